@@ -5,11 +5,16 @@
 // =============================================================================
 // Wraps the Vidvox HAP reference decoder for easy use in TrussC.
 // Decodes HAP frames to DXT/BC compressed texture data.
+//
+// Multi-chunk frames decode their chunks in parallel on a long-lived pool
+// shared by every HapDecoder (and so every HapPlayer). The calling thread
+// claims chunks alongside the workers; no threads are started per frame.
 
 #include <vector>
 #include <cstdint>
 #include <functional>
-#include <thread>
+
+#include "tc/utils/tcParallel.h"
 
 // HAP reference decoder (BSD-2-Clause)
 extern "C" {
@@ -92,6 +97,17 @@ class HapDecoder {
 public:
     HapDecoder() = default;
 
+    // Chunk decode pool shared by all decoders. `threadCount` = worker
+    // threads besides the decoding thread; -1 = hardware_concurrency() - 1,
+    // 0 = decode chunks inline. Blocks while a frame is being decoded.
+    static void setDecodeThreadCount(int threadCount) {
+        decodePool().setThreadCount(threadCount);
+    }
+
+    static int getDecodeThreadCount() {
+        return decodePool().getThreadCount();
+    }
+
     // Get last chunk count (for debugging, -1 = callback not called)
     int getLastChunkCount() const { return lastChunkCount_; }
 
@@ -198,6 +214,13 @@ public:
 private:
     mutable int lastChunkCount_ = -1;  // -1 = callback never called
 
+    // Separate from WorkerPool::shared() so frame decodes never queue
+    // behind image kernels. Created on first use.
+    static trussc::WorkerPool& decodePool() {
+        static trussc::WorkerPool pool;
+        return pool;
+    }
+
     // HAP decode callback for parallel decoding
     static void hapDecodeCallback(HapDecodeWorkFunction work, void* p, unsigned int count, void* info) {
         // Store chunk count (always, even for count=0 or 1)
@@ -214,19 +237,12 @@ private:
             return;
         }
 
-        // Parallel decode using threads
-        std::vector<std::thread> threads;
-        threads.reserve(count);
-
-        for (unsigned int i = 0; i < count; i++) {
-            threads.emplace_back([work, p, i]() {
-                work(p, i);
-            });
-        }
-
-        for (auto& t : threads) {
-            t.join();
-        }
+        // Chunks are claimed from an atomic counter by the pool workers and
+        // this thread; returns once every chunk is done. Several players
+        // decoding at once each get workers from the pool.
+        decodePool().parallelFor(0, static_cast<int>(count), [work, p](int i) {
+            work(p, static_cast<unsigned int>(i));
+        });
     }
 };
 
@@ -0,0 +1,176 @@
+// =============================================================================
+// tcxHapPixels.cpp - BC/DXT -> RGBA8 kernels (see tcxHapPixels.h)
+// =============================================================================
+
+#include "tcxHapPixels.h"
+#include "impl/bcdec.h"
+#include "tc/utils/tcParallel.h"
+#include "tc/utils/tcSimd.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tcx::hap {
+
+namespace {
+
+namespace simd = trussc::internal::simd;
+
+// Four RGB float pixels in [0, 1] -> four RGBA8 pixels (alpha 255), clamped
+// and truncated exactly like static_cast<uint8_t>(std::clamp(v * 255, 0, 255)).
+inline void storeRgb4(simd::f32x4 r, simd::f32x4 g, simd::f32x4 b, uint8_t* dst) {
+    const simd::f32x4 k255 = simd::set1(255.0f);
+    r = simd::min(simd::max(simd::mul(r, k255), simd::zero()), k255);
+    g = simd::min(simd::max(simd::mul(g, k255), simd::zero()), k255);
+    b = simd::min(simd::max(simd::mul(b, k255), simd::zero()), k255);
+#if defined(TC_SIMD_SSE2)
+    __m128i px = _mm_or_si128(_mm_cvttps_epi32(r), _mm_slli_epi32(_mm_cvttps_epi32(g), 8));
+    px = _mm_or_si128(px, _mm_slli_epi32(_mm_cvttps_epi32(b), 16));
+    px = _mm_or_si128(px, _mm_set1_epi32((int)0xFF000000u));
+    _mm_storeu_si128((__m128i*)dst, px);
+#elif defined(TC_SIMD_NEON)
+    uint32x4_t px = vorrq_u32(vcvtq_u32_f32(r), vshlq_n_u32(vcvtq_u32_f32(g), 8));
+    px = vorrq_u32(px, vshlq_n_u32(vcvtq_u32_f32(b), 16));
+    px = vorrq_u32(px, vdupq_n_u32(0xFF000000u));
+    vst1q_u8(dst, vreinterpretq_u8_u32(px));
+#else
+    for (int i = 0; i < 4; i++) {
+        dst[i * 4 + 0] = (uint8_t)r.v[i];
+        dst[i * 4 + 1] = (uint8_t)g.v[i];
+        dst[i * 4 + 2] = (uint8_t)b.v[i];
+        dst[i * 4 + 3] = 255;
+    }
+#endif
+}
+
+// RGTC1 (BC4) -> gray RGBA8.
+void decodeGrayBlock(const uint8_t* block, uint8_t* dst, int dstPitch) {
+    uint8_t r[16];
+    bcdec_bc4(block, r, 4);
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const uint8_t v = r[y * 4 + x];
+            uint8_t* p = dst + y * dstPitch + x * 4;
+            p[0] = v;
+            p[1] = v;
+            p[2] = v;
+            p[3] = 255;
+        }
+    }
+}
+
+void decodeBlock(HapFormat format, const uint8_t* block, uint8_t* dst, int dstPitch) {
+    switch (format) {
+        case HapFormat::DXT1:      bcdec_bc1(block, dst, dstPitch); break;
+        case HapFormat::DXT5:      bcdec_bc3(block, dst, dstPitch); break;
+        case HapFormat::YCoCgDXT5: decodeYCoCgBlock(block, dst, dstPitch); break;
+        case HapFormat::BC7:       bcdec_bc7(block, dst, dstPitch); break;
+        case HapFormat::RGTC1:     decodeGrayBlock(block, dst, dstPitch); break;
+        default: break;
+    }
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// HAP Q block
+// -----------------------------------------------------------------------------
+void decodeYCoCgBlock(const uint8_t* block, uint8_t* dst, int dstPitch) {
+    // Y: BC3 alpha block (bcdec__smooth_alpha_block)
+    uint64_t alphaBits;
+    std::memcpy(&alphaBits, block, 8);
+    unsigned a[8];
+    a[0] = alphaBits & 0xFF;
+    a[1] = (alphaBits >> 8) & 0xFF;
+    if (a[0] > a[1]) {
+        for (unsigned i = 1; i < 7; i++) a[i + 1] = ((7 - i) * a[0] + i * a[1]) / 7;
+    } else {
+        for (unsigned i = 1; i < 5; i++) a[i + 1] = ((5 - i) * a[0] + i * a[1]) / 5;
+        a[6] = 0;
+        a[7] = 255;
+    }
+    float y[8];
+    for (int i = 0; i < 8; i++) y[i] = a[i] / 255.0f;
+
+    // Co, Cg, scale: BC3 colour block, always 4-colour (bcdec__color_block)
+    uint16_t c0, c1;
+    std::memcpy(&c0, block + 8, 2);
+    std::memcpy(&c1, block + 10, 2);
+    const unsigned r0 = (c0 >> 11) & 0x1F, g0 = (c0 >> 5) & 0x3F, b0 = c0 & 0x1F;
+    const unsigned r1 = (c1 >> 11) & 0x1F, g1 = (c1 >> 5) & 0x3F, b1 = c1 & 0x1F;
+    const unsigned pr[4] = {(r0 * 527 + 23) >> 6, (r1 * 527 + 23) >> 6,
+                            ((2 * r0 + r1) * 351 + 61) >> 7, ((r0 + r1 * 2) * 351 + 61) >> 7};
+    const unsigned pg[4] = {(g0 * 259 + 33) >> 6, (g1 * 259 + 33) >> 6,
+                            ((2 * g0 + g1) * 2763 + 1039) >> 11, ((g0 + g1 * 2) * 2763 + 1039) >> 11};
+    const unsigned pb[4] = {(b0 * 527 + 23) >> 6, (b1 * 527 + 23) >> 6,
+                            ((2 * b0 + b1) * 351 + 61) >> 7, ((b0 + b1 * 2) * 351 + 61) >> 7};
+
+    // Chroma per palette entry, same operations as ycocg.glsl:
+    // scale = B * 255/8 + 1, co = (R - 0.5) / scale, cg = (G - 0.5) / scale
+    float co[4], cg[4];
+    for (int i = 0; i < 4; i++) {
+        const float scale = ((pb[i] / 255.0f) * (255.0f / 8.0f)) + 1.0f;
+        co[i] = ((pr[i] / 255.0f) - 0.5f) / scale;
+        cg[i] = ((pg[i] / 255.0f) - 0.5f) / scale;
+    }
+
+    uint32_t colorBits;
+    std::memcpy(&colorBits, block + 12, 4);
+    uint64_t yBits = alphaBits >> 16;
+    for (int row = 0; row < 4; row++) {
+        float yv[4], cov[4], cgv[4];
+        for (int x = 0; x < 4; x++) {
+            const unsigned ci = colorBits & 3;
+            yv[x] = y[yBits & 7];
+            cov[x] = co[ci];
+            cgv[x] = cg[ci];
+            colorBits >>= 2;
+            yBits >>= 3;
+        }
+        const simd::f32x4 vy = simd::load(yv), vco = simd::load(cov), vcg = simd::load(cgv);
+        storeRgb4(simd::sub(simd::add(vy, vco), vcg),     // r = y + co - cg
+                  simd::add(vy, vcg),                     // g = y + cg
+                  simd::sub(simd::sub(vy, vco), vcg),     // b = y - co - cg
+                  dst + row * dstPitch);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Whole frame
+// -----------------------------------------------------------------------------
+bool decodeBlocksToRgba(const uint8_t* blocks, size_t size, uint32_t width, uint32_t height,
+                        HapFormat format, uint8_t* dst, size_t dstStride, int maxThreads) {
+    const size_t blockBytes = getBytesPerBlock(format);
+    if (blockBytes == 0 || !blocks || !dst || width == 0 || height == 0) return false;
+    if (size < calculateTextureSize(width, height, format)) return false;
+    if (dstStride == 0) dstStride = (size_t)width * 4;
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t fullX = width / 4;   // blocks that fit horizontally
+
+    trussc::WorkerPool::shared().parallelFor(0, (int)blocksY, [&](int by) {
+        const uint8_t* src = blocks + (size_t)by * blocksX * blockBytes;
+        uint8_t* row = dst + (size_t)by * 4 * dstStride;
+        const uint32_t rows = std::min<uint32_t>(4, height - (uint32_t)by * 4);
+
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint8_t* block = src + bx * blockBytes;
+            uint8_t* out = row + bx * 16;
+            if (rows == 4 && bx < fullX) {
+                decodeBlock(format, block, out, (int)dstStride);
+                continue;
+            }
+            // Clipped block (right column / bottom row): decode to a tile
+            uint8_t tile[4 * 16];
+            decodeBlock(format, block, tile, 16);
+            const uint32_t cols = std::min<uint32_t>(4, width - bx * 4);
+            for (uint32_t y = 0; y < rows; y++) {
+                std::memcpy(out + y * dstStride, tile + y * 16, cols * 4);
+            }
+        }
+    }, maxThreads);
+    return true;
+}
+
+} // namespace tcx::hap
@@ -0,0 +1,43 @@
+#pragma once
+
+// =============================================================================
+// tcxHapPixels - CPU BC/DXT -> RGBA8 decode for HapPlayer::getPixels()
+// =============================================================================
+// The GPU samples HAP frames as compressed textures; these kernels are for the
+// CPU side (recording, analysis, CPU effects). Rows of 4x4 blocks are split
+// across WorkerPool::shared(), and the output rows of each block row are
+// written while they are still in cache.
+//
+//   HAP / HAP Alpha   BC1 / BC3 via bcdec.
+//   HAP Q             BC3 holding Co, Cg, scale and Y. The YCoCg -> RGB
+//                     divides run once per palette entry (4 per block)
+//                     instead of per pixel, and the per-pixel math runs four
+//                     pixels at a time on SSE2 / NEON (tc/utils/tcSimd.h).
+//                     Bit-identical to the scalar per-pixel conversion on
+//                     every path; matches ycocg.glsl.
+//   BC7, RGTC1        bcdec (RGTC1 is expanded to gray, alpha 255).
+//
+// Edge blocks of sizes that aren't a multiple of 4 are clipped.
+// =============================================================================
+
+#include "tcxHapDecoder.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tcx::hap {
+
+// Decode a whole frame as HapDecoder outputs it (`size` bytes of `format`
+// blocks) to RGBA8 at `dst`, `dstStride` bytes per row (0 = width * 4).
+// `maxThreads` caps the threads taking part, the caller included (0 = the
+// whole shared pool, 1 = this thread only). Returns false if `size` is too
+// small or the format is unknown.
+bool decodeBlocksToRgba(const uint8_t* blocks, size_t size, uint32_t width, uint32_t height,
+                        HapFormat format, uint8_t* dst, size_t dstStride = 0,
+                        int maxThreads = 0);
+
+// One 4x4 HAP Q block (BC3: R = Co, G = Cg, B = scale, A = Y) to RGB with
+// alpha 255. Writes 4 rows of 16 bytes, `dstPitch` bytes apart.
+void decodeYCoCgBlock(const uint8_t* block, uint8_t* dst, int dstPitch);
+
+} // namespace tcx::hap
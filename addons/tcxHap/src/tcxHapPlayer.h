@@ -13,13 +13,18 @@
 //
 //   void update() { player.update(); }
 //   void draw() { player.draw(0, 0); }
+//
+// Frames are read and decoded ahead of the playhead on a background thread
+// (see tcxHapReadAhead.h); update() only swaps in a decoded frame and uploads
+// it. setReadAheadFrames(0) goes back to decoding on the main thread.
 // =============================================================================
 
 #include <TrussC.h>
 #include "tcxMovParser.h"
 #include "tcxHapDecoder.h"
+#include "tcxHapReadAhead.h"
+#include "tcxHapPixels.h"
 #include "ycocg.glsl.h"
-#include "impl/bcdec.h"
 
 namespace tcx::hap {
 
@@ -63,13 +68,40 @@ public:
     }
 
     int getChunkCount() const {
-        return hapDecoder_.getLastChunkCount();
+        return chunkCount_;
+    }
+
+    // Ring occupancy, hits and late frames of the read-ahead stage.
+    HapReadAheadStats getReadAheadStats() const {
+        return readAhead_ ? readAhead_->getStats() : HapReadAheadStats{};
     }
 
     void resetStats() {
         decodeTimeMs_ = 0.0;
     }
 
+    // Worker threads that decode the chunks of multi-chunk frames, shared by
+    // every HapPlayer (see HapDecoder::setDecodeThreadCount).
+    static void setDecodeThreadCount(int threadCount) {
+        HapDecoder::setDecodeThreadCount(threadCount);
+    }
+
+    static int getDecodeThreadCount() {
+        return HapDecoder::getDecodeThreadCount();
+    }
+
+    // Decoded frames to keep ready ahead of the playhead (default 3; each
+    // costs one DXT frame, e.g. 8 MB at 4K HAP Q). 0 = decode synchronously
+    // in update(). Takes effect immediately if a movie is loaded.
+    void setReadAheadFrames(int frames) {
+        readAheadFrames_ = std::max(0, frames);
+        if (initialized_) startReadAhead();
+    }
+
+    int getReadAheadFrames() const {
+        return readAheadFrames_;
+    }
+
     // =========================================================================
     // Load / Close
     // =========================================================================
@@ -121,8 +153,8 @@ public:
 
         // Determine HAP format from first frame
         if (!videoTrack->samples.empty()) {
-            std::vector<uint8_t> firstFrame;
-            if (movParser_.readSample(*videoTrack, 0, firstFrame)) {
+            auto firstFrame = movParser_.getSample(*videoTrack, 0);
+            if (!firstFrame.empty()) {
                 hapFormat_ = getHapFrameFormat(firstFrame.data(), firstFrame.size());
             }
         }
@@ -137,6 +169,7 @@ public:
         // Allocate frame buffer for decoded DXT data
         size_t bufferSize = calculateTextureSize(width_, height_, hapFormat_);
         frameBuffer_.resize(bufferSize);
+        path_ = path;
 
         // Create compressed texture
         if (!createCompressedTexture()) {
@@ -159,12 +192,16 @@ public:
 
         initialized_ = true;
         currentFrame_ = 0;
+        startReadAhead();
         return tc::LoadResult::success();
     }
 
     void close() override {
         if (!initialized_) return;
 
+        // Stop the read-ahead worker before its file and buffers go away
+        readAhead_.reset();
+
         // Stop audio
         if (hasAudio_) {
             audioPlayer_.stop();
@@ -173,7 +210,6 @@ public:
         movParser_.close();
         texture_.clear();
         frameBuffer_.clear();
-        sampleBuffer_.clear();
         pixels_.clear();
         pixelsValid_ = false;
         videoTrack_ = nullptr;
@@ -192,6 +228,9 @@ public:
         totalFrames_ = 0;
         currentFrame_ = 0;
         playbackTime_ = 0;
+        stride_ = 1.0;
+        chunkCount_ = -1;
+        path_.clear();
         hapFormat_ = HapFormat::Unknown;
     }
 
@@ -207,7 +246,11 @@ public:
         if (playing_ && !paused_) {
             frameNew_ = false;
             // Advance playback time (can be negative for reverse)
-            playbackTime_ += tc::getDeltaTime() * speed_;
+            double dt = tc::getDeltaTime();
+            playbackTime_ += dt * speed_;
+            if (duration_ > 0 && dt > 0) {
+                stride_ = dt * speed_ * totalFrames_ / duration_;  // frames per update
+            }
 
             // Calculate target frame
             int targetFrame = static_cast<int>(playbackTime_ / duration_ * totalFrames_);
@@ -235,15 +278,20 @@ public:
                 }
             }
 
-            // Decode new frame if needed
+            // Show new frame if needed
             if (targetFrame != currentFrame_ || !firstFrameReceived_) {
-                if (decodeFrame(targetFrame)) {
+                if (loadFrame(targetFrame)) {
                     currentFrame_ = targetFrame;
                     updateTexture();
                     markFrameNew();
                 }
             }
         }
+
+        // Tell the read-ahead worker what comes next
+        if (readAhead_) {
+            readAhead_->setPlayhead(currentFrame_, stride_, loop_);
+        }
     }
 
     // =========================================================================
@@ -274,11 +322,14 @@ public:
     void setFrame(int frame) override {
         if (!initialized_) return;
         frame = std::max(0, std::min(frame, totalFrames_ - 1));
-        if (decodeFrame(frame)) {
+        if (loadFrame(frame)) {
             currentFrame_ = frame;
             playbackTime_ = (duration_ * frame) / totalFrames_;
             updateTexture();
             markFrameNew();
+            if (readAhead_) {
+                readAhead_->setPlayhead(currentFrame_, stride_, loop_);
+            }
         }
     }
 
@@ -299,6 +350,10 @@ public:
     // Override setSpeed to allow negative values (reverse playback)
     void setSpeed(float speed) {
         speed_ = speed;  // Allow any value including negative
+        // Point read-ahead the new way before the next update() measures it
+        if (speed != 0.0f && std::signbit(speed) != std::signbit(stride_)) {
+            stride_ = -stride_;
+        }
         if (initialized_) {
             setSpeedImpl(speed_);
         }
@@ -329,6 +384,24 @@ public:
         return pixels_.empty() ? nullptr : pixels_.data();
     }
 
+    // Decode the current frame straight into `pixels` (RGBA8, reallocated
+    // only if the size or format differs), skipping the internal copy that
+    // getPixels() keeps. Returns false if no frame is loaded.
+    bool decodePixels(tc::Pixels& pixels) const {
+        if (frameBuffer_.empty() || width_ == 0 || height_ == 0) return false;
+        const int w = static_cast<int>(width_), h = static_cast<int>(height_);
+        if (!pixels.isAllocated() || pixels.getWidth() != w || pixels.getHeight() != h ||
+            pixels.getChannels() != 4 || pixels.isFloat()) {
+            pixels.allocate(w, h, 4);
+        }
+        if (pixelsValid_) {
+            std::memcpy(pixels.getData(), pixels_.data(), pixels_.size());
+            return true;
+        }
+        return decodeBlocksToRgba(frameBuffer_.data(), frameBuffer_.size(), width_, height_,
+                                  hapFormat_, pixels.getData());
+    }
+
     // =========================================================================
     // Audio access (for encoding to other formats)
     // =========================================================================
@@ -472,12 +545,20 @@ private:
 
     HapFormat hapFormat_ = HapFormat::Unknown;
     std::vector<uint8_t> frameBuffer_;
-    std::vector<uint8_t> sampleBuffer_;
+
+    // Frames paged in ahead of a main-thread decode (adviseSamples)
+    static constexpr size_t kAdviseFrames = 4;
+
+    // Background read + decode (null when off)
+    std::unique_ptr<HapReadAhead> readAhead_;
+    int readAheadFrames_ = 3;
+    tc::fs::path path_;
 
     float duration_ = 0;
     int totalFrames_ = 0;
     int currentFrame_ = 0;
     double playbackTime_ = 0;
+    double stride_ = 1.0;   // frames per update, negative in reverse
 
     // Audio playback
     tc::Sound audioPlayer_;
@@ -492,6 +573,7 @@ private:
 
     // Performance stats (low-pass filtered)
     double decodeTimeMs_ = 0.0;
+    int chunkCount_ = -1;
 
     // -------------------------------------------------------------------------
     // Internal methods
@@ -518,16 +600,20 @@ private:
         audioTrack_ = other.audioTrack_;
         hapFormat_ = other.hapFormat_;
         frameBuffer_ = std::move(other.frameBuffer_);
-        sampleBuffer_ = std::move(other.sampleBuffer_);
+        readAhead_ = std::move(other.readAhead_);  // worker owns its own file
+        readAheadFrames_ = other.readAheadFrames_;
+        path_ = std::move(other.path_);
         pixels_ = std::move(other.pixels_);
         pixelsValid_ = other.pixelsValid_;
         duration_ = other.duration_;
         totalFrames_ = other.totalFrames_;
         currentFrame_ = other.currentFrame_;
         playbackTime_ = other.playbackTime_;
+        stride_ = other.stride_;
         audioPlayer_ = std::move(other.audioPlayer_);
         hasAudio_ = other.hasAudio_;
         decodeTimeMs_ = other.decodeTimeMs_;
+        chunkCount_ = other.chunkCount_;
 
         // Invalidate source
         other.initialized_ = false;
@@ -538,6 +624,7 @@ private:
         other.width_ = 0;
         other.height_ = 0;
         other.decodeTimeMs_ = 0.0;
+        other.chunkCount_ = -1;
     }
 
     bool loadAudio() {
@@ -579,10 +666,8 @@ private:
         audioData.reserve(totalSize);
 
         for (size_t i = 0; i < audioTrack_->samples.size(); i++) {
-            std::vector<uint8_t> sampleData;
-            if (movParser_.readSample(*audioTrack_, i, sampleData)) {
-                audioData.insert(audioData.end(), sampleData.begin(), sampleData.end());
-            }
+            auto sampleData = movParser_.getSample(*audioTrack_, i);
+            audioData.insert(audioData.end(), sampleData.begin(), sampleData.end());
         }
 
         if (audioData.empty()) {
@@ -626,10 +711,8 @@ private:
         mp3Data.reserve(totalSize);
 
         for (size_t i = 0; i < audioTrack_->samples.size(); i++) {
-            std::vector<uint8_t> sampleData;
-            if (movParser_.readSample(*audioTrack_, i, sampleData)) {
-                mp3Data.insert(mp3Data.end(), sampleData.begin(), sampleData.end());
-            }
+            auto sampleData = movParser_.getSample(*audioTrack_, i);
+            mp3Data.insert(mp3Data.end(), sampleData.begin(), sampleData.end());
         }
 
         if (mp3Data.empty()) {
@@ -671,8 +754,8 @@ private:
         int channels = audioTrack_->channels;
 
         for (size_t i = 0; i < audioTrack_->samples.size(); i++) {
-            std::vector<uint8_t> sampleData;
-            if (movParser_.readSample(*audioTrack_, i, sampleData)) {
+            auto sampleData = movParser_.getSample(*audioTrack_, i);
+            if (!sampleData.empty()) {
                 // Add ADTS header for this frame
                 uint8_t adtsHeader[7];
                 tc::SoundBuffer::createAdtsHeader(adtsHeader, static_cast<int>(sampleData.size()),
@@ -707,6 +790,41 @@ private:
         return true;
     }
 
+    void startReadAhead() {
+        readAhead_.reset();
+        if (readAheadFrames_ <= 0) return;
+        readAhead_ = std::make_unique<HapReadAhead>();
+        if (!readAhead_->start(path_, width_, height_, frameBuffer_.size(), readAheadFrames_)) {
+            tc::logWarning("HapPlayer") << "Read-ahead unavailable, decoding on the main thread";
+            readAhead_.reset();
+            return;
+        }
+        readAhead_->setPlayhead(currentFrame_, stride_, loop_);
+    }
+
+    // Put `frameIndex` into frameBuffer_: from the read-ahead ring if it's
+    // there, otherwise decoded here.
+    bool loadFrame(int frameIndex) {
+        double ms = 0.0;
+        int chunks = -1;
+        if (readAhead_ && readAhead_->take(frameIndex, frameBuffer_, ms, chunks)) {
+            pixelsValid_ = false;
+            chunkCount_ = chunks;
+            recordDecodeTime(ms);
+            return true;
+        }
+        return decodeFrame(frameIndex);
+    }
+
+    void recordDecodeTime(double ms) {
+        if (decodeTimeMs_ == 0.0) {
+            decodeTimeMs_ = ms;  // First measurement after reset
+        } else {
+            constexpr double kAlpha = 0.05;
+            decodeTimeMs_ = decodeTimeMs_ * (1.0 - kAlpha) + ms * kAlpha;
+        }
+    }
+
     bool decodeFrame(int frameIndex) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -715,15 +833,19 @@ private:
             return false;
         }
 
-        // Read sample data from MOV
-        if (!movParser_.readSample(*videoTrack_, frameIndex, sampleBuffer_)) {
+        // Sample data straight from the mapped MOV (no copy); hint the OS
+        // to page in what comes next in the playback direction
+        auto sample = movParser_.getSample(*videoTrack_, frameIndex);
+        if (sample.empty()) {
             return false;
         }
+        const int direction = (playing_ && !paused_) ? (speed_ < 0 ? -1 : 1) : 0;
+        movParser_.adviseSamples(*videoTrack_, frameIndex, direction, kAdviseFrames);
 
         // Decode HAP frame to DXT data
         HapFormat outFormat;
         if (!hapDecoder_.decodeToBuffer(
-                sampleBuffer_.data(), sampleBuffer_.size(),
+                sample.data(), sample.size(),
                 width_, height_,
                 frameBuffer_.data(), frameBuffer_.size(),
                 outFormat)) {
@@ -732,21 +854,16 @@ private:
 
         // Invalidate RGBA cache - will be decoded on demand
         pixelsValid_ = false;
+        chunkCount_ = hapDecoder_.getLastChunkCount();
 
         // Record decode time (low-pass filter)
         auto endTime = std::chrono::high_resolution_clock::now();
-        double ms = std::chrono::duration<double, std::milli>(endTime - startTime).count();
-        if (decodeTimeMs_ == 0.0) {
-            decodeTimeMs_ = ms;  // First measurement after reset
-        } else {
-            constexpr double kAlpha = 0.05;
-            decodeTimeMs_ = decodeTimeMs_ * (1.0 - kAlpha) + ms * kAlpha;
-        }
+        recordDecodeTime(std::chrono::duration<double, std::milli>(endTime - startTime).count());
 
         return true;
     }
 
-    // Decode BC/DXT frameBuffer to RGBA pixels
+    // Decode BC/DXT frameBuffer to RGBA pixels (tcxHapPixels.h)
     void decodeFrameToRgba() {
         if (frameBuffer_.empty() || width_ == 0 || height_ == 0) {
             return;
@@ -758,130 +875,15 @@ private:
             pixels_.resize(pixelCount);
         }
 
-        // Decode based on format
-        const uint8_t* src = frameBuffer_.data();
-        uint8_t* dst = pixels_.data();
-
-        // BC textures are 4x4 block compressed
-        int blocksX = (width_ + 3) / 4;
-        int blocksY = (height_ + 3) / 4;
-        int dstPitch = width_ * 4;  // bytes per row in output
-
-        switch (hapFormat_) {
-            case HapFormat::DXT1:
-                // BC1: 8 bytes per block
-                for (int by = 0; by < blocksY; by++) {
-                    for (int bx = 0; bx < blocksX; bx++) {
-                        uint8_t* blockDst = dst + (by * 4 * dstPitch) + (bx * 4 * 4);
-                        bcdec_bc1(src, blockDst, dstPitch);
-                        src += BCDEC_BC1_BLOCK_SIZE;
-                    }
-                }
-                break;
-
-            case HapFormat::DXT5:
-                // BC3: 16 bytes per block
-                for (int by = 0; by < blocksY; by++) {
-                    for (int bx = 0; bx < blocksX; bx++) {
-                        uint8_t* blockDst = dst + (by * 4 * dstPitch) + (bx * 4 * 4);
-                        bcdec_bc3(src, blockDst, dstPitch);
-                        src += BCDEC_BC3_BLOCK_SIZE;
-                    }
-                }
-                break;
-
-            case HapFormat::YCoCgDXT5:
-                // BC3 + YCoCg color transform: 16 bytes per block
-                for (int by = 0; by < blocksY; by++) {
-                    for (int bx = 0; bx < blocksX; bx++) {
-                        uint8_t* blockDst = dst + (by * 4 * dstPitch) + (bx * 4 * 4);
-                        bcdec_bc3(src, blockDst, dstPitch);
-                        src += BCDEC_BC3_BLOCK_SIZE;
-                    }
-                }
-                // Convert YCoCg to RGB
-                convertYCoCgToRgb();
-                break;
-
-            case HapFormat::BC7:
-                // BC7: 16 bytes per block
-                for (int by = 0; by < blocksY; by++) {
-                    for (int bx = 0; bx < blocksX; bx++) {
-                        uint8_t* blockDst = dst + (by * 4 * dstPitch) + (bx * 4 * 4);
-                        bcdec_bc7(src, blockDst, dstPitch);
-                        src += BCDEC_BC7_BLOCK_SIZE;
-                    }
-                }
-                break;
-
-            case HapFormat::RGTC1:
-                // BC4: 8 bytes per block, single channel -> expand to RGBA
-                for (int by = 0; by < blocksY; by++) {
-                    for (int bx = 0; bx < blocksX; bx++) {
-                        // Decode to temporary R buffer
-                        uint8_t rBlock[16];
-                        bcdec_bc4(src, rBlock, 4);
-                        // Expand R to RGBA
-                        for (int py = 0; py < 4; py++) {
-                            for (int px = 0; px < 4; px++) {
-                                int dstX = bx * 4 + px;
-                                int dstY = by * 4 + py;
-                                if (dstX < width_ && dstY < height_) {
-                                    uint8_t* pixel = dst + (dstY * dstPitch) + (dstX * 4);
-                                    uint8_t r = rBlock[py * 4 + px];
-                                    pixel[0] = r;
-                                    pixel[1] = r;
-                                    pixel[2] = r;
-                                    pixel[3] = 255;
-                                }
-                            }
-                        }
-                        src += BCDEC_BC4_BLOCK_SIZE;
-                    }
-                }
-                break;
-
-            default:
-                // Unknown format
-                std::fill(pixels_.begin(), pixels_.end(), 0);
-                break;
+        if (!decodeBlocksToRgba(frameBuffer_.data(), frameBuffer_.size(), width_, height_,
+                                hapFormat_, pixels_.data())) {
+            // Unknown format
+            std::fill(pixels_.begin(), pixels_.end(), 0);
         }
 
         pixelsValid_ = true;
     }
 
-    // Convert YCoCg color space to RGB (for HAP-Q)
-    // Must match the GPU shader in ycocg.glsl
-    void convertYCoCgToRgb() {
-        size_t pixelCount = static_cast<size_t>(width_) * height_;
-        for (size_t i = 0; i < pixelCount; i++) {
-            uint8_t* pixel = pixels_.data() + i * 4;
-            // DXT5 texture channels: R=Co, G=Cg, B=Scale, A=Y
-            // Convert to 0-1 range
-            float coRaw = pixel[0] / 255.0f;
-            float cgRaw = pixel[1] / 255.0f;
-            float scaleRaw = pixel[2] / 255.0f;
-            float y = pixel[3] / 255.0f;
-
-            // Scale factor: (B * 255 / 8) + 1 = (B * 31.875) + 1
-            float scale = (scaleRaw * (255.0f / 8.0f)) + 1.0f;
-
-            // Chrominance values (centered at 0.5, divided by scale)
-            float co = (coRaw - 0.5f) / scale;
-            float cg = (cgRaw - 0.5f) / scale;
-
-            // YCoCg to RGB conversion
-            float r = y + co - cg;
-            float g = y + cg;
-            float b = y - co - cg;
-
-            pixel[0] = static_cast<uint8_t>(std::clamp(r * 255.0f, 0.0f, 255.0f));
-            pixel[1] = static_cast<uint8_t>(std::clamp(g * 255.0f, 0.0f, 255.0f));
-            pixel[2] = static_cast<uint8_t>(std::clamp(b * 255.0f, 0.0f, 255.0f));
-            pixel[3] = 255;
-        }
-    }
-
     bool createCompressedTexture() {
         // Map HAP format to sokol pixel format
         switch (hapFormat_) {
@@ -1000,10 +1002,8 @@ private:
         audioData.reserve(totalSize);
 
         for (size_t i = 0; i < audioTrack_->samples.size(); i++) {
-            std::vector<uint8_t> sampleData;
-            if (const_cast<MovParser&>(movParser_).readSample(*audioTrack_, i, sampleData)) {
-                audioData.insert(audioData.end(), sampleData.begin(), sampleData.end());
-            }
+            auto sampleData = movParser_.getSample(*audioTrack_, i);
+            audioData.insert(audioData.end(), sampleData.begin(), sampleData.end());
         }
 
         return audioData;
@@ -1025,8 +1025,8 @@ private:
         int channels = audioTrack_->channels;
 
         for (size_t i = 0; i < audioTrack_->samples.size(); i++) {
-            std::vector<uint8_t> sampleData;
-            if (const_cast<MovParser&>(movParser_).readSample(*audioTrack_, i, sampleData)) {
+            auto sampleData = movParser_.getSample(*audioTrack_, i);
+            if (!sampleData.empty()) {
                 // Add ADTS header for this frame
                 uint8_t adtsHeader[7];
                 tc::SoundBuffer::createAdtsHeader(adtsHeader, static_cast<int>(sampleData.size()),
@@ -0,0 +1,285 @@
+#pragma once
+
+// =============================================================================
+// tcxHapReadAhead - background read + decode ring for HapPlayer
+// =============================================================================
+// A worker thread reads the frames playback is about to need from the MOV
+// (through its own mapping of the file) and decodes them to DXT/BC into a fixed ring
+// of frame buffers. The player's update() then only swaps a ready buffer in
+// and uploads it, so disk stalls and large frames land on the worker instead
+// of the main thread.
+//
+// Prediction: from the last shown frame, the next `capacity` frames along
+// the playback stride (frames advanced per update; negative = reverse),
+// wrapping at either end when looping. Ready frames that fall out of that
+// window (seek, speed or direction change) are discarded to make room.
+//
+// All frame buffers are allocated in start(); steady-state playback does not
+// allocate.
+// =============================================================================
+
+#include "tcxMovParser.h"
+#include "tcxHapDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcx::hap {
+
+// -----------------------------------------------------------------------------
+// Read-ahead statistics (see HapPlayer::getReadAheadStats)
+// -----------------------------------------------------------------------------
+struct HapReadAheadStats {
+    int capacity = 0;            // ring slots (0 = read-ahead off)
+    int ready = 0;               // decoded frames waiting right now
+    double averageReady = 0.0;   // ready frames per update() (low-pass filtered)
+    uint64_t hits = 0;           // frames update() took from the ring
+    uint64_t lateFrames = 0;     // frames not decoded in time (decoded on the main thread)
+    uint64_t discarded = 0;      // decoded frames never shown (seek, speed change)
+};
+
+// -----------------------------------------------------------------------------
+// HapReadAhead
+// -----------------------------------------------------------------------------
+class HapReadAhead {
+public:
+    HapReadAhead() = default;
+    ~HapReadAhead() { stop(); }
+
+    HapReadAhead(const HapReadAhead&) = delete;
+    HapReadAhead& operator=(const HapReadAhead&) = delete;
+
+    // Open `path` again for the worker and start it. `frameBytes` is the
+    // decoded (DXT/BC) size of one frame.
+    bool start(const tc::fs::path& path, uint32_t width, uint32_t height,
+               size_t frameBytes, int capacity) {
+        stop();
+        if (capacity <= 0 || !parser_.open(path)) return false;
+        track_ = parser_.getInfo().getVideoTrack();
+        if (!track_ || track_->samples.empty()) {
+            parser_.close();
+            return false;
+        }
+        width_ = width;
+        height_ = height;
+        totalFrames_ = static_cast<int>(track_->samples.size());
+
+        slots_.assign(static_cast<size_t>(capacity), Slot{});
+        for (auto& slot : slots_) slot.data.resize(frameBytes);
+        stats_ = HapReadAheadStats{};
+        stats_.capacity = capacity;
+        playhead_ = 0;
+        stride_ = 1.0;
+        loop_ = false;
+        failedFrame_ = -1;
+        stop_ = false;
+
+        worker_ = std::thread([this] { workerLoop(); });
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+        parser_.close();
+        track_ = nullptr;
+        slots_.clear();
+        stats_.capacity = 0;
+        stats_.ready = 0;
+    }
+
+    bool isRunning() const { return worker_.joinable(); }
+
+    // Main thread, once per update(): the frame on screen and the playback
+    // stride in frames per update (negative = reverse, 0 = paused).
+    void setPlayhead(int frame, double stride, bool loop) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            playhead_ = frame;
+            stride_ = stride;
+            loop_ = loop;
+            int ready = 0;
+            for (const auto& slot : slots_) ready += slot.state == Slot::Ready;
+            stats_.averageReady = stats_.averageReady * 0.95 + ready * 0.05;
+        }
+        cv_.notify_all();
+    }
+
+    // Main thread: if `frame` is decoded (or being decoded right now, in
+    // which case this waits for it), swap it into `out` and return true.
+    // `out` must be frameBytes long; its old buffer goes back to the ring.
+    // A miss counts as a late frame.
+    bool take(int frame, std::vector<uint8_t>& out, double& decodeMs, int& chunkCount) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto find = [&]() -> Slot* {
+            for (auto& slot : slots_) {
+                if (slot.state != Slot::Free && slot.frame == frame) return &slot;
+            }
+            return nullptr;
+        };
+        Slot* slot = find();
+        if (slot && slot->state == Slot::Decoding) {
+            doneCv_.wait(lock, [&] { return slot->state != Slot::Decoding; });
+            slot = find();
+            stats_.lateFrames++;
+        } else if (slot) {
+            stats_.hits++;
+        } else {
+            stats_.lateFrames++;
+            return false;
+        }
+        if (!slot || slot->data.size() != out.size()) return false;
+
+        std::swap(slot->data, out);
+        decodeMs = slot->decodeMs;
+        chunkCount = slot->chunkCount;
+        slot->state = Slot::Free;
+        lock.unlock();
+        cv_.notify_all();
+        return true;
+    }
+
+    // True if `frame` is decoded and waiting in the ring.
+    bool isReady(int frame) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& slot : slots_) {
+            if (slot.state == Slot::Ready && slot.frame == frame) return true;
+        }
+        return false;
+    }
+
+    HapReadAheadStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        HapReadAheadStats stats = stats_;
+        stats.ready = 0;
+        for (const auto& slot : slots_) stats.ready += slot.state == Slot::Ready;
+        return stats;
+    }
+
+private:
+    struct Slot {
+        enum State { Free, Decoding, Ready };
+        State state = Free;
+        int frame = -1;
+        double decodeMs = 0.0;
+        int chunkCount = -1;
+        std::vector<uint8_t> data;
+    };
+
+    // Worker-owned (opened in start(), closed after the worker joins)
+    MovParser parser_;
+    const MovTrack* track_ = nullptr;
+    HapDecoder decoder_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    int totalFrames_ = 0;
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;       // wakes the worker
+    std::condition_variable doneCv_;   // a decode finished
+    std::vector<Slot> slots_;
+    HapReadAheadStats stats_;
+    int playhead_ = 0;
+    double stride_ = 1.0;
+    bool loop_ = false;
+    int failedFrame_ = -1;             // don't retry a frame that failed to decode
+    bool stop_ = false;
+
+    // The k-th frame after the playhead (k >= 1), or -1 past a non-looping end.
+    int predict(int k) const {
+        const double step = std::max(1.0, std::fabs(stride_));
+        const int dir = stride_ < 0 ? -1 : 1;
+        long f = playhead_ + dir * std::lround(k * step);
+        if (loop_) {
+            f %= totalFrames_;
+            if (f < 0) f += totalFrames_;
+        } else if (f < 0 || f >= totalFrames_) {
+            return -1;
+        }
+        return static_cast<int>(f);
+    }
+
+    bool isWanted(int frame) const {
+        for (int k = 1; k <= static_cast<int>(slots_.size()); k++) {
+            const int f = predict(k);
+            if (f < 0) break;
+            if (f == frame) return true;
+        }
+        return false;
+    }
+
+    bool inRing(int frame) const {
+        for (const auto& slot : slots_) {
+            if (slot.state != Slot::Free && slot.frame == frame) return true;
+        }
+        return false;
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            // Drop ready frames the playhead has moved away from.
+            for (auto& slot : slots_) {
+                if (slot.state == Slot::Ready && !isWanted(slot.frame)) {
+                    slot.state = Slot::Free;
+                    stats_.discarded++;
+                }
+            }
+
+            // Nearest predicted frame that isn't in the ring yet.
+            int frame = -1;
+            for (int k = 1; k <= static_cast<int>(slots_.size()); k++) {
+                const int f = predict(k);
+                if (f < 0) break;
+                if (!inRing(f) && f != failedFrame_) {
+                    frame = f;
+                    break;
+                }
+            }
+            Slot* slot = nullptr;
+            if (frame >= 0) {
+                for (auto& s : slots_) {
+                    if (s.state == Slot::Free) { slot = &s; break; }
+                }
+            }
+            if (!slot) {
+                cv_.wait(lock);
+                continue;
+            }
+
+            slot->state = Slot::Decoding;
+            slot->frame = frame;
+            const int direction = stride_ < 0 ? -1 : (stride_ > 0 ? 1 : 0);
+            lock.unlock();
+
+            const auto t0 = std::chrono::steady_clock::now();
+            parser_.adviseSamples(*track_, static_cast<size_t>(frame), direction, slots_.size());
+            const auto sample = parser_.getSample(*track_, static_cast<size_t>(frame));
+            HapFormat format;
+            const bool ok = !sample.empty()
+                && decoder_.decodeToBuffer(sample.data(), sample.size(), width_, height_,
+                                           slot->data.data(), slot->data.size(), format);
+            const auto t1 = std::chrono::steady_clock::now();
+
+            lock.lock();
+            slot->decodeMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            slot->chunkCount = decoder_.getLastChunkCount();
+            slot->state = ok ? Slot::Ready : Slot::Free;
+            failedFrame_ = ok ? -1 : frame;
+            doneCv_.notify_all();
+        }
+    }
+};
+
+} // namespace tcx::hap
@@ -5,13 +5,21 @@
 // =============================================================================
 // Parses MOV container to extract video/audio track information and frame data.
 // Designed for HAP codec support but works with any MOV file.
+//
+// The file is memory-mapped (trussc::MappedFile): getSample() returns a span
+// straight into the mapping, so decoders read frames without a copy and
+// several players on the same file share the OS page cache. adviseSamples()
+// turns the playback direction into readahead hints.
 
+#include "tc/utils/tcMappedFile.h"
 #include <string>
 #include <vector>
-#include <fstream>
 #include <cstdint>
 #include <memory>
 #include <cstring>
+#include <span>
+#include <algorithm>
+#include <utility>
 
 namespace tcx::hap {
 
@@ -169,18 +177,16 @@ public:
 
     MovParser(MovParser&& other) noexcept
         : file_(std::move(other.file_))
-        , fileSize_(other.fileSize_)
-        , info_(std::move(other.info_)) {
-        other.fileSize_ = 0;
+        , info_(std::move(other.info_))
+        , advisedDirection_(other.advisedDirection_) {
     }
 
     MovParser& operator=(MovParser&& other) noexcept {
         if (this != &other) {
             close();
             file_ = std::move(other.file_);
-            fileSize_ = other.fileSize_;
             info_ = std::move(other.info_);
-            other.fileSize_ = 0;
+            advisedDirection_ = other.advisedDirection_;
         }
         return *this;
     }
@@ -188,41 +194,94 @@ public:
     bool open(const tc::fs::path& path) {
         close();
 
-        // Create a completely fresh fstream object (not reusing old one)
-        file_ = std::ifstream(path, std::ios::binary);
-        if (!file_.is_open()) return false;
+        if (!file_.open(path)) return false;
+        pos_ = 0;
 
-        // Get file size
-        file_.seekg(0, std::ios::end);
-        fileSize_ = file_.tellg();
-        file_.seekg(0, std::ios::beg);
-
-        return parse();
+        // Atoms are read once, front to back
+        file_.advise(trussc::MappedFile::Access::Sequential);
+        bool ok = parse();
+        file_.advise(trussc::MappedFile::Access::Normal);
+        advisedDirection_ = 0;
+        return ok;
     }
 
     void close() {
-        if (file_.is_open()) {
-            file_.close();
-        }
-        // Reset to fresh state by assigning default-constructed object
-        file_ = std::ifstream();
+        file_.close();
         info_ = MovInfo();
+        pos_ = 0;
+        advisedDirection_ = 0;
     }
 
-    bool isOpen() const { return file_.is_open(); }
+    bool isOpen() const { return file_.isOpen(); }
     const MovInfo& getInfo() const { return info_; }
 
-    // Read sample data from file
-    bool readSample(const MovTrack& track, size_t sampleIndex, std::vector<uint8_t>& data) {
-        if (sampleIndex >= track.samples.size()) return false;
+    // Sample bytes inside the mapped file (no copy). Valid until close();
+    // empty if the index is out of range or the sample runs past the end of
+    // the file.
+    std::span<const uint8_t> getSample(const MovTrack& track, size_t sampleIndex) const {
+        if (sampleIndex >= track.samples.size()) return {};
 
         const auto& sample = track.samples[sampleIndex];
-        data.resize(sample.size);
+        if (sample.offset > fileSize() || sample.size > fileSize() - sample.offset) return {};
+        return {file_.data() + sample.offset, sample.size};
+    }
 
-        file_.seekg(sample.offset);
-        file_.read(reinterpret_cast<char*>(data.data()), sample.size);
+    // Read sample data from file (copy of getSample())
+    bool readSample(const MovTrack& track, size_t sampleIndex, std::vector<uint8_t>& data) const {
+        if (sampleIndex >= track.samples.size()) return false;
 
-        return file_.good();
+        auto sample = getSample(track, sampleIndex);
+        if (sample.size() != track.samples[sampleIndex].size) return false;
+        data.assign(sample.begin(), sample.end());
+        return true;
+    }
+
+    // Readahead hints for playing `track` from `sampleIndex`: direction > 0
+    // forward, < 0 reverse, 0 = paused / scrubbing. Asks the OS to page in
+    // the next `count` samples in that direction, and switches the whole
+    // file to sequential readahead when playing forward (the kernel only
+    // reads ahead forward, so reverse and scrubbing use random access).
+    void adviseSamples(const MovTrack& track, size_t sampleIndex, int direction,
+                       size_t count) {
+        const size_t total = track.samples.size();
+        if (!file_.isOpen() || sampleIndex >= total) return;
+
+        direction = direction > 0 ? 1 : (direction < 0 ? -1 : 0);
+        if (direction != advisedDirection_) {
+            file_.advise(direction > 0 ? trussc::MappedFile::Access::Sequential
+                                       : trussc::MappedFile::Access::Random);
+            advisedDirection_ = direction;
+        }
+        const auto [begin, end] = adviseRange(track, sampleIndex, direction, count);
+        if (begin < end) {
+            file_.advise(trussc::MappedFile::Access::WillNeed, (size_t)begin, (size_t)(end - begin));
+        }
+    }
+
+    // The bytes adviseSamples() pages in: [begin, end) over the `count`
+    // samples from `sampleIndex` in `direction` (reverse counts back, paused
+    // reads forward), clamped to the first / last sample and the file.
+    // Empty (begin >= end) for count 0 or an index past the end.
+    std::pair<uint64_t, uint64_t> adviseRange(const MovTrack& track, size_t sampleIndex,
+                                              int direction, size_t count) const {
+        const size_t total = track.samples.size();
+        if (count == 0 || sampleIndex >= total) return {0, 0};
+
+        // Byte range covering the upcoming samples (usually contiguous)
+        size_t first = sampleIndex, last = sampleIndex;
+        if (direction < 0) {
+            first = sampleIndex >= count - 1 ? sampleIndex - (count - 1) : 0;
+        } else {
+            last = std::min(total - 1, sampleIndex + count - 1);
+        }
+        uint64_t begin = UINT64_MAX, end = 0;
+        for (size_t i = first; i <= last; i++) {
+            const auto& sample = track.samples[i];
+            begin = std::min(begin, sample.offset);
+            end = std::max(end, sample.offset + sample.size);
+        }
+        end = std::min<uint64_t>(end, fileSize());
+        return {begin, end};
     }
 
     // Static helper to check if file is HAP without full parse
@@ -243,21 +302,35 @@ public:
     }
 
 private:
-    std::ifstream file_;
-    uint64_t fileSize_ = 0;
+    trussc::MappedFile file_;
     MovInfo info_;
+    uint64_t pos_ = 0;          // parse cursor
+    int advisedDirection_ = 0;  // last direction passed to adviseSamples()
+
+    uint64_t fileSize() const { return file_.size(); }
+
+    void skip(uint64_t bytes) { pos_ += bytes; }
+
+    // Read big-endian integers straight from the mapping. Reads past the
+    // end of the file return 0 (the atom bounds checks stop parsing).
+    uint8_t readU8() {
+        uint8_t v = pos_ < fileSize() ? file_.data()[pos_] : 0;
+        pos_++;
+        return v;
+    }
 
-    // Read big-endian integers
     uint16_t readU16() {
-        uint8_t buf[2];
-        file_.read(reinterpret_cast<char*>(buf), 2);
-        return (buf[0] << 8) | buf[1];
+        if (pos_ + 2 > fileSize()) { pos_ += 2; return 0; }
+        const uint8_t* p = file_.data() + pos_;
+        pos_ += 2;
+        return (p[0] << 8) | p[1];
     }
 
     uint32_t readU32() {
-        uint8_t buf[4];
-        file_.read(reinterpret_cast<char*>(buf), 4);
-        return (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+        if (pos_ + 4 > fileSize()) { pos_ += 4; return 0; }
+        const uint8_t* p = file_.data() + pos_;
+        pos_ += 4;
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
     }
 
     uint64_t readU64() {
@@ -274,8 +347,8 @@ private:
 
     // Parse entire file
     bool parse() {
-        while (file_.tellg() < static_cast<std::streampos>(fileSize_)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < fileSize()) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -292,30 +365,30 @@ private:
                 dataSize = extSize - 16;
             } else if (atomSize == 0) {
                 // Atom extends to end of file
-                dataSize = fileSize_ - file_.tellg();
+                dataSize = fileSize() - pos_;
             } else {
                 dataSize = atomSize - 8;
             }
 
-            uint64_t atomEnd = static_cast<uint64_t>(file_.tellg()) + dataSize;
+            uint64_t atomEnd = pos_ + dataSize;
 
             // Progress guard: atom must advance past its start and stay within file.
-            if (atomEnd <= atomStart || atomEnd > fileSize_) break;
+            if (atomEnd <= atomStart || atomEnd > fileSize()) break;
 
             if (atomType == ATOM_MOOV) {
                 parseMoov(atomEnd);
             }
 
             // Skip to next atom
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
 
         return !info_.tracks.empty();
     }
 
     void parseMoov(uint64_t endPos) {
-        while (file_.tellg() < static_cast<std::streampos>(endPos)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < endPos) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -328,20 +401,20 @@ private:
                 parseTrak(atomEnd);
             }
 
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
     }
 
     void parseMvhd() {
-        uint8_t version = file_.get();
-        file_.seekg(3, std::ios::cur); // flags
+        uint8_t version = readU8();
+        skip(3); // flags
 
         if (version == 1) {
-            file_.seekg(16, std::ios::cur); // creation/modification time
+            skip(16); // creation/modification time
             info_.timescale = readU32();
             info_.duration = readU64();
         } else {
-            file_.seekg(8, std::ios::cur); // creation/modification time
+            skip(8); // creation/modification time
             info_.timescale = readU32();
             info_.duration = readU32();
         }
@@ -350,8 +423,8 @@ private:
     void parseTrak(uint64_t endPos) {
         MovTrack track;
 
-        while (file_.tellg() < static_cast<std::streampos>(endPos)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < endPos) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -364,7 +437,7 @@ private:
                 parseMdia(track, atomEnd);
             }
 
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
 
         // Build sample table with timestamps
@@ -376,35 +449,35 @@ private:
     }
 
     void parseTkhd(MovTrack& track) {
-        uint8_t version = file_.get();
-        file_.seekg(3, std::ios::cur); // flags
+        uint8_t version = readU8();
+        skip(3); // flags
 
         if (version == 1) {
-            file_.seekg(16, std::ios::cur); // creation/modification time
+            skip(16); // creation/modification time
             track.trackId = readU32();
-            file_.seekg(4, std::ios::cur); // reserved
-            file_.seekg(8, std::ios::cur); // duration
+            skip(4); // reserved
+            skip(8); // duration
         } else {
-            file_.seekg(8, std::ios::cur); // creation/modification time
+            skip(8); // creation/modification time
             track.trackId = readU32();
-            file_.seekg(4, std::ios::cur); // reserved
-            file_.seekg(4, std::ios::cur); // duration
+            skip(4); // reserved
+            skip(4); // duration
         }
 
-        file_.seekg(8, std::ios::cur);  // reserved
-        file_.seekg(2, std::ios::cur);  // layer
-        file_.seekg(2, std::ios::cur);  // alternate group
-        file_.seekg(2, std::ios::cur);  // volume
-        file_.seekg(2, std::ios::cur);  // reserved
-        file_.seekg(36, std::ios::cur); // matrix
+        skip(8);  // reserved
+        skip(2);  // layer
+        skip(2);  // alternate group
+        skip(2);  // volume
+        skip(2);  // reserved
+        skip(36); // matrix
 
         track.width = static_cast<uint32_t>(readFixed32());
         track.height = static_cast<uint32_t>(readFixed32());
     }
 
     void parseMdia(MovTrack& track, uint64_t endPos) {
-        while (file_.tellg() < static_cast<std::streampos>(endPos)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < endPos) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -419,34 +492,34 @@ private:
                 parseMinf(track, atomEnd);
             }
 
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
     }
 
     void parseMdhd(MovTrack& track) {
-        uint8_t version = file_.get();
-        file_.seekg(3, std::ios::cur); // flags
+        uint8_t version = readU8();
+        skip(3); // flags
 
         if (version == 1) {
-            file_.seekg(16, std::ios::cur); // creation/modification time
+            skip(16); // creation/modification time
             track.timescale = readU32();
             track.duration = readU64();
         } else {
-            file_.seekg(8, std::ios::cur); // creation/modification time
+            skip(8); // creation/modification time
             track.timescale = readU32();
             track.duration = readU32();
         }
     }
 
     void parseHdlr(MovTrack& track) {
-        file_.seekg(4, std::ios::cur); // version + flags
-        file_.seekg(4, std::ios::cur); // pre_defined
+        skip(4); // version + flags
+        skip(4); // pre_defined
         track.handlerType = readU32();
     }
 
     void parseMinf(MovTrack& track, uint64_t endPos) {
-        while (file_.tellg() < static_cast<std::streampos>(endPos)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < endPos) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -457,7 +530,7 @@ private:
                 parseStbl(track, atomEnd);
             }
 
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
     }
 
@@ -468,8 +541,8 @@ private:
         std::vector<std::pair<uint32_t, uint32_t>> sampleToChunk; // firstChunk, samplesPerChunk
         std::vector<std::pair<uint32_t, uint32_t>> timeToSample;  // count, delta
 
-        while (file_.tellg() < static_cast<std::streampos>(endPos)) {
-            uint64_t atomStart = file_.tellg();
+        while (pos_ < endPos) {
+            uint64_t atomStart = pos_;
             uint32_t atomSize = readU32();
             uint32_t atomType = readU32();
 
@@ -490,7 +563,7 @@ private:
                 parseCo64(chunkOffsets);
             }
 
-            file_.seekg(atomEnd);
+            pos_ = atomEnd;
         }
 
         // Build sample list
@@ -498,40 +571,40 @@ private:
     }
 
     void parseStsd(MovTrack& track) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t entryCount = readU32();
 
         if (entryCount > 0) {
             uint32_t entrySize = readU32();
             track.codecFourCC = readU32();
 
-            file_.seekg(6, std::ios::cur);  // reserved
-            file_.seekg(2, std::ios::cur);  // data reference index
+            skip(6);  // reserved
+            skip(2);  // data reference index
 
             if (track.isVideo()) {
-                file_.seekg(2, std::ios::cur);  // version
-                file_.seekg(2, std::ios::cur);  // revision
-                file_.seekg(4, std::ios::cur);  // vendor
-                file_.seekg(4, std::ios::cur);  // temporal quality
-                file_.seekg(4, std::ios::cur);  // spatial quality
+                skip(2);  // version
+                skip(2);  // revision
+                skip(4);  // vendor
+                skip(4);  // temporal quality
+                skip(4);  // spatial quality
                 track.width = readU16();
                 track.height = readU16();
             } else if (track.isAudio()) {
-                file_.seekg(2, std::ios::cur);  // version
-                file_.seekg(2, std::ios::cur);  // revision
-                file_.seekg(4, std::ios::cur);  // vendor
+                skip(2);  // version
+                skip(2);  // revision
+                skip(4);  // vendor
                 track.channels = readU16();
                 track.bitsPerSample = readU16();
-                file_.seekg(2, std::ios::cur);  // compression id
-                file_.seekg(2, std::ios::cur);  // packet size
+                skip(2);  // compression id
+                skip(2);  // packet size
                 track.sampleRate = readU16();   // Only integer part
-                file_.seekg(2, std::ios::cur);  // Fixed point fraction
+                skip(2);  // Fixed point fraction
             }
         }
     }
 
     void parseStts(std::vector<std::pair<uint32_t, uint32_t>>& timeToSample) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t entryCount = readU32();
 
         timeToSample.reserve(entryCount);
@@ -543,20 +616,20 @@ private:
     }
 
     void parseStsc(std::vector<std::pair<uint32_t, uint32_t>>& sampleToChunk) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t entryCount = readU32();
 
         sampleToChunk.reserve(entryCount);
         for (uint32_t i = 0; i < entryCount; i++) {
             uint32_t firstChunk = readU32();
             uint32_t samplesPerChunk = readU32();
-            file_.seekg(4, std::ios::cur); // sample description index
+            skip(4); // sample description index
             sampleToChunk.push_back({firstChunk, samplesPerChunk});
         }
     }
 
     void parseStsz(std::vector<uint32_t>& sampleSizes) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t sampleSize = readU32();
         uint32_t sampleCount = readU32();
 
@@ -575,7 +648,7 @@ private:
     }
 
     void parseStco(std::vector<uint64_t>& chunkOffsets) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t entryCount = readU32();
 
         chunkOffsets.reserve(entryCount);
@@ -585,7 +658,7 @@ private:
     }
 
     void parseCo64(std::vector<uint64_t>& chunkOffsets) {
-        file_.seekg(4, std::ios::cur); // version + flags
+        skip(4); // version + flags
         uint32_t entryCount = readU32();
 
         chunkOffsets.reserve(entryCount);
@@ -0,0 +1,652 @@
+// =============================================================================
+// tcxHap tests - headless chunk-decode test + latency benchmark (no window).
+//
+// Built and run by CI on every push/PR across macOS / Windows / Linux via
+// examples/build_all.py --addon-tests-only (exit 0 = pass, non-zero = fail).
+//
+// Encodes synthetic 4K HAP / HAP Alpha frames with the reference encoder
+// (Snappy, 1-16 chunks) and checks HapDecoder gets the texture back exactly
+// through the shared chunk pool:
+//   - every chunk count, both formats, round-trips byte for byte
+//   - getLastChunkCount() reports the frame's chunk count
+//   - setDecodeThreadCount() resizes the pool (0 = inline) and decoding
+//     stays exact at every size
+//   - two decoders on two threads at once both decode exactly
+//   - MovParser maps a small generated .mov: getSample() returns the frame
+//     bytes in place (no copy), readSample() copies the same bytes, and
+//     out-of-range or truncated samples come back empty
+//   - HapReadAhead, on the same .mov: frames ahead of the playhead
+//     are decoded in the background forward, in reverse, across the loop
+//     point and at stride 2; a seek discards stale frames and counts the
+//     frame that wasn't ready as late
+//   - decodeBlocksToRgba() (getPixels) matches bcdec + the scalar YCoCg
+//     conversion byte for byte for every format, on sizes that aren't a
+//     multiple of 4, with one thread and with the whole pool
+// Then prints per-frame decode latency percentiles for the pool against the
+// old thread-per-chunk callback, and 4K HAP Q getPixels() time against the
+// old single-threaded per-pixel path. Timings never fail the test.
+// =============================================================================
+
+#include <TrussC.h>
+#include "tcxHapDecoder.h"
+#include "tcxHapReadAhead.h"
+#include "tcxHapPixels.h"
+#include "impl/bcdec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace tcx::hap;
+
+static int g_pass = 0, g_fail = 0;
+static void check(const char* name, bool ok) {
+    std::printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    std::fflush(stdout);  // flush each line so CI logs survive a later timeout
+    ok ? ++g_pass : ++g_fail;
+}
+
+constexpr uint32_t WIDTH = 3840;
+constexpr uint32_t HEIGHT = 2160;
+
+// BC texture data that compresses roughly like real footage: smooth
+// gradients (repeating endpoints) with a noisy index field.
+static std::vector<uint8_t> makeTexture(HapFormat format, uint32_t seed) {
+    std::vector<uint8_t> tex(calculateTextureSize(WIDTH, HEIGHT, format));
+    const size_t blockBytes = getBytesPerBlock(format);
+    const uint32_t blocksX = (WIDTH + 3) / 4;
+    for (size_t b = 0; b < tex.size() / blockBytes; b++) {
+        uint8_t* block = tex.data() + b * blockBytes;
+        const uint32_t bx = (uint32_t)(b % blocksX), by = (uint32_t)(b / blocksX);
+        for (size_t i = 0; i < blockBytes; i++) {
+            seed = seed * 1103515245u + 12345u;
+            const bool endpoint = (i % 8) < 4;
+            block[i] = endpoint ? (uint8_t)((bx / 8 + by / 8 + i) & 0xFF)
+                                : (uint8_t)((seed >> 16) & ((b & 3) ? 0x0F : 0xFF));
+        }
+    }
+    return tex;
+}
+
+static unsigned int hapTextureFormat(HapFormat format) {
+    return format == HapFormat::DXT5 ? HapTextureFormat_RGBA_DXT5 : HapTextureFormat_RGB_DXT1;
+}
+
+static std::vector<uint8_t> encodeFrame(const std::vector<uint8_t>& tex, HapFormat format,
+                                        unsigned int chunks) {
+    const void* input = tex.data();
+    unsigned long inputBytes = (unsigned long)tex.size();
+    unsigned int textureFormat = hapTextureFormat(format);
+    unsigned int compressor = HapCompressorSnappy;
+    unsigned int chunkCount = chunks;
+
+    std::vector<uint8_t> frame(HapMaxEncodedLength(1, &inputBytes, &textureFormat, &chunkCount));
+    unsigned long used = 0;
+    const unsigned int result = HapEncode(1, &input, &inputBytes, &textureFormat, &compressor,
+                                          &chunkCount, frame.data(), (unsigned long)frame.size(),
+                                          &used);
+    if (result != HapResult_No_Error) return {};
+    frame.resize(used);
+    return frame;
+}
+
+static bool decodesExactly(HapDecoder& decoder, const std::vector<uint8_t>& frame,
+                           const std::vector<uint8_t>& tex, HapFormat format) {
+    std::vector<uint8_t> out(tex.size());
+    HapFormat outFormat = HapFormat::Unknown;
+    return decoder.decodeToBuffer(frame.data(), frame.size(), WIDTH, HEIGHT,
+                                  out.data(), out.size(), outFormat)
+        && outFormat == format && out == tex;
+}
+
+// --- correctness --------------------------------------------------------------
+
+static void testRoundTrip() {
+    std::printf("\n--- round trip through the chunk pool (%d workers) ---\n",
+                HapDecoder::getDecodeThreadCount());
+    for (HapFormat format : {HapFormat::DXT1, HapFormat::DXT5}) {
+        const auto tex = makeTexture(format, 7);
+        bool exact = true, counted = true;
+        for (unsigned int chunks : {1u, 2u, 4u, 7u, 16u}) {
+            const auto frame = encodeFrame(tex, format, chunks);
+            HapDecoder decoder;
+            exact = exact && !frame.empty() && decodesExactly(decoder, frame, tex, format);
+            counted = counted && decoder.getLastChunkCount() == (int)chunks;
+        }
+        const char* name = format == HapFormat::DXT1 ? "HAP" : "HAP Alpha";
+        char label[96];
+        std::snprintf(label, sizeof(label), "%s 4K, 1-16 chunks: decoded texture is exact", name);
+        check(label, exact);
+        std::snprintf(label, sizeof(label), "%s 4K: getLastChunkCount() matches the frame", name);
+        check(label, counted);
+    }
+}
+
+static void testPoolSize() {
+    std::printf("\n--- pool size ---\n");
+    const auto tex = makeTexture(HapFormat::DXT1, 11);
+    const auto frame = encodeFrame(tex, HapFormat::DXT1, 16);
+    const int original = HapDecoder::getDecodeThreadCount();
+
+    bool sizes = true, exact = true;
+    for (int threads : {0, 1, 3}) {
+        HapDecoder::setDecodeThreadCount(threads);
+        sizes = sizes && HapDecoder::getDecodeThreadCount() == threads;
+        HapDecoder decoder;
+        exact = exact && decodesExactly(decoder, frame, tex, HapFormat::DXT1);
+    }
+    HapDecoder::setDecodeThreadCount(original);
+    check("setDecodeThreadCount() resizes the shared pool (0 = inline)", sizes);
+    check("16-chunk frame decodes exactly at every pool size", exact);
+}
+
+static void testConcurrentDecoders() {
+    std::printf("\n--- two decoders at once ---\n");
+    const auto texA = makeTexture(HapFormat::DXT1, 21);
+    const auto texB = makeTexture(HapFormat::DXT5, 22);
+    const auto frameA = encodeFrame(texA, HapFormat::DXT1, 16);
+    const auto frameB = encodeFrame(texB, HapFormat::DXT5, 8);
+
+    bool okA = true, okB = true;
+    std::thread other([&] {
+        HapDecoder decoder;
+        for (int i = 0; i < 20; i++) okB = okB && decodesExactly(decoder, frameB, texB, HapFormat::DXT5);
+    });
+    HapDecoder decoder;
+    for (int i = 0; i < 20; i++) okA = okA && decodesExactly(decoder, frameA, texA, HapFormat::DXT1);
+    other.join();
+    check("decoders on two threads sharing the pool both stay exact", okA && okB);
+}
+
+// --- read-ahead ---------------------------------------------------------------
+
+constexpr uint32_t SMALL_W = 256;
+constexpr uint32_t SMALL_H = 128;
+constexpr int MOV_FRAMES = 24;
+
+static void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back((uint8_t)(v >> shift));
+}
+
+// Wrap `payload` in an atom of type `type`.
+static std::vector<uint8_t> atom(const char* type, const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> out;
+    putU32(out, (uint32_t)(payload.size() + 8));
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    return out;
+}
+
+static std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts) {
+    std::vector<uint8_t> out;
+    for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+    return out;
+}
+
+// Minimal QuickTime file: one Hap1 video track, every frame in one chunk.
+// Only the atoms MovParser reads are written.
+static bool writeMov(const tc::fs::path& path, const std::vector<std::vector<uint8_t>>& frames) {
+    auto build = [&](uint32_t mdatOffset) {
+        std::vector<uint8_t> mdhd(4 + 8, 0);
+        putU32(mdhd, 600);                          // timescale
+        putU32(mdhd, 600u * (uint32_t)frames.size() / 30);
+        std::vector<uint8_t> hdlr(8, 0);
+        hdlr.insert(hdlr.end(), {'v', 'i', 'd', 'e'});
+        std::vector<uint8_t> stsd(4, 0);
+        putU32(stsd, 1);
+        putU32(stsd, 8 + 8 + 16 + 4);               // entry size
+        stsd.insert(stsd.end(), {'H', 'a', 'p', '1'});
+        stsd.insert(stsd.end(), 6 + 2 + 16, 0);
+        stsd.insert(stsd.end(), {(uint8_t)(SMALL_W >> 8), (uint8_t)SMALL_W,
+                                 (uint8_t)(SMALL_H >> 8), (uint8_t)SMALL_H});
+        std::vector<uint8_t> stsc(4, 0);
+        putU32(stsc, 1);
+        putU32(stsc, 1);
+        putU32(stsc, (uint32_t)frames.size());
+        putU32(stsc, 1);
+        std::vector<uint8_t> stsz(4, 0);
+        putU32(stsz, 0);
+        putU32(stsz, (uint32_t)frames.size());
+        for (const auto& f : frames) putU32(stsz, (uint32_t)f.size());
+        std::vector<uint8_t> stco(4, 0);
+        putU32(stco, 1);
+        putU32(stco, mdatOffset);
+
+        const auto stbl = atom("stbl", concat({atom("stsd", stsd), atom("stsc", stsc),
+                                               atom("stsz", stsz), atom("stco", stco)}));
+        const auto mdia = atom("mdia", concat({atom("mdhd", mdhd), atom("hdlr", hdlr),
+                                               atom("minf", stbl)}));
+        return atom("moov", atom("trak", mdia));
+    };
+    const auto moov = build(0);
+    const auto header = build((uint32_t)moov.size() + 8);  // same size, real offset
+
+    std::vector<uint8_t> mdat;
+    for (const auto& f : frames) mdat.insert(mdat.end(), f.begin(), f.end());
+
+    std::ofstream out(path, std::ios::binary);
+    const auto file = concat({header, atom("mdat", mdat)});
+    out.write(reinterpret_cast<const char*>(file.data()), (std::streamsize)file.size());
+    return out.good();
+}
+
+// A small DXT1 texture whose every byte identifies its frame.
+static std::vector<uint8_t> smallTexture(int frame) {
+    std::vector<uint8_t> tex(calculateTextureSize(SMALL_W, SMALL_H, HapFormat::DXT1));
+    for (size_t i = 0; i < tex.size(); i++) tex[i] = (uint8_t)(frame * 7 + (i & 0x3F));
+    return tex;
+}
+
+// Wait (up to 5 s) until the worker has decoded `frame`.
+static bool waitReady(const HapReadAhead& ring, int frame) {
+    for (int i = 0; i < 5000; i++) {
+        if (ring.isReady(frame)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Play `frames` in order the way HapPlayer::update() does: take each from
+// the ring, then move the playhead onto it. True if every take hit and
+// every frame came back exact.
+static bool playThrough(HapReadAhead& ring, const std::vector<std::vector<uint8_t>>& textures,
+                        std::initializer_list<int> frames, double stride, bool loop) {
+    std::vector<uint8_t> shown(textures[0].size());
+    bool ok = true;
+    for (int frame : frames) {
+        ok = ok && waitReady(ring, frame);
+        double ms = 0.0;
+        int chunks = 0;
+        ok = ok && ring.take(frame, shown, ms, chunks) && shown == textures[(size_t)frame]
+            && chunks == 1;
+        ring.setPlayhead(frame, stride, loop);
+    }
+    return ok;
+}
+
+static void testMovParser(const tc::fs::path& path, const std::vector<std::vector<uint8_t>>& frames) {
+    std::printf("\n--- mapped MOV parser ---\n");
+    MovParser parser;
+    const bool opened = parser.open(path);
+    const MovTrack* track = opened ? parser.getInfo().getVideoTrack() : nullptr;
+    check("open() maps and parses the movie",
+          track && track->isHap() && track->width == SMALL_W && track->height == SMALL_H
+          && track->samples.size() == frames.size());
+    if (!track) return;
+
+    bool same = true, inPlace = true, copies = true;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const auto sample = parser.getSample(*track, i);
+        same = same && std::equal(sample.begin(), sample.end(), frames[i].begin(), frames[i].end());
+        inPlace = inPlace && sample.data() == parser.getSample(*track, i).data();
+        std::vector<uint8_t> copy;
+        copies = copies && parser.readSample(*track, i, copy) && copy == frames[i];
+    }
+    check("getSample() returns every frame's bytes", same);
+    check("getSample() is a view into the mapping, not a copy", inPlace);
+    check("readSample() copies the same bytes", copies);
+
+    std::vector<uint8_t> copy;
+    check("out-of-range sample is empty / fails",
+          parser.getSample(*track, frames.size()).empty()
+          && !parser.readSample(*track, frames.size(), copy));
+
+    // Hints only: the advised bytes stop at the first / last sample, and
+    // the mapping reads the same afterwards.
+    const auto& s = track->samples;
+    const size_t lastIndex = frames.size() - 1;
+    const auto bytes = [&](size_t first, size_t last) {
+        return std::make_pair(s[first].offset, s[last].offset + s[last].size);
+    };
+    check("adviseRange() forward covers the next samples",
+          parser.adviseRange(*track, 0, 1, 4) == bytes(0, 3));
+    check("adviseRange() forward / reverse clamped at the file ends",
+          parser.adviseRange(*track, lastIndex, 1, 8) == bytes(lastIndex, lastIndex)
+          && parser.adviseRange(*track, 2, -1, 8) == bytes(0, 2));
+    const auto none = parser.adviseRange(*track, 5, 0, 0);
+    const auto past = parser.adviseRange(*track, frames.size(), 1, 8);
+    check("adviseRange() empty for count 0 / past the end",
+          none.first >= none.second && past.first >= past.second);
+    parser.adviseSamples(*track, 0, 1, 8);
+    parser.adviseSamples(*track, lastIndex, 1, 8);
+    parser.adviseSamples(*track, 2, -1, 8);
+    parser.adviseSamples(*track, 5, 0, 0);
+    bool unchanged = true;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const auto sample = parser.getSample(*track, i);
+        unchanged = unchanged && std::equal(sample.begin(), sample.end(), frames[i].begin(), frames[i].end());
+    }
+    check("adviseSamples() leaves every sample's bytes as they were", unchanged);
+
+    MovTrack truncated = *track;
+    truncated.samples.back().size += 1u << 20;   // runs past the end of the file
+    check("sample running past the end of the file is empty / fails",
+          parser.getSample(truncated, frames.size() - 1).empty()
+          && !parser.readSample(truncated, frames.size() - 1, copy));
+
+    MovParser moved(std::move(parser));
+    const auto sample = moved.getSample(*moved.getInfo().getVideoTrack(), 3);
+    check("moved parser keeps the mapping",
+          std::equal(sample.begin(), sample.end(), frames[3].begin(), frames[3].end()));
+}
+
+static void testReadAhead(const tc::fs::path& path, const std::vector<std::vector<uint8_t>>& textures) {
+    std::printf("\n--- read-ahead ring ---\n");
+
+    HapReadAhead ring;
+    const size_t frameBytes = textures[0].size();
+    check("start() opens the movie and starts the worker",
+          ring.start(path, SMALL_W, SMALL_H, frameBytes, 4) && ring.isRunning());
+
+    ring.setPlayhead(0, 1.0, false);
+    check("fills the ring with the next 4 frames",
+          waitReady(ring, 4) && ring.getStats().ready == 4);
+    check("forward: frames 1-6 come from the ring, exact",
+          playThrough(ring, textures, {1, 2, 3, 4, 5, 6}, 1.0, false));
+
+    ring.setPlayhead(6, -1.0, false);
+    check("reverse: frames 5-0 come from the ring, exact",
+          playThrough(ring, textures, {5, 4, 3, 2, 1, 0}, -1.0, false));
+
+    ring.setPlayhead(0, -1.0, true);
+    check("reverse loop: wraps from 0 to the last frame",
+          playThrough(ring, textures, {MOV_FRAMES - 1, MOV_FRAMES - 2}, -1.0, true));
+
+    ring.setPlayhead(MOV_FRAMES - 2, 1.0, true);
+    check("forward loop: wraps from the last frame to 0",
+          playThrough(ring, textures, {MOV_FRAMES - 1, 0, 1}, 1.0, true));
+
+    ring.setPlayhead(1, 2.0, false);
+    check("stride 2 (double speed): frames 3, 5, 7 come from the ring",
+          playThrough(ring, textures, {3, 5, 7}, 2.0, false));
+
+    ring.setPlayhead(MOV_FRAMES - 1, 1.0, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    check("no read-ahead past a non-looping end", ring.getStats().ready == 0);
+
+    // Seek: nothing near frame 12 is ready, so it's a late frame.
+    ring.setPlayhead(0, 1.0, false);
+    waitReady(ring, 4);
+    const auto before = ring.getStats();
+    std::vector<uint8_t> shown(frameBytes);
+    double ms = 0.0;
+    int chunks = 0;
+    const bool took = ring.take(12, shown, ms, chunks);
+    ring.setPlayhead(12, 1.0, false);
+    const bool refilled = waitReady(ring, 16);
+    const auto after = ring.getStats();
+    check("seek: frame not in the ring is a miss and counts as late",
+          !took && after.lateFrames == before.lateFrames + 1);
+    check("seek: stale frames are discarded and the ring refills",
+          refilled && after.discarded >= before.discarded + 4);
+    check("seek: play on from the new position", playThrough(ring, textures, {13, 14}, 1.0, false));
+
+    const auto stats = ring.getStats();
+    std::printf("  capacity %d, ready %d, avg ready %.2f, hits %llu, late %llu, discarded %llu\n",
+                stats.capacity, stats.ready, stats.averageReady,
+                (unsigned long long)stats.hits, (unsigned long long)stats.lateFrames,
+                (unsigned long long)stats.discarded);
+    check("stats: every played frame counted as a hit", stats.hits == 22 && stats.capacity == 4);
+
+    ring.stop();
+    check("stop() joins the worker", !ring.isRunning() && ring.getStats().capacity == 0);
+}
+
+static void testMovie() {
+    std::vector<std::vector<uint8_t>> textures, frames;
+    for (int i = 0; i < MOV_FRAMES; i++) {
+        textures.push_back(smallTexture(i));
+        frames.push_back(encodeFrame(textures.back(), HapFormat::DXT1, 1));
+    }
+    const auto path = tc::fs::temp_directory_path() / "tcxHap_test.mov";
+    if (!writeMov(path, frames)) {
+        check("write test .mov", false);
+        return;
+    }
+    testMovParser(path, frames);
+    testReadAhead(path, textures);
+    std::error_code ec;
+    tc::fs::remove(path, ec);
+}
+
+// --- BC -> RGBA (getPixels) ------------------------------------------------
+
+// The decode HapPlayer::getPixels() used before tcxHapPixels: bcdec block by
+// block on one thread, then YCoCg -> RGB per pixel. Writes a block-padded
+// image (blocksX * 4 wide) so edge blocks need no clipping.
+static void referenceRgba(const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height,
+                          HapFormat format, std::vector<uint8_t>& out) {
+    const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const int pitch = (int)blocksX * 16;
+    out.assign((size_t)pitch * blocksY * 4, 0);
+    const uint8_t* src = blocks.data();
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            uint8_t* dst = out.data() + (size_t)by * 4 * pitch + bx * 16;
+            switch (format) {
+                case HapFormat::DXT1: bcdec_bc1(src, dst, pitch); break;
+                case HapFormat::DXT5:
+                case HapFormat::YCoCgDXT5: bcdec_bc3(src, dst, pitch); break;
+                case HapFormat::BC7: bcdec_bc7(src, dst, pitch); break;
+                case HapFormat::RGTC1: {
+                    uint8_t r[16];
+                    bcdec_bc4(src, r, 4);
+                    for (int i = 0; i < 16; i++) {
+                        uint8_t* p = dst + (i / 4) * pitch + (i % 4) * 4;
+                        p[0] = p[1] = p[2] = r[i];
+                        p[3] = 255;
+                    }
+                    break;
+                }
+                default: break;
+            }
+            src += getBytesPerBlock(format);
+        }
+    }
+    if (format != HapFormat::YCoCgDXT5) return;
+    for (size_t i = 0; i < out.size(); i += 4) {
+        uint8_t* pixel = out.data() + i;
+        float coRaw = pixel[0] / 255.0f;
+        float cgRaw = pixel[1] / 255.0f;
+        float scaleRaw = pixel[2] / 255.0f;
+        float y = pixel[3] / 255.0f;
+        float scale = (scaleRaw * (255.0f / 8.0f)) + 1.0f;
+        float co = (coRaw - 0.5f) / scale;
+        float cg = (cgRaw - 0.5f) / scale;
+        float r = y + co - cg;
+        float g = y + cg;
+        float b = y - co - cg;
+        pixel[0] = static_cast<uint8_t>(std::clamp(r * 255.0f, 0.0f, 255.0f));
+        pixel[1] = static_cast<uint8_t>(std::clamp(g * 255.0f, 0.0f, 255.0f));
+        pixel[2] = static_cast<uint8_t>(std::clamp(b * 255.0f, 0.0f, 255.0f));
+        pixel[3] = 255;
+    }
+}
+
+// Random block bits: every palette mode and index pattern shows up.
+static std::vector<uint8_t> randomBlocks(uint32_t width, uint32_t height, HapFormat format,
+                                         uint32_t seed) {
+    std::vector<uint8_t> blocks(calculateTextureSize(width, height, format));
+    for (auto& b : blocks) {
+        seed = seed * 1103515245u + 12345u;
+        b = (uint8_t)(seed >> 16);
+    }
+    return blocks;
+}
+
+static bool matchesReference(uint32_t width, uint32_t height, HapFormat format, int maxThreads) {
+    const auto blocks = randomBlocks(width, height, format, width * 31 + height);
+    std::vector<uint8_t> ref;
+    referenceRgba(blocks, width, height, format, ref);
+    const size_t refPitch = (size_t)((width + 3) / 4) * 16;
+
+    std::vector<uint8_t> out((size_t)width * height * 4 + 64, 0xCD);   // + guard bytes
+    if (!decodeBlocksToRgba(blocks.data(), blocks.size(), width, height, format, out.data(),
+                            0, maxThreads)) {
+        return false;
+    }
+    for (uint32_t y = 0; y < height; y++) {
+        if (std::memcmp(out.data() + (size_t)y * width * 4, ref.data() + y * refPitch,
+                        (size_t)width * 4) != 0) {
+            return false;
+        }
+    }
+    return std::all_of(out.end() - 64, out.end(), [](uint8_t b) { return b == 0xCD; });
+}
+
+static void testRgba() {
+    std::printf("\n--- BC -> RGBA (getPixels) ---\n");
+    const struct { HapFormat format; const char* name; } formats[] = {
+        {HapFormat::DXT1, "HAP (BC1)"},
+        {HapFormat::DXT5, "HAP Alpha (BC3)"},
+        {HapFormat::YCoCgDXT5, "HAP Q (YCoCg BC3)"},
+        {HapFormat::BC7, "BC7"},
+        {HapFormat::RGTC1, "HAP A (RGTC1)"},
+    };
+    for (const auto& f : formats) {
+        bool ok = true;
+        for (auto size : {std::pair<uint32_t, uint32_t>{64, 32}, {13, 7}, {1, 1}, {258, 130}}) {
+            ok = ok && matchesReference(size.first, size.second, f.format, 1)
+                    && matchesReference(size.first, size.second, f.format, 0);
+        }
+        char label[96];
+        std::snprintf(label, sizeof(label), "%s: matches bcdec reference, 1 / all threads", f.name);
+        check(label, ok);
+    }
+
+    std::vector<uint8_t> out(16);
+    check("short input / unknown format are rejected",
+          !decodeBlocksToRgba(out.data(), 8, 8, 4, HapFormat::DXT1, out.data())
+          && !decodeBlocksToRgba(out.data(), 16, 4, 4, HapFormat::Unknown, out.data()));
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+// The callback HapDecoder used before the pool: one std::thread per chunk.
+static void threadPerChunkCallback(HapDecodeWorkFunction work, void* p, unsigned int count, void*) {
+    if (count <= 1) {
+        for (unsigned int i = 0; i < count; i++) work(p, i);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned int i = 0; i < count; i++) {
+        threads.emplace_back([work, p, i]() { work(p, i); });
+    }
+    for (auto& t : threads) t.join();
+}
+
+struct Percentiles {
+    double p50, p90, p99, max;
+};
+
+static Percentiles percentiles(std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    auto at = [&](double q) { return ms[(size_t)(q * (double)(ms.size() - 1) + 0.5)]; };
+    return {at(0.50), at(0.90), at(0.99), ms.back()};
+}
+
+template <class Decode>
+static Percentiles timeFrames(const std::vector<std::vector<uint8_t>>& frames, int count, Decode decode) {
+    std::vector<double> ms;
+    ms.reserve((size_t)count);
+    for (int i = 0; i < count; i++) {
+        const auto& frame = frames[(size_t)i % frames.size()];
+        const auto t0 = std::chrono::steady_clock::now();
+        decode(frame);
+        const auto t1 = std::chrono::steady_clock::now();
+        ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return percentiles(std::move(ms));
+}
+
+static void printRow(const char* name, const Percentiles& p) {
+    std::printf("  %-22s p50 %6.2f  p90 %6.2f  p99 %6.2f  max %6.2f ms\n",
+                name, p.p50, p.p90, p.p99, p.max);
+}
+
+static void benchmark() {
+    constexpr unsigned int CHUNKS = 16;
+    constexpr int FRAMES = 240;   // 4 s of 4K60
+    std::printf("\n--- benchmark: 4K HAP, %u chunks, %d frames, %d pool workers ---\n",
+                CHUNKS, FRAMES, HapDecoder::getDecodeThreadCount());
+
+    // A few distinct frames so the input isn't always hot in cache.
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        frames.push_back(encodeFrame(makeTexture(HapFormat::DXT1, seed), HapFormat::DXT1, CHUNKS));
+    }
+    std::vector<uint8_t> out(calculateTextureSize(WIDTH, HEIGHT, HapFormat::DXT1));
+    std::printf("  frame: %.1f MB BC1 -> %.1f MB HAP\n",
+                out.size() / 1048576.0, frames[0].size() / 1048576.0);
+
+    auto viaPool = [&](const std::vector<uint8_t>& frame) {
+        static HapDecoder decoder;
+        HapFormat format;
+        decoder.decodeToBuffer(frame.data(), frame.size(), WIDTH, HEIGHT,
+                               out.data(), out.size(), format);
+    };
+    auto viaThreads = [&](const std::vector<uint8_t>& frame) {
+        unsigned long used = 0;
+        unsigned int format = 0;
+        HapDecode(frame.data(), (unsigned long)frame.size(), 0, threadPerChunkCallback, nullptr,
+                  out.data(), (unsigned long)out.size(), &used, &format);
+    };
+
+    viaPool(frames[0]);   // start the pool's workers outside the timings
+    const auto pool = timeFrames(frames, FRAMES, viaPool);
+    const auto threads = timeFrames(frames, FRAMES, viaThreads);
+    printRow("shared pool", pool);
+    printRow("thread per chunk", threads);
+    std::printf("  p50 speedup %.2fx, p99 speedup %.2fx\n",
+                threads.p50 / pool.p50, threads.p99 / pool.p99);
+}
+
+static void benchmarkRgba() {
+    constexpr int FRAMES = 20;
+    std::printf("\n--- benchmark: 4K HAP Q -> RGBA, %d frames, %d pool workers ---\n",
+                FRAMES, trussc::WorkerPool::shared().getThreadCount());
+    const auto blocks = randomBlocks(WIDTH, HEIGHT, HapFormat::YCoCgDXT5, 5);
+    std::vector<uint8_t> ref, out((size_t)WIDTH * HEIGHT * 4);
+
+    auto time = [&](auto decode) {
+        std::vector<double> ms;
+        for (int i = 0; i < FRAMES; i++) {
+            const auto t0 = std::chrono::steady_clock::now();
+            decode();
+            const auto t1 = std::chrono::steady_clock::now();
+            ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        return percentiles(std::move(ms));
+    };
+    const auto old = time([&] { referenceRgba(blocks, WIDTH, HEIGHT, HapFormat::YCoCgDXT5, ref); });
+    const auto one = time([&] {
+        decodeBlocksToRgba(blocks.data(), blocks.size(), WIDTH, HEIGHT, HapFormat::YCoCgDXT5,
+                           out.data(), 0, 1);
+    });
+    const auto all = time([&] {
+        decodeBlocksToRgba(blocks.data(), blocks.size(), WIDTH, HEIGHT, HapFormat::YCoCgDXT5,
+                           out.data());
+    });
+    printRow("old (per pixel, 1 thr)", old);
+    printRow("kernel, 1 thread", one);
+    printRow("kernel, shared pool", all);
+    std::printf("  p50 speedup %.2fx (1 thread), %.2fx (pool)\n", old.p50 / one.p50, old.p50 / all.p50);
+}
+
+int main() {
+    testRoundTrip();
+    testPoolSize();
+    testConcurrentDecoders();
+    testMovie();
+    testRgba();
+    benchmark();
+    benchmarkRgba();
+
+    std::printf("\n%d passed, %d failed\n", g_pass, g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
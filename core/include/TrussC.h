@@ -105,6 +105,7 @@
 #include "tc/utils/tcTime.h"
 #include "tc/utils/tcLog.h"
 #include "tc/utils/tcCompress.h"
+#include "tc/utils/tcMappedFile.h"
 
 // TrussC file dialogs
 #include "tc/utils/tcFileDialog.h"
@@ -2911,6 +2912,10 @@ int runApp(const WindowSettings& settings = WindowSettings()) {
 // TrussC HasTexture interface
 #include "tc/gpu/tcHasTexture.h"
 
+// TrussC GPU block compression + on-disk compressed texture cache
+#include "tc/graphics/tcBlockCompress.h"
+#include "tc/graphics/tcTextureCache.h"
+
 // TrussC image (needed before tcMesh.h)
 #include "tc/graphics/tcImage.h"
 
@@ -2957,6 +2962,7 @@ inline void bindCursorImage(Cursor cursor, const Image& image,
 
 // TrussC video playback
 #include "tc/video/tcVideoPlayer.h"
+#include "tc/video/tcVideoGroup.h"
 
 // TrussC video recording (native encoder, no ffmpeg)
 #include "tc/video/tcVideoRecorder.h"
@@ -3061,10 +3067,13 @@ inline void drawCone(float x, float y, float z, float radius, float height, int
 #include "tc/sound/tcSound.h"
 #include "tc/sound/tcChipSound.h"
 #include "tc/sound/tcAudioRecorder.h"
+#include "tc/sound/tcAudioAnalyzer.h"
 
 // TrussC threading
 #include "tc/utils/tcThread.h"
 #include "tc/utils/tcThreadChannel.h"
+#include "tc/utils/tcTripleBuffer.h"
+#include "tc/utils/tcParallel.h"
 
 // TrussC animation
 #include "tc/animation/tcEasing.h"
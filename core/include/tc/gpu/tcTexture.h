@@ -289,6 +289,14 @@ public:
     // Data must be provided for immutable compressed textures
     void allocateCompressed(int width, int height, sg_pixel_format format,
                             const void* data, size_t dataSize) {
+        sg_range level = {data, dataSize};
+        allocateCompressed(width, height, format, &level, 1);
+    }
+
+    // Same, with a mip chain: levels[i] holds the blocks of mip i
+    // (numLevels <= SG_MAX_MIPMAPS). Used by Image::loadCompressed.
+    void allocateCompressed(int width, int height, sg_pixel_format format,
+                            const sg_range* levels, int numLevels) {
         clear();
 
         width_ = width;
@@ -296,8 +304,16 @@ public:
         channels_ = 4;  // Compressed textures treated as RGBA
         usage_ = TextureUsage::Immutable;
         pixelFormat_ = format;
+        numMipLevels_ = std::clamp(numLevels, 1, (int)SG_MAX_MIPMAPS);
+        mipmapped_ = numMipLevels_ > 1;
+
+        createCompressedResources(levels, numMipLevels_);
+    }
 
-        createCompressedResources(data, dataSize);
+    // Whether the current backend / GPU can sample `format` (BC formats are
+    // missing on most GLES / mobile targets).
+    static bool isFormatSupported(sg_pixel_format format) {
+        return sg_query_pixelformat(format).sample;
     }
 
     // Update compressed texture (recreates texture - BC textures are immutable)
@@ -311,7 +327,10 @@ public:
         internal::deferGpuDestroy(image_);
 
         // Recreate with new data
-        createCompressedResources(data, dataSize);
+        sg_range level = {data, dataSize};
+        numMipLevels_ = 1;
+        mipmapped_ = false;
+        createCompressedResources(&level, 1);
     }
 
     bool isCompressed() const {
@@ -390,6 +409,8 @@ public:
         view_ = {};
         attachmentView_ = {};
         sampler_ = {};
+        mipChain_.clear();
+        mipChainStale_ = false;
     }
 
     // === State ===
@@ -411,59 +432,20 @@ public:
         // it as immutable with all mip levels baked in from CPU data.
         // The view and sampler are also rebuilt so handles stay consistent.
         if (mipmapped_ && allocated_ && usage_ != TextureUsage::Immutable) {
-            if (pixels.getWidth() != width_ ||
-                pixels.getHeight() != height_ ||
-                pixels.getChannels() != channels_) return;
-
-            // DEVICE frame counter (Fix 3): sokol's one-update-per-image-per-
-            // frame limit is a device constraint, so this must stay on
-            // sapp_frame_count(), NOT the per-window getFrameCount().
-            uint64_t currentFrame = sapp_frame_count();
-            if (lastUpdateFrame_ == currentFrame) {
-                logWarning() << "[Texture] loadData() called twice in same frame, skipped";
-                return;
-            }
-            lastUpdateFrame_ = currentFrame;
-
-            const size_t bpp = computeBytesPerPixel();
-
-            sg_image_desc img_desc = {};
-            img_desc.width  = width_;
-            img_desc.height = height_;
-            img_desc.pixel_format = (pixelFormat_ != SG_PIXELFORMAT_NONE)
-                                  ? pixelFormat_
-                                  : ((channels_ == 4) ? SG_PIXELFORMAT_RGBA8 : SG_PIXELFORMAT_R8);
-            img_desc.num_mipmaps  = numMipLevels_;
-
-            img_desc.data.mip_levels[0].ptr  = pixels.getDataVoid();
-            img_desc.data.mip_levels[0].size = (size_t)width_ * height_ * bpp;
-
-            // Lower mip levels: chain Pixels::halve() starting from a clone of
-            // the source. halve() is gamma-correct for U8 buffers (matches the
-            // FBO mipmap convention); F32 buffers are averaged directly.
-            // mipChain entries keep the data alive for the sg_make_image call
-            // below — the pointers we hand to sg_image_data must remain valid
-            // until sg_make_image returns.
-            std::vector<Pixels> mipChain;
-            mipChain.reserve(numMipLevels_ > 1 ? numMipLevels_ - 1 : 0);
-            Pixels current = pixels.clone();
-            for (int level = 1; level < numMipLevels_; level++) {
-                current.halve();
-                mipChain.emplace_back(current.clone());
-                img_desc.data.mip_levels[level].ptr  = mipChain.back().getDataVoid();
-                img_desc.data.mip_levels[level].size = mipChain.back().getTotalBytes();
-            }
-
-            // Tear down old GPU resources (deferred — a draw recorded earlier
-            // this frame may still reference the old view) and rebuild.
-            internal::deferGpuDestroy(view_);
-            internal::deferGpuDestroy(image_);
-
-            image_ = sg_make_image(&img_desc);
+            loadMipmappedData(pixels, nullptr);
+            return;
+        }
+        loadData(pixels.getDataVoid(), pixels.getWidth(), pixels.getHeight(), pixels.getChannels());
+    }
 
-            sg_view_desc view_desc = {};
-            view_desc.texture.image = image_;
-            view_ = sg_make_view(&view_desc);
+    // Same as loadData(pixels), but only the (x, y, w, h) rectangle changed
+    // since the previous upload. On a Dynamic mipmapped texture only the mip
+    // texels under that rectangle are regenerated on the CPU (the upload
+    // itself still covers every level); otherwise this is a full loadData.
+    void loadData(const Pixels& pixels, int x, int y, int w, int h) {
+        if (mipmapped_ && allocated_ && usage_ != TextureUsage::Immutable) {
+            const int rect[4] = {x, y, w, h};
+            loadMipmappedData(pixels, rect);
             return;
         }
         loadData(pixels.getDataVoid(), pixels.getWidth(), pixels.getHeight(), pixels.getChannels());
@@ -645,6 +627,8 @@ private:
     bool mipmapped_ = false;
     TextureUsage usage_ = TextureUsage::Immutable;
     uint64_t lastUpdateFrame_ = UINT64_MAX;  // Last updated frame
+    MipChain mipChain_;          // CPU mip levels of a Dynamic mipmapped texture
+    bool mipChainStale_ = false; // a loadData was skipped; rebuild the whole chain
     sg_pixel_format pixelFormat_ = SG_PIXELFORMAT_NONE;
 
     TextureFilter minFilter_ = TextureFilter::Linear;
@@ -688,13 +672,15 @@ private:
         }
     }
 
-    void createCompressedResources(const void* data, size_t dataSize) {
+    void createCompressedResources(const sg_range* levels, int numLevels) {
         sg_image_desc img_desc = {};
         img_desc.width = width_;
         img_desc.height = height_;
         img_desc.pixel_format = pixelFormat_;
-        img_desc.data.mip_levels[0].ptr = data;
-        img_desc.data.mip_levels[0].size = dataSize;
+        img_desc.num_mipmaps = numLevels;
+        for (int level = 0; level < numLevels; level++) {
+            img_desc.data.mip_levels[level] = levels[level];
+        }
 
         image_ = sg_make_image(&img_desc);
 
@@ -727,9 +713,9 @@ private:
         bool isFloat = (pixelFormat_ == SG_PIXELFORMAT_RGBA32F);
         size_t dataSize = (size_t)width_ * height_ * bpp;
 
-        // Storage for mip chain Pixels (kept alive until sg_make_image
+        // Storage for the mip levels (kept alive until sg_make_image
         // copies them). Used by the Immutable + auto-mipmap path below.
-        std::vector<Pixels> mipChain;
+        MipChain mipChain;
 
         switch (usage_) {
             case TextureUsage::Immutable:
@@ -737,31 +723,21 @@ private:
                     img_desc.data.mip_levels[0].ptr = initialData;
                     img_desc.data.mip_levels[0].size = dataSize;
 
-                    // Generate mip chain via chained Pixels::halve().
-                    // Pixels::halve is gamma-correct for U8 (matches the FBO
-                    // mipmap downsample) and direct-average for F32 (assumed
-                    // already linear). Restricted to channels_ == 4 same as
-                    // before, since Pixels currently only handles 4-channel
-                    // RGBA / RGBAF32 here.
+                    // Generate the mip chain on the CPU (MipChain: same
+                    // gamma-correct 2x2 box as Pixels::halve, which matches
+                    // the FBO mipmap downsample; direct average for F32,
+                    // assumed already linear). Restricted to channels_ == 4
+                    // since only RGBA8 / RGBA32F formats are created here.
                     if (mipmapped_ && channels_ == 4) {
                         int numLevels = 1 + (int)std::floor(std::log2((float)std::max(width_, height_)));
                         if (numLevels > SG_MAX_MIPMAPS) numLevels = SG_MAX_MIPMAPS;
                         img_desc.num_mipmaps = numLevels;
 
-                        Pixels current;
-                        if (isFloat) {
-                            current.setFromFloats(static_cast<const float*>(initialData),
-                                                  width_, height_, channels_);
-                        } else {
-                            current.setFromPixels(static_cast<const unsigned char*>(initialData),
-                                                  width_, height_, channels_);
-                        }
-                        mipChain.reserve(numLevels - 1);
+                        mipChain.build(initialData, width_, height_, channels_,
+                                       isFloat ? PixelFormat::F32 : PixelFormat::U8, numLevels);
                         for (int level = 1; level < numLevels; level++) {
-                            current.halve();
-                            mipChain.emplace_back(current.clone());
-                            img_desc.data.mip_levels[level].ptr  = mipChain.back().getDataVoid();
-                            img_desc.data.mip_levels[level].size = mipChain.back().getTotalBytes();
+                            img_desc.data.mip_levels[level].ptr  = mipChain.getLevelData(level);
+                            img_desc.data.mip_levels[level].size = mipChain.getLevelBytes(level);
                         }
                     }
                 }
@@ -947,9 +923,67 @@ private:
         internal::restoreCurrentPipeline();
     }
 
-    // Mipmap chain generation lives in Pixels::halve (gamma-correct for U8,
-    // direct-average for F32). The old static generateMipLevel() helper that
-    // used to live here has been folded into that single implementation.
+    // Dynamic + mipmapped upload: (re)build the CPU mip chain and recreate
+    // the image as immutable with every level baked in. `dirtyRect` (x, y,
+    // w, h) limits the CPU work to the texels under a changed rectangle when
+    // the cached chain is still in step with the previous upload.
+    void loadMipmappedData(const Pixels& pixels, const int* dirtyRect) {
+        if (pixels.getWidth() != width_ ||
+            pixels.getHeight() != height_ ||
+            pixels.getChannels() != channels_) return;
+
+        // DEVICE frame counter (Fix 3): sokol's one-update-per-image-per-
+        // frame limit is a device constraint, so this must stay on
+        // sapp_frame_count(), NOT the per-window getFrameCount().
+        uint64_t currentFrame = sapp_frame_count();
+        if (lastUpdateFrame_ == currentFrame) {
+            logWarning() << "[Texture] loadData() called twice in same frame, skipped";
+            // The skipped pixels never reached the chain; the next partial
+            // update would otherwise miss them.
+            mipChainStale_ = true;
+            return;
+        }
+        lastUpdateFrame_ = currentFrame;
+
+        // Lower mip levels: gamma-correct 2x2 box for U8 (matches the FBO
+        // mipmap convention), direct average for F32. All levels share the
+        // mipChain_ buffer, which is reused across uploads.
+        if (dirtyRect && !mipChainStale_ &&
+            mipChain_.isBuiltFor(width_, height_, channels_, pixels.getFormat(), numMipLevels_)) {
+            mipChain_.update(pixels.getDataVoid(), dirtyRect[0], dirtyRect[1], dirtyRect[2], dirtyRect[3]);
+        } else {
+            mipChain_.build(pixels, numMipLevels_);
+        }
+        mipChainStale_ = false;
+
+        const size_t bpp = computeBytesPerPixel();
+
+        sg_image_desc img_desc = {};
+        img_desc.width  = width_;
+        img_desc.height = height_;
+        img_desc.pixel_format = (pixelFormat_ != SG_PIXELFORMAT_NONE)
+                              ? pixelFormat_
+                              : ((channels_ == 4) ? SG_PIXELFORMAT_RGBA8 : SG_PIXELFORMAT_R8);
+        img_desc.num_mipmaps  = numMipLevels_;
+
+        img_desc.data.mip_levels[0].ptr  = pixels.getDataVoid();
+        img_desc.data.mip_levels[0].size = (size_t)width_ * height_ * bpp;
+        for (int level = 1; level < mipChain_.getNumLevels(); level++) {
+            img_desc.data.mip_levels[level].ptr  = mipChain_.getLevelData(level);
+            img_desc.data.mip_levels[level].size = mipChain_.getLevelBytes(level);
+        }
+
+        // Tear down old GPU resources (deferred — a draw recorded earlier
+        // this frame may still reference the old view) and rebuild.
+        internal::deferGpuDestroy(view_);
+        internal::deferGpuDestroy(image_);
+
+        image_ = sg_make_image(&img_desc);
+
+        sg_view_desc view_desc = {};
+        view_desc.texture.image = image_;
+        view_ = sg_make_view(&view_desc);
+    }
 
     void moveFrom(Texture&& other) {
         image_ = other.image_;
@@ -967,6 +1001,8 @@ private:
         mipSamplingViews_ = std::move(other.mipSamplingViews_);
         usage_ = other.usage_;
         lastUpdateFrame_ = other.lastUpdateFrame_;
+        mipChain_ = std::move(other.mipChain_);
+        mipChainStale_ = other.mipChainStale_;
         pixelFormat_ = other.pixelFormat_;
         minFilter_ = other.minFilter_;
         magFilter_ = other.magFilter_;
@@ -988,6 +1024,7 @@ private:
         other.mipAttachmentViews_.clear();
         other.mipSamplingViews_.clear();
         other.pixelFormat_ = SG_PIXELFORMAT_NONE;
+        other.mipChainStale_ = false;
     }
 };
 
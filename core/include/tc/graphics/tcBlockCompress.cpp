@@ -0,0 +1,466 @@
+// =============================================================================
+// tcBlockCompress.cpp - BC1 / BC3 / BC7 (mode 6) block encoders
+// =============================================================================
+
+#include "tc/graphics/tcBlockCompress.h"
+#include "tc/utils/tcParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace trussc {
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Shared fitting helpers
+// -----------------------------------------------------------------------------
+
+// Principal axis of `n` points in `dims` dimensions (power iteration on the
+// covariance matrix). Returns false for a (near) solid block.
+bool principalAxis(const float (*pts)[4], int n, int dims, float* mean, float* axis) {
+    for (int c = 0; c < dims; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < n; i++) mean[c] += pts[i][c];
+        mean[c] /= (float)n;
+    }
+    float cov[4][4] = {};
+    for (int i = 0; i < n; i++) {
+        float d[4];
+        for (int c = 0; c < dims; c++) d[c] = pts[i][c] - mean[c];
+        for (int a = 0; a < dims; a++) {
+            for (int b = a; b < dims; b++) cov[a][b] += d[a] * d[b];
+        }
+    }
+    for (int a = 0; a < dims; a++) {
+        for (int b = 0; b < a; b++) cov[a][b] = cov[b][a];
+    }
+
+    // Start from the channel with the largest variance; converges in a few
+    // steps for 16 points.
+    int best = 0;
+    for (int c = 1; c < dims; c++) {
+        if (cov[c][c] > cov[best][best]) best = c;
+    }
+    if (cov[best][best] < 1e-3f) return false;
+    for (int c = 0; c < dims; c++) axis[c] = cov[best][c];
+
+    for (int iter = 0; iter < 6; iter++) {
+        float next[4] = {};
+        for (int a = 0; a < dims; a++) {
+            for (int b = 0; b < dims; b++) next[a] += cov[a][b] * axis[b];
+        }
+        float len = 0.0f;
+        for (int c = 0; c < dims; c++) len += next[c] * next[c];
+        if (len < 1e-12f) return false;
+        len = 1.0f / std::sqrt(len);
+        for (int c = 0; c < dims; c++) axis[c] = next[c] * len;
+    }
+    return true;
+}
+
+// Endpoints at the extremes of the points projected on `axis`.
+void axisEndpoints(const float (*pts)[4], int n, int dims, const float* mean, const float* axis,
+                   float* e0, float* e1) {
+    float tmin = 1e30f, tmax = -1e30f;
+    for (int i = 0; i < n; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < dims; c++) t += (pts[i][c] - mean[c]) * axis[c];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+    }
+    for (int c = 0; c < dims; c++) {
+        e0[c] = std::clamp(mean[c] + axis[c] * tmax, 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + axis[c] * tmin, 0.0f, 255.0f);
+    }
+}
+
+// Least-squares endpoints for fixed interpolation weights: minimise
+// sum |w_i * e0 + (1 - w_i) * e1 - p_i|^2. Returns false if degenerate.
+bool leastSquaresEndpoints(const float (*pts)[4], const float* w, int n, int dims,
+                           float* e0, float* e1) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float x[4] = {}, y[4] = {};
+    for (int i = 0; i < n; i++) {
+        float a = w[i], b = 1.0f - w[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < dims; c++) {
+            x[c] += a * pts[i][c];
+            y[c] += b * pts[i][c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) return false;
+    float inv = 1.0f / det;
+    for (int c = 0; c < dims; c++) {
+        e0[c] = std::clamp((bb * x[c] - ab * y[c]) * inv, 0.0f, 255.0f);
+        e1[c] = std::clamp((aa * y[c] - ab * x[c]) * inv, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// BC1 colour block (also the colour half of BC3)
+// -----------------------------------------------------------------------------
+
+inline uint16_t pack565(const float* c) {
+    int r = (int)std::lround(c[0] * 31.0f / 255.0f);
+    int g = (int)std::lround(c[1] * 63.0f / 255.0f);
+    int b = (int)std::lround(c[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpack565(uint16_t v, float* c) {
+    int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    c[0] = (float)((r << 3) | (r >> 2));
+    c[1] = (float)((g << 2) | (g >> 4));
+    c[2] = (float)((b << 3) | (b >> 2));
+}
+
+struct ColorFit {
+    uint16_t c0 = 0, c1 = 0;
+    uint32_t indices = 0;
+    float error = 1e30f;
+};
+
+// Quantise (e0, e1) to 565 and pick the nearest palette entry per texel.
+// threeColor: c0 <= c1 mode (index 3 = transparent black), used by BC1 when
+// the block has punch-through alpha. Only opaque texels count toward error.
+ColorFit quantizeColor(const float (*pts)[4], const bool* transparent, const float* e0,
+                       const float* e1, bool threeColor) {
+    ColorFit fit;
+    uint16_t q0 = pack565(e0), q1 = pack565(e1);
+    if (threeColor ? (q0 > q1) : (q0 < q1)) std::swap(q0, q1);
+
+    float pal[4][3];
+    unpack565(q0, pal[0]);
+    unpack565(q1, pal[1]);
+    int entries;
+    if (threeColor || q0 == q1) {
+        // c0 == c1 also decodes as 3-colour mode; with every index 0 or 2 the
+        // result is just c0, so it is fine for solid opaque blocks.
+        for (int c = 0; c < 3; c++) pal[2][c] = (pal[0][c] + pal[1][c]) * 0.5f;
+        entries = 3;
+    } else {
+        for (int c = 0; c < 3; c++) {
+            pal[2][c] = (2.0f * pal[0][c] + pal[1][c]) / 3.0f;
+            pal[3][c] = (pal[0][c] + 2.0f * pal[1][c]) / 3.0f;
+        }
+        entries = 4;
+    }
+
+    fit.c0 = q0;
+    fit.c1 = q1;
+    fit.error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        uint32_t idx = 3;
+        if (!transparent[i]) {
+            float best = 1e30f;
+            for (int k = 0; k < entries; k++) {
+                float d0 = pts[i][0] - pal[k][0];
+                float d1 = pts[i][1] - pal[k][1];
+                float d2 = pts[i][2] - pal[k][2];
+                float d = d0 * d0 + d1 * d1 + d2 * d2;
+                if (d < best) { best = d; idx = (uint32_t)k; }
+            }
+            fit.error += best;
+        }
+        fit.indices |= idx << (2 * i);
+    }
+    return fit;
+}
+
+void encodeColorBlock(const uint8_t* rgba, uint8_t* out, bool allowTransparent) {
+    float pts[16][4];
+    bool transparent[16];
+    float opaque[16][4];
+    int nOpaque = 0;
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) pts[i][c] = rgba[i * 4 + c];
+        transparent[i] = allowTransparent && rgba[i * 4 + 3] < 128;
+        if (!transparent[i]) {
+            std::memcpy(opaque[nOpaque++], pts[i], sizeof(pts[i]));
+        }
+    }
+    const bool threeColor = nOpaque < 16;
+
+    ColorFit best;
+    if (nOpaque == 0) {
+        best.c0 = best.c1 = 0;
+        best.indices = 0xFFFFFFFFu;
+    } else {
+        float mean[4], axis[4], e0[4], e1[4];
+        if (principalAxis(opaque, nOpaque, 3, mean, axis)) {
+            axisEndpoints(opaque, nOpaque, 3, mean, axis, e0, e1);
+        } else {
+            for (int c = 0; c < 3; c++) e0[c] = e1[c] = mean[c];
+        }
+        best = quantizeColor(pts, transparent, e0, e1, threeColor);
+
+        // Refine against the chosen indices (weights of c0 per palette entry).
+        static const float kWeight4[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        static const float kWeight3[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+        for (int iter = 0; iter < 2 && best.error > 0.0f; iter++) {
+            const float* table = (threeColor || best.c0 == best.c1) ? kWeight3 : kWeight4;
+            float w[16];
+            int n = 0;
+            for (int i = 0; i < 16; i++) {
+                if (transparent[i]) continue;
+                w[n++] = table[(best.indices >> (2 * i)) & 3];
+            }
+            float r0[4], r1[4];
+            if (!leastSquaresEndpoints(opaque, w, n, 3, r0, r1)) break;
+            // The palette may have been swapped to satisfy the mode order, in
+            // which case r0/r1 map to (c1, c0); quantizeColor re-sorts anyway.
+            ColorFit candidate = quantizeColor(pts, transparent, r0, r1, threeColor);
+            if (candidate.error >= best.error) break;
+            best = candidate;
+        }
+    }
+
+    out[0] = (uint8_t)(best.c0 & 0xFF);
+    out[1] = (uint8_t)(best.c0 >> 8);
+    out[2] = (uint8_t)(best.c1 & 0xFF);
+    out[3] = (uint8_t)(best.c1 >> 8);
+    for (int b = 0; b < 4; b++) out[4 + b] = (uint8_t)(best.indices >> (8 * b));
+}
+
+// -----------------------------------------------------------------------------
+// BC3 alpha block
+// -----------------------------------------------------------------------------
+
+void encodeAlphaBlock(const uint8_t* rgba, uint8_t* out) {
+    int amin = 255, amax = 0;
+    for (int i = 0; i < 16; i++) {
+        amin = std::min(amin, (int)rgba[i * 4 + 3]);
+        amax = std::max(amax, (int)rgba[i * 4 + 3]);
+    }
+    out[0] = (uint8_t)amax;
+    out[1] = (uint8_t)amin;
+    uint64_t bits = 0;
+    if (amax != amin) {
+        // a0 > a1: 8-entry ramp. Entry 0 = a0, 1 = a1, 2..7 in between.
+        int pal[8];
+        pal[0] = amax;
+        pal[1] = amin;
+        for (int k = 2; k < 8; k++) pal[k] = ((8 - k) * amax + (k - 1) * amin) / 7;
+        for (int i = 0; i < 16; i++) {
+            int a = rgba[i * 4 + 3];
+            int bestK = 0, bestD = 1 << 30;
+            for (int k = 0; k < 8; k++) {
+                int d = std::abs(a - pal[k]);
+                if (d < bestD) { bestD = d; bestK = k; }
+            }
+            bits |= (uint64_t)bestK << (3 * i);
+        }
+    }
+    for (int b = 0; b < 6; b++) out[2 + b] = (uint8_t)(bits >> (8 * b));
+}
+
+// -----------------------------------------------------------------------------
+// BC7 mode 6: RGBA 7.7.7.7 endpoints + one p-bit each, 4-bit indices
+// -----------------------------------------------------------------------------
+
+const int kBC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Endpoint {
+    int q[4];   // 7-bit
+    int p;      // p-bit
+    int value(int c) const { return (q[c] << 1) | p; }
+};
+
+BC7Endpoint quantizeBC7(const float* e) {
+    BC7Endpoint best{};
+    float bestErr = 1e30f;
+    for (int p = 0; p < 2; p++) {
+        BC7Endpoint ep{};
+        ep.p = p;
+        float err = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            ep.q[c] = std::clamp((int)std::lround((e[c] - p) * 0.5f), 0, 127);
+            float d = (float)ep.value(c) - e[c];
+            err += d * d;
+        }
+        if (err < bestErr) { bestErr = err; best = ep; }
+    }
+    return best;
+}
+
+struct BC7Fit {
+    BC7Endpoint e0{}, e1{};
+    uint8_t idx[16] = {};
+    float error = 1e30f;
+};
+
+BC7Fit indexBC7(const float (*pts)[4], const BC7Endpoint& e0, const BC7Endpoint& e1) {
+    BC7Fit fit;
+    fit.e0 = e0;
+    fit.e1 = e1;
+    fit.error = 0.0f;
+
+    float pal[16][4];
+    float v0[4], dir[4];
+    float dirLen2 = 0.0f;
+    for (int c = 0; c < 4; c++) {
+        int a = e0.value(c), b = e1.value(c);
+        for (int k = 0; k < 16; k++) {
+            pal[k][c] = (float)(((64 - kBC7Weights4[k]) * a + kBC7Weights4[k] * b + 32) >> 6);
+        }
+        v0[c] = (float)a;
+        dir[c] = (float)(b - a);
+        dirLen2 += dir[c] * dir[c];
+    }
+
+    for (int i = 0; i < 16; i++) {
+        // Project onto the endpoint line for a first guess, then check the
+        // neighbouring steps (the palette is rounded, not exactly linear).
+        int guess = 0;
+        if (dirLen2 > 0.0f) {
+            float t = 0.0f;
+            for (int c = 0; c < 4; c++) t += (pts[i][c] - v0[c]) * dir[c];
+            float w = std::clamp(t / dirLen2, 0.0f, 1.0f) * 64.0f;
+            while (guess < 15 && (float)kBC7Weights4[guess + 1] <= w) guess++;
+            if (guess < 15 && w - kBC7Weights4[guess] > kBC7Weights4[guess + 1] - w) guess++;
+        }
+        int lo = std::max(0, guess - 1), hi = std::min(15, guess + 1);
+        float best = 1e30f;
+        int bestK = guess;
+        for (int k = lo; k <= hi; k++) {
+            float d = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                float e = pts[i][c] - pal[k][c];
+                d += e * e;
+            }
+            if (d < best) { best = d; bestK = k; }
+        }
+        fit.idx[i] = (uint8_t)bestK;
+        fit.error += best;
+    }
+    return fit;
+}
+
+struct BitWriter128 {
+    uint64_t lo = 0, hi = 0;
+    int pos = 0;
+    void put(uint32_t value, int bits) {
+        for (int b = 0; b < bits; b++, pos++) {
+            uint64_t bit = (value >> b) & 1u;
+            if (pos < 64) lo |= bit << pos;
+            else hi |= bit << (pos - 64);
+        }
+    }
+};
+
+void encodeBC7Mode6(const uint8_t* rgba, uint8_t* out) {
+    float pts[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) pts[i][c] = rgba[i * 4 + c];
+    }
+
+    float mean[4], axis[4], e0[4], e1[4];
+    if (principalAxis(pts, 16, 4, mean, axis)) {
+        axisEndpoints(pts, 16, 4, mean, axis, e0, e1);
+    } else {
+        for (int c = 0; c < 4; c++) e0[c] = e1[c] = mean[c];
+    }
+    BC7Fit best = indexBC7(pts, quantizeBC7(e0), quantizeBC7(e1));
+
+    for (int iter = 0; iter < 2 && best.error > 0.0f; iter++) {
+        float w[16];
+        for (int i = 0; i < 16; i++) w[i] = (64 - kBC7Weights4[best.idx[i]]) / 64.0f;
+        float r0[4], r1[4];
+        if (!leastSquaresEndpoints(pts, w, 16, 4, r0, r1)) break;
+        BC7Fit candidate = indexBC7(pts, quantizeBC7(r0), quantizeBC7(r1));
+        if (candidate.error >= best.error) break;
+        best = candidate;
+    }
+
+    // The anchor (texel 0) index is stored with its top bit implied 0:
+    // swap the endpoints and mirror the indices if it is set.
+    if (best.idx[0] & 8) {
+        std::swap(best.e0, best.e1);
+        for (int i = 0; i < 16; i++) best.idx[i] = (uint8_t)(15 - best.idx[i]);
+    }
+
+    BitWriter128 w;
+    w.put(1u << 6, 7);                     // mode 6
+    for (int c = 0; c < 4; c++) {
+        w.put((uint32_t)best.e0.q[c], 7);
+        w.put((uint32_t)best.e1.q[c], 7);
+    }
+    w.put((uint32_t)best.e0.p, 1);
+    w.put((uint32_t)best.e1.p, 1);
+    w.put(best.idx[0], 3);
+    for (int i = 1; i < 16; i++) w.put(best.idx[i], 4);
+
+    for (int b = 0; b < 8; b++) {
+        out[b] = (uint8_t)(w.lo >> (8 * b));
+        out[8 + b] = (uint8_t)(w.hi >> (8 * b));
+    }
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+std::size_t blockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t blockCompressedSize(int width, int height, BlockFormat format) {
+    if (width <= 0 || height <= 0) return 0;
+    return (std::size_t)((width + 3) / 4) * (std::size_t)((height + 3) / 4) * blockBytes(format);
+}
+
+void encodeBC1Block(const std::uint8_t* rgba, std::uint8_t* out) {
+    encodeColorBlock(rgba, out, true);
+}
+
+void encodeBC3Block(const std::uint8_t* rgba, std::uint8_t* out) {
+    encodeAlphaBlock(rgba, out);
+    encodeColorBlock(rgba, out + 8, false);
+}
+
+void encodeBC7Block(const std::uint8_t* rgba, std::uint8_t* out) {
+    encodeBC7Mode6(rgba, out);
+}
+
+void encodeBlocks(const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                  std::uint8_t* dst) {
+    if (!rgba || !dst || width <= 0 || height <= 0) return;
+    const int bw = (width + 3) / 4;
+    const int bh = (height + 3) / 4;
+    const std::size_t bb = blockBytes(format);
+    void (*encodeBlock)(const std::uint8_t*, std::uint8_t*) =
+        format == BlockFormat::BC1 ? encodeBC1Block
+      : format == BlockFormat::BC3 ? encodeBC3Block
+      : encodeBC7Block;
+
+    parallelFor(0, bh, [&](int by) {
+        std::uint8_t block[64];
+        std::uint8_t* out = dst + (std::size_t)by * bw * bb;
+        for (int bx = 0; bx < bw; bx++) {
+            for (int y = 0; y < 4; y++) {
+                int sy = std::min(by * 4 + y, height - 1);
+                for (int x = 0; x < 4; x++) {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, rgba + ((std::size_t)sy * width + sx) * 4, 4);
+                }
+            }
+            encodeBlock(block, out + (std::size_t)bx * bb);
+        }
+    });
+}
+
+void encodeBlocks(const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                  std::vector<std::uint8_t>& out) {
+    out.resize(blockCompressedSize(width, height, format));
+    encodeBlocks(rgba, width, height, format, out.data());
+}
+
+} // namespace trussc
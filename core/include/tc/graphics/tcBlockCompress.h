@@ -0,0 +1,63 @@
+#pragma once
+
+// =============================================================================
+// tcBlockCompress.h - CPU encoders for GPU block-compressed textures
+// =============================================================================
+//
+// Encodes RGBA8 images into BC1 / BC3 / BC7 blocks that the GPU samples
+// directly (Texture::allocateCompressed). Pure CPU — no window, no GPU — so it
+// runs on worker threads and in headless tools that pre-bake a TextureCache.
+//
+//   BC1   4 bpp  RGB + 1-bit alpha (texels with alpha < 128 become
+//                transparent). Opaque photos: 8x smaller than RGBA8.
+//   BC3   8 bpp  BC1 colour + an 8-step alpha ramp. Smooth alpha.
+//   BC7   8 bpp  RGBA, clearly better than BC1/BC3 on gradients. Only mode 6
+//                is emitted (one RGBA line per block, 16 steps): fast to
+//                encode, and the mode most real-time encoders default to.
+//
+// Each block is fitted along its principal colour axis and then refined once
+// by least squares; that is quick enough to encode a 4K photo in well under a
+// second on a few cores, at a quality a few dB short of offline encoders.
+// Rows of blocks are split across WorkerPool::shared().
+//
+//   std::vector<uint8_t> blocks;
+//   tc::encodeBlocks(pixels.getData(), w, h, tc::BlockFormat::BC7, blocks);
+//   texture.allocateCompressed(w, h, SG_PIXELFORMAT_BC7_RGBA, blocks.data(), blocks.size());
+//
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trussc {
+
+enum class BlockFormat {
+    BC1,
+    BC3,
+    BC7,
+};
+
+// Bytes per 4x4 block: 8 for BC1, 16 for BC3 / BC7.
+std::size_t blockBytes(BlockFormat format);
+
+// Size of a width x height image in `format`. Partial edge blocks count as
+// whole blocks (that is also how the GPU expects each mip level laid out).
+std::size_t blockCompressedSize(int width, int height, BlockFormat format);
+
+// Encode one 4x4 block. `rgba` is 16 texels, row-major, 4 bytes each; `out`
+// receives blockBytes(format) bytes.
+void encodeBC1Block(const std::uint8_t* rgba, std::uint8_t* out);
+void encodeBC3Block(const std::uint8_t* rgba, std::uint8_t* out);
+void encodeBC7Block(const std::uint8_t* rgba, std::uint8_t* out);
+
+// Encode a tightly packed RGBA8 image. Edge blocks repeat the last row /
+// column. The vector form resizes `out`; the raw form writes
+// blockCompressedSize() bytes into `dst` (e.g. one mip level of a larger
+// buffer).
+void encodeBlocks(const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                  std::vector<std::uint8_t>& out);
+void encodeBlocks(const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                  std::uint8_t* dst);
+
+} // namespace trussc
@@ -180,6 +180,23 @@ private:
 
     // CPU-side pixel data (for expansion/update)
     std::vector<uint8_t> pixels_;  // RGBA
+
+    // Mip levels below pixels_ (only once the font builds mipmaps). Glyphs
+    // added since the last upload are unioned into the dirty rect so only
+    // their footprint is re-averaged; empty when dirtyX1_ <= dirtyX0_.
+    MipChain mips_;
+    int dirtyX0_ = 0, dirtyY0_ = 0, dirtyX1_ = 0, dirtyY1_ = 0;
+
+    void markDirty(int x, int y, int w, int h) {
+        if (dirtyX1_ <= dirtyX0_) {
+            dirtyX0_ = x; dirtyY0_ = y; dirtyX1_ = x + w; dirtyY1_ = y + h;
+            return;
+        }
+        dirtyX0_ = std::min(dirtyX0_, x);
+        dirtyY0_ = std::min(dirtyY0_, y);
+        dirtyX1_ = std::max(dirtyX1_, x + w);
+        dirtyY1_ = std::max(dirtyY1_, y + h);
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -800,6 +817,7 @@ private:
             atlas.rowHeight_ = paddedHeight;
         }
 
+        atlas.markDirty(destX, destY, glyphWidth, glyphHeight);
         atlas.textureDirty_ = true;
         return true;
     }
@@ -876,12 +894,12 @@ private:
         // text, non-HiDPI displays) alias and shimmer under motion — MSAA can't
         // fix in-texture minification. sokol never auto-generates mipmaps, so we
         // build the chain on the CPU here. Glyph texels are white (RGB=255) with
-        // coverage in A, so every mip keeps RGB=255 and box-averages only alpha;
-        // that avoids the dark colour fringe straight-alpha RGBA averaging would
-        // produce and keeps minified glyphs clean. (GLYPH_PADDING=2 means very
-        // coarse mips bleed slightly between neighbours, but that range is
-        // sub-pixel on screen and far preferable to shimmer.)
-        std::vector<std::vector<uint8_t>> lowerMips;   // levels 1..N (level 0 = atlas.pixels_)
+        // coverage in A, so every mip keeps RGB=255 and box-averages only alpha
+        // (MipChain::Filter::Coverage); that avoids the dark colour fringe
+        // straight-alpha RGBA averaging would produce and keeps minified glyphs
+        // clean. (GLYPH_PADDING=2 means very coarse mips bleed slightly between
+        // neighbours, but that range is sub-pixel on screen and far preferable
+        // to shimmer.)
         // Oversampling and mipmapping compose: oversampling owns 1:1 and above,
         // the mip chain owns minification -- which is exactly where a denser
         // atlas would otherwise make aliasing worse. pickSampler() keeps the
@@ -889,38 +907,29 @@ private:
         // are only ever reached when they are the right answer. On an NxN
         // atlas the chain also lands better than on a 1x one: drawing at 1/N
         // scale reads mip log2(N), whose resolution matches the target exactly.
+        //
+        // The chain is kept per atlas: a new glyph only re-averages the mip
+        // texels under it, so CJK warm-up no longer re-walks the whole atlas
+        // per glyph. A fresh or expanded atlas rebuilds in full.
         if (wantMipmaps_ && mipsBuilt_) {
-            int numMips = 1;
-            for (int mw = atlas.width_, mh = atlas.height_; mw > 1 || mh > 1; ) {
-                mw = std::max(1, mw / 2);
-                mh = std::max(1, mh / 2);
-                ++numMips;
-            }
-            lowerMips.reserve(numMips - 1);   // reserve so .data() pointers stay valid
-
-            const uint8_t* prev = atlas.pixels_.data();
-            int pw = atlas.width_, ph = atlas.height_;
-            img_desc.num_mipmaps = numMips;
-            for (int level = 1; level < numMips; ++level) {
-                int cw = std::max(1, pw / 2), ch = std::max(1, ph / 2);
-                std::vector<uint8_t> dst(static_cast<size_t>(cw) * ch * 4);
-                for (int y = 0; y < ch; ++y) {
-                    for (int x = 0; x < cw; ++x) {
-                        int x0 = x * 2, y0 = y * 2;
-                        int x1 = std::min(x0 + 1, pw - 1), y1 = std::min(y0 + 1, ph - 1);
-                        int a = (prev[(y0 * pw + x0) * 4 + 3] + prev[(y0 * pw + x1) * 4 + 3]
-                               + prev[(y1 * pw + x0) * 4 + 3] + prev[(y1 * pw + x1) * 4 + 3] + 2) / 4;
-                        uint8_t* d = &dst[(static_cast<size_t>(y) * cw + x) * 4];
-                        d[0] = 255; d[1] = 255; d[2] = 255; d[3] = static_cast<uint8_t>(a);
-                    }
+            if (atlas.mips_.isBuiltFor(atlas.width_, atlas.height_, 4, PixelFormat::U8, 0,
+                                       MipChain::Filter::Coverage)) {
+                if (atlas.dirtyX1_ > atlas.dirtyX0_) {
+                    atlas.mips_.update(atlas.pixels_.data(), atlas.dirtyX0_, atlas.dirtyY0_,
+                                       atlas.dirtyX1_ - atlas.dirtyX0_,
+                                       atlas.dirtyY1_ - atlas.dirtyY0_);
                 }
-                lowerMips.push_back(std::move(dst));
-                img_desc.data.mip_levels[level].ptr  = lowerMips.back().data();
-                img_desc.data.mip_levels[level].size = lowerMips.back().size();
-                prev = lowerMips.back().data();
-                pw = cw; ph = ch;
+            } else {
+                atlas.mips_.build(atlas.pixels_.data(), atlas.width_, atlas.height_, 4,
+                                  PixelFormat::U8, 0, MipChain::Filter::Coverage);
+            }
+            img_desc.num_mipmaps = atlas.mips_.getNumLevels();
+            for (int level = 1; level < atlas.mips_.getNumLevels(); ++level) {
+                img_desc.data.mip_levels[level].ptr  = atlas.mips_.getLevelData(level);
+                img_desc.data.mip_levels[level].size = atlas.mips_.getLevelBytes(level);
             }
         }
+        atlas.dirtyX0_ = atlas.dirtyX1_ = 0;
         atlas.texture_ = sg_make_image(&img_desc);
 
         sg_view_desc view_desc = {};
@@ -0,0 +1,84 @@
+#pragma once
+
+// =============================================================================
+// tcGammaTables.h - gamma 2.2 lookup tables for U8 image operations
+// =============================================================================
+// Decode (code -> linear) and encode (linear -> code) for the gamma-correct U8
+// paths in tcPixels.cpp (Pixels::resize / halve, MipChain), without a pow()
+// per sample. encode() returns exactly what the original per-texel
+// lround(clamp(pow(l, 1 / 2.2)) * 255) did, so the LUT paths stay
+// bit-identical to the loops they replaced.
+//
+// Internal: shared by tcPixels.cpp and core/tests/mipChain.
+// =============================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace trussc {
+namespace internal {
+
+struct GammaTables {
+    static constexpr int kCoarse = 4096;
+    float toLinear[256];          // sRGB code -> linear
+    float unorm[256];             // code -> code / 255 (linear channels)
+    float threshold[256];         // smallest linear value that encodes to code k
+    uint8_t coarse[kCoarse + 1];  // encode(i / kCoarse), starting point for the search
+
+    // The encoding every U8 path used before the tables; encode() reproduces it.
+    static int referenceEncode(float l) {
+        float v = std::pow(l, 1.0f / 2.2f);
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        return (int)std::lround(v * 255.0f);
+    }
+
+    GammaTables() {
+        // threshold[k] is the smallest float in [0, 1] that referenceEncode
+        // maps to k or above, found by bisection over the bit patterns
+        // (non-negative floats order like their bits). pow((k - 0.5) / 255,
+        // 2.2) is only close: it misses the exact rounding boundary by an ulp
+        // or so for a few codes.
+        uint32_t lo = 0;
+        for (int k = 0; k < 256; k++) {
+            toLinear[k] = std::pow(k / 255.0f, 2.2f);
+            unorm[k] = k / 255.0f;
+            if (k == 0) {
+                threshold[k] = 0.0f;
+                continue;
+            }
+            uint32_t hi = 0x3F800000u;  // 1.0f, encodes to 255
+            while (lo < hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                float l;
+                std::memcpy(&l, &mid, sizeof(l));
+                if (referenceEncode(l) >= k) hi = mid;
+                else lo = mid + 1;
+            }
+            std::memcpy(&threshold[k], &lo, sizeof(float));
+        }
+        int code = 0;
+        for (int i = 0; i <= kCoarse; i++) {
+            float l = (float)i / (float)kCoarse;
+            while (code < 255 && l >= threshold[code + 1]) code++;
+            coarse[i] = (uint8_t)code;
+        }
+    }
+
+    // Same result as referenceEncode(l) for every float.
+    uint8_t encode(float l) const {
+        if (!(l > 0.0f)) return 0;
+        if (l >= 1.0f) return 255;
+        int code = coarse[(int)(l * kCoarse)];
+        while (code < 255 && l >= threshold[code + 1]) code++;
+        return (uint8_t)code;
+    }
+};
+
+inline const GammaTables& gammaTables() {
+    static const GammaTables tables;
+    return tables;
+}
+
+} // namespace internal
+} // namespace trussc
@@ -82,6 +82,53 @@ public:
         return LoadResult::success();
     }
 
+    // Load through the GPU-compressed texture cache (tcTextureCache.h).
+    // The first load decodes, encodes to `format` (BC1: opaque, 4 bpp;
+    // BC3 / BC7: with alpha, 8 bpp) on worker threads and writes the cache;
+    // later launches upload the cached blocks directly — no PNG/JPEG decode,
+    // and 1/4 to 1/8 of the VRAM of RGBA8.
+    //
+    // The Image holds no CPU pixels afterwards (getPixels() is empty and the
+    // pixel operations do nothing); use load() when you need them. Falls
+    // back to load() when the backend can't sample `format` (GLES / most
+    // mobile GPUs), and on D3D11 for sizes that are not a multiple of 4.
+    LoadResult loadCompressed(const fs::path& path, BlockFormat format = BlockFormat::BC7,
+                              bool mipmaps = false) {
+        clear();
+
+        const sg_pixel_format sgFormat = toSgPixelFormat(format);
+        bool supported = Texture::isFormatSupported(sgFormat);
+        if (supported && sg_query_backend() == SG_BACKEND_D3D11) {
+            int w = 0, h = 0, comp = 0;
+            fs::path resolved = getDataPath(path);
+            if (stbi_info(internal::pathToUtf8(resolved).c_str(), &w, &h, &comp)
+                && (w % 4 != 0 || h % 4 != 0)) {
+                supported = false;
+            }
+        }
+        if (!supported) {
+            logNotice("Image") << "block-compressed textures unavailable here, loading "
+                               << internal::pathToUtf8(path) << " as RGBA";
+            return load(path, mipmaps);
+        }
+
+        CompressedImage blocks;
+        LoadResult r = TextureCache::shared().load(path, format, mipmaps, blocks);
+        if (!r) {
+            return r;
+        }
+
+        sg_range levels[SG_MAX_MIPMAPS] = {};
+        const int numLevels = std::min(blocks.getNumLevels(), (int)SG_MAX_MIPMAPS);
+        for (int l = 0; l < numLevels; l++) {
+            levels[l] = {blocks.getLevelData(l), blocks.levelSizes[l]};
+        }
+        texture_.allocateCompressed(blocks.width, blocks.height, sgFormat, levels, numLevels);
+        mipmaps_ = numLevels > 1;
+        usage_ = TextureUsage::Immutable;
+        return LoadResult::success();
+    }
+
     // Load image from memory
     LoadResult loadFromMemory(const unsigned char* buffer, int len, bool mipmaps = false) {
         clear();
@@ -108,10 +155,12 @@ public:
     // Allocate empty image (for dynamic updates via setColor + update()).
     //
     // `mipmaps=true` builds a mip chain alongside the Dynamic texture; each
-    // subsequent `update()` regenerates the chain CPU-side (2x2 box average)
-    // and re-uploads every level. Costs a per-update CPU pass roughly equal
-    // to ~1/3 the base level size. Worth it when the image is sampled at
-    // varying scales (3D texture mapping, UI scaling) — otherwise leave off.
+    // subsequent `update()` regenerates the chain CPU-side (2x2 box average,
+    // split across worker threads) and re-uploads every level. Costs a
+    // per-update CPU pass roughly equal to ~1/3 the base level size; use
+    // `update(x, y, w, h)` when only part of the image changed. Worth it when
+    // the image is sampled at varying scales (3D texture mapping, UI
+    // scaling) — otherwise leave off.
     void allocate(int width, int height, int channels = 4, bool mipmaps = false) {
         clear();
         pixels_.allocate(width, height, channels);
@@ -133,10 +182,13 @@ public:
 
     // === State ===
 
-    bool isAllocated() const { return pixels_.isAllocated(); }
-    int getWidth() const { return pixels_.getWidth(); }
-    int getHeight() const { return pixels_.getHeight(); }
-    int getChannels() const { return pixels_.getChannels(); }
+    // A loadCompressed() image has a texture but no CPU pixels, so the size
+    // comes from the texture in that case.
+    bool isAllocated() const { return pixels_.isAllocated() || isCompressed(); }
+    int getWidth() const { return isCompressed() ? texture_.getWidth() : pixels_.getWidth(); }
+    int getHeight() const { return isCompressed() ? texture_.getHeight() : pixels_.getHeight(); }
+    int getChannels() const { return isCompressed() ? 4 : pixels_.getChannels(); }
+    bool isCompressed() const { return texture_.isAllocated() && texture_.isCompressed(); }
 
     // === Pixels access ===
 
@@ -217,6 +269,17 @@ public:
         }
     }
 
+    // Like update(), for when only the (x, y, w, h) rectangle changed since
+    // the last upload (painting, a sub-image blit). On a mipmapped Image
+    // only the mip texels under that rectangle are recomputed. Everything
+    // outside it must be unchanged since the previous update().
+    void update(int x, int y, int w, int h) {
+        if (texture_.isAllocated()) {
+            texture_.loadData(pixels_, x, y, w, h);
+            dirty_ = false;
+        }
+    }
+
     // Manually set dirty flag (when directly editing via getPixels())
     void setDirty() { dirty_ = true; }
 
@@ -0,0 +1,723 @@
+#pragma once
+
+// =============================================================================
+// tcPixelConv.h - pixel layout / format conversion kernels
+// =============================================================================
+//
+// One place for the conversions that used to be hand-rolled at every call site
+// (loaders, grabbers, video players, Fbo readback, recorders):
+//
+//   rgbToRgba      RGB8  -> RGBA8, RGB32F -> RGBA32F (constant alpha)
+//   grayToRgba     G8    -> RGBA8 (replicated, constant alpha)
+//   grayAlphaToRgba GA8  -> RGBA8 (replicated, alpha kept)
+//   swapRB         BGRA8 <-> RGBA8 (symmetric; in place is fine)
+//   u8ToF32        U8    -> F32 in [0, 1]
+//   f32ToU8        F32   -> U8 (clamped, rounded)
+//   u16ToU8        U16   -> U8 (high byte; P010 video planes)
+//   yuyvToRgba     YUYV  -> RGBA8 (webcam 4:2:2, BT.601 limited range)
+//   yuyvToPlanes   YUYV  -> Y + interleaved UV planes (GPU conversion)
+//   rgbaToI420     RGBA8 -> Y + U + V planes (4:2:0, BT.709; video encoders)
+//   rgbaToNv12     RGBA8 -> Y + interleaved UV planes (4:2:0, BT.709)
+//   premultiply    straight -> premultiplied alpha (RGBA8 / RGBA32F)
+//   unpremultiply  premultiplied -> straight alpha (RGBA8 / RGBA32F)
+//   extractChannel one channel of an interleaved buffer -> planar
+//
+// `count` is always in PIXELS, except u8ToF32 / f32ToU8 which work on plain
+// values (pass width * height * channels). Row strides are the caller's
+// business: call once per row when rows are padded (the 4:2:0 kernels, which
+// need row pairs, take strides themselves).
+//
+// Kernels use SSE2 on x86-64 and NEON on arm64 (see tc/utils/tcSimd.h) with
+// a scalar tail / fallback; results are identical on every path. They are
+// single-threaded and allocation-free, safe to call from decode threads.
+//
+// Usage:
+//   tc::pixelconv::swapRB(bgra, rgba, w * h);
+//   tc::pixelconv::u8ToF32(pixels.getData(), floats, w * h * 4);
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "tc/utils/tcSimd.h"
+
+namespace trussc {
+namespace pixelconv {
+
+// ---------------------------------------------------------------------------
+// RGB8 -> RGBA8
+// ---------------------------------------------------------------------------
+inline void rgbToRgba(const uint8_t* src, uint8_t* dst, size_t count, uint8_t alpha = 255) {
+    size_t i = 0;
+#if defined(TC_SIMD_NEON)
+    const uint8x16_t a = vdupq_n_u8(alpha);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        uint8x16x4_t rgba = {{ rgb.val[0], rgb.val[1], rgb.val[2], a }};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+#else
+    // 4-byte load per pixel (the 4th byte is the next pixel's R, replaced by
+    // alpha; little-endian, like every supported target). Stop one pixel
+    // early so the last load stays in bounds.
+    const uint32_t a = (uint32_t)alpha << 24;
+    for (; i + 1 < count; ++i) {
+        uint32_t p;
+        std::memcpy(&p, src + i * 3, 4);
+        p = (p & 0x00FFFFFFu) | a;
+        std::memcpy(dst + i * 4, &p, 4);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+// RGB32F -> RGBA32F (HDR loads)
+inline void rgbToRgba(const float* src, float* dst, size_t count, float alpha = 1.0f) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Gray8 -> RGBA8
+// ---------------------------------------------------------------------------
+inline void grayToRgba(const uint8_t* src, uint8_t* dst, size_t count, uint8_t alpha = 255) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i a = _mm_set1_epi8((char)alpha);
+    for (; i + 16 <= count; i += 16) {
+        __m128i g  = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i gg = _mm_unpacklo_epi8(g, g);       // g0 g0 g1 g1 ...
+        __m128i ga = _mm_unpacklo_epi8(g, a);       // g0 a  g1 a  ...
+        __m128i gg2 = _mm_unpackhi_epi8(g, g);
+        __m128i ga2 = _mm_unpackhi_epi8(g, a);
+        _mm_storeu_si128((__m128i*)(dst + i * 4 +  0), _mm_unpacklo_epi16(gg,  ga));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(gg,  ga));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 32), _mm_unpacklo_epi16(gg2, ga2));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 48), _mm_unpackhi_epi16(gg2, ga2));
+    }
+#elif defined(TC_SIMD_NEON)
+    const uint8x16_t a = vdupq_n_u8(alpha);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t g = vld1q_u8(src + i);
+        uint8x16x4_t rgba = {{ g, g, g, a }};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint8_t g = src[i];
+        dst[i * 4 + 0] = g;
+        dst[i * 4 + 1] = g;
+        dst[i * 4 + 2] = g;
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// GrayAlpha8 -> RGBA8
+// ---------------------------------------------------------------------------
+inline void grayAlphaToRgba(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i lo = _mm_set1_epi16(0x00FF);
+    for (; i + 8 <= count; i += 8) {
+        __m128i ga = _mm_loadu_si128((const __m128i*)(src + i * 2));   // g0 a0 g1 a1 ...
+        __m128i g  = _mm_and_si128(ga, lo);
+        __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));             // g0 g0 g1 g1 ...
+        _mm_storeu_si128((__m128i*)(dst + i * 4 +  0), _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(gg, ga));
+    }
+#elif defined(TC_SIMD_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x2_t ga = vld2q_u8(src + i * 2);
+        uint8x16x4_t rgba = {{ ga.val[0], ga.val[0], ga.val[0], ga.val[1] }};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint8_t g = src[i * 2];
+        dst[i * 4 + 0] = g;
+        dst[i * 4 + 1] = g;
+        dst[i * 4 + 2] = g;
+        dst[i * 4 + 3] = src[i * 2 + 1];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BGRA8 <-> RGBA8. forceOpaque writes alpha = 255 (camera RGB32 / XRGB
+// sources leave the 4th byte undefined).
+// ---------------------------------------------------------------------------
+inline void swapRB(const uint8_t* src, uint8_t* dst, size_t count, bool forceOpaque = false) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i maskGA = _mm_set1_epi32((int)0xFF00FF00u);
+    const __m128i maskLo = _mm_set1_epi32(0x000000FF);
+    const __m128i opaque = _mm_set1_epi32(forceOpaque ? (int)0xFF000000u : 0);
+    for (; i + 4 <= count; i += 4) {
+        __m128i p  = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i ga = _mm_and_si128(p, maskGA);
+        __m128i r  = _mm_and_si128(_mm_srli_epi32(p, 16), maskLo);
+        __m128i b  = _mm_slli_epi32(_mm_and_si128(p, maskLo), 16);
+        __m128i o  = _mm_or_si128(_mm_or_si128(ga, r), _mm_or_si128(b, opaque));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), o);
+    }
+#elif defined(TC_SIMD_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t p = vld4q_u8(src + i * 4);
+        uint8x16_t t = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = t;
+        if (forceOpaque) p.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst + i * 4, p);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint8_t c0 = src[i * 4 + 0];
+        uint8_t c2 = src[i * 4 + 2];
+        dst[i * 4 + 0] = c2;
+        dst[i * 4 + 1] = src[i * 4 + 1];
+        dst[i * 4 + 2] = c0;
+        dst[i * 4 + 3] = forceOpaque ? 255 : src[i * 4 + 3];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// U8 -> F32 ([0, 255] -> [0, 1]), `count` values
+// ---------------------------------------------------------------------------
+inline void u8ToF32(const uint8_t* src, float* dst, size_t count) {
+    constexpr float kInv255 = 1.0f / 255.0f;
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(kInv255);
+    for (; i + 16 <= count; i += 16) {
+        __m128i v   = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo  = _mm_unpacklo_epi8(v, zero);
+        __m128i hi  = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(dst + i +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+#elif defined(TC_SIMD_NEON)
+    const float32x4_t scale = vdupq_n_f32(kInv255);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t v  = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_f32(dst + i +  0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))),  scale));
+        vst1q_f32(dst + i +  4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+        vst1q_f32(dst + i +  8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))),  scale));
+        vst1q_f32(dst + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = (float)src[i] * kInv255;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// F32 -> U8 (clamp to [0, 1], round to nearest), `count` values
+// ---------------------------------------------------------------------------
+inline void f32ToU8(const float* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 k255 = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    auto cvt = [&](const float* p) {
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), zero), one);
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, k255), half));
+    };
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_packs_epi32(cvt(src + i + 0), cvt(src + i + 4));
+        __m128i b = _mm_packs_epi32(cvt(src + i + 8), cvt(src + i + 12));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(TC_SIMD_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one  = vdupq_n_f32(1.0f);
+    const float32x4_t k255 = vdupq_n_f32(255.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    auto cvt = [&](const float* p) {
+        float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(p), zero), one);
+        return vmovn_u32(vcvtq_u32_f32(vaddq_f32(vmulq_f32(v, k255), half)));
+    };
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t a = vcombine_u16(cvt(src + i + 0), cvt(src + i + 4));
+        uint16x8_t b = vcombine_u16(cvt(src + i + 8), cvt(src + i + 12));
+        vst1q_u8(dst + i, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    }
+#endif
+    for (; i < count; ++i) {
+        float v = src[i];
+        // NaN fails both comparisons and lands on 0, same as the SIMD max/min.
+        v = (v > 0.0f) ? v : 0.0f;
+        v = (v < 1.0f) ? v : 1.0f;
+        dst[i] = (uint8_t)(int)(v * 255.0f + 0.5f);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// U16 -> U8 (high byte, truncated), `count` values. Narrows MSB-aligned
+// samples such as P010 (10 bits in the top of each 16-bit word).
+// ---------------------------------------------------------------------------
+inline void u16ToU8(const uint16_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(src + i + 0)), 8);
+        __m128i b = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(src + i + 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(TC_SIMD_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x8_t a = vshrn_n_u16(vld1q_u16(src + i + 0), 8);
+        uint8x8_t b = vshrn_n_u16(vld1q_u16(src + i + 8), 8);
+        vst1q_u8(dst + i, vcombine_u8(a, b));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = (uint8_t)(src[i] >> 8);
+}
+
+// ---------------------------------------------------------------------------
+// YUYV (packed 4:2:2, webcams) -> RGBA8, BT.601 limited range. `count` is in
+// pixels and must be even (one Y0 U Y1 V group per pixel pair). Integer math,
+// identical on every path.
+// ---------------------------------------------------------------------------
+namespace detail {
+inline uint8_t clampU8(int v) { return (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v); }
+
+#if defined(TC_SIMD_SSE2)
+// Two 16-bit coefficients in each 32-bit lane, for _mm_madd_epi16.
+inline __m128i coeffPair(int lo, int hi) {
+    return _mm_set1_epi32((int)(((uint32_t)(uint16_t)hi << 16) | (uint16_t)lo));
+}
+#endif
+} // namespace detail
+
+inline void yuyvToRgba(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    // 8 pixels per step. Each product sum is formed in 32 bits
+    // (_mm_madd_epi16) so the results match the scalar loop exactly.
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    const __m128i k16  = _mm_set1_epi16(16);
+    const __m128i k128 = _mm_set1_epi16(128);
+    const __m128i one  = _mm_set1_epi16(1);
+    const __m128i kR   = detail::coeffPair(298, 409);    // c, e
+    const __m128i kB   = detail::coeffPair(298, 516);    // c, d
+    const __m128i kG0  = detail::coeffPair(298, -100);   // c, d
+    const __m128i kG1  = detail::coeffPair(-208, 128);   // e, 1 (+ rounding)
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+    auto channel = [](__m128i lo, __m128i hi) {   // 2 x 4 int32 -> 8 x u8 (low half)
+        __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+        return _mm_packus_epi16(v, v);
+    };
+    for (; i + 8 <= count; i += 8) {
+        const __m128i p  = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        const __m128i c  = _mm_sub_epi16(_mm_and_si128(p, lowByte), k16);   // y - 16
+        const __m128i uv = _mm_sub_epi16(_mm_srli_epi16(p, 8), k128);       // u0 v0 u1 v1 ...
+        // Each pixel pair's u (d) and v (e), repeated for both pixels.
+        const __m128i d = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, 0xA0), 0xA0);
+        const __m128i e = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, 0xF5), 0xF5);
+
+        const __m128i ceLo = _mm_unpacklo_epi16(c, e), ceHi = _mm_unpackhi_epi16(c, e);
+        const __m128i cdLo = _mm_unpacklo_epi16(c, d), cdHi = _mm_unpackhi_epi16(c, d);
+        const __m128i e1Lo = _mm_unpacklo_epi16(e, one), e1Hi = _mm_unpackhi_epi16(e, one);
+
+        const __m128i r = channel(_mm_add_epi32(_mm_madd_epi16(ceLo, kR), round),
+                                  _mm_add_epi32(_mm_madd_epi16(ceHi, kR), round));
+        const __m128i g = channel(_mm_add_epi32(_mm_madd_epi16(cdLo, kG0), _mm_madd_epi16(e1Lo, kG1)),
+                                  _mm_add_epi32(_mm_madd_epi16(cdHi, kG0), _mm_madd_epi16(e1Hi, kG1)));
+        const __m128i b = channel(_mm_add_epi32(_mm_madd_epi16(cdLo, kB), round),
+                                  _mm_add_epi32(_mm_madd_epi16(cdHi, kB), round));
+
+        const __m128i rg = _mm_unpacklo_epi8(r, g);       // r0 g0 r1 g1 ...
+        const __m128i ba = _mm_unpacklo_epi8(b, alpha);   // b0 a  b1 a  ...
+        _mm_storeu_si128((__m128i*)(dst + i * 4 +  0), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+#elif defined(TC_SIMD_NEON)
+    // 16 pixels per step: vld4 splits Y0 / U / Y1 / V of 8 pixel pairs.
+    const uint8x16_t alpha = vdupq_n_u8(255);
+    auto widen = [](uint8x8_t v, int16_t bias) {
+        return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(bias));
+    };
+    // (k0 * a + k1 * b + k2 * c + 128) >> 8 in 32 bits, clamped to u8
+    auto dot = [](int16x8_t a, int16_t ka, int16x8_t b, int16_t kb, int16x8_t c, int16_t kc) {
+        int32x4_t lo = vdupq_n_s32(128), hi = vdupq_n_s32(128);
+        lo = vmlal_n_s16(lo, vget_low_s16(a), ka);  hi = vmlal_n_s16(hi, vget_high_s16(a), ka);
+        lo = vmlal_n_s16(lo, vget_low_s16(b), kb);  hi = vmlal_n_s16(hi, vget_high_s16(b), kb);
+        lo = vmlal_n_s16(lo, vget_low_s16(c), kc);  hi = vmlal_n_s16(hi, vget_high_s16(c), kc);
+        return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, 8)), vqmovn_s32(vshrq_n_s32(hi, 8))));
+    };
+    for (; i + 16 <= count; i += 16) {
+        const uint8x8x4_t p = vld4_u8(src + i * 2);
+        const int16x8_t d = widen(p.val[1], 128);
+        const int16x8_t e = widen(p.val[3], 128);
+        uint8x8x2_t r, g, b;
+        for (int k = 0; k < 2; ++k) {
+            const int16x8_t c = widen(p.val[k * 2], 16);   // even, then odd pixels
+            r.val[k] = dot(c, 298, e, 409, d, 0);
+            g.val[k] = dot(c, 298, d, -100, e, -208);
+            b.val[k] = dot(c, 298, d, 516, e, 0);
+        }
+        // Re-interleave even / odd pixels.
+        const uint8x8x2_t rz = vzip_u8(r.val[0], r.val[1]);
+        const uint8x8x2_t gz = vzip_u8(g.val[0], g.val[1]);
+        const uint8x8x2_t bz = vzip_u8(b.val[0], b.val[1]);
+        uint8x16x4_t rgba = {{ vcombine_u8(rz.val[0], rz.val[1]), vcombine_u8(gz.val[0], gz.val[1]),
+                               vcombine_u8(bz.val[0], bz.val[1]), alpha }};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+#endif
+    for (; i + 2 <= count; i += 2) {
+        const uint8_t* s = src + i * 2;
+        const int d = s[1] - 128;
+        const int e = s[3] - 128;
+        for (int k = 0; k < 2; ++k) {
+            const int c = s[k * 2] - 16;
+            uint8_t* o = dst + (i + k) * 4;
+            o[0] = detail::clampU8((298 * c + 409 * e + 128) >> 8);
+            o[1] = detail::clampU8((298 * c - 100 * d - 208 * e + 128) >> 8);
+            o[2] = detail::clampU8((298 * c + 516 * d + 128) >> 8);
+            o[3] = 255;
+        }
+    }
+}
+
+// YUYV -> Y plane (`count` bytes) + interleaved UV plane (`count` bytes, one
+// U V pair per pixel pair): a 4:2:2 layout the NV12 video shader samples
+// as is, so the conversion to RGB happens on the GPU. Plain de-interleave.
+inline void yuyvToPlanes(const uint8_t* src, uint8_t* y, uint8_t* uv, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + i * 2 + 16));
+        _mm_storeu_si128((__m128i*)(y + i),
+                         _mm_packus_epi16(_mm_and_si128(a, lowByte), _mm_and_si128(b, lowByte)));
+        _mm_storeu_si128((__m128i*)(uv + i),
+                         _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+#elif defined(TC_SIMD_NEON)
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x2_t p = vld2q_u8(src + i * 2);
+        vst1q_u8(y + i, p.val[0]);
+        vst1q_u8(uv + i, p.val[1]);
+    }
+#endif
+    for (; i < count; ++i) {
+        y[i]  = src[i * 2];
+        uv[i] = src[i * 2 + 1];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RGBA8 -> planar YUV 4:2:0 for video encoders: I420 (Y, U, V planes) or NV12
+// (Y + interleaved UV). BT.709 limited range; chroma is the rounded mean of
+// each 2x2 block (the last column / row pairs with itself when odd). Strides
+// are in bytes, so planes can follow any layout (e.g. GStreamer's 4-byte
+// aligned rows). Integer math, identical on every path:
+//   Y = ((47 R + 157 G + 16 B + 128) >> 8) + 16
+//   U = ((-26 R - 86 G + 112 B + 128) >> 8) + 128
+//   V = ((112 R - 102 G - 10 B + 128) >> 8) + 128
+// ---------------------------------------------------------------------------
+namespace detail {
+inline uint8_t lumaBt709(const uint8_t* p) {
+    return (uint8_t)(((47 * p[0] + 157 * p[1] + 16 * p[2] + 128) >> 8) + 16);
+}
+
+#if defined(TC_SIMD_SSE2)
+// The sums fit 16 bits (Y unsigned, U / V signed), so wrapping 16-bit
+// multiplies give the exact result.
+inline void splitRgb8(const uint8_t* p, __m128i& r, __m128i& g, __m128i& b) {
+    const __m128i lo = _mm_loadu_si128((const __m128i*)p);
+    const __m128i hi = _mm_loadu_si128((const __m128i*)(p + 16));
+    const __m128i m = _mm_set1_epi32(0xFF);
+    r = _mm_packs_epi32(_mm_and_si128(lo, m), _mm_and_si128(hi, m));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), m), _mm_and_si128(_mm_srli_epi32(hi, 8), m));
+    b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), m), _mm_and_si128(_mm_srli_epi32(hi, 16), m));
+}
+
+inline __m128i luma8(__m128i r, __m128i g, __m128i b) {
+    const __m128i s = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(47)), _mm_mullo_epi16(g, _mm_set1_epi16(157))),
+        _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(16)), _mm_set1_epi16(128)));
+    return _mm_add_epi16(_mm_srli_epi16(s, 8), _mm_set1_epi16(16));
+}
+
+// Rounded 2x2 means of two rows of 8 -> 4 x 32-bit lanes
+inline __m128i blockMean4(__m128i top, __m128i bottom) {
+    const __m128i s = _mm_add_epi16(top, bottom);
+    const __m128i pairs = _mm_add_epi32(_mm_and_si128(s, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(s, 16));
+    return _mm_srli_epi32(_mm_add_epi32(pairs, _mm_set1_epi32(2)), 2);
+}
+
+inline __m128i chroma8(__m128i r, __m128i g, __m128i b, short kr, short kg, short kb) {
+    const __m128i s = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(kr)), _mm_mullo_epi16(g, _mm_set1_epi16(kg))),
+        _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(kb)), _mm_set1_epi16(128)));
+    return _mm_add_epi16(_mm_srai_epi16(s, 8), _mm_set1_epi16(128));
+}
+#endif
+
+// Two source rows -> two Y rows + one chroma row. uv != nullptr: NV12
+// (interleaved), else separate u / v.
+inline void rgbaRowsToYuv420(const uint8_t* r0, const uint8_t* r1, size_t w,
+                             uint8_t* y0, uint8_t* y1,
+                             uint8_t* u, uint8_t* v, uint8_t* uv) {
+    size_t x = 0;
+#if defined(TC_SIMD_SSE2)
+    for (; x + 16 <= w; x += 16) {
+        __m128i R[2][2], G[2][2], B[2][2];   // [row][half]
+        for (int k = 0; k < 2; ++k) {
+            splitRgb8(r0 + (x + k * 8) * 4, R[0][k], G[0][k], B[0][k]);
+            splitRgb8(r1 + (x + k * 8) * 4, R[1][k], G[1][k], B[1][k]);
+        }
+        _mm_storeu_si128((__m128i*)(y0 + x), _mm_packus_epi16(luma8(R[0][0], G[0][0], B[0][0]),
+                                                               luma8(R[0][1], G[0][1], B[0][1])));
+        _mm_storeu_si128((__m128i*)(y1 + x), _mm_packus_epi16(luma8(R[1][0], G[1][0], B[1][0]),
+                                                               luma8(R[1][1], G[1][1], B[1][1])));
+        const __m128i mr = _mm_packs_epi32(blockMean4(R[0][0], R[1][0]), blockMean4(R[0][1], R[1][1]));
+        const __m128i mg = _mm_packs_epi32(blockMean4(G[0][0], G[1][0]), blockMean4(G[0][1], G[1][1]));
+        const __m128i mb = _mm_packs_epi32(blockMean4(B[0][0], B[1][0]), blockMean4(B[0][1], B[1][1]));
+        const __m128i cu = chroma8(mr, mg, mb, -26, -86, 112);
+        const __m128i cv = chroma8(mr, mg, mb, 112, -102, -10);
+        if (uv) {
+            _mm_storeu_si128((__m128i*)(uv + x), _mm_unpacklo_epi8(_mm_packus_epi16(cu, cu),
+                                                                    _mm_packus_epi16(cv, cv)));
+        } else {
+            _mm_storel_epi64((__m128i*)(u + x / 2), _mm_packus_epi16(cu, cu));
+            _mm_storel_epi64((__m128i*)(v + x / 2), _mm_packus_epi16(cv, cv));
+        }
+    }
+#elif defined(TC_SIMD_NEON)
+    // Every partial sum fits 16 bits: Y unsigned, U / V signed.
+    auto luma = [](uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+        uint16x8_t s = vmull_u8(r, vdup_n_u8(47));
+        s = vmlal_u8(s, g, vdup_n_u8(157));
+        s = vmlal_u8(s, b, vdup_n_u8(16));
+        return vadd_u8(vshrn_n_u16(vaddq_u16(s, vdupq_n_u16(128)), 8), vdup_n_u8(16));
+    };
+    auto chroma = [](int16x8_t r, int16x8_t g, int16x8_t b, int16_t kr, int16_t kg, int16_t kb) {
+        int16x8_t s = vmlaq_n_s16(vdupq_n_s16(128), r, kr);
+        s = vmlaq_n_s16(s, g, kg);
+        s = vmlaq_n_s16(s, b, kb);
+        return vqmovun_s16(vaddq_s16(vshrq_n_s16(s, 8), vdupq_n_s16(128)));
+    };
+    for (; x + 16 <= w; x += 16) {
+        const uint8x16x4_t a = vld4q_u8(r0 + x * 4);
+        const uint8x16x4_t c = vld4q_u8(r1 + x * 4);
+        vst1q_u8(y0 + x, vcombine_u8(luma(vget_low_u8(a.val[0]), vget_low_u8(a.val[1]), vget_low_u8(a.val[2])),
+                                     luma(vget_high_u8(a.val[0]), vget_high_u8(a.val[1]), vget_high_u8(a.val[2]))));
+        vst1q_u8(y1 + x, vcombine_u8(luma(vget_low_u8(c.val[0]), vget_low_u8(c.val[1]), vget_low_u8(c.val[2])),
+                                     luma(vget_high_u8(c.val[0]), vget_high_u8(c.val[1]), vget_high_u8(c.val[2]))));
+        // Rounded 2x2 means: horizontal pairs of both rows, (s + 2) >> 2
+        int16x8_t m[3];
+        for (int k = 0; k < 3; ++k) {
+            m[k] = vreinterpretq_s16_u16(vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(a.val[k]), c.val[k]), 2));
+        }
+        const uint8x8_t cu = chroma(m[0], m[1], m[2], -26, -86, 112);
+        const uint8x8_t cv = chroma(m[0], m[1], m[2], 112, -102, -10);
+        if (uv) {
+            const uint8x8x2_t pair = {{ cu, cv }};
+            vst2_u8(uv + x, pair);
+        } else {
+            vst1_u8(u + x / 2, cu);
+            vst1_u8(v + x / 2, cv);
+        }
+    }
+#endif
+    for (; x < w; x += 2) {
+        const size_t x1 = x + 1 < w ? x + 1 : x;
+        const uint8_t* p[4] = { r0 + x * 4, r0 + x1 * 4, r1 + x * 4, r1 + x1 * 4 };
+        y0[x] = lumaBt709(p[0]);
+        y1[x] = lumaBt709(p[2]);
+        if (x1 != x) {
+            y0[x1] = lumaBt709(p[1]);
+            y1[x1] = lumaBt709(p[3]);
+        }
+        int m[3];
+        for (int k = 0; k < 3; ++k) m[k] = (p[0][k] + p[1][k] + p[2][k] + p[3][k] + 2) >> 2;
+        const uint8_t cu = (uint8_t)(((-26 * m[0] - 86 * m[1] + 112 * m[2] + 128) >> 8) + 128);
+        const uint8_t cv = (uint8_t)(((112 * m[0] - 102 * m[1] - 10 * m[2] + 128) >> 8) + 128);
+        if (uv) {
+            uv[x] = cu;
+            uv[x + 1] = cv;
+        } else {
+            u[x / 2] = cu;
+            v[x / 2] = cv;
+        }
+    }
+}
+} // namespace detail
+
+// `srcStride` / plane strides in bytes. U and V are (w + 1) / 2 x (h + 1) / 2.
+inline void rgbaToI420(const uint8_t* src, size_t srcStride, size_t w, size_t h,
+                       uint8_t* y, size_t yStride, uint8_t* u, size_t uStride,
+                       uint8_t* v, size_t vStride) {
+    for (size_t row = 0; row < h; row += 2) {
+        const size_t row1 = row + 1 < h ? row + 1 : row;
+        detail::rgbaRowsToYuv420(src + row * srcStride, src + row1 * srcStride, w,
+                                 y + row * yStride, y + row1 * yStride,
+                                 u + row / 2 * uStride, v + row / 2 * vStride, nullptr);
+    }
+}
+
+// UV plane: (w + 1) / 2 U,V pairs per row, (h + 1) / 2 rows.
+inline void rgbaToNv12(const uint8_t* src, size_t srcStride, size_t w, size_t h,
+                       uint8_t* y, size_t yStride, uint8_t* uv, size_t uvStride) {
+    for (size_t row = 0; row < h; row += 2) {
+        const size_t row1 = row + 1 < h ? row + 1 : row;
+        detail::rgbaRowsToYuv420(src + row * srcStride, src + row1 * srcStride, w,
+                                 y + row * yStride, y + row1 * yStride,
+                                 nullptr, nullptr, uv + row / 2 * uvStride);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Premultiply / unpremultiply (RGBA8). Rounded exactly: c * a / 255.
+// ---------------------------------------------------------------------------
+namespace detail {
+// round(x / 255) for x in [0, 255 * 255]
+inline uint8_t div255(uint32_t x) {
+    x += 128;
+    return (uint8_t)((x + (x >> 8)) >> 8);
+}
+} // namespace detail
+
+inline void premultiply(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(TC_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    // Multiplier lane 3 (alpha) is forced to 255 so alpha passes through.
+    const __m128i alphaLane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i keepRGB   = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    auto mul2 = [&](__m128i px) {  // two pixels as 8 x u16
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, 0xFF), 0xFF);
+        a = _mm_or_si128(_mm_and_si128(a, keepRGB), alphaLane);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, a), bias);
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    };
+    for (; i + 4 <= count; i += 4) {
+        __m128i p  = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i lo = mul2(_mm_unpacklo_epi8(p, zero));
+        __m128i hi = mul2(_mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(TC_SIMD_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        for (int c = 0; c < 3; ++c) {
+            uint16x8_t t = vmull_u8(p.val[c], p.val[3]);
+            // (t + 128 + ((t + 128) >> 8)) >> 8
+            p.val[c] = vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8);
+        }
+        vst4_u8(dst + i * 4, p);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint32_t a = src[i * 4 + 3];
+        dst[i * 4 + 0] = detail::div255(src[i * 4 + 0] * a);
+        dst[i * 4 + 1] = detail::div255(src[i * 4 + 1] * a);
+        dst[i * 4 + 2] = detail::div255(src[i * 4 + 2] * a);
+        dst[i * 4 + 3] = (uint8_t)a;
+    }
+}
+
+// Inverse of premultiply. Fully transparent pixels become (0, 0, 0, 0).
+// Scalar with a reciprocal table: there is no fast vector integer divide and
+// the table keeps this well under the cost of the memory traffic.
+inline void unpremultiply(const uint8_t* src, uint8_t* dst, size_t count) {
+    struct Recip {
+        uint32_t v[256];
+        Recip() {
+            v[0] = 0;
+            for (uint32_t a = 1; a < 256; ++a) v[a] = (255u * 65536u + a / 2) / a;
+        }
+    };
+    static const Recip recip;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t a = src[i * 4 + 3];
+        uint32_t r = recip.v[a];
+        for (int c = 0; c < 3; ++c) {
+            uint32_t v = (src[i * 4 + c] * r + 32768u) >> 16;
+            dst[i * 4 + c] = (uint8_t)(v > 255 ? 255 : v);
+        }
+        dst[i * 4 + 3] = (uint8_t)a;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Premultiply / unpremultiply (RGBA32F)
+// ---------------------------------------------------------------------------
+inline void premultiply(const float* src, float* dst, size_t count) {
+    using namespace internal::simd;
+    for (size_t i = 0; i < count; ++i) {
+        const float a = src[i * 4 + 3];
+        f32x4 p = mul(load(src + i * 4), set1(a));
+        store(dst + i * 4, p);
+        dst[i * 4 + 3] = a;
+    }
+}
+
+inline void unpremultiply(const float* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float a = src[i * 4 + 3];
+        const float inv = (a > 0.0f) ? 1.0f / a : 0.0f;
+        dst[i * 4 + 0] = src[i * 4 + 0] * inv;
+        dst[i * 4 + 1] = src[i * 4 + 1] * inv;
+        dst[i * 4 + 2] = src[i * 4 + 2] * inv;
+        dst[i * 4 + 3] = a;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Channel extraction: channel `channel` of an interleaved `channels`-wide
+// buffer into a tightly packed plane. Works for any element type (U8 for
+// colour, uint16_t depth, float IR).
+// ---------------------------------------------------------------------------
+template<typename T>
+inline void extractChannel(const T* src, int channels, int channel, T* dst, size_t count) {
+    const T* s = src + channel;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        dst[i + 0] = s[(i + 0) * channels];
+        dst[i + 1] = s[(i + 1) * channels];
+        dst[i + 2] = s[(i + 2) * channels];
+        dst[i + 3] = s[(i + 3) * channels];
+    }
+    for (; i < count; ++i) dst[i] = s[i * channels];
+}
+
+#if defined(TC_SIMD_NEON)
+// RGBA8 fast path: one vld4 de-interleaves 16 pixels.
+template<>
+inline void extractChannel<uint8_t>(const uint8_t* src, int channels, int channel, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    if (channels == 4) {
+        for (; i + 16 <= count; i += 16) {
+            uint8x16x4_t p = vld4q_u8(src + i * 4);
+            vst1q_u8(dst + i, p.val[channel & 3]);
+        }
+    }
+    for (; i < count; ++i) dst[i] = src[i * channels + channel];
+}
+#endif
+
+} // namespace pixelconv
+} // namespace trussc
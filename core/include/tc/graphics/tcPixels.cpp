@@ -3,6 +3,8 @@
 // =============================================================================
 
 #include "TrussC.h"
+#include "tc/utils/tcSimd.h"
+#include "tc/graphics/tcGammaTables.h"
 
 namespace trussc {
 
@@ -42,11 +44,11 @@ bool Pixels::loadPlatform(const fs::path& /*path*/) {
 #endif
 
 // =============================================================================
-// Image operations: halve / resize / crop / mirror
+// Image operations: halve / resize / crop / mirror, MipChain
 // =============================================================================
 //
 // Math is done in linear light for U8 buffers. The convention used by the
-// gamma helpers (sRGBToLinear / linearToSRGB above in the header) is gamma
+// gamma helpers (sRGBToLinear / GammaTables in tcGammaTables.h) is gamma
 // 2.2 — same as the FBO mipmap downsample shader and the rest of the
 // gamma-correct paths. F32 buffers are assumed to already be linear (HDR
 // sources, intermediate compute), so no conversion is applied.
@@ -58,6 +60,9 @@ bool Pixels::loadPlatform(const fs::path& /*path*/) {
 
 namespace {
 
+using internal::GammaTables;
+using internal::gammaTables;
+
 // Catmull-Rom bicubic kernel weight at signed distance d. The result is
 // undefined outside [-2, 2]; callers are expected to only sample within
 // that window. Sum of weights over -1, 0, 1, 2 is exactly 1, so the
@@ -69,10 +74,10 @@ inline float catmullRomWeight(float d) {
     return 0.0f;
 }
 
-// sRGB <-> linear conversion (gamma 2.2 approximation), same convention
-// as the rest of the gamma-correct pipeline.
+// sRGB -> linear conversion (gamma 2.2 approximation), same convention
+// as the rest of the gamma-correct pipeline. The inverse is
+// GammaTables::encode.
 inline float sRGBToLinear(float s) { return std::pow(s, 2.2f); }
-inline float linearToSRGB(float l) { return std::pow(l, 1.0f / 2.2f); }
 
 // For 3- and 4-channel buffers, the R/G/B channels are sRGB-encoded;
 // alpha (channel 3 in RGBA) and anything in a single-/two-channel buffer
@@ -88,62 +93,11 @@ inline float clampf(float v, float lo, float hi) {
 
 } // anonymous namespace
 
-void Pixels::halve() {
-    if (!allocated_) return;
-    int newW = std::max(width_ / 2, 1);
-    int newH = std::max(height_ / 2, 1);
-
-    Pixels dst;
-    dst.allocate(newW, newH, channels_, format_);
-
-    const bool isF32 = (format_ == PixelFormat::F32);
-    const int   ch    = channels_;
-    const int   sw    = width_;
-    const int   sh    = height_;
-
-    auto srcF = static_cast<const float*>(data_);
-    auto srcU = static_cast<const unsigned char*>(data_);
-    auto dstF = static_cast<float*>(dst.data_);
-    auto dstU = static_cast<unsigned char*>(dst.data_);
-
-    for (int y = 0; y < newH; y++) {
-        int sy0 = std::min(2 * y,     sh - 1);
-        int sy1 = std::min(2 * y + 1, sh - 1);
-        for (int x = 0; x < newW; x++) {
-            int sx0 = std::min(2 * x,     sw - 1);
-            int sx1 = std::min(2 * x + 1, sw - 1);
-            for (int c = 0; c < ch; c++) {
-                int i00 = (sy0 * sw + sx0) * ch + c;
-                int i01 = (sy0 * sw + sx1) * ch + c;
-                int i10 = (sy1 * sw + sx0) * ch + c;
-                int i11 = (sy1 * sw + sx1) * ch + c;
-                if (isF32) {
-                    // F32 = already linear, average directly.
-                    float avg = (srcF[i00] + srcF[i01] + srcF[i10] + srcF[i11]) * 0.25f;
-                    dstF[(y * newW + x) * ch + c] = avg;
-                } else {
-                    bool linear = isLinearChannel(ch, c);
-                    auto fetch = [&](int i) -> float {
-                        float v = srcU[i] / 255.0f;
-                        return linear ? v : sRGBToLinear(v);
-                    };
-                    float avg = (fetch(i00) + fetch(i01) + fetch(i10) + fetch(i11)) * 0.25f;
-                    if (!linear) avg = linearToSRGB(avg);
-                    avg = clampf(avg, 0.0f, 1.0f);
-                    dstU[(y * newW + x) * ch + c] = static_cast<unsigned char>(std::lround(avg * 255.0f));
-                }
-            }
-        }
-    }
-
-    *this = std::move(dst);
-}
-
 void Pixels::crop(int x, int y, int w, int h) {
     if (!allocated_ || w <= 0 || h <= 0) return;
 
     Pixels dst;
-    dst.allocate(w, h, channels_, format_);
+    allocateLike(dst, w, h);
 
     const size_t bpp = (format_ == PixelFormat::F32)
                        ? (size_t)channels_ * sizeof(float)
@@ -202,196 +156,507 @@ void Pixels::mirror(bool horizontal, bool vertical) {
     }
 }
 
-// One-axis resample helper for Pixels::resize.
+// =============================================================================
+// Pixels::resize — precomputed separable filter, LUT gamma, SIMD, threaded
+// =============================================================================
 //
-// Resamples `src` along the X axis only into `dst`. Both buffers must
-// match in height, channels and format; only the widths differ. Picks
-// BoxArea when downscaling (`dstW < srcW`) and Catmull-Rom bicubic when
-// upscaling. For U8 buffers, RGB channels run through the gamma 2.2
-// curve so the average lives in linear light; alpha and non-RGB buffers
-// stay linear.
-static void resample1D_X(const Pixels& src, Pixels& dst) {
+// The filter for each axis (BoxArea when shrinking, Catmull-Rom when
+// growing) depends only on the source/destination length, so it is built
+// once per resize as a flat table of (source index, weight) taps per
+// destination sample. Rows are then filtered X-first into a small per-band
+// float buffer and Y-second into the destination, with output bands split
+// across WorkerPool::shared().
+//
+// U8 data never goes through std::pow in the loop: decoding is a 256-entry
+// table and encoding is a threshold search over the 256 sRGB codes (same
+// result as lround(pow(v, 1/2.2) * 255), see tcGammaTables.h). The X-pass
+// result is clamped to [0, 1] and re-quantised to U8 precision (via the same
+// tables) before the Y pass, so results stay within ±1 LSB of the original
+// two-buffer implementation, which stored that intermediate as a U8 image
+// (core/tests/pixelsResize).
+
+namespace {
+
+// Filter taps for one axis. Destination sample `i` reads `taps` source
+// samples index[i * taps + k] weighted by weight[i * taps + k]. Rows with
+// fewer real taps are padded with zero weights.
+struct ResampleAxis {
+    int taps = 0;
+    std::vector<int> index;
+    std::vector<float> weight;
+};
+
+ResampleAxis buildResampleAxis(int srcLen, int dstLen) {
+    ResampleAxis axis;
+
+    if (srcLen == dstLen) {
+        axis.taps = 1;
+        axis.index.resize(dstLen);
+        axis.weight.assign(dstLen, 1.0f);
+        for (int i = 0; i < dstLen; i++) axis.index[i] = i;
+        return axis;
+    }
+
+    const float scale = (float)srcLen / (float)dstLen;
+
+    if (dstLen > srcLen) {
+        // Catmull-Rom bicubic — 4 neighbours of the sub-pixel position,
+        // clamped to source bounds.
+        axis.taps = 4;
+        axis.index.resize((size_t)dstLen * 4);
+        axis.weight.resize((size_t)dstLen * 4);
+        for (int i = 0; i < dstLen; i++) {
+            float center = (i + 0.5f) * scale - 0.5f;
+            int cf = (int)std::floor(center);
+            float t = center - (float)cf;
+            for (int k = -1; k <= 2; k++) {
+                int si = std::clamp(cf + k, 0, srcLen - 1);
+                axis.index[(size_t)i * 4 + k + 1] = si;
+                axis.weight[(size_t)i * 4 + k + 1] = catmullRomWeight((float)k - t);
+            }
+        }
+        return axis;
+    }
+
+    // BoxArea — every source texel inside [startF, endF) contributes
+    // proportional to its overlap with that interval.
+    axis.taps = (int)std::ceil(scale) + 1;
+    axis.index.assign((size_t)dstLen * axis.taps, 0);
+    axis.weight.assign((size_t)dstLen * axis.taps, 0.0f);
+    for (int i = 0; i < dstLen; i++) {
+        float startF = i * scale;
+        float endF   = (i + 1) * scale;
+        int startI = (int)std::floor(startF);
+        int endI   = std::min((int)std::ceil(endF), srcLen);
+        int*   idx = &axis.index[(size_t)i * axis.taps];
+        float* wgt = &axis.weight[(size_t)i * axis.taps];
+        int n = 0;
+        float total = 0.0f;
+        for (int si = startI; si < endI && n < axis.taps; si++) {
+            float w = std::min(endF, (float)(si + 1)) - std::max(startF, (float)si);
+            if (w <= 0.0f) continue;
+            idx[n] = si;
+            wgt[n] = w;
+            total += w;
+            n++;
+        }
+        if (total > 0.0f) {
+            for (int k = 0; k < n; k++) wgt[k] /= total;
+        } else {
+            idx[0] = std::min(startI, srcLen - 1);
+            wgt[0] = 1.0f;
+            n = 1;
+        }
+        // Padding taps repeat the last real index (always in bounds).
+        for (int k = n; k < axis.taps; k++) idx[k] = idx[n - 1];
+    }
+    return axis;
+}
+
+inline uint8_t encodeUnorm(float v) {
+    v = clampf(v, 0.0f, 1.0f);
+    return static_cast<uint8_t>(v * 255.0f + 0.5f);
+}
+
+// Per-thread scratch rows, reused across resizes so steady-state resizing
+// of same-sized frames does not allocate.
+struct ResampleScratch {
+    std::vector<float> srcRow;
+    std::vector<float> xRows;
+    std::vector<float> outRow;
+    std::vector<const float*> tapRows;
+};
+
+ResampleScratch& resampleScratch() {
+    thread_local ResampleScratch scratch;
+    return scratch;
+}
+
+// X pass: one source row (already linear float, `sw * ch` values) into
+// `dw * ch` values.
+void resampleRowX(const float* src, float* dst, int dw, int ch, const ResampleAxis& ax, bool clampOut) {
+    using namespace internal::simd;
+    const int taps = ax.taps;
+    const int*   idx = ax.index.data();
+    const float* wgt = ax.weight.data();
+
+    if (ch == 4) {
+        // One RGBA pixel per vector.
+        const f32x4 lo = zero();
+        const f32x4 hi = set1(1.0f);
+        for (int x = 0; x < dw; x++) {
+            const int*   xi = idx + (size_t)x * taps;
+            const float* xw = wgt + (size_t)x * taps;
+            f32x4 acc = zero();
+            for (int k = 0; k < taps; k++) {
+                acc = madd(acc, set1(xw[k]), load(src + (size_t)xi[k] * 4));
+            }
+            if (clampOut) acc = min(max(acc, lo), hi);
+            store(dst + (size_t)x * 4, acc);
+        }
+        return;
+    }
+
+    for (int x = 0; x < dw; x++) {
+        const int*   xi = idx + (size_t)x * taps;
+        const float* xw = wgt + (size_t)x * taps;
+        for (int c = 0; c < ch; c++) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps; k++) {
+                acc += xw[k] * src[(size_t)xi[k] * ch + c];
+            }
+            if (clampOut) acc = clampf(acc, 0.0f, 1.0f);
+            dst[(size_t)x * ch + c] = acc;
+        }
+    }
+}
+
+// Y pass: weighted sum of `taps` rows of `n` floats.
+void resampleRowY(const float* const* rows, const float* wgt, int taps, float* dst, int n) {
+    using namespace internal::simd;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        f32x4 acc = zero();
+        for (int k = 0; k < taps; k++) {
+            acc = madd(acc, set1(wgt[k]), load(rows[k] + i));
+        }
+        store(dst + i, acc);
+    }
+    for (; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) acc += wgt[k] * rows[k][i];
+        dst[i] = acc;
+    }
+}
+
+// Resample the destination rows [y0, y1).
+void resampleBand(const Pixels& src, Pixels& dst, const ResampleAxis& ax, const ResampleAxis& ay,
+                  int y0, int y1) {
     const int sw = src.getWidth();
-    const int sh = src.getHeight();
     const int dw = dst.getWidth();
     const int ch = src.getChannels();
     const bool isF32 = src.isFloat();
-    const bool downscale = dw < sw;
-    const float scale = (float)sw / (float)dw;  // > 1 downscale, < 1 upscale
-
-    const float* srcF = isF32 ? static_cast<const float*>(src.getDataVoid()) : nullptr;
-    const unsigned char* srcU = isF32 ? nullptr : static_cast<const unsigned char*>(src.getDataVoid());
-    float* dstF = isF32 ? static_cast<float*>(dst.getDataVoid()) : nullptr;
-    unsigned char* dstU = isF32 ? nullptr : static_cast<unsigned char*>(dst.getDataVoid());
-
-    auto fetchLinear = [&](int y, int x, int c, bool isLinearCh) -> float {
-        if (isF32) return srcF[((size_t)y * sw + x) * ch + c];
-        float v = srcU[((size_t)y * sw + x) * ch + c] / 255.0f;
-        return isLinearCh ? v : sRGBToLinear(v);
-    };
-    auto storeLinear = [&](int y, int x, int c, bool isLinearCh, float v) {
+    const GammaTables& gt = gammaTables();
+
+    // Source rows this band touches.
+    int lo = INT32_MAX, hi = -1;
+    for (size_t t = (size_t)y0 * ay.taps; t < (size_t)y1 * ay.taps; t++) {
+        lo = std::min(lo, ay.index[t]);
+        hi = std::max(hi, ay.index[t]);
+    }
+
+    const size_t srcRowLen = (size_t)sw * ch;
+    const size_t dstRowLen = (size_t)dw * ch;
+
+    ResampleScratch& scratch = resampleScratch();
+    scratch.srcRow.resize(srcRowLen);
+    scratch.xRows.resize((size_t)(hi - lo + 1) * dstRowLen);
+    scratch.outRow.resize(dstRowLen);
+
+    // Per-channel decode table for U8 (gamma for R/G/B of 3-4 ch buffers).
+    const float* decode[4] = {};
+    bool gamma[4] = {};
+    for (int c = 0; c < ch && c < 4; c++) {
+        gamma[c] = !isLinearChannel(ch, c);
+        decode[c] = gamma[c] ? gt.toLinear : gt.unorm;
+    }
+
+    // X pass for every source row the band needs.
+    for (int sy = lo; sy <= hi; sy++) {
+        const float* rowIn;
         if (isF32) {
-            dstF[((size_t)y * dw + x) * ch + c] = v;
-            return;
+            rowIn = src.getDataF32() + (size_t)sy * srcRowLen;
+        } else {
+            const unsigned char* u = src.getData() + (size_t)sy * srcRowLen;
+            float* f = scratch.srcRow.data();
+            for (size_t i = 0; i < srcRowLen; i += ch) {
+                for (int c = 0; c < ch; c++) f[i + c] = decode[c][u[i + c]];
+            }
+            rowIn = f;
         }
-        if (!isLinearCh) v = linearToSRGB(v);
-        if (v < 0.0f) v = 0.0f;
-        else if (v > 1.0f) v = 1.0f;
-        dstU[((size_t)y * dw + x) * ch + c] = static_cast<unsigned char>(std::lround(v * 255.0f));
-    };
+        float* xRow = scratch.xRows.data() + (size_t)(sy - lo) * dstRowLen;
+        resampleRowX(rowIn, xRow, dw, ch, ax, /*clampOut=*/!isF32);
+        if (!isF32) {
+            for (size_t i = 0; i < dstRowLen; i += ch) {
+                for (int c = 0; c < ch; c++) {
+                    float& v = xRow[i + c];
+                    v = gamma[c] ? gt.toLinear[gt.encode(v)] : gt.unorm[encodeUnorm(v)];
+                }
+            }
+        }
+    }
 
-    auto isLinearChannel = [&](int c) -> bool {
-        if (ch <= 2) return true;
-        return c == 3;  // alpha
-    };
+    // Y pass + store.
+    const int taps = ay.taps;
+    scratch.tapRows.resize(taps);
+    const float** rows = scratch.tapRows.data();
+    for (int y = y0; y < y1; y++) {
+        const int*   yi = &ay.index[(size_t)y * ay.taps];
+        const float* yw = &ay.weight[(size_t)y * ay.taps];
+        for (int k = 0; k < taps; k++) {
+            rows[k] = scratch.xRows.data() + (size_t)(yi[k] - lo) * dstRowLen;
+        }
 
-    for (int y = 0; y < sh; y++) {
-        for (int x = 0; x < dw; x++) {
+        if (isF32) {
+            resampleRowY(rows, yw, taps, dst.getDataF32() + (size_t)y * dstRowLen, (int)dstRowLen);
+            continue;
+        }
+
+        float* out = scratch.outRow.data();
+        resampleRowY(rows, yw, taps, out, (int)dstRowLen);
+        unsigned char* d = dst.getData() + (size_t)y * dstRowLen;
+        for (size_t i = 0; i < dstRowLen; i += ch) {
             for (int c = 0; c < ch; c++) {
-                bool linCh = isLinearChannel(c);
-                float v = 0.0f;
-                if (downscale) {
-                    // BoxArea — every source texel inside [startF, endF) contributes
-                    // proportional to its overlap with that interval.
-                    float startF = x * scale;
-                    float endF   = (x + 1) * scale;
-                    int startI = (int)std::floor(startF);
-                    int endI   = std::min((int)std::ceil(endF), sw);
-                    float sum = 0.0f, total = 0.0f;
-                    for (int si = startI; si < endI; si++) {
-                        float w = std::min(endF, (float)(si + 1)) - std::max(startF, (float)si);
-                        if (w <= 0.0f) continue;
-                        sum   += fetchLinear(y, si, c, linCh) * w;
-                        total += w;
-                    }
-                    v = (total > 0.0f) ? (sum / total) : fetchLinear(y, std::min(startI, sw - 1), c, linCh);
-                } else {
-                    // Catmull-Rom bicubic — 4 neighbours of the sub-pixel position
-                    // in source space, clamped to source bounds.
-                    float center = (x + 0.5f) * scale - 0.5f;
-                    int cf = (int)std::floor(center);
-                    float t = center - (float)cf;
-                    float sum = 0.0f;
-                    for (int k = -1; k <= 2; k++) {
-                        int si = cf + k;
-                        if (si < 0) si = 0;
-                        else if (si >= sw) si = sw - 1;
-                        sum += fetchLinear(y, si, c, linCh) * catmullRomWeight((float)k - t);
-                    }
-                    v = sum;
-                }
-                storeLinear(y, x, c, linCh, v);
+                d[i + c] = gamma[c] ? gt.encode(out[i + c]) : encodeUnorm(out[i + c]);
             }
         }
     }
 }
 
-// One-axis resample helper for Pixels::resize.
+} // anonymous namespace
+
+void Pixels::resize(int newW, int newH) {
+    if (!allocated_ || newW <= 0 || newH <= 0) return;
+    if (newW == width_ && newH == height_) return;
+
+    ResampleAxis ax = buildResampleAxis(width_, newW);
+    ResampleAxis ay = buildResampleAxis(height_, newH);
+
+    Pixels dst;
+    allocateLike(dst, newW, newH);
+
+    // Bands of output rows: enough of them to balance across the pool, but
+    // big enough that the rows shared at band edges are re-filtered rarely.
+    const int threads = WorkerPool::shared().getThreadCount() + 1;
+    const bool small = (size_t)newW * newH < 128 * 128;
+    int bandRows = small ? newH : std::max(8, (newH + threads * 4 - 1) / (threads * 4));
+    int bands = (newH + bandRows - 1) / bandRows;
+
+    parallelFor(0, bands, [&](int b) {
+        int y0 = b * bandRows;
+        int y1 = std::min(newH, y0 + bandRows);
+        resampleBand(*this, dst, ax, ay, y0, y1);
+    });
+
+    *this = std::move(dst);
+}
+
+// =============================================================================
+// 2x2 box downsample: Pixels::halve and MipChain
+// =============================================================================
 //
-// Resamples `src` along the Y axis only into `dst`. Mirrors `resample1D_X`;
-// only width is shared between buffers, heights differ.
-static void resample1D_Y(const Pixels& src, Pixels& dst) {
-    const int sw = src.getWidth();
-    const int sh = src.getHeight();
-    const int dh = dst.getHeight();
-    const int ch = src.getChannels();
-    const bool isF32 = src.isFloat();
-    const bool downscale = dh < sh;
-    const float scale = (float)sh / (float)dh;
-
-    const float* srcF = isF32 ? static_cast<const float*>(src.getDataVoid()) : nullptr;
-    const unsigned char* srcU = isF32 ? nullptr : static_cast<const unsigned char*>(src.getDataVoid());
-    float* dstF = isF32 ? static_cast<float*>(dst.getDataVoid()) : nullptr;
-    unsigned char* dstU = isF32 ? nullptr : static_cast<unsigned char*>(dst.getDataVoid());
-
-    auto fetchLinear = [&](int y, int x, int c, bool isLinearCh) -> float {
-        if (isF32) return srcF[((size_t)y * sw + x) * ch + c];
-        float v = srcU[((size_t)y * sw + x) * ch + c] / 255.0f;
-        return isLinearCh ? v : sRGBToLinear(v);
-    };
-    auto storeLinear = [&](int y, int x, int c, bool isLinearCh, float v) {
-        if (isF32) {
-            dstF[((size_t)y * sw + x) * ch + c] = v;
-            return;
+// Output texel (x, y) averages source texels (2x, 2y) .. (2x+1, 2y+1),
+// clamped to the source edge (a 1-texel-wide source repeats its only column).
+// U8 goes through the gamma LUTs instead of pow(); the sums are formed in the
+// same order as the original per-texel loop, so the output is bit-identical
+// to it. 4-channel buffers average one f32x4 per texel.
+
+namespace {
+
+struct HalveSource {
+    const void* data;
+    int width;
+    int height;
+};
+
+void halveRowU8(const unsigned char* r0, const unsigned char* r1, int sw,
+                unsigned char* out, int ch, int x0, int x1) {
+    const GammaTables& gt = gammaTables();
+    const float* lut[4];
+    for (int c = 0; c < 4; c++) lut[c] = isLinearChannel(ch, c) ? gt.unorm : gt.toLinear;
+
+    if (ch == 4) {
+        using namespace internal::simd;
+        const f32x4 quarter = set1(0.25f);
+        for (int x = x0; x < x1; x++) {
+            const unsigned char* p00 = r0 + std::min(2 * x,     sw - 1) * 4;
+            const unsigned char* p01 = r0 + std::min(2 * x + 1, sw - 1) * 4;
+            const unsigned char* p10 = r1 + std::min(2 * x,     sw - 1) * 4;
+            const unsigned char* p11 = r1 + std::min(2 * x + 1, sw - 1) * 4;
+            alignas(16) float t[4][4];
+            for (int c = 0; c < 4; c++) {
+                t[0][c] = lut[c][p00[c]];
+                t[1][c] = lut[c][p01[c]];
+                t[2][c] = lut[c][p10[c]];
+                t[3][c] = lut[c][p11[c]];
+            }
+            f32x4 sum = add(add(add(load(t[0]), load(t[1])), load(t[2])), load(t[3]));
+            store(t[0], mul(sum, quarter));
+            unsigned char* d = out + x * 4;
+            d[0] = gt.encode(t[0][0]);
+            d[1] = gt.encode(t[0][1]);
+            d[2] = gt.encode(t[0][2]);
+            d[3] = static_cast<unsigned char>(std::lround(clampf(t[0][3], 0.0f, 1.0f) * 255.0f));
         }
-        if (!isLinearCh) v = linearToSRGB(v);
-        if (v < 0.0f) v = 0.0f;
-        else if (v > 1.0f) v = 1.0f;
-        dstU[((size_t)y * sw + x) * ch + c] = static_cast<unsigned char>(std::lround(v * 255.0f));
-    };
+        return;
+    }
 
-    auto isLinearChannel = [&](int c) -> bool {
-        if (ch <= 2) return true;
-        return c == 3;
-    };
+    for (int x = x0; x < x1; x++) {
+        int sx0 = std::min(2 * x,     sw - 1);
+        int sx1 = std::min(2 * x + 1, sw - 1);
+        for (int c = 0; c < ch; c++) {
+            const float* l = lut[c];
+            float avg = (l[r0[sx0 * ch + c]] + l[r0[sx1 * ch + c]]
+                       + l[r1[sx0 * ch + c]] + l[r1[sx1 * ch + c]]) * 0.25f;
+            out[x * ch + c] = isLinearChannel(ch, c)
+                ? static_cast<unsigned char>(std::lround(clampf(avg, 0.0f, 1.0f) * 255.0f))
+                : gt.encode(avg);
+        }
+    }
+}
 
-    for (int y = 0; y < dh; y++) {
+void halveRowF32(const float* r0, const float* r1, int sw, float* out, int ch, int x0, int x1) {
+    if (ch == 4) {
+        using namespace internal::simd;
+        const f32x4 quarter = set1(0.25f);
+        for (int x = x0; x < x1; x++) {
+            int sx0 = std::min(2 * x,     sw - 1) * 4;
+            int sx1 = std::min(2 * x + 1, sw - 1) * 4;
+            f32x4 sum = add(add(add(load(r0 + sx0), load(r0 + sx1)), load(r1 + sx0)), load(r1 + sx1));
+            store(out + x * 4, mul(sum, quarter));
+        }
+        return;
+    }
+    for (int x = x0; x < x1; x++) {
+        int sx0 = std::min(2 * x,     sw - 1) * ch;
+        int sx1 = std::min(2 * x + 1, sw - 1) * ch;
         for (int c = 0; c < ch; c++) {
-            // weights / indices for this destination row, reused across all x.
-            int wIndex[4];
-            float wValue[4];
-            int wCount = 0;
-            float startF = 0.0f, endF = 0.0f;
-
-            if (downscale) {
-                startF = y * scale;
-                endF   = (y + 1) * scale;
-            } else {
-                float center = (y + 0.5f) * scale - 0.5f;
-                int cf = (int)std::floor(center);
-                float t = center - (float)cf;
-                for (int k = -1; k <= 2; k++) {
-                    int si = cf + k;
-                    if (si < 0) si = 0;
-                    else if (si >= sh) si = sh - 1;
-                    wIndex[wCount] = si;
-                    wValue[wCount] = catmullRomWeight((float)k - t);
-                    wCount++;
-                }
-            }
+            out[x * ch + c] = (r0[sx0 + c] + r0[sx1 + c] + r1[sx0 + c] + r1[sx1 + c]) * 0.25f;
+        }
+    }
+}
 
-            for (int x = 0; x < sw; x++) {
-                bool linCh = isLinearChannel(c);
-                float v = 0.0f;
-                if (downscale) {
-                    int startI = (int)std::floor(startF);
-                    int endI   = std::min((int)std::ceil(endF), sh);
-                    float sum = 0.0f, total = 0.0f;
-                    for (int si = startI; si < endI; si++) {
-                        float w = std::min(endF, (float)(si + 1)) - std::max(startF, (float)si);
-                        if (w <= 0.0f) continue;
-                        sum   += fetchLinear(si, x, c, linCh) * w;
-                        total += w;
-                    }
-                    v = (total > 0.0f) ? (sum / total) : fetchLinear(std::min(startI, sh - 1), x, c, linCh);
+// Glyph atlas texels are white with coverage in alpha; empty texels are
+// (0, 0, 0, 0). Keeping RGB at 255 avoids a dark fringe on minified glyphs.
+void halveRowCoverage(const unsigned char* r0, const unsigned char* r1, int sw,
+                      unsigned char* out, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        int sx0 = std::min(2 * x,     sw - 1) * 4 + 3;
+        int sx1 = std::min(2 * x + 1, sw - 1) * 4 + 3;
+        int a = (r0[sx0] + r0[sx1] + r1[sx0] + r1[sx1] + 2) >> 2;
+        unsigned char* d = out + x * 4;
+        d[0] = 255; d[1] = 255; d[2] = 255; d[3] = static_cast<unsigned char>(a);
+    }
+}
+
+// Downsample rows/columns [x0, x1) x [y0, y1) of the half-size image `dst`
+// (row width dw). Row bands go to the shared pool once the region is big
+// enough to be worth waking it.
+void halveRegion(const HalveSource& src, void* dst, int dw, int ch, PixelFormat format,
+                 MipChain::Filter filter, int x0, int y0, int x1, int y1) {
+    const int rows = y1 - y0;
+    if (rows <= 0 || x1 <= x0) return;
+
+    auto runRows = [&](int ya, int yb) {
+        for (int y = ya; y < yb; y++) {
+            int sy0 = std::min(2 * y,     src.height - 1);
+            int sy1 = std::min(2 * y + 1, src.height - 1);
+            if (format == PixelFormat::F32) {
+                auto s = static_cast<const float*>(src.data);
+                halveRowF32(s + (size_t)sy0 * src.width * ch, s + (size_t)sy1 * src.width * ch,
+                            src.width, static_cast<float*>(dst) + (size_t)y * dw * ch, ch, x0, x1);
+            } else {
+                auto s = static_cast<const unsigned char*>(src.data);
+                auto r0 = s + (size_t)sy0 * src.width * ch;
+                auto r1 = s + (size_t)sy1 * src.width * ch;
+                auto out = static_cast<unsigned char*>(dst) + (size_t)y * dw * ch;
+                if (filter == MipChain::Filter::Coverage) {
+                    halveRowCoverage(r0, r1, src.width, out, x0, x1);
                 } else {
-                    float sum = 0.0f;
-                    for (int k = 0; k < wCount; k++) {
-                        sum += fetchLinear(wIndex[k], x, c, linCh) * wValue[k];
-                    }
-                    v = sum;
+                    halveRowU8(r0, r1, src.width, out, ch, x0, x1);
                 }
-                storeLinear(y, x, c, linCh, v);
             }
         }
+    };
+
+    const size_t texels = (size_t)(x1 - x0) * rows;
+    if (texels < 128 * 128) {
+        runRows(y0, y1);
+        return;
     }
+    const int threads = WorkerPool::shared().getThreadCount() + 1;
+    int bandRows = std::max(4, (rows + threads * 4 - 1) / (threads * 4));
+    int bands = (rows + bandRows - 1) / bandRows;
+    parallelFor(0, bands, [&](int b) {
+        int ya = y0 + b * bandRows;
+        runRows(ya, std::min(y1, ya + bandRows));
+    });
 }
 
-void Pixels::resize(int newW, int newH) {
-    if (!allocated_ || newW <= 0 || newH <= 0) return;
-    if (newW == width_ && newH == height_) return;
+} // anonymous namespace
+
+void Pixels::halve() {
+    if (!allocated_) return;
+    int newW = std::max(width_ / 2, 1);
+    int newH = std::max(height_ / 2, 1);
+
+    Pixels dst;
+    allocateLike(dst, newW, newH);
+    halveRegion({data_, width_, height_}, dst.data_, newW, channels_, format_,
+                MipChain::Filter::Box, 0, 0, newW, newH);
+
+    *this = std::move(dst);
+}
 
-    // 2-pass separable: horizontal first into an intermediate of size
-    // (newW x height_), then vertical into the final (newW x newH).
-    Pixels intermediate;
-    intermediate.allocate(newW, height_, channels_, format_);
-    resample1D_X(*this, intermediate);
+void MipChain::build(const void* base, int width, int height, int channels,
+                     PixelFormat format, int numLevels, Filter filter) {
+    levels_.clear();
+    if (!base || width <= 0 || height <= 0 || channels <= 0) return;
+    if (filter == Filter::Coverage && (channels != 4 || format != PixelFormat::U8)) {
+        filter = Filter::Box;
+    }
 
-    Pixels final;
-    final.allocate(newW, newH, channels_, format_);
-    resample1D_Y(intermediate, final);
+    const int fullLevels = computeNumLevels(width, height);
+    if (numLevels <= 0 || numLevels > fullLevels) numLevels = fullLevels;
+
+    const size_t texelBytes = (size_t)channels * (format == PixelFormat::F32 ? sizeof(float) : 1);
+    levels_.resize(numLevels);
+    levels_[0] = {0, (size_t)width * height * texelBytes, width, height};
+    size_t total = 0;
+    for (int l = 1; l < numLevels; l++) {
+        Level& lv = levels_[l];
+        lv.width = std::max(1, levels_[l - 1].width / 2);
+        lv.height = std::max(1, levels_[l - 1].height / 2);
+        lv.bytes = (size_t)lv.width * lv.height * texelBytes;
+        lv.offset = total;
+        total = (total + lv.bytes + 15) & ~(size_t)15;
+    }
+    // resize() keeps the capacity, so same-sized rebuilds never allocate.
+    storage_.resize(total);
+    channels_ = channels;
+    format_ = format;
+    filter_ = filter;
+
+    for (int l = 1; l < numLevels; l++) {
+        downsample(base, l, 0, 0, levels_[l].width, levels_[l].height);
+    }
+}
+
+void MipChain::update(const void* base, int x, int y, int w, int h) {
+    if (levels_.empty() || !base) return;
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + w, levels_[0].width);
+    int y1 = std::min(y + h, levels_[0].height);
+
+    for (int l = 1; l < (int)levels_.size(); l++) {
+        // Texels whose 2x2 footprint touches the dirty rect of level l - 1.
+        // (The last column/row of an odd-sized level feeds nothing below.)
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 = std::min((x1 + 1) >> 1, levels_[l].width);
+        y1 = std::min((y1 + 1) >> 1, levels_[l].height);
+        if (x1 <= x0 || y1 <= y0) return;
+        downsample(base, l, x0, y0, x1, y1);
+    }
+}
 
-    *this = std::move(final);
+void MipChain::downsample(const void* base, int level, int x0, int y0, int x1, int y1) {
+    const Level& src = levels_[level - 1];
+    const Level& dst = levels_[level];
+    const void* srcData = (level == 1) ? base : storage_.data() + src.offset;
+    halveRegion({srcData, src.width, src.height}, storage_.data() + dst.offset, dst.width,
+                channels_, format_, filter_, x0, y0, x1, y1);
 }
 
 } // namespace trussc
@@ -7,10 +7,15 @@
 
 // This file is included from TrussC.h
 
+#include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <vector>
 #include "stb/stb_image.h"
 #include "stb/stb_image_write.h"
 #include "tc/utils/tcFileIO.h"   // internal::pathToUtf8
+#include "tc/graphics/tcPixelConv.h"
+#include "tc/graphics/tcPixelsPool.h"
 
 namespace trussc {
 
@@ -64,9 +69,42 @@ public:
         allocated_ = true;
     }
 
+    // Allocate with storage borrowed from `pool` (64-byte aligned). The block
+    // goes back to the pool on clear() / destruction, and re-allocating a
+    // pooled buffer that is already big enough keeps its block. Unlike the
+    // plain overload the contents are NOT zeroed - meant for producers that
+    // overwrite every byte (video frames, conversions).
+    void allocate(int width, int height, int channels, PixelFormat format,
+                  const std::shared_ptr<PixelsPool>& pool) {
+        if (!pool) {
+            allocate(width, height, channels, format);
+            return;
+        }
+        size_t bytes = (size_t)width * height * channels
+                     * (format == PixelFormat::F32 ? sizeof(float) : 1);
+        if (!(data_ && pool_ == pool && capacity_ >= bytes)) {
+            clear();
+            data_ = pool->acquire(bytes, capacity_);
+            pool_ = pool;
+        }
+        width_ = width;
+        height_ = height;
+        channels_ = channels;
+        format_ = format;
+        allocated_ = true;
+    }
+
+    // Pool the storage was borrowed from (nullptr for plain allocations)
+    const std::shared_ptr<PixelsPool>& getPool() const { return pool_; }
+
     // Release resources
     void clear() {
-        if (data_) {
+        if (pool_) {
+            pool_->release(data_, capacity_);
+            pool_.reset();
+            capacity_ = 0;
+            data_ = nullptr;
+        } else if (data_) {
             if (format_ == PixelFormat::F32) {
                 delete[] static_cast<float*>(data_);
             } else {
@@ -191,6 +229,32 @@ public:
         memcpy(data_, srcData, getTotalBytes());
     }
 
+    // Copy from external U8 data into F32 pixels ([0, 255] -> [0, 1])
+    void setFromPixelsAsFloats(const unsigned char* srcData, int width, int height, int channels) {
+        allocate(width, height, channels, PixelFormat::F32);
+        pixelconv::u8ToF32(srcData, static_cast<float*>(data_), (size_t)width * height * channels);
+    }
+
+    // Copy from external F32 data into U8 pixels (clamped to [0, 1], rounded)
+    void setFromFloatsAsPixels(const float* srcData, int width, int height, int channels) {
+        allocate(width, height, channels, PixelFormat::U8);
+        pixelconv::f32ToU8(srcData, static_cast<unsigned char*>(data_), (size_t)width * height * channels);
+    }
+
+    // Copy of this buffer in another sample format (U8 <-> F32). Same
+    // channel count; values are mapped [0, 255] <-> [0, 1], no gamma.
+    Pixels convertTo(PixelFormat format) const {
+        Pixels p;
+        if (!allocated_ || !data_) return p;
+        if (format == format_) return clone();
+        if (format == PixelFormat::F32) {
+            p.setFromPixelsAsFloats(static_cast<const unsigned char*>(data_), width_, height_, channels_);
+        } else {
+            p.setFromFloatsAsPixels(static_cast<const float*>(data_), width_, height_, channels_);
+        }
+        return p;
+    }
+
     // Copy to external buffer
     void copyTo(unsigned char* dst) const {
         if (allocated_ && data_ && dst) {
@@ -271,12 +335,7 @@ public:
 
         size_t count = (size_t)width_ * height_;
         float* rgba = new float[count * 4];
-        for (size_t i = 0; i < count; ++i) {
-            rgba[i * 4 + 0] = loaded[i * 3 + 0];
-            rgba[i * 4 + 1] = loaded[i * 3 + 1];
-            rgba[i * 4 + 2] = loaded[i * 3 + 2];
-            rgba[i * 4 + 3] = 1.0f;
-        }
+        pixelconv::rgbToRgba(loaded, rgba, count, 1.0f);
         data_ = rgba;
         stbi_image_free(loaded);
 
@@ -328,9 +387,8 @@ public:
     // 4-channel buffer go through the sRGB curve.
 
     // Replace the buffer with its 2x2 box-averaged half (gamma-correct).
-    // Resulting size is max(width/2, 1) x max(height/2, 1). Used as the
-    // building block of mipmap chain generation; also exposed directly
-    // for quick 1/2 downscaling.
+    // Resulting size is max(width/2, 1) x max(height/2, 1). Same kernel as
+    // MipChain (below), exposed directly for quick 1/2 downscaling.
     void halve();
 
     // Replace the buffer with a quality-first resampled (newW x newH)
@@ -340,9 +398,11 @@ public:
     // The implementation is separable 2-pass; mixed downscale-on-one-axis
     // / upscale-on-the-other is fine.
     //
-    // This is the quality path, not the fast path. If you need cheap
-    // resizing, render the source as a texture into an Fbo at the
-    // target size with mipmaps enabled — that uses the GPU sampler.
+    // Filter weights are built once per call, U8 gamma goes through
+    // lookup tables, and output rows are split across
+    // WorkerPool::shared(), so per-frame use on video-sized buffers is
+    // fine. For the cheapest possible resize, render the source as a
+    // texture into an Fbo at the target size — that uses the GPU sampler.
     void resize(int newW, int newH);
 
     // Replace the buffer with a (w x h) region starting at (x, y).
@@ -366,9 +426,19 @@ private:
     int channels_ = 0;
     PixelFormat format_ = PixelFormat::U8;
     bool allocated_ = false;
+    std::shared_ptr<PixelsPool> pool_;   // set when data_ is a pool block
+    size_t capacity_ = 0;                // pool block size
+
+    // Allocate `dst` the way this buffer was allocated (same pool, if any).
+    void allocateLike(Pixels& dst, int width, int height) const {
+        if (pool_) dst.allocate(width, height, channels_, format_, pool_);
+        else dst.allocate(width, height, channels_, format_);
+    }
 
     void moveFrom(Pixels&& other) {
         data_ = other.data_;
+        pool_ = std::move(other.pool_);
+        capacity_ = other.capacity_;
         width_ = other.width_;
         height_ = other.height_;
         channels_ = other.channels_;
@@ -376,6 +446,7 @@ private:
         allocated_ = other.allocated_;
 
         other.data_ = nullptr;
+        other.capacity_ = 0;
         other.width_ = 0;
         other.height_ = 0;
         other.channels_ = 0;
@@ -384,4 +455,94 @@ private:
     }
 };
 
+// ---------------------------------------------------------------------------
+// MipChain - CPU-generated mip levels for a base image
+// ---------------------------------------------------------------------------
+// Builds levels 1..N-1 below a base image with the same 2x2 box filter as
+// Pixels::halve (gamma-correct for U8 RGB, direct average for F32 and
+// alpha), so the result is bit-identical to a chain of halve() calls.
+// Every level lives in one buffer that is kept across rebuilds: a Dynamic
+// mipmapped texture re-uploading each frame does not allocate. Rows of each
+// level are split across WorkerPool::shared().
+//
+// update() regenerates only the texels under a changed rectangle of the
+// base, level by level, which is what makes per-frame partial updates of a
+// large mipmapped image (paint canvas, glyph atlas) cheap.
+//
+// Level 0 is the caller's base image and is never copied; getLevelData(0)
+// returns nullptr.
+class MipChain {
+public:
+    enum class Filter {
+        Box,        // gamma-correct 2x2 box (same as Pixels::halve)
+        Coverage,   // glyph atlases: RGB forced to 255, alpha box-averaged
+    };
+
+    // Number of levels of a full chain down to 1x1, including the base.
+    static int computeNumLevels(int width, int height) {
+        int n = 1;
+        while (width > 1 || height > 1) {
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+            ++n;
+        }
+        return n;
+    }
+
+    // Build levels 1..numLevels-1 from `base` (tightly packed rows).
+    // numLevels <= 0 builds the full chain. Coverage requires RGBA U8.
+    void build(const void* base, int width, int height, int channels,
+               PixelFormat format, int numLevels = 0, Filter filter = Filter::Box);
+
+    void build(const Pixels& base, int numLevels = 0, Filter filter = Filter::Box) {
+        build(base.getDataVoid(), base.getWidth(), base.getHeight(), base.getChannels(),
+              base.getFormat(), numLevels, filter);
+    }
+
+    // `base` changed inside (x, y, w, h) since the last build()/update();
+    // regenerate just the texels that depend on it. The base must have the
+    // same size/format as the last build() — if not (or nothing was built
+    // yet), call build() instead; isBuiltFor() tells which.
+    void update(const void* base, int x, int y, int w, int h);
+
+    bool isBuiltFor(int width, int height, int channels, PixelFormat format,
+                    int numLevels = 0, Filter filter = Filter::Box) const {
+        if (numLevels <= 0) numLevels = computeNumLevels(width, height);
+        return !levels_.empty() && levels_[0].width == width && levels_[0].height == height
+            && channels_ == channels && format_ == format
+            && (int)levels_.size() == numLevels && filter_ == filter;
+    }
+
+    int getNumLevels() const { return (int)levels_.size(); }
+    int getLevelWidth(int level) const { return levels_[level].width; }
+    int getLevelHeight(int level) const { return levels_[level].height; }
+    size_t getLevelBytes(int level) const { return levels_[level].bytes; }
+    const void* getLevelData(int level) const {
+        return level == 0 ? nullptr : storage_.data() + levels_[level].offset;
+    }
+
+    // Drop the levels and release the storage.
+    void clear() {
+        levels_.clear();
+        std::vector<unsigned char>().swap(storage_);
+    }
+
+private:
+    struct Level {
+        size_t offset = 0;
+        size_t bytes = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    std::vector<unsigned char> storage_;   // all levels >= 1, 16-byte aligned offsets
+    std::vector<Level> levels_;            // [0] = base (size only)
+    int channels_ = 0;
+    PixelFormat format_ = PixelFormat::U8;
+    Filter filter_ = Filter::Box;
+
+    // Fill rows/columns [x0, x1) x [y0, y1) of `level` from level - 1.
+    void downsample(const void* base, int level, int x0, int y0, int x1, int y1);
+};
+
 } // namespace trussc
@@ -0,0 +1,144 @@
+// =============================================================================
+// tcPixelsPool.cpp - PixelsPool implementation
+// =============================================================================
+
+#include "tc/graphics/tcPixelsPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace trussc {
+
+namespace {
+
+constexpr std::size_t kHugePageSize = 2u << 20;
+
+std::size_t roundUp(std::size_t n, std::size_t step) {
+    return (n + step - 1) / step * step;
+}
+
+void* alignedAlloc(std::size_t bytes, std::size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, bytes) == 0 ? p : nullptr;
+#endif
+}
+
+void alignedFree(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // anonymous namespace
+
+PixelsPool::~PixelsPool() {
+    trim();
+}
+
+const std::shared_ptr<PixelsPool>& PixelsPool::shared() {
+    // Never destroyed: Pixels in other statics may still hold blocks at exit.
+    static auto* instance = new std::shared_ptr<PixelsPool>(std::make_shared<PixelsPool>());
+    return *instance;
+}
+
+std::size_t PixelsPool::sizeClass(std::size_t bytes) {
+    if (bytes == 0) return 0;
+    std::size_t n = roundUp(bytes, kAlignment);
+    if (n <= 4 * kAlignment) return n;
+    // 4 classes per power of two: at most 25% slack, and frames that differ
+    // by a few rows (odd crops, 1080 vs 1088) share a block.
+    const int log2 = (int)std::bit_width(n - 1) - 1;
+    return roundUp(n, std::size_t(1) << (log2 - 2));
+}
+
+void* PixelsPool::acquire(std::size_t bytes, std::size_t& capacity) {
+    capacity = sizeClass(bytes);
+    if (capacity == 0) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool huge = hugePages_ && capacity >= kHugePageSize;
+    if (huge) capacity = roundUp(capacity, kHugePageSize);
+
+    void* p = nullptr;
+    auto it = freeLists_.find(capacity);
+    if (it != freeLists_.end() && !it->second.empty()) {
+        p = it->second.back();
+        it->second.pop_back();
+        stats_.bytesCached -= capacity;
+        stats_.reused++;
+    } else {
+        p = alignedAlloc(capacity, huge ? kHugePageSize : kAlignment);
+        if (!p) {
+            capacity = 0;
+            return nullptr;
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (huge) madvise(p, capacity, MADV_HUGEPAGE);
+#endif
+        stats_.allocated++;
+    }
+
+    stats_.bytesInUse += capacity;
+    stats_.blocksInUse++;
+    stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+    stats_.peakBlocksInUse = std::max(stats_.peakBlocksInUse, stats_.blocksInUse);
+    return p;
+}
+
+void PixelsPool::release(void* ptr, std::size_t capacity) {
+    if (!ptr) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    freeLists_[capacity].push_back(ptr);
+    stats_.bytesCached += capacity;
+    stats_.bytesInUse -= capacity;
+    stats_.blocksInUse--;
+}
+
+void PixelsPool::setHugePages(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+#if defined(__linux__)
+    hugePages_ = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+bool PixelsPool::getHugePages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hugePages_;
+}
+
+void PixelsPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [capacity, blocks] : freeLists_) {
+        for (void* p : blocks) alignedFree(p);
+    }
+    freeLists_.clear();
+    stats_.bytesCached = 0;
+}
+
+PixelsPool::Stats PixelsPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void PixelsPool::resetPeak() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.peakBytesInUse = stats_.bytesInUse;
+    stats_.peakBlocksInUse = stats_.blocksInUse;
+}
+
+} // namespace trussc
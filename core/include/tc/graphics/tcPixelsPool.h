@@ -0,0 +1,92 @@
+#pragma once
+
+// =============================================================================
+// tcPixelsPool.h - recycled, aligned storage for Pixels
+// =============================================================================
+//
+// Video producers fill a fresh Pixels for every frame. With plain new[] that
+// is a multi-megabyte malloc + free per frame (and, for buffers above the
+// allocator's mmap threshold, a round trip to the kernel that faults every
+// page in again). A PixelsPool keeps released blocks on per-size-class free
+// lists and hands them back out, so steady-state playback does not allocate.
+//
+//   auto pool = std::make_shared<tc::PixelsPool>();
+//   tc::Pixels frame;
+//   frame.allocate(1920, 1080, 4, tc::PixelFormat::U8, pool);  // borrowed
+//   ...
+//   frame.clear();   // (or destruction) returns the block to the pool
+//
+// - Blocks are 64-byte aligned (a cache line; safe for any SIMD load).
+// - Sizes are rounded up to a size class (4 classes per power of two), so
+//   a slightly smaller frame reuses a slightly larger block.
+// - Optionally (Linux) blocks of 2 MiB and up are backed by transparent huge
+//   pages, which cuts TLB misses when converting 4K frames.
+// - Thread-safe: producers acquire on a decode thread, consumers release on
+//   the main thread.
+//
+// Pixels keep a shared_ptr to the pool they borrowed from, so a pool lives
+// as long as any of its blocks is still out (frames handed to the app can
+// safely outlive the VideoGrabber that produced them).
+//
+// =============================================================================
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace trussc {
+
+class PixelsPool {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    struct Stats {
+        std::size_t bytesInUse = 0;       // capacity of blocks currently lent out
+        std::size_t peakBytesInUse = 0;   // high-water mark of bytesInUse
+        std::size_t bytesCached = 0;      // capacity sitting on the free lists
+        std::size_t blocksInUse = 0;
+        std::size_t peakBlocksInUse = 0;  // high-water mark of blocksInUse
+        std::size_t reused = 0;           // acquires served from a free list
+        std::size_t allocated = 0;        // acquires that hit the system allocator
+    };
+
+    PixelsPool() = default;
+    ~PixelsPool();
+
+    PixelsPool(const PixelsPool&) = delete;
+    PixelsPool& operator=(const PixelsPool&) = delete;
+
+    // Process-wide pool for code that has no natural owner for one.
+    static const std::shared_ptr<PixelsPool>& shared();
+
+    // Round a request up to the block size the pool would hand out.
+    static std::size_t sizeClass(std::size_t bytes);
+
+    // Borrow a block of at least `bytes` (contents undefined). `capacity`
+    // receives the real block size, which must be passed back to release().
+    // Returns nullptr for 0 bytes or when the system is out of memory.
+    void* acquire(std::size_t bytes, std::size_t& capacity);
+    void release(void* ptr, std::size_t capacity);
+
+    // Back blocks of 2 MiB and larger with transparent huge pages
+    // (madvise(MADV_HUGEPAGE)). Linux only; a no-op elsewhere. Affects
+    // blocks allocated after the call.
+    void setHugePages(bool enabled);
+    bool getHugePages() const;
+
+    // Free every cached (not lent out) block.
+    void trim();
+
+    Stats getStats() const;
+    void resetPeak();
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::size_t, std::vector<void*>> freeLists_;   // by capacity
+    Stats stats_;
+    bool hugePages_ = false;
+};
+
+} // namespace trussc
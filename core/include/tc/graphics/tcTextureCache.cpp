@@ -0,0 +1,267 @@
+// =============================================================================
+// tcTextureCache.cpp - TextureCache implementation (requires TrussC.h for
+// getDataPath / logging)
+// =============================================================================
+
+#include "TrussC.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace trussc {
+
+namespace {
+
+// Cache file layout (little-endian, as written by the host):
+//   CacheHeader
+//   uint64_t levelSizes[numLevels]
+//   level data, back to back
+constexpr uint32_t kCacheMagic = 0x43424354;   // "TCBC"
+constexpr uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic = kCacheMagic;
+    uint32_t version = kCacheVersion;
+    uint32_t format = 0;
+    uint32_t numLevels = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    uint64_t sourceHash = 0;
+};
+
+// 64-bit content hash (FNV-1a over 8-byte words + final mix). Only used to
+// tell "same file, new mtime" from a real change, not for security.
+uint64_t hashBytes(const uint8_t* data, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ull ^ n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+    }
+    for (; i < n; i++) h = (h ^ data[i]) * 0x100000001b3ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::string hex64(uint64_t v) {
+    static const char* digits = "0123456789abcdef";
+    std::string s(16, '0');
+    for (int i = 15; i >= 0; i--, v >>= 4) s[i] = digits[v & 15];
+    return s;
+}
+
+const char* formatName(BlockFormat f) {
+    switch (f) {
+        case BlockFormat::BC1: return "bc1";
+        case BlockFormat::BC3: return "bc3";
+        case BlockFormat::BC7: return "bc7";
+    }
+    return "bc";
+}
+
+bool readFile(const fs::path& path, std::vector<uint8_t>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    in.seekg(0, std::ios::beg);
+    out.resize((size_t)size);
+    return size == 0 || (bool)in.read(reinterpret_cast<char*>(out.data()), size);
+}
+
+bool readHeader(std::ifstream& in, CacheHeader& header, std::vector<uint64_t>& levelSizes) {
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (header.magic != kCacheMagic || header.version != kCacheVersion) return false;
+    if (header.numLevels == 0 || header.numLevels > 16) return false;
+    levelSizes.resize(header.numLevels);
+    return (bool)in.read(reinterpret_cast<char*>(levelSizes.data()),
+                         sizeof(uint64_t) * header.numLevels);
+}
+
+bool readPayload(std::ifstream& in, const CacheHeader& header,
+                 const std::vector<uint64_t>& levelSizes, CompressedImage& out) {
+    out.width = header.width;
+    out.height = header.height;
+    out.format = (BlockFormat)header.format;
+    out.levelOffsets.clear();
+    out.levelSizes.clear();
+    size_t total = 0;
+    for (int l = 0; l < (int)header.numLevels; l++) {
+        int lw = std::max(1, header.width >> l);
+        int lh = std::max(1, header.height >> l);
+        if (levelSizes[l] != blockCompressedSize(lw, lh, out.format)) return false;
+        out.levelOffsets.push_back(total);
+        out.levelSizes.push_back((size_t)levelSizes[l]);
+        total += (size_t)levelSizes[l];
+    }
+    out.data.resize(total);
+    return (bool)in.read(reinterpret_cast<char*>(out.data.data()), (std::streamsize)total);
+}
+
+bool writeCacheFile(const fs::path& path, const CacheHeader& header, const CompressedImage& img) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    // Write to a temporary name and rename, so a concurrent reader (another
+    // thread, another instance of the app) never sees a half-written file.
+    fs::path tmp = path;
+    tmp += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                                   (size_t)std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t s : img.levelSizes) {
+            uint64_t v = s;
+            out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+        out.write(reinterpret_cast<const char*>(img.data.data()), (std::streamsize)img.data.size());
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+void encodeImage(const Pixels& rgba, BlockFormat format, bool mipmaps, CompressedImage& out) {
+    const int w = rgba.getWidth(), h = rgba.getHeight();
+    MipChain chain;
+    if (mipmaps) chain.build(rgba);
+    const int numLevels = mipmaps ? chain.getNumLevels() : 1;
+
+    out.width = w;
+    out.height = h;
+    out.format = format;
+    out.levelOffsets.clear();
+    out.levelSizes.clear();
+    size_t total = 0;
+    for (int l = 0; l < numLevels; l++) {
+        size_t bytes = blockCompressedSize(std::max(1, w >> l), std::max(1, h >> l), format);
+        out.levelOffsets.push_back(total);
+        out.levelSizes.push_back(bytes);
+        total += bytes;
+    }
+    out.data.resize(total);
+
+    for (int l = 0; l < numLevels; l++) {
+        const uint8_t* src = (l == 0) ? rgba.getData()
+                                      : static_cast<const uint8_t*>(chain.getLevelData(l));
+        encodeBlocks(src, std::max(1, w >> l), std::max(1, h >> l), format,
+                     out.data.data() + out.levelOffsets[l]);
+    }
+}
+
+} // anonymous namespace
+
+fs::path TextureCache::getDirectory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directory_.empty() ? getDataPath(".texcache") : directory_;
+}
+
+LoadResult TextureCache::load(const fs::path& path, BlockFormat format, bool mipmaps,
+                              CompressedImage& out) {
+    const fs::path source = getDataPath(path);
+    std::error_code ec;
+    const uint64_t sourceSize = fs::file_size(source, ec);
+    if (ec) {
+        return LoadResult::fail(LoadError::FileNotFound,
+                                "file not found: " + internal::pathToUtf8(source));
+    }
+    const int64_t sourceMtime = (int64_t)fs::last_write_time(source, ec).time_since_epoch().count();
+
+    fs::path absolute = fs::absolute(source, ec);
+    std::string keyText = internal::pathToUtf8(absolute.lexically_normal());
+    keyText += mipmaps ? "|mips" : "|base";
+    const fs::path cacheFile = getDirectory() /
+        (hex64(hashBytes(reinterpret_cast<const uint8_t*>(keyText.data()), keyText.size()))
+         + "." + formatName(format) + ".tcbc");
+
+    CacheHeader cached;
+    std::vector<uint64_t> levelSizes;
+    bool haveHeader = false;
+    {
+        std::ifstream in(cacheFile, std::ios::binary);
+        haveHeader = in && readHeader(in, cached, levelSizes)
+                  && cached.format == (uint32_t)format
+                  && cached.sourceSize == sourceSize;
+        if (haveHeader && cached.sourceMtime == sourceMtime && readPayload(in, cached, levelSizes, out)) {
+            hits_++;
+            return LoadResult::success();
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    if (!readFile(source, bytes)) {
+        return LoadResult::fail(LoadError::FileNotFound,
+                                "cannot read: " + internal::pathToUtf8(source));
+    }
+    const uint64_t sourceHash = hashBytes(bytes.data(), bytes.size());
+
+    CacheHeader header;
+    header.format = (uint32_t)format;
+    header.sourceSize = sourceSize;
+    header.sourceMtime = sourceMtime;
+    header.sourceHash = sourceHash;
+
+    // Touched but unchanged (copied, checked out again): reuse the blocks and
+    // refresh the recorded mtime so the next launch skips the hash.
+    if (haveHeader && cached.sourceHash == sourceHash) {
+        std::ifstream in(cacheFile, std::ios::binary);
+        if (in && readHeader(in, cached, levelSizes) && readPayload(in, cached, levelSizes, out)) {
+            header.width = cached.width;
+            header.height = cached.height;
+            header.numLevels = cached.numLevels;
+            in.close();
+            writeCacheFile(cacheFile, header, out);
+            hits_++;
+            return LoadResult::success();
+        }
+    }
+
+    misses_++;
+    Pixels pixels;
+    LoadResult r = pixels.loadFromMemory(bytes.data(), (int)bytes.size());
+    if (!r) {
+        r = pixels.load(source);   // platform decoders (ImageIO etc.)
+        if (!r) return r;
+    }
+    if (pixels.getFormat() != PixelFormat::U8 || pixels.getChannels() != 4) {
+        return LoadResult::fail(LoadError::UnsupportedFormat,
+                                "block compression needs an 8-bit RGBA image");
+    }
+
+    encodeImage(pixels, format, mipmaps, out);
+
+    header.width = out.width;
+    header.height = out.height;
+    header.numLevels = (uint32_t)out.getNumLevels();
+    if (!writeCacheFile(cacheFile, header, out)) {
+        logWarning("TextureCache") << "could not write " << internal::pathToUtf8(cacheFile)
+                                   << " (encoded result is still used)";
+    }
+    return LoadResult::success();
+}
+
+void TextureCache::clear() {
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(getDirectory(), ec)) {
+        if (entry.path().extension() == ".tcbc") fs::remove(entry.path(), ec);
+    }
+}
+
+} // namespace trussc
@@ -2,7 +2,7 @@
 
 // =============================================================================
 // TrussC FFT
-// Fast Fourier Transform (Cooley-Tukey radix-2 algorithm)
+// Fast Fourier Transform (Cooley-Tukey, radix-4 passes + radix-2 tail)
 //
 // Usage:
 //   vector<complex<float>> data(1024);
@@ -17,6 +17,20 @@
 //
 //   // Window function
 //   tc::applyWindow(signal, tc::WindowType::Hanning);
+//
+//   // Repeated analysis (per frame / per channel): no allocation after the
+//   // first call. Output is the N/2 + 1 non-redundant bins.
+//   tc::FftPlan plan(4096);
+//   vector<complex<float>> bins(plan.getRealBins());
+//   plan.forwardReal(samples, bins.data(), tc::WindowType::Hanning);
+//
+//   // Or with the free functions and caller-owned outputs:
+//   tc::fftReal(signal, bins, tc::WindowType::Hanning);
+//   tc::fftMagnitude(bins, magnitudes);
+//
+// All transforms go through an FftPlan (the free functions keep one per size
+// per thread). A plan holds bit-reversal and twiddle tables and its own work
+// buffers, so it is not safe to share between threads — use one per thread.
 // =============================================================================
 
 #include <vector>
@@ -24,7 +38,11 @@
 #include <cmath>
 #include <algorithm>
 
+#include <cstdint>
+#include <memory>
+
 #include "../utils/tcLog.h"
+#include "../utils/tcSimd.h"
 #include "../../tcMath.h"
 
 namespace trussc {
@@ -114,65 +132,272 @@ inline int getBits(int n) {
 } // namespace internal
 
 // ---------------------------------------------------------------------------
-// FFT (Cooley-Tukey radix-2 decimation-in-time)
+// FftPlan — precomputed tables for one power-of-two size
 // ---------------------------------------------------------------------------
+//
+// forward() / inverse(): in-place complex transform of size N.
+// forwardReal(): real input of size N through a complex transform of size
+// N/2 (even samples as real part, odd as imaginary) plus one split pass;
+// writes N/2 + 1 bins (DC .. Nyquist), unnormalized like fft().
+//
+// Internally the data is deinterleaved into split re / im arrays in
+// bit-reversed order, so every butterfly pass from length 16 up is a plain
+// 4-wide SIMD loop over contiguous twiddles. Passes are fused two stages at
+// a time (radix-4) to halve the sweeps over memory.
+class FftPlan {
+public:
+    FftPlan() = default;
+    explicit FftPlan(int size) { setup(size); }
+
+    // (Re)build the tables. size must be a power of two (>= 1).
+    bool setup(int size) {
+        if (!isPowerOfTwo(size)) {
+            logError() << "FftPlan: size must be power of 2 (got " << size << ")";
+            size_ = 0;
+            return false;
+        }
+        size_ = size;
+
+        // twRe_/twIm_[h + j] = exp(-i * pi * j / h) for each pass half-length
+        // h (a power of two < size) and j < h.
+        twRe_.assign(std::max(size, 2), 0.0f);
+        twIm_.assign(std::max(size, 2), 0.0f);
+        for (int h = 1; h < size; h *= 2) {
+            for (int j = 0; j < h; j++) {
+                const double a = -3.14159265358979323846 * j / h;
+                twRe_[h + j] = (float)std::cos(a);
+                twIm_[h + j] = (float)std::sin(a);
+            }
+        }
+        buildBitReverse(bitrev_, size);
+        buildBitReverse(bitrevHalf_, std::max(size / 2, 1));
+        workRe_.assign(size, 0.0f);
+        workIm_.assign(size, 0.0f);
+        for (auto& w : windows_) w.clear();
+        return true;
+    }
 
-// In-place FFT
-inline void fft(std::vector<std::complex<float>>& data) {
-    int n = static_cast<int>(data.size());
-    if (n <= 1) return;
+    int getSize() const { return size_; }
+    int getRealBins() const { return size_ / 2 + 1; }
+
+    void forward(std::complex<float>* data) {
+        if (size_ <= 1) return;
+        float* re = workRe_.data();
+        float* im = workIm_.data();
+        for (int i = 0; i < size_; i++) {
+            const std::complex<float> v = data[bitrev_[i]];
+            re[i] = v.real();
+            im[i] = v.imag();
+        }
+        transform(re, im, size_);
+        for (int i = 0; i < size_; i++) data[i] = {re[i], im[i]};
+    }
 
-    // Error if not power of 2
-    if (!isPowerOfTwo(n)) {
-        logError() << "FFT: size must be power of 2 (got " << n << ")";
-        return;
+    // Normalized (ifft(fft(x)) == x). Runs the forward kernel with re / im
+    // swapped, which conjugates in and out for free.
+    void inverse(std::complex<float>* data) {
+        if (size_ <= 1) return;
+        float* re = workRe_.data();
+        float* im = workIm_.data();
+        for (int i = 0; i < size_; i++) {
+            const std::complex<float> v = data[bitrev_[i]];
+            re[i] = v.real();
+            im[i] = v.imag();
+        }
+        transform(im, re, size_);
+        const float scale = 1.0f / (float)size_;
+        for (int i = 0; i < size_; i++) data[i] = {re[i] * scale, im[i] * scale};
     }
 
-    int bits = internal::getBits(n);
+    // Real input (size samples) -> getRealBins() bins in `out`, optionally
+    // windowed on the way in (the window table is cached in the plan).
+    void forwardReal(const float* in, std::complex<float>* out, WindowType window = WindowType::Rect) {
+        if (size_ == 0) return;
+        if (size_ == 1) { out[0] = {in[0], 0.0f}; return; }
+        const int m = size_ / 2;
+        float* re = workRe_.data();
+        float* im = workIm_.data();
+        const float* w = window == WindowType::Rect ? nullptr : getWindow(window);
+        for (int i = 0; i < m; i++) {
+            const int k = 2 * bitrevHalf_[i];
+            re[i] = w ? in[k] * w[k] : in[k];
+            im[i] = w ? in[k + 1] * w[k + 1] : in[k + 1];
+        }
+        transform(re, im, m);
+
+        // Split Z (the half-size spectrum) into the even / odd-sample
+        // spectra and recombine: X[k] = E[k] + W_N^k * O[k].
+        out[0] = {re[0] + im[0], 0.0f};
+        out[m] = {re[0] - im[0], 0.0f};
+        const float* wr = twRe_.data() + m;
+        const float* wi = twIm_.data() + m;
+        for (int k = 1; k < m; k++) {
+            const float zr = re[k], zi = im[k];
+            const float cr = re[m - k], ci = -im[m - k];      // conj(Z[m-k])
+            const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+            const float dr = zr - cr, di = zi - ci;
+            const float orr = 0.5f * di, oi = -0.5f * dr;     // -i/2 * (Z - conj)
+            out[k] = {er + wr[k] * orr - wi[k] * oi, ei + wr[k] * oi + wi[k] * orr};
+        }
+    }
 
-    // Bit reverse permutation
-    for (int i = 0; i < n; i++) {
-        int j = internal::bitReverse(i, bits);
-        if (i < j) {
-            std::swap(data[i], data[j]);
+    // Window coefficients for this size (computed once per type).
+    const float* getWindow(WindowType type) {
+        auto& w = windows_[(int)type];
+        if ((int)w.size() != size_) {
+            w.resize(size_);
+            for (int i = 0; i < size_; i++) w[i] = windowFunction(type, i, size_);
+        }
+        return w.data();
+    }
+
+private:
+    static void buildBitReverse(std::vector<uint32_t>& table, int n) {
+        table.assign(n, 0);
+        const int bits = internal::getBits(n);
+        for (int i = 0; i < n; i++) table[i] = (uint32_t)internal::bitReverse(i, bits);
+    }
+
+    // In-place DIT transform of n (<= size_) bit-reversed split values.
+    void transform(float* re, float* im, int n) const {
+        if (n == 2) {
+            const float r = re[1], i = im[1];
+            re[1] = re[0] - r; im[1] = im[0] - i;
+            re[0] += r;        im[0] += i;
+            return;
+        }
+        if (n < 4) return;
+
+        // Stages 1 + 2: twiddle-free radix-4.
+        for (int i = 0; i < n; i += 4) {
+            const float ar = re[i] + re[i + 1], ai = im[i] + im[i + 1];
+            const float br = re[i] - re[i + 1], bi = im[i] - im[i + 1];
+            const float cr = re[i + 2] + re[i + 3], ci = im[i + 2] + im[i + 3];
+            const float dr = re[i + 2] - re[i + 3], di = im[i + 2] - im[i + 3];
+            re[i]     = ar + cr; im[i]     = ai + ci;
+            re[i + 2] = ar - cr; im[i + 2] = ai - ci;
+            re[i + 1] = br + di; im[i + 1] = bi - dr;   // b + (-i) d
+            re[i + 3] = br - di; im[i + 3] = bi + dr;
+        }
+
+        int h = 4;
+        for (; 4 * h <= n; h *= 4) radix4Pass(re, im, n, h);
+        if (2 * h == n) radix2Pass(re, im, n, h);
+    }
+
+    // One stage of half-length h (h >= 4).
+    void radix2Pass(float* re, float* im, int n, int h) const {
+        namespace simd = internal::simd;
+        const float* twr = twRe_.data() + h;
+        const float* twi = twIm_.data() + h;
+        for (int i = 0; i < n; i += 2 * h) {
+            float* r0 = re + i; float* i0 = im + i;
+            float* r1 = r0 + h; float* i1 = i0 + h;
+            for (int j = 0; j < h; j += 4) {
+                const auto wr = simd::load(twr + j), wi = simd::load(twi + j);
+                const auto br = simd::load(r1 + j), bi = simd::load(i1 + j);
+                const auto tr = simd::sub(simd::mul(br, wr), simd::mul(bi, wi));
+                const auto ti = simd::madd(simd::mul(br, wi), bi, wr);
+                const auto ar = simd::load(r0 + j), ai = simd::load(i0 + j);
+                simd::store(r0 + j, simd::add(ar, tr)); simd::store(i0 + j, simd::add(ai, ti));
+                simd::store(r1 + j, simd::sub(ar, tr)); simd::store(i1 + j, simd::sub(ai, ti));
+            }
         }
     }
 
-    // Butterfly operation
-    for (int len = 2; len <= n; len *= 2) {
-        float angle = -TAU / len;
-        std::complex<float> wn(std::cos(angle), std::sin(angle));
-
-        for (int i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            for (int j = 0; j < len / 2; j++) {
-                std::complex<float> u = data[i + j];
-                std::complex<float> t = w * data[i + j + len / 2];
-                data[i + j] = u + t;
-                data[i + j + len / 2] = u - t;
-                w *= wn;
+    // Two stages (half-lengths h and 2h, h >= 4) in one sweep.
+    void radix4Pass(float* re, float* im, int n, int h) const {
+        namespace simd = internal::simd;
+        const float* t1r = twRe_.data() + h;
+        const float* t1i = twIm_.data() + h;
+        const float* t2r = twRe_.data() + 2 * h;
+        const float* t2i = twIm_.data() + 2 * h;
+        auto cmul = [](simd::f32x4 ar, simd::f32x4 ai, simd::f32x4 br, simd::f32x4 bi,
+                       simd::f32x4& outR, simd::f32x4& outI) {
+            outR = simd::sub(simd::mul(ar, br), simd::mul(ai, bi));
+            outI = simd::madd(simd::mul(ar, bi), ai, br);
+        };
+        for (int i = 0; i < n; i += 4 * h) {
+            float* ra = re + i;         float* ia = im + i;
+            float* rb = ra + h;         float* ib = ia + h;
+            float* rc = ra + 2 * h;     float* ic = ia + 2 * h;
+            float* rd = ra + 3 * h;     float* id = ia + 3 * h;
+            for (int j = 0; j < h; j += 4) {
+                const auto w1r = simd::load(t1r + j), w1i = simd::load(t1i + j);
+                const auto w2r = simd::load(t2r + j), w2i = simd::load(t2i + j);
+
+                simd::f32x4 tbr, tbi, tdr, tdi;
+                cmul(simd::load(rb + j), simd::load(ib + j), w1r, w1i, tbr, tbi);
+                cmul(simd::load(rd + j), simd::load(id + j), w1r, w1i, tdr, tdi);
+                const auto ar = simd::load(ra + j), ai = simd::load(ia + j);
+                const auto cr = simd::load(rc + j), ci = simd::load(ic + j);
+                const auto a1r = simd::add(ar, tbr), a1i = simd::add(ai, tbi);
+                const auto b1r = simd::sub(ar, tbr), b1i = simd::sub(ai, tbi);
+                const auto c1r = simd::add(cr, tdr), c1i = simd::add(ci, tdi);
+                const auto d1r = simd::sub(cr, tdr), d1i = simd::sub(ci, tdi);
+
+                simd::f32x4 ucr, uci, udr, udi;
+                cmul(c1r, c1i, w2r, w2i, ucr, uci);
+                cmul(d1r, d1i, w2r, w2i, udr, udi);
+                // Second half of the 2h stage uses w2 * (-i): (r, i) -> (i, -r).
+                simd::store(ra + j, simd::add(a1r, ucr)); simd::store(ia + j, simd::add(a1i, uci));
+                simd::store(rc + j, simd::sub(a1r, ucr)); simd::store(ic + j, simd::sub(a1i, uci));
+                simd::store(rb + j, simd::add(b1r, udi)); simd::store(ib + j, simd::sub(b1i, udr));
+                simd::store(rd + j, simd::sub(b1r, udi)); simd::store(id + j, simd::add(b1i, udr));
             }
         }
     }
+
+    int size_ = 0;
+    std::vector<float> twRe_, twIm_;
+    std::vector<uint32_t> bitrev_;       // size_
+    std::vector<uint32_t> bitrevHalf_;   // size_ / 2 (real transform)
+    std::vector<float> workRe_, workIm_;
+    std::vector<float> windows_[4];      // by WindowType, built on demand
+};
+
+namespace internal {
+
+// One plan per size per thread for the free functions below. Plans live
+// until the thread exits; after the first call for a size nothing allocates.
+inline FftPlan& fftPlanFor(int n) {
+    thread_local std::vector<std::unique_ptr<FftPlan>> plans;
+    for (auto& p : plans) {
+        if (p->getSize() == n) return *p;
+    }
+    plans.push_back(std::make_unique<FftPlan>(n));
+    return *plans.back();
 }
 
-// In-place inverse FFT
-inline void ifft(std::vector<std::complex<float>>& data) {
+} // namespace internal
+
+// ---------------------------------------------------------------------------
+// FFT
+// ---------------------------------------------------------------------------
+
+// In-place FFT
+inline void fft(std::vector<std::complex<float>>& data) {
     int n = static_cast<int>(data.size());
     if (n <= 1) return;
 
-    // Take conjugate
-    for (auto& x : data) {
-        x = std::conj(x);
+    // Error if not power of 2
+    if (!isPowerOfTwo(n)) {
+        logError() << "FFT: size must be power of 2 (got " << n << ")";
+        return;
     }
+    internal::fftPlanFor(n).forward(data.data());
+}
 
-    // FFT
-    fft(data);
+// In-place inverse FFT
+inline void ifft(std::vector<std::complex<float>>& data) {
+    int n = static_cast<int>(data.size());
+    if (n <= 1) return;
 
-    // Take conjugate and normalize
-    for (auto& x : data) {
-        x = std::conj(x) / (float)n;
+    if (!isPowerOfTwo(n)) {
+        logError() << "IFFT: size must be power of 2 (got " << n << ")";
+        return;
     }
+    internal::fftPlanFor(n).inverse(data.data());
 }
 
 // ---------------------------------------------------------------------------
@@ -188,30 +413,59 @@ inline std::vector<std::complex<float>> toComplex(const std::vector<float>& real
     return result;
 }
 
-// FFT of real signal
-inline std::vector<std::complex<float>> fftReal(const std::vector<float>& signal) {
-    auto data = toComplex(signal);
-    fft(data);
-    return data;
+// FFT of real signal into caller-owned `out`: signal.size() / 2 + 1 bins
+// (DC .. Nyquist). `out` is only resized, so reusing it doesn't allocate.
+inline void fftReal(const std::vector<float>& signal, std::vector<std::complex<float>>& out,
+                    WindowType window = WindowType::Rect) {
+    int n = static_cast<int>(signal.size());
+    if (!isPowerOfTwo(n)) {
+        logError() << "FFT: size must be power of 2 (got " << n << ")";
+        out.clear();
+        return;
+    }
+    out.resize(n / 2 + 1);
+    internal::fftPlanFor(n).forwardReal(signal.data(), out.data(), window);
 }
 
-// FFT of real signal (with window function)
+// FFT of real signal (full signal.size() bins; the upper half mirrors the
+// lower one)
 inline std::vector<std::complex<float>> fftReal(const std::vector<float>& signal, WindowType window) {
-    std::vector<float> windowed = signal;
-    applyWindow(windowed, window);
-    return fftReal(windowed);
+    int n = static_cast<int>(signal.size());
+    if (n <= 1 || !isPowerOfTwo(n)) {
+        // Size errors are reported by fft()
+        auto data = toComplex(signal);
+        if (window != WindowType::Rect) applyWindow(data, window);
+        fft(data);
+        return data;
+    }
+    std::vector<std::complex<float>> data(n);
+    internal::fftPlanFor(n).forwardReal(signal.data(), data.data(), window);
+    for (int k = n / 2 + 1; k < n; k++) data[k] = std::conj(data[n - k]);
+    return data;
+}
+
+inline std::vector<std::complex<float>> fftReal(const std::vector<float>& signal) {
+    return fftReal(signal, WindowType::Rect);
 }
 
 // ---------------------------------------------------------------------------
 // Spectrum analysis
 // ---------------------------------------------------------------------------
 
-// Get magnitude (amplitude)
-inline std::vector<float> fftMagnitude(const std::vector<std::complex<float>>& spectrum) {
-    std::vector<float> mag(spectrum.size());
+// Get magnitude (amplitude) into caller-owned `out` (resized to match)
+inline void fftMagnitude(const std::vector<std::complex<float>>& spectrum, std::vector<float>& out) {
+    out.resize(spectrum.size());
+    // sqrt(re^2 + im^2) rather than std::abs, which goes through hypot().
+    const float* p = reinterpret_cast<const float*>(spectrum.data());
     for (size_t i = 0; i < spectrum.size(); i++) {
-        mag[i] = std::abs(spectrum[i]);
+        out[i] = std::sqrt(p[2 * i] * p[2 * i] + p[2 * i + 1] * p[2 * i + 1]);
     }
+}
+
+// Get magnitude (amplitude)
+inline std::vector<float> fftMagnitude(const std::vector<std::complex<float>>& spectrum) {
+    std::vector<float> mag;
+    fftMagnitude(spectrum, mag);
     return mag;
 }
 
@@ -0,0 +1,536 @@
+#pragma once
+
+// =============================================================================
+// tcAudioAnalyzer.h - Streaming spectral analysis of the engine output
+//
+// Runs a hop-based STFT over the mixer's mono analysis ring on its own
+// worker thread, so analysis follows the audio clock instead of the frame
+// rate: every hop (default 512 frames, ~10.7 ms at 48 kHz) produces a
+// magnitude spectrum, Mel bands, RMS / peak, spectral flux with onset
+// detection and a running BPM estimate, stamped with the engine frame
+// position it describes.
+//
+//   AudioAnalyzer analyzer;
+//   analyzer.start();                      // after the engine is initialized
+//   ...
+//   const auto& a = analyzer.getFrame();   // latest hop, lock-free
+//   drawBars(a.mel);
+//   if (a.onsetCount != lastOnsets) { flash(); lastOnsets = a.onsetCount; }
+//
+// - The audio thread does nothing extra: the mixer already appends each
+//   block to the analysis ring (AudioEngine::readAnalysis()); the worker
+//   polls its position and never blocks the callback.
+// - Results go through a TripleBuffer: getFrame() returns the newest
+//   complete hop without locking. Read it from one thread (usually main).
+//   Hops between two reads are superseded, but onsetCount /
+//   lastOnsetPosition count every onset, so none are missed.
+// - feed() analyzes a mono stream you supply (mic input, offline files)
+//   with the same pipeline, synchronously, instead of the engine output.
+// =============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "tcSound.h"
+#include "../math/tcFFT.h"
+#include "../utils/tcLog.h"
+#include "../utils/tcTripleBuffer.h"
+
+namespace trussc {
+
+// -----------------------------------------------------------------------------
+// AudioAnalyzerSettings
+// -----------------------------------------------------------------------------
+struct AudioAnalyzerSettings {
+    int fftSize = 2048;             // power of two, 64 .. ANALYSIS_BUFFER_SIZE
+    int hopSize = 512;              // frames between analyses (<= fftSize)
+    WindowType window = WindowType::Hanning;
+
+    int   melBands = 32;
+    float melMinHz = 30.0f;
+    float melMaxHz = 16000.0f;      // clamped to Nyquist
+
+    // Onset: flux above mean + onsetThreshold * deviation of the last
+    // ~0.5 s, at least minOnsetInterval seconds after the previous one.
+    float onsetThreshold   = 1.5f;
+    float minOnsetInterval = 0.08f;
+
+    // BPM search range and the onset history it looks at (seconds).
+    float minBpm     = 70.0f;
+    float maxBpm     = 180.0f;
+    float bpmHistory = 8.0f;
+};
+
+// -----------------------------------------------------------------------------
+// AudioAnalysisFrame — one hop
+// -----------------------------------------------------------------------------
+struct AudioAnalysisFrame {
+    // Engine frame just past the analysed window (same numbering as
+    // AudioOutBuffer::framePosition; in feed() mode, frames fed so far) and
+    // that position in seconds.
+    uint64_t framePosition = 0;
+    double   time = 0.0;
+    uint64_t hop = 0;               // hops analysed so far (0 = nothing yet)
+    int      sampleRate = 0;
+    int      fftSize = 0;
+
+    // fftSize / 2 + 1 bins, DC .. Nyquist, scaled so a sine of amplitude A
+    // reads about A at its bin (binToFrequency() maps bins to Hz).
+    std::vector<float> magnitudes;
+
+    // Mel bands, low to high: sqrt of the triangle-weighted power, so a
+    // tone of amplitude A at a band's center reads a little above A.
+    std::vector<float> mel;
+
+    // Over the hop's new samples (the last hopSize frames).
+    float rms  = 0.0f;
+    float peak = 0.0f;
+
+    // Half-wave rectified change of the log spectrum since the last hop.
+    float flux = 0.0f;
+
+    bool     onset = false;         // an onset was detected at this hop
+    uint64_t onsetCount = 0;        // onsets since start()
+    uint64_t lastOnsetPosition = 0; // framePosition of the latest onset
+
+    float bpm = 0.0f;               // 0 until enough history
+    float bpmConfidence = 0.0f;     // 0 .. 1 (normalized autocorrelation)
+};
+
+// -----------------------------------------------------------------------------
+// AudioAnalyzer
+// -----------------------------------------------------------------------------
+class AudioAnalyzer {
+public:
+    AudioAnalyzer() = default;
+    ~AudioAnalyzer() { stop(); }
+
+    AudioAnalyzer(const AudioAnalyzer&) = delete;
+    AudioAnalyzer& operator=(const AudioAnalyzer&) = delete;
+
+    // Start analysing the engine's master output on a worker thread. The
+    // engine must already be initialized; returns false otherwise.
+    bool start(const AudioAnalyzerSettings& settings = {}) {
+        if (isRunning()) {
+            logWarning("AudioAnalyzer") << "start: already running";
+            return false;
+        }
+        auto& engine = AudioEngine::getInstance();
+        if (!engine.isInitialized()) {
+            logWarning("AudioAnalyzer")
+                << "start: AudioEngine is not initialized - nothing to analyze";
+            return false;
+        }
+        applySettings(settings);
+        configure(engine.getSampleRate());
+        resetFrames();
+        cursor_ = engine.getAnalysisPosition();
+        position_ = cursor_;
+        droppedHops_.store(0, std::memory_order_relaxed);
+
+        running_.store(true, std::memory_order_release);
+        worker_ = std::thread([this] { workerLoop(); });
+        return true;
+    }
+
+    // Stop the worker. The last frame stays readable. Safe when not running.
+    void stop() {
+        if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Manual mode: analyze a mono stream at `sampleRate` pushed through
+    // feed(). Resets all state; not while start()ed.
+    void setup(int sampleRate, const AudioAnalyzerSettings& settings = {}) {
+        if (isRunning()) {
+            logWarning("AudioAnalyzer") << "setup: stop() the engine analysis first";
+            return;
+        }
+        applySettings(settings);
+        configure(sampleRate);
+        resetFrames();
+        position_ = 0;
+    }
+
+    // Analyze `count` more mono samples (manual mode). Hops complete inside
+    // this call and are published before it returns.
+    void feed(const float* mono, size_t count) {
+        if (isRunning() || fftSize_ == 0) return;
+        process(mono, count);
+    }
+
+    // Latest published hop. Call from one thread only; the reference stays
+    // valid until the next getFrame() call.
+    const AudioAnalysisFrame& getFrame() {
+        frames_.update();
+        return frames_.front();
+    }
+
+    // True if a hop was published since the last getFrame().
+    bool hasNewFrame() const { return frames_.hasUpdate(); }
+
+    // Hops skipped because the worker fell more than the analysis ring
+    // behind the mixer (0 in normal operation).
+    uint64_t getDroppedHops() const { return droppedHops_.load(std::memory_order_relaxed); }
+
+    const AudioAnalyzerSettings& getSettings() const { return settings_; }
+
+    // Center frequency of Mel band `band`, in Hz, at the sample rate of the
+    // last getFrame(). Same thread as getFrame().
+    float getMelFrequency(int band) const {
+        if (band < 0 || band >= settings_.melBands) return 0.0f;
+        return melPointHz(settings_, frames_.front().sampleRate, band + 1);
+    }
+
+private:
+    struct MelFilter {
+        int start = 0;                  // first bin
+        std::vector<float> weights;
+    };
+
+    static float hzToMel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+    static float melToHz(float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+    // Point k of the bands + 2 equally Mel-spaced filter edges; band m spans
+    // points m .. m + 2 and peaks at m + 1.
+    static float melPointHz(const AudioAnalyzerSettings& s, int sampleRate, int k) {
+        const float nyquist = 0.5f * (float)std::max(sampleRate, 1);
+        const float minHz = std::clamp(s.melMinHz, 0.0f, nyquist);
+        const float maxHz = std::clamp(s.melMaxHz, std::min(minHz + 1.0f, nyquist), nyquist);
+        const float lo = hzToMel(minHz), hi = hzToMel(maxHz);
+        return melToHz(lo + (hi - lo) * (float)k / (float)(s.melBands + 1));
+    }
+
+    // --- setup -------------------------------------------------------------
+    // Caller's thread only (start() / setup()); the worker just reads these.
+    void applySettings(const AudioAnalyzerSettings& settings) {
+        settings_ = settings;
+        settings_.fftSize = nextPowerOfTwo(std::clamp(settings.fftSize, 64, (int)AudioEngine::ANALYSIS_BUFFER_SIZE));
+        settings_.hopSize = std::clamp(settings.hopSize, 1, settings_.fftSize);
+        settings_.melBands = std::max(1, settings.melBands);
+    }
+
+    void configure(int sampleRate) {
+        sampleRate_ = std::max(sampleRate, 1);
+        fftSize_ = settings_.fftSize;
+        hopSize_ = settings_.hopSize;
+
+        plan_.setup(fftSize_);
+        const int bins = fftSize_ / 2 + 1;
+        history_.assign((size_t)fftSize_, 0.0f);
+        hopBuf_.assign((size_t)hopSize_, 0.0f);
+        hopFill_ = 0;
+        spectrum_.assign((size_t)bins, {});
+        logMag_.assign((size_t)bins, 0.0f);
+        prevLogMag_.assign((size_t)bins, 0.0f);
+
+        // 2 / sum(window): a sine of amplitude A peaks at ~A.
+        const float* w = plan_.getWindow(settings_.window);
+        double sum = 0.0;
+        for (int i = 0; i < fftSize_; i++) sum += w[i];
+        magScale_ = sum > 0.0 ? (float)(2.0 / sum) : 0.0f;
+
+        buildMelFilters(bins);
+
+        const float hopsPerSec = (float)sampleRate_ / (float)hopSize_;
+        fluxWindow_.assign((size_t)std::max(4, (int)(0.5f * hopsPerSec)), 0.0f);
+        fluxWindowPos_ = 0;
+        envelope_.assign((size_t)std::max(16, (int)(settings_.bpmHistory * hopsPerSec)), 0.0f);
+        envelopePos_ = 0;
+        envelopeCount_ = 0;
+        prevFlux_ = 0.0f;
+        hop_ = 0;
+        onsetCount_ = 0;
+        lastOnsetPosition_ = 0;
+        hasOnset_ = false;
+        bpm_ = 0.0f;
+        bpmConfidence_ = 0.0f;
+        bpmCorr_.clear();
+    }
+
+    // Size all three frame slots up front so hops never allocate, whichever
+    // slots the reader happens to leave the writer. Reader-side state too:
+    // only from start() / setup(), not from the worker.
+    void resetFrames() {
+        AudioAnalysisFrame blank;
+        blank.sampleRate = sampleRate_;
+        blank.fftSize = fftSize_;
+        blank.magnitudes.assign((size_t)(fftSize_ / 2 + 1), 0.0f);
+        blank.mel.assign(melFilters_.size(), 0.0f);
+        frames_.reset(blank);
+    }
+
+    void buildMelFilters(int bins) {
+        const int bands = settings_.melBands;
+        const float binHz = (float)sampleRate_ / (float)fftSize_;
+
+        melFilters_.assign((size_t)bands, {});
+        for (int m = 0; m < bands; m++) {
+            const float f0 = melPointHz(settings_, sampleRate_, m);
+            const float f1 = melPointHz(settings_, sampleRate_, m + 1);
+            const float f2 = melPointHz(settings_, sampleRate_, m + 2);
+            MelFilter& f = melFilters_[(size_t)m];
+            const int b0 = std::max(0, (int)std::ceil(f0 / binHz));
+            const int b2 = std::min(bins - 1, (int)std::floor(f2 / binHz));
+            f.start = b0;
+            for (int b = b0; b <= b2; b++) {
+                const float hz = (float)b * binHz;
+                const float wgt = hz <= f1 ? (hz - f0) / std::max(f1 - f0, 1e-6f)
+                                           : (f2 - hz) / std::max(f2 - f1, 1e-6f);
+                f.weights.push_back(std::max(0.0f, wgt));
+            }
+            // Low bands can be narrower than a bin: use the nearest one.
+            if (f.weights.empty() || *std::max_element(f.weights.begin(), f.weights.end()) == 0.0f) {
+                f.start = std::clamp((int)std::lround(f1 / binHz), 0, bins - 1);
+                f.weights.assign(1, 1.0f);
+            }
+        }
+    }
+
+    // --- worker --------------------------------------------------------------
+    void workerLoop() {
+        auto& engine = AudioEngine::getInstance();
+        constexpr size_t CHUNK = 1024;
+        std::vector<float> chunk(CHUNK);
+        const auto nap = std::chrono::microseconds(
+            std::clamp((int64_t)(5e5 * hopSize_ / sampleRate_), (int64_t)1000, (int64_t)10000));
+
+        while (running_.load(std::memory_order_acquire)) {
+            // Device re-init at a new rate: restart the analysis there (the
+            // frame slots resize themselves on the next hops).
+            if (engine.getSampleRate() != sampleRate_) {
+                configure(engine.getSampleRate());
+                cursor_ = engine.getAnalysisPosition();
+                position_ = cursor_;
+            }
+
+            const uint64_t end = engine.getAnalysisPosition();
+            while (cursor_ < end) {
+                const size_t n = (size_t)std::min<uint64_t>(end - cursor_, CHUNK);
+                if (!engine.readAnalysis(cursor_, chunk.data(), n)) {
+                    // Fell a whole ring behind (debugger, suspended
+                    // process): skip to the present.
+                    const uint64_t now = engine.getAnalysisPosition();
+                    droppedHops_.fetch_add((now - cursor_) / (uint64_t)hopSize_,
+                                           std::memory_order_relaxed);
+                    cursor_ = now;
+                    position_ = now;
+                    hopFill_ = 0;
+                    break;
+                }
+                process(chunk.data(), n);
+                cursor_ += n;
+            }
+            std::this_thread::sleep_for(nap);
+        }
+    }
+
+    // --- analysis ------------------------------------------------------------
+    void process(const float* mono, size_t count) {
+        while (count > 0) {
+            const size_t take = std::min(count, (size_t)(hopSize_ - hopFill_));
+            std::memcpy(hopBuf_.data() + hopFill_, mono, take * sizeof(float));
+            hopFill_ += (int)take;
+            position_ += take;
+            mono += take;
+            count -= take;
+            if (hopFill_ == hopSize_) {
+                std::memmove(history_.data(), history_.data() + hopSize_,
+                             (size_t)(fftSize_ - hopSize_) * sizeof(float));
+                std::memcpy(history_.data() + (fftSize_ - hopSize_), hopBuf_.data(),
+                            (size_t)hopSize_ * sizeof(float));
+                hopFill_ = 0;
+                analyzeHop();
+            }
+        }
+    }
+
+    void analyzeHop() {
+        AudioAnalysisFrame& out = frames_.back();
+        const int bins = fftSize_ / 2 + 1;
+        hop_++;
+
+        out.framePosition = position_;
+        out.time = (double)position_ / (double)sampleRate_;
+        out.hop = hop_;
+        out.sampleRate = sampleRate_;
+        out.fftSize = fftSize_;
+
+        // Level over the new samples.
+        float sq = 0.0f, pk = 0.0f;
+        for (float v : hopBuf_) {
+            sq += v * v;
+            pk = std::max(pk, std::fabs(v));
+        }
+        out.rms = std::sqrt(sq / (float)hopSize_);
+        out.peak = pk;
+
+        // Spectrum.
+        plan_.forwardReal(history_.data(), spectrum_.data(), settings_.window);
+        out.magnitudes.resize((size_t)bins);
+        for (int b = 0; b < bins; b++) {
+            const float re = spectrum_[(size_t)b].real(), im = spectrum_[(size_t)b].imag();
+            out.magnitudes[(size_t)b] = std::sqrt(re * re + im * im) * magScale_;
+        }
+
+        out.mel.resize(melFilters_.size());
+        for (size_t m = 0; m < melFilters_.size(); m++) {
+            const MelFilter& f = melFilters_[m];
+            float power = 0.0f;
+            for (size_t i = 0; i < f.weights.size(); i++) {
+                const float mag = out.magnitudes[(size_t)f.start + i];
+                power += f.weights[i] * mag * mag;
+            }
+            out.mel[m] = std::sqrt(power);
+        }
+
+        // Spectral flux on a log-compressed spectrum.
+        float flux = 0.0f;
+        for (int b = 0; b < bins; b++) {
+            logMag_[(size_t)b] = std::log1p(100.0f * out.magnitudes[(size_t)b]);
+            flux += std::max(0.0f, logMag_[(size_t)b] - prevLogMag_[(size_t)b]);
+        }
+        flux /= (float)bins;
+        std::swap(logMag_, prevLogMag_);
+        out.flux = flux;
+
+        detectOnset(out, flux);
+
+        envelope_[envelopePos_] = flux;
+        envelopePos_ = (envelopePos_ + 1) % envelope_.size();
+        envelopeCount_++;
+        // Tempo changes slowly; re-estimate about 4 times a second.
+        const uint64_t every = std::max<uint64_t>(1, (uint64_t)(sampleRate_ / (4 * hopSize_)));
+        if (hop_ % every == 0) estimateBpm();
+        out.bpm = bpm_;
+        out.bpmConfidence = bpmConfidence_;
+
+        frames_.publish();
+    }
+
+    void detectOnset(AudioAnalysisFrame& out, float flux) {
+        // Adaptive threshold from the recent flux (before this hop).
+        float mean = 0.0f;
+        for (float v : fluxWindow_) mean += v;
+        mean /= (float)fluxWindow_.size();
+        float dev = 0.0f;
+        for (float v : fluxWindow_) dev += std::fabs(v - mean);
+        dev /= (float)fluxWindow_.size();
+        fluxWindow_[fluxWindowPos_] = flux;
+        fluxWindowPos_ = (fluxWindowPos_ + 1) % fluxWindow_.size();
+
+        const float threshold = mean + settings_.onsetThreshold * dev + 1e-3f;
+        const uint64_t minGap = (uint64_t)(settings_.minOnsetInterval * (float)sampleRate_);
+        const bool spaced = !hasOnset_ || position_ - lastOnsetPosition_ >= minGap;
+        out.onset = flux > threshold && flux >= prevFlux_ && spaced;
+        prevFlux_ = flux;
+        if (out.onset) {
+            onsetCount_++;
+            lastOnsetPosition_ = position_;
+            hasOnset_ = true;
+        }
+        out.onsetCount = onsetCount_;
+        out.lastOnsetPosition = lastOnsetPosition_;
+    }
+
+    // Autocorrelation of the flux envelope over the BPM range, weighted
+    // towards ~120 BPM to settle octave ambiguity, with parabolic
+    // interpolation of the peak lag.
+    void estimateBpm() {
+        const size_t n = std::min<size_t>(envelopeCount_, envelope_.size());
+        const float hopsPerSec = (float)sampleRate_ / (float)hopSize_;
+        const int minLag = std::max(1, (int)std::floor(60.0f * hopsPerSec / std::max(settings_.maxBpm, 1.0f)));
+        const int maxLag = (int)std::ceil(60.0f * hopsPerSec / std::max(settings_.minBpm, 1.0f));
+        if (n < (size_t)maxLag * 2 + 2) return;
+
+        // Oldest .. newest, mean removed.
+        ordered_.resize(n);
+        const size_t first = (envelopePos_ + envelope_.size() - n) % envelope_.size();
+        float mean = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            ordered_[i] = envelope_[(first + i) % envelope_.size()];
+            mean += ordered_[i];
+        }
+        mean /= (float)n;
+        float energy = 0.0f;
+        for (float& v : ordered_) {
+            v -= mean;
+            energy += v * v;
+        }
+        if (energy <= 1e-12f) return;
+
+        bpmCorr_.assign((size_t)(maxLag + 2), 0.0f);
+        for (int lag = std::max(1, minLag - 1); lag <= maxLag + 1; lag++) {
+            float acc = 0.0f;
+            for (size_t i = (size_t)lag; i < n; i++) acc += ordered_[i] * ordered_[i - (size_t)lag];
+            bpmCorr_[(size_t)lag] = acc / energy;
+        }
+
+        int best = -1;
+        float bestScore = 0.0f;
+        for (int lag = minLag; lag <= maxLag; lag++) {
+            const float bpm = 60.0f * hopsPerSec / (float)lag;
+            const float octave = std::log2(bpm / 120.0f);
+            const float score = bpmCorr_[(size_t)lag] * std::exp(-0.5f * octave * octave);
+            if (score > bestScore) {
+                bestScore = score;
+                best = lag;
+            }
+        }
+        if (best < 0) {
+            bpmConfidence_ = 0.0f;
+            return;
+        }
+        float lag = (float)best;
+        const float a = bpmCorr_[(size_t)best - 1], b = bpmCorr_[(size_t)best], c = bpmCorr_[(size_t)best + 1];
+        const float denom = a - 2.0f * b + c;
+        if (denom < 0.0f) lag += std::clamp(0.5f * (a - c) / denom, -0.5f, 0.5f);
+        bpm_ = 60.0f * hopsPerSec / lag;
+        bpmConfidence_ = std::clamp(b, 0.0f, 1.0f);
+    }
+
+    // --- state ---------------------------------------------------------------
+    AudioAnalyzerSettings settings_;
+    int sampleRate_ = 0;
+    int fftSize_ = 0;
+    int hopSize_ = 0;
+
+    // Worker (or feed() caller) only.
+    FftPlan plan_;
+    std::vector<float> history_;                   // last fftSize_ samples
+    std::vector<float> hopBuf_;                    // samples of the hop in progress
+    int hopFill_ = 0;
+    uint64_t position_ = 0;                        // frame after the last sample processed
+    uint64_t cursor_ = 0;                          // next engine frame to read
+    std::vector<std::complex<float>> spectrum_;
+    float magScale_ = 0.0f;
+    std::vector<MelFilter> melFilters_;
+    std::vector<float> logMag_, prevLogMag_;
+    std::vector<float> fluxWindow_;
+    size_t fluxWindowPos_ = 0;
+    float prevFlux_ = 0.0f;
+    std::vector<float> envelope_, ordered_, bpmCorr_;
+    size_t envelopePos_ = 0;
+    uint64_t envelopeCount_ = 0;
+    uint64_t hop_ = 0;
+    uint64_t onsetCount_ = 0;
+    uint64_t lastOnsetPosition_ = 0;
+    bool hasOnset_ = false;
+    float bpm_ = 0.0f, bpmConfidence_ = 0.0f;
+
+    TripleBuffer<AudioAnalysisFrame> frames_;
+    std::atomic<uint64_t> droppedHops_{0};
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+};
+
+} // namespace trussc
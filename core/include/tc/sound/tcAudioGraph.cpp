@@ -0,0 +1,693 @@
+// =============================================================================
+// tcAudioGraph.cpp - effect nodes, buses and graph scheduling
+// =============================================================================
+
+#include "tc/sound/tcAudioGraph.h"
+
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace trussc {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+float dbToGain(float db) { return std::pow(10.0f, db * 0.05f); }
+
+// Flush values that would decay into denormals in recursive state.
+inline float flushDenormal(float v) { return std::fabs(v) < 1e-20f ? 0.0f : v; }
+
+size_t nextPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// BiquadFilter
+// =============================================================================
+
+BiquadFilter::BiquadFilter(Type type, float frequency, float q, float gainDb)
+    : type_((int)type), frequency_(frequency), q_(q), gainDb_(gainDb) {}
+
+void BiquadFilter::computeCoefficients(Type type, float frequency, float q, float gainDb,
+                                       int sampleRate, float out[5]) {
+    const float fs = (float)std::max(sampleRate, 1);
+    const float f  = std::clamp(frequency, 1.0f, fs * 0.49f);
+    const float w0 = 2.0f * kPi * f / fs;
+    const float cw = std::cos(w0);
+    const float alpha = std::sin(w0) / (2.0f * std::max(q, 0.05f));
+    const float A = std::pow(10.0f, gainDb / 40.0f);
+    const float sqA2a = 2.0f * std::sqrt(A) * alpha;
+
+    float b0 = 1, b1 = 0, b2 = 0, a0 = 1, a1 = 0, a2 = 0;
+    switch (type) {
+        case Type::LowPass:
+            b0 = (1 - cw) * 0.5f; b1 = 1 - cw; b2 = b0;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case Type::HighPass:
+            b0 = (1 + cw) * 0.5f; b1 = -(1 + cw); b2 = b0;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case Type::BandPass:
+            b0 = alpha; b1 = 0; b2 = -alpha;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case Type::Notch:
+            b0 = 1; b1 = -2 * cw; b2 = 1;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case Type::AllPass:
+            b0 = 1 - alpha; b1 = -2 * cw; b2 = 1 + alpha;
+            a0 = 1 + alpha; a1 = -2 * cw; a2 = 1 - alpha;
+            break;
+        case Type::Peak:
+            b0 = 1 + alpha * A; b1 = -2 * cw; b2 = 1 - alpha * A;
+            a0 = 1 + alpha / A; a1 = -2 * cw; a2 = 1 - alpha / A;
+            break;
+        case Type::LowShelf:
+            b0 = A * ((A + 1) - (A - 1) * cw + sqA2a);
+            b1 = 2 * A * ((A - 1) - (A + 1) * cw);
+            b2 = A * ((A + 1) - (A - 1) * cw - sqA2a);
+            a0 = (A + 1) + (A - 1) * cw + sqA2a;
+            a1 = -2 * ((A - 1) + (A + 1) * cw);
+            a2 = (A + 1) + (A - 1) * cw - sqA2a;
+            break;
+        case Type::HighShelf:
+            b0 = A * ((A + 1) + (A - 1) * cw + sqA2a);
+            b1 = -2 * A * ((A - 1) + (A + 1) * cw);
+            b2 = A * ((A + 1) + (A - 1) * cw - sqA2a);
+            a0 = (A + 1) - (A - 1) * cw + sqA2a;
+            a1 = 2 * ((A - 1) - (A + 1) * cw);
+            a2 = (A + 1) - (A - 1) * cw - sqA2a;
+            break;
+    }
+    out[0] = b0 / a0;
+    out[1] = b1 / a0;
+    out[2] = b2 / a0;
+    out[3] = a1 / a0;
+    out[4] = a2 / a0;
+}
+
+float BiquadFilter::getResponse(float hz) const {
+    float c[5];
+    computeCoefficients(getType(), getFrequency(), getQ(), getGain(), sampleRate_, c);
+    const float w = 2.0f * kPi * hz / (float)sampleRate_;
+    const std::complex<float> z1 = std::polar(1.0f, -w);
+    const std::complex<float> z2 = z1 * z1;
+    return std::abs((c[0] + c[1] * z1 + c[2] * z2) / (1.0f + c[3] * z1 + c[4] * z2));
+}
+
+void BiquadFilter::prepare(int sampleRate, int channels) {
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    std::fill(std::begin(z1_), std::end(z1_), 0.0f);
+    std::fill(std::begin(z2_), std::end(z2_), 0.0f);
+    touch();
+}
+
+void BiquadFilter::process(float* buffer, int frames, int channels) {
+    if (consumeChanges()) {
+        computeCoefficients(getType(), getFrequency(), getQ(), getGain(), sampleRate_, c_);
+    }
+    const float b0 = c_[0], b1 = c_[1], b2 = c_[2], a1 = c_[3], a2 = c_[4];
+    const int chs = std::min(channels, MAX_CHANNELS);
+    // The recursion is serial in time, so channels are the only parallel
+    // axis; each runs as its own tight loop with the state in registers.
+    for (int c = 0; c < chs; c++) {
+        float z1 = z1_[c], z2 = z2_[c];
+        float* p = buffer + c;
+        for (int i = 0; i < frames; i++, p += channels) {
+            const float x = *p;
+            const float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            *p = y;
+        }
+        z1_[c] = flushDenormal(z1);
+        z2_[c] = flushDenormal(z2);
+    }
+}
+
+// =============================================================================
+// SvfFilter (Simper / Cytomic trapezoidal SVF)
+// =============================================================================
+
+SvfFilter::SvfFilter(Type type, float cutoff, float q)
+    : type_((int)type), cutoff_(cutoff), q_(q) {}
+
+void SvfFilter::prepare(int sampleRate, int channels) {
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    std::fill(std::begin(ic1_), std::end(ic1_), 0.0f);
+    std::fill(std::begin(ic2_), std::end(ic2_), 0.0f);
+    touch();
+}
+
+void SvfFilter::process(float* buffer, int frames, int channels) {
+    if (consumeChanges()) {
+        const float fs = (float)std::max(sampleRate_, 1);
+        const float fc = std::clamp(getCutoff(), 1.0f, fs * 0.49f);
+        const float g = std::tan(kPi * fc / fs);
+        k_  = 1.0f / std::max(getQ(), 0.05f);
+        a1_ = 1.0f / (1.0f + g * (g + k_));
+        a2_ = g * a1_;
+        a3_ = g * a2_;
+    }
+    // Output = m0 * input + m1 * band + m2 * low.
+    float m0 = 0, m1 = 0, m2 = 1;
+    switch (getType()) {
+        case Type::LowPass:  m0 = 0; m1 = 0;    m2 = 1;  break;
+        case Type::HighPass: m0 = 1; m1 = -k_;  m2 = -1; break;
+        case Type::BandPass: m0 = 0; m1 = 1;    m2 = 0;  break;
+        case Type::Notch:    m0 = 1; m1 = -k_;  m2 = 0;  break;
+        case Type::Peak:     m0 = 1; m1 = -k_;  m2 = -2; break;
+    }
+    const float a1 = a1_, a2 = a2_, a3 = a3_;
+    const int chs = std::min(channels, MAX_CHANNELS);
+    for (int c = 0; c < chs; c++) {
+        float ic1 = ic1_[c], ic2 = ic2_[c];
+        float* p = buffer + c;
+        for (int i = 0; i < frames; i++, p += channels) {
+            const float v0 = *p;
+            const float v3 = v0 - ic2;
+            const float v1 = a1 * ic1 + a2 * v3;
+            const float v2 = ic2 + a2 * ic1 + a3 * v3;
+            ic1 = 2.0f * v1 - ic1;
+            ic2 = 2.0f * v2 - ic2;
+            *p = m0 * v0 + m1 * v1 + m2 * v2;
+        }
+        ic1_[c] = flushDenormal(ic1);
+        ic2_[c] = flushDenormal(ic2);
+    }
+}
+
+// =============================================================================
+// Delay
+// =============================================================================
+
+Delay::Delay(float seconds, float feedback, float mix, float maxSeconds)
+    : time_(seconds), feedback_(feedback), mix_(mix), maxSeconds_(std::max(maxSeconds, 0.001f)) {}
+
+void Delay::prepare(int sampleRate, int channels) {
+    sampleRate_ = sampleRate;
+    channels_ = std::min(channels, MAX_CHANNELS);
+    capacity_ = nextPow2((size_t)(maxSeconds_ * (float)sampleRate) + 4);
+    line_.assign(capacity_ * (size_t)channels_, 0.0f);
+    write_ = 0;
+    current_ = -1.0f;
+}
+
+void Delay::process(float* buffer, int frames, int channels) {
+    if (line_.empty()) return;
+    const int chs = std::min(channels, channels_);
+    const size_t mask = capacity_ - 1;
+    const float target = std::clamp(getTime() * (float)sampleRate_, 1.0f, (float)(capacity_ - 2));
+    const float feedback = std::clamp(getFeedback(), -0.98f, 0.98f);
+    const float wet = std::clamp(getMix(), 0.0f, 1.0f);
+    const float dry = 1.0f - wet;
+
+    // Glide the delay time to the new value across this block.
+    if (current_ < 0.0f) current_ = target;
+    const float step = (target - current_) / (float)frames;
+
+    float* line = line_.data();
+    for (int i = 0; i < frames; i++) {
+        const float d = current_ + step * (float)(i + 1);
+        const float r = (float)write_ + (float)capacity_ - d;
+        const size_t i0 = (size_t)r;
+        const float frac = r - (float)i0;
+        const float* s0 = line + (i0 & mask) * (size_t)channels_;
+        const float* s1 = line + ((i0 + 1) & mask) * (size_t)channels_;
+        float* w = line + write_ * (size_t)channels_;
+        float* p = buffer + (size_t)i * channels;
+        for (int c = 0; c < chs; c++) {
+            const float delayed = s0[c] + (s1[c] - s0[c]) * frac;
+            const float x = p[c];
+            w[c] = flushDenormal(x + delayed * feedback);
+            p[c] = x * dry + delayed * wet;
+        }
+        write_ = (write_ + 1) & mask;
+    }
+    current_ = target;
+}
+
+// =============================================================================
+// Reverb
+// =============================================================================
+
+namespace {
+// Freeverb tunings at 44.1 kHz; the right side is spread by 23 samples.
+constexpr int kCombTuning[8]    = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+constexpr int kAllpassTuning[4] = {556, 441, 341, 225};
+constexpr int kStereoSpread     = 23;
+constexpr float kFixedGain      = 0.015f;
+constexpr float kScaleWet       = 3.0f;
+} // anonymous namespace
+
+Reverb::Reverb(float roomSize, float damping, float wet, float dry, float width)
+    : roomSize_(roomSize), damping_(damping), wet_(wet), dry_(dry), width_(width) {}
+
+void Reverb::prepare(int sampleRate, int channels) {
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    const float scale = (float)sampleRate / 44100.0f;
+    for (int side = 0; side < 2; side++) {
+        const int spread = side * kStereoSpread;
+        for (int i = 0; i < COMBS; i++) {
+            comb_[side][i].buf.assign((size_t)std::max(1.0f, (kCombTuning[i] + spread) * scale), 0.0f);
+            comb_[side][i].pos = 0;
+            comb_[side][i].store = 0.0f;
+        }
+        for (int i = 0; i < ALLPASSES; i++) {
+            allpass_[side][i].buf.assign((size_t)std::max(1.0f, (kAllpassTuning[i] + spread) * scale), 0.0f);
+            allpass_[side][i].pos = 0;
+        }
+    }
+    touch();
+}
+
+void Reverb::process(float* buffer, int frames, int channels) {
+    if (comb_[0][0].buf.empty()) return;
+    if (consumeChanges()) {
+        feedback_ = std::clamp(getRoomSize(), 0.0f, 1.0f) * 0.28f + 0.7f;
+        damp_ = std::clamp(getDamping(), 0.0f, 1.0f) * 0.4f;
+        const float wet = std::max(getWet(), 0.0f) * kScaleWet;
+        const float width = std::clamp(getWidth(), 0.0f, 1.0f);
+        wet1_ = wet * (width * 0.5f + 0.5f);
+        wet2_ = wet * ((1.0f - width) * 0.5f);
+        dryGain_ = getDry();
+    }
+    const int sides = channels >= 2 ? 2 : 1;
+    const float damp1 = damp_, damp2 = 1.0f - damp_, feedback = feedback_;
+
+    for (int i = 0; i < frames; i++) {
+        float* p = buffer + (size_t)i * channels;
+        const float input = (sides == 2 ? p[0] + p[1] : 2.0f * p[0]) * kFixedGain;
+        float out[2] = {0.0f, 0.0f};
+        for (int side = 0; side < sides; side++) {
+            float acc = 0.0f;
+            for (auto& cb : comb_[side]) {
+                const float y = cb.buf[cb.pos];
+                cb.store = flushDenormal(y * damp2 + cb.store * damp1);
+                cb.buf[cb.pos] = input + cb.store * feedback;
+                if (++cb.pos == cb.buf.size()) cb.pos = 0;
+                acc += y;
+            }
+            for (auto& ap : allpass_[side]) {
+                const float b = ap.buf[ap.pos];
+                ap.buf[ap.pos] = flushDenormal(acc + b * 0.5f);
+                acc = b - acc;
+                if (++ap.pos == ap.buf.size()) ap.pos = 0;
+            }
+            out[side] = acc;
+        }
+        if (sides == 2) {
+            const float l = p[0], r = p[1];
+            p[0] = out[0] * wet1_ + out[1] * wet2_ + l * dryGain_;
+            p[1] = out[1] * wet1_ + out[0] * wet2_ + r * dryGain_;
+        } else {
+            p[0] = out[0] * (wet1_ + wet2_) + p[0] * dryGain_;
+        }
+    }
+}
+
+// =============================================================================
+// Compressor
+// =============================================================================
+
+Compressor::Compressor(float thresholdDb, float ratio, float attackMs, float releaseMs,
+                       float kneeDb, float makeupDb)
+    : thresholdDb_(thresholdDb), ratio_(ratio), attackMs_(attackMs),
+      releaseMs_(releaseMs), kneeDb_(kneeDb), makeupDb_(makeupDb) {}
+
+void Compressor::prepare(int sampleRate, int channels) {
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    envelopeDb_ = 0.0f;
+    touch();
+}
+
+void Compressor::process(float* buffer, int frames, int channels) {
+    if (consumeChanges()) {
+        const float fs = (float)std::max(sampleRate_, 1);
+        auto coef = [&](float ms) {
+            return ms <= 0.0f ? 0.0f : std::exp(-1.0f / (ms * 0.001f * fs));
+        };
+        attackCoef_ = coef(getAttack());
+        releaseCoef_ = coef(getRelease());
+        slope_ = 1.0f - 1.0f / std::max(getRatio(), 1.0f);
+        makeup_ = dbToGain(getMakeup());
+        ceiling_ = dbToGain(getThreshold());
+    }
+    const float threshold = getThreshold();
+    const float knee = std::max(getKnee(), 0.0f);
+    const float halfKnee = knee * 0.5f;
+    const float makeup = makeup_;
+    float env = envelopeDb_;
+
+    for (int i = 0; i < frames; i++) {
+        float* p = buffer + (size_t)i * channels;
+        float level = 0.0f;
+        for (int c = 0; c < channels; c++) level = std::max(level, std::fabs(p[c]));
+
+        // Gain computer (dB), soft knee around the threshold.
+        float reduction = 0.0f;
+        if (level > 1e-6f) {
+            const float over = 20.0f * std::log10(level) - threshold;
+            if (over > halfKnee) {
+                reduction = slope_ * over;
+            } else if (knee > 0.0f && over > -halfKnee) {
+                const float x = over + halfKnee;
+                reduction = slope_ * x * x / (2.0f * knee);
+            }
+        }
+        // Attack while reduction grows, release while it shrinks.
+        const float c = reduction > env ? attackCoef_ : releaseCoef_;
+        env = reduction + c * (env - reduction);
+
+        const float gain = (env > 1e-4f ? dbToGain(-env) : 1.0f) * makeup;
+        for (int ch = 0; ch < channels; ch++) {
+            float y = p[ch] * gain;
+            if (hardCeiling_) y = std::clamp(y, -ceiling_, ceiling_);
+            p[ch] = y;
+        }
+    }
+    envelopeDb_ = env;
+    reductionDb_.store(env, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// AudioBus
+// =============================================================================
+
+AudioBus::AudioBus(AudioGraph& graph, std::string name)
+    : graph_(graph), name_(std::move(name)),
+      buffer_((size_t)AudioGraph::BLOCK_FRAMES * AudioGraph::MAX_CHANNELS, 0.0f) {}
+
+bool AudioBus::addEffect(std::shared_ptr<AudioNode> node) {
+    if (!node) return false;
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    if (node->owner_) return false;
+    graph_.prepareNodeLocked(*node);
+    node->owner_ = this;
+    effects_.push_back(std::move(node));
+    graph_.publishLocked();
+    return true;
+}
+
+bool AudioBus::removeEffect(const std::shared_ptr<AudioNode>& node) {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    auto it = std::find(effects_.begin(), effects_.end(), node);
+    if (it == effects_.end()) return false;
+    (*it)->owner_ = nullptr;
+    effects_.erase(it);
+    graph_.publishLocked();
+    return true;
+}
+
+void AudioBus::clearEffects() {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    for (auto& n : effects_) n->owner_ = nullptr;
+    effects_.clear();
+    graph_.publishLocked();
+}
+
+std::vector<std::shared_ptr<AudioNode>> AudioBus::getEffects() const {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    return effects_;
+}
+
+bool AudioBus::setOutput(std::shared_ptr<AudioBus> bus) {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    if (this == graph_.master_.get() || removed_) return false;
+    if (bus == graph_.master_) bus.reset();
+    if (bus) {
+        if (bus.get() == this || bus->removed_ || &bus->graph_ != &graph_) return false;
+        if (graph_.reachesLocked(bus.get(), this)) return false;
+    }
+    output_ = std::move(bus);
+    graph_.publishLocked();
+    return true;
+}
+
+std::shared_ptr<AudioBus> AudioBus::getOutput() const {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    if (this == graph_.master_.get()) return nullptr;
+    return output_ ? output_ : graph_.master_;
+}
+
+bool AudioBus::setSend(const std::shared_ptr<AudioBus>& target, float level) {
+    if (!target) return false;
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    auto it = std::find_if(sends_.begin(), sends_.end(),
+                           [&](const auto& s) { return s->target == target; });
+    if (level == 0.0f) {
+        if (it != sends_.end()) {
+            sends_.erase(it);
+            graph_.publishLocked();
+        }
+        return true;
+    }
+    if (it != sends_.end()) {
+        (*it)->level.store(level, std::memory_order_relaxed);
+        return true;
+    }
+    if (target.get() == this || target->removed_ || removed_ || &target->graph_ != &graph_) return false;
+    if (graph_.reachesLocked(target.get(), this)) return false;
+    auto send = std::make_shared<Send>();
+    send->target = target;
+    send->level.store(level, std::memory_order_relaxed);
+    sends_.push_back(std::move(send));
+    graph_.publishLocked();
+    return true;
+}
+
+float AudioBus::getSend(const std::shared_ptr<AudioBus>& target) const {
+    std::lock_guard<std::mutex> lock(graph_.mutex_);
+    for (auto& s : sends_) {
+        if (s->target == target) return s->level.load(std::memory_order_relaxed);
+    }
+    return 0.0f;
+}
+
+// =============================================================================
+// AudioGraph
+// =============================================================================
+
+AudioGraph::AudioGraph() {
+    master_ = std::shared_ptr<AudioBus>(new AudioBus(*this, "master"));
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishLocked();
+}
+
+AudioGraph::~AudioGraph() {
+    delete pending_.exchange(nullptr);
+    delete garbage_.exchange(nullptr);
+    delete current_;
+}
+
+std::shared_ptr<AudioBus> AudioGraph::createBus(const std::string& name) {
+    auto bus = std::shared_ptr<AudioBus>(new AudioBus(*this, name));
+    std::lock_guard<std::mutex> lock(mutex_);
+    buses_.push_back(bus);
+    publishLocked();
+    return bus;
+}
+
+void AudioGraph::removeBus(const std::shared_ptr<AudioBus>& bus) {
+    if (!bus || bus == master_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(buses_.begin(), buses_.end(), bus);
+    if (it == buses_.end()) return;
+    buses_.erase(it);
+    bus->removed_ = true;
+    for (auto& other : buses_) {
+        if (other->output_ == bus) other->output_.reset();
+    }
+    auto dropSendsTo = [&](AudioBus& from) {
+        from.sends_.erase(std::remove_if(from.sends_.begin(), from.sends_.end(),
+                                         [&](const auto& s) { return s->target == bus; }),
+                          from.sends_.end());
+    };
+    for (auto& other : buses_) dropSendsTo(*other);
+    dropSendsTo(*master_);
+    bus->sends_.clear();
+    bus->output_.reset();
+    publishLocked();
+}
+
+std::shared_ptr<AudioBus> AudioGraph::findBus(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (master_->name_ == name) return master_;
+    for (auto& b : buses_) {
+        if (b->name_ == name) return b;
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<AudioBus>> AudioGraph::getBuses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto all = buses_;
+    all.push_back(master_);
+    return all;
+}
+
+void AudioGraph::prepareNodeLocked(AudioNode& node) {
+    if (node.preparedRate_ == sampleRate_ && node.preparedChannels_ == channels_) return;
+    node.prepare(sampleRate_, channels_);
+    node.preparedRate_ = sampleRate_;
+    node.preparedChannels_ = channels_;
+}
+
+void AudioGraph::prepare(int sampleRate, int channels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleRate_ = sampleRate;
+    channels_ = std::min(channels, MAX_CHANNELS);
+    for (auto& n : master_->effects_) prepareNodeLocked(*n);
+    for (auto& b : buses_) {
+        for (auto& n : b->effects_) prepareNodeLocked(*n);
+    }
+}
+
+// Does `from` (following outputs and sends) reach `to`?
+bool AudioGraph::reachesLocked(const AudioBus* from, const AudioBus* to) const {
+    std::vector<const AudioBus*> stack{from};
+    std::unordered_set<const AudioBus*> seen;
+    while (!stack.empty()) {
+        const AudioBus* b = stack.back();
+        stack.pop_back();
+        if (b == to) return true;
+        if (!seen.insert(b).second) continue;
+        if (b != master_.get()) stack.push_back(b->output_ ? b->output_.get() : master_.get());
+        for (auto& s : b->sends_) stack.push_back(s->target.get());
+    }
+    return false;
+}
+
+// Build the processing order (every bus after everything that feeds it,
+// master last) and hand it to the audio thread.
+void AudioGraph::publishLocked() {
+    auto* topo = new Topology();
+
+    std::vector<AudioBus*> order;
+    std::unordered_set<AudioBus*> visited;
+    std::function<void(AudioBus*)> visit = [&](AudioBus* b) {
+        if (!visited.insert(b).second) return;
+        if (b != master_.get()) visit(b->output_ ? b->output_.get() : master_.get());
+        for (auto& s : b->sends_) visit(s->target.get());
+        order.push_back(b);   // after all of its destinations
+    };
+    for (auto& b : buses_) visit(b.get());
+    visit(master_.get());
+    std::reverse(order.begin(), order.end());
+
+    std::unordered_map<const AudioBus*, int> index;
+    for (int i = 0; i < (int)order.size(); i++) index[order[i]] = i;
+
+    topo->steps.resize(order.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        AudioBus* b = order[i];
+        Step& step = topo->steps[i];
+        step.bus = b;
+        for (auto& n : b->effects_) {
+            step.effects.push_back(n.get());
+            topo->keep.push_back(n);
+        }
+        if (b != master_.get()) {
+            step.output = index[b->output_ ? b->output_.get() : master_.get()];
+        }
+        for (auto& s : b->sends_) {
+            step.sends.emplace_back(index[s->target.get()], &s->level);
+            topo->keep.push_back(s);
+        }
+    }
+    topo->keep.push_back(master_);
+    for (auto& b : buses_) topo->keep.push_back(b);
+
+    // A previous order the audio thread never picked up can go right away.
+    delete pending_.exchange(topo, std::memory_order_acq_rel);
+    collectGarbage();
+}
+
+void AudioGraph::collectGarbage() {
+    delete garbage_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+bool AudioGraph::beginBlock(int channels) {
+    // Adopt a new order only once the previous retired one was collected,
+    // so the audio thread never has to free anything itself.
+    if (pending_.load(std::memory_order_acquire) && !garbage_.load(std::memory_order_acquire)) {
+        if (Topology* next = pending_.exchange(nullptr, std::memory_order_acq_rel)) {
+            if (current_) {
+                for (auto& s : current_->steps) s.bus->live_ = false;
+            }
+            garbage_.store(current_, std::memory_order_release);
+            current_ = next;
+            for (auto& s : current_->steps) s.bus->live_ = true;
+        }
+    }
+    if (!current_ || channels > MAX_CHANNELS) return false;
+    if (current_->steps.size() > 1) return true;
+    const Step& master = current_->steps.back();
+    const AudioBus& m = *master.bus;
+    return !master.effects.empty()
+        || m.gain_.load(std::memory_order_relaxed) != 1.0f
+        || m.pan_.load(std::memory_order_relaxed) != 0.0f
+        || m.mute_.load(std::memory_order_relaxed);
+}
+
+void AudioGraph::clear(int frames, int channels) {
+    const size_t bytes = (size_t)frames * channels * sizeof(float);
+    for (auto& s : current_->steps) std::memset(s.bus->buffer_.data(), 0, bytes);
+}
+
+float* AudioGraph::getBusBuffer(const AudioBus* bus) {
+    if (bus && bus->live_) return const_cast<AudioBus*>(bus)->buffer_.data();
+    return current_->steps.back().bus->buffer_.data();
+}
+
+void AudioGraph::process(float* out, int frames, int channels) {
+    const size_t n = (size_t)frames * channels;
+    auto& steps = current_->steps;
+    for (auto& step : steps) {
+        AudioBus& bus = *step.bus;
+        float* buf = bus.buffer_.data();
+
+        for (AudioNode* node : step.effects) {
+            if (!node->isBypassed()) node->process(buf, frames, channels);
+        }
+
+        const float gain = bus.mute_.load(std::memory_order_relaxed)
+                         ? 0.0f : bus.gain_.load(std::memory_order_relaxed);
+        const float pan = channels >= 2 ? bus.pan_.load(std::memory_order_relaxed) : 0.0f;
+        if (gain != 1.0f || pan != 0.0f) {
+            float gains[MAX_CHANNELS];
+            for (int c = 0; c < channels; c++) gains[c] = gain;
+            if (pan < 0.0f) gains[1] *= 1.0f + pan;
+            if (pan > 0.0f) gains[0] *= 1.0f - pan;
+            audiograph::applyChannelGains(buf, frames, channels, gains);
+        }
+        bus.peak_.store(audiograph::peak(buf, n), std::memory_order_relaxed);
+
+        for (auto& [target, level] : step.sends) {
+            const float l = level->load(std::memory_order_relaxed);
+            if (l != 0.0f) audiograph::accumulate(steps[target].bus->buffer_.data(), buf, n, l);
+        }
+        if (step.output >= 0) {
+            audiograph::accumulate(steps[step.output].bus->buffer_.data(), buf, n, 1.0f);
+        } else {
+            std::memcpy(out, buf, n * sizeof(float));
+        }
+    }
+}
+
+} // namespace trussc
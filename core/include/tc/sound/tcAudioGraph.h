@@ -0,0 +1,510 @@
+#pragma once
+
+// =============================================================================
+// tcAudioGraph.h - buses, sends and effect nodes processed on the audio thread
+// =============================================================================
+//
+// The engine mixes every voice into a bus (Sound::setBus(); default = the
+// master bus), runs each bus's insert effects, applies its gain / pan and
+// sends, and sums it into its output bus. The master bus feeds the device.
+//
+//   auto& graph = tc::AudioEngine::getInstance().getGraph();
+//   auto sfx    = graph.createBus("sfx");
+//   auto reverb = graph.createBus("reverb");
+//   reverb->addEffect(std::make_shared<tc::Reverb>());
+//   sfx->addEffect(std::make_shared<tc::BiquadFilter>(tc::BiquadFilter::Type::HighPass, 120.0f));
+//   sfx->setSend(reverb, 0.3f);
+//   graph.getMaster()->addEffect(std::make_shared<tc::Limiter>());
+//   footstep.setBus(sfx);
+//
+// Threading:
+//   - Parameters (gains, send levels, filter frequencies, ...) are atomics;
+//     set them from any thread. The audio thread picks them up at the next
+//     block and recomputes coefficients there only when something changed.
+//   - Structural edits (createBus, addEffect, setOutput, setSend to a new
+//     target, ...) rebuild an immutable processing order on the calling
+//     thread and hand it to the audio thread through an atomic pointer.
+//     The audio thread never locks, allocates or frees.
+//   - Routing is a DAG: setOutput() / setSend() refuse edges that would
+//     create a cycle.
+//
+// Processing runs in blocks of up to BLOCK_FRAMES frames; longer device
+// callbacks are split. Node state is allocated by prepare() on the calling
+// thread (when a node is added, and by the engine on init / re-init).
+// When the graph is trivial (master only, no effects, unity gain) the
+// engine skips it entirely.
+//
+// Writing a node: derive from AudioNode, allocate in prepare(), process in
+// place in process(), and call touch() from parameter setters so
+// process() can see consumeChanges().
+//
+// =============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/tcSimd.h"
+
+namespace trussc {
+
+class AudioGraph;
+class AudioBus;
+class AudioEngine;
+
+// ---------------------------------------------------------------------------
+// audiograph — block kernels shared by buses and nodes (interleaved buffers)
+// ---------------------------------------------------------------------------
+namespace audiograph {
+
+// out[i] += in[i] * gain for n samples.
+inline void accumulate(float* out, const float* in, size_t n, float gain) {
+    namespace simd = internal::simd;
+    size_t i = 0;
+    const auto g = simd::set1(gain);
+    for (; i + 4 <= n; i += 4) {
+        simd::store(out + i, simd::madd(simd::load(out + i), simd::load(in + i), g));
+    }
+    for (; i < n; i++) out[i] += in[i] * gain;
+}
+
+// Scale each channel of an interleaved block by gains[c].
+inline void applyChannelGains(float* buffer, int frames, int channels, const float* gains) {
+    namespace simd = internal::simd;
+    const size_t n = (size_t)frames * channels;
+    size_t i = 0;
+    if (channels == 1 || channels == 2 || channels == 4) {
+        // The gain pattern repeats every 4 samples.
+        float pattern[4];
+        for (int k = 0; k < 4; k++) pattern[k] = gains[k % channels];
+        const auto g = simd::load(pattern);
+        for (; i + 4 <= n; i += 4) simd::store(buffer + i, simd::mul(simd::load(buffer + i), g));
+    }
+    for (; i < n; i++) buffer[i] *= gains[i % (size_t)channels];
+}
+
+// Peak absolute sample.
+inline float peak(const float* buffer, size_t n) {
+    namespace simd = internal::simd;
+    size_t i = 0;
+    auto m = simd::zero();
+    for (; i + 4 <= n; i += 4) {
+        const auto v = simd::load(buffer + i);
+        m = simd::max(m, simd::max(v, simd::sub(simd::zero(), v)));
+    }
+    float lanes[4];
+    simd::store(lanes, m);
+    float p = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; i < n; i++) p = std::max(p, buffer[i] < 0.0f ? -buffer[i] : buffer[i]);
+    return p;
+}
+
+} // namespace audiograph
+
+// ---------------------------------------------------------------------------
+// AudioNode — base for insert effects
+// ---------------------------------------------------------------------------
+class AudioNode {
+public:
+    static constexpr int MAX_CHANNELS = 8;
+
+    virtual ~AudioNode() = default;
+
+    // Bypassed nodes pass audio through untouched (state is kept).
+    void setBypass(bool bypass) { bypass_.store(bypass, std::memory_order_relaxed); }
+    bool isBypassed() const { return bypass_.load(std::memory_order_relaxed); }
+
+    // Allocate / size state for a rate and channel count. Called off the
+    // audio thread, before the node is live or with the device stopped.
+    virtual void prepare(int sampleRate, int channels) = 0;
+
+    // Process `frames` interleaved frames in place. Audio thread; must not
+    // allocate, lock or free. frames <= AudioGraph::BLOCK_FRAMES.
+    virtual void process(float* buffer, int frames, int channels) = 0;
+
+protected:
+    // Parameter setters call touch(); process() calls consumeChanges() once
+    // per block and refreshes derived values when it returns true.
+    void touch() { version_.fetch_add(1, std::memory_order_release); }
+    bool consumeChanges() {
+        const uint32_t v = version_.load(std::memory_order_acquire);
+        if (v == seen_) return false;
+        seen_ = v;
+        return true;
+    }
+
+    int sampleRate_ = 48000;
+    int channels_ = 2;
+
+private:
+    std::atomic<bool> bypass_{false};
+    std::atomic<uint32_t> version_{1};
+    uint32_t seen_ = 0;           // audio thread
+
+    // Under AudioGraph's mutex. prepare() is skipped when the node is
+    // already sized for the graph, so a node moved between buses keeps its
+    // state and is never resized under the audio thread.
+    friend class AudioGraph;
+    friend class AudioBus;
+    AudioBus* owner_ = nullptr;
+    int preparedRate_ = 0;
+    int preparedChannels_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// BiquadFilter — RBJ cookbook second-order section (transposed direct form
+// II), one state per channel. Gain is used by Peak / LowShelf / HighShelf.
+// ---------------------------------------------------------------------------
+class BiquadFilter : public AudioNode {
+public:
+    enum class Type { LowPass, HighPass, BandPass, Notch, Peak, LowShelf, HighShelf, AllPass };
+
+    explicit BiquadFilter(Type type = Type::LowPass, float frequency = 1000.0f,
+                          float q = 0.7071f, float gainDb = 0.0f);
+
+    void setType(Type type)       { type_.store((int)type, std::memory_order_relaxed); touch(); }
+    void setFrequency(float hz)   { frequency_.store(hz, std::memory_order_relaxed); touch(); }
+    void setQ(float q)            { q_.store(q, std::memory_order_relaxed); touch(); }
+    void setGain(float gainDb)    { gainDb_.store(gainDb, std::memory_order_relaxed); touch(); }
+    Type  getType() const         { return (Type)type_.load(std::memory_order_relaxed); }
+    float getFrequency() const    { return frequency_.load(std::memory_order_relaxed); }
+    float getQ() const            { return q_.load(std::memory_order_relaxed); }
+    float getGain() const         { return gainDb_.load(std::memory_order_relaxed); }
+
+    // Magnitude response (linear) at `hz` for the current parameters, e.g.
+    // for drawing an EQ curve.
+    float getResponse(float hz) const;
+
+    void prepare(int sampleRate, int channels) override;
+    void process(float* buffer, int frames, int channels) override;
+
+    // b0 b1 b2 a1 a2 (a0 normalized to 1).
+    static void computeCoefficients(Type type, float frequency, float q, float gainDb,
+                                    int sampleRate, float out[5]);
+
+private:
+    std::atomic<int>   type_;
+    std::atomic<float> frequency_;
+    std::atomic<float> q_;
+    std::atomic<float> gainDb_;
+
+    float c_[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    float z1_[MAX_CHANNELS] = {};
+    float z2_[MAX_CHANNELS] = {};
+};
+
+// ---------------------------------------------------------------------------
+// SvfFilter — topology-preserving state-variable filter. Stays stable and
+// click-free under fast cutoff modulation (LFOs, envelopes), where a
+// biquad's coefficients would jump.
+// ---------------------------------------------------------------------------
+class SvfFilter : public AudioNode {
+public:
+    enum class Type { LowPass, HighPass, BandPass, Notch, Peak };
+
+    explicit SvfFilter(Type type = Type::LowPass, float cutoff = 1000.0f, float q = 0.7071f);
+
+    void setType(Type type)     { type_.store((int)type, std::memory_order_relaxed); touch(); }
+    void setCutoff(float hz)    { cutoff_.store(hz, std::memory_order_relaxed); touch(); }
+    void setQ(float q)          { q_.store(q, std::memory_order_relaxed); touch(); }
+    Type  getType() const       { return (Type)type_.load(std::memory_order_relaxed); }
+    float getCutoff() const     { return cutoff_.load(std::memory_order_relaxed); }
+    float getQ() const          { return q_.load(std::memory_order_relaxed); }
+
+    void prepare(int sampleRate, int channels) override;
+    void process(float* buffer, int frames, int channels) override;
+
+private:
+    std::atomic<int>   type_;
+    std::atomic<float> cutoff_;
+    std::atomic<float> q_;
+
+    float a1_ = 1.0f, a2_ = 0.0f, a3_ = 0.0f, k_ = 1.0f;
+    float ic1_[MAX_CHANNELS] = {};
+    float ic2_[MAX_CHANNELS] = {};
+};
+
+// ---------------------------------------------------------------------------
+// Delay — feedback delay with a wet/dry mix. The line is allocated for
+// `maxSeconds` up front; time changes glide over one block (no clicks).
+// ---------------------------------------------------------------------------
+class Delay : public AudioNode {
+public:
+    explicit Delay(float seconds = 0.25f, float feedback = 0.35f, float mix = 0.3f,
+                   float maxSeconds = 2.0f);
+
+    void setTime(float seconds)    { time_.store(seconds, std::memory_order_relaxed); }
+    void setFeedback(float amount) { feedback_.store(amount, std::memory_order_relaxed); }
+    void setMix(float wet)         { mix_.store(wet, std::memory_order_relaxed); }
+    float getTime() const          { return time_.load(std::memory_order_relaxed); }
+    float getFeedback() const      { return feedback_.load(std::memory_order_relaxed); }
+    float getMix() const           { return mix_.load(std::memory_order_relaxed); }
+    float getMaxTime() const       { return maxSeconds_; }
+
+    void prepare(int sampleRate, int channels) override;
+    void process(float* buffer, int frames, int channels) override;
+
+private:
+    std::atomic<float> time_;
+    std::atomic<float> feedback_;
+    std::atomic<float> mix_;
+    float maxSeconds_;
+
+    std::vector<float> line_;      // interleaved, size = capacity * channels
+    size_t capacity_ = 0;          // frames, power of two
+    size_t write_ = 0;
+    float  current_ = -1.0f;       // delay in frames actually in use
+};
+
+// ---------------------------------------------------------------------------
+// Reverb — algorithmic (Schroeder / Moorer, "Freeverb" tuning): 8 damped
+// comb filters and 4 allpasses per side, no convolution. Stereo in/out;
+// a mono bus uses the left side, channels beyond 2 pass through.
+// ---------------------------------------------------------------------------
+class Reverb : public AudioNode {
+public:
+    explicit Reverb(float roomSize = 0.6f, float damping = 0.5f,
+                    float wet = 0.3f, float dry = 1.0f, float width = 1.0f);
+
+    void setRoomSize(float v) { roomSize_.store(v, std::memory_order_relaxed); touch(); }
+    void setDamping(float v)  { damping_.store(v, std::memory_order_relaxed); touch(); }
+    void setWet(float v)      { wet_.store(v, std::memory_order_relaxed); touch(); }
+    void setDry(float v)      { dry_.store(v, std::memory_order_relaxed); touch(); }
+    void setWidth(float v)    { width_.store(v, std::memory_order_relaxed); touch(); }
+    float getRoomSize() const { return roomSize_.load(std::memory_order_relaxed); }
+    float getDamping() const  { return damping_.load(std::memory_order_relaxed); }
+    float getWet() const      { return wet_.load(std::memory_order_relaxed); }
+    float getDry() const      { return dry_.load(std::memory_order_relaxed); }
+    float getWidth() const    { return width_.load(std::memory_order_relaxed); }
+
+    void prepare(int sampleRate, int channels) override;
+    void process(float* buffer, int frames, int channels) override;
+
+private:
+    static constexpr int COMBS = 8;
+    static constexpr int ALLPASSES = 4;
+
+    struct Comb {
+        std::vector<float> buf;
+        size_t pos = 0;
+        float store = 0.0f;
+    };
+    struct Allpass {
+        std::vector<float> buf;
+        size_t pos = 0;
+    };
+
+    std::atomic<float> roomSize_, damping_, wet_, dry_, width_;
+
+    Comb    comb_[2][COMBS];
+    Allpass allpass_[2][ALLPASSES];
+    float feedback_ = 0.84f, damp_ = 0.2f;
+    float wet1_ = 0.0f, wet2_ = 0.0f, dryGain_ = 1.0f;
+};
+
+// ---------------------------------------------------------------------------
+// Compressor — feed-forward, stereo-linked peak compressor with a soft knee
+// and make-up gain. getGainReduction() is a meter (dB, >= 0).
+// ---------------------------------------------------------------------------
+class Compressor : public AudioNode {
+public:
+    explicit Compressor(float thresholdDb = -18.0f, float ratio = 4.0f,
+                        float attackMs = 10.0f, float releaseMs = 120.0f,
+                        float kneeDb = 6.0f, float makeupDb = 0.0f);
+
+    void setThreshold(float db)   { thresholdDb_.store(db, std::memory_order_relaxed); touch(); }
+    void setRatio(float ratio)    { ratio_.store(ratio, std::memory_order_relaxed); touch(); }
+    void setAttack(float ms)      { attackMs_.store(ms, std::memory_order_relaxed); touch(); }
+    void setRelease(float ms)     { releaseMs_.store(ms, std::memory_order_relaxed); touch(); }
+    void setKnee(float db)        { kneeDb_.store(db, std::memory_order_relaxed); touch(); }
+    void setMakeup(float db)      { makeupDb_.store(db, std::memory_order_relaxed); touch(); }
+    float getThreshold() const    { return thresholdDb_.load(std::memory_order_relaxed); }
+    float getRatio() const        { return ratio_.load(std::memory_order_relaxed); }
+    float getAttack() const       { return attackMs_.load(std::memory_order_relaxed); }
+    float getRelease() const      { return releaseMs_.load(std::memory_order_relaxed); }
+    float getKnee() const         { return kneeDb_.load(std::memory_order_relaxed); }
+    float getMakeup() const       { return makeupDb_.load(std::memory_order_relaxed); }
+
+    float getGainReduction() const { return reductionDb_.load(std::memory_order_relaxed); }
+
+    void prepare(int sampleRate, int channels) override;
+    void process(float* buffer, int frames, int channels) override;
+
+protected:
+    // Limiter: output is additionally clamped to the threshold.
+    bool hardCeiling_ = false;
+
+private:
+    std::atomic<float> thresholdDb_, ratio_, attackMs_, releaseMs_, kneeDb_, makeupDb_;
+    std::atomic<float> reductionDb_{0.0f};
+
+    float attackCoef_ = 0.0f, releaseCoef_ = 0.0f;
+    float slope_ = 0.75f, makeup_ = 1.0f, ceiling_ = 1.0f;
+    float envelopeDb_ = 0.0f;      // smoothed gain reduction, dB
+};
+
+// ---------------------------------------------------------------------------
+// Limiter — Compressor preset: infinite ratio, fast attack, and a hard
+// ceiling at the threshold so nothing above it reaches the output.
+// ---------------------------------------------------------------------------
+class Limiter : public Compressor {
+public:
+    explicit Limiter(float ceilingDb = -1.0f, float releaseMs = 60.0f)
+        : Compressor(ceilingDb, 1000.0f, 0.5f, releaseMs, 0.0f, 0.0f) {
+        hardCeiling_ = true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// AudioBus — a mix point: insert effects, then gain / pan, then post-fader
+// sends, then summed into the output bus. Create through AudioGraph.
+// ---------------------------------------------------------------------------
+class AudioBus {
+public:
+    const std::string& getName() const { return name_; }
+
+    void setGain(float gain) { gain_.store(gain, std::memory_order_relaxed); }
+    float getGain() const    { return gain_.load(std::memory_order_relaxed); }
+    // -1 (left) .. 1 (right) balance on channels 0 / 1.
+    void setPan(float pan)   { pan_.store(pan, std::memory_order_relaxed); }
+    float getPan() const     { return pan_.load(std::memory_order_relaxed); }
+    void setMute(bool mute)  { mute_.store(mute, std::memory_order_relaxed); }
+    bool isMuted() const     { return mute_.load(std::memory_order_relaxed); }
+
+    // Peak of the last processed block, post-fader (a level meter).
+    float getPeak() const    { return peak_.load(std::memory_order_relaxed); }
+
+    // Insert chain, processed in order. A node belongs to one bus at a time;
+    // addEffect() returns false if it is already in use.
+    bool addEffect(std::shared_ptr<AudioNode> node);
+    bool removeEffect(const std::shared_ptr<AudioNode>& node);
+    void clearEffects();
+    std::vector<std::shared_ptr<AudioNode>> getEffects() const;
+
+    // Destination of this bus (default: master; nullptr = master). Returns
+    // false for the master bus itself or if the edge would form a cycle.
+    bool setOutput(std::shared_ptr<AudioBus> bus);
+    std::shared_ptr<AudioBus> getOutput() const;
+
+    // Post-fader send to `target` at `level`; level 0 removes the send.
+    // Changing the level of an existing send is a plain atomic store.
+    // Returns false if the send would form a cycle.
+    bool setSend(const std::shared_ptr<AudioBus>& target, float level);
+    float getSend(const std::shared_ptr<AudioBus>& target) const;
+
+    AudioBus(const AudioBus&) = delete;
+    AudioBus& operator=(const AudioBus&) = delete;
+
+private:
+    friend class AudioGraph;
+    friend class AudioEngine;
+
+    struct Send {
+        std::shared_ptr<AudioBus> target;
+        std::atomic<float> level{0.0f};
+    };
+
+    AudioBus(AudioGraph& graph, std::string name);
+
+    AudioGraph& graph_;
+    std::string name_;
+    std::atomic<float> gain_{1.0f};
+    std::atomic<float> pan_{0.0f};
+    std::atomic<bool>  mute_{false};
+    std::atomic<float> peak_{0.0f};
+
+    // Structure, under the graph's mutex.
+    std::vector<std::shared_ptr<AudioNode>> effects_;
+    std::shared_ptr<AudioBus> output_;
+    std::vector<std::shared_ptr<Send>> sends_;
+    bool removed_ = false;
+
+    // Audio thread: mix buffer (BLOCK_FRAMES x MAX_CHANNELS) and whether
+    // the current processing order contains this bus.
+    std::vector<float> buffer_;
+    bool live_ = false;
+};
+
+// ---------------------------------------------------------------------------
+// AudioGraph — owns the buses; the engine processes it every block.
+// ---------------------------------------------------------------------------
+class AudioGraph {
+public:
+    static constexpr int BLOCK_FRAMES = 256;
+    static constexpr int MAX_CHANNELS = AudioNode::MAX_CHANNELS;
+
+    AudioGraph();
+    ~AudioGraph();
+
+    AudioGraph(const AudioGraph&) = delete;
+    AudioGraph& operator=(const AudioGraph&) = delete;
+
+    std::shared_ptr<AudioBus> getMaster() const { return master_; }
+
+    // New bus routed to master. Names are labels (duplicates allowed).
+    std::shared_ptr<AudioBus> createBus(const std::string& name);
+    // Detach a bus: buses and sends that fed it are dropped / re-routed to
+    // master, voices still set to it play through master.
+    void removeBus(const std::shared_ptr<AudioBus>& bus);
+    std::shared_ptr<AudioBus> findBus(const std::string& name) const;
+    std::vector<std::shared_ptr<AudioBus>> getBuses() const;
+
+    // ---- engine side -------------------------------------------------------
+
+    // Size every node and bus for the device. Not on the audio thread, and
+    // not while it runs.
+    void prepare(int sampleRate, int channels);
+
+    // Audio thread, once per callback: adopt a newly published processing
+    // order. Returns false when the graph is a no-op (master only, no
+    // effects, unity gain, centered, unmuted) so the caller can mix
+    // straight into the device buffer.
+    bool beginBlock(int channels);
+
+    // Audio thread, per sub-block of <= BLOCK_FRAMES frames:
+    // clear() zeroes the bus buffers, getBusBuffer() is where a voice
+    // routed to `bus` mixes (master if null or not live), process() runs
+    // the buses and writes the master into `out`.
+    void clear(int frames, int channels);
+    float* getBusBuffer(const AudioBus* bus);
+    void process(float* out, int frames, int channels);
+
+    // Free processing orders the audio thread has let go of.
+    void collectGarbage();
+
+private:
+    friend class AudioBus;
+
+    struct Step {
+        AudioBus* bus = nullptr;
+        std::vector<AudioNode*> effects;
+        int output = -1;                                       // step index; -1 = device
+        std::vector<std::pair<int, const std::atomic<float>*>> sends;   // step index, level
+    };
+    struct Topology {
+        std::vector<Step> steps;                               // sources first, master last
+        std::vector<std::shared_ptr<const void>> keep;         // buses, nodes, sends
+    };
+
+    // Caller holds mutex_.
+    void prepareNodeLocked(AudioNode& node);
+    void publishLocked();
+    bool reachesLocked(const AudioBus* from, const AudioBus* to) const;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<AudioBus> master_;
+    std::vector<std::shared_ptr<AudioBus>> buses_;   // excluding master
+    int sampleRate_ = 48000;
+    int channels_ = 2;
+
+    std::atomic<Topology*> pending_{nullptr};
+    std::atomic<Topology*> garbage_{nullptr};
+    Topology* current_ = nullptr;                     // audio thread
+};
+
+} // namespace trussc
@@ -1,19 +1,26 @@
 #pragma once
 
 // =============================================================================
-// tcAudioRecorder.h - Record the engine's master output to a WAV file
+// tcAudioRecorder.h - Record the engine's master output to a WAV / FLAC file
 //
 // Taps AudioEngine::audioOut at priority::Monitor, so it runs AFTER every
 // generator / effect listener and captures the same mix the speakers get.
 // The audio-thread listener only copies samples into a lock-free ring
-// buffer; a background thread drains the ring, applies the channel map and
-// writes the file — no allocation, locking or IO ever happens on the audio
-// thread.
+// buffer; a background thread drains the ring, applies the channel map,
+// encodes and writes the file — no allocation, locking or IO ever happens on
+// the audio thread.
 //
 //   AudioRecorder rec;
 //   rec.start("take.wav");           // record the master mix
 //   ...
-//   rec.stop();                      // finalize (patches the WAV header)
+//   rec.stop();                      // finalize (patches the header)
+//
+// The writer sleeps on a semaphore until the ring holds ~1/4 s of audio (the
+// listener posts it once per fill, not per callback) or stop() asks for the
+// final sweep, so stop() returns as soon as the tail is on disk. Output goes
+// through BlockFileWriter: 1 MiB aligned writes into space reserved ahead of time.
+// Codec::Flac encodes losslessly on the writer thread for long multichannel
+// show recordings.
 //
 // The engine keeps playing as usual; recording is a pure observer.
 // =============================================================================
@@ -23,11 +30,13 @@
 #include <cmath>
 #include <cstdint>
 #include <cstring>
-#include <fstream>
+#include <semaphore>
 #include <thread>
 #include <vector>
 
 #include "tcSound.h"
+#include "tcFlacEncoder.h"
+#include "../utils/tcBlockFileWriter.h"
 #include "../utils/tcLog.h"
 #include "../utils/tcUtils.h"
 
@@ -43,6 +52,14 @@ struct AudioRecordSettings {
     };
     SampleFormat format = SampleFormat::S16;
 
+    enum class Codec {
+        Wav,    // uncompressed RIFF/WAVE (default)
+        Flac,   // lossless FLAC, typically about half the size of the WAV.
+                // S16 -> 16-bit, F32 -> 24-bit (FLAC stores integers, so
+                // anything beyond full scale is clipped).
+    };
+    Codec codec = Codec::Wav;
+
     // Channel routing, same structure and semantics as Sound::setChannelMap():
     // outer index = OUTPUT (file) channel, inner list = ENGINE channels summed
     // into it — out[c] = sum of mix[s] for s in channelMap[c]. Sums are NOT
@@ -65,9 +82,10 @@ public:
     AudioRecorder(const AudioRecorder&) = delete;
     AudioRecorder& operator=(const AudioRecorder&) = delete;
 
-    // Start recording the master mix into `path` (WAV). The audio engine must
-    // already be initialized (playing a Sound or calling AudioEngine::init()
-    // does that); returns false otherwise, or when the file can't be opened.
+    // Start recording the master mix into `path` (WAV, or FLAC with
+    // settings.codec = Codec::Flac). The audio engine must already be
+    // initialized (playing a Sound or calling AudioEngine::init() does that);
+    // returns false otherwise, or when the file can't be opened.
     bool start(const fs::path& path, const AudioRecordSettings& settings = {}) {
         if (isRecording()) {
             logWarning("AudioRecorder") << "start: already recording";
@@ -95,8 +113,15 @@ public:
             std::error_code ec;
             fs::create_directories(resolved.parent_path(), ec);
         }
-        file_.open(resolved, std::ios::binary | std::ios::trunc);
-        if (!file_) {
+        if (isFlac() && !flac_.setup(sampleRate_, outChannels_, isFloat() ? 24 : 16)) {
+            logWarning("AudioRecorder") << "start: FLAC supports 1-8 channels, got "
+                                        << outChannels_;
+            return false;
+        }
+        // Reserve disk ~30 s of uncompressed output ahead of the writes.
+        const uint64_t bytesPerSecond = (uint64_t)sampleRate_ * outChannels_ * bytesPerSample();
+        if (!file_.open(resolved, 1 << 20,
+                        std::clamp<uint64_t>(bytesPerSecond * 30, 16ull << 20, 256ull << 20))) {
             logError("AudioRecorder") << "start: cannot open " << resolved.string();
             return false;
         }
@@ -105,14 +130,25 @@ public:
 
         // Ring sized for ~4 seconds of engine output: overflow only happens if
         // the writer thread stalls that long, in which case frames are counted
-        // into droppedFrames_ instead of blocking the audio thread.
+        // into droppedFrames_ instead of blocking the audio thread. The writer
+        // is woken every 1/16 of it (~1/4 s).
         ringCap_ = (size_t)1 << (size_t)std::ceil(
             std::log2((double)sampleRate_ * srcChannels_ * 4.0));
         ring_.assign(ringCap_, 0.0f);
+        wakeThreshold_ = ringCap_ / 16;
         head_.store(0, std::memory_order_relaxed);
         tail_.store(0, std::memory_order_relaxed);
         droppedFrames_.store(0, std::memory_order_relaxed);
         framesWritten_.store(0, std::memory_order_relaxed);
+        wakePending_.store(false, std::memory_order_relaxed);
+        while (wake_.try_acquire()) {}
+
+        // Writer-side buffers, sized once so the writer never allocates either.
+        chunk_.assign(CHUNK_FRAMES * (size_t)srcChannels_, 0.0f);
+        mapped_.assign(CHUNK_FRAMES * (size_t)outChannels_, 0.0f);
+        pcm_.assign(CHUNK_FRAMES * (size_t)outChannels_ * sizeof(float), 0);
+        if (isFlac()) flacBlock_.assign((size_t)flac_.getBlockSize() * outChannels_, 0);
+        flacFill_ = 0;
 
         running_.store(true, std::memory_order_release);
         writer_ = std::thread([this] { writerLoop(); });
@@ -124,7 +160,8 @@ public:
 
         logNotice("AudioRecorder") << "recording -> " << path_.string()
             << " (" << sampleRate_ << " Hz, " << outChannels_ << "ch, "
-            << (settings_.format == AudioRecordSettings::SampleFormat::S16 ? "s16" : "f32")
+            << (isFlac() ? (isFloat() ? "flac 24-bit" : "flac 16-bit")
+                         : (isFloat() ? "f32" : "s16"))
             << ")";
         return true;
     }
@@ -133,9 +170,12 @@ public:
     void stop() {
         if (!running_.exchange(false, std::memory_order_acq_rel)) return;
         listener_ = EventListener();   // unsubscribe (audio thread stops feeding)
+        wakeWriter();                  // final sweep now, not at the next timeout
         if (writer_.joinable()) writer_.join();
         patchHeader();
-        file_.close();
+        if (!file_.close()) {
+            logError("AudioRecorder") << "write failed (disk full?): " << path_.string();
+        }
         uint64_t dropped = droppedFrames_.load(std::memory_order_relaxed);
         if (dropped > 0) {
             logWarning("AudioRecorder") << "stopped, " << dropped
@@ -183,18 +223,30 @@ private:
         std::memcpy(ring_.data() + at, b.data, first * sizeof(float));
         if (n > first) std::memcpy(ring_.data(), b.data + first, (n - first) * sizeof(float));
         head_.store(head + n, std::memory_order_release);
+        if ((size_t)(head + n - tail) >= wakeThreshold_) wakeWriter();
+    }
+
+    // Post the writer's semaphore at most once per wake-up: wakePending_ goes
+    // true here and back to false only after the writer has taken the post,
+    // so the binary semaphore is never released twice. Lock-free (a futex /
+    // ulock wake at worst), so fine on the audio thread.
+    void wakeWriter() {
+        if (!wakePending_.exchange(true, std::memory_order_acq_rel)) wake_.release();
     }
 
     // --- writer thread side --------------------------------------------------
     void writerLoop() {
-        std::vector<float> chunk;      // interleaved engine-format samples
-        std::vector<float> mapped;     // interleaved file-format samples
-        std::vector<int16_t> s16;
-        while (running_.load(std::memory_order_acquire) || pending() > 0) {
-            drain(chunk, mapped, s16);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (;;) {
+            const bool stopping = !running_.load(std::memory_order_acquire);
+            // The timeout only matters when the device stops delivering
+            // mid-fill: whatever is buffered still reaches the file.
+            if (!stopping && wake_.try_acquire_for(std::chrono::milliseconds(250))) {
+                wakePending_.store(false, std::memory_order_release);
+            }
+            drain();
+            if (stopping) break;       // listener detached: that was the last sweep
         }
-        drain(chunk, mapped, s16);     // final sweep after the listener detached
+        if (isFlac() && flacFill_ > 0) encodeFlacBlock();   // short final block
     }
 
     size_t pending() const {
@@ -202,44 +254,73 @@ private:
                         - tail_.load(std::memory_order_relaxed));
     }
 
-    void drain(std::vector<float>& chunk, std::vector<float>& mapped,
-               std::vector<int16_t>& s16) {
-        size_t n = pending();
-        n -= n % (size_t)srcChannels_;   // whole frames only
-        if (n == 0) return;
-        chunk.resize(n);
-        const uint64_t tail = tail_.load(std::memory_order_relaxed);
-        const size_t at = (size_t)(tail & (ringCap_ - 1));
-        const size_t first = std::min(n, ringCap_ - at);
-        std::memcpy(chunk.data(), ring_.data() + at, first * sizeof(float));
-        if (n > first) std::memcpy(chunk.data() + first, ring_.data(), (n - first) * sizeof(float));
-        tail_.store(tail + n, std::memory_order_release);
-
-        const size_t frames = n / srcChannels_;
-        mapChannels(chunk.data(), frames, mapped);
-
-        if (settings_.format == AudioRecordSettings::SampleFormat::S16) {
-            s16.resize(mapped.size());
-            for (size_t i = 0; i < mapped.size(); i++) {
-                float v = std::clamp(mapped[i], -1.0f, 1.0f);
-                s16[i] = (int16_t)std::lrintf(v * 32767.0f);
+    // Everything in the ring, CHUNK_FRAMES at a time.
+    void drain() {
+        for (;;) {
+            size_t n = std::min(pending(), CHUNK_FRAMES * (size_t)srcChannels_);
+            n -= n % (size_t)srcChannels_;   // whole frames only
+            if (n == 0) return;
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t at = (size_t)(tail & (ringCap_ - 1));
+            const size_t first = std::min(n, ringCap_ - at);
+            std::memcpy(chunk_.data(), ring_.data() + at, first * sizeof(float));
+            if (n > first) std::memcpy(chunk_.data() + first, ring_.data(), (n - first) * sizeof(float));
+            tail_.store(tail + n, std::memory_order_release);
+
+            const size_t frames = n / srcChannels_;
+            mapChannels(chunk_.data(), frames, mapped_.data());
+            const size_t count = frames * outChannels_;
+
+            if (isFlac()) {
+                writeFlac(mapped_.data(), frames);
+                continue;                    // framesWritten_ counts encoded blocks
+            }
+            if (isFloat()) {
+                file_.write(mapped_.data(), count * sizeof(float));
+            } else {
+                auto* s16 = reinterpret_cast<int16_t*>(pcm_.data());
+                for (size_t i = 0; i < count; i++) {
+                    float v = std::clamp(mapped_[i], -1.0f, 1.0f);
+                    s16[i] = (int16_t)std::lrintf(v * 32767.0f);
+                }
+                file_.write(s16, count * sizeof(int16_t));
+            }
+            framesWritten_.fetch_add((uint64_t)frames, std::memory_order_relaxed);
+        }
+    }
+
+    // Quantize into the current FLAC block; encode each block as it fills.
+    void writeFlac(const float* src, size_t frames) {
+        const float scale = isFloat() ? 8388607.0f : 32767.0f;
+        const size_t block = (size_t)flac_.getBlockSize();
+        while (frames > 0) {
+            const size_t take = std::min(frames, block - flacFill_);
+            int32_t* dst = flacBlock_.data() + flacFill_ * outChannels_;
+            for (size_t i = 0; i < take * outChannels_; i++) {
+                dst[i] = (int32_t)std::lrintf(std::clamp(src[i], -1.0f, 1.0f) * scale);
             }
-            file_.write((const char*)s16.data(), (std::streamsize)(s16.size() * sizeof(int16_t)));
-        } else {
-            file_.write((const char*)mapped.data(), (std::streamsize)(mapped.size() * sizeof(float)));
+            flacFill_ += take;
+            src += take * outChannels_;
+            frames -= take;
+            if (flacFill_ == block) encodeFlacBlock();
         }
-        framesWritten_.fetch_add((uint64_t)frames, std::memory_order_relaxed);
+    }
+
+    void encodeFlacBlock() {
+        const size_t bytes = flac_.encode(flacBlock_.data(), (int)flacFill_);
+        file_.write(flac_.data(), bytes);
+        framesWritten_.fetch_add((uint64_t)flacFill_, std::memory_order_relaxed);
+        flacFill_ = 0;
     }
 
     // Engine-interleaved -> file-interleaved. Explicit map: out[c] = sum of
     // sources (unnormalized, same as Sound::setChannelMap). Auto: 1:1 for
     // mono/stereo engines, averaged downmix to mono for 3ch+.
-    void mapChannels(const float* src, size_t frames, std::vector<float>& out) {
-        out.assign(frames * outChannels_, 0.0f);
+    void mapChannels(const float* src, size_t frames, float* out) {
         if (!settings_.channelMap.empty()) {
             for (size_t f = 0; f < frames; f++) {
                 const float* in = src + f * srcChannels_;
-                float* o = out.data() + f * outChannels_;
+                float* o = out + f * outChannels_;
                 for (int c = 0; c < outChannels_; c++) {
                     float acc = 0.0f;
                     for (int s : settings_.channelMap[(size_t)c]) {
@@ -249,7 +330,7 @@ private:
                 }
             }
         } else if (srcChannels_ == outChannels_) {
-            std::memcpy(out.data(), src, frames * srcChannels_ * sizeof(float));
+            std::memcpy(out, src, frames * srcChannels_ * sizeof(float));
         } else {   // auto mono downmix (average keeps levels sane by default)
             const float inv = 1.0f / (float)srcChannels_;
             for (size_t f = 0; f < frames; f++) {
@@ -261,43 +342,57 @@ private:
         }
     }
 
-    // --- WAV plumbing --------------------------------------------------------
+    // --- file plumbing -------------------------------------------------------
     bool isFloat() const { return settings_.format == AudioRecordSettings::SampleFormat::F32; }
+    bool isFlac() const { return settings_.codec == AudioRecordSettings::Codec::Flac; }
     int bytesPerSample() const { return isFloat() ? 4 : 2; }
 
     void writeHeader() {
+        if (isFlac()) {
+            // STREAMINFO totals are rewritten in place on stop.
+            file_.write(flac_.getHeader(), FlacEncoder::HEADER_SIZE);
+            return;
+        }
         // RIFF/WAVE with fmt (+ fact for float) and a data chunk whose size is
         // patched on stop. Float files use format tag 3 (IEEE float).
-        auto u32 = [&](uint32_t v) { file_.write((const char*)&v, 4); };
-        auto u16 = [&](uint16_t v) { file_.write((const char*)&v, 2); };
+        auto u32 = [&](uint32_t v) { file_.write(&v, 4); };
+        auto u16 = [&](uint16_t v) { file_.write(&v, 2); };
         const uint16_t tag = isFloat() ? 3 : 1;
         const uint32_t byteRate = (uint32_t)(sampleRate_ * outChannels_ * bytesPerSample());
         file_.write("RIFF", 4); u32(0); file_.write("WAVE", 4);
         file_.write("fmt ", 4); u32(16);
         u16(tag); u16((uint16_t)outChannels_); u32((uint32_t)sampleRate_);
         u32(byteRate); u16((uint16_t)(outChannels_ * bytesPerSample())); u16((uint16_t)(bytesPerSample() * 8));
-        if (isFloat()) { file_.write("fact", 4); u32(4); factPos_ = file_.tellp(); u32(0); }
-        file_.write("data", 4); dataSizePos_ = file_.tellp(); u32(0);
-        dataStart_ = file_.tellp();
+        if (isFloat()) { file_.write("fact", 4); u32(4); factPos_ = file_.tell(); u32(0); }
+        file_.write("data", 4); dataSizePos_ = file_.tell(); u32(0);
+        dataStart_ = file_.tell();
     }
 
     void patchHeader() {
+        if (isFlac()) {
+            file_.writeAt(0, flac_.getHeader(), FlacEncoder::HEADER_SIZE);
+            return;
+        }
+        // RIFF sizes are 32-bit: past 4 GiB they saturate, and most readers
+        // then play the data chunk to end-of-file.
         const uint64_t frames = framesWritten_.load(std::memory_order_relaxed);
-        const uint32_t dataBytes = (uint32_t)(frames * outChannels_ * bytesPerSample());
-        auto patch32 = [&](std::streampos pos, uint32_t v) {
-            file_.seekp(pos); file_.write((const char*)&v, 4);
+        const uint64_t dataBytes = frames * outChannels_ * bytesPerSample();
+        auto patch32 = [&](uint64_t pos, uint64_t v) {
+            const uint32_t clamped = (uint32_t)std::min<uint64_t>(v, 0xFFFFFFFFu);
+            file_.writeAt(pos, &clamped, 4);
         };
         patch32(dataSizePos_, dataBytes);
-        if (isFloat()) patch32(factPos_, (uint32_t)frames);
-        patch32(std::streampos(4), (uint32_t)((uint64_t)dataStart_ - 8 + dataBytes));
-        file_.seekp(0, std::ios::end);
+        if (isFloat()) patch32(factPos_, frames);
+        patch32(4, dataStart_ - 8 + dataBytes);
     }
 
     // --- state ---------------------------------------------------------------
+    static constexpr size_t CHUNK_FRAMES = 4096;   // writer drain granularity
+
     AudioRecordSettings settings_;
-    fs::path      path_;
-    std::ofstream file_;
-    std::streampos dataSizePos_{}, factPos_{}, dataStart_{};
+    fs::path        path_;
+    BlockFileWriter file_;
+    uint64_t        dataSizePos_ = 0, factPos_ = 0, dataStart_ = 0;
     int sampleRate_  = 0;
     int srcChannels_ = 0;
     int outChannels_ = 0;
@@ -308,6 +403,17 @@ private:
     std::atomic<uint64_t> droppedFrames_{0};       // in frames
     std::atomic<uint64_t> framesWritten_{0};       // in frames
     std::atomic<bool>     running_{false};
+    size_t                wakeThreshold_ = 0;      // in floats
+    std::atomic<bool>     wakePending_{false};
+    std::binary_semaphore wake_{0};
+
+    // Writer thread only.
+    std::vector<float>   chunk_;                   // interleaved engine-format samples
+    std::vector<float>   mapped_;                  // interleaved file-format samples
+    std::vector<uint8_t> pcm_;                     // converted samples for the file
+    FlacEncoder          flac_;
+    std::vector<int32_t> flacBlock_;               // one FLAC block being filled
+    size_t               flacFill_ = 0;            // frames in flacBlock_
 
     std::thread   writer_;
     EventListener listener_;
@@ -11,7 +11,8 @@
 // Decoder configuration:
 // - MA_NO_DECODING is intentionally NOT set: ma_decoder (WAV/MP3/FLAC) is used
 //   by tcSound_impl.cpp to decode static asset files
-// - MA_NO_ENCODING: we don't write audio files
+// - MA_NO_ENCODING: nothing writes audio through miniaudio (AudioRecorder
+//   has its own WAV / FLAC writer)
 // - MA_NO_GENERATION: TrussC has its own generators (sine/square/noise/etc)
 //
 // AAC remains platform-specific (AudioToolbox / GStreamer / MediaCodec) for
@@ -25,6 +26,7 @@
 #include "miniaudio.h"
 
 #include "tc/sound/tcSound.h"
+#include "tc/utils/tcMappedFile.h"
 
 #include <algorithm>
 #include <atomic>
@@ -35,6 +37,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace trussc {
@@ -56,33 +59,245 @@ ma_result maDecoderInitPathA(const fs::path& path,
 // =============================================================================
 // Streaming audio playback
 //
-// Each play() of a SoundStream allocates a StreamInstance: an ma_decoder
-// configured to output at engine sample rate + stereo (so the mixer can
-// memcpy + apply vol/pan without resampling), plus a small ring buffer
-// fed by a dedicated worker thread.
+// Each SoundStream owns a StreamBlockCache: one ma_decoder configured to
+// output at engine sample rate + stereo (so the mixer can memcpy + apply
+// vol/pan without resampling), reading the memory-mapped file, and a small
+// LRU of decoded blocks. Each play() allocates a StreamInstance: a ring
+// buffer the StreamWorker pool fills by copying out of the cache. Voices
+// that play the same region of a file (a loop triggered several times, a
+// stem layered at polyphony 4) decode it once.
 //
 // Ring is SPSC:
-//   - producer = StreamWorker thread (writes at writeFrame_)
+//   - producer = a StreamWorker thread (writes at writeFrame_; only one
+//     worker holds an instance at a time, see `busy`)
 //   - consumer = audio callback / mixer (reads at readFrame_)
 // Both indices are monotonic uint64; modulo RING_FRAMES on access. Power
 // of 2 keeps the wrap to a bitwise AND.
 //
 // Sizing: RING_FRAMES = 16384 stereo frames at 96 kHz = ~170 ms latency
-// budget. Worker polls every ~5 ms so underrun is unlikely under normal
-// load. Bigger = more headroom + memory; smaller = less RAM but more
-// vulnerable to long decode stalls.
+// budget. Workers poll every ~5 ms and serve the ring closest to running
+// dry first, so underrun is unlikely under normal load. Bigger = more
+// headroom + memory; smaller = less RAM but more vulnerable to long
+// decode stalls.
 // =============================================================================
 
 namespace internal {
 
+// ---------------------------------------------------------------------------
+// StreamBlockCache — decoded, engine-rate stereo PCM for one SoundStream,
+// cut into fixed-size blocks. Blocks are immutable once published, so any
+// number of workers can copy from the same block without locking; the
+// cache only keeps the most recently used ones within its byte budget.
+//
+// Decoding is serialized per stream (one decoder). The decoder keeps its
+// read cursor between blocks, so the common case — voices moving forward
+// through the file — never seeks.
+// ---------------------------------------------------------------------------
+class StreamBlockCache {
+public:
+    static constexpr size_t BLOCK_FRAMES = 8192;
+    static constexpr int    CHANNELS     = 2;
+    static constexpr size_t BLOCK_BYTES  = BLOCK_FRAMES * CHANNELS * sizeof(float);
+
+    struct Block {
+        std::vector<float> samples;   // interleaved stereo
+        size_t frames = 0;            // < BLOCK_FRAMES only for the last block
+    };
+
+    ~StreamBlockCache() { closeDecoder(); }
+
+    // Open the file (mapped when possible) and a decoder outputting at
+    // `sampleRate`. Returns the miniaudio result.
+    ma_result open(const fs::path& path, ma_encoding_format format, int sampleRate) {
+        std::lock_guard<std::mutex> lock(decoderMutex_);
+        path_ = path;
+        format_ = format;
+        file_.open(path);
+        return openDecoderLocked(sampleRate);
+    }
+
+    // Re-open the decoder at a new engine rate and drop every cached
+    // block. Voices built before the call keep the blocks they hold.
+    ma_result setSampleRate(int sampleRate) {
+        std::lock_guard<std::mutex> lock(decoderMutex_);
+        if (sampleRate == sampleRate_ && decoderInitialized_) return MA_SUCCESS;
+        closeDecoder();
+        {
+            std::lock_guard<std::mutex> mapLock(mapMutex_);
+            blocks_.clear();
+            cachedBytes_.store(0, std::memory_order_relaxed);
+        }
+        return openDecoderLocked(sampleRate);
+    }
+
+    int getSampleRate() const { return sampleRate_.load(std::memory_order_acquire); }
+    uint64_t getTotalFrames() const { return totalFrames_.load(std::memory_order_acquire); }
+
+    void setBudget(size_t bytes) {
+        budgetBlocks_.store(std::max<size_t>(1, bytes / BLOCK_BYTES), std::memory_order_relaxed);
+    }
+
+    // Block `index` (frames [index * BLOCK_FRAMES, +BLOCK_FRAMES)), decoding
+    // it on a miss. nullptr past the end of the file or on decode failure.
+    std::shared_ptr<const Block> get(uint64_t index) {
+        if (auto hit = lookup(index)) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return hit;
+        }
+
+        std::lock_guard<std::mutex> lock(decoderMutex_);
+        // Another worker may have decoded it while we waited.
+        if (auto hit = lookup(index)) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return hit;
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        if (!decoderInitialized_) return nullptr;
+
+        const uint64_t total = totalFrames_.load(std::memory_order_relaxed);
+        const uint64_t first = index * BLOCK_FRAMES;
+        if (total > 0 && first >= total) return nullptr;
+        if (cursor_ != first) {
+            if (ma_decoder_seek_to_pcm_frame(&decoder_, first) != MA_SUCCESS) return nullptr;
+            cursor_ = first;
+        }
+
+        auto block = std::make_shared<Block>();
+        block->samples.resize(BLOCK_FRAMES * CHANNELS);
+        while (block->frames < BLOCK_FRAMES) {
+            ma_uint64 read = 0;
+            ma_decoder_read_pcm_frames(&decoder_,
+                                       block->samples.data() + block->frames * CHANNELS,
+                                       BLOCK_FRAMES - block->frames, &read);
+            if (read == 0) break;
+            block->frames += (size_t)read;
+        }
+        cursor_ += block->frames;
+        if (block->frames == 0) return nullptr;
+        blocksDecoded_.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> mapLock(mapMutex_);
+        blocks_[index] = Entry{block, ++tick_};
+        cachedBytes_.fetch_add(BLOCK_BYTES, std::memory_order_relaxed);
+        evictLocked(index);
+        return block;
+    }
+
+    void fillStats(SoundStreamStats& out) const {
+        out.cacheHits     = hits_.load(std::memory_order_relaxed);
+        out.cacheMisses   = misses_.load(std::memory_order_relaxed);
+        out.blocksDecoded = blocksDecoded_.load(std::memory_order_relaxed);
+        out.cachedBytes   = cachedBytes_.load(std::memory_order_relaxed);
+        out.memoryMapped  = mapped_.load(std::memory_order_relaxed);
+    }
+
+    void resetStats() {
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+        blocksDecoded_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Block> block;
+        uint64_t lastUse = 0;
+    };
+
+    std::shared_ptr<const Block> lookup(uint64_t index) {
+        std::lock_guard<std::mutex> lock(mapMutex_);
+        auto it = blocks_.find(index);
+        if (it == blocks_.end()) return nullptr;
+        it->second.lastUse = ++tick_;
+        return it->second.block;
+    }
+
+    // Drop least-recently-used blocks over budget, never the one just added.
+    // A linear scan is fine: the budget is a few dozen blocks.
+    void evictLocked(uint64_t keep) {
+        const size_t budget = budgetBlocks_.load(std::memory_order_relaxed);
+        while (blocks_.size() > budget) {
+            auto victim = blocks_.end();
+            for (auto it = blocks_.begin(); it != blocks_.end(); ++it) {
+                if (it->first == keep) continue;
+                if (victim == blocks_.end() || it->second.lastUse < victim->second.lastUse) {
+                    victim = it;
+                }
+            }
+            if (victim == blocks_.end()) break;
+            blocks_.erase(victim);
+            cachedBytes_.fetch_sub(BLOCK_BYTES, std::memory_order_relaxed);
+        }
+    }
+
+    ma_result openDecoderLocked(int sampleRate) {
+        ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, CHANNELS, (ma_uint32)sampleRate);
+        cfg.encodingFormat = format_;
+        ma_result r = MA_ERROR;
+        bool mapped = false;
+        if (file_.isOpen() && file_.size() > 0) {
+            // Blocks are decoded front to back; let the kernel read ahead.
+            file_.advise(MappedFile::Access::Sequential);
+            r = ma_decoder_init_memory(file_.data(), file_.size(), &cfg, &decoder_);
+            mapped = (r == MA_SUCCESS);
+        }
+        if (!mapped) {
+            // Mapping unavailable (exotic filesystem, 32-bit address space
+            // exhausted): fall back to buffered file reads.
+            r = maDecoderInitPathA(path_, &cfg, &decoder_);
+        }
+        if (r != MA_SUCCESS) return r;
+
+        decoderInitialized_ = true;
+        cursor_ = 0;
+        ma_uint64 total = 0;
+        ma_decoder_get_length_in_pcm_frames(&decoder_, &total);
+        totalFrames_.store((uint64_t)total, std::memory_order_release);
+        sampleRate_.store(sampleRate, std::memory_order_release);
+        mapped_.store(mapped, std::memory_order_relaxed);
+        return MA_SUCCESS;
+    }
+
+    void closeDecoder() {
+        if (decoderInitialized_) {
+            ma_decoder_uninit(&decoder_);
+            decoderInitialized_ = false;
+        }
+    }
+
+    // Decoder side, guarded by decoderMutex_.
+    std::mutex decoderMutex_;
+    fs::path path_;
+    ma_encoding_format format_ = ma_encoding_format_unknown;
+    MappedFile file_;
+    ma_decoder decoder_;
+    bool decoderInitialized_ = false;
+    uint64_t cursor_ = 0;                 // next frame the decoder will output
+
+    // Cache side, guarded by mapMutex_ (taken after decoderMutex_).
+    std::mutex mapMutex_;
+    std::unordered_map<uint64_t, Entry> blocks_;
+    uint64_t tick_ = 0;
+
+    std::atomic<int>      sampleRate_{0};
+    std::atomic<uint64_t> totalFrames_{0};
+    std::atomic<size_t>   budgetBlocks_{(2u << 20) / BLOCK_BYTES};
+    std::atomic<size_t>   cachedBytes_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> blocksDecoded_{0};
+    std::atomic<bool>     mapped_{false};
+};
+
 struct StreamInstance {
     static constexpr size_t RING_FRAMES = 16384;          // power of 2
     static constexpr size_t RING_MASK   = RING_FRAMES - 1;
-    static constexpr int    CHANNELS    = 2;              // stereo, hard-coded
+    static constexpr int    CHANNELS    = StreamBlockCache::CHANNELS;
+                                                          // stereo, hard-coded
                                                           // because that's what
                                                           // the mixer consumes
-    ma_decoder decoder;
-    bool decoderInitialized = false;
+
+    // Shared with every other voice of the same SoundStream.
+    std::shared_ptr<StreamBlockCache> cache;
 
     // Interleaved stereo float, size = RING_FRAMES * CHANNELS.
     std::vector<float> ring;
@@ -93,11 +308,23 @@ struct StreamInstance {
     std::atomic<bool>     looping{false};
     std::atomic<bool>     disposed{false};   // set by AudioEngine to retire
                                               // the instance from the worker
-    // Seek request: writer side honors it before its next decode read.
+    // Seek request: writer side honors it before its next copy.
     std::atomic<bool>     seekRequested{false};
     std::atomic<uint64_t> seekTargetFrame{0};
 
-    uint64_t totalFramesInFile = 0;           // duration in source frames
+    // Playback speed as last seen by the mixer; the worker pool uses it to
+    // turn buffered frames into time-to-underrun.
+    std::atomic<float>    speed{1.0f};
+    // Claimed by the worker currently refilling this instance.
+    std::atomic<bool>     busy{false};
+
+    uint64_t totalFramesInFile = 0;           // duration in engine-rate frames
+
+    // Worker side (only touched by the worker holding `busy`): next file
+    // frame to copy and the cache block it lives in.
+    uint64_t sourceFrame = 0;
+    std::shared_ptr<const StreamBlockCache::Block> block;
+    uint64_t blockIndex = 0;
 
     // Sub-frame position inside the ring for setSpeed-aware linear interp.
     // Only touched by the mixer (audio callback thread) — single-writer, no
@@ -105,12 +332,10 @@ struct StreamInstance {
     double subFrame = 0.0;
 
     StreamInstance() : ring(RING_FRAMES * CHANNELS, 0.0f) {}
-    ~StreamInstance() {
-        if (decoderInitialized) {
-            ma_decoder_uninit(&decoder);
-            decoderInitialized = false;
-        }
-    }
+
+    // Frames behind readFrame the worker must not overwrite: the windowed-
+    // sinc resampler reads up to taps/2 - 1 frames of history.
+    static constexpr size_t HISTORY_FRAMES = soundmix::SincTable::MAX_TAPS / 2;
 
     // Frames available for read (monotonic, never overflows in practice
     // — uint64 at 96 kHz lasts ~6 million years).
@@ -118,7 +343,7 @@ struct StreamInstance {
         return writeFrame.load(std::memory_order_acquire)
              - readFrame.load(std::memory_order_relaxed);
     }
-    uint64_t space() const { return RING_FRAMES - available(); }
+    uint64_t space() const { return RING_FRAMES - HISTORY_FRAMES - available(); }
 };
 
 } // namespace internal
@@ -126,15 +351,25 @@ struct StreamInstance {
 // Implementation detail: the rest of this TU refers to StreamInstance
 // unqualified. (This is a .cpp, not a public header.)
 using internal::StreamInstance;
+using internal::StreamBlockCache;
 
 // ---------------------------------------------------------------------------
-// StreamWorker — single thread + condition variable; refills any registered
-// StreamInstance whose ring buffer is below half capacity. Wakes up on a CV
-// signal whenever a new instance is registered, plus a periodic timeout so
-// long-running streams stay topped up.
+// StreamWorker — a small pool of threads sharing one list of registered
+// StreamInstances. Refills are deadline-ordered: each pass a worker claims
+// the instance that will run dry first (buffered frames / playback speed;
+// pending seeks go first) and tops it up by at most REFILL_SLICE frames, so
+// a voice about to underrun never waits behind a long refill of one that
+// is comfortably full. Wakes up on a CV signal whenever a new instance is
+// registered, plus a periodic timeout so long-running streams stay topped
+// up.
 // ---------------------------------------------------------------------------
 class StreamWorker {
 public:
+    // Rings with less free space than this are left alone (batches copies).
+    static constexpr size_t MIN_REFILL   = 1024;
+    static constexpr size_t REFILL_SLICE = 4096;
+    static constexpr int    MAX_THREADS  = 4;
+
     static StreamWorker& getInstance() {
         static StreamWorker instance;
         return instance;
@@ -153,7 +388,11 @@ public:
             stop_ = true;
             cv_.notify_all();
         }
-        if (thread_.joinable()) thread_.join();
+        for (auto& t : threads_) {
+            if (t.joinable()) t.join();
+        }
+        threads_.clear();
+        running_ = false;
     }
 
 private:
@@ -164,17 +403,23 @@ private:
         if (running_) return;
         stop_ = false;
         running_ = true;
-        thread_ = std::thread([this] { run(); });
+        // Decoding is cheap next to realtime; a couple of threads is enough
+        // to keep one slow decode (a seek deep into an MP3) from stalling
+        // every other ring.
+        const int n = std::clamp((int)std::thread::hardware_concurrency() / 2, 1, MAX_THREADS);
+        for (int i = 0; i < n; i++) {
+            threads_.emplace_back([this] { run(); });
+        }
     }
 
-    // Refill one stream up to roughly full. Honor seek requests first.
-    void refillOne(StreamInstance& s) {
-        if (s.disposed.load(std::memory_order_acquire)) return;
-        if (!s.decoderInitialized) return;
+    // Copy up to `maxFrames` frames from the block cache into the ring.
+    // Honors seek requests first. Returns the number of frames written.
+    static size_t refillOne(StreamInstance& s, size_t maxFrames) {
+        if (s.disposed.load(std::memory_order_acquire)) return 0;
+        if (!s.cache) return 0;
 
         if (s.seekRequested.exchange(false, std::memory_order_acq_rel)) {
-            uint64_t target = s.seekTargetFrame.load(std::memory_order_relaxed);
-            ma_decoder_seek_to_pcm_frame(&s.decoder, target);
+            s.sourceFrame = s.seekTargetFrame.load(std::memory_order_relaxed);
             // Reset ring: drain any stale samples so the mixer sees the
             // post-seek stream from this point. subFrame is owned by the
             // mixer thread; clearing it from here is a benign race in
@@ -186,82 +431,111 @@ private:
             s.subFrame = 0.0;
         }
 
-        // Decode in chunks of up to scratchFrames frames at a time.
-        constexpr size_t scratchFrames = 1024;
-        float scratch[scratchFrames * StreamInstance::CHANNELS];
-
-        while (s.space() >= scratchFrames) {
-            ma_uint64 read = 0;
-            ma_result r = ma_decoder_read_pcm_frames(
-                &s.decoder, scratch, scratchFrames, &read);
-            if (read == 0) {
-                if (s.looping.load(std::memory_order_acquire)) {
-                    ma_decoder_seek_to_pcm_frame(&s.decoder, 0);
+        size_t written = 0;
+        while (written < maxFrames && s.space() > 0) {
+            const uint64_t index = s.sourceFrame / StreamBlockCache::BLOCK_FRAMES;
+            if (!s.block || s.blockIndex != index) {
+                s.block = s.cache->get(index);
+                s.blockIndex = index;
+            }
+            const size_t offset = (size_t)(s.sourceFrame - index * StreamBlockCache::BLOCK_FRAMES);
+            if (!s.block || offset >= s.block->frames) {
+                // End of file (or an undecodable tail).
+                if (s.looping.load(std::memory_order_acquire) && s.sourceFrame > 0) {
+                    s.sourceFrame = 0;
+                    // Loop may have been switched on after the stream ended.
+                    s.endOfStream.store(false, std::memory_order_release);
                     continue;
                 }
                 s.endOfStream.store(true, std::memory_order_release);
                 break;
             }
 
-            // Copy `read` frames into the ring, splitting on wrap.
+            const size_t n = (size_t)std::min<uint64_t>(
+                {(uint64_t)(s.block->frames - offset), s.space(), (uint64_t)(maxFrames - written)});
+            const float* src = s.block->samples.data() + offset * StreamInstance::CHANNELS;
+
+            // Copy `n` frames into the ring, splitting on wrap.
             uint64_t w = s.writeFrame.load(std::memory_order_relaxed);
             size_t   start = (size_t)(w & StreamInstance::RING_MASK);
-            size_t   first = std::min<size_t>(read, StreamInstance::RING_FRAMES - start);
+            size_t   first = std::min<size_t>(n, StreamInstance::RING_FRAMES - start);
             std::memcpy(&s.ring[start * StreamInstance::CHANNELS],
-                        scratch,
+                        src,
                         first * StreamInstance::CHANNELS * sizeof(float));
-            if (first < read) {
+            if (first < n) {
                 std::memcpy(&s.ring[0],
-                            scratch + first * StreamInstance::CHANNELS,
-                            (read - first) * StreamInstance::CHANNELS * sizeof(float));
+                            src + first * StreamInstance::CHANNELS,
+                            (n - first) * StreamInstance::CHANNELS * sizeof(float));
             }
-            s.writeFrame.store(w + read, std::memory_order_release);
+            s.writeFrame.store(w + n, std::memory_order_release);
+            s.sourceFrame += n;
+            written += n;
+        }
+        return written;
+    }
 
-            if ((ma_uint64)read < (ma_uint64)scratchFrames) {
-                // Short read = end of file. Next iteration's read=0 path
-                // handles the EOS / loop bookkeeping; bail out for now.
-                if (!s.looping.load(std::memory_order_acquire)) {
-                    s.endOfStream.store(true, std::memory_order_release);
-                }
-                break;
+    // Most urgent instance that needs work and isn't claimed by another
+    // worker, claimed for the caller. Prunes dead entries. Called locked.
+    std::shared_ptr<StreamInstance> claimMostUrgentLocked() {
+        std::shared_ptr<StreamInstance> best;
+        double bestDeadline = 0.0;
+        auto it = streams_.begin();
+        while (it != streams_.end()) {
+            auto sp = it->lock();
+            if (!sp || sp->disposed.load(std::memory_order_acquire)) {
+                it = streams_.erase(it);
+                continue;
+            }
+            ++it;
+            if (sp->busy.load(std::memory_order_relaxed)) continue;
+
+            double deadline;
+            if (sp->seekRequested.load(std::memory_order_acquire)) {
+                deadline = -1.0;
+            } else {
+                // Ended, unless loop was switched on afterwards (an empty
+                // file never loops). sourceFrame is safe to read: the
+                // instance isn't busy and busy is released under mutex_.
+                if (sp->endOfStream.load(std::memory_order_acquire)
+                    && !(sp->looping.load(std::memory_order_acquire) && sp->sourceFrame > 0)) continue;
+                if (sp->space() < MIN_REFILL) continue;
+                // Output frames until the ring runs dry. A paused or frozen
+                // voice (speed 0) still gets filled, just last.
+                const double speed = std::max(0.01, (double)sp->speed.load(std::memory_order_relaxed));
+                deadline = (double)sp->available() / speed;
+            }
+            if (!best || deadline < bestDeadline) {
+                best = std::move(sp);
+                bestDeadline = deadline;
             }
-            (void)r;
         }
+        if (best) best->busy.store(true, std::memory_order_relaxed);
+        return best;
     }
 
     void run() {
-        while (true) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait_for(lock, std::chrono::milliseconds(5),
-                         [this] { return stop_ || !streams_.empty(); });
-            if (stop_) break;
-
-            // Snapshot strong refs while holding the lock, then drop the
-            // lock for the actual decode work (which calls into miniaudio
-            // and shouldn't block other registrations).
-            std::vector<std::shared_ptr<StreamInstance>> live;
-            live.reserve(streams_.size());
-            auto it = streams_.begin();
-            while (it != streams_.end()) {
-                if (auto sp = it->lock()) {
-                    if (!sp->disposed.load(std::memory_order_acquire)) {
-                        live.push_back(std::move(sp));
-                    }
-                    ++it;
-                } else {
-                    it = streams_.erase(it);
-                }
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            auto s = claimMostUrgentLocked();
+            if (!s) {
+                cv_.wait_for(lock, std::chrono::milliseconds(5));
+                continue;
             }
-            lock.unlock();
 
-            for (auto& sp : live) {
-                refillOne(*sp);
-            }
+            // Drop the lock for the actual copy / decode work (which calls
+            // into miniaudio and shouldn't block other registrations or the
+            // other workers' scheduling).
+            lock.unlock();
+            refillOne(*s, REFILL_SLICE);
+            lock.lock();
+            s->busy.store(false, std::memory_order_relaxed);
+            // Release our reference before re-scanning, so a disposed
+            // instance can die here instead of on the next pass.
+            s.reset();
         }
-        running_ = false;
     }
 
-    std::thread thread_;
+    std::vector<std::thread> threads_;
     std::mutex mutex_;
     std::condition_variable cv_;
     std::vector<std::weak_ptr<StreamInstance>> streams_;
@@ -270,9 +544,9 @@ private:
 };
 
 // ---------------------------------------------------------------------------
-// SoundStream::loadStream — open the file once to validate format and
-// query duration/channels/sampleRate. Per-voice decoders are opened
-// lazily by AudioEngine::play().
+// SoundStream::loadStream — map the file, open the stream's shared decoder
+// to validate format and query duration/channels/sampleRate. Per-voice
+// rings are built lazily by AudioEngine::play().
 // ---------------------------------------------------------------------------
 LoadResult SoundStream::loadStream(const fs::path& path, int maxPolyphony) {
     if (maxPolyphony < 1) maxPolyphony = 1;
@@ -313,15 +587,12 @@ LoadResult SoundStream::loadStream(const fs::path& path, int maxPolyphony) {
                                 "file not found: " + internal::pathToUtf8(path));
     }
 
-    // Probe decode: open, query, close. Per-voice decoders re-open later.
-    // The decoder is configured to output at the engine's runtime sample
-    // rate so the mixer can memcpy without resampling.
-    ma_decoder probe;
-    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32,
-                                                    StreamInstance::CHANNELS,
-                                                    AudioEngine::getInstance().getSampleRate());
-    cfg.encodingFormat = fmt;
-    ma_result r = maDecoderInitPathA(path, &cfg, &probe);
+    // Open the shared decoder + block cache. The decoder is configured to
+    // output at the engine's runtime sample rate so the mixer can memcpy
+    // without resampling; voices opened later copy out of its blocks.
+    auto cache = std::make_shared<internal::StreamBlockCache>();
+    cache->setBudget(cacheSize_);
+    ma_result r = cache->open(path, fmt, AudioEngine::getInstance().getSampleRate());
     if (r != MA_SUCCESS) {
         printf("SoundStream: failed to open %s (result=%d)\n",
                internal::pathToUtf8(path).c_str(), (int)r);
@@ -330,14 +601,12 @@ LoadResult SoundStream::loadStream(const fs::path& path, int maxPolyphony) {
                                 " (result=" + std::to_string((int)r) + ")");
     }
 
-    ma_uint64 totalFrames = 0;
-    ma_decoder_get_length_in_pcm_frames(&probe, &totalFrames);
-    channels = (int)probe.outputChannels;
-    sampleRate = (int)probe.outputSampleRate;
+    channels = StreamInstance::CHANNELS;
+    sampleRate = cache->getSampleRate();
     duration_ = (sampleRate > 0)
-                ? (float)((double)totalFrames / (double)sampleRate)
+                ? (float)((double)cache->getTotalFrames() / (double)sampleRate)
                 : 0.0f;
-    ma_decoder_uninit(&probe);
+    cache_ = std::move(cache);
 
     path_ = path;
     maxPolyphony_ = maxPolyphony;
@@ -348,25 +617,48 @@ LoadResult SoundStream::loadStream(const fs::path& path, int maxPolyphony) {
     return LoadResult::success();
 }
 
+void SoundStream::setCacheSize(size_t bytes) {
+    cacheSize_ = bytes;
+    if (cache_) cache_->setBudget(bytes);
+}
+
+SoundStreamStats SoundStream::getStats() const {
+    SoundStreamStats st;
+    if (cache_) cache_->fillStats(st);
+    st.underruns = underruns_.load(std::memory_order_relaxed);
+    st.underrunFrames = underrunFrames_.load(std::memory_order_relaxed);
+    return st;
+}
+
+void SoundStream::resetStats() {
+    if (cache_) cache_->resetStats();
+    underruns_.store(0, std::memory_order_relaxed);
+    underrunFrames_.store(0, std::memory_order_relaxed);
+}
+
 // ---------------------------------------------------------------------------
-// AudioEngine::play(SoundSource) — unified entry point for both eager
-// SoundBuffer and streaming SoundStream sources.
+// AudioEngine::createVoice(SoundSource) — unified entry point for eager
+// SoundBuffer, streaming SoundStream and SoundSynth sources. Builds the voice
+// only; the audio thread doesn't see it until startVoice().
 // ---------------------------------------------------------------------------
-std::shared_ptr<PlayingSound> AudioEngine::play(std::shared_ptr<SoundSource> source) {
+std::shared_ptr<PlayingSound> AudioEngine::createVoice(std::shared_ptr<SoundSource> source) {
     if (!initialized_ || !source) return nullptr;
 
     // For streams: also build a StreamInstance up-front so when we hand
-    // the slot back the caller can already start consuming frames.
+    // the voice back the caller can already start consuming frames.
     std::shared_ptr<StreamInstance> stream;
     if (source->kind() == SoundSource::Stream) {
         auto* s = static_cast<SoundStream*>(source.get());
 
         // Count active stream voices for this same source — refuse to
-        // exceed maxPolyphony. Walking the slot list is O(MAX_PLAYING_SOUNDS)
-        // but MAX is small (32) so this is fine in practice.
+        // exceed maxPolyphony. Walking the registry is O(maxPolyphony)
+        // but that is small (32 by default) so this is fine in practice.
         int active = 0;
-        for (auto& slot : playingSounds_) {
-            if (slot && slot->playing && slot->buffer.get() == s) ++active;
+        {
+            std::lock_guard<std::mutex> lock(commandMutex_);
+            for (auto& slot : registry_) {
+                if (slot && slot->playing && slot->buffer.get() == s) ++active;
+            }
         }
         if (active >= s->getMaxPolyphony()) {
             // Conservative: log + reject. The caller (Sound::play()) will
@@ -379,64 +671,465 @@ std::shared_ptr<PlayingSound> AudioEngine::play(std::shared_ptr<SoundSource> sou
             return nullptr;
         }
 
-        // Open a fresh decoder for this voice.
-        stream = std::make_shared<StreamInstance>();
-        ma_decoder_config cfg = ma_decoder_config_init(
-            ma_format_f32, StreamInstance::CHANNELS, sampleRate_);
-        cfg.encodingFormat = (ma_encoding_format)s->encodingFormatHint_;
-        ma_result r = maDecoderInitPathA(s->path_, &cfg, &stream->decoder);
+        if (!s->cache_) {
+            printf("SoundStream: %s is not loaded\n", s->getPath().c_str());
+            return nullptr;
+        }
+        // Streams loaded before the engine picked its rate decode at the
+        // old one; blocks must match the device.
+        ma_result r = s->cache_->setSampleRate(sampleRate_);
         if (r != MA_SUCCESS) {
-            printf("SoundStream: per-voice decoder init failed for %s (result=%d)\n",
+            printf("SoundStream: decoder init failed for %s (result=%d)\n",
                    s->getPath().c_str(), (int)r);
             return nullptr;
         }
-        stream->decoderInitialized = true;
-        ma_uint64 totalFrames = 0;
-        ma_decoder_get_length_in_pcm_frames(&stream->decoder, &totalFrames);
-        stream->totalFramesInFile = (uint64_t)totalFrames;
+        s->sampleRate = sampleRate_;
+
+        stream = std::make_shared<StreamInstance>();
+        stream->cache = s->cache_;
+        stream->totalFramesInFile = s->cache_->getTotalFrames();
 
         StreamWorker::getInstance().registerStream(stream);
     }
 
-    std::lock_guard<std::mutex> lock(mutex_);
+    // Synths render at the engine rate, so like streams they need no
+    // rate compensation.
+    std::shared_ptr<SoundSynthInstance> synth;
+    if (source->kind() == SoundSource::Synth) {
+        if (source->channels < 1 || source->channels > SoundSynth::MAX_CHANNELS) {
+            printf("AudioEngine: synth has %d channels (1-%d supported)\n",
+                   source->channels, SoundSynth::MAX_CHANNELS);
+            return nullptr;
+        }
+        synth = static_cast<SoundSynth*>(source.get())->createInstance(sampleRate_);
+        if (!synth) return nullptr;
+        source->sampleRate = sampleRate_;
+    }
+
+    auto voice = std::make_shared<PlayingSound>();
+    voice->buffer = source;
+    voice->stream = stream;
+    voice->synth = synth;
+    voice->positionF = 0.0;
+    voice->volume = 1.0f;
+    voice->pan = 0.0f;
+    voice->speed = 1.0f;
+    voice->loop = false;
+    voice->playing = true;
+    voice->paused = false;
+    // For streams the decoder already resampled to engine rate (and synths
+    // render at it), so rateRatio = 1.0 (no pitch adjust). For eager buffers, retain
+    // the existing buffer/engine ratio compensation.
+    if (source->kind() == SoundSource::Eager) {
+        voice->rateRatio = (source->sampleRate > 0 && sampleRate_ > 0)
+            ? ((float)source->sampleRate / (float)sampleRate_)
+            : 1.0f;
+    } else {
+        voice->rateRatio = 1.0f;
+    }
+    return voice;
+}
+
+bool AudioEngine::startVoice(const std::shared_ptr<PlayingSound>& voice) {
+    if (!voice) return false;
+
+    auto reject = [&](const char* why) {
+        printf("AudioEngine: %s\n", why);
+        voice->playing = false;
+        // Mark the just-opened stream as disposed so the worker drops it.
+        if (voice->stream) voice->stream->disposed.store(true, std::memory_order_release);
+        return false;
+    };
+
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    collectRetired();
+
+    std::shared_ptr<PlayingSound>* free = nullptr;
+    for (auto& slot : registry_) {
+        if (!slot || !slot->playing) { free = &slot; break; }
+    }
+    std::shared_ptr<PlayingSound>* victim = nullptr;
+    if (!free) {
+        victim = findStealVictim(voice->priority.load(std::memory_order_relaxed));
+        if (!victim) return reject("max playing sounds reached");
+        free = victim;
+    }
+
+    voice->startOrder = ++voiceSerial_;
+    voice->audibility.store(std::fabs(voice->volume.load()), std::memory_order_relaxed);
+    voice->isVirtual.store(false, std::memory_order_relaxed);
+
+    VoiceCommand cmd;
+    cmd.type = VoiceCommand::Start;
+    cmd.voice = voice;
+    if (!commands_->push(std::move(cmd))) {
+        statDropped_.fetch_add(1, std::memory_order_relaxed);
+        return reject("command queue full, voice dropped");
+    }
+    if (victim) {
+        // The audio thread fades it out over FADE_SECONDS, overlapping the
+        // new voice, and then stops it. It has left the registry, so it
+        // can't be stolen twice.
+        (*victim)->stolen.store(true, std::memory_order_relaxed);
+        statStolen_.fetch_add(1, std::memory_order_relaxed);
+    }
+    *free = voice;
+    return true;
+}
 
-    for (auto& slot : playingSounds_) {
-        if (!slot || !slot->playing) {
-            slot = std::make_shared<PlayingSound>();
-            slot->buffer = source;
-            slot->stream = stream;
-            slot->positionF = 0.0;
-            slot->volume = 1.0f;
-            slot->pan = 0.0f;
-            slot->speed = 1.0f;
-            slot->loop = false;
-            slot->playing = true;
-            slot->paused = false;
-            // For streams the decoder already resampled to engine rate, so
-            // rateRatio = 1.0 (no pitch adjust). For eager buffers, retain
-            // the existing buffer/engine ratio compensation.
-            if (source->kind() == SoundSource::Eager) {
-                slot->rateRatio = (source->sampleRate > 0 && sampleRate_ > 0)
-                    ? ((float)source->sampleRate / (float)sampleRate_)
-                    : 1.0f;
+// ---------------------------------------------------------------------------
+// findStealVictim — the registry slot whose voice the steal policy gives up
+// for a new sound of `priority`, or nullptr. Voices of higher priority than
+// the newcomer are never candidates. Caller holds commandMutex_; every slot
+// holds a playing voice (there was no free one).
+// ---------------------------------------------------------------------------
+std::shared_ptr<PlayingSound>* AudioEngine::findStealVictim(int priority) {
+    const auto policy = (VoiceStealPolicy)stealPolicy_.load(std::memory_order_relaxed);
+    const int victim = soundmix::pickStealVictim(policy, priority, (int)registry_.size(),
+        [this](int i) {
+            const PlayingSound& v = *registry_[i];
+            soundmix::VoiceInfo info;
+            info.priority = v.priority.load(std::memory_order_relaxed);
+            info.audibility = v.audibility.load(std::memory_order_relaxed);
+            info.startOrder = v.startOrder;
+            return info;
+        });
+    return victim < 0 ? nullptr : &registry_[victim];
+}
+
+void AudioEngine::setMaxRealVoices(int count) {
+    maxRealVoices_.store(std::max(0, count), std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// assignRealVoices — audio thread, once per block. Measures every live
+// voice and lets soundmix::assignReal() pick the real ones (O(n), over the
+// preallocated rank_ scratch, so thousands of voices stay cheap). A voice
+// that changes side fades toward it in mixVoice(); it only turns virtual —
+// stops being mixed — once the fade out is done. Stolen voices take no
+// part in the ranking and stop as soon as they are silent (a paused one
+// at once).
+// ---------------------------------------------------------------------------
+void AudioEngine::assignRealVoices() {
+    const float threshold = audibilityThreshold_.load(std::memory_order_relaxed);
+    const int budget = maxRealVoices_.load(std::memory_order_relaxed);
+
+    int candidates = 0;
+    for (int i = 0; i < numVoices_; i++) {
+        PlayingSound& v = *voices_[i];
+        if (!v.playing) continue;
+
+        // Before the paused / buffer skip: a voice stolen while paused is
+        // silent already, so it stops at once instead of lingering.
+        if (v.stolen.load(std::memory_order_relaxed)) {
+            v.wantReal = false;
+            if (!v.placed || v.fadeGain == 0.0f || v.paused || !v.buffer) v.playing = false;
+            continue;
+        }
+        if (v.paused || !v.buffer) continue;
+
+        float loudest = 1.0f;
+        if (const auto* gains = v.channelGains.get(); gains && !gains->empty()) {
+            loudest = 0.0f;
+            for (float g : *gains) loudest = std::max(loudest, std::fabs(g));
+        }
+        // Pan only attenuates the far side, so it never lowers the peak.
+        const float a = std::fabs(v.volume.load()) * loudest;
+        v.audibility.store(a, std::memory_order_relaxed);
+
+        soundmix::VoiceInfo& info = rank_[candidates++];
+        info.priority = v.priority.load(std::memory_order_relaxed);
+        info.audibility = a;
+        info.startOrder = v.startOrder;
+        info.real = v.wantReal || !v.placed;
+        info.id = i;
+    }
+
+    soundmix::assignReal(rank_.data(), candidates, threshold, budget);
+
+    for (int k = 0; k < candidates; k++) {
+        PlayingSound& v = *voices_[rank_[k].id];
+        v.wantReal = rank_[k].real;
+        if (!v.placed) {
+            // First block: start on its side without a fade.
+            v.fadeGain = v.wantReal ? 1.0f : 0.0f;
+            v.placed = true;
+        }
+    }
+
+    int realCount = 0;
+    int virtualCount = 0;
+    for (int i = 0; i < numVoices_; i++) {
+        PlayingSound& v = *voices_[i];
+        if (!v.playing || v.paused || !v.buffer) continue;
+        const bool silent = !v.wantReal && v.fadeGain == 0.0f;
+        v.isVirtual.store(silent, std::memory_order_relaxed);
+        ++(silent ? virtualCount : realCount);
+    }
+
+    statRealVoices_.store(realCount, std::memory_order_relaxed);
+    statVirtualVoices_.store(virtualCount, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// advanceVirtualVoice — move a virtual voice's playhead by one block without
+// mixing it, with the same end / loop semantics as the mix paths.
+// ---------------------------------------------------------------------------
+void AudioEngine::advanceVirtualVoice(PlayingSound& sound, int num_frames) {
+    if (sound.buffer->kind() == SoundSource::Eager) {
+        const auto& src = *static_cast<const SoundBuffer*>(sound.buffer.get());
+        const double length = (double)src.numSamples;
+        double posF = sound.positionF
+                    + (double)sound.speed.load() * (double)sound.rateRatio * num_frames;
+        if (posF >= length || posF < 0.0) {
+            if (sound.loop && length > 0.0) {
+                posF = std::fmod(posF, length);
+                if (posF < 0.0) posF += length;
             } else {
-                slot->rateRatio = 1.0f;
+                sound.playing = false;
+                posF = std::clamp(posF, 0.0, length);
             }
-            return slot;
         }
+        sound.positionF = posF;
+        return;
     }
 
-    printf("AudioEngine: max playing sounds reached\n");
-    // Mark the just-opened stream as disposed so the worker drops it.
-    if (stream) stream->disposed.store(true, std::memory_order_release);
-    return nullptr;
+    // Synth: run the clock (notes start and end on time) without rendering.
+    if (sound.buffer->kind() == SoundSource::Synth) {
+        auto* synth = sound.synth.get();
+        if (!synth) return;
+        if (sound.positionF != synth->getPosition()) synth->seek(sound.positionF);
+        const double speed = std::clamp((double)sound.speed.load(), 0.0, 10.0);
+        for (int frame = 0; frame < num_frames; ) {
+            const int want = std::min(soundmix::RUN_FRAMES, num_frames - frame);
+            const int got = synth->skip(want, speed, sound.loop.load());
+            frame += got;
+            if (got < want) {
+                sound.playing = false;
+                break;
+            }
+        }
+        sound.positionF = synth->getPosition();
+        return;
+    }
+
+    // Stream: consume the ring as if it had been mixed, so the voice comes
+    // back in the right place and the worker keeps refilling it.
+    auto& stream = sound.stream;
+    if (!stream) return;
+    stream->looping.store(sound.loop.load(), std::memory_order_release);
+    const double speed = std::clamp((double)sound.speed.load(), 0.0, 10.0);
+    stream->speed.store((float)speed, std::memory_order_relaxed);
+
+    const double want = stream->subFrame + speed * num_frames;
+    const uint64_t whole = (uint64_t)want;
+    const uint64_t avail = stream->available();
+    const uint64_t taken = std::min(whole, avail);
+    stream->subFrame = (taken == whole) ? want - (double)whole : 0.0;
+    stream->readFrame.store(stream->readFrame.load(std::memory_order_relaxed) + taken,
+                            std::memory_order_release);
+
+    if (taken < whole && stream->endOfStream.load(std::memory_order_acquire)
+        && !sound.loop.load()) {
+        sound.playing = false;
+    }
+    sound.positionF += (double)taken;
+    if (sound.loop.load() && stream->totalFramesInFile > 0) {
+        const double total = (double)stream->totalFramesInFile;
+        if (sound.positionF >= total) sound.positionF = std::fmod(sound.positionF, total);
+    }
+}
+
+bool AudioEngine::setVoiceRouting(const std::shared_ptr<PlayingSound>& voice,
+                                  std::shared_ptr<const std::vector<std::vector<int>>> channelMap,
+                                  std::shared_ptr<const std::vector<float>> channelGains) {
+    if (!voice) return false;
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    collectRetired();
+
+    VoiceCommand cmd;
+    cmd.type = VoiceCommand::Routing;
+    cmd.voice = voice;
+    cmd.channelMap = std::move(channelMap);
+    cmd.channelGains = std::move(channelGains);
+    if (!commands_->push(std::move(cmd))) {
+        statDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool AudioEngine::setVoiceBus(const std::shared_ptr<PlayingSound>& voice,
+                              std::shared_ptr<AudioBus> bus) {
+    if (!voice) return false;
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    collectRetired();
+
+    VoiceCommand cmd;
+    cmd.type = VoiceCommand::Bus;
+    cmd.voice = voice;
+    cmd.bus = std::move(bus);
+    if (!commands_->push(std::move(cmd))) {
+        statDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// Destroy what the audio thread handed back. Caller holds commandMutex_.
+void AudioEngine::collectRetired() {
+    std::shared_ptr<const void> dead;
+    while (retired_->pop(dead)) dead.reset();
+    graph_.collectGarbage();
+}
+
+// ---------------------------------------------------------------------------
+// mixThroughGraph — audio thread, when AudioGraph::beginBlock() says the
+// graph is doing something. Each voice mixes into its bus's buffer (master
+// when unrouted or the bus was removed); the graph then runs effects,
+// gains and sends and writes the master into the device buffer.
+// ---------------------------------------------------------------------------
+void AudioEngine::mixThroughGraph(float* buffer, int num_frames, int num_channels) {
+    for (int offset = 0; offset < num_frames; offset += AudioGraph::BLOCK_FRAMES) {
+        const int frames = std::min(AudioGraph::BLOCK_FRAMES, num_frames - offset);
+        graph_.clear(frames, num_channels);
+        for (int i = 0; i < numVoices_; i++) {
+            PlayingSound& sound = *voices_[i];
+            mixVoice(sound, graph_.getBusBuffer(sound.bus.get()), frames, num_channels);
+        }
+        graph_.process(buffer + (size_t)offset * num_channels, frames, num_channels);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// applyVoiceCommands — block-start bookkeeping on the audio thread (or on the
+// init() thread while the device is stopped). Never allocates and never
+// drops the last reference to anything: finished voices and replaced
+// routing snapshots go back through retired_ and die in collectRetired().
+// ---------------------------------------------------------------------------
+void AudioEngine::applyVoiceCommands() {
+    // Retire stopped voices, keeping the rest in start order.
+    int n = 0;
+    for (int i = 0; i < numVoices_; i++) {
+        auto& v = voices_[i];
+        if (!v->playing) {
+            std::shared_ptr<const void> r = v;
+            if (retired_->push(std::move(r))) { v.reset(); continue; }
+        }
+        if (n != i) voices_[n] = std::move(v);
+        n++;
+    }
+    numVoices_ = n;
+
+    VoiceCommand cmd;
+    while (commands_->pop(cmd)) {
+        if (cmd.type == VoiceCommand::Start) {
+            // Stopped again before it ever played: nothing to mix.
+            if (cmd.voice->playing && numVoices_ == (int)voices_.size()) {
+                dropFadingVoice();
+            }
+            if (cmd.voice->playing && numVoices_ < (int)voices_.size()) {
+                voices_[numVoices_++] = std::move(cmd.voice);
+            } else if (cmd.voice->playing) {
+                cmd.voice->playing = false;
+                statDropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (cmd.type == VoiceCommand::Routing) {
+            std::swap(cmd.voice->channelMap, cmd.channelMap);
+            std::swap(cmd.voice->channelGains, cmd.channelGains);
+        } else {
+            std::swap(cmd.voice->bus, cmd.bus);
+        }
+        // Whatever the command still holds (old routing, a voice we
+        // didn't take) is released off this thread. A full ring can only
+        // happen if nobody has called play() for a very long time; then
+        // the references simply die here.
+        if (cmd.voice) retired_->push(std::move(cmd.voice));
+        if (cmd.channelMap) retired_->push(std::move(cmd.channelMap));
+        if (cmd.channelGains) retired_->push(std::move(cmd.channelGains));
+        if (cmd.bus) retired_->push(std::move(cmd.bus));
+        cmd = VoiceCommand{};
+    }
+    statVoices_.store(numVoices_, std::memory_order_relaxed);
+}
+
+// Make room for a start when voices_ is full of voices still fading out
+// after being stolen: cut the oldest of them short and retire it.
+void AudioEngine::dropFadingVoice() {
+    for (int i = 0; i < numVoices_; i++) {
+        if (!voices_[i]->stolen.load(std::memory_order_relaxed)) continue;
+        voices_[i]->playing = false;
+        std::shared_ptr<const void> r = voices_[i];
+        if (!retired_->push(std::move(r))) return;
+        for (int k = i + 1; k < numVoices_; k++) voices_[k - 1] = std::move(voices_[k]);
+        voices_[--numVoices_].reset();
+        return;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// resizeVoices — (re)build the voice list and queues for a polyphony. Only
+// called from the constructor and init(), with no audio callback running.
+// Voices already playing survive up to the new polyphony (oldest first);
+// the rest are stopped.
+// ---------------------------------------------------------------------------
+void AudioEngine::resizeVoices(int polyphony) {
+    std::lock_guard<std::mutex> lock(commandMutex_);
+    if (commands_) {
+        applyVoiceCommands();
+        collectRetired();
+    }
+
+    std::vector<std::shared_ptr<PlayingSound>> keep;
+    for (int i = 0; i < numVoices_; i++) {
+        auto& v = voices_[i];
+        if ((int)keep.size() < polyphony) keep.push_back(std::move(v));
+        else v->playing = false;
+    }
+
+    registry_.assign(polyphony, nullptr);
+    voices_.assign(2 * polyphony, nullptr);
+    rank_.assign(2 * polyphony, soundmix::VoiceInfo{});
+    numVoices_ = (int)keep.size();
+    for (int i = 0; i < numVoices_; i++) {
+        registry_[i] = keep[i];
+        voices_[i] = std::move(keep[i]);
+    }
+
+    size_t retiredCapacity = 1;
+    while (retiredCapacity < (size_t)(2 * polyphony + 3 * COMMAND_QUEUE_SIZE)) retiredCapacity <<= 1;
+    commands_ = std::make_unique<internal::SpscQueue<VoiceCommand>>(COMMAND_QUEUE_SIZE);
+    retired_ = std::make_unique<internal::SpscQueue<std::shared_ptr<const void>>>(retiredCapacity);
+    statVoices_.store(numVoices_, std::memory_order_relaxed);
+}
+
+AudioEngineStats AudioEngine::getStats() const {
+    AudioEngineStats s;
+    s.callbacks       = statCallbacks_.load(std::memory_order_relaxed);
+    s.lateCallbacks   = statLate_.load(std::memory_order_relaxed);
+    s.xruns           = statXruns_.load(std::memory_order_relaxed);
+    s.peakLoad        = statPeakLoad_.load(std::memory_order_relaxed);
+    s.droppedCommands = statDropped_.load(std::memory_order_relaxed);
+    s.stolenVoices    = statStolen_.load(std::memory_order_relaxed);
+    s.activeVoices    = statVoices_.load(std::memory_order_relaxed);
+    s.realVoices      = statRealVoices_.load(std::memory_order_relaxed);
+    s.virtualVoices   = statVirtualVoices_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AudioEngine::resetStats() {
+    statCallbacks_ = 0;
+    statLate_ = 0;
+    statXruns_ = 0;
+    statPeakLoad_ = 0.0f;
+    statDropped_ = 0;
+    statStolen_ = 0;
 }
 
 // ---------------------------------------------------------------------------
 // mixStreamVoice — consume frames from the per-voice ring buffer.
 //
-// The mixer is invoked with the global engine lock held (mutex_), so we
-// don't need to lock the stream itself — the SPSC ring uses atomic
+// Runs on the audio thread without any lock — the SPSC ring uses atomic
 // indices for synchronization with the worker.
 //
 // speed support:
@@ -448,6 +1141,9 @@ std::shared_ptr<PlayingSound> AudioEngine::play(std::shared_ptr<SoundSource> sou
 //     subFrame by `speed`. Each whole unit of subFrame consumes one
 //     ring frame.
 //   - speed = 0 keeps subFrame fixed → same sample emitted = freeze.
+//   - with a sinc ResampleQuality the same subFrame drives a windowed-
+//     sinc filter over the ring instead of the lerp; the worker leaves
+//     HISTORY_FRAMES behind readFrame untouched for it.
 //   - speed > 1 consumes the ring N× faster, raising underrun risk on
 //     slow hardware. Worker decode is far faster than realtime on
 //     modern CPUs for WAV / MP3 / FLAC, so this is usually fine.
@@ -470,12 +1166,13 @@ void AudioEngine::mixStreamVoice(PlayingSound& sound, SoundStream& src,
     double speed = (double)sound.speed.load();
     if (speed < 0.0) speed = 0.0;
     if (speed > 10.0) speed = 10.0;
+    stream->speed.store((float)speed, std::memory_order_relaxed);
 
     // Snapshot routing state for this callback. Stream ring is always 2ch
     // (the per-voice decoder is configured to output stereo), so routing
     // operates on src.channels = StreamInstance::CHANNELS.
-    auto map = internal::sharedLoad(sound.channelMap);
-    auto gains = internal::sharedLoad(sound.channelGains);
+    const auto* map = sound.channelMap.get();
+    const auto* gains = sound.channelGains.get();
     int mm = sound.mixMode.load(std::memory_order_acquire);
     const int srcCh = StreamInstance::CHANNELS;
     const int mapSize = map ? (int)map->size() : 0;
@@ -485,34 +1182,71 @@ void AudioEngine::mixStreamVoice(PlayingSound& sound, SoundStream& src,
     uint64_t readFrame  = stream->readFrame.load(std::memory_order_relaxed);
     double   subFrame   = stream->subFrame;
 
+    // Windowed-sinc: window [readFrame - history, readFrame - history + taps).
+    // Frames before the start of the ring (just started / seeked) read as
+    // silence, and so do frames past the end of a finished stream, so its
+    // tail plays out.
+    const auto* sinc = soundmix::SincTable::find(
+        sound.resampleQuality.load(std::memory_order_relaxed));
+    const int taps    = sinc ? sinc->getTaps() : 2;
+    const int history = sinc ? sinc->getHistory() : 0;
+    const int band    = soundmix::SincTable::bandFor(speed);
+    const uint64_t lookahead = (uint64_t)(taps - history - 1);
+    float coef[soundmix::SincTable::MAX_TAPS];
+    float window[soundmix::SincTable::MAX_TAPS * StreamInstance::CHANNELS];
+
     int produced = 0;
+    int starved = 0;          // output frames skipped for lack of data
     double posAdvance = 0.0;  // sum of consumed ring frames this callback
 
     for (int frame = 0; frame < num_frames; ++frame) {
-        // Need both readFrame and readFrame+1 for interpolation.
-        if (readFrame + 1 >= writeFrame) {
-            if (stream->endOfStream.load(std::memory_order_acquire)
-                && !sound.loop.load()) {
+        // Need readFrame .. readFrame + lookahead for interpolation.
+        const bool ended = stream->endOfStream.load(std::memory_order_acquire)
+                        && !sound.loop.load();
+        if (readFrame + lookahead >= writeFrame
+            && !(sinc && ended && readFrame < writeFrame)) {
+            if (ended) {
                 sound.playing = false;
                 break;
             }
             // Underrun: emit nothing for this output frame, give the
             // worker a chance to catch up. subFrame state preserved.
+            ++starved;
             continue;
         }
 
-        size_t idx0 = (size_t)(readFrame & StreamInstance::RING_MASK)
-                      * StreamInstance::CHANNELS;
-        size_t idx1 = (size_t)((readFrame + 1) & StreamInstance::RING_MASK)
-                      * StreamInstance::CHANNELS;
-        float frac = (float)subFrame;
-
-        // Pull interpolated sample for ring channel s (0 = L, 1 = R).
+        // Interpolated sample per ring channel (0 = L, 1 = R).
+        float chs[StreamInstance::CHANNELS];
+        if (sinc) {
+            const int64_t start = (int64_t)readFrame - history;
+            for (int k = 0; k < taps; k++) {
+                const int64_t f = start + k;
+                float* w = window + (size_t)k * StreamInstance::CHANNELS;
+                if (f < 0 || (uint64_t)f >= writeFrame) {
+                    w[0] = w[1] = 0.0f;
+                } else {
+                    const float* r = &stream->ring[(size_t)((uint64_t)f & StreamInstance::RING_MASK)
+                                                   * StreamInstance::CHANNELS];
+                    w[0] = r[0];
+                    w[1] = r[1];
+                }
+            }
+            sinc->coefficients(band, (float)subFrame, coef);
+            soundmix::detail::dot2(window, coef, taps, chs[0], chs[1]);
+        } else {
+            size_t idx0 = (size_t)(readFrame & StreamInstance::RING_MASK)
+                          * StreamInstance::CHANNELS;
+            size_t idx1 = (size_t)((readFrame + 1) & StreamInstance::RING_MASK)
+                          * StreamInstance::CHANNELS;
+            float frac = (float)subFrame;
+            for (int s = 0; s < StreamInstance::CHANNELS; s++) {
+                float a = stream->ring[idx0 + (size_t)s];
+                float b = stream->ring[idx1 + (size_t)s];
+                chs[s] = a + (b - a) * frac;
+            }
+        }
         auto srcAt = [&](int s) -> float {
-            if (s < 0 || s >= srcCh) return 0.0f;
-            float a = stream->ring[idx0 + (size_t)s];
-            float b = stream->ring[idx1 + (size_t)s];
-            return a + (b - a) * frac;
+            return (s < 0 || s >= srcCh) ? 0.0f : chs[s];
         };
 
         // Per-output-channel routing (same shape as mixEagerVoice).
@@ -549,6 +1283,12 @@ void AudioEngine::mixStreamVoice(PlayingSound& sound, SoundStream& src,
 
     stream->readFrame.store(readFrame, std::memory_order_release);
     stream->subFrame = subFrame;
+    // A voice waiting for its first frames (fresh play() / seek) is start-up
+    // latency, not an underrun.
+    if (starved > 0 && writeFrame > 0) {
+        src.underruns_.fetch_add(1, std::memory_order_relaxed);
+        src.underrunFrames_.fetch_add((uint64_t)starved, std::memory_order_relaxed);
+    }
 
     // positionF advances by the actual ring frames consumed (which equals
     // produced output frames * average speed). When speed = 0, posAdvance
@@ -591,7 +1331,8 @@ bool AudioEngine::init() {
         .sampleRate   = sampleRate_,
         .channels     = channels_,
         .bufferSize   = bufferSize_,
-        .maxPolyphony = (int)playingSounds_.size(),
+        .maxPolyphony = getMaxPolyphony(),
+        .maxRealVoices = getMaxRealVoices(),
         .deviceName   = std::string(),
     });
 }
@@ -630,16 +1371,23 @@ bool AudioEngine::init(const AudioSettings& settings) {
     channels_   = settings.channels   > 0 ? settings.channels   : DEFAULT_CHANNELS;
     bufferSize_ = settings.bufferSize  > 0 ? settings.bufferSize : DEFAULT_BUFFER_SIZE;
 
+    setMaxRealVoices(settings.maxRealVoices);
+
     int polyphony = settings.maxPolyphony > 0
                   ? settings.maxPolyphony
                   : DEFAULT_MAX_PLAYING_SOUNDS;
-    if ((int)playingSounds_.size() != polyphony) {
-        // Preserve existing slots up to the new size; truncating drops the
-        // oldest extra voices (which is the same policy as play() reusing
-        // dead slots — losing them is unavoidable if the user shrinks the
-        // pool while voices are active).
-        playingSounds_.resize(polyphony);
+    if (getMaxPolyphony() != polyphony) {
+        // Preserve playing voices up to the new size; shrinking the pool
+        // while voices are active stops the newest extra ones. The device
+        // is stopped, so this thread can stand in for the audio thread.
+        resizeVoices(polyphony);
+    } else if (reinit) {
+        // Apply anything queued while the device was down, so migration
+        // below sees every live voice.
+        std::lock_guard<std::mutex> lock(commandMutex_);
+        applyVoiceCommands();
     }
+    lastCallbackNs_ = 0;
 
     // Re-init only: migrate active voices so they continue from the same
     // playback position at the new engine rate. The device is currently
@@ -648,6 +1396,12 @@ bool AudioEngine::init(const AudioSettings& settings) {
         migrateVoicesToNewRate(oldRate, sampleRate_);
     }
 
+    // Size effect state and the fade scratch for the (new) device while no
+    // callback can run.
+    graph_.prepare(sampleRate_, channels_);
+    fadeScratch_.assign((size_t)soundmix::RUN_FRAMES
+                        * std::max(channels_, AudioGraph::MAX_CHANNELS), 0.0f);
+
     // Lazily create a persistent ma_context. Sharing one context across
     // every device init/uninit cycle keeps CoreAudio's internal state
     // consistent on macOS — without it, the second ma_device_uninit in a
@@ -717,7 +1471,7 @@ bool AudioEngine::init(const AudioSettings& settings) {
     initialized_ = true;
 
     printf("AudioEngine: initialized (%d Hz, %d ch, %d voices) [miniaudio]\n",
-           sampleRate_, channels_, (int)playingSounds_.size());
+           sampleRate_, channels_, getMaxPolyphony());
 
     // Fire audioDeviceChanged with the resolved device's real info.
     // ma_device's playback.name is populated by ma_device_init even when
@@ -727,7 +1481,7 @@ bool AudioEngine::init(const AudioSettings& settings) {
     args.sampleRate   = sampleRate_;
     args.channels     = channels_;
     args.bufferSize   = bufferSize_;
-    args.maxPolyphony = (int)playingSounds_.size();
+    args.maxPolyphony = getMaxPolyphony();
 
     // Determine whether the opened device is the OS default by comparing
     // its device ID against the isDefault flag from the playback device
@@ -788,20 +1542,24 @@ std::vector<AudioDeviceInfo> AudioEngine::listDevices() {
 // by an engine rate change. We just recompute rateRatio = source_rate /
 // new_engine_rate so each output frame advances posF by the right amount.
 //
-// Streaming voices: the per-voice ma_decoder was configured to OUTPUT at
-// the old engine rate, and the ring holds samples at that rate. Both are
-// stale. We rebuild the StreamInstance from scratch (new decoder
-// configured at newRate), seek it to the same wall-clock playback time,
-// and rejoin the StreamWorker. The old StreamInstance is dropped — its
-// destructor uninits the old decoder. Worker's weak_ptr to it stops
-// locking and the entry self-evicts on the next iteration.
+// Synth voices: rebuilt at the new rate and sought to the same time.
+//
+// Streaming voices: the stream's shared ma_decoder was configured to
+// OUTPUT at the old engine rate, and its cached blocks and the voice's ring
+// hold samples at that rate. All are stale. We re-open the decoder at
+// newRate (dropping the cache), rebuild the StreamInstance from scratch
+// starting at the same wall-clock playback time, and rejoin the
+// StreamWorker. The old StreamInstance is disposed and dropped; the
+// workers' weak_ptr to it stops locking and the entry self-evicts on the
+// next pass.
 //
 // Called with the device stopped, so no audio callback can race.
 // ---------------------------------------------------------------------------
 void AudioEngine::migrateVoicesToNewRate(int oldRate, int newRate) {
     if (oldRate == newRate || oldRate <= 0 || newRate <= 0) return;
 
-    for (auto& slot : playingSounds_) {
+    for (int i = 0; i < numVoices_; i++) {
+        auto& slot = voices_[i];
         if (!slot || !slot->buffer) continue;
         if (!slot->playing && !slot->paused) continue;
 
@@ -810,44 +1568,52 @@ void AudioEngine::migrateVoicesToNewRate(int oldRate, int newRate) {
             slot->rateRatio = (slot->buffer->sampleRate > 0)
                 ? ((float)slot->buffer->sampleRate / (float)newRate)
                 : 1.0f;
+        } else if (slot->buffer->kind() == SoundSource::Synth) {
+            // Synth voice — a fresh instance at the new rate, sought to the
+            // same time (notes sounding there restart mid-way).
+            auto* src = static_cast<SoundSynth*>(slot->buffer.get());
+            const double tSec = std::max(0.0, slot->positionF / (double)oldRate);
+            auto synth = src->createInstance(newRate);
+            if (!synth) {
+                slot->playing = false;
+                slot->synth.reset();
+                continue;
+            }
+            src->sampleRate = newRate;
+            synth->seek(tSec * (double)newRate);
+            slot->synth = std::move(synth);
+            slot->positionF = slot->synth->getPosition();
         } else {
-            // Streaming voice — rebuild the per-voice decoder.
+            // Streaming voice — re-open the stream's shared decoder at the
+            // new rate (once per stream) and rebuild the voice's ring.
             auto* src = static_cast<SoundStream*>(slot->buffer.get());
 
             // Current playback time in seconds, derived from the old engine rate.
             double tSec = slot->positionF / (double)oldRate;
             if (tSec < 0.0) tSec = 0.0;
 
-            // Build a fresh StreamInstance + decoder at the new rate.
-            auto newStream = std::make_shared<StreamInstance>();
-            ma_decoder_config cfg = ma_decoder_config_init(
-                ma_format_f32, StreamInstance::CHANNELS, newRate);
-            cfg.encodingFormat = (ma_encoding_format)src->encodingFormatHint_;
-            ma_result r = maDecoderInitPathA(src->path_, &cfg, &newStream->decoder);
+            ma_result r = src->cache_ ? src->cache_->setSampleRate(newRate) : MA_ERROR;
             if (r != MA_SUCCESS) {
                 printf("AudioEngine: stream voice migration failed for %s (result=%d) — stopping voice\n",
                        src->getPath().c_str(), (int)r);
                 slot->playing = false;
-                // Drop the stale stream so its old decoder is destroyed.
+                if (slot->stream) slot->stream->disposed.store(true, std::memory_order_release);
                 slot->stream.reset();
                 continue;
             }
-            newStream->decoderInitialized = true;
-
-            // Seek to the same wall-clock time in the new decoder's output frames.
-            ma_uint64 seekFrames = (ma_uint64)(tSec * (double)newRate);
-            ma_decoder_seek_to_pcm_frame(&newStream->decoder, seekFrames);
+            src->sampleRate = newRate;
 
-            ma_uint64 total = 0;
-            ma_decoder_get_length_in_pcm_frames(&newStream->decoder, &total);
-            newStream->totalFramesInFile = (uint64_t)total;
+            // Start the new ring at the same wall-clock time in new-rate frames.
+            auto newStream = std::make_shared<StreamInstance>();
+            newStream->cache = src->cache_;
+            newStream->totalFramesInFile = src->cache_->getTotalFrames();
+            newStream->sourceFrame = (uint64_t)(tSec * (double)newRate);
             newStream->subFrame = 0.0;
             // writeFrame / readFrame default to 0; ring will be filled fresh by worker.
 
-            // Swap in the new stream. The old StreamInstance's shared_ptr
-            // refcount drops; if the worker still holds it locally via
-            // refillOne's `sp`, it survives until that call returns, then
-            // ~StreamInstance kills the old decoder.
+            // Swap in the new stream. The old instance is retired from the
+            // workers; one still mid-refill keeps it alive until it returns.
+            if (slot->stream) slot->stream->disposed.store(true, std::memory_order_release);
             slot->stream = newStream;
             StreamWorker::getInstance().registerStream(newStream);
 
@@ -877,7 +1643,31 @@ void AudioEngine::shutdown() {
 }
 
 void AudioEngine::mixAudio(float* buffer, int num_frames, int num_channels) {
+    using Clock = std::chrono::steady_clock;
+    const int64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+
     mixAudioInternal(buffer, num_frames, num_channels);
+
+    const int64_t end = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+    const int64_t blockNs = sampleRate_ > 0
+        ? (int64_t)num_frames * 1000000000 / sampleRate_ : 0;
+    if (blockNs > 0) {
+        const float load = (float)(end - start) / (float)blockNs;
+        if (load > statPeakLoad_.load(std::memory_order_relaxed)) {
+            statPeakLoad_.store(load, std::memory_order_relaxed);
+        }
+        if (load > 1.0f) statLate_.fetch_add(1, std::memory_order_relaxed);
+        // A gap of more than two blocks since the previous callback means
+        // the device ran dry (or the OS didn't schedule us in time).
+        if (lastCallbackNs_ != 0 && start - lastCallbackNs_ > 2 * std::max(blockNs, lastBlockNs_)) {
+            statXruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    lastCallbackNs_ = start;
+    lastBlockNs_ = blockNs;
+    statCallbacks_.fetch_add(1, std::memory_order_relaxed);
 }
 
 // ---------------------------------------------------------------------------
@@ -17,11 +17,29 @@
 //   Sound song = melody.build();
 //   song.setLoop(true);
 //   song.play();
+//
+//   // Same melody synthesized live in the mixer (no pre-rendered PCM)
+//   auto synth = std::make_shared<ChipSoundSynth>(melody);
+//   Sound live;
+//   live.loadSynth(synth);
+//   live.setLoop(true);
+//   live.play();
+//   synth->setTempo(1.5f);                 // any time, takes effect next block
+//   synth->trigger({ Wave::Noise, 0, 0.05f });   // one-off note, now
+//
+// build() renders every note into a SoundBuffer up front: the whole song as
+// PCM, ready before play() returns. ChipSoundSynth renders the same voices
+// (same oscillators and ADSR) block by block on the audio thread instead, so
+// it costs a few hundred bytes per voice whatever the song length, starts
+// instantly and can be re-pitched / re-timed while it plays.
 // =============================================================================
 
 #include "tcSound.h"
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
 
 namespace trussc {
 
@@ -43,6 +61,10 @@ struct ChipSoundNote {
     float sustain = 0.7f;       // sustain level
     float release = 0.05f;
 
+    // Chip extras
+    float duty = 0.5f;          // Square: fraction of the period spent high (0.125 / 0.25 = NES pulse)
+    float sweep = 0.0f;         // pitch slide in semitones per second (+ up, - down)
+
     // Constructors
     ChipSoundNote() = default;
 
@@ -61,30 +83,18 @@ struct ChipSoundNote {
     }
 
     // Generate raw buffer (without ADSR, for Bundle mixing)
-    void generateBuffer(SoundBuffer& buf) const {
-        switch (wave) {
-            case Wave::Sin:
-                buf.generateSineWave(hz, duration, volume);
-                break;
-            case Wave::Square:
-                buf.generateSquareWave(hz, duration, volume);
-                break;
-            case Wave::Triangle:
-                buf.generateTriangleWave(hz, duration, volume);
-                break;
-            case Wave::Sawtooth:
-                buf.generateSawtoothWave(hz, duration, volume);
-                break;
-            case Wave::Noise:
-                buf.generateNoise(duration, volume);
-                break;
-            case Wave::PinkNoise:
-                buf.generatePinkNoise(duration, volume);
-                break;
-            case Wave::Silent:
-                buf.generateSilence(duration);
-                break;
-        }
+    void generateBuffer(SoundBuffer& buf) const;
+
+    // Envelope gain `t` seconds into the note: the SoundBuffer::applyADSR()
+    // shape over `duration` (release ends at duration).
+    float envelopeAt(float t) const {
+        float sustainTime = duration - attack - decay - release;
+        if (sustainTime < 0) sustainTime = 0;
+        if (t < attack) return t / attack;
+        if (t < attack + decay) return 1.0f - (1.0f - sustain) * ((t - attack) / decay);
+        if (t < attack + decay + sustainTime) return sustain;
+        float envelope = sustain * (1.0f - (t - (attack + decay + sustainTime)) / release);
+        return envelope < 0 ? 0 : envelope;
     }
 
     // Total duration including release
@@ -96,6 +106,120 @@ struct ChipSoundNote {
 // Convenience alias
 using Wave = ChipSoundNote::Wave;
 
+// ---------------------------------------------------------------------------
+// ChipVoice - one oscillator + envelope, shared by the offline build() path
+// and ChipSoundSynth. Plain data, no allocation.
+// ---------------------------------------------------------------------------
+namespace internal {
+
+struct ChipVoice {
+    ChipSoundNote note;
+    double time = 0.0;     // seconds into the note
+    double phase = 0.0;    // oscillator phase in cycles, [0, 1)
+    double hz = 0.0;       // current frequency (sweep applied)
+    float gain = 1.0f;
+    uint32_t seed = 12345;
+    float pink[7] = {};
+    uint64_t order = 0;    // start order, for voice stealing
+    bool active = false;
+
+    // Start `elapsed` seconds into the note (a seek landing mid-note).
+    void start(const ChipSoundNote& n, float g, double elapsed, uint64_t startOrder) {
+        note = n;
+        time = elapsed;
+        phase = 0.0;
+        hz = n.sweep != 0.0f ? n.hz * std::exp2(n.sweep * elapsed / 12.0) : n.hz;
+        gain = g;
+        seed = 12345;
+        std::fill(std::begin(pink), std::end(pink), 0.0f);
+        order = startOrder;
+        active = true;
+    }
+
+    // Add `n` frames to out. dt = note seconds per frame, cyclesPerHz =
+    // oscillator cycles per Hz per frame (1 / rate, times pitch and speed).
+    // With `envelope` the note's ADSR applies and the voice ends at its
+    // duration; without, it runs raw for as long as asked.
+    void render(float* out, size_t n, double dt, double cyclesPerHz, bool envelope) {
+        const double sweepStep = note.sweep != 0.0f ? std::exp2(note.sweep * dt / 12.0) : 1.0;
+        const float amp = note.volume * gain;
+        for (size_t i = 0; i < n; i++) {
+            // A frame plays only if it ends inside the note, so the voice
+            // spans floor(duration * rate) frames like the offline buffer.
+            if (envelope && time + dt > note.duration + 1e-9) {
+                active = false;
+                return;
+            }
+            const float p = (float)phase;
+            float v = 0.0f;
+            switch (note.wave) {
+                case Wave::Sin:      v = std::sin(TAU * p); break;
+                case Wave::Square:   v = p < note.duty ? 1.0f : -1.0f; break;
+                case Wave::Triangle: v = p < 0.5f ? (4.0f * p - 1.0f) : (3.0f - 4.0f * p); break;
+                case Wave::Sawtooth: v = 2.0f * p - 1.0f; break;
+                case Wave::Noise:    v = nextWhite(); break;
+                case Wave::PinkNoise: v = nextPink(); break;
+                case Wave::Silent:   break;
+            }
+            if (envelope) v *= note.envelopeAt((float)time);
+            out[i] += amp * v;
+
+            phase += hz * cyclesPerHz;
+            if (phase >= 1.0) phase -= std::floor(phase);
+            hz *= sweepStep;
+            time += dt;
+        }
+    }
+
+    // Advance `n` frames without output (virtual voices).
+    void skip(size_t n, double dt, double cyclesPerHz) {
+        const double span = dt * (double)n;
+        if (time + span >= note.duration) {
+            active = false;
+            return;
+        }
+        phase += hz * cyclesPerHz * (double)n;
+        phase -= std::floor(phase);
+        if (note.sweep != 0.0f) hz *= std::exp2(note.sweep * span / 12.0);
+        time += span;
+    }
+
+private:
+    // Same generators as SoundBuffer::generateNoise() / generatePinkNoise().
+    float nextWhite() {
+        seed = seed * 1103515245 + 12345;
+        return ((seed >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+    }
+
+    float nextPink() {
+        const float white = nextWhite();
+        float* b = pink;
+        b[0] = 0.99886f * b[0] + white * 0.0555179f;
+        b[1] = 0.99332f * b[1] + white * 0.0750759f;
+        b[2] = 0.96900f * b[2] + white * 0.1538520f;
+        b[3] = 0.86650f * b[3] + white * 0.3104856f;
+        b[4] = 0.55000f * b[4] + white * 0.5329522f;
+        b[5] = -0.7616f * b[5] - white * 0.0168980f;
+        const float value = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f;
+        b[6] = white * 0.115926f;
+        return value * 0.11f;
+    }
+};
+
+} // namespace internal
+
+inline void ChipSoundNote::generateBuffer(SoundBuffer& buf) const {
+    constexpr int sampleRate = 44100;
+    buf.sampleRate = sampleRate;
+    buf.channels = 1;
+    buf.numSamples = (size_t)(duration * sampleRate);
+    buf.samples.assign(buf.numSamples, 0.0f);
+
+    internal::ChipVoice voice;
+    voice.start(*this, 1.0f, 0.0, 0);
+    voice.render(buf.samples.data(), buf.numSamples, 1.0 / sampleRate, 1.0 / sampleRate, false);
+}
+
 // ---------------------------------------------------------------------------
 // ChipSoundBundle - Multiple notes with timing
 // ---------------------------------------------------------------------------
@@ -169,4 +293,209 @@ struct ChipSoundBundle {
     }
 };
 
+// ---------------------------------------------------------------------------
+// ChipSoundSynth - ChipSound voices synthesized live in the mixer
+// ---------------------------------------------------------------------------
+//
+// A SoundSynth that plays a ChipSoundBundle (optional) plus notes sent with
+// trigger(), with at most maxVoices sounding at once (the oldest note is cut
+// when a new one needs a voice). Notes start on the exact output frame their
+// time falls on, whatever the device block size.
+//
+// Differences from build():
+//   - The sequence is shared, never rendered: each playing instance holds
+//     only its voices, so memory does not grow with the song.
+//   - setPitch() / setTempo() change a playing sound from the next block.
+//   - Sound::setSpeed() works like tape (time and pitch), limited to [0, 10].
+//   - No clip() of its own; the engine's output stage clips as usual.
+//
+// With an empty sequence the sound has no length (getDuration() == 0) and
+// plays until stopped, voicing only triggered notes.
+namespace internal { class ChipSynthInstance; }
+
+class ChipSoundSynth : public SoundSynth {
+public:
+    static constexpr int DEFAULT_VOICES = 16;
+    static constexpr int TRIGGER_QUEUE_SIZE = 64;
+
+    explicit ChipSoundSynth(int maxVoices = DEFAULT_VOICES)
+        : ChipSoundSynth(ChipSoundBundle{}, maxVoices) {}
+
+    explicit ChipSoundSynth(const ChipSoundBundle& sequence, int maxVoices = DEFAULT_VOICES)
+        : maxVoices_(std::max(1, maxVoices)) {
+        channels = 1;
+        auto entries = sequence.entries;
+        for (auto& e : entries) {
+            e.time = std::max(0.0f, e.time);
+            maxNoteLength_ = std::max(maxNoteLength_, e.note.duration);
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const auto& a, const auto& b) { return a.time < b.time; });
+        sequence_ = std::make_shared<const std::vector<ChipSoundBundle::Entry>>(std::move(entries));
+        duration_ = sequence.getDuration();
+        gain_ = sequence.volume;
+    }
+
+    // Transpose every voice by `semitones` (fractional = pitch bend).
+    void setPitch(float semitones) { pitch_.store(semitones, std::memory_order_relaxed); }
+    float getPitch() const { return pitch_.load(std::memory_order_relaxed); }
+
+    // Sequence rate: note start times and lengths run `rate` times as fast,
+    // pitch unchanged. 0 holds every note where it is.
+    void setTempo(float rate) { tempo_.store(std::max(0.0f, rate), std::memory_order_relaxed); }
+    float getTempo() const { return tempo_.load(std::memory_order_relaxed); }
+
+    // Start a note at the beginning of the next block. Call from one thread
+    // (typically the app thread). Notes sent while nothing plays wait for
+    // the next play(). Returns false when TRIGGER_QUEUE_SIZE notes are
+    // already waiting.
+    bool trigger(const ChipSoundNote& note) {
+        ChipSoundNote n = note;
+        return triggers_.push(std::move(n));
+    }
+
+    int getMaxVoices() const { return maxVoices_; }
+
+    float getDuration() const override { return duration_; }
+
+    std::shared_ptr<SoundSynthInstance> createInstance(int sampleRate) override;
+
+private:
+    friend class internal::ChipSynthInstance;
+
+    std::shared_ptr<const std::vector<ChipSoundBundle::Entry>> sequence_;  // by time
+    float duration_ = 0.0f;
+    float maxNoteLength_ = 0.0f;
+    float gain_ = 1.0f;
+    int maxVoices_;
+    std::atomic<float> pitch_{0.0f};
+    std::atomic<float> tempo_{1.0f};
+    internal::SpscQueue<ChipSoundNote> triggers_{TRIGGER_QUEUE_SIZE};
+};
+
+namespace internal {
+
+// One playing ChipSoundSynth: its voices and its place in the sequence.
+class ChipSynthInstance : public SoundSynthInstance {
+public:
+    ChipSynthInstance(ChipSoundSynth& synth, int sampleRate)
+        : synth_(synth), sequence_(synth.sequence_), rate_((double)sampleRate),
+          // Whole frames, rounded the way build() sizes its buffer.
+          length_((double)(size_t)(synth.duration_ * (float)sampleRate) / rate_),
+          voices_((size_t)synth.maxVoices_) {}
+
+    int render(float* out, int frames, double speed, bool loop) override {
+        std::fill(out, out + frames, 0.0f);
+        return process(out, frames, speed, loop);
+    }
+
+    int skip(int frames, double speed, bool loop) override {
+        return process(nullptr, frames, speed, loop);
+    }
+
+    void seek(double frame) override {
+        for (auto& v : voices_) v.active = false;
+        const auto& seq = *sequence_;
+        time_ = std::max(0.0, frame / rate_);
+        if (!seq.empty()) time_ = std::min(time_, length_);
+        cursor_ = (size_t)(std::lower_bound(seq.begin(), seq.end(), time_,
+                               [](const ChipSoundBundle::Entry& e, double t) { return e.time < t; })
+                           - seq.begin());
+        // Notes that began earlier and still sound here resume mid-way.
+        for (size_t i = cursor_; i-- > 0; ) {
+            if (seq[i].time + synth_.maxNoteLength_ <= time_) break;
+            if (seq[i].time + seq[i].note.duration > time_) {
+                startVoice(seq[i].note, time_ - seq[i].time);
+            }
+        }
+    }
+
+    double getPosition() const override { return time_ * rate_; }
+
+private:
+    int process(float* out, int frames, double speed, bool loop) {
+        ChipSoundNote note;
+        while (synth_.triggers_.pop(note)) startVoice(note, 0.0);
+
+        const double tempo = synth_.tempo_.load(std::memory_order_relaxed);
+        const double pitch = std::exp2(synth_.pitch_.load(std::memory_order_relaxed) / 12.0);
+        const double dt = speed * tempo / rate_;           // sequence seconds per frame
+        const double cyclesPerHz = speed * pitch / rate_;
+        const auto& seq = *sequence_;
+        const double length = length_;
+
+        int done = 0;
+        while (done < frames) {
+            // Like a voice, the sequence spans the frames that end inside
+            // it: at speed 1, as many as build() makes.
+            if (!seq.empty() && time_ + std::max(dt, 0.0) > length + EPSILON) {
+                if (!loop || length <= 0.0) return done;
+                time_ = time_ > length ? std::fmod(time_ - length, length) : 0.0;
+                cursor_ = 0;
+            }
+            // EPSILON: time_ is a running sum, so a start that falls exactly
+            // on a frame may be reached a hair early and must not slip to
+            // the next one.
+            while (cursor_ < seq.size() && seq[cursor_].time <= time_ + EPSILON) {
+                startVoice(seq[cursor_].note, std::max(0.0, time_ - seq[cursor_].time));
+                ++cursor_;
+            }
+
+            // Run up to the next note start (the frame whose time first
+            // reaches it) or the end of the sequence.
+            int run = frames - done;
+            double boundary = -1.0;
+            if (dt > 0.0 && cursor_ < seq.size()) {
+                const double next = seq[cursor_].time;
+                const double until = std::ceil((next - EPSILON - time_) / dt);
+                if (until < (double)run) {
+                    run = std::max(1, (int)until);
+                    boundary = next;
+                }
+            } else if (dt > 0.0 && !seq.empty()) {
+                const double until = std::floor((length + EPSILON - time_) / dt);
+                if (until < (double)run) run = std::max(1, (int)until);
+            }
+
+            for (auto& v : voices_) {
+                if (!v.active) continue;
+                if (out) v.render(out + done, (size_t)run, dt, cyclesPerHz, true);
+                else v.skip((size_t)run, dt, cyclesPerHz);
+            }
+            time_ += dt * run;
+            if (boundary >= 0.0) time_ = std::max(time_, boundary);  // absorb rounding
+            done += run;
+        }
+        return done;
+    }
+
+    void startVoice(const ChipSoundNote& note, double elapsed) {
+        if (note.wave == Wave::Silent || elapsed >= note.duration) return;
+        ChipVoice* slot = nullptr;
+        for (auto& v : voices_) {
+            if (!v.active) { slot = &v; break; }
+            if (!slot || v.order < slot->order) slot = &v;
+        }
+        slot->start(note, synth_.gain_, elapsed, ++order_);
+    }
+
+    static constexpr double EPSILON = 1e-9;   // seconds, far below one frame
+
+    ChipSoundSynth& synth_;
+    std::shared_ptr<const std::vector<ChipSoundBundle::Entry>> sequence_;
+    double rate_;
+    double length_;          // sequence seconds
+    double time_ = 0.0;      // sequence seconds
+    size_t cursor_ = 0;      // next entry to start
+    uint64_t order_ = 0;
+    std::vector<ChipVoice> voices_;
+};
+
+} // namespace internal
+
+inline std::shared_ptr<SoundSynthInstance> ChipSoundSynth::createInstance(int sampleRate) {
+    if (sampleRate <= 0) return nullptr;
+    return std::make_shared<internal::ChipSynthInstance>(*this, sampleRate);
+}
+
 } // namespace trussc
@@ -0,0 +1,406 @@
+// =============================================================================
+// tcFlacEncoder.cpp - FlacEncoder implementation
+// =============================================================================
+
+#include "tc/sound/tcFlacEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace trussc {
+
+namespace {
+
+constexpr int MAX_FIXED_ORDER = 4;
+constexpr int MAX_PARTITION_ORDER = 8;
+
+constexpr std::array<std::uint8_t, 256> makeCrc8() {
+    std::array<std::uint8_t, 256> t{};
+    for (int i = 0; i < 256; i++) {
+        std::uint8_t c = (std::uint8_t)i;
+        for (int b = 0; b < 8; b++) c = (std::uint8_t)((c & 0x80) ? (c << 1) ^ 0x07 : c << 1);
+        t[(size_t)i] = c;
+    }
+    return t;
+}
+
+constexpr std::array<std::uint16_t, 256> makeCrc16() {
+    std::array<std::uint16_t, 256> t{};
+    for (int i = 0; i < 256; i++) {
+        std::uint16_t c = (std::uint16_t)(i << 8);
+        for (int b = 0; b < 8; b++) c = (std::uint16_t)((c & 0x8000) ? (c << 1) ^ 0x8005 : c << 1);
+        t[(size_t)i] = c;
+    }
+    return t;
+}
+
+constexpr auto CRC8 = makeCrc8();
+constexpr auto CRC16 = makeCrc16();
+
+std::uint8_t crc8(const std::uint8_t* p, std::size_t n) {
+    std::uint8_t c = 0;
+    for (std::size_t i = 0; i < n; i++) c = CRC8[c ^ p[i]];
+    return c;
+}
+
+std::uint16_t crc16(const std::uint8_t* p, std::size_t n) {
+    std::uint16_t c = 0;
+    for (std::size_t i = 0; i < n; i++) c = (std::uint16_t)((c << 8) ^ CRC16[(c >> 8) ^ p[i]]);
+    return c;
+}
+
+// Fixed-predictor residual of order 0-4, zig-zag folded to unsigned.
+inline std::uint32_t fold(std::int64_t e) {
+    const std::int32_t v = (std::int32_t)e;
+    return ((std::uint32_t)v << 1) ^ (std::uint32_t)(v >> 31);
+}
+
+void fixedResidual(const std::int32_t* x, int n, int order, std::uint32_t* out) {
+    switch (order) {
+    case 0:
+        for (int i = 0; i < n; i++) out[i] = fold(x[i]);
+        break;
+    case 1:
+        for (int i = 1; i < n; i++) out[i] = fold((std::int64_t)x[i] - x[i - 1]);
+        break;
+    case 2:
+        for (int i = 2; i < n; i++) out[i] = fold((std::int64_t)x[i] - 2 * (std::int64_t)x[i - 1] + x[i - 2]);
+        break;
+    case 3:
+        for (int i = 3; i < n; i++) {
+            out[i] = fold((std::int64_t)x[i] - 3 * ((std::int64_t)x[i - 1] - x[i - 2]) - x[i - 3]);
+        }
+        break;
+    default:
+        for (int i = 4; i < n; i++) {
+            out[i] = fold((std::int64_t)x[i] - 4 * ((std::int64_t)x[i - 1] + x[i - 3])
+                          + 6 * (std::int64_t)x[i - 2] + x[i - 4]);
+        }
+        break;
+    }
+}
+
+// Best Rice parameter for a partition of `count` values summing to `sum`,
+// and its cost in bits. sum >> k over-counts sum(u >> k) by < count, so the
+// cost is an upper bound and the chosen encoding never exceeds it.
+inline int riceParam(std::uint64_t sum, std::uint32_t count, int maxK, std::uint64_t& bits) {
+    if (count == 0) {
+        bits = 0;
+        return 0;
+    }
+    const std::uint64_t mean = sum / count;
+    int k0 = 0;
+    while (k0 < maxK && (std::uint64_t(1) << (k0 + 1)) <= mean) k0++;
+    int best = k0;
+    bits = ~std::uint64_t(0);
+    for (int k = std::max(0, k0 - 1); k <= std::min(maxK, k0 + 1); k++) {
+        const std::uint64_t b = (std::uint64_t)count * (std::uint64_t)(k + 1) + (sum >> k);
+        if (b < bits) {
+            bits = b;
+            best = k;
+        }
+    }
+    return best;
+}
+
+int maxPartitionOrder(int n, int order) {
+    int p = 0;
+    while (p < MAX_PARTITION_ORDER && (n % (2 << p)) == 0 && (n >> (p + 1)) > order) p++;
+    return p;
+}
+
+int blockSizeCode(int frames) {
+    if (frames == 192) return 1;
+    for (int c = 2; c <= 5; c++) if (frames == 576 << (c - 2)) return c;
+    for (int c = 8; c <= 15; c++) if (frames == 256 << (c - 8)) return c;
+    return frames <= 256 ? 6 : 7;
+}
+
+int sampleRateCode(int rate) {
+    switch (rate) {
+    case 88200:  return 1;
+    case 176400: return 2;
+    case 192000: return 3;
+    case 8000:   return 4;
+    case 16000:  return 5;
+    case 22050:  return 6;
+    case 24000:  return 7;
+    case 32000:  return 8;
+    case 44100:  return 9;
+    case 48000:  return 10;
+    case 96000:  return 11;
+    default:     return 0;   // from STREAMINFO
+    }
+}
+
+int sampleSizeCode(int bits) {
+    switch (bits) {
+    case 8:  return 1;
+    case 12: return 2;
+    case 16: return 4;
+    case 20: return 5;
+    case 24: return 6;
+    default: return 0;       // from STREAMINFO
+    }
+}
+
+} // namespace
+
+bool FlacEncoder::setup(int sampleRate, int channels, int bitsPerSample, int blockSize) {
+    channels_ = 0;
+    if (sampleRate <= 0 || sampleRate > 655350 || channels < 1 || channels > 8 ||
+        bitsPerSample < 8 || bitsPerSample > 24 || blockSize < 16 || blockSize > 65535) {
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    bits_ = bitsPerSample;
+    blockSize_ = blockSize;
+    frameNumber_ = 0;
+    totalFrames_ = 0;
+    minFrameBytes_ = maxFrameBytes_ = 0;
+
+    // Stereo also keeps mid and side planes.
+    planes_.assign((size_t)(channels == 2 ? 4 : channels) * (size_t)blockSize, 0);
+    residual_.assign((size_t)blockSize, 0);
+    sums_.assign((size_t)1 << MAX_PARTITION_ORDER, 0);
+
+    // Worst case is verbatim (the encoder never picks anything larger):
+    // frame header <= 16 bytes, 1-byte subframe headers, side at bits + 1,
+    // CRC-16, plus slack for the bit writer.
+    out_.assign(16 + (size_t)channels * (1 + ((size_t)(bitsPerSample + 1) * blockSize + 7) / 8) + 2 + 8, 0);
+    return true;
+}
+
+void FlacEncoder::put(std::uint32_t value, int bits) {
+    if (bits == 0) return;
+    acc_ = (acc_ << bits) | (value & maskOf(bits));
+    accBits_ += bits;
+    while (accBits_ >= 8) {
+        accBits_ -= 8;
+        out_[pos_++] = (std::uint8_t)(acc_ >> accBits_);
+    }
+}
+
+void FlacEncoder::putRice(std::uint32_t u, int k) {
+    std::uint32_t q = u >> k;
+    while (q >= 31) {
+        put(0, 31);
+        q -= 31;
+    }
+    put(1, (int)q + 1);   // q zeros, then the stop bit
+    put(u, k);
+}
+
+void FlacEncoder::alignByte() {
+    if (accBits_ > 0) put(0, 8 - accBits_);
+}
+
+FlacEncoder::Subframe FlacEncoder::analyze(const std::int32_t* x, int n, int bits) {
+    Subframe best;
+    best.type = 1;
+    best.bits = 8 + (std::uint64_t)n * (std::uint64_t)bits;
+
+    bool constant = true;
+    for (int i = 1; i < n && constant; i++) constant = x[i] == x[0];
+    if (constant) {
+        best.type = 0;
+        best.bits = 8 + (std::uint64_t)bits;
+        return best;
+    }
+
+    for (int order = 0; order <= std::min(MAX_FIXED_ORDER, n - 1); order++) {
+        fixedResidual(x, n, order, residual_.data());
+        const int pMax = maxPartitionOrder(n, order);
+        const int parts = 1 << pMax;
+        const int partLen = n >> pMax;
+        for (int p = 0; p < parts; p++) {
+            std::uint64_t s = 0;
+            for (int i = std::max(p * partLen, order); i < (p + 1) * partLen; i++) s += residual_[(size_t)i];
+            sums_[(size_t)p] = s;
+        }
+        // Merge pairs upwards, costing each partition order on the way.
+        for (int po = pMax; po >= 0; po--) {
+            const int count = 1 << po;
+            const int len = n >> po;
+            std::uint64_t data = 0;
+            int maxK = 0;
+            for (int p = 0; p < count; p++) {
+                std::uint64_t b;
+                const std::uint32_t samples = (std::uint32_t)(p == 0 ? len - order : len);
+                maxK = std::max(maxK, riceParam(sums_[(size_t)p], samples, 30, b));
+                data += b;
+            }
+            const std::uint64_t total = 8 + (std::uint64_t)order * (std::uint64_t)bits + 2 + 4
+                                      + (std::uint64_t)count * (maxK > 14 ? 5 : 4) + data;
+            if (total < best.bits) {
+                best.type = 2;
+                best.order = order;
+                best.partitionOrder = po;
+                best.bits = total;
+            }
+            if (po > 0) {
+                for (int p = 0; p < count / 2; p++) sums_[(size_t)p] = sums_[(size_t)(2 * p)] + sums_[(size_t)(2 * p + 1)];
+            }
+        }
+    }
+    return best;
+}
+
+void FlacEncoder::writeSubframe(const std::int32_t* x, int n, int bits, const Subframe& sf) {
+    put(0, 1);
+    if (sf.type == 0) {
+        put(0, 6);
+        put(0, 1);
+        putSigned(x[0], bits);
+        return;
+    }
+    if (sf.type == 1) {
+        put(1, 6);
+        put(0, 1);
+        for (int i = 0; i < n; i++) putSigned(x[i], bits);
+        return;
+    }
+
+    put(8 | (std::uint32_t)sf.order, 6);
+    put(0, 1);
+    for (int i = 0; i < sf.order; i++) putSigned(x[i], bits);
+
+    fixedResidual(x, n, sf.order, residual_.data());
+    const int count = 1 << sf.partitionOrder;
+    const int len = n >> sf.partitionOrder;
+    int ks[1 << MAX_PARTITION_ORDER];
+    int maxK = 0;
+    for (int p = 0; p < count; p++) {
+        const int begin = p == 0 ? sf.order : p * len;
+        std::uint64_t s = 0;
+        for (int i = begin; i < (p + 1) * len; i++) s += residual_[(size_t)i];
+        std::uint64_t unused;
+        ks[p] = riceParam(s, (std::uint32_t)((p + 1) * len - begin), 30, unused);
+        maxK = std::max(maxK, ks[p]);
+    }
+    const bool wide = maxK > 14;
+    put(wide ? 1 : 0, 2);
+    put((std::uint32_t)sf.partitionOrder, 4);
+    for (int p = 0; p < count; p++) {
+        put((std::uint32_t)ks[p], wide ? 5 : 4);
+        for (int i = p == 0 ? sf.order : p * len; i < (p + 1) * len; i++) putRice(residual_[(size_t)i], ks[p]);
+    }
+}
+
+std::size_t FlacEncoder::encode(const std::int32_t* interleaved, int frames) {
+    if (channels_ == 0 || frames <= 0 || frames > blockSize_) return 0;
+    const int n = frames;
+    const std::size_t stride = (std::size_t)blockSize_;
+
+    for (int c = 0; c < channels_; c++) {
+        std::int32_t* plane = planes_.data() + (size_t)c * stride;
+        for (int i = 0; i < n; i++) plane[i] = interleaved[(size_t)i * channels_ + c];
+    }
+
+    // Channel assignment and per-channel choices.
+    int assignment = channels_ - 1;
+    const std::int32_t* src[8];
+    int srcBits[8];
+    Subframe sub[8];
+    for (int c = 0; c < channels_; c++) {
+        src[c] = planes_.data() + (size_t)c * stride;
+        srcBits[c] = bits_;
+        sub[c] = analyze(src[c], n, bits_);
+    }
+    if (channels_ == 2) {
+        const std::int32_t* l = planes_.data();
+        const std::int32_t* r = planes_.data() + stride;
+        std::int32_t* mid = planes_.data() + 2 * stride;
+        std::int32_t* side = planes_.data() + 3 * stride;
+        for (int i = 0; i < n; i++) {
+            mid[i] = (std::int32_t)(((std::int64_t)l[i] + r[i]) >> 1);
+            side[i] = l[i] - r[i];
+        }
+        const Subframe m = analyze(mid, n, bits_);
+        const Subframe s = analyze(side, n, bits_ + 1);
+        const std::uint64_t costs[4] = {
+            sub[0].bits + sub[1].bits,   // independent
+            sub[0].bits + s.bits,        // left / side
+            s.bits + sub[1].bits,        // side / right
+            m.bits + s.bits,             // mid / side
+        };
+        const int best = (int)(std::min_element(costs, costs + 4) - costs);
+        if (best == 1) {
+            assignment = 8;
+            src[1] = side; srcBits[1] = bits_ + 1; sub[1] = s;
+        } else if (best == 2) {
+            assignment = 9;
+            src[0] = side; srcBits[0] = bits_ + 1; sub[0] = s;
+        } else if (best == 3) {
+            assignment = 10;
+            src[0] = mid; sub[0] = m;
+            src[1] = side; srcBits[1] = bits_ + 1; sub[1] = s;
+        }
+    }
+
+    // Frame header.
+    pos_ = 0;
+    acc_ = 0;
+    accBits_ = 0;
+    const int bsCode = blockSizeCode(n);
+    put(0x3FFE, 14);
+    put(0, 1);                          // reserved
+    put(0, 1);                          // fixed block size
+    put((std::uint32_t)bsCode, 4);
+    put((std::uint32_t)sampleRateCode(sampleRate_), 4);
+    put((std::uint32_t)assignment, 4);
+    put((std::uint32_t)sampleSizeCode(bits_), 3);
+    put(0, 1);
+    // Frame number, UTF-8 style.
+    const std::uint64_t fn = frameNumber_;
+    if (fn < 0x80) {
+        put((std::uint32_t)fn, 8);
+    } else {
+        int extra = fn < 0x800 ? 1 : fn < 0x10000 ? 2 : fn < 0x200000 ? 3
+                  : fn < 0x4000000 ? 4 : fn < 0x80000000ull ? 5 : 6;
+        const std::uint32_t lead = (0xFF00u >> (extra + 1)) & 0xFFu;
+        put(lead | (std::uint32_t)(fn >> (6 * extra)), 8);
+        for (int i = extra - 1; i >= 0; i--) put(0x80u | (std::uint32_t)((fn >> (6 * i)) & 0x3F), 8);
+    }
+    if (bsCode == 6) put((std::uint32_t)(n - 1), 8);
+    if (bsCode == 7) put((std::uint32_t)(n - 1), 16);
+    put(crc8(out_.data(), pos_), 8);
+
+    for (int c = 0; c < channels_; c++) writeSubframe(src[c], n, srcBits[c], sub[c]);
+
+    alignByte();
+    const std::uint16_t crc = crc16(out_.data(), pos_);
+    put(crc, 16);
+
+    frameNumber_++;
+    totalFrames_ += (std::uint64_t)n;
+    const std::uint32_t bytes = (std::uint32_t)pos_;
+    minFrameBytes_ = minFrameBytes_ == 0 ? bytes : std::min(minFrameBytes_, bytes);
+    maxFrameBytes_ = std::max(maxFrameBytes_, bytes);
+    return pos_;
+}
+
+const std::uint8_t* FlacEncoder::getHeader() {
+    std::uint8_t* h = header_;
+    std::memcpy(h, "fLaC", 4);
+    h[4] = 0x80;                        // last metadata block, STREAMINFO
+    h[5] = 0; h[6] = 0; h[7] = 34;
+    std::uint8_t* s = h + 8;
+    const std::uint32_t bs = (std::uint32_t)blockSize_;
+    s[0] = (std::uint8_t)(bs >> 8); s[1] = (std::uint8_t)bs;      // min block size
+    s[2] = (std::uint8_t)(bs >> 8); s[3] = (std::uint8_t)bs;      // max block size
+    s[4] = (std::uint8_t)(minFrameBytes_ >> 16); s[5] = (std::uint8_t)(minFrameBytes_ >> 8); s[6] = (std::uint8_t)minFrameBytes_;
+    s[7] = (std::uint8_t)(maxFrameBytes_ >> 16); s[8] = (std::uint8_t)(maxFrameBytes_ >> 8); s[9] = (std::uint8_t)maxFrameBytes_;
+    // 20 bits rate | 3 bits channels - 1 | 5 bits bps - 1 | 36 bits total.
+    const std::uint64_t packed = ((std::uint64_t)sampleRate_ << 44)
+                               | ((std::uint64_t)(channels_ - 1) << 41)
+                               | ((std::uint64_t)(bits_ - 1) << 36)
+                               | (totalFrames_ & 0xFFFFFFFFFull);
+    for (int i = 0; i < 8; i++) s[10 + i] = (std::uint8_t)(packed >> (56 - 8 * i));
+    std::memset(s + 18, 0, 16);         // MD5 not computed
+    return header_;
+}
+
+} // namespace trussc
@@ -0,0 +1,102 @@
+#pragma once
+
+// =============================================================================
+// tcFlacEncoder.h - Lossless FLAC encoder for recordings
+// =============================================================================
+//
+// Turns interleaved integer PCM into a FLAC stream any player (and
+// SoundBuffer::load() via dr_flac) can open — typically 40-60% the size of
+// the WAV for music, far less for silence-heavy show recordings. Built for
+// AudioRecorder's writer thread: it keeps no file handle, only hands back
+// encoded bytes, and stops allocating after setup().
+//
+//   FlacEncoder enc;
+//   enc.setup(48000, 2, 16);
+//   out.write(enc.getHeader(), FlacEncoder::HEADER_SIZE);
+//   while (...) {                                   // blockSize frames each
+//       size_t n = enc.encode(samples, frames);
+//       out.write(enc.data(), n);
+//   }
+//   out.writeAt(0, enc.getHeader(), FlacEncoder::HEADER_SIZE);  // final stats
+//
+// Each block tries the fixed predictors (orders 0-4) on every channel and,
+// for stereo, all four channel decorrelations (independent, left/side,
+// side/right, mid/side), then Rice-codes the residual with the partition
+// order that estimates smallest. Constant blocks (silence) collapse to a few
+// bytes; blocks that don't compress are stored verbatim. No LPC search, so
+// files run a few percent larger than `flac -5` at a small fraction of the
+// CPU cost.
+//
+// The STREAMINFO MD5 is left zero ("not computed"), which the format allows.
+//
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trussc {
+
+class FlacEncoder {
+public:
+    // "fLaC" + the STREAMINFO block (the only metadata block written).
+    static constexpr std::size_t HEADER_SIZE = 42;
+
+    // Channels 1-8, bitsPerSample 8-24, blockSize 16-65535. Returns false
+    // (and stays unusable) on anything else.
+    bool setup(int sampleRate, int channels, int bitsPerSample = 16, int blockSize = 4096);
+
+    // Encode one block of `frames` interleaved frames (frames <= blockSize;
+    // only the last block of a stream may be shorter). Samples must fit in
+    // bitsPerSample. Returns the byte count available from data().
+    std::size_t encode(const std::int32_t* interleaved, int frames);
+
+    // Bytes of the last encode(), valid until the next one.
+    const std::uint8_t* data() const { return out_.data(); }
+
+    // "fLaC" + STREAMINFO reflecting everything encoded so far. Write it at
+    // the start of the stream, and again over the first HEADER_SIZE bytes
+    // once done to record the totals.
+    const std::uint8_t* getHeader();
+
+    std::uint64_t getTotalFrames() const { return totalFrames_; }
+    int getBlockSize() const { return blockSize_; }
+    int getChannels() const { return channels_; }
+    int getBitsPerSample() const { return bits_; }
+
+private:
+    struct Subframe {
+        int type = 0;          // 0 constant, 1 verbatim, 2 fixed
+        int order = 0;
+        int partitionOrder = 0;
+        std::uint64_t bits = 0;
+    };
+
+    Subframe analyze(const std::int32_t* x, int n, int bits);
+    void writeSubframe(const std::int32_t* x, int n, int bits, const Subframe& sf);
+
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    int bits_ = 0;
+    int blockSize_ = 0;
+    std::uint64_t frameNumber_ = 0;
+    std::uint64_t totalFrames_ = 0;
+    std::uint32_t minFrameBytes_ = 0, maxFrameBytes_ = 0;
+
+    std::vector<std::int32_t> planes_;     // per channel, + mid/side for stereo
+    std::vector<std::uint32_t> residual_;  // zig-zag residual scratch
+    std::vector<std::uint64_t> sums_;      // per finest partition
+    std::vector<std::uint8_t> out_;
+    std::size_t pos_ = 0;                  // bit writer: bytes complete
+    std::uint64_t acc_ = 0;
+    int accBits_ = 0;
+    std::uint8_t header_[HEADER_SIZE] = {};
+
+    void put(std::uint32_t value, int bits);
+    void putSigned(std::int32_t value, int bits) { put((std::uint32_t)value & maskOf(bits), bits); }
+    void putRice(std::uint32_t u, int k);
+    void alignByte();
+    static std::uint32_t maskOf(int bits) { return bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u); }
+};
+
+} // namespace trussc
@@ -34,6 +34,9 @@
 #include "../../tcMath.h"
 #include "../events/tcEvent.h"
 #include "../utils/tcLog.h"
+#include "tcSoundMix.h"
+#include "tcSoundVoices.h"
+#include "tcAudioGraph.h"
 
 namespace trussc {
 
@@ -41,10 +44,12 @@ namespace trussc {
 // ---------------------------------------------------------------------------
 // SoundSource — abstract base for anything Sound::play() can consume.
 //
-// Two concrete subclasses:
+// Three concrete kinds:
 //   - SoundBuffer (eager): full decoded PCM in memory.
-//   - SoundStream (streaming): file kept open, decoded on demand by a
-//     worker thread into a per-instance ring buffer.
+//   - SoundStream (streaming): file kept open, decoded on demand by
+//     worker threads into a per-instance ring buffer.
+//   - SoundSynth (synthesized): nothing stored; each voice renders its
+//     block in the mixer callback (ChipSoundSynth in tcChipSound.h).
 //
 // The `kind_` enum lets the audio mixer dispatch on type without a
 // virtual call per frame. Per-block work (channels / sampleRate /
@@ -52,7 +57,7 @@ namespace trussc {
 // ---------------------------------------------------------------------------
 class SoundSource {
 public:
-    enum Kind { Eager, Stream };
+    enum Kind { Eager, Stream, Synth };
 
     int channels = 0;
     int sampleRate = 0;
@@ -379,27 +384,44 @@ public:
 
 // ---------------------------------------------------------------------------
 // SoundStream — streaming source. File stays open; samples are decoded on
-// demand by the engine's StreamWorker thread into a per-PlayingSound ring
+// demand by the engine's StreamWorker threads into a per-PlayingSound ring
 // buffer. Use when the file is too large to decode into RAM up front
 // (multi-minute BGM, podcasts) — a few-hundred-KB working set per voice
 // instead of full PCM.
 //
-// One SoundStream describes the source; per-voice decoder + ring buffer
-// state lives in StreamInstance (declared in tcAudio_impl.cpp because it
-// includes miniaudio types). maxPolyphony controls how many concurrent
-// `play()` instances are allowed before the engine recycles the slot.
+// One SoundStream describes the source and owns one decoder, reading the
+// memory-mapped file, that fills a cache of decoded blocks. Every voice
+// copies out of that cache into its own ring buffer (StreamInstance,
+// declared in tcAudio_impl.cpp because it includes miniaudio types), so
+// voices playing the same region share the decode work. maxPolyphony
+// controls how many concurrent `play()` instances are allowed before the
+// engine recycles the slot.
 //
 // Constraints (vs eager SoundBuffer):
-//   - setSpeed() is treated as 1.0 (no resampling on the fly — decoder
-//     outputs engine-rate frames).
+//   - setSpeed() range is [0, 10] (no reverse); the decoder outputs
+//     engine-rate frames and the mixer resamples them for speed.
 //   - setPosition() seeks the decoder and re-fills the ring buffer
 //     (~10 ms blackout, similar tradeoff to other engines).
-//   - Each polyphony slot costs one open file handle + one decoder +
-//     one ring buffer (default ~16 KB).
+//   - Each polyphony slot costs one ring buffer (~130 KB); the block cache
+//     is shared (setCacheSize(), default 2 MB per stream).
 // ---------------------------------------------------------------------------
-// Per-voice decoder + ring-buffer state. Full definition lives in
-// tcAudio_impl.cpp (where miniaudio's headers are visible).
-namespace internal { struct StreamInstance; }
+// Per-voice ring-buffer state and the shared block cache. Full definitions
+// live in tcAudio_impl.cpp (where miniaudio's headers are visible).
+namespace internal {
+struct StreamInstance;
+class StreamBlockCache;
+}
+
+// Counters for one SoundStream, summed over all of its voices.
+struct SoundStreamStats {
+    uint64_t underruns = 0;        // audio callbacks in which a voice's ring ran dry
+    uint64_t underrunFrames = 0;   // output frames left silent by those underruns
+    uint64_t cacheHits = 0;        // block requests served from the cache
+    uint64_t cacheMisses = 0;      // block requests that had to decode
+    uint64_t blocksDecoded = 0;
+    size_t   cachedBytes = 0;      // decoded PCM currently held by the cache
+    bool     memoryMapped = false; // decoder reads a mapped file (vs buffered I/O)
+};
 
 class SoundStream : public SoundSource {
 public:
@@ -418,20 +440,79 @@ public:
     fs::path getPath() const { return path_; }
     int getMaxPolyphony() const { return maxPolyphony_; }
 
+    // Upper bound on decoded PCM kept for reuse by this stream's voices.
+    // Blocks a voice is still reading stay alive past the budget. Takes
+    // effect on the next decoded block; may be called before loadStream().
+    void setCacheSize(size_t bytes);
+    size_t getCacheSize() const { return cacheSize_; }
+
+    SoundStreamStats getStats() const;
+    void resetStats();
+
 private:
     fs::path path_;
     int maxPolyphony_ = 1;
     int encodingFormatHint_ = 0;  // ma_encoding_format value, stored as int
                                   // to avoid pulling miniaudio.h into the header.
     float duration_ = 0.0f;
+    size_t cacheSize_ = 2u << 20;
+    std::shared_ptr<internal::StreamBlockCache> cache_;
+
+    // Written by the mixer (audio thread), read by getStats().
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> underrunFrames_{0};
 
     friend struct internal::StreamInstance;
     friend class AudioEngine;
 };
 
 // ---------------------------------------------------------------------------
-// Per-PlayingSound stream state. Owns a miniaudio decoder and a ring
-// buffer fed by StreamWorker. Mixer reads from `ring`. Declared as a
+// SoundSynth — a source computed while it plays instead of read from PCM.
+//
+// AudioEngine::createVoice() asks the synth for a SoundSynthInstance at the
+// engine rate (on the play() thread, so it may allocate there); the mixer
+// then calls render() on the audio thread, soundmix::RUN_FRAMES frames at a
+// time, and routes the result like any other voice (volume, pan, channel
+// map, bus). Memory is whatever the instance holds — typically O(voices).
+//
+// Positions are in source frames at the engine rate. speed scales time (and,
+// for synths that honour it, pitch) like tape; it is clamped to [0, 10] as
+// for streams.
+// ---------------------------------------------------------------------------
+class SoundSynthInstance {
+public:
+    virtual ~SoundSynthInstance() = default;
+
+    // Audio thread; must not allocate, lock or block. Overwrite `frames`
+    // (<= soundmix::RUN_FRAMES) frames, channel c planar at
+    // out + c * soundmix::RUN_FRAMES, advancing `speed` source frames per
+    // output frame. Returns the frames produced; fewer than asked means the
+    // sound ended (only when !loop).
+    virtual int render(float* out, int frames, double speed, bool loop) = 0;
+
+    // Same timing as render() without producing audio (virtual voices).
+    virtual int skip(int frames, double speed, bool loop) = 0;
+
+    // Jump to a position in source frames (Sound::setPosition()).
+    virtual void seek(double frame) = 0;
+    virtual double getPosition() const = 0;
+};
+
+class SoundSynth : public SoundSource {
+public:
+    // Upper bound on `channels`, so the mixer's planar scratch stays on the
+    // stack.
+    static constexpr int MAX_CHANNELS = 8;
+
+    SoundSynth() : SoundSource(SoundSource::Synth) {}
+
+    // One per playing voice, rendering at `sampleRate`. nullptr = refuse.
+    virtual std::shared_ptr<SoundSynthInstance> createInstance(int sampleRate) = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Per-PlayingSound stream state. Owns a ring buffer that StreamWorker
+// fills from the stream's shared block cache. Mixer reads from `ring`. Declared as a
 // forward declaration here; full definition is in tcAudio_impl.cpp
 // where miniaudio's headers are visible (see internal::StreamInstance
 // forward-declared above).
@@ -461,79 +542,72 @@ enum class MixMode {
 };
 
 // ---------------------------------------------------------------------------
-// Atomic shared_ptr shim
+// ResampleQuality — interpolator used when a voice plays at a speed other
+// than 1 or its source rate differs from the device rate (44.1 kHz assets on
+// a 48 kHz device). Set per-Sound via Sound::setResampleQuality().
 //
-// PlayingSound stores routing snapshots (channelMap / channelGains) as
-// shared_ptr that the UI thread updates and the audio thread reads. We'd
-// like to use the C++20 std::atomic<std::shared_ptr<T>> specialization,
-// but Apple libc++ doesn't ship it yet (verified 2026-05). We fall back
-// to the (C++20-deprecated) std::atomic_load / std::atomic_store free
-// functions, suppressing the deprecation warning locally — when the
-// specialization lands the storage type and accessors auto-switch.
+//   Linear   — 2-tap linear interpolation (default, cheapest). Aliases
+//              audibly when pitching up and dulls / images the top octave.
+//   Sinc8 .. Sinc64
+//            — polyphase windowed-sinc with that many taps; the cutoff
+//              follows the speed, so pitching up is alias-free up to 8x.
+//              Sinc16 is a good default for music, Sinc64 is mastering
+//              grade. Cost per voice grows with the tap count (see
+//              core/tests/soundMix for numbers on your machine).
+//
+// The enum value is the tap count.
 // ---------------------------------------------------------------------------
-namespace internal {
+enum class ResampleQuality {
+    Linear = 0,
+    Sinc8  = 8,
+    Sinc16 = 16,
+    Sinc32 = 32,
+    Sinc64 = 64,
+};
 
-#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
-    // Native C++20 specialization path — lock-free where supported,
-    // no deprecation warnings.
-    template<class T>
-    using AtomicSharedPtr = std::atomic<std::shared_ptr<T>>;
+// ---------------------------------------------------------------------------
+// SpscQueue — fixed-capacity single-producer / single-consumer queue.
+//
+// The audio engine hands voices and routing snapshots between the UI side
+// and the audio callback through these. Slots are allocated up front and
+// elements are moved in and out, so push() / pop() never allocate, lock or
+// free: a popped slot is left moved-from (empty), and pushing into an empty
+// slot releases nothing. Either end may be the audio thread.
+//
+// Capacity must be a power of two. push() returns false when full (the
+// element is left untouched), pop() returns false when empty.
+// ---------------------------------------------------------------------------
+namespace internal {
 
-    template<class T>
-    inline std::shared_ptr<T> sharedLoad(const AtomicSharedPtr<T>& p) {
-        return p.load(std::memory_order_acquire);
-    }
-    template<class T>
-    inline void sharedStore(AtomicSharedPtr<T>& p, std::shared_ptr<T> v) {
-        p.store(std::move(v), std::memory_order_release);
-    }
-#else
-    // Fallback: a plain shared_ptr accessed via the deprecated free-
-    // function atomic API. Still lock-free for shared_ptr on common
-    // platforms; the deprecation is for ergonomics only.
-    template<class T>
-    using AtomicSharedPtr = std::shared_ptr<T>;
-
-    // Use the *_explicit forms with matching acquire/release ordering so
-    // this path is symmetric with the C++20 specialization branch above
-    // — without the explicit, the free functions default to seq_cst and
-    // we'd silently take a stronger fence on Apple while GCC / MSVC ran
-    // with the weaker order. Identical observable behavior for our 1
-    // producer (UI) / 1 consumer (audio) usage, but keeps the two
-    // branches honest.
-    template<class T>
-    inline std::shared_ptr<T> sharedLoad(const std::shared_ptr<T>& p) {
-#       if defined(__clang__) || defined(__GNUC__)
-#           pragma GCC diagnostic push
-#           pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#       elif defined(_MSC_VER)
-#           pragma warning(push)
-#           pragma warning(disable: 4996)
-#       endif
-        return std::atomic_load_explicit(&p, std::memory_order_acquire);
-#       if defined(__clang__) || defined(__GNUC__)
-#           pragma GCC diagnostic pop
-#       elif defined(_MSC_VER)
-#           pragma warning(pop)
-#       endif
+template<class T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : slots_(capacity), mask_(capacity - 1) {}
+
+    bool push(T&& v) {
+        size_t w = write_.load(std::memory_order_relaxed);
+        if (w - read_.load(std::memory_order_acquire) > mask_) return false;
+        slots_[w & mask_] = std::move(v);
+        write_.store(w + 1, std::memory_order_release);
+        return true;
     }
-    template<class T>
-    inline void sharedStore(std::shared_ptr<T>& p, std::shared_ptr<T> v) {
-#       if defined(__clang__) || defined(__GNUC__)
-#           pragma GCC diagnostic push
-#           pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#       elif defined(_MSC_VER)
-#           pragma warning(push)
-#           pragma warning(disable: 4996)
-#       endif
-        std::atomic_store_explicit(&p, std::move(v), std::memory_order_release);
-#       if defined(__clang__) || defined(__GNUC__)
-#           pragma GCC diagnostic pop
-#       elif defined(_MSC_VER)
-#           pragma warning(pop)
-#       endif
+
+    bool pop(T& out) {
+        size_t r = read_.load(std::memory_order_relaxed);
+        if (r == write_.load(std::memory_order_acquire)) return false;
+        out = std::move(slots_[r & mask_]);
+        read_.store(r + 1, std::memory_order_release);
+        return true;
     }
-#endif
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+};
 
 } // namespace internal
 
@@ -541,16 +615,21 @@ namespace internal {
 // Playing Sound Instance
 // ---------------------------------------------------------------------------
 struct PlayingSound {
-    // Polymorphic — either SoundBuffer (eager) or SoundStream (streaming).
+    // Polymorphic — SoundBuffer (eager), SoundStream (streaming) or
+    // SoundSynth (synthesized).
     // Dispatch in the mixer is by kind() to avoid a vtable lookup per
     // frame. Field name kept as `buffer` for backward compatibility with
     // tcxLua bindings; the type is now the wider SoundSource.
     std::shared_ptr<SoundSource> buffer;
 
     // Per-instance streaming state. Null for eager voices; allocated by
-    // AudioEngine::play() when buffer->kind() == Stream.
+    // AudioEngine::createVoice() when buffer->kind() == Stream.
     std::shared_ptr<internal::StreamInstance> stream;
 
+    // Per-instance synth state. Null unless buffer->kind() == Synth;
+    // created by AudioEngine::createVoice().
+    std::shared_ptr<SoundSynthInstance> synth;
+
     std::atomic<float> volume{1.0f};
     std::atomic<float> pan{0.0f};        // -1.0 (left) ~ 0.0 (center) ~ 1.0 (right)
     std::atomic<float> speed{1.0f};      // 0.5 (half speed) ~ 1.0 (normal) ~ 2.0 (double speed)
@@ -559,19 +638,43 @@ struct PlayingSound {
     std::atomic<bool> paused{false};
 
     // Routing. mixMode is a plain atomic int (enum value). channelMap /
-    // channelGains are atomically-updatable shared_ptr — the UI thread
-    // installs new versions via internal::sharedStore and the
-    // audio thread reads via internal::sharedLoad each callback.
-    // The shim type auto-switches between C++20
-    // std::atomic<std::shared_ptr<T>> and the deprecated free-function
-    // atomic API based on __cpp_lib_atomic_shared_ptr.
+    // channelGains belong to the audio thread once the voice is started:
+    // set them before AudioEngine::startVoice(), and afterwards only
+    // through AudioEngine::setVoiceRouting(), which swaps them in at the
+    // next block and returns the old snapshots for release off the audio
+    // thread.
     //
     // null map  → use mixMode rules
     // non-null  → map is the source of truth
     // gains entries beyond .size() default to 1.0
     std::atomic<int> mixMode{(int)MixMode::Auto};
-    internal::AtomicSharedPtr<const std::vector<std::vector<int>>> channelMap;
-    internal::AtomicSharedPtr<const std::vector<float>>            channelGains;
+    std::shared_ptr<const std::vector<std::vector<int>>> channelMap;
+    std::shared_ptr<const std::vector<float>>            channelGains;
+
+    // ResampleQuality as its tap count (0 = linear). The mixer only uses a
+    // sinc table that already exists (Sound::setResampleQuality builds it),
+    // so setting this field directly to an unbuilt quality plays linear.
+    std::atomic<int> resampleQuality{(int)ResampleQuality::Linear};
+
+    // Voice management (see AudioEngine "Voice management"). priority:
+    // higher = more important, default 0. audibility / isVirtual are
+    // written by the audio thread each block; startOrder by startVoice().
+    std::atomic<int>   priority{0};
+    std::atomic<float> audibility{1.0f};  // volume x loudest channel gain
+    std::atomic<bool>  isVirtual{false};  // position advances, not mixed
+    std::atomic<bool>  stolen{false};     // fading out, then stops
+    uint64_t startOrder = 0;
+
+    // Audio thread only: mixing gain (1 = real, 0 = virtual, between while
+    // fading toward wantReal). placed is false until the first block
+    // decides, so a voice that starts virtual or real doesn't fade.
+    float fadeGain = 1.0f;
+    bool  wantReal = true;
+    bool  placed = false;
+
+    // Bus the voice mixes into (null = master). Same ownership rule as
+    // channelMap: set before startVoice(), then via AudioEngine::setVoiceBus().
+    std::shared_ptr<AudioBus> bus;
 
     // Playback position (floating-point for speed adjustment)
     double positionF{0.0};
@@ -603,7 +706,8 @@ struct AudioSettings {
     int sampleRate   = 96000;   // engine output sample rate (Hz)
     int channels     = 2;       // engine output channel count (1 = mono, 2 = stereo)
     int bufferSize   = 0;       // requested device buffer size in frames; 0 = let miniaudio choose
-    int maxPolyphony = 32;      // max simultaneously-playing Sound voices
+    int maxPolyphony = 32;      // max simultaneously-playing Sound voices (real + virtual)
+    int maxRealVoices = 0;      // voices actually mixed per block; 0 = all of them
     std::string deviceName;     // playback device name; empty = system default
 };
 
@@ -669,13 +773,49 @@ struct AudioInBuffer {
     uint64_t     framePosition;
 };
 
+// ---------------------------------------------------------------------------
+// AudioEngineStats — real-time health of the mixer, from
+// AudioEngine::getStats(). Counters are cumulative since init() or the last
+// resetStats().
+//
+//   lateCallbacks  the mix took longer than the block it produced (the
+//                  device was certainly starved: an audible glitch)
+//   xruns          a callback started more than two block lengths after the
+//                  previous one (the device ran dry or the OS starved the
+//                  audio thread; almost always audible)
+//   peakLoad       worst mix time / block duration (1.0 = late)
+//   droppedCommands play() / routing changes rejected because the command
+//                  queue was full (more than COMMAND_QUEUE_SIZE per block)
+//   stolenVoices   voices faded out and stopped to make room for a new
+//                  play()
+//   realVoices / virtualVoices
+//                  split of the playing voices in the last block: mixed
+//                  (fading ones included) vs. only advanced (see
+//                  AudioEngine "Voice management")
+// ---------------------------------------------------------------------------
+struct AudioEngineStats {
+    uint64_t callbacks       = 0;
+    uint64_t lateCallbacks   = 0;
+    uint64_t xruns           = 0;
+    float    peakLoad        = 0.0f;
+    uint64_t droppedCommands = 0;
+    uint64_t stolenVoices    = 0;
+    int      activeVoices    = 0;   // voices the audio thread holds
+    int      realVoices      = 0;
+    int      virtualVoices   = 0;
+};
+
 // ---------------------------------------------------------------------------
 // Audio Engine (singleton, miniaudio-based)
 // ---------------------------------------------------------------------------
 class AudioEngine {
 public:
     // FFT analysis buffer is internal-only and unaffected by AudioSettings.
+    // ANALYSIS_BUFFER_SIZE is the most getAnalysisBuffer() returns; the ring
+    // behind it holds ANALYSIS_RING_SIZE frames so readers (and
+    // AudioAnalyzer's worker) have slack while the mixer keeps writing.
     static constexpr int ANALYSIS_BUFFER_SIZE = 4096;
+    static constexpr int ANALYSIS_RING_SIZE   = 4 * ANALYSIS_BUFFER_SIZE;
 
     // Default values used when init() is called without an explicit
     // AudioSettings, and as initial values for the runtime fields. 48 kHz
@@ -722,7 +862,7 @@ public:
     // on the value being sensible.
     int getSampleRate()   const { return sampleRate_; }
     int getChannels()     const { return channels_; }
-    int getMaxPolyphony() const { return (int)playingSounds_.size(); }
+    int getMaxPolyphony() const { return (int)registry_.size(); }
     int getBufferSize()   const { return bufferSize_; }
     bool isInitialized()  const { return initialized_; }
 
@@ -761,24 +901,96 @@ public:
 
         numSamples = std::min(numSamples, (size_t)ANALYSIS_BUFFER_SIZE);
 
-        std::lock_guard<std::mutex> lock(analysisMutex_);
-
-        // Copy latest samples from ring buffer
-        size_t readPos = (analysisWritePos_ + ANALYSIS_BUFFER_SIZE - numSamples) % ANALYSIS_BUFFER_SIZE;
-
-        for (size_t i = 0; i < numSamples; i++) {
-            outBuffer[i] = analysisBuffer_[(readPos + i) % ANALYSIS_BUFFER_SIZE];
+        // Before the first numSamples frames exist, the head is silence.
+        const uint64_t end = getAnalysisPosition();
+        const size_t lead = end < numSamples ? (size_t)(numSamples - end) : 0;
+        std::fill(outBuffer, outBuffer + lead, 0.0f);
+        const uint64_t start = end - (numSamples - lead);
+        if (!readAnalysis(start, outBuffer + lead, numSamples - lead)) {
+            // Only if this thread stalled for a large part of the ring
+            // mid-copy: take what's there now.
+            readAnalysis(getAnalysisPosition() - (numSamples - lead), outBuffer + lead,
+                         numSamples - lead);
         }
-
         return numSamples;
     }
 
-    // Add new playback instance. Accepts any SoundSource — eager
-    // SoundBuffer or streaming SoundStream. For streams, also allocates a
-    // StreamInstance (decoder + ring buffer) and registers it with the
-    // StreamWorker. Implementation lives in tcAudio_impl.cpp so the
-    // streaming branch can see miniaudio types.
-    std::shared_ptr<PlayingSound> play(std::shared_ptr<SoundSource> source);
+    // Analysis ring, by absolute frame. The mixer appends one mono sample
+    // per output frame (same numbering as AudioOutBuffer::framePosition)
+    // and publishes the count with a release store — it never waits for
+    // readers. getAnalysisPosition() is the number of frames written.
+    uint64_t getAnalysisPosition() const {
+        return analysisPosition_.load(std::memory_order_acquire);
+    }
+
+    // Copy frames [start, start + count) of the analysis ring. Returns false
+    // if any of them isn't written yet, was overwritten before or during
+    // the copy, or count > ANALYSIS_BUFFER_SIZE.
+    bool readAnalysis(uint64_t start, float* out, size_t count) const {
+        constexpr uint64_t RING = ANALYSIS_RING_SIZE;
+        if (count > (size_t)ANALYSIS_BUFFER_SIZE) return false;
+        const uint64_t end = getAnalysisPosition();
+        if (start > end || end - start < count || end - start > RING) return false;
+
+        const size_t at = (size_t)(start & (RING - 1));
+        const size_t first = std::min(count, (size_t)RING - at);
+        std::memcpy(out, analysisBuffer_.data() + at, first * sizeof(float));
+        std::memcpy(out + first, analysisBuffer_.data(), (count - first) * sizeof(float));
+
+        // The mixer may already be writing the block after `now`; allow it
+        // up to ANALYSIS_BUFFER_SIZE frames before calling the copy torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t now = analysisPosition_.load(std::memory_order_relaxed);
+        return now + ANALYSIS_BUFFER_SIZE <= start + RING;
+    }
+
+    // Voice handoff. The audio thread owns the list of voices it mixes;
+    // other threads never lock against it. They publish commands (start a
+    // voice, replace its routing) into an SPSC queue that the callback
+    // drains at the start of each block, and the callback hands finished
+    // voices and replaced routing snapshots back through a second queue so
+    // they are destroyed here, on the calling thread, never in the
+    // callback. Scalar parameters (volume, pan, speed, loop, paused,
+    // playing) stay plain atomics on PlayingSound, read once per block.
+    //
+    // play(source) = createVoice(source) + startVoice(voice). Split them
+    // to configure the voice before the audio thread can see it.
+    //
+    // createVoice: build a voice for any SoundSource — eager SoundBuffer,
+    // streaming SoundStream or SoundSynth. For streams, also builds a
+    // per-voice ring (StreamInstance) on the stream's block cache and
+    // registers it with the StreamWorker; for synths, the voice's
+    // SoundSynthInstance.
+    // Implementation lives in tcAudio_impl.cpp so the streaming branch can
+    // see miniaudio types. Returns nullptr when not initialized or when the
+    // stream's maxPolyphony is reached.
+    std::shared_ptr<PlayingSound> createVoice(std::shared_ptr<SoundSource> source);
+
+    // Queue a created voice for playback from the next block. Returns false
+    // when all maxPolyphony voices are busy or the command queue is full.
+    bool startVoice(const std::shared_ptr<PlayingSound>& voice);
+
+    // Replace a started voice's channelMap / channelGains (null = none).
+    // Takes effect at the next block.
+    bool setVoiceRouting(const std::shared_ptr<PlayingSound>& voice,
+                         std::shared_ptr<const std::vector<std::vector<int>>> channelMap,
+                         std::shared_ptr<const std::vector<float>> channelGains);
+
+    // Move a started voice to another bus (null = master). Takes effect at
+    // the next block.
+    bool setVoiceBus(const std::shared_ptr<PlayingSound>& voice, std::shared_ptr<AudioBus> bus);
+
+    // Buses, sends and effects between the voices and the device (see
+    // tcAudioGraph.h). The graph lives as long as the engine; buses and
+    // effects can be set up before init().
+    AudioGraph& getGraph() { return graph_; }
+
+    // Add new playback instance (createVoice + startVoice).
+    std::shared_ptr<PlayingSound> play(std::shared_ptr<SoundSource> source) {
+        auto voice = createVoice(std::move(source));
+        if (voice && !startVoice(voice)) voice.reset();
+        return voice;
+    }
 
     // Backward-compat overload — most callers pass shared_ptr<SoundBuffer>
     // directly, and we don't want to force them through an explicit
@@ -790,17 +1002,68 @@ public:
     // Called from audio callback (internal use)
     void mixAudio(float* buffer, int num_frames, int num_channels);
 
+    // Mixer health: late callbacks, xruns, peak load, dropped commands,
+    // real / virtual voice counts.
+    AudioEngineStats getStats() const;
+    void resetStats();
+
+    // -------------------------------------------------------------------------
+    // Voice management
+    // -------------------------------------------------------------------------
+    //
+    // maxPolyphony bounds how many voices exist; maxRealVoices bounds how
+    // many of them are mixed. Each block the audio thread ranks the live
+    // voices and mixes only the most important ones; the others are
+    // *virtual*: their position keeps advancing (a one-shot still ends on
+    // time, a loop stays in phase) but they cost almost nothing. A voice
+    // goes virtual when
+    //   - its audibility (volume x loudest channel gain) is below the
+    //     audibility threshold, or
+    //   - more than maxRealVoices voices are audible and it ranks below
+    //     them: by priority, then audibility, then start order (newer
+    //     voices lose ties).
+    // It becomes real again once it ranks back in. Both tests have a
+    // +3 dB hysteresis (soundmix::AUDIBILITY_HYSTERESIS), and every switch
+    // — and every stolen voice — fades over soundmix::FADE_SECONDS (5 ms)
+    // instead of cutting. A voice fading out still counts as real.
+    //
+    // With a large maxPolyphony, a small maxRealVoices and a steal policy,
+    // thousands of short sounds (particle hits, footsteps) can be fired
+    // per second at a fixed mixing cost.
+    void setMaxRealVoices(int count);         // 0 = mix every voice
+    int getMaxRealVoices() const { return maxRealVoices_.load(std::memory_order_relaxed); }
+
+    // Linear gain below which a voice is virtual (default 0.001 = -60 dB;
+    // 0 disables).
+    void setAudibilityThreshold(float gain) {
+        audibilityThreshold_.store(std::max(0.0f, gain), std::memory_order_relaxed);
+    }
+    float getAudibilityThreshold() const {
+        return audibilityThreshold_.load(std::memory_order_relaxed);
+    }
+
+    void setVoiceStealPolicy(VoiceStealPolicy policy) {
+        stealPolicy_.store((int)policy, std::memory_order_relaxed);
+    }
+    VoiceStealPolicy getVoiceStealPolicy() const {
+        return (VoiceStealPolicy)stealPolicy_.load(std::memory_order_relaxed);
+    }
+
+    // Commands (play / routing changes) that can be queued per audio block.
+    static constexpr int COMMAND_QUEUE_SIZE = 1024;
+
 private:
     AudioEngine() {
-        playingSounds_.resize(DEFAULT_MAX_PLAYING_SOUNDS);
-        analysisBuffer_.resize(ANALYSIS_BUFFER_SIZE, 0.0f);
+        resizeVoices(DEFAULT_MAX_PLAYING_SOUNDS);
+        analysisBuffer_.resize(ANALYSIS_RING_SIZE, 0.0f);
     }
 
     ~AudioEngine() {
         shutdown();
     }
 
-    // Eager mix path: linear interpolation over a fully-decoded SoundBuffer.
+    // Eager mix path: linear (default) or windowed-sinc interpolation over a
+    // fully-decoded SoundBuffer, per sound.resampleQuality.
     //
     // Supports the full setSpeed range (currently [-10, 10]):
     //   - speed > 0: forward playback (1.0 = natural pitch at engine rate).
@@ -818,103 +1081,43 @@ private:
     //   - sound.channelGains entries scale per-output-ch (default 1.0).
     //   - pan multiplier applies to ch0/ch1 only (legacy stereo balance).
     //
-    // Bounds are resolved at the top of each iteration so posF never reaches
-    // the indexing step with a negative or out-of-range value (size_t cast
-    // of a negative double is UB).
+    // The work is done in runs between loop / end boundaries by the block
+    // kernels in tcSoundMix.h; bounds are resolved before each run so posF
+    // never reaches the indexing step with a negative or out-of-range value
+    // (size_t cast of a negative double is UB).
     static void mixEagerVoice(PlayingSound& sound, const SoundBuffer& src,
                               float* buffer, int num_frames, int num_channels) {
         double posF = sound.positionF;
-        float vol = sound.volume;
         float pan = sound.pan;
         float speed = sound.speed;
         double posStep = (double)speed * (double)sound.rateRatio;
-        double srcLen = (double)src.numSamples;
 
+        // Routing state is owned by the audio thread (replaced only by
+        // applyVoiceCommands() at block start), so plain reads are fine.
+        soundmix::Routing routing;
+        routing.map = sound.channelMap && !sound.channelMap->empty()
+                    ? sound.channelMap.get() : nullptr;
+        routing.gains = sound.channelGains.get();
+        routing.downmixMono = sound.mixMode.load(std::memory_order_acquire)
+                            == (int)MixMode::DownmixMono;
         // pan = -1: full left, 0: center, +1: full right
-        float panL = (pan <= 0.0f) ? 1.0f : (1.0f - pan);
-        float panR = (pan >= 0.0f) ? 1.0f : (1.0f + pan);
-
-        // Snapshot routing state once at the top of the callback. Audio
-        // thread reads atomically so the UI thread's setChannelMap store
-        // sees a happens-before edge.
-        auto map = internal::sharedLoad(sound.channelMap);
-        auto gains = internal::sharedLoad(sound.channelGains);
-        int mm = sound.mixMode.load(std::memory_order_acquire);
-        const int srcCh = src.channels;
-        const int mapSize = map ? (int)map->size() : 0;
-        const int gainsSize = gains ? (int)gains->size() : 0;
-
-        for (int frame = 0; frame < num_frames; frame++) {
-            // Resolve bounds for both directions BEFORE indexing.
-            if (posF < 0.0) {
-                if (sound.loop) {
-                    posF += srcLen;
-                    // Defensive: very large negative step could still be < 0.
-                    if (posF < 0.0) posF = std::fmod(posF, srcLen) + srcLen;
-                } else {
-                    sound.playing = false;
-                    break;
-                }
-            }
-            if (posF >= srcLen) {
-                if (sound.loop) {
-                    posF -= srcLen;
-                    if (posF >= srcLen) posF = std::fmod(posF, srcLen);
-                } else {
-                    sound.playing = false;
-                    break;
-                }
-            }
-
-            size_t pos0 = (size_t)posF;
-            size_t pos1 = pos0 + 1;
-            float frac = (float)(posF - (double)pos0);
-
-            if (pos1 >= src.numSamples) {
-                pos1 = sound.loop ? 0 : pos0;
-            }
-
-            // Pull an interpolated sample for source channel s. Handles
-            // mono / multi-ch indexing uniformly via stride = srcCh.
-            auto srcAt = [&](int s) -> float {
-                if (s < 0 || s >= srcCh) return 0.0f;
-                float a = src.samples[pos0 * (size_t)srcCh + (size_t)s];
-                float b = src.samples[pos1 * (size_t)srcCh + (size_t)s];
-                return a + (b - a) * frac;
-            };
-
-            // Per-output-channel routing.
-            for (int c = 0; c < num_channels; c++) {
-                float sample = 0.0f;
-
-                if (mapSize > 0) {
-                    // Explicit map wins. c beyond map.size() = silent.
-                    if (c < mapSize) {
-                        for (int s : (*map)[c]) sample += srcAt(s);
-                    }
-                } else if (mm == (int)MixMode::DownmixMono) {
-                    // Sum all source channels, then average. Broadcasts
-                    // identical mono content to every output channel.
-                    for (int s = 0; s < srcCh; s++) sample += srcAt(s);
-                    if (srcCh > 0) sample /= (float)srcCh;
-                } else {
-                    // Auto: mono broadcasts, multi-ch 1:1 with truncation.
-                    if (srcCh == 1) {
-                        sample = srcAt(0);
-                    } else {
-                        sample = (c < srcCh) ? srcAt(c) : 0.0f;
-                    }
-                }
-
-                float gain = (c < gainsSize) ? (*gains)[c] : 1.0f;
-                float panMul = (c == 0) ? panL : ((c == 1) ? panR : 1.0f);
-
-                buffer[frame * num_channels + c] += sample * gain * panMul * vol;
-            }
-
-            posF += posStep;
-        }
-
+        routing.panL = (pan <= 0.0f) ? 1.0f : (1.0f - pan);
+        routing.panR = (pan >= 0.0f) ? 1.0f : (1.0f + pan);
+        routing.volume = sound.volume;
+
+        soundmix::Source source;
+        source.samples = src.samples.data();
+        source.numFrames = src.numSamples;
+        source.channels = src.channels;
+
+        const auto* sinc = soundmix::SincTable::find(
+            sound.resampleQuality.load(std::memory_order_relaxed));
+        const bool ok = sinc
+            ? soundmix::mixSinc(source, posF, posStep, sound.loop, *sinc, routing,
+                                buffer, num_frames, num_channels)
+            : soundmix::mixLinear(source, posF, posStep, sound.loop, routing,
+                                  buffer, num_frames, num_channels);
+        if (!ok) sound.playing = false;
         sound.positionF = posF;
     }
 
@@ -924,50 +1127,155 @@ private:
     static void mixStreamVoice(PlayingSound& sound, SoundStream& src,
                                float* buffer, int num_frames, int num_channels);
 
+    // Synth mix path: the instance renders RUN_FRAMES planar frames at a
+    // time, routed by the same soundmix::route() as the eager kernels. A
+    // positionF that no longer matches the instance (Sound::setPosition())
+    // is a seek.
+    static void mixSynthVoice(PlayingSound& sound, const SoundSynth& src,
+                              float* buffer, int num_frames, int num_channels) {
+        auto* synth = sound.synth.get();
+        if (!synth) return;
+        if (sound.positionF != synth->getPosition()) synth->seek(sound.positionF);
+
+        const float pan = sound.pan;
+        soundmix::Routing routing;
+        routing.map = sound.channelMap && !sound.channelMap->empty()
+                    ? sound.channelMap.get() : nullptr;
+        routing.gains = sound.channelGains.get();
+        routing.downmixMono = sound.mixMode.load(std::memory_order_acquire)
+                            == (int)MixMode::DownmixMono;
+        routing.panL = (pan <= 0.0f) ? 1.0f : (1.0f - pan);
+        routing.panR = (pan >= 0.0f) ? 1.0f : (1.0f + pan);
+        routing.volume = sound.volume;
+
+        const double speed = std::clamp((double)sound.speed.load(), 0.0, 10.0);
+        const bool loop = sound.loop;
+        const int srcCh = std::clamp(src.channels, 1, SoundSynth::MAX_CHANNELS);
+        float planes[SoundSynth::MAX_CHANNELS * soundmix::RUN_FRAMES];
+
+        for (int frame = 0; frame < num_frames; ) {
+            const int want = std::min(soundmix::RUN_FRAMES, num_frames - frame);
+            const int got = synth->render(planes, want, speed, loop);
+            if (got > 0) {
+                soundmix::mixPlanar(planes, srcCh, got, routing,
+                                    buffer + (size_t)frame * num_channels, num_channels);
+            }
+            frame += got;
+            if (got < want) {
+                sound.playing = false;
+                break;
+            }
+        }
+        sound.positionF = synth->getPosition();
+    }
+
     // Re-init helper: rate-adjust active voices so they keep playing from
     // the same point in time after the engine restarts at a new sample
     // rate. Eager voices just recompute rateRatio. Streaming voices need
     // their per-voice decoder rebuilt at the new rate + seeked to the
     // current playback position; the ring is cleared so the worker
     // refills it with samples at the new rate. Implementation lives in
-    // tcAudio_impl.cpp (miniaudio types). Called with mutex_ NOT held —
-    // the device is already stopped, so no audio callback can race.
+    // tcAudio_impl.cpp (miniaudio types). Called with the device stopped,
+    // so no audio callback can race.
     void migrateVoicesToNewRate(int oldRate, int newRate);
 
+    // Voice list plumbing (tcAudio_impl.cpp). applyVoiceCommands() runs on
+    // the audio thread at block start — or on the init() thread while the
+    // device is stopped. resizeVoices() / collectRetired() need
+    // commandMutex_ (resizeVoices takes it itself).
+    void applyVoiceCommands();
+    void dropFadingVoice();
+    void resizeVoices(int polyphony);
+    void collectRetired();
+
+    // Voice management (tcAudio_impl.cpp). assignRealVoices() runs on the
+    // audio thread after applyVoiceCommands(): it decides wantReal for
+    // every live voice, stops stolen voices that have faded out and sets
+    // isVirtual on those that are silent and meant to stay so.
+    // findStealVictim() runs under commandMutex_ and returns the registry
+    // slot to reuse, or nullptr.
+    void assignRealVoices();
+    std::shared_ptr<PlayingSound>* findStealVictim(int priority);
+    static void advanceVirtualVoice(PlayingSound& sound, int num_frames);
+
+    // Mix (or, when virtual, just advance) one voice into `out`. A voice
+    // whose fadeGain hasn't reached its target is rendered into
+    // fadeScratch_ and added through the ramp, RUN_FRAMES at a time.
+    void mixVoice(PlayingSound& sound, float* out, int num_frames, int num_channels) {
+        if (!sound.playing || sound.paused) return;
+        if (!sound.buffer) return;
+
+        if (sound.isVirtual.load(std::memory_order_relaxed)) {
+            advanceVirtualVoice(sound, num_frames);
+            return;
+        }
+
+        const float target = sound.wantReal ? 1.0f : 0.0f;
+        const int chunk = std::min(soundmix::RUN_FRAMES,
+                                   (int)(fadeScratch_.size() / std::max(1, num_channels)));
+        if (sound.fadeGain == target || chunk == 0) {
+            sound.fadeGain = target;
+            mixSource(sound, out, num_frames, num_channels);
+            return;
+        }
+
+        const float step = (float)(1.0 / (soundmix::FADE_SECONDS * sampleRate_));
+        for (int frame = 0; frame < num_frames && sound.playing; frame += chunk) {
+            const int n = std::min(chunk, num_frames - frame);
+            std::memset(fadeScratch_.data(), 0, (size_t)n * num_channels * sizeof(float));
+            mixSource(sound, fadeScratch_.data(), n, num_channels);
+            sound.fadeGain = soundmix::addFaded(fadeScratch_.data(),
+                                                out + (size_t)frame * num_channels,
+                                                n, num_channels, sound.fadeGain, target, step);
+        }
+        if (sound.fadeGain == 0.0f && sound.stolen.load(std::memory_order_relaxed)) {
+            sound.playing = false;
+        }
+    }
+
+    // Dispatch on source kind. Eager path is the common case and stays
+    // inline-friendly; streaming path lives in the impl TU.
+    static void mixSource(PlayingSound& sound, float* out, int num_frames, int num_channels) {
+        if (sound.buffer->kind() == SoundSource::Eager) {
+            mixEagerVoice(sound, *static_cast<SoundBuffer*>(sound.buffer.get()),
+                          out, num_frames, num_channels);
+        } else if (sound.buffer->kind() == SoundSource::Synth) {
+            mixSynthVoice(sound, *static_cast<const SoundSynth*>(sound.buffer.get()),
+                          out, num_frames, num_channels);
+        } else {
+            mixStreamVoice(sound, *static_cast<SoundStream*>(sound.buffer.get()),
+                           out, num_frames, num_channels);
+        }
+    }
+
+    // Graph path (tcAudio_impl.cpp): mix voices into their buses and run
+    // the graph, AudioGraph::BLOCK_FRAMES at a time.
+    void mixThroughGraph(float* buffer, int num_frames, int num_channels);
+
     void mixAudioInternal(float* buffer, int num_frames, int num_channels) {
         // Clear buffer
         std::memset(buffer, 0, num_frames * num_channels * sizeof(float));
 
-        // Mix all live Sound voices under the engine lock. The lock guards
-        // the playingSounds_ slot list against concurrent play() — without
-        // it a play() that swaps a slot mid-iteration would crash.
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-
-            for (auto& sound : playingSounds_) {
-                if (!sound || !sound->playing || sound->paused) continue;
-                if (!sound->buffer) continue;
-
-                // Dispatch on source kind. Eager path is the common case
-                // and stays inline-friendly; streaming path lives in the
-                // impl TU.
-                if (sound->buffer->kind() == SoundSource::Eager) {
-                    mixEagerVoice(*sound,
-                                  *static_cast<SoundBuffer*>(sound->buffer.get()),
-                                  buffer, num_frames, num_channels);
-                } else {
-                    mixStreamVoice(*sound,
-                                   *static_cast<SoundStream*>(sound->buffer.get()),
-                                   buffer, num_frames, num_channels);
-                }
+        // Pick up voices started / re-routed since the last block and hand
+        // finished ones back. Wait-free: nothing here shares a lock with
+        // play(), so a burst of play() calls can't stall the callback.
+        applyVoiceCommands();
+
+        assignRealVoices();
+
+        // Voices mix straight into the device buffer unless buses / effects
+        // are in use; then the graph mixes them per bus, in sub-blocks.
+        if (graph_.beginBlock(num_channels)) {
+            mixThroughGraph(buffer, num_frames, num_channels);
+        } else {
+            for (int i = 0; i < numVoices_; i++) {
+                mixVoice(*voices_[i], buffer, num_frames, num_channels);
             }
         }
 
-        // audioOut listeners run AFTER Sound voices and OUTSIDE the lock.
-        // The lock is released first so a listener that calls
-        // engine.play() doesn't deadlock — that's a discouraged but
-        // possible foot-gun. Listeners read/write only the buffer and
-        // their own captured state, so they don't need the engine lock.
+        // audioOut listeners run AFTER Sound voices. A listener that calls
+        // engine.play() only queues a command (picked up next block) —
+        // still discouraged, since createVoice() allocates.
         if (audioOut.listenerCount() > 0) {
             AudioOutBuffer ob;
             ob.data          = buffer;
@@ -979,26 +1287,13 @@ private:
         }
         framePosition_ += (uint64_t)num_frames;
 
-        // Clipping
-        for (int i = 0; i < num_frames * num_channels; i++) {
-            if (buffer[i] > 1.0f) buffer[i] = 1.0f;
-            if (buffer[i] < -1.0f) buffer[i] = -1.0f;
-        }
-
-        // Copy to FFT analysis ring buffer (mono: left+right average)
-        {
-            std::lock_guard<std::mutex> lock(analysisMutex_);
-            for (int frame = 0; frame < num_frames; frame++) {
-                float mono;
-                if (num_channels > 1) {
-                    mono = (buffer[frame * num_channels] + buffer[frame * num_channels + 1]) * 0.5f;
-                } else {
-                    mono = buffer[frame * num_channels];
-                }
-                analysisBuffer_[analysisWritePos_] = mono;
-                analysisWritePos_ = (analysisWritePos_ + 1) % ANALYSIS_BUFFER_SIZE;
-            }
-        }
+        // Clip, and copy to the FFT analysis ring buffer (mono: left+right
+        // average) in the same pass, then publish the new end. Readers
+        // validate their copy against the position instead of locking.
+        size_t tapPos = (size_t)((framePosition_ - (uint64_t)num_frames) & (ANALYSIS_RING_SIZE - 1));
+        soundmix::clipAndTap(buffer, num_frames, num_channels,
+                             analysisBuffer_.data(), ANALYSIS_RING_SIZE, tapPos);
+        analysisPosition_.store(framePosition_, std::memory_order_release);
     }
 
     void* device_ = nullptr;   // ma_device*
@@ -1006,8 +1301,62 @@ private:
                                // CoreAudio internal state stays consistent
                                // when devices are torn down + recreated.
     bool initialized_ = false;
-    std::vector<std::shared_ptr<PlayingSound>> playingSounds_;
-    std::mutex mutex_;
+
+    // A command for the audio thread. Start: voice. Routing: voice + the
+    // new snapshots (swapped with the voice's, so the old ones ride back
+    // out through retired_). Bus: voice + its new bus, likewise swapped.
+    struct VoiceCommand {
+        enum Type : uint8_t { Start, Routing, Bus };
+        Type type = Start;
+        std::shared_ptr<PlayingSound> voice;
+        std::shared_ptr<const std::vector<std::vector<int>>> channelMap;
+        std::shared_ptr<const std::vector<float>> channelGains;
+        std::shared_ptr<AudioBus> bus;
+    };
+
+    // Declared before the voices so buses outlive every voice routed to
+    // them.
+    AudioGraph graph_;
+
+    // Audio thread only: voices being mixed, [0, numVoices_) live, in start
+    // order. Capacity is fixed by resizeVoices() (2x polyphony, so voices
+    // awaiting retirement never block a start).
+    std::vector<std::shared_ptr<PlayingSound>> voices_;
+    int numVoices_ = 0;
+
+    // Producer side, under commandMutex_ (never taken by the audio thread):
+    // one slot per allowed voice; a slot is free once its voice stops
+    // playing. Bounds polyphony without asking the audio thread.
+    std::vector<std::shared_ptr<PlayingSound>> registry_;
+    std::mutex commandMutex_;
+    std::unique_ptr<internal::SpscQueue<VoiceCommand>> commands_;
+    // Audio thread -> producers: anything whose last reference might drop
+    // in the callback. Sized so it cannot fill between two drains.
+    std::unique_ptr<internal::SpscQueue<std::shared_ptr<const void>>> retired_;
+
+    // Voice management. rank_ (voices_.size() entries) and fadeScratch_
+    // (RUN_FRAMES x channels, sized by init()) are audio-thread scratch so
+    // ranking and fading never allocate; voiceSerial_ is under
+    // commandMutex_.
+    std::atomic<int>   maxRealVoices_{0};
+    std::atomic<float> audibilityThreshold_{0.001f};
+    std::atomic<int>   stealPolicy_{(int)VoiceStealPolicy::None};
+    std::vector<soundmix::VoiceInfo> rank_;
+    std::vector<float> fadeScratch_;
+    uint64_t           voiceSerial_ = 0;
+
+    // Callback timing (written on the audio thread, read by getStats()).
+    std::atomic<uint64_t> statCallbacks_{0};
+    std::atomic<uint64_t> statLate_{0};
+    std::atomic<uint64_t> statXruns_{0};
+    std::atomic<float>    statPeakLoad_{0.0f};
+    std::atomic<uint64_t> statDropped_{0};
+    std::atomic<uint64_t> statStolen_{0};
+    std::atomic<int>      statVoices_{0};
+    std::atomic<int>      statRealVoices_{0};
+    std::atomic<int>      statVirtualVoices_{0};
+    int64_t lastCallbackNs_ = 0;      // audio thread only; 0 = no previous
+    int64_t lastBlockNs_ = 0;
 
     // Runtime engine configuration. Initialized to defaults; replaced when
     // init(AudioSettings) succeeds. Reading these before init() returns the
@@ -1024,10 +1373,10 @@ private:
     // touched on the audio thread (mixAudioInternal), no atomicity needed.
     uint64_t framePosition_ = 0;
 
-    // FFT analysis ring buffer
+    // FFT analysis ring buffer (ANALYSIS_RING_SIZE frames, written only by
+    // the audio thread; frame f lives at f & (ANALYSIS_RING_SIZE - 1)).
     std::vector<float> analysisBuffer_;
-    size_t analysisWritePos_ = 0;
-    std::mutex analysisMutex_;
+    std::atomic<uint64_t> analysisPosition_{0};
 };
 
 // ---------------------------------------------------------------------------
@@ -1101,7 +1450,7 @@ public:
     // doc comment above for when to prefer this over load().
     //
     // Limitations vs eager load():
-    //   - setSpeed() is ignored (decoder outputs engine-rate frames).
+    //   - setSpeed() is limited to [0, 10] (no reverse playback).
     //   - setPosition() incurs a seek + ring-buffer refill (~10 ms).
     //
     // Web (Emscripten): streaming relies on std::thread + on-disk file I/O,
@@ -1149,6 +1498,13 @@ public:
         buffer_ = buf;  // upcast SoundBuffer -> SoundSource via shared_ptr conversion
     }
 
+    // Play a synthesizer (e.g. ChipSoundSynth) rendered live in the mixer.
+    // Keep your own shared_ptr to change its parameters while it plays.
+    void loadSynth(std::shared_ptr<SoundSynth> synth) {
+        if (!AudioEngine::getInstance().isInitialized()) AudioEngine::getInstance().init();
+        buffer_ = std::move(synth);
+    }
+
     bool isLoaded() const { return buffer_ != nullptr; }
 
     // True for streams loaded via loadStream(); false for eager loads.
@@ -1178,15 +1534,21 @@ public:
         // Stop if already playing
         stop();
 
-        playing_ = AudioEngine::getInstance().play(buffer_);
+        // Configure the voice fully before the audio thread can see it.
+        auto& engine = AudioEngine::getInstance();
+        playing_ = engine.createVoice(buffer_);
         if (playing_) {
             playing_->volume = volume_;
             playing_->pan = pan_;
             playing_->speed = speed_;
             playing_->loop = loop_;
             playing_->mixMode.store((int)mixMode_, std::memory_order_release);
-            internal::sharedStore(playing_->channelMap,   channelMap_);
-            internal::sharedStore(playing_->channelGains, channelGains_);
+            playing_->resampleQuality.store((int)resampleQuality_, std::memory_order_relaxed);
+            playing_->priority.store(priority_, std::memory_order_relaxed);
+            playing_->channelMap = channelMap_;
+            playing_->channelGains = channelGains_;
+            playing_->bus = bus_;
+            if (!engine.startVoice(playing_)) playing_.reset();
         }
     }
 
@@ -1250,13 +1612,14 @@ public:
     //   - Streaming voices: [0, 10]. Negative is currently clamped to 0
     //     because reverse streaming would need direction-aware ring fill +
     //     per-chunk reverse, not yet implemented. Zero = freeze.
+    //   - Synth voices: [0, 10], like streams (time only runs forward).
     //
     // Values outside [-10, 10] are clamped.
     void setSpeed(float speed) {
         if (speed < -10.0f) speed = -10.0f;
         if (speed >  10.0f) speed =  10.0f;
-        // Streams don't support reverse yet — clamp away the negative half.
-        if (buffer_ && buffer_->kind() == SoundSource::Stream && speed < 0.0f) {
+        // Streams and synths don't play in reverse — clamp away the negative half.
+        if (buffer_ && buffer_->kind() != SoundSource::Eager && speed < 0.0f) {
             speed = 0.0f;
         }
         speed_ = speed;
@@ -1267,6 +1630,49 @@ public:
 
     float getSpeed() const { return speed_; }
 
+    // Interpolator for speed / sample-rate conversion (see ResampleQuality).
+    // Works for eager and streaming sounds; safe while playing. Selecting a
+    // sinc quality the first time builds its coefficient table here (a few
+    // ms for Sinc64), never on the audio thread.
+    void setResampleQuality(ResampleQuality q) {
+        if (q != ResampleQuality::Linear) soundmix::SincTable::get((int)q);
+        resampleQuality_ = q;
+        if (playing_) {
+            playing_->resampleQuality.store((int)q, std::memory_order_relaxed);
+        }
+    }
+
+    ResampleQuality getResampleQuality() const { return resampleQuality_; }
+
+    // Voice priority for the engine's voice manager: when voices run out or
+    // the real-voice budget is exceeded, higher-priority sounds win
+    // (default 0; negative values are fine).
+    void setPriority(int priority) {
+        priority_ = priority;
+        if (playing_) {
+            playing_->priority.store(priority, std::memory_order_relaxed);
+        }
+    }
+
+    int getPriority() const { return priority_; }
+
+    // Route this sound through a bus of AudioEngine::getGraph() (null =
+    // master). Applies to the playing voice too.
+    void setBus(std::shared_ptr<AudioBus> bus) {
+        bus_ = std::move(bus);
+        if (playing_ && playing_->playing) {
+            AudioEngine::getInstance().setVoiceBus(playing_, bus_);
+        }
+    }
+
+    std::shared_ptr<AudioBus> getBus() const { return bus_; }
+
+    // True while the voice exists but is not being mixed (inaudible or
+    // outranked; see AudioEngine "Voice management").
+    bool isVirtual() const {
+        return playing_ && playing_->playing && playing_->isVirtual.load(std::memory_order_relaxed);
+    }
+
     // -------------------------------------------------------------------------
     // Channel routing
     // -------------------------------------------------------------------------
@@ -1327,7 +1733,7 @@ public:
                 : std::make_shared<const std::vector<std::vector<int>>>(std::move(map));
         channelMap_ = sp;
         if (playing_) {
-            internal::sharedStore(playing_->channelMap, sp);
+            AudioEngine::getInstance().setVoiceRouting(playing_, channelMap_, channelGains_);
         }
     }
 
@@ -1345,7 +1751,7 @@ public:
                 : std::make_shared<const std::vector<float>>(gains);
         channelGains_ = sp;
         if (playing_) {
-            internal::sharedStore(playing_->channelGains, sp);
+            AudioEngine::getInstance().setVoiceRouting(playing_, channelMap_, channelGains_);
         }
     }
 
@@ -1378,14 +1784,15 @@ public:
         if (!playing_ || !buffer_) return;
         double pos = seconds * buffer_->sampleRate;
         if (pos < 0) pos = 0;
-        // For eager: clamp to numSamples. For streams: clamp to duration
-        // (decoder seek happens lazily in the stream mixer).
+        // For eager: clamp to numSamples. For streams and synths: clamp to
+        // duration (decoder seek / synth seek happens lazily in the mixer).
         if (buffer_->kind() == SoundSource::Eager) {
             auto* eager = static_cast<const SoundBuffer*>(buffer_.get());
             if (pos >= (double)eager->numSamples) pos = (double)eager->numSamples - 1;
         } else {
+            // A synth with no fixed length (duration 0) can go anywhere.
             double maxPos = (double)buffer_->getDuration() * buffer_->sampleRate;
-            if (pos >= maxPos) pos = maxPos - 1;
+            if (maxPos > 0.0 && pos >= maxPos) pos = maxPos - 1;
         }
         playing_->positionF = pos;
     }
@@ -1402,6 +1809,9 @@ private:
     float   speed_   = 1.0f;
     bool    loop_    = false;
     MixMode mixMode_ = MixMode::Auto;
+    ResampleQuality resampleQuality_ = ResampleQuality::Linear;
+    int     priority_ = 0;
+    std::shared_ptr<AudioBus> bus_;
     std::shared_ptr<const std::vector<std::vector<int>>> channelMap_;
     std::shared_ptr<const std::vector<float>>            channelGains_;
 };
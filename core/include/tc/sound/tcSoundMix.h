@@ -0,0 +1,539 @@
+#pragma once
+
+// =============================================================================
+// tcSoundMix.h - block mixing kernels for eager (fully decoded) voices
+// =============================================================================
+//
+// AudioEngine::mixEagerVoice() used to do everything per output frame:
+// resolve loop / end bounds, evaluate an interpolation lambda per output
+// channel and branch on channel map / mix mode in the innermost loop. These
+// kernels split the work into runs of up to RUN_FRAMES frames:
+//
+//   1. walk     one scalar pass advances the play head until the next loop or
+//               end boundary (or the end of the run) and records the two
+//               source frame offsets + the fraction for every output frame
+//   2. render   one tight loop per routing case over the whole run:
+//                 mono -> N     interpolate once, add to every output channel
+//                 N -> N        one source channel per output channel
+//                 downmix       sum + average, then broadcast
+//                 explicit map  per output: sum of the mapped channels
+//               At speed * rateRatio == 1 the run is contiguous and the loops
+//               read the source directly instead of gathering.
+//
+// Every sample is computed with exactly the expressions of the old per-frame
+// loop, in the same order (lerp, per-output sum, * gain * pan * volume), so
+// the output is bit-identical to it. That is also why these are plain loops
+// the compiler vectorizes rather than hand-written intrinsics: an explicit
+// multiply-add would round differently from the scalar code wherever the
+// compiler contracts to FMA (clang on arm64).
+//
+// mixSinc() is the same structure with a band-limited interpolator: a
+// polyphase windowed-sinc filter (8 / 16 / 32 / 64 taps, Kaiser window) whose
+// coefficient rows are precomputed per cutoff band, so pitching up (step > 1)
+// switches to a lower cutoff instead of aliasing. Taps are interpolated
+// between adjacent phase rows and the dot products use tcSimd.h. Selected
+// per voice with Sound::setResampleQuality(); linear stays the default.
+//
+// mixPlanar() routes a block that was rendered rather than resampled
+// (SoundSynth voices) through the same routing code.
+//
+// clipAndTap() fuses the engine's final clip pass with the mono copy into the
+// analysis ring.
+//
+// Header-only and independent of the engine, so core/tests/soundMix can check
+// the kernels against the old loop.
+// =============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "tc/utils/tcSimd.h"
+
+namespace trussc {
+namespace soundmix {
+
+// Output frames rendered per run (bounds the stack scratch to ~6 KB).
+constexpr int RUN_FRAMES = 256;
+
+// Interleaved source samples.
+struct Source {
+    const float* samples = nullptr;
+    size_t numFrames = 0;
+    int channels = 1;
+};
+
+// Routing for one voice, resolved once per callback.
+//   map    non-null/non-empty: out[c] = sum of src[s] for s in map[c]
+//   else   downmixMono: average of all source channels to every output
+//   else   mono source broadcasts, multi-channel routes 1:1 (truncated)
+// gains scale per output channel (entries beyond size() = 1.0); panL / panR
+// apply to outputs 0 / 1 only.
+struct Routing {
+    const std::vector<std::vector<int>>* map = nullptr;
+    const std::vector<float>* gains = nullptr;
+    bool downmixMono = false;
+    float panL = 1.0f;
+    float panR = 1.0f;
+    float volume = 1.0f;
+};
+
+namespace detail {
+
+struct Run {
+    size_t offset0[RUN_FRAMES];   // element offset of frame pos0 (pos0 * channels)
+    size_t offset1[RUN_FRAMES];   // element offset of the frame interpolated towards
+    float frac[RUN_FRAMES];
+    int count = 0;
+    bool contiguous = false;      // offset0[i] = offset0[0] + i * ch, offset1 = offset0 + ch
+};
+
+// Advance posF over at most maxFrames output frames, stopping at the first
+// position outside [0, srcLen) (left for the caller to wrap or end on).
+inline void walk(const Source& src, double& posF, double posStep, bool loop,
+                 int maxFrames, Run& run) {
+    const double srcLen = (double)src.numFrames;
+    const size_t ch = (size_t)src.channels;
+    int n = 0;
+    while (n < maxFrames && posF >= 0.0 && posF < srcLen) {
+        size_t pos0 = (size_t)posF;
+        size_t pos1 = pos0 + 1;
+        if (pos1 >= src.numFrames) pos1 = loop ? 0 : pos0;
+        run.offset0[n] = pos0 * ch;
+        run.offset1[n] = pos1 * ch;
+        run.frac[n] = (float)(posF - (double)pos0);
+        posF += posStep;
+        n++;
+    }
+    run.count = n;
+    run.contiguous = posStep == 1.0 && n > 0
+        && run.offset0[n - 1] - run.offset0[0] == (size_t)(n - 1) * ch
+        && run.offset1[n - 1] == run.offset0[n - 1] + ch;
+}
+
+// dst[i] = (Accumulate ? dst[i] + : ) lerp of source channel s over the run.
+template<bool Accumulate>
+inline void lerpChannel(const Source& src, const Run& run, int s, float* dst) {
+    const int n = run.count;
+    const float* frac = run.frac;
+    if (run.contiguous) {
+        const size_t ch = (size_t)src.channels;
+        const float* p = src.samples + run.offset0[0] + (size_t)s;
+        for (int i = 0; i < n; i++) {
+            float a = p[(size_t)i * ch];
+            float b = p[(size_t)(i + 1) * ch];
+            float v = a + (b - a) * frac[i];
+            if constexpr (Accumulate) dst[i] += v;
+            else dst[i] = v;
+        }
+    } else {
+        const float* p = src.samples + (size_t)s;
+        const size_t* o0 = run.offset0;
+        const size_t* o1 = run.offset1;
+        for (int i = 0; i < n; i++) {
+            float a = p[o0[i]];
+            float b = p[o1[i]];
+            float v = a + (b - a) * frac[i];
+            if constexpr (Accumulate) dst[i] += v;
+            else dst[i] = v;
+        }
+    }
+}
+
+// out[i * stride] += sample[i] * gain * pan * volume
+inline void addScaled(const float* sample, int n, float gain, float pan, float volume,
+                      float* out, int stride) {
+    for (int i = 0; i < n; i++) {
+        out[(size_t)i * stride] += sample[i] * gain * pan * volume;
+    }
+}
+
+// Route one run of resampled source channels into out. fetch(s, dst, acc)
+// writes (acc = false) or adds (acc = true) source channel s for the run.
+template<class Fetch>
+inline void route(const Fetch& fetch, int srcCh, int n, const Routing& r,
+                  float* out, int outCh) {
+    const int mapSize = r.map ? (int)r.map->size() : 0;
+    const int gainsSize = r.gains ? (int)r.gains->size() : 0;
+    auto gainOf = [&](int c) { return c < gainsSize ? (*r.gains)[c] : 1.0f; };
+    auto panOf = [&](int c) { return c == 0 ? r.panL : (c == 1 ? r.panR : 1.0f); };
+
+    float sample[RUN_FRAMES];
+    if (srcCh <= 0) return;
+
+    if (mapSize > 0) {
+        // Explicit map. Outputs beyond the map (and empty entries) are
+        // silent and left untouched; out-of-range sources contribute 0.
+        for (int c = 0; c < std::min(mapSize, outCh); c++) {
+            bool any = false;
+            for (int s : (*r.map)[c]) {
+                if (s < 0 || s >= srcCh) continue;
+                fetch(s, sample, any);
+                any = true;
+            }
+            if (any) addScaled(sample, n, gainOf(c), panOf(c), r.volume, out + c, outCh);
+        }
+        return;
+    }
+
+    if (r.downmixMono || srcCh == 1) {
+        // One signal to every output: mono source, or the average of all
+        // source channels.
+        fetch(0, sample, false);
+        if (r.downmixMono && srcCh > 1) {
+            for (int s = 1; s < srcCh; s++) fetch(s, sample, true);
+            const float div = (float)srcCh;
+            for (int i = 0; i < n; i++) sample[i] /= div;
+        }
+        for (int c = 0; c < outCh; c++) {
+            addScaled(sample, n, gainOf(c), panOf(c), r.volume, out + c, outCh);
+        }
+        return;
+    }
+
+    // N -> N, truncated; outputs without a source channel stay silent.
+    for (int c = 0; c < std::min(srcCh, outCh); c++) {
+        fetch(c, sample, false);
+        addScaled(sample, n, gainOf(c), panOf(c), r.volume, out + c, outCh);
+    }
+}
+
+inline void render(const Source& src, const Run& run, const Routing& r,
+                   float* out, int outCh) {
+    auto lerp = [&](int s, float* dst, bool accumulate) {
+        if (accumulate) lerpChannel<true>(src, run, s, dst);
+        else lerpChannel<false>(src, run, s, dst);
+    };
+    route(lerp, src.channels, run.count, r, out, outCh);
+}
+
+} // namespace detail
+
+// Mix numFrames of a linearly interpolated voice into out (interleaved,
+// outCh channels), advancing posF by posStep source frames per output frame.
+// posStep may be negative (reverse) or 0 (freeze). Returns false when a
+// non-looping voice ran off either end (posF is left where it stopped).
+inline bool mixLinear(const Source& src, double& posF, double posStep, bool loop,
+                      const Routing& routing, float* out, int numFrames, int outCh) {
+    if (src.numFrames == 0 || !src.samples) return false;
+    const double srcLen = (double)src.numFrames;
+    detail::Run run;
+
+    int frame = 0;
+    while (frame < numFrames) {
+        // Resolve bounds for both directions BEFORE indexing.
+        if (posF < 0.0) {
+            if (!loop) return false;
+            posF += srcLen;
+            // Defensive: very large negative step could still be < 0.
+            if (posF < 0.0) posF = std::fmod(posF, srcLen) + srcLen;
+        }
+        if (posF >= srcLen) {
+            if (!loop) return false;
+            posF -= srcLen;
+            if (posF >= srcLen) posF = std::fmod(posF, srcLen);
+        }
+
+        detail::walk(src, posF, posStep, loop, std::min(RUN_FRAMES, numFrames - frame), run);
+        if (run.count == 0) return false;   // NaN position
+        detail::render(src, run, routing, out + (size_t)frame * outCh, outCh);
+        frame += run.count;
+    }
+    return true;
+}
+
+// Mix n (<= RUN_FRAMES) frames of planar source audio rendered on the fly
+// (channel s at planes + s * RUN_FRAMES, e.g. a SoundSynth block) into out,
+// with the same routing as the resampling paths.
+inline void mixPlanar(const float* planes, int srcCh, int n, const Routing& routing,
+                      float* out, int outCh) {
+    auto fetch = [&](int s, float* dst, bool accumulate) {
+        const float* p = planes + (size_t)s * RUN_FRAMES;
+        if (accumulate) {
+            for (int i = 0; i < n; i++) dst[i] += p[i];
+        } else {
+            std::memcpy(dst, p, (size_t)n * sizeof(float));
+        }
+    };
+    detail::route(fetch, srcCh, n, routing, out, outCh);
+}
+
+// ---------------------------------------------------------------------------
+// Windowed-sinc resampling
+// ---------------------------------------------------------------------------
+
+// Sources with more channels than this always use linear interpolation.
+constexpr int MAX_SINC_CHANNELS = 8;
+
+// Polyphase coefficient table for one tap count. Tables are immutable and
+// shared process-wide; get() builds one on first use (~taps * 10 KB, a few
+// ms for 64 taps), find() only looks it up, so the audio thread uses find()
+// and the UI thread calls get() when a voice selects the quality.
+class SincTable {
+public:
+    static constexpr int PHASES = 256;   // rows per band (+1 for frac -> 1)
+    static constexpr int BANDS = 10;     // cutoff 2^(-b/3): steps up to 8x alias-free
+    static constexpr int MAX_TAPS = 64;
+
+    // 8 / 16 / 32 / 64 (other values round up; <= 0 returns nullptr).
+    static const SincTable* get(int taps) {
+        const int index = slotIndex(taps);
+        if (index < 0) return nullptr;
+        auto& slot = slots()[index];
+        if (const SincTable* t = slot.load(std::memory_order_acquire)) return t;
+        static std::mutex buildMutex;
+        std::lock_guard<std::mutex> lock(buildMutex);
+        const SincTable* t = slot.load(std::memory_order_acquire);
+        if (!t) {
+            t = new SincTable(8 << index);   // never freed: voices may still read it at exit
+            slot.store(t, std::memory_order_release);
+        }
+        return t;
+    }
+
+    static const SincTable* find(int taps) {
+        const int index = slotIndex(taps);
+        return index < 0 ? nullptr : slots()[index].load(std::memory_order_acquire);
+    }
+
+    int getTaps() const { return taps_; }
+
+    // Frames before the centre frame i in the filter window
+    // [i - history, i - history + taps).
+    int getHistory() const { return taps_ / 2 - 1; }
+
+    // Band for a step of |step| source frames per output frame: the first
+    // band whose cutoff is at or below the output Nyquist.
+    static int bandFor(double step) {
+        step = std::fabs(step);
+        if (!(step > 1.0)) return 0;
+        int b = (int)std::ceil(3.0 * std::log2(step) - 1e-9);
+        return std::clamp(b, 0, BANDS - 1);
+    }
+
+    // Coefficients for fractional position frac in [0, 1): the two nearest
+    // phase rows, linearly interpolated.
+    void coefficients(int band, float frac, float* out) const {
+        using namespace internal::simd;
+        float p = frac * (float)PHASES;
+        int i = std::clamp((int)p, 0, PHASES - 1);
+        const f32x4 f = set1(p - (float)i);
+        const float* r0 = rows_.data() + ((size_t)band * (PHASES + 1) + (size_t)i) * (size_t)taps_;
+        const float* r1 = r0 + taps_;
+        for (int k = 0; k < taps_; k += 4) {
+            f32x4 a = load(r0 + k);
+            store(out + k, madd(a, sub(load(r1 + k), a), f));
+        }
+    }
+
+private:
+    explicit SincTable(int taps) : taps_(taps) {
+        // Kaiser beta / passband edge per size: longer filters afford a
+        // sharper transition closer to Nyquist.
+        const double beta = taps <= 8 ? 5.0 : taps <= 16 ? 6.5 : taps <= 32 ? 8.0 : 9.5;
+        const double rolloff = taps <= 8 ? 0.80 : taps <= 16 ? 0.88 : taps <= 32 ? 0.93 : 0.96;
+        const int history = taps / 2 - 1;
+        const double half = taps / 2.0;
+        const double i0Beta = besselI0(beta);
+        rows_.resize((size_t)BANDS * (PHASES + 1) * (size_t)taps);
+        std::vector<double> h(taps);
+
+        for (int b = 0; b < BANDS; b++) {
+            const double fc = rolloff * std::exp2(-b / 3.0);
+            for (int p = 0; p <= PHASES; p++) {
+                const double frac = (double)p / PHASES;
+                float* row = rows_.data() + ((size_t)b * (PHASES + 1) + (size_t)p) * (size_t)taps;
+                double sum = 0.0;
+                for (int k = 0; k < taps; k++) {
+                    const double x = (double)(k - history) - frac;
+                    const double w = x / half;
+                    const double win = std::fabs(w) >= 1.0 ? 0.0
+                                     : besselI0(beta * std::sqrt(1.0 - w * w)) / i0Beta;
+                    const double px = 3.14159265358979323846 * fc * x;
+                    const double sinc = std::fabs(px) < 1e-12 ? 1.0 : std::sin(px) / px;
+                    h[k] = fc * sinc * win;
+                    sum += h[k];
+                }
+                // Unity DC gain for every phase (no ripple at the row rate).
+                for (int k = 0; k < taps; k++) row[k] = (float)(h[k] / sum);
+            }
+        }
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64; k++) {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+            if (term < sum * 1e-17) break;
+        }
+        return sum;
+    }
+
+    static int slotIndex(int taps) {
+        if (taps <= 0) return -1;
+        return taps <= 8 ? 0 : taps <= 16 ? 1 : taps <= 32 ? 2 : 3;
+    }
+
+    static std::atomic<const SincTable*>* slots() {
+        static std::atomic<const SincTable*> instances[4] = {};
+        return instances;
+    }
+
+    int taps_;
+    std::vector<float> rows_;   // [band][phase][tap]
+};
+
+namespace detail {
+
+// Dot product of taps (a multiple of 4) contiguous samples.
+inline float dot1(const float* x, const float* h, int taps) {
+    using namespace internal::simd;
+    f32x4 acc = zero();
+    for (int k = 0; k < taps; k += 4) acc = madd(acc, load(x + k), load(h + k));
+    float v[4];
+    store(v, acc);
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+// Both channels of an interleaved stereo window in one pass.
+inline void dot2(const float* x, const float* h, int taps, float& left, float& right) {
+    using namespace internal::simd;
+    f32x4 acc = zero();
+    for (int k = 0; k < taps; k += 4) {
+        f32x4 hk = load(h + k);
+        acc = madd(acc, load(x + 2 * k), zipLo(hk, hk));       // L0 R0 L1 R1
+        acc = madd(acc, load(x + 2 * k + 4), zipHi(hk, hk));   // L2 R2 L3 R3
+    }
+    float v[4];
+    store(v, acc);
+    left = v[0] + v[2];
+    right = v[1] + v[3];
+}
+
+// Filter one interleaved window (taps frames, ch channels) into
+// dst[s * stride] for every source channel s.
+inline void filterWindow(const float* win, int ch, const float* coef, int taps,
+                         float* dst, int stride) {
+    if (ch == 1) {
+        dst[0] = dot1(win, coef, taps);
+    } else if (ch == 2) {
+        dot2(win, coef, taps, dst[0], dst[stride]);
+    } else {
+        for (int s = 0; s < ch; s++) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps; k++) acc += win[(size_t)k * ch + s] * coef[k];
+            dst[(size_t)s * stride] = acc;
+        }
+    }
+}
+
+} // namespace detail
+
+// Mix numFrames of a voice resampled with `table` (see mixLinear for the
+// arguments and result). Outside the source the window reads the other end
+// when looping, silence otherwise. Sources with more than
+// MAX_SINC_CHANNELS channels fall back to mixLinear.
+inline bool mixSinc(const Source& src, double& posF, double posStep, bool loop,
+                    const SincTable& table, const Routing& routing,
+                    float* out, int numFrames, int outCh) {
+    if (src.channels > MAX_SINC_CHANNELS) {
+        return mixLinear(src, posF, posStep, loop, routing, out, numFrames, outCh);
+    }
+    if (src.numFrames == 0 || !src.samples) return false;
+
+    const double srcLen = (double)src.numFrames;
+    const int ch = src.channels;
+    const int taps = table.getTaps();
+    const int history = table.getHistory();
+    const int band = SincTable::bandFor(posStep);
+    const int64_t numSrc = (int64_t)src.numFrames;
+
+    constexpr int PLANAR = MAX_SINC_CHANNELS * RUN_FRAMES / 2;
+    const int runMax = std::min(RUN_FRAMES, PLANAR / std::max(ch, 1));
+    float planar[PLANAR];
+    float coef[SincTable::MAX_TAPS];
+    float window[SincTable::MAX_TAPS * MAX_SINC_CHANNELS];
+
+    int frame = 0;
+    while (frame < numFrames) {
+        // Resolve bounds for both directions BEFORE indexing (as mixLinear).
+        if (posF < 0.0) {
+            if (!loop) return false;
+            posF += srcLen;
+            if (posF < 0.0) posF = std::fmod(posF, srcLen) + srcLen;
+        }
+        if (posF >= srcLen) {
+            if (!loop) return false;
+            posF -= srcLen;
+            if (posF >= srcLen) posF = std::fmod(posF, srcLen);
+        }
+
+        const int maxN = std::min(runMax, numFrames - frame);
+        int n = 0;
+        while (n < maxN && posF >= 0.0 && posF < srcLen) {
+            const int64_t i = (int64_t)posF;
+            table.coefficients(band, (float)(posF - (double)i), coef);
+            const int64_t start = i - history;
+            const float* win;
+            if (start >= 0 && start + taps <= numSrc) {
+                win = src.samples + (size_t)start * ch;
+            } else {
+                for (int k = 0; k < taps; k++) {
+                    int64_t idx = start + k;
+                    float* w = window + (size_t)k * ch;
+                    if (loop) {
+                        idx %= numSrc;
+                        if (idx < 0) idx += numSrc;
+                    } else if (idx < 0 || idx >= numSrc) {
+                        std::memset(w, 0, sizeof(float) * ch);
+                        continue;
+                    }
+                    std::memcpy(w, src.samples + (size_t)idx * ch, sizeof(float) * ch);
+                }
+                win = window;
+            }
+            detail::filterWindow(win, ch, coef, taps, planar + n, runMax);
+            posF += posStep;
+            n++;
+        }
+        if (n == 0) return false;   // NaN position
+
+        auto fetch = [&](int s, float* dst, bool accumulate) {
+            const float* p = planar + (size_t)s * runMax;
+            if (accumulate) {
+                for (int k = 0; k < n; k++) dst[k] += p[k];
+            } else {
+                std::memcpy(dst, p, sizeof(float) * n);
+            }
+        };
+        detail::route(fetch, ch, n, routing, out + (size_t)frame * outCh, outCh);
+        frame += n;
+    }
+    return true;
+}
+
+// Final pass over the mixed block: clamp to [-1, 1] and append the mono mix
+// ((L + R) / 2, or ch 0 for mono output) of the clamped frames to the
+// analysis ring at writePos.
+inline void clipAndTap(float* buffer, int numFrames, int channels,
+                       float* ring, size_t ringSize, size_t& writePos) {
+    size_t pos = writePos;
+    for (int frame = 0; frame < numFrames; frame++) {
+        float* f = buffer + (size_t)frame * channels;
+        for (int c = 0; c < channels; c++) {
+            f[c] = std::min(std::max(f[c], -1.0f), 1.0f);
+        }
+        ring[pos] = channels > 1 ? (f[0] + f[1]) * 0.5f : f[0];
+        if (++pos == ringSize) pos = 0;
+    }
+    writePos = pos;
+}
+
+} // namespace soundmix
+} // namespace trussc
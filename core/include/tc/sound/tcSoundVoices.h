@@ -0,0 +1,157 @@
+#pragma once
+
+// =============================================================================
+// tcSoundVoices.h - voice management decisions for AudioEngine
+// =============================================================================
+//
+// The policy half of AudioEngine's voice management, kept apart from the
+// engine's atomics and queues:
+//
+//   assignReal()       which live voices are mixed (real) this block and
+//                      which only advance (virtual)
+//   pickStealVictim()  which voice a new sound takes over when all
+//                      maxPolyphony voices are in use
+//   addFaded()         the gain ramp a voice is mixed through while it
+//                      changes state, so no switch is a hard cut
+//
+// Both decisions have hysteresis: a virtual voice has to clear the
+// audibility threshold by AUDIBILITY_HYSTERESIS to come back, and a voice
+// that is real ranks as if AUDIBILITY_HYSTERESIS louder, so two voices of
+// similar level don't trade places every block.
+//
+// Header-only and independent of the engine, so core/tests/soundMix can
+// check it.
+// =============================================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace trussc {
+
+// ---------------------------------------------------------------------------
+// VoiceStealPolicy — what play() does once all maxPolyphony voices are
+// taken (AudioEngine::setVoiceStealPolicy). A voice is never stolen by a
+// sound of lower priority; among the rest the policy picks:
+//
+//   None            — reject the new sound (default)
+//   Oldest          — the voice started first
+//   Quietest        — the voice with the lowest audibility
+//   LowestPriority  — the lowest-priority voice (oldest among equals)
+//
+// The stolen voice fades out over FADE_SECONDS while the new one starts.
+// ---------------------------------------------------------------------------
+enum class VoiceStealPolicy {
+    None = 0,
+    Oldest,
+    Quietest,
+    LowestPriority,
+};
+
+namespace soundmix {
+
+// Length of the gain ramp when a voice goes real <-> virtual or is stolen.
+constexpr double FADE_SECONDS = 0.005;
+
+// +3 dB: the margin a voice needs over the threshold to leave the virtual
+// state, and the head start a real voice gets when ranked against the
+// maxRealVoices cutoff.
+constexpr float AUDIBILITY_HYSTERESIS = 1.4125f;
+
+// One voice as the decisions see it. `real` is the state it was in last
+// block on input and the state it is in this block after assignReal().
+// `id` is the caller's handle back to the voice.
+struct VoiceInfo {
+    int      priority   = 0;
+    float    audibility = 1.0f;
+    uint64_t startOrder = 0;
+    bool     real       = true;
+    int      id         = 0;
+};
+
+struct VoiceCounts {
+    int real = 0;
+    int virtualVoices = 0;
+};
+
+// Ranking order for the maxRealVoices cutoff: priority, then audibility
+// (with the real voices' head start), then start order (newer voices lose
+// ties).
+inline bool moreImportant(const VoiceInfo& a, const VoiceInfo& b) {
+    if (a.priority != b.priority) return a.priority > b.priority;
+    const float qa = a.real ? a.audibility * AUDIBILITY_HYSTERESIS : a.audibility;
+    const float qb = b.real ? b.audibility * AUDIBILITY_HYSTERESIS : b.audibility;
+    if (qa != qb) return qa > qb;
+    return a.startOrder < b.startOrder;
+}
+
+// Decide which of n voices are real this block (budget 0 = no limit).
+// A voice below `threshold` is virtual — below threshold x
+// AUDIBILITY_HYSTERESIS if it was virtual already — and of the audible
+// ones only the `budget` most important stay real. Reorders v (O(n),
+// nth_element); read the results back through VoiceInfo::id.
+inline VoiceCounts assignReal(VoiceInfo* v, int n, float threshold, int budget) {
+    VoiceInfo* audibleEnd = std::partition(v, v + n, [threshold](const VoiceInfo& x) {
+        return x.audibility >= (x.real ? threshold : threshold * AUDIBILITY_HYSTERESIS);
+    });
+    int real = (int)(audibleEnd - v);
+    if (budget > 0 && real > budget) {
+        std::nth_element(v, v + budget, audibleEnd, moreImportant);
+        real = budget;
+    }
+    for (int k = 0; k < n; k++) v[k].real = k < real;
+    return {real, n - real};
+}
+
+// Index of the voice a new sound of `priority` takes over under `policy`,
+// or -1. Voices of higher priority than the newcomer are never candidates.
+// get(i) returns the VoiceInfo of voice i (its `real` and `id` are unused).
+template<class Get>
+inline int pickStealVictim(VoiceStealPolicy policy, int priority, int n, const Get& get) {
+    if (policy == VoiceStealPolicy::None) return -1;
+
+    int best = -1;
+    VoiceInfo b;
+    for (int i = 0; i < n; i++) {
+        const VoiceInfo a = get(i);
+        if (a.priority > priority) continue;
+        bool better = best < 0;
+        if (!better) {
+            switch (policy) {
+                case VoiceStealPolicy::Oldest:
+                    better = a.startOrder < b.startOrder;
+                    break;
+                case VoiceStealPolicy::Quietest:
+                    better = a.audibility < b.audibility
+                          || (a.audibility == b.audibility && a.startOrder < b.startOrder);
+                    break;
+                case VoiceStealPolicy::LowestPriority:
+                    better = a.priority < b.priority
+                          || (a.priority == b.priority && a.startOrder < b.startOrder);
+                    break;
+                case VoiceStealPolicy::None:
+                    break;
+            }
+        }
+        if (better) { best = i; b = a; }
+    }
+    return best;
+}
+
+// out += src * gain over `frames` interleaved frames, with the gain moving
+// from `gain` toward `target` by `step` per frame (reaching it exactly,
+// then holding). Returns the gain after the last frame.
+inline float addFaded(const float* src, float* out, int frames, int channels,
+                      float gain, float target, float step) {
+    for (int i = 0; i < frames; i++) {
+        gain = target > gain ? std::min(target, gain + step)
+                             : std::max(target, gain - step);
+        const float* s = src + (size_t)i * channels;
+        float* o = out + (size_t)i * channels;
+        for (int c = 0; c < channels; c++) o[c] += s[c] * gain;
+    }
+    return gain;
+}
+
+} // namespace soundmix
+} // namespace trussc
@@ -0,0 +1,154 @@
+// =============================================================================
+// tcBlockFileWriter.cpp - BlockFileWriter implementation
+// =============================================================================
+
+#include "tc/utils/tcBlockFileWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trussc {
+
+namespace {
+constexpr std::size_t PAGE = 4096;
+}
+
+bool BlockFileWriter::open(const fs::path& path, std::size_t bufferBytes, std::uint64_t reserveBytes) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE h = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                           nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    handle_ = h;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    handle_ = fd;
+#endif
+
+    capacity_ = std::max<std::size_t>(PAGE, (bufferBytes + PAGE - 1) / PAGE * PAGE);
+    buffer_ = static_cast<std::uint8_t*>(::operator new(capacity_, std::align_val_t(PAGE)));
+    staged_ = 0;
+    written_ = 0;
+    reserveBytes_ = reserveBytes;
+    reserved_ = 0;
+    good_ = true;
+    reserve(reserveBytes_);
+    return true;
+}
+
+bool BlockFileWriter::close() {
+    if (!isOpen()) return good_;
+    flush();
+#if defined(_WIN32)
+    // NTFS drops allocation past end-of-file when the last handle closes.
+    CloseHandle(handle_);
+#else
+    // Preallocated space past the end is kept reserved (KEEP_SIZE /
+    // F_PREALLOCATE never move end-of-file); truncating to the real size
+    // hands it back.
+    if (reserved_ > written_ && ftruncate(handle_, (off_t)written_) != 0) good_ = false;
+    ::close(handle_);
+#endif
+    handle_ = INVALID;
+    ::operator delete(buffer_, std::align_val_t(PAGE));
+    buffer_ = nullptr;
+    capacity_ = staged_ = 0;
+    return good_;
+}
+
+bool BlockFileWriter::write(const void* data, std::size_t size) {
+    if (!isOpen()) return false;
+    const auto* src = static_cast<const std::uint8_t*>(data);
+    while (size > 0) {
+        const std::size_t take = std::min(size, capacity_ - staged_);
+        std::memcpy(buffer_ + staged_, src, take);
+        staged_ += take;
+        src += take;
+        size -= take;
+        if (staged_ == capacity_ && !flush()) return false;
+    }
+    return good_;
+}
+
+bool BlockFileWriter::writeAt(std::uint64_t offset, const void* data, std::size_t size) {
+    if (!isOpen() || offset + size > tell()) return false;
+    if (!flush()) return false;
+    return writeRaw(offset, data, size);
+}
+
+bool BlockFileWriter::flush() {
+    if (!isOpen()) return false;
+    if (staged_ == 0) return good_;
+    if (written_ + staged_ > reserved_) reserve(written_ + staged_ + reserveBytes_);
+    const bool ok = writeRaw(written_, buffer_, staged_);
+    written_ += staged_;
+    staged_ = 0;
+    return ok;
+}
+
+bool BlockFileWriter::writeRaw(std::uint64_t offset, const void* data, std::size_t size) {
+    const auto* src = static_cast<const std::uint8_t*>(data);
+    while (size > 0) {
+#if defined(_WIN32)
+        OVERLAPPED at = {};
+        at.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+        at.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD done = 0;
+        const DWORD chunk = (DWORD)std::min<std::size_t>(size, 1u << 30);
+        if (!WriteFile(handle_, src, chunk, &done, &at) || done == 0) {
+            good_ = false;
+            return false;
+        }
+#else
+        const ssize_t done = ::pwrite(handle_, src, size, (off_t)offset);
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) {
+            good_ = false;
+            return false;
+        }
+#endif
+        src += done;
+        offset += (std::uint64_t)done;
+        size -= (std::size_t)done;
+    }
+    return true;
+}
+
+void BlockFileWriter::reserve(std::uint64_t upTo) {
+    if (reserveBytes_ == 0 || upTo <= reserved_) return;
+#if defined(_WIN32)
+    FILE_ALLOCATION_INFO info = {};
+    info.AllocationSize.QuadPart = (LONGLONG)upTo;
+    SetFileInformationByHandle(handle_, FileAllocationInfo, &info, sizeof(info));
+#elif defined(__linux__)
+    // KEEP_SIZE: reserve blocks without moving end-of-file, so a crash
+    // leaves a file as long as what was actually written.
+    fallocate(handle_, FALLOC_FL_KEEP_SIZE, (off_t)reserved_, (off_t)(upTo - reserved_));
+#elif defined(__APPLE__)
+    fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, (off_t)(upTo - reserved_), 0};
+    if (fcntl(handle_, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        fcntl(handle_, F_PREALLOCATE, &store);
+    }
+#endif
+    // Failure is not an error: writes just allocate as they go.
+    reserved_ = upTo;
+}
+
+} // namespace trussc
@@ -0,0 +1,94 @@
+#pragma once
+
+// =============================================================================
+// tcBlockFileWriter.h - sequential binary writer for long-running recordings
+// =============================================================================
+//
+// Appends go into a page-aligned staging buffer and reach the OS only as
+// whole buffers (1 MiB by default) at buffer-aligned offsets, instead of one
+// small write() per audio block. Disk space is reserved ahead of the write
+// position in large extents (fallocate on Linux, F_PREALLOCATE on macOS,
+// FileAllocationInfo on Windows), so a file that grows for hours stays
+// contiguous and a full disk shows up early instead of mid-recording.
+//
+//   tc::BlockFileWriter out;
+//   if (out.open(path)) {
+//       out.write(header, sizeof(header));
+//       while (recording) out.write(block.data(), block.size());
+//       out.writeAt(4, &riffSize, 4);     // patch a header field
+//       out.close();                      // flush, drop unused reservation
+//   }
+//
+// - Not thread-safe: one writer thread owns the object.
+// - Reservation is a hint; if the filesystem can't preallocate, writes still
+//   work and simply allocate as they go.
+// - close() trims the file to the bytes actually written.
+//
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace trussc {
+
+namespace fs = std::filesystem;
+
+class BlockFileWriter {
+public:
+    BlockFileWriter() = default;
+    ~BlockFileWriter() { close(); }
+
+    BlockFileWriter(const BlockFileWriter&) = delete;
+    BlockFileWriter& operator=(const BlockFileWriter&) = delete;
+
+    // Create / truncate `path`. `bufferBytes` is the staging size (rounded
+    // up to 4 KiB); `reserveBytes` is how far ahead of the write position
+    // disk space is kept reserved (0 = never preallocate).
+    bool open(const fs::path& path, std::size_t bufferBytes = 1 << 20,
+              std::uint64_t reserveBytes = 64ull << 20);
+
+    // Flush, release the unused reservation and close. Returns false if any
+    // write since open() failed. Safe to call when not open.
+    bool close();
+
+    bool isOpen() const { return handle_ != INVALID; }
+
+    // Append `size` bytes. Only copies unless the staging buffer fills up.
+    bool write(const void* data, std::size_t size);
+
+    // Overwrite bytes already appended (header fields). Flushes first.
+    bool writeAt(std::uint64_t offset, const void* data, std::size_t size);
+
+    // Push the staged bytes to the OS (not necessarily to disk).
+    bool flush();
+
+    // Bytes appended so far (= file size after close()).
+    std::uint64_t tell() const { return written_ + (std::uint64_t)staged_; }
+
+    // False once any write has failed (e.g. disk full).
+    bool good() const { return good_; }
+
+private:
+#if defined(_WIN32)
+    using Handle = void*;
+    static inline Handle const INVALID = (Handle)(intptr_t)-1;
+#else
+    using Handle = int;
+    static constexpr Handle INVALID = -1;
+#endif
+
+    bool writeRaw(std::uint64_t offset, const void* data, std::size_t size);
+    void reserve(std::uint64_t upTo);
+
+    Handle handle_ = INVALID;
+    std::uint8_t* buffer_ = nullptr;       // aligned staging buffer
+    std::size_t capacity_ = 0;
+    std::size_t staged_ = 0;
+    std::uint64_t written_ = 0;            // bytes handed to the OS
+    std::uint64_t reserveBytes_ = 0;
+    std::uint64_t reserved_ = 0;           // file space reserved up to here
+    bool good_ = true;
+};
+
+} // namespace trussc
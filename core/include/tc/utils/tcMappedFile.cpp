@@ -0,0 +1,104 @@
+// =============================================================================
+// tcMappedFile.cpp - MappedFile implementation
+// =============================================================================
+
+#include "tc/utils/tcMappedFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trussc {
+
+bool MappedFile::open(const fs::path& path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        open_ = true;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);   // the view keeps the mapping alive
+    if (!p) return false;
+    data_ = static_cast<const std::uint8_t*>(p);
+    size_ = (std::size_t)size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        open_ = true;
+        return true;
+    }
+    void* p = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);            // the mapping keeps the file alive
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const std::uint8_t*>(p);
+    size_ = (std::size_t)st.st_size;
+#endif
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+void MappedFile::advise(Access access, std::size_t offset, std::size_t length) const {
+#if defined(_WIN32) || defined(__EMSCRIPTEN__)
+    (void)access; (void)offset; (void)length;
+#else
+    if (!data_ || offset >= size_) return;
+    if (length == 0 || length > size_ - offset) length = size_ - offset;
+
+    // madvise wants a page-aligned start; widen the range down to one.
+    const std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+    const std::size_t start = offset / page * page;
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::Normal:     advice = MADV_NORMAL; break;
+        case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+        case Access::Random:     advice = MADV_RANDOM; break;
+        case Access::WillNeed:   advice = MADV_WILLNEED; break;
+        case Access::DontNeed:   advice = MADV_DONTNEED; break;
+    }
+    madvise(const_cast<std::uint8_t*>(data_) + start, length + (offset - start), advice);
+#endif
+}
+
+} // namespace trussc
@@ -0,0 +1,85 @@
+#pragma once
+
+// =============================================================================
+// tcMappedFile.h - read-only memory-mapped file
+// =============================================================================
+//
+// Maps a whole file into the address space so decoders and parsers can read
+// it as one contiguous byte range instead of going through fread() and a
+// private copy. Pages are faulted in on first touch and live in the OS page
+// cache, so several readers of the same file share one copy of the bytes.
+//
+//   tc::MappedFile file;
+//   if (file.open(path)) {
+//       file.advise(tc::MappedFile::Access::Sequential);
+//       parse(file.data(), file.size());
+//   }
+//
+// - Read-only. The mapping stays valid until close() / destruction; the file
+//   handle itself is released right after mapping.
+// - Empty files open successfully with data() == nullptr and size() == 0.
+// - advise() forwards to madvise() on POSIX and is a hint only (a no-op on
+//   Windows).
+//
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+namespace trussc {
+
+namespace fs = std::filesystem;
+
+class MappedFile {
+public:
+    enum class Access {
+        Normal,       // default readahead
+        Sequential,   // read front to back: aggressive readahead, drop behind
+        Random,       // scattered reads: no readahead
+        WillNeed,     // start paging the range in now
+        DontNeed,     // range won't be read again soon
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const fs::path& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    // Map `path` (closing any previous mapping). Returns false if the file
+    // can't be opened or mapped.
+    bool open(const fs::path& path);
+    void close();
+
+    bool isOpen() const { return open_; }
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // Access pattern hint for [offset, offset + length); length 0 = to the
+    // end of the file.
+    void advise(Access access, std::size_t offset = 0, std::size_t length = 0) const;
+
+private:
+    void swap(MappedFile& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(open_, other.open_);
+    }
+
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool open_ = false;
+};
+
+} // namespace trussc
@@ -0,0 +1,209 @@
+#pragma once
+
+// =============================================================================
+// tcParallel.h - persistent worker pool + parallelFor
+// =============================================================================
+// A fixed set of long-lived worker threads that split an index range with the
+// calling thread. Work items are claimed one at a time from an atomic counter,
+// so the caller always participates and uneven items (a slow image band, a
+// large HAP chunk) balance themselves out.
+//
+//   tc::parallelFor(0, rows, [&](int y) { processRow(y); });
+//
+// The shared pool (WorkerPool::shared()) backs the CPU image kernels
+// (Pixels::resize, mipmap generation, pixel conversion). Subsystems that must
+// not queue behind those (e.g. a video decoder) can own a separate WorkerPool.
+//
+// Rules:
+//   - The body runs on worker threads. It must not touch GPU resources and
+//     must not call runOnMainThread-and-wait.
+//   - Several callers can use one pool at once. Each call queues its range as
+//     a job; idle workers join the oldest job that still wants help, and
+//     every caller works through its own range, so concurrent callers (two
+//     videos decoding) run side by side and a nested call from inside a body
+//     can't deadlock.
+//   - setThreadCount() waits for running jobs; calls that start meanwhile run
+//     their range inline rather than wait for it.
+//   - On the web there are no threads: everything runs inline.
+// =============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trussc {
+
+class WorkerPool {
+public:
+    // threadCount = number of extra worker threads (the caller is one more).
+    // -1 = hardware_concurrency() - 1.
+    explicit WorkerPool(int threadCount = -1) {
+        setThreadCount(threadCount);
+    }
+
+    ~WorkerPool() {
+        stopWorkers();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Process-wide pool used by the built-in CPU kernels.
+    static WorkerPool& shared() {
+        static WorkerPool instance;
+        return instance;
+    }
+
+    // Resize the pool. Blocks until in-flight jobs finish. Not from inside
+    // a body.
+    void setThreadCount(int threadCount) {
+        std::lock_guard<std::mutex> resizeLock(resizeMutex_);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            resizing_ = true;
+            doneCv_.wait(lock, [this] { return callers_ == 0; });
+        }
+        stopWorkers();
+        if (threadCount < 0) {
+            unsigned hc = std::thread::hardware_concurrency();
+            threadCount = hc > 1 ? (int)hc - 1 : 0;
+        }
+#ifdef __EMSCRIPTEN__
+        threadCount = 0;
+#endif
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        workers_.reserve(threadCount);
+        for (int i = 0; i < threadCount; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+        threadCount_.store(threadCount, std::memory_order_relaxed);
+        resizing_ = false;
+    }
+
+    // Worker threads, not counting the caller.
+    int getThreadCount() const { return threadCount_.load(std::memory_order_relaxed); }
+
+    // Run fn(i) for every i in [begin, end). Returns when all items are done.
+    // `maxThreads` caps how many threads (including the caller) take part;
+    // 0 = no cap.
+    void parallelFor(int begin, int end, const std::function<void(int)>& fn, int maxThreads = 0) {
+        if (end <= begin) return;
+        const int count = end - begin;
+
+        Job job;
+        job.fn = &fn;
+        job.end = end;
+        job.next.store(begin, std::memory_order_relaxed);
+        int helpers = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            helpers = resizing_ ? 0 : threadCount_.load(std::memory_order_relaxed);
+            if (maxThreads > 0) helpers = std::min(helpers, maxThreads - 1);
+            helpers = std::min(helpers, count - 1);
+            if (helpers > 0) {
+                job.helpersWanted = helpers;
+                jobs_.push_back(&job);
+                ++callers_;
+            }
+        }
+        if (helpers <= 0) {
+            for (int i = begin; i < end; ++i) fn(i);
+            return;
+        }
+        cv_.notify_all();
+
+        runItems(job);
+
+        // Unlist the job and wait for the helpers that joined it to leave.
+        // Workers that wake late no longer find it.
+        std::unique_lock<std::mutex> lock(mutex_);
+        job.helpersWanted = 0;
+        jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+        doneCv_.wait(lock, [&job] { return job.helpersActive == 0; });
+        if (--callers_ == 0) doneCv_.notify_all();
+    }
+
+private:
+    // One parallelFor() call, on its caller's stack; listed in jobs_ while
+    // it still accepts helpers.
+    struct Job {
+        const std::function<void(int)>* fn = nullptr;
+        int end = 0;
+        std::atomic<int> next{0};
+        int helpersWanted = 0;          // under mutex_
+        int helpersActive = 0;          // under mutex_
+    };
+
+    std::vector<std::thread> workers_;
+    std::atomic<int> threadCount_{0};   // workers_.size(), readable unlocked
+    std::mutex resizeMutex_;            // one setThreadCount() at a time
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable doneCv_;
+    std::vector<Job*> jobs_;            // oldest first
+    int callers_ = 0;                   // parallelFor() calls with jobs listed
+    bool resizing_ = false;
+    bool stop_ = false;
+
+    static void runItems(Job& job) {
+        for (;;) {
+            int i = job.next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= job.end) break;
+            (*job.fn)(i);
+        }
+    }
+
+    // The oldest listed job that still wants a helper, or nullptr.
+    // Caller holds mutex_.
+    Job* claimJob() {
+        for (Job* job : jobs_) {
+            if (job->helpersWanted > 0
+                && job->next.load(std::memory_order_relaxed) < job->end) {
+                --job->helpersWanted;
+                ++job->helpersActive;
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            Job* job = nullptr;
+            cv_.wait(lock, [&] { return stop_ || (job = claimJob()) != nullptr; });
+            if (stop_) return;
+            lock.unlock();
+            runItems(*job);
+            lock.lock();
+            if (--job->helpersActive == 0) doneCv_.notify_all();
+        }
+    }
+
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+        workers_.clear();
+        threadCount_.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Split [begin, end) across the shared worker pool and the calling thread.
+inline void parallelFor(int begin, int end, const std::function<void(int)>& fn) {
+    WorkerPool::shared().parallelFor(begin, end, fn);
+}
+
+} // namespace trussc
@@ -0,0 +1,96 @@
+#pragma once
+
+// =============================================================================
+// tcSimd.h - minimal 4-wide float SIMD wrapper for internal kernels
+// =============================================================================
+// A thin layer over SSE2 (every x86-64 target) and NEON (every arm64 target,
+// Raspberry Pi 4/5, Android arm64-v8a, Apple Silicon) with a scalar fallback
+// for everything else (wasm without simd128, 32-bit ARM without NEON).
+//
+// Only the baseline instruction set of each architecture is used, so no extra
+// compiler flags are needed and one binary runs everywhere. Kernels are
+// written once against `f32x4` and compile to the native vector ops.
+//
+// Internal: this is not a general-purpose SIMD library. Add ops here only when
+// a kernel actually needs them.
+// =============================================================================
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TC_SIMD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #define TC_SIMD_NEON 1
+    #include <arm_neon.h>
+#else
+    #define TC_SIMD_SCALAR 1
+#endif
+
+namespace trussc {
+namespace internal {
+namespace simd {
+
+#if defined(TC_SIMD_SSE2)
+
+using f32x4 = __m128;
+
+inline f32x4 load(const float* p)             { return _mm_loadu_ps(p); }
+inline void  store(float* p, f32x4 v)         { _mm_storeu_ps(p, v); }
+inline f32x4 set1(float v)                    { return _mm_set1_ps(v); }
+inline f32x4 zero()                           { return _mm_setzero_ps(); }
+inline f32x4 add(f32x4 a, f32x4 b)            { return _mm_add_ps(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b)            { return _mm_sub_ps(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b)            { return _mm_mul_ps(a, b); }
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+inline f32x4 min(f32x4 a, f32x4 b)            { return _mm_min_ps(a, b); }
+inline f32x4 max(f32x4 a, f32x4 b)            { return _mm_max_ps(a, b); }
+inline f32x4 zipLo(f32x4 a, f32x4 b)          { return _mm_unpacklo_ps(a, b); }   // a0 b0 a1 b1
+inline f32x4 zipHi(f32x4 a, f32x4 b)          { return _mm_unpackhi_ps(a, b); }   // a2 b2 a3 b3
+
+#elif defined(TC_SIMD_NEON)
+
+using f32x4 = float32x4_t;
+
+inline f32x4 load(const float* p)             { return vld1q_f32(p); }
+inline void  store(float* p, f32x4 v)         { vst1q_f32(p, v); }
+inline f32x4 set1(float v)                    { return vdupq_n_f32(v); }
+inline f32x4 zero()                           { return vdupq_n_f32(0.0f); }
+inline f32x4 add(f32x4 a, f32x4 b)            { return vaddq_f32(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b)            { return vsubq_f32(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b)            { return vmulq_f32(a, b); }
+// Separate mul + add (not vfmaq) so results match the SSE2 and scalar paths
+// bit for bit — kernels that promise bit-identical output rely on this.
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return vaddq_f32(acc, vmulq_f32(a, b)); }
+inline f32x4 min(f32x4 a, f32x4 b)            { return vminq_f32(a, b); }
+inline f32x4 max(f32x4 a, f32x4 b)            { return vmaxq_f32(a, b); }
+inline f32x4 zipLo(f32x4 a, f32x4 b)          { return vzipq_f32(a, b).val[0]; }
+inline f32x4 zipHi(f32x4 a, f32x4 b)          { return vzipq_f32(a, b).val[1]; }
+
+#else
+
+struct f32x4 { float v[4]; };
+
+inline f32x4 load(const float* p)             { f32x4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void  store(float* p, f32x4 a)         { std::memcpy(p, a.v, sizeof(a.v)); }
+inline f32x4 set1(float s)                    { return {{s, s, s, s}}; }
+inline f32x4 zero()                           { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+inline f32x4 add(f32x4 a, f32x4 b)            { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline f32x4 sub(f32x4 a, f32x4 b)            { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline f32x4 mul(f32x4 a, f32x4 b)            { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return add(acc, mul(a, b)); }
+inline f32x4 min(f32x4 a, f32x4 b)            { return {{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                                                         a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]}}; }
+inline f32x4 max(f32x4 a, f32x4 b)            { return {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+                                                         a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]}}; }
+inline f32x4 zipLo(f32x4 a, f32x4 b)          { return {{a.v[0], b.v[0], a.v[1], b.v[1]}}; }
+inline f32x4 zipHi(f32x4 a, f32x4 b)          { return {{a.v[2], b.v[2], a.v[3], b.v[3]}}; }
+
+#endif
+
+inline f32x4 clamp01(f32x4 v) { return min(max(v, zero()), set1(1.0f)); }
+
+} // namespace simd
+} // namespace internal
+} // namespace trussc
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace trussc {
+
+// ---------------------------------------------------------------------------
+// TripleBuffer - latest-value handoff between one writer and one reader
+// ---------------------------------------------------------------------------
+//
+// Three slots: the writer fills its back slot and publishes it; the reader
+// picks up the most recently published slot. Neither side ever blocks or
+// waits for the other, and the reader always sees a complete value. Values
+// published faster than the reader looks are simply superseded (use
+// ThreadChannel when every value must be delivered).
+//
+// Usage:
+//   // Writer thread
+//   Result& r = buffer.back();
+//   fill(r);                      // reuse r's storage; no allocation needed
+//   buffer.publish();
+//
+//   // Reader thread
+//   buffer.update();              // true if something new arrived
+//   const Result& latest = buffer.front();
+//
+// Slots are reused in rotation, so a writer that resizes vectors in place
+// stops allocating once all three have grown.
+//
+// ---------------------------------------------------------------------------
+
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // ---- writer ----------------------------------------------------------
+
+    // Slot to fill. Contents are whatever was published three rounds ago.
+    T& back() { return slots_[back_]; }
+
+    // Make back() the latest value and hand the writer a free slot.
+    void publish() {
+        back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // ---- reader ----------------------------------------------------------
+
+    // Swap in the latest published value, if any. Returns true when
+    // front() changed.
+    bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // True if a value was published since the last update().
+    bool hasUpdate() const {
+        return (middle_.load(std::memory_order_relaxed) & FRESH) != 0;
+    }
+
+    // Value as of the last update(). Stays valid until the next update().
+    const T& front() const { return slots_[front_]; }
+
+    // ---- setup -----------------------------------------------------------
+
+    // Set all three slots to `value` and drop any unread publish. Only while
+    // neither side is using the buffer (e.g. to pre-size slot storage).
+    void reset(const T& value) {
+        for (T& slot : slots_) slot = value;
+        back_ = 0;
+        middle_.store(1, std::memory_order_relaxed);
+        front_ = 2;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T slots_[3];
+    uint8_t back_ = 0;                     // writer only
+    std::atomic<uint8_t> middle_{1};       // shared: index | FRESH
+    uint8_t front_ = 2;                    // reader only
+};
+
+} // namespace trussc
@@ -0,0 +1,237 @@
+#pragma once
+
+// =============================================================================
+// tcVideoFrameQueue.h - decoded frames between a decode thread and update()
+// =============================================================================
+//
+// The Linux VideoPlayer decodes on a thread of its own (or a VideoDecodePool
+// worker) and shows frames from update(). VideoFrameQueue is that hand-off:
+//
+//   decode side   allocate() / copyPlanes() fill a Frame from pooled storage
+//                 (RGBA, or the Y / UV / V planes the YUV shaders convert),
+//                 push() queues it
+//   update side   takeFront() moves the front frame into shown(); the frame
+//                 it replaces goes back to the pool
+//
+// Nothing is copied after the decode: the player's pixel pointers alias
+// shown() until the next takeFront(). Storage comes from one PixelsPool and
+// at most MAX_QUEUE_SIZE queued + one being decoded + shown() are out at
+// once, so after prime() has warmed POOL_FRAMES frames playback stops
+// allocating.
+//
+// Not thread-safe: the player holds its own mutex around the queue side.
+// The decode-side calls only touch the Frame they are given. Independent of
+// FFmpeg (planes come in as data / linesize arrays, AVFrame-style), so
+// core/tests/videoPlanes runs this same code.
+// =============================================================================
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "tc/graphics/tcPixels.h"   // expects Color (TrussC.h includes it first)
+
+namespace trussc {
+
+class VideoFrameQueue {
+public:
+    // How frames travel from the decode thread to the player
+    enum class Planes {
+        RGBA,  // sws_scale to RGBA8 (fallback)
+        NV12,  // Y + interleaved UV, 8-bit (NV12; P010 narrowed)
+        I420,  // Y + U + V, 8-bit (YUV420P)
+    };
+
+    // Decoder output formats copyPlanes() takes without a conversion.
+    enum class Source {
+        NV12,     // Y + interleaved UV, 8-bit
+        P010,     // Y + interleaved UV, 10 bits in the top of 16
+        YUV420P,  // Y + U + V, 8-bit
+    };
+
+    struct Frame {
+        Pixels pixels;    // RGBA, or the Y plane (1 channel) when planar
+        Pixels pixelsUV;  // NV12: UV plane (width x height/2 bytes), I420: U plane
+        Pixels pixelsV;   // I420: V plane (U and V are width/2 x height/2)
+        Planes planes = Planes::RGBA;
+        double pts = 0.0;
+        bool scrub = false;    // decoded for a seek: shown even while paused
+        bool preview = false;  // scrub mode: the keyframe shown until the exact frame
+    };
+
+    static constexpr size_t MAX_QUEUE_SIZE = 4;
+    static constexpr size_t POOL_FRAMES = MAX_QUEUE_SIZE + 2;
+
+    void setPool(std::shared_ptr<PixelsPool> pool) { pool_ = std::move(pool); }
+
+    // Frame size and the layout shown() is kept in. Planar layouts need even
+    // sizes.
+    void setLayout(int width, int height, Planes planes) {
+        width_ = width;
+        height_ = height;
+        planes_ = planes;
+    }
+    Planes getLayout() const { return planes_; }
+
+    // --- decode side ----------------------------------------------------------
+
+    // Pooled storage for one frame in `planes` layout (contents undefined).
+    void allocate(Frame& data, Planes planes) const {
+        data.planes = planes;
+        switch (planes) {
+            case Planes::RGBA:
+                data.pixels.allocate(width_, height_, 4, PixelFormat::U8, pool_);
+                break;
+            case Planes::NV12:
+                data.pixels.allocate(width_, height_, 1, PixelFormat::U8, pool_);
+                data.pixelsUV.allocate(width_, height_ / 2, 1, PixelFormat::U8, pool_);
+                break;
+            case Planes::I420:
+                data.pixels.allocate(width_, height_, 1, PixelFormat::U8, pool_);
+                data.pixelsUV.allocate(width_ / 2, height_ / 2, 1, PixelFormat::U8, pool_);
+                data.pixelsV.allocate(width_ / 2, height_ / 2, 1, PixelFormat::U8, pool_);
+                break;
+        }
+    }
+
+    // Copy the planes of a decoded frame (data / linesize as in AVFrame) into
+    // pooled storage in the planar layout. Returns false (caller falls back
+    // to RGBA) when `source` has no path to it, e.g. after a mid-stream
+    // format change.
+    bool copyPlanes(Source source, const uint8_t* const* data, const int* linesize,
+                    Frame& out) const {
+        if (planes_ == Planes::NV12 && source == Source::NV12) {
+            allocate(out, Planes::NV12);
+            copyPlane(out.pixels, data[0], linesize[0], width_, height_);
+            // (width/2 pairs) * 2 bytes = width
+            copyPlane(out.pixelsUV, data[1], linesize[1], width_, height_ / 2);
+        } else if (planes_ == Planes::NV12 && source == Source::P010) {
+            // 10 bits in the top of each 16-bit sample: keep the high byte and
+            // reuse the NV12 textures and shader (there is no 16-bit unorm
+            // texture format to upload P010 as is).
+            allocate(out, Planes::NV12);
+            narrowPlane(out.pixels, data[0], linesize[0], width_, height_);
+            narrowPlane(out.pixelsUV, data[1], linesize[1], width_, height_ / 2);
+        } else if (planes_ == Planes::I420 && source == Source::YUV420P) {
+            allocate(out, Planes::I420);
+            const int cw = width_ / 2, ch = height_ / 2;
+            copyPlane(out.pixels,   data[0], linesize[0], width_, height_);
+            copyPlane(out.pixelsUV, data[1], linesize[1], cw, ch);
+            copyPlane(out.pixelsV,  data[2], linesize[2], cw, ch);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Deep copy of a frame's planes into pooled storage (for a scrub cache).
+    void copyFrame(const Frame& src, Frame& dst) const {
+        allocate(dst, src.planes);
+        std::memcpy(dst.pixels.getData(), src.pixels.getData(), src.pixels.getTotalBytes());
+        if (src.planes != Planes::RGBA)
+            std::memcpy(dst.pixelsUV.getData(), src.pixelsUV.getData(), src.pixelsUV.getTotalBytes());
+        if (src.planes == Planes::I420)
+            std::memcpy(dst.pixelsV.getData(), src.pixelsV.getData(), src.pixelsV.getTotalBytes());
+        dst.pts     = src.pts;
+        dst.scrub   = src.scrub;
+        dst.preview = src.preview;
+    }
+
+    // True if a frame can be shown in the current layout (a mid-stream format
+    // change can queue RGBA frames in a planar mode).
+    bool fits(const Frame& data) const {
+        if (data.planes != planes_) return false;
+        const size_t lumaBytes = (size_t)width_ * height_;
+        switch (planes_) {
+            case Planes::RGBA:
+                return data.pixels.getTotalBytes() == lumaBytes * 4;
+            case Planes::NV12:
+                return data.pixels.getTotalBytes() == lumaBytes
+                    && data.pixelsUV.getTotalBytes() == lumaBytes / 2;
+            case Planes::I420:
+                return data.pixels.getTotalBytes() == lumaBytes
+                    && data.pixelsUV.getTotalBytes() == lumaBytes / 4
+                    && data.pixelsV.getTotalBytes() == lumaBytes / 4;
+        }
+        return false;
+    }
+
+    // --- queue side (under the player's mutex) --------------------------------
+
+    void push(Frame&& data) { frames_.push_back(std::move(data)); }
+    void pop() { frames_.pop_front(); }
+    void clear() { frames_.clear(); }
+    bool empty() const { return frames_.empty(); }
+    size_t size() const { return frames_.size(); }
+    const Frame& front() const { return frames_.front(); }
+    const std::deque<Frame>& queued() const { return frames_; }
+
+    // Move the front frame into shown() and drop it from the queue. Returns
+    // false, leaving shown() as it was, if the frame doesn't fit the layout.
+    bool takeFront() {
+        const bool ok = fits(frames_.front());
+        if (ok) {
+            shown_ = std::move(frames_.front());
+            shownReal_ = true;
+        }
+        frames_.pop_front();
+        return ok;
+    }
+
+    // The frame on screen. Its pixels stay where they are until the next
+    // takeFront() / prime() / reset().
+    Frame& shown() { return shown_; }
+    const Frame& shown() const { return shown_; }
+    bool hasShownFrame() const { return shownReal_; }   // false while primed only
+
+    // Allocate shown() in the current layout with neutral content (black,
+    // chroma 128) and warm the pool with POOL_FRAMES frames, so playback
+    // doesn't allocate from the first frame on.
+    void prime() {
+        if (width_ <= 0 || height_ <= 0) return;
+        allocate(shown_, planes_);
+        shownReal_ = false;  // black until the first decoded frame
+        {
+            std::vector<Frame> warm(POOL_FRAMES - 1);
+            for (auto& f : warm) allocate(f, planes_);
+        }   // back on the pool's free lists
+        std::memset(shown_.pixels.getData(), 0, shown_.pixels.getTotalBytes());
+        if (planes_ != Planes::RGBA) {
+            std::memset(shown_.pixelsUV.getData(), 128, shown_.pixelsUV.getTotalBytes());  // 128 = neutral chroma
+        }
+        if (planes_ == Planes::I420) {
+            std::memset(shown_.pixelsV.getData(), 128, shown_.pixelsV.getTotalBytes());
+        }
+    }
+
+    // Drop the queue and the shown frame.
+    void reset() {
+        frames_.clear();
+        shown_ = Frame{};
+        shownReal_ = false;
+    }
+
+private:
+    std::shared_ptr<PixelsPool> pool_;
+    int width_ = 0;
+    int height_ = 0;
+    Planes planes_ = Planes::RGBA;
+
+    std::deque<Frame> frames_;
+    Frame shown_;
+    bool shownReal_ = false;
+
+    static void copyPlane(Pixels& dst, const uint8_t* plane, int stride, int rowBytes, int rows) {
+        for (int row = 0; row < rows; ++row)
+            std::memcpy(dst.getData() + (size_t)row * rowBytes, plane + (size_t)row * stride, rowBytes);
+    }
+
+    static void narrowPlane(Pixels& dst, const uint8_t* plane, int stride, int samples, int rows) {
+        for (int row = 0; row < rows; ++row)
+            pixelconv::u16ToU8(reinterpret_cast<const uint16_t*>(plane + (size_t)row * stride),
+                               dst.getData() + (size_t)row * samples, samples);
+    }
+};
+
+} // namespace trussc
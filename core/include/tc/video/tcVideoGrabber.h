@@ -56,6 +56,10 @@ struct GrabberFrameQueue {
     std::deque<GrabberFrame> frames;
     std::atomic<size_t> maxFrames{0};  // 0 = queueing disabled
 
+    // Frame storage. Dropped and consumed frames hand their block back, so a
+    // steady capture rate stops allocating after the first few frames.
+    std::shared_ptr<PixelsPool> pool = std::make_shared<PixelsPool>();
+
     // Called from the capture thread. Drops the oldest frame when full so a
     // stalled consumer never blocks capture (timestamps stay truthful).
     void push(const unsigned char* rgba, int w, int h, uint64_t tUs) {
@@ -63,7 +67,7 @@ struct GrabberFrameQueue {
         if (cap == 0 || !rgba || w <= 0 || h <= 0) return;
         GrabberFrame f;
         f.timestampUs = tUs;
-        f.pixels.allocate(w, h, 4);
+        f.pixels.allocate(w, h, 4, PixelFormat::U8, pool);
         std::memcpy(f.pixels.getData(), rgba, (size_t)w * h * 4);
         std::lock_guard<std::mutex> lock(mtx);
         while (frames.size() >= cap) frames.pop_front();
@@ -134,6 +138,20 @@ public:
         return verbose_;
     }
 
+    // Deliver frames as YUV planes instead of RGBA (call before setup()).
+    // The CPU only splits (YUYV cameras) or decodes (MJPEG cameras) the
+    // frame; the colour conversion happens in the draw shader. In YUV mode
+    // getPixels() is null - read getPixelsY() / getPixelsUV() instead. Queued
+    // frames (setFrameQueueSize) are still RGBA, converted only while the
+    // queue is enabled. Ignored where unsupported: check isYuvMode().
+    TC_PLATFORMS("linux") void setYuvOutput(bool enabled) {
+        yuvOutput_ = enabled;
+    }
+
+    TC_PLATFORMS("linux") bool getYuvOutput() const {
+        return yuvOutput_;
+    }
+
     // =========================================================================
     // Setup / Close
     // =========================================================================
@@ -167,11 +185,20 @@ public:
         closePlatform();
 
         texture_.clear();
+        textureY_.clear();
+        textureUV_.clear();
 
         if (pixels_) {
             delete[] pixels_;
             pixels_ = nullptr;
         }
+        delete[] pixelsY_;
+        delete[] pixelsUV_;
+        pixelsY_ = nullptr;
+        pixelsUV_ = nullptr;
+        yuvMode_ = false;
+        uvWidth_ = 0;
+        uvHeight_ = 0;
 
         initialized_ = false;
         frameNew_ = false;
@@ -216,7 +243,12 @@ public:
         // Update texture if buffer was updated
         if (pixelsDirty_.exchange(false)) {
             std::lock_guard<std::mutex> lock(mutex_);
-            texture_.loadData(pixels_, width_, height_, 4);
+            if (yuvMode_) {
+                textureY_.loadData(pixelsY_, width_, height_, 1);
+                textureUV_.loadData(pixelsUV_, uvWidth_, uvHeight_, 2);
+            } else {
+                texture_.loadData(pixels_, width_, height_, 4);
+            }
             frameNew_ = true;
         }
     }
@@ -245,6 +277,26 @@ public:
     unsigned char* getPixels() { return pixels_; }
     const unsigned char* getPixels() const { return pixels_; }
 
+    // YUV mode (setYuvOutput): Y plane (width x height) and interleaved UV
+    // plane (getUVWidth() x getUVHeight() U,V pairs; BT.601 limited range).
+    // YUYV cameras keep their 4:2:2 chroma (full height), MJPEG is 4:2:0.
+    TC_PLATFORMS("linux") bool isYuvMode() const { return yuvMode_; }
+    TC_PLATFORMS("linux") const unsigned char* getPixelsY() const { return pixelsY_; }
+    TC_PLATFORMS("linux") const unsigned char* getPixelsUV() const { return pixelsUV_; }
+    TC_PLATFORMS("linux") int getUVWidth() const { return uvWidth_; }
+    TC_PLATFORMS("linux") int getUVHeight() const { return uvHeight_; }
+
+    // Camera frames never decoded because every MJPEG decode thread was busy
+    // (the camera keeps running; the frame queue doesn't see them either).
+    // Linux MJPEG cameras only; 0 otherwise.
+    TC_PLATFORMS("linux") uint64_t getDroppedFrames() const {
+#if defined(__linux__) && !defined(__ANDROID__)
+        return getDroppedFramesPlatform();
+#else
+        return 0;
+#endif
+    }
+
     // =========================================================================
     // Buffered frames (opt-in, timestamped)
     // =========================================================================
@@ -281,6 +333,13 @@ public:
         return n;
     }
 
+    // Storage behind the queued frames. peakBytesInUse / peakBlocksInUse are
+    // the high-water marks: how much frame memory the queue (plus frames
+    // the app still holds) has needed at most.
+    TC_PLATFORMS("macos,windows,linux") PixelsPool::Stats getFramePoolStats() const {
+        return frameQueue_->pool->getStats();
+    }
+
     // Copy to Image
     void copyToImage(Image& image) const {
         if (!initialized_ || !pixels_) return;
@@ -299,7 +358,21 @@ public:
     Texture& getTexture() override { return texture_; }
     const Texture& getTexture() const override { return texture_; }
 
-    // draw() uses HasTexture's default implementation
+    // YUV mode draws the planes through the conversion shader; otherwise
+    // the RGBA texture (HasTexture's default)
+    void draw(float x, float y) const override {
+        draw(x, y, (float)width_, (float)height_);
+    }
+
+    void draw(float x, float y, float w, float h) const override {
+#if defined(__linux__) && !defined(__ANDROID__)
+        if (yuvMode_ && yuvShaderHandle_) {
+            drawYuvPlatform(x, y, w, h);
+            return;
+        }
+#endif
+        if (texture_.isAllocated()) texture_.draw(x, y, w, h);
+    }
 
     // =========================================================================
     // Permissions (macOS)
@@ -342,6 +415,17 @@ private:
     // Texture (Stream mode)
     Texture texture_;
 
+    // YUV output (Linux): Y + interleaved UV planes, set up by setupPlatform()
+    bool yuvOutput_ = false;           // requested via setYuvOutput()
+    bool yuvMode_ = false;             // active
+    unsigned char* pixelsY_ = nullptr;
+    unsigned char* pixelsUV_ = nullptr;
+    int uvWidth_ = 0;
+    int uvHeight_ = 0;
+    Texture textureY_;
+    Texture textureUV_;
+    void* yuvShaderHandle_ = nullptr;  // internal::YuvVideoShader* on Linux
+
     // Platform-specific handle
     void* platformHandle_ = nullptr;
 
@@ -364,12 +448,25 @@ private:
         pixels_ = other.pixels_;
         pixelsDirty_.store(other.pixelsDirty_.load());
         texture_ = std::move(other.texture_);
+        yuvOutput_ = other.yuvOutput_;
+        yuvMode_ = other.yuvMode_;
+        pixelsY_ = other.pixelsY_;
+        pixelsUV_ = other.pixelsUV_;
+        uvWidth_ = other.uvWidth_;
+        uvHeight_ = other.uvHeight_;
+        textureY_ = std::move(other.textureY_);
+        textureUV_ = std::move(other.textureUV_);
+        yuvShaderHandle_ = other.yuvShaderHandle_;
         platformHandle_ = other.platformHandle_;
         frameQueue_ = std::move(other.frameQueue_);
         other.frameQueue_ = std::make_unique<internal::GrabberFrameQueue>();
 
         // Invalidate source object
         other.pixels_ = nullptr;
+        other.pixelsY_ = nullptr;
+        other.pixelsUV_ = nullptr;
+        other.yuvMode_ = false;
+        other.yuvShaderHandle_ = nullptr;
         other.initialized_ = false;
         other.pendingSetup_ = false;
         other.platformHandle_ = nullptr;
@@ -384,6 +481,19 @@ private:
             return false;
         }
 
+        if (yuvMode_) {
+            // Planes start out black (Y 16, UV 128)
+            pixelsY_ = new unsigned char[(size_t)width_ * height_];
+            pixelsUV_ = new unsigned char[(size_t)uvWidth_ * uvHeight_ * 2];
+            std::memset(pixelsY_, 16, (size_t)width_ * height_);
+            std::memset(pixelsUV_, 128, (size_t)uvWidth_ * uvHeight_ * 2);
+            updateDelegatePixels();
+            textureY_.allocate(width_, height_, 1, TextureUsage::Stream);
+            textureUV_.allocate(uvWidth_, uvHeight_, TextureFormat::RG8, TextureUsage::Stream);
+            initialized_ = true;
+            return true;
+        }
+
         // Allocate pixel buffer
         size_t bufferSize = width_ * height_ * 4;
         pixels_ = new unsigned char[bufferSize];
@@ -437,6 +547,11 @@ private:
     bool checkResizeNeeded();
     void getNewSize(int& width, int& height);
     void clearResizeFlag();
+
+#if defined(__linux__) && !defined(__ANDROID__)
+    void drawYuvPlatform(float x, float y, float w, float h) const;
+    uint64_t getDroppedFramesPlatform() const;
+#endif
 };
 
 } // namespace trussc
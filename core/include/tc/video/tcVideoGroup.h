@@ -0,0 +1,401 @@
+#pragma once
+
+// =============================================================================
+// tcVideoGroup.h - synchronised playback of several VideoPlayers
+// =============================================================================
+//
+// For video walls and multi-screen installations: the members of a group run
+// on one master clock and show the same moment on every display frame.
+//
+//   tc::VideoPlayer screens[9];
+//   tc::VideoGroup wall;
+//   for (auto& s : screens) { s.load(...); wall.add(s); }
+//   wall.setLoop(true);
+//   wall.play();
+//
+//   void update() {
+//       wall.update();          // instead of screens[i].update()
+//   }
+//
+// - play() and seeks preroll: the clock waits until every member has a frame
+//   at the start position (at most one second), then all start together.
+// - Frame lock (VideoFrameLock, tcVideoSync.h): a member that is a frame or
+//   two late holds the whole wall on its frame instead of tearing.
+// - Linux: members decode on a shared pool of threads (setDecodeThreads()),
+//   always working on the stream closest to running out of frames, and
+//   present on the group clock; soundtracks follow it. Other backends keep
+//   their native clocks and are pulled back by a seek when one drifts more
+//   than a few frames.
+// - getStats() reports per member drift, late and skipped frames.
+//
+// The group doesn't own its players: they must stay at the same address
+// (not moved) and outlive the group, or be removed from it first.
+//
+// =============================================================================
+
+#include "tcVideoPlayer.h"
+#include "tcVideoSync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace trussc {
+
+class TC_PLATFORMS("macos,windows,linux,ios,web") VideoGroup {
+public:
+    struct MemberStats {
+        double drift = 0.0;         // shown frame time - group clock (s)
+        double maxDrift = 0.0;      // largest |drift| seen
+        uint64_t frames = 0;        // new frames shown
+        uint64_t late = 0;          // display frames without a frame on time
+        uint64_t skipped = 0;       // frames never shown (passed over)
+    };
+
+    VideoGroup() = default;
+    ~VideoGroup() { clear(); }
+
+    VideoGroup(const VideoGroup&) = delete;
+    VideoGroup& operator=(const VideoGroup&) = delete;
+
+    // =========================================================================
+    // Members
+    // =========================================================================
+
+    void add(VideoPlayer& player) {
+        for (auto& m : members_) {
+            if (m.player == &player) return;
+        }
+        Member m;
+        m.player = &player;
+        members_.push_back(m);
+        player.setLoop(loop_);
+        rebuildPool();
+        // Joining a running group: start at the clock. During a preroll or
+        // a pause the newcomer is seeked only and starts with the others.
+        // (play() first: it may rewind a player that ended.)
+        if (playing_) {
+            if (!paused_ && !prerolling_) player.play();
+            player.setCurrentTime((float)clock_);
+        }
+    }
+
+    void remove(VideoPlayer& player) {
+        for (auto it = members_.begin(); it != members_.end(); ++it) {
+            if (it->player == &player) {
+                release(*it);
+                members_.erase(it);
+                break;
+            }
+        }
+        rebuildPool();
+    }
+
+    void clear() {
+        for (auto& m : members_) release(m);
+        members_.clear();
+        rebuildPool();
+    }
+
+    size_t size() const { return members_.size(); }
+    VideoPlayer& get(size_t i) { return *members_[i].player; }
+
+    /// Decode threads shared by the members (Linux). 0 = automatic: one per
+    /// core minus one for the app, at most one per member.
+    void setDecodeThreads(int threads) {
+        decodeThreads_ = std::max(threads, 0);
+        rebuildPool();
+    }
+    int getDecodeThreads() const { return poolThreads_; }
+
+    /// How many frames a late member may hold the wall back before the clock
+    /// moves on without it (0 = never hold). Default 2.
+    void setMaxLagFrames(int frames) { lock_.setMaxLagFrames(frames); }
+    int getMaxLagFrames() const { return lock_.getMaxLagFrames(); }
+
+    // =========================================================================
+    // Playback
+    // =========================================================================
+
+    void play() {
+        if (playing_ && !paused_) return;
+        if (!playing_ && clock_ >= getDuration()) clock_ = 0.0;
+        playing_ = true;
+        paused_ = false;
+        seekMembers(clock_);
+    }
+
+    void stop() {
+        playing_ = false;
+        paused_ = false;
+        prerolling_ = false;
+        clock_ = 0.0;
+        lock_.reset();
+        for (auto& m : members_) {
+            m.player->stop();
+            m.lastFrame = -1;
+        }
+    }
+
+    void setPaused(bool paused) {
+        if (!playing_ || paused == paused_) return;
+        paused_ = paused;
+        if (paused) {
+            for (auto& m : members_) m.player->setPaused(true);
+        } else {
+            startPreroll();  // members resume together once all have a frame
+        }
+    }
+
+    bool isPlaying() const { return playing_ && !paused_; }
+    bool isPaused() const { return paused_; }
+
+    /// Seek every member; playback goes on (after a preroll) from there.
+    void setCurrentTime(double seconds) {
+        clock_ = std::clamp(seconds, 0.0, (double)getDuration());
+        if (playing_ && !paused_) {
+            seekMembers(clock_);
+        } else {
+            lock_.reset();
+            for (auto& m : members_) m.player->setCurrentTime((float)clock_);
+        }
+    }
+    void setPosition(float pct) { setCurrentTime(pct * getDuration()); }
+
+    /// The group clock (seconds).
+    double getCurrentTime() const { return clock_; }
+
+    /// The longest member.
+    float getDuration() const {
+        float d = 0.0f;
+        for (auto& m : members_) d = std::max(d, m.player->getDuration());
+        return d;
+    }
+
+    /// Loop the whole group: when the longest member ends, all start over.
+    void setLoop(bool loop) {
+        loop_ = loop;
+        for (auto& m : members_) m.player->setLoop(loop);
+    }
+    bool isLoop() const { return loop_; }
+
+    // =========================================================================
+    // Update
+    // =========================================================================
+
+    /// Advance the clock and update every member. Call once per frame
+    /// instead of the members' own update().
+    void update() {
+        attachMembers();
+
+        const auto now = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double>(now - lastTick_).count();
+        lastTick_ = now;
+
+        if (prerolling_) {
+            if (allReady() || now - prerollStart_ > std::chrono::seconds(1)) {
+                finishPreroll();
+            }
+        } else if (playing_ && !paused_) {
+            clock_ += std::min(dt, 0.25);  // a stalled app doesn't jump ahead
+            const double duration = getDuration();
+            if (clock_ >= duration) {
+                if (loop_) {
+                    clock_ = 0.0;
+                    seekMembers(0.0);
+                } else {
+                    clock_ = duration;
+                    playing_ = false;
+                }
+            }
+        }
+
+        present();
+    }
+
+    // =========================================================================
+    // Telemetry
+    // =========================================================================
+
+    const MemberStats& getStats(size_t i) const { return members_[i].stats; }
+
+    /// Display frames on which the wall was held back for a late member.
+    uint64_t getHeldFrames() const { return heldFrames_; }
+
+    void resetStats() {
+        for (auto& m : members_) m.stats = MemberStats{};
+        heldFrames_ = 0;
+    }
+
+private:
+    struct Member {
+        VideoPlayer* player = nullptr;
+        void* attached = nullptr;   // platform handle the pool knows (Linux)
+        int lastFrame = -1;
+        MemberStats stats;
+    };
+
+    // Linux: put the group clock on every member, frame-locked.
+    // Elsewhere: members run on their own clocks; seek back the ones that
+    // drifted away from the group clock.
+    void present() {
+#if defined(__linux__) && !defined(__ANDROID__)
+        const size_t n = members_.size();
+        newest_.resize(n);
+        durations_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            VideoPlayer* p = members_[i].player;
+            durations_[i] = p->frameDurationPlatform();
+            // A member past its end is never late: its last frame stays up.
+            newest_[i] = clock_ >= p->getDuration() ? clock_ : p->newestFramePlatform(clock_);
+        }
+        const bool running = playing_ && !paused_ && !prerolling_;
+        const auto d = lock_.decide(clock_, newest_, durations_, &late_);
+        if (running && d.held) ++heldFrames_;
+
+        for (size_t i = 0; i < n; ++i) {
+            Member& m = members_[i];
+            m.player->setGroupClockPlatform(clock_, d.present);
+            m.player->update();
+            if (running && late_[i]) ++m.stats.late;
+            record(m);
+        }
+#else
+        const bool running = playing_ && !paused_ && !prerolling_;
+        for (auto& m : members_) {
+            m.player->update();
+            record(m);
+            const float frames = (float)m.player->getTotalFrames();
+            const double frameDur = frames > 0 ? m.player->getDuration() / frames : 1.0 / 30.0;
+            if (running && clock_ < m.player->getDuration() &&
+                std::abs(m.stats.drift) > kDriftCorrectFrames * frameDur) {
+                m.player->setCurrentTime((float)clock_);
+            }
+        }
+#endif
+    }
+
+    void record(Member& m) {
+        if (!m.player->isFrameNew()) return;
+        const int frame = m.player->getCurrentFrame();
+        if (playing_ && !paused_ && !prerolling_) {
+            ++m.stats.frames;
+            if (m.lastFrame >= 0 && frame > m.lastFrame + 1) {
+                m.stats.skipped += frame - m.lastFrame - 1;
+            }
+            m.stats.drift = m.player->getCurrentTime() - clock_;
+            m.stats.maxDrift = std::max(m.stats.maxDrift, std::abs(m.stats.drift));
+        }
+        m.lastFrame = frame;
+    }
+
+    // Seek all members to `seconds` and hold the clock until they have
+    // their frame there.
+    void seekMembers(double seconds) {
+        lock_.reset();
+        for (auto& m : members_) {
+            if (m.player->isPlaying()) m.player->setPaused(true);
+            m.player->setCurrentTime((float)seconds);
+            m.lastFrame = -1;
+        }
+        startPreroll();
+    }
+
+    void startPreroll() {
+        prerolling_ = true;
+        prerollStart_ = std::chrono::steady_clock::now();
+    }
+
+    void finishPreroll() {
+        prerolling_ = false;
+        lastTick_ = std::chrono::steady_clock::now();
+        for (auto& m : members_) {
+            if (m.player->isPaused()) {
+                m.player->setPaused(false);
+            } else if (!m.player->isPlaying()) {
+                m.player->play();
+            }
+        }
+    }
+
+    // Every member has a picture at the clock (within a frame).
+    bool allReady() const {
+        for (auto& m : members_) {
+            if (!m.player->isLoaded()) continue;
+#if defined(__linux__) && !defined(__ANDROID__)
+            const double dur = m.player->frameDurationPlatform();
+            if (m.player->newestFramePlatform(clock_ + dur) <= clock_ - dur) return false;
+#else
+            if (!m.player->isReady()) return false;
+#endif
+        }
+        return true;
+    }
+
+    // (Re)attach members to the pool; a reloaded player has a new handle.
+    void attachMembers() {
+#if defined(__linux__) && !defined(__ANDROID__)
+        for (auto& m : members_) {
+            if (m.attached != m.player->platformHandle_) {
+                m.player->attachDecodePoolPlatform(pool_);
+                m.attached = m.player->platformHandle_;
+            }
+        }
+#endif
+    }
+
+    void release(Member& m) {
+#if defined(__linux__) && !defined(__ANDROID__)
+        m.player->setGroupClockPlatform(std::numeric_limits<double>::quiet_NaN(), 0.0);
+        m.player->attachDecodePoolPlatform(nullptr);
+#endif
+        m.attached = nullptr;
+    }
+
+    // A pool sized for the current members; members move over on the next
+    // update().
+    void rebuildPool() {
+        int threads = decodeThreads_;
+        if (threads == 0) {
+            const int cores = (int)std::thread::hardware_concurrency();
+            threads = std::clamp(cores - 1, 1, std::max((int)members_.size(), 1));
+        }
+        if (members_.empty()) threads = 0;
+        if (threads == poolThreads_) return;
+
+#if defined(__linux__) && !defined(__ANDROID__)
+        for (auto& m : members_) {
+            m.player->attachDecodePoolPlatform(nullptr);
+            m.attached = nullptr;
+        }
+        if (pool_) VideoPlayer::destroyDecodePoolPlatform(pool_);
+        pool_ = threads > 0 ? VideoPlayer::createDecodePoolPlatform(threads) : nullptr;
+#endif
+        poolThreads_ = threads;
+    }
+
+    static constexpr double kDriftCorrectFrames = 3.0;
+
+    std::vector<Member> members_;
+    VideoFrameLock lock_;
+    void* pool_ = nullptr;
+    int decodeThreads_ = 0;
+    int poolThreads_ = 0;
+
+    double clock_ = 0.0;
+    bool playing_ = false;
+    bool paused_ = false;
+    bool loop_ = false;
+    bool prerolling_ = false;
+    std::chrono::steady_clock::time_point lastTick_ = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point prerollStart_;
+    uint64_t heldFrames_ = 0;
+
+    std::vector<double> newest_, durations_;
+    std::vector<char> late_;
+};
+
+} // namespace trussc
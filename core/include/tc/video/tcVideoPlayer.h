@@ -87,18 +87,19 @@ public:
 
         // Create texture(s) for per-frame updates
         if (width_ > 0 && height_ > 0) {
-            if (nv12Mode_) {
-                textureY_.allocate(width_,     height_,     1,                  TextureUsage::Stream);
-                textureUV_.allocate(width_ / 2, height_ / 2, TextureFormat::RG8, TextureUsage::Stream);
+            if (yuvMode_) {
+                const TextureFormat uvFormat = i420Mode_ ? TextureFormat::R8 : TextureFormat::RG8;
+                textureY_.allocate(width_,     height_,     1,        TextureUsage::Stream);
+                textureUV_.allocate(width_ / 2, height_ / 2, uvFormat, TextureUsage::Stream);
+                if (i420Mode_) {
+                    textureV_.allocate(width_ / 2, height_ / 2, TextureFormat::R8, TextureUsage::Stream);
+                }
                 // Prime the textures with the neutral-chroma CPU buffers
                 // (Y=0, UV=128) set up in loadPlatform(). Without this, the
                 // GPU textures contain uninitialized data and the BT.601
                 // shader renders a green flash on the first frame (Y=0,
                 // U=0, V=0 → RGB (0, 135, 0)).
-                if (pixelsY_ && pixelsUV_) {
-                    textureY_.loadData(pixelsY_,  width_,     height_,     1);
-                    textureUV_.loadData(pixelsUV_, width_ / 2, height_ / 2, 2);
-                }
+                uploadPlanes();
             } else {
                 texture_.allocate(width_, height_, 4, TextureUsage::Stream);
             }
@@ -126,12 +127,15 @@ public:
         texture_.clear();
         textureY_.clear();
         textureUV_.clear();
+        textureV_.clear();
 
         if (pixels_)  { delete[] pixels_;  pixels_  = nullptr; }
         if (pixelsY_) { delete[] pixelsY_; pixelsY_ = nullptr; }
         if (pixelsUV_){ delete[] pixelsUV_; pixelsUV_ = nullptr; }
-        nv12Mode_ = false;
-        nv12ShaderHandle_ = nullptr;  // deleted in closePlatform()
+        if (pixelsV_) { delete[] pixelsV_; pixelsV_ = nullptr; }
+        yuvMode_ = false;
+        i420Mode_ = false;
+        yuvShaderHandle_ = nullptr;  // deleted in closePlatform()
 
         initialized_ = false;
         playing_ = false;
@@ -165,12 +169,8 @@ public:
         // Check for new frame from platform
         if (hasNewFramePlatform()) {
             std::lock_guard<std::mutex> lock(mutex_);
-            if (nv12Mode_) {
-                if (pixelsY_ && pixelsUV_ && width_ > 0 && height_ > 0) {
-                    textureY_.loadData(pixelsY_,  width_,     height_,     1);
-                    textureUV_.loadData(pixelsUV_, width_ / 2, height_ / 2, 2);
-                    markFrameNew();
-                }
+            if (yuvMode_) {
+                if (uploadPlanes()) markFrameNew();
             } else {
                 if (pixels_ && width_ > 0 && height_ > 0) {
                     texture_.loadData(pixels_, width_, height_, 4);
@@ -181,14 +181,14 @@ public:
         }
 
         // A live frame replaces the poster; free the temporary poster
-        // texture in NV12 mode (the shader path takes over). Track what
+        // texture in YUV mode (the shader path takes over). Track what
         // moment the picture on the texture belongs to (poster decisions).
         if (frameNew_) {
             lastShownTime_ = getCurrentTime();
             pendingSeekSec_ = -1.0f;  // live playback reflects the position now
             if (posterActive_) {
                 posterActive_ = false;
-                if (nv12Mode_) texture_.clear();
+                if (yuvMode_) texture_.clear();
             }
         }
 
@@ -244,7 +244,7 @@ public:
     bool getAutoPoster() const { return autoPoster_; }
 
     // =========================================================================
-    // Draw (NV12 path uses shader; RGBA path uses default HasTexture::draw)
+    // Draw (YUV path uses shader; RGBA path uses default HasTexture::draw)
     // =========================================================================
 
     void draw(float x, float y) const override {
@@ -253,10 +253,10 @@ public:
 
     void draw(float x, float y, float w, float h) const override {
 #if defined(__linux__) && !defined(__ANDROID__)
-        // While the poster is up, draw it even in NV12 mode (the poster is an
+        // While the poster is up, draw it even in YUV mode (the poster is an
         // RGBA texture; the Y/UV planes still hold priming data).
-        if (nv12Mode_ && nv12ShaderHandle_ && !posterActive_) {
-            drawNV12Platform(x, y, w, h);
+        if (yuvMode_ && yuvShaderHandle_ && !posterActive_) {
+            drawYuvPlatform(x, y, w, h);
             return;
         }
 #endif
@@ -306,6 +306,26 @@ public:
         previousFramePlatform();
     }
 
+    /// Scrub mode for timeline scrubbing and "jump to cue" (Linux backend;
+    /// other backends ignore it). Each seek first shows the keyframe before
+    /// the target, then the exact frame once it is decoded, and the last
+    /// `cacheFrames` seek results are kept so scrubbing back over them
+    /// shows them without decoding (each costs one decoded frame of memory).
+    /// Can be set before or after load().
+    ///
+    /// On Linux, seeks also show their frame while stopped or paused, and go
+    /// through a keyframe index built in the background after load() and
+    /// cached next to the video as "<file>.tcseek".
+    void setScrubMode(bool on, int cacheFrames = 8) {
+        scrubMode_ = on;
+        scrubCacheFrames_ = cacheFrames;
+#if defined(__linux__) && !defined(__ANDROID__)
+        setScrubModePlatform();
+#endif
+    }
+
+    bool getScrubMode() const { return scrubMode_; }
+
     // =========================================================================
     // Gamma Correction
     // =========================================================================
@@ -343,11 +363,28 @@ public:
     // Pixel access
     // =========================================================================
 
+    /// RGBA pixels of the current frame (nullptr in planar modes — use
+    /// getPixelsY() / getPixelsUV() / getPixelsV()).
+    /// On Linux the pointer goes into a pooled frame, not a player-owned
+    /// copy: it is valid until the next update() that brings a new frame,
+    /// after which the block is reused by the decoder. Copy the data to
+    /// keep a frame.
     unsigned char* getPixels() override { return pixels_; }
     const unsigned char* getPixels() const override { return pixels_; }
 
+    /// Planes of the current frame in planar modes (Y full size; UV, or U
+    /// and V, at half resolution). Same lifetime as getPixels(): pooled on
+    /// Linux, reused after the next update() that brings a new frame.
     unsigned char* getPixelsY()  { return pixelsY_; }
     unsigned char* getPixelsUV() { return pixelsUV_; }
+    unsigned char* getPixelsV()  { return pixelsV_; }
+
+    /// Storage behind the decoded-frame queue (Linux backend; other
+    /// backends decode into their own buffers and report zeros).
+    /// peakBytesInUse / peakBlocksInUse are the high-water marks.
+    PixelsPool::Stats getFramePoolStats() const {
+        return framePool_->getStats();
+    }
 
     // =========================================================================
     // Audio access
@@ -422,15 +459,22 @@ protected:
     }
 
 private:
-    // Pixel data (RGBA)
+    // Pixel data (RGBA). On Linux this and the YUV planes below point into
+    // the decoder's shown frame (no copy) and move to each new frame in
+    // update(); other backends own a buffer of their own.
     unsigned char* pixels_ = nullptr;
 
-    // NV12 (CUDA HW decode) planes — Linux only, non-null when nv12Mode_ is set
+    // YUV planes, converted to RGB by a shader at draw — Linux only,
+    // non-null when yuvMode_ is set. NV12 (HW decode; P010 is narrowed to
+    // 8 bits): Y + interleaved UV. I420 (YUV420P): Y + U in pixelsUV_ + V.
     unsigned char* pixelsY_  = nullptr;
     unsigned char* pixelsUV_ = nullptr;
+    unsigned char* pixelsV_  = nullptr;  // I420 only
     Texture textureY_;
     Texture textureUV_;
-    bool  nv12Mode_       = false;
+    Texture textureV_;
+    bool  yuvMode_        = false;
+    bool  i420Mode_       = false;  // separate U / V planes (yuvMode_ only)
     bool  autoPoster_     = true;   // extract-and-show a poster on load/play
     bool  posterActive_   = false;  // poster currently on texture_ (until live)
     Pixels posterPx_;               // poster awaiting upload (deferred one frame)
@@ -438,14 +482,21 @@ private:
     uint64_t texUploadFrame_ = ~0ull;    // sapp frame of the last texture_ upload
     float lastShownTime_  = -1.0f;  // time (sec) of the picture on the texture
     float pendingSeekSec_ = -1.0f;  // seek target awaiting playback (-1 = none)
-    void* nv12ShaderHandle_ = nullptr;  // NV12VideoShader* on Linux/CUDA
+    void* yuvShaderHandle_ = nullptr;  // YuvVideoShader* on Linux
 
     // Gamma correction (1.0 = none)
     float gammaCorrection_ = 1.0f;
 
+    // Decoded frames waiting in the platform queue borrow from here
+    std::shared_ptr<PixelsPool> framePool_ = std::make_shared<PixelsPool>();
+
     // HW decode preference (default on; Linux backend honors this)
     bool useHwAccel_ = true;
 
+    // setScrubMode() (Linux backend honors this)
+    bool scrubMode_ = false;
+    int scrubCacheFrames_ = 8;
+
     // Platform-specific handle
     void* platformHandle_ = nullptr;
 
@@ -472,34 +523,58 @@ private:
         pixels_    = other.pixels_;
         pixelsY_   = other.pixelsY_;
         pixelsUV_  = other.pixelsUV_;
+        pixelsV_   = other.pixelsV_;
         texture_   = std::move(other.texture_);
         textureY_  = std::move(other.textureY_);
         textureUV_ = std::move(other.textureUV_);
-        nv12Mode_        = other.nv12Mode_;
+        textureV_  = std::move(other.textureV_);
+        yuvMode_         = other.yuvMode_;
+        i420Mode_        = other.i420Mode_;
         autoPoster_      = other.autoPoster_;
+        scrubMode_       = other.scrubMode_;
+        scrubCacheFrames_ = other.scrubCacheFrames_;
         posterActive_    = other.posterActive_;
         posterPx_        = std::move(other.posterPx_);
         posterUploadPending_ = other.posterUploadPending_;
         texUploadFrame_  = other.texUploadFrame_;
         lastShownTime_   = other.lastShownTime_;
         pendingSeekSec_  = other.pendingSeekSec_;
-        nv12ShaderHandle_ = other.nv12ShaderHandle_;
+        yuvShaderHandle_ = other.yuvShaderHandle_;
         platformHandle_  = other.platformHandle_;
         sourcePath_      = std::move(other.sourcePath_);
+        framePool_       = std::move(other.framePool_);
 
+        other.framePool_ = std::make_shared<PixelsPool>();
         other.pixels_    = nullptr;
         other.pixelsY_   = nullptr;
         other.pixelsUV_  = nullptr;
+        other.pixelsV_   = nullptr;
         other.posterUploadPending_ = false;
         other.texUploadFrame_      = ~0ull;
-        other.nv12Mode_        = false;
-        other.nv12ShaderHandle_ = nullptr;
+        other.yuvMode_         = false;
+        other.i420Mode_        = false;
+        other.yuvShaderHandle_ = nullptr;
         other.initialized_     = false;
         other.platformHandle_  = nullptr;
         other.width_  = 0;
         other.height_ = 0;
     }
 
+    // Upload the CPU YUV planes to their textures (YUV mode). Returns false
+    // if the planes aren't allocated.
+    bool uploadPlanes() {
+        if (!pixelsY_ || !pixelsUV_ || width_ <= 0 || height_ <= 0) return false;
+        textureY_.loadData(pixelsY_, width_, height_, 1);
+        if (i420Mode_) {
+            if (!pixelsV_) return false;
+            textureUV_.loadData(pixelsUV_, width_ / 2, height_ / 2, 1);
+            textureV_.loadData(pixelsV_,   width_ / 2, height_ / 2, 1);
+        } else {
+            textureUV_.loadData(pixelsUV_, width_ / 2, height_ / 2, 2);
+        }
+        return true;
+    }
+
     // Clear texture to black (prevents old frame from showing)
     // Extract the frame at timeSec and put it on texture_ as a poster.
     // timeSec <= 0 uses the keyframe path (frame 0 is a keyframe: exact+fast).
@@ -703,9 +778,20 @@ private:
 
     // Allow platform implementations to access internals
     friend class internal::VideoPlayerPlatformAccess;
+    friend class VideoGroup;
 
 #if defined(__linux__) && !defined(__ANDROID__)
-    void drawNV12Platform(float x, float y, float w, float h) const;
+    void drawYuvPlatform(float x, float y, float w, float h) const;
+    void bindFramePlatform();
+    void setScrubModePlatform();
+
+    // VideoGroup (tcVideoGroup.h): shared decode pool and group clock
+    static void* createDecodePoolPlatform(int threads);
+    static void destroyDecodePoolPlatform(void* pool);
+    void attachDecodePoolPlatform(void* pool);              // nullptr = own thread
+    void setGroupClockPlatform(double clock, double present); // NaN = own clock
+    double newestFramePlatform(double t) const;             // -inf if none
+    double frameDurationPlatform() const;
 #endif
 };
 
@@ -729,6 +815,9 @@ public:
     static std::mutex& getMutex(VideoPlayer& player) {
         return player.mutex_;
     }
+    static const std::shared_ptr<PixelsPool>& getFramePool(VideoPlayer& player) {
+        return player.framePool_;
+    }
 };
 } // namespace internal
 
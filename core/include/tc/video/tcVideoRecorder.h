@@ -60,6 +60,15 @@
     #define TC_ASYNC_SCREEN_CAPTURE 0
 #endif
 
+// Linux: VideoWriter converts and encodes frames on worker threads behind a
+// queue of pooled RGBA buffers (settings.queueDepth / queuePolicy). Elsewhere
+// every frame is handed to the encoder synchronously.
+#if defined(__linux__) && !defined(__ANDROID__)
+    #define TC_PIPELINED_VIDEO_WRITER 1
+#else
+    #define TC_PIPELINED_VIDEO_WRITER 0
+#endif
+
 namespace trussc {
 
 class Fbo;
@@ -88,6 +97,12 @@ inline const char* videoCodecName(VideoCodec c) {
     return "?";
 }
 
+// What VideoWriter does with a frame when its encode queue is full (Linux).
+enum class VideoQueuePolicy {
+    Block,  // wait for the encoder: nothing is lost (offline renders) — the default
+    Drop,   // skip the frame and count it: the app never stalls (live capture)
+};
+
 struct VideoRecordSettings {
     VideoCodec codec = VideoCodec::H264;
     float fps = 60.0f;          // ScreenRecorder: capture ceiling (real-time PTS,
@@ -95,6 +110,10 @@ struct VideoRecordSettings {
                                 // VideoWriter: the exact output frame rate.
     int bitrate = 0;            // bits/sec for H.264/HEVC; 0 = auto. Ignored by ProRes.
     int keyframeInterval = 0;   // frames between keyframes; 0 = encoder default.
+    int queueDepth = 0;         // Linux: RGBA frames that may wait for conversion /
+                                // encoding (one w*h*4 buffer each); 0 = auto.
+    VideoQueuePolicy queuePolicy = VideoQueuePolicy::Block;
+                                // Linux: when the queue is full. Others block.
     float duration = 0.0f;      // ScreenRecorder: auto-stop & finalize after this
                                 // many seconds of output; 0 = unlimited (call
                                 // stop() manually). Ignored by VideoWriter.
@@ -150,6 +169,8 @@ public:
         settings_ = settings;
         fps_ = (settings_.fps > 0.0f) ? settings_.fps : 60.0f;
         frameCount_ = 0;
+        encodedFrames_.store(0);
+        droppedFrames_.store(0);
         scratch_.resize((size_t)width_ * height_ * 4);
 
         // Platform encoders take UTF-8 (converted to native inside)
@@ -170,14 +191,26 @@ public:
     void close() {
         if (open_) {
             closePlatform();
+            const uint64_t dropped = droppedFrames_.load();
             logNotice("VideoWriter")
-                << "saved " << frameCount_ << " frames -> " << path_;
+                << "saved " << (frameCount_ - dropped) << " frames"
+                << (dropped ? " (" + std::to_string(dropped) + " dropped)" : std::string())
+                << " -> " << path_;
         }
         open_ = false;
     }
 
     bool isOpen() const { return open_; }
+    // Frames added so far, dropped ones included (they keep their slot on the
+    // addFrame() timeline).
     int  getFrameCount() const { return frameCount_; }
+
+    // Frames the encoder has consumed, and frames skipped because the encode
+    // queue was full (settings.queuePolicy = Drop). Without the Linux queue
+    // every added frame is encoded synchronously and none are dropped.
+    // Frames still queued when the encoder fails count as neither.
+    uint64_t getEncodedFrames() const { return encodedFrames_.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const { return droppedFrames_.load(std::memory_order_relaxed); }
     int  getWidth() const { return width_; }
     int  getHeight() const { return height_; }
     float getFps() const { return fps_; }
@@ -199,11 +232,37 @@ public:
                 << " != writer " << width_ << "x" << height_;
             return false;
         }
+#if TC_PIPELINED_VIDEO_WRITER
+        // Read back straight into the encode queue's next free buffer; the
+        // conversion and encoding run on the writer's threads.
+        bool dropped = false;
+        unsigned char* dst = acquireFramePlatform(dropped);
+        if (!dst) {
+            if (!dropped) {
+                logError("VideoWriter") << "encoder rejected frame " << frameCount_;
+                return false;
+            }
+            ++frameCount_;
+            return true;
+        }
+        if (!fbo.readPixels(dst)) {
+            cancelFramePlatform();
+            logError("VideoWriter") << "fbo readPixels failed";
+            return false;
+        }
+        if (!commitFramePlatform(timeSec)) {
+            logError("VideoWriter") << "encoder rejected frame " << frameCount_;
+            return false;
+        }
+        ++frameCount_;
+        return true;
+#else
         if (!fbo.readPixels(scratch_.data())) {
             logError("VideoWriter") << "fbo readPixels failed";
             return false;
         }
         return appendRGBA(scratch_.data(), timeSec);
+#endif
     }
     bool addFrameAt(const Pixels& pixels, double timeSec) {
         if (!open_) return false;
@@ -218,13 +277,15 @@ public:
         const unsigned char* src = pixels.getData();
         const int ch = pixels.getChannels();
         const size_t n = (size_t)width_ * height_;
-        for (size_t i = 0; i < n; ++i) {
-            unsigned char r = src[i * ch + 0];
-            scratch_[i * 4 + 0] = r;
-            scratch_[i * 4 + 1] = (ch > 1) ? src[i * ch + 1] : r;
-            scratch_[i * 4 + 2] = (ch > 2) ? src[i * ch + 2] : r;
-            scratch_[i * 4 + 3] = 255;
+        if (ch == 3) {
+            pixelconv::rgbToRgba(src, scratch_.data(), n);
+            return appendRGBA(scratch_.data(), timeSec);
+        }
+        if (ch == 1) {
+            pixelconv::grayToRgba(src, scratch_.data(), n);
+            return appendRGBA(scratch_.data(), timeSec);
         }
+        pixelconv::grayAlphaToRgba(src, scratch_.data(), n);
         return appendRGBA(scratch_.data(), timeSec);
     }
 
@@ -258,6 +319,7 @@ public:
             return false;
         }
         ++frameCount_;
+        encodedFrames_.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 #endif
@@ -280,6 +342,9 @@ private:
             return false;
         }
         ++frameCount_;
+#if !TC_PIPELINED_VIDEO_WRITER
+        encodedFrames_.fetch_add(1, std::memory_order_relaxed);  // Linux: when the encoder lets go of it
+#endif
         return true;
     }
 
@@ -294,6 +359,14 @@ private:
     unsigned char* lockFramePlatform(int& strideOut);   // lock & return encoder buffer
     bool submitFramePlatform(double timeSec);            // append the locked buffer
 #endif
+#if TC_PIPELINED_VIDEO_WRITER
+    // Encode-queue hooks (Linux): a free RGBA buffer to fill (nullptr: failed,
+    // or dropped = true when the queue is full under VideoQueuePolicy::Drop),
+    // then queue it at a PTS or hand it back unused.
+    unsigned char* acquireFramePlatform(bool& dropped);
+    bool commitFramePlatform(double timeSec);
+    void cancelFramePlatform();
+#endif
 
     internal::VideoWriterPlatformData* platform_ = nullptr;
     fs::path path_;
@@ -304,6 +377,9 @@ private:
     VideoRecordSettings settings_;
     int   frameCount_ = 0;
     bool  open_ = false;
+    // Updated by the platform's encode threads (Linux)
+    std::atomic<uint64_t> encodedFrames_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
 };
 
 // ---------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+#pragma once
+
+// =============================================================================
+// tcVideoSeekIndex.h - keyframe / PTS index and scrub frame cache
+// =============================================================================
+//
+// A plain demuxer seek lands on "some keyframe before t", and the decoder
+// then has to work forward without knowing which frame it is looking for.
+// VideoSeekIndex records the presentation timestamp of every frame of a
+// stream and which of them are keyframes, so a seek to t can go straight to
+// the keyframe before the frame on screen at t and stop exactly on it:
+//
+//   tc::VideoSeekIndex index;
+//   for (each demuxed packet) index.add(pkt.pts, pkt.isKey);
+//   index.finish();
+//   int64_t frame = index.frameAtOrBefore(t);     // the frame shown at t
+//   int64_t key   = index.keyframeAtOrBefore(t);  // where decoding starts
+//
+// - Timestamps are in the stream's time base; add() takes packets in any
+//   order (decode order), finish() sorts them.
+// - Building it means reading every packet once, so save() / load() cache it
+//   in a sidecar file next to the video (sidecarPath()). The cache is keyed
+//   by the file's size + modification time and the stream index; a mismatch
+//   or a damaged file makes load() fail and the index is rebuilt.
+//
+// VideoFrameCache is a small LRU of decoded frames keyed by timestamp, so
+// scrubbing back and forth over the same spot shows frames without decoding
+// them again.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <list>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace trussc {
+
+namespace fs = std::filesystem;
+
+class VideoSeekIndex {
+public:
+    static constexpr int64_t kNone = std::numeric_limits<int64_t>::min();
+
+    // Identifies the file version the index was built from.
+    struct Source {
+        uint64_t size = 0;
+        int64_t mtime = 0;    // last_write_time, clock ticks since its epoch
+        int32_t stream = 0;   // video stream index inside the container
+
+        bool operator==(const Source& o) const {
+            return size == o.size && mtime == o.mtime && stream == o.stream;
+        }
+        bool operator!=(const Source& o) const { return !(*this == o); }
+
+        // Size + mtime of `file` (false if it isn't a readable regular file).
+        static bool of(const fs::path& file, int32_t stream, Source& out) {
+            std::error_code ec;
+            if (!fs::is_regular_file(file, ec)) return false;
+            out.size = fs::file_size(file, ec);
+            if (ec) return false;
+            auto t = fs::last_write_time(file, ec);
+            if (ec) return false;
+            out.mtime = (int64_t)t.time_since_epoch().count();
+            out.stream = stream;
+            return true;
+        }
+    };
+
+    void clear() {
+        frames_.clear();
+        keyframes_.clear();
+    }
+
+    // Record one frame (a demuxed packet). Call finish() when done.
+    void add(int64_t pts, bool keyframe) {
+        frames_.push_back(pts);
+        if (keyframe) keyframes_.push_back(pts);
+    }
+
+    // Sort into presentation order and drop duplicate timestamps.
+    void finish() {
+        sortUnique(frames_);
+        sortUnique(keyframes_);
+    }
+
+    // Usable for seeking: at least one keyframe.
+    bool empty() const { return keyframes_.empty(); }
+    size_t getFrameCount() const { return frames_.size(); }
+    size_t getKeyframeCount() const { return keyframes_.size(); }
+    const std::vector<int64_t>& getFrames() const { return frames_; }
+    const std::vector<int64_t>& getKeyframes() const { return keyframes_; }
+
+    // The frame on screen at `pts`: the last one starting at or before it.
+    // Before the first frame that is the first frame; kNone if empty.
+    int64_t frameAtOrBefore(int64_t pts) const { return atOrBefore(frames_, pts); }
+
+    // Where to start decoding to reach the frame at `pts`.
+    int64_t keyframeAtOrBefore(int64_t pts) const { return atOrBefore(keyframes_, pts); }
+
+    // Neighbouring frames of the one at `pts` (kNone past either end).
+    int64_t frameAfter(int64_t pts) const {
+        auto it = std::upper_bound(frames_.begin(), frames_.end(), pts);
+        return it == frames_.end() ? kNone : *it;
+    }
+    int64_t frameBefore(int64_t pts) const {
+        auto it = std::lower_bound(frames_.begin(), frames_.end(), pts);
+        return it == frames_.begin() ? kNone : *(it - 1);
+    }
+
+    // Frames decoded to reach the frame at `pts` from its keyframe,
+    // counting both (presentation order; close to decode order per GOP).
+    size_t framesToDecode(int64_t pts) const {
+        const int64_t frame = frameAtOrBefore(pts);
+        const int64_t key = keyframeAtOrBefore(frame);
+        if (frame == kNone || key == kNone) return 0;
+        auto a = std::lower_bound(frames_.begin(), frames_.end(), key);
+        auto b = std::lower_bound(frames_.begin(), frames_.end(), frame);
+        return (size_t)(b - a) + 1;
+    }
+
+    // ---------------------------------------------------------------------
+    // Sidecar cache
+    // ---------------------------------------------------------------------
+
+    // "movie.mp4" -> "movie.mp4.tcseek"
+    static fs::path sidecarPath(const fs::path& video) {
+        fs::path p = video;
+        p += ".tcseek";
+        return p;
+    }
+
+    // Write atomically (temp file + rename), so a concurrent reader never
+    // sees a half-written index. The temp name is unique per call (thread,
+    // time, counter, as TextureCache does), so two players indexing the same
+    // clip at once each rename a whole file into place. Returns false if the
+    // directory isn't writable; the index stays usable in memory either way.
+    bool save(const fs::path& path, const Source& source) const {
+        static std::atomic<uint64_t> counter{0};
+        fs::path tmp = path;
+        tmp += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                                       (size_t)std::chrono::steady_clock::now().time_since_epoch().count()) +
+               "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            const Header h = header(source);
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            out.write(reinterpret_cast<const char*>(frames_.data()), frames_.size() * sizeof(int64_t));
+            out.write(reinterpret_cast<const char*>(keyframes_.data()), keyframes_.size() * sizeof(int64_t));
+            if (!out) {
+                out.close();
+                std::error_code ec;
+                fs::remove(tmp, ec);
+                return false;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        if (ec) fs::remove(tmp, ec);
+        return !ec;
+    }
+
+    // Replace the index with the sidecar at `path` if it was written for
+    // `source`. On failure the index is left unchanged.
+    bool load(const fs::path& path, const Source& source) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        Header h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+        const Header want = header(source);
+        if (std::memcmp(h.magic, want.magic, sizeof(h.magic)) != 0 || h.version != want.version ||
+            h.fileSize != want.fileSize || h.mtime != want.mtime || h.stream != want.stream) {
+            return false;
+        }
+
+        // Reject counts the file can't hold before allocating for them.
+        std::error_code ec;
+        const uint64_t bytes = fs::file_size(path, ec);
+        if (ec || h.frameCount > bytes / sizeof(int64_t) || h.keyframeCount > h.frameCount ||
+            bytes != sizeof(Header) + (h.frameCount + h.keyframeCount) * sizeof(int64_t)) {
+            return false;
+        }
+
+        std::vector<int64_t> frames(h.frameCount), keyframes(h.keyframeCount);
+        if (!in.read(reinterpret_cast<char*>(frames.data()), frames.size() * sizeof(int64_t)) ||
+            !in.read(reinterpret_cast<char*>(keyframes.data()), keyframes.size() * sizeof(int64_t))) {
+            return false;
+        }
+        if (!std::is_sorted(frames.begin(), frames.end()) ||
+            !std::is_sorted(keyframes.begin(), keyframes.end())) {
+            return false;
+        }
+        frames_ = std::move(frames);
+        keyframes_ = std::move(keyframes);
+        return true;
+    }
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t fileSize;
+        int64_t mtime;
+        int32_t stream;
+        uint32_t reserved;
+        uint64_t frameCount;
+        uint64_t keyframeCount;
+    };
+
+    Header header(const Source& source) const {
+        Header h{};
+        std::memcpy(h.magic, "TCSK", 4);
+        h.version = 1;
+        h.fileSize = source.size;
+        h.mtime = source.mtime;
+        h.stream = source.stream;
+        h.frameCount = frames_.size();
+        h.keyframeCount = keyframes_.size();
+        return h;
+    }
+
+    static void sortUnique(std::vector<int64_t>& v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+
+    static int64_t atOrBefore(const std::vector<int64_t>& v, int64_t pts) {
+        if (v.empty()) return kNone;
+        auto it = std::upper_bound(v.begin(), v.end(), pts);
+        return it == v.begin() ? v.front() : *(it - 1);
+    }
+
+    std::vector<int64_t> frames_;     // every frame, presentation order
+    std::vector<int64_t> keyframes_;  // the keyframes among them
+};
+
+// ---------------------------------------------------------------------------
+// VideoFrameCache - LRU of decoded frames keyed by timestamp
+// ---------------------------------------------------------------------------
+// Meant for a handful of frames (lookups are linear). Not thread-safe: keep
+// it on the thread that decodes. Frame only needs to be movable.
+template <typename Frame>
+class VideoFrameCache {
+public:
+    explicit VideoFrameCache(size_t capacity = 0) : capacity_(capacity) {}
+
+    // 0 disables the cache (and empties it).
+    void setCapacity(size_t capacity) {
+        capacity_ = capacity;
+        trim();
+    }
+    size_t getCapacity() const { return capacity_; }
+    size_t size() const { return items_.size(); }
+    void clear() { items_.clear(); }
+
+    // The frame stored for `pts` (now the most recently used), or nullptr.
+    const Frame* find(int64_t pts) {
+        for (auto it = items_.begin(); it != items_.end(); ++it) {
+            if (it->first == pts) {
+                items_.splice(items_.begin(), items_, it);
+                return &items_.front().second;
+            }
+        }
+        return nullptr;
+    }
+
+    bool contains(int64_t pts) const {
+        for (const auto& item : items_) {
+            if (item.first == pts) return true;
+        }
+        return false;
+    }
+
+    // Store (or replace) the frame for `pts`, evicting the least recently
+    // used one when full.
+    void put(int64_t pts, Frame frame) {
+        if (capacity_ == 0) return;
+        for (auto it = items_.begin(); it != items_.end(); ++it) {
+            if (it->first == pts) {
+                items_.erase(it);
+                break;
+            }
+        }
+        items_.emplace_front(pts, std::move(frame));
+        trim();
+    }
+
+private:
+    void trim() {
+        while (items_.size() > capacity_) items_.pop_back();
+    }
+
+    size_t capacity_;
+    std::list<std::pair<int64_t, Frame>> items_;  // front = most recent
+};
+
+} // namespace trussc
@@ -0,0 +1,98 @@
+#pragma once
+
+// =============================================================================
+// tcVideoSync.h - frame lock policy for synchronised playback
+// =============================================================================
+//
+// Decides which moment a group of videos shows on a display frame. Every
+// member reports the newest frame it could show at the group clock; the
+// group then presents one time for all of them:
+//
+//   tc::VideoFrameLock lock;
+//   lock.setMaxLagFrames(2);
+//   auto d = lock.decide(clock, newest, durations);
+//   for (each member i) member[i].present(d.present);   // same moment
+//
+// - A member is on time when its newest frame still covers the clock
+//   (newest > clock - its frame duration).
+// - All on time: present the clock.
+// - Someone late by at most maxLagFrames of its frames: hold everyone on the
+//   late member's newest frame, so the wall never shows two moments at once
+//   (it catches up on the next display frames).
+// - Later than that, or no frame at all (stalled, not decoded yet): present
+//   the clock anyway - one stuck stream must not freeze the whole wall.
+// - The presented time never goes backwards between decide() calls (a frame
+//   already on screen can't be taken back); reset() after a seek.
+//
+// Plain C++ (no TrussC dependencies), used by VideoGroup.
+//
+// =============================================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace trussc {
+
+class VideoFrameLock {
+public:
+    struct Decision {
+        double present = 0.0;   // time every member shows
+        size_t late = 0;        // members without a frame covering the clock
+        bool held = false;      // present < clock: waiting for late members
+    };
+
+    void setMaxLagFrames(int frames) { maxLagFrames_ = std::max(frames, 0); }
+    int getMaxLagFrames() const { return maxLagFrames_; }
+
+    // Forget the last presented time (after a seek or loop).
+    void reset() { last_ = -std::numeric_limits<double>::infinity(); }
+
+    // newest[i]: member i's newest frame time at or before `clock`
+    // (-infinity: none). durations[i]: its frame duration. If `lateOut` is
+    // given, lateOut[i] is set for members that are late.
+    Decision decide(double clock, const std::vector<double>& newest,
+                    const std::vector<double>& durations,
+                    std::vector<char>* lateOut = nullptr) {
+        const double inf = std::numeric_limits<double>::infinity();
+        Decision d;
+        if (lateOut) lateOut->assign(newest.size(), 0);
+
+        double slowest = inf;   // newest frame of the latest late member
+        double window = 0.0;    // lag the hold tolerates
+        for (size_t i = 0; i < newest.size(); ++i) {
+            const double dur = i < durations.size() && durations[i] > 0.0 ? durations[i] : 1.0 / 30.0;
+            if (newest[i] > clock - dur + kEpsilon) continue;
+            ++d.late;
+            if (lateOut) (*lateOut)[i] = 1;
+            if (newest[i] < slowest) {
+                slowest = newest[i];
+                window = maxLagFrames_ * dur;
+            }
+        }
+
+        d.present = clock;
+        if (d.late > 0 && slowest > -inf && clock - slowest <= window) {
+            d.present = slowest;
+            d.held = true;
+        }
+        d.present = std::max(d.present, last_);
+        if (d.present >= clock) {
+            d.present = clock;
+            d.held = false;
+        }
+        last_ = d.present;
+        return d;
+    }
+
+private:
+    // A frame exactly one duration old no longer covers the clock, even when
+    // rounding puts it a hair inside.
+    static constexpr double kEpsilon = 1e-6;
+
+    int maxLagFrames_ = 2;
+    double last_ = -std::numeric_limits<double>::infinity();
+};
+
+} // namespace trussc
@@ -0,0 +1,105 @@
+#pragma once
+
+// =============================================================================
+// tcYuvVideoShader.h - draw YUV planes with a GPU colour conversion
+// =============================================================================
+//
+// Immediate-draw shader for the Linux video backends (VideoPlayer, and
+// VideoGrabber in YUV output mode): an immutable unit quad, positioned by
+// uniforms, sampling the planes with normalised coordinates - so any chroma
+// subsampling (4:2:0, 4:2:2) works as long as the planes cover the frame.
+//
+//   NV12: Y (R8) + interleaved UV (RG8)   videoNV12.glsl
+//   I420: Y + U + V (R8 each)             videoI420.glsl
+//
+// Both are BT.601 limited range. Not included from TrussC.h; include it
+// after TrussC.h in the backend that draws with it.
+//
+// =============================================================================
+
+#include "tc/gpu/shaders/videoNV12.glsl.h"
+#include "tc/gpu/shaders/videoI420.glsl.h"
+
+namespace trussc {
+namespace internal {
+
+class YuvVideoShader : public Shader {
+public:
+    void loadShader(bool i420) {
+        load(i420 ? tc_video_i420_i420_shader_desc : tc_video_nv12_nv12_shader_desc);
+    }
+
+    // texV is only bound for I420 (nullptr for NV12)
+    void draw(float x, float y, float w, float h,
+              const Texture& texY, const Texture& texUV, const Texture* texV) {
+        if (!loaded) return;
+
+        ensureSwapchainPass();
+        sgl_draw();
+
+        sg_apply_pipeline(pipeline);
+
+        // x/y/w/h come in logical coordinates (same space tcApp draws in),
+        // but sapp_width()/sapp_height() are physical framebuffer pixels.
+        // Divide by DPI scale so the shader's viewport matches its inputs.
+        const float dpiScale = sapp_dpi_scale();
+        const float vpW = (float)sapp_width()  / dpiScale;
+        const float vpH = (float)sapp_height() / dpiScale;
+
+        struct VsParams { float v[8]; } p = {{
+            vpW, vpH, x, y,
+            w,   h,   0.0f, 0.0f
+        }};
+        sg_range range = { &p, sizeof(p) };
+        sg_apply_uniforms(0, &range);
+
+        sg_bindings bind = {};
+        bind.vertex_buffers[0] = vertexBuffer;
+        bind.index_buffer      = indexBuffer;
+        bind.views[0]    = texY.getView();
+        bind.samplers[0] = texY.getSampler();
+        bind.views[1]    = texUV.getView();
+        bind.samplers[1] = texUV.getSampler();
+        if (texV) {
+            bind.views[2]    = texV->getView();
+            bind.samplers[2] = texV->getSampler();
+        }
+        sg_apply_bindings(&bind);
+
+        sg_draw(0, 6, 1);
+
+        sg_reset_state_cache();
+        sgl_defaults();
+        sglLoadProjection(screen2DProjection(vpW, vpH));
+        sgl_matrix_mode_modelview();
+        sgl_load_identity();
+    }
+
+protected:
+    sg_pipeline_desc createPipelineDesc() override {
+        sg_pipeline_desc desc = {};
+        desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT2;
+        desc.colors[0].blend.enabled = false;
+        desc.index_type = SG_INDEXTYPE_UINT16;
+        desc.label = "tc_yuv_pipeline";
+        return desc;
+    }
+
+    void createVertexBuffer() override {
+        float verts[] = { 0.f,0.f, 1.f,0.f, 1.f,1.f, 0.f,1.f };
+        sg_buffer_desc vd = {};
+        vd.data  = SG_RANGE(verts);
+        vd.label = "tc_yuv_verts";
+        vertexBuffer = sg_make_buffer(&vd);
+
+        uint16_t idx[] = { 0, 1, 2, 0, 2, 3 };
+        sg_buffer_desc id = {};
+        id.usage.index_buffer = true;
+        id.data  = SG_RANGE(idx);
+        id.label = "tc_yuv_idx";
+        indexBuffer = sg_make_buffer(&id);
+    }
+};
+
+} // namespace internal
+} // namespace trussc
@@ -99,10 +99,7 @@ bool Fbo::readPixelsFloatPlatform(float* pixels) const {
                            glFormat, GL_UNSIGNED_BYTE, tmp.data(), width_ * ch, true)) {
         return false;
     }
-    int total = width_ * height_ * ch;
-    for (int i = 0; i < total; i++) {
-        pixels[i] = (float)tmp[i] / 255.0f;
-    }
+    pixelconv::u8ToF32(tmp.data(), pixels, (size_t)width_ * height_ * ch);
     return true;
 }
 
@@ -2,12 +2,21 @@
 // tcVideoGrabber_linux.cpp - Linux V4L2 implementation
 // =============================================================================
 // Uses Video4Linux2 (V4L2) for webcam capture.
-// Supports YUYV and MJPEG formats, converts to RGBA.
+// Supports YUYV and MJPEG formats, converts to RGBA - or, with
+// setYuvOutput(), hands Y + UV planes to the NV12 draw shader.
+//
+// - YUYV: SIMD conversion (tc::pixelconv) on the capture thread.
+// - MJPEG: libavcodec on a few decode threads, one frame each (frame
+//   parallel); frames are published in capture order. The capture thread
+//   only copies the compressed bytes and hands the V4L2 buffer straight
+//   back, so a slow decode never stalls the driver queue.
 // =============================================================================
 
 #ifdef __linux__
 
 #include "TrussC.h"
+#include "tc/graphics/tcPixelConv.h"
+#include "tc/video/tcYuvVideoShader.h"
 
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
@@ -19,13 +28,269 @@
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 
-// For MJPEG decoding
-#define STB_IMAGE_IMPLEMENTATION_ALREADY_DONE
-#include <stb/stb_image.h>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+#include <libavutil/pixdesc.h>
+}
 
 namespace trussc {
 
+struct VideoGrabberPlatformData;
+static void publishFrame(VideoGrabberPlatformData* data, const unsigned char* rgba,
+                         const unsigned char* y, const unsigned char* uv, uint64_t arrivalUs);
+
+// =============================================================================
+// MJPEG decoder: frame-parallel libavcodec workers
+// =============================================================================
+// Each worker owns a decoder context and decodes whole frames; with N
+// workers N frames are in flight. A frame that finishes early waits for its
+// predecessors, so the app (and the frame queue) see capture order. When
+// every slot is taken the new frame is dropped - the camera keeps running.
+class MjpegDecoder {
+public:
+    ~MjpegDecoder() { stop(); }
+
+    // Output: RGBA, or Y + NV12 UV planes (yuv; RGBA as well while
+    // setQueueRgba() is on, for the frame queue).
+    bool start(VideoGrabberPlatformData* owner, int width, int height, bool yuv, int threads) {
+        owner_ = owner;
+        width_ = width;
+        height_ = height;
+        yuv_ = yuv;
+        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+        if (!codec) {
+            logError("VideoGrabber") << "No MJPEG decoder in libavcodec";
+            return false;
+        }
+        workers_.resize(std::max(threads, 1));
+        for (auto& w : workers_) {
+            w.ctx = avcodec_alloc_context3(codec);
+            if (!w.ctx) return false;
+            w.ctx->thread_count = 1;  // parallel across frames instead
+            if (avcodec_open2(w.ctx, codec, nullptr) < 0) {
+                logError("VideoGrabber") << "Failed to open MJPEG decoder";
+                return false;
+            }
+            w.frame = av_frame_alloc();
+            w.pkt = av_packet_alloc();
+        }
+        // One frame waiting per worker on top of the ones being decoded
+        slots_.resize(workers_.size() * 2);
+        for (auto& slot : slots_) freeSlots_.push_back(&slot);
+
+        running_ = true;
+        for (auto& w : workers_) w.thread = std::thread(&MjpegDecoder::workerLoop, this, &w);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        publishCv_.notify_all();
+        for (auto& w : workers_) {
+            if (w.thread.joinable()) w.thread.join();
+            if (w.sws) sws_freeContext(w.sws);
+            if (w.swsRgba) sws_freeContext(w.swsRgba);
+            av_packet_free(&w.pkt);
+            av_frame_free(&w.frame);
+            avcodec_free_context(&w.ctx);
+        }
+        workers_.clear();
+    }
+
+    // Capture thread: copy the compressed frame into a free slot. Returns
+    // false (frame dropped) when all decoders are behind.
+    bool submit(const unsigned char* src, size_t size, uint64_t arrivalUs) {
+        Slot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (freeSlots_.empty()) {
+                ++dropped_;
+                return false;
+            }
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        // libavcodec reads up to AV_INPUT_BUFFER_PADDING_SIZE past the end
+        slot->data.resize(size + AV_INPUT_BUFFER_PADDING_SIZE);
+        std::memcpy(slot->data.data(), src, size);
+        std::memset(slot->data.data() + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        slot->size = size;
+        slot->arrivalUs = arrivalUs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot->seq = nextSeq_++;
+            pending_.push_back(slot);
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void setQueueRgba(bool on) { queueRgba_.store(on, std::memory_order_relaxed); }
+
+    uint64_t getDropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    struct Slot {
+        std::vector<unsigned char> data;
+        size_t size = 0;
+        uint64_t arrivalUs = 0;
+        uint64_t seq = 0;
+    };
+
+    struct Worker {
+        std::thread thread;
+        AVCodecContext* ctx = nullptr;
+        AVFrame* frame = nullptr;
+        AVPacket* pkt = nullptr;
+        SwsContext* sws = nullptr;       // decoded -> output (RGBA or NV12)
+        SwsContext* swsRgba = nullptr;   // decoded -> RGBA for the frame queue (yuv)
+        int swsFormat = -1;
+        std::vector<unsigned char> out, outUV, rgba;
+    };
+
+    void workerLoop(Worker* w) {
+        for (;;) {
+            Slot* slot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return !running_ || !pending_.empty(); });
+                if (!running_) return;
+                slot = pending_.front();
+                pending_.pop_front();
+            }
+
+            const bool ok = decode(*w, *slot);
+
+            // Publish in capture order. Only this worker can move nextPublish_
+            // on from here, so the copy itself runs unlocked.
+            std::unique_lock<std::mutex> lock(mutex_);
+            publishCv_.wait(lock, [&] { return !running_ || nextPublish_ == slot->seq; });
+            if (!running_) return;
+            lock.unlock();
+            if (ok) {
+                publishFrame(owner_, yuv_ ? nullptr : w->out.data(),
+                             yuv_ ? w->out.data() : nullptr,
+                             yuv_ ? w->outUV.data() : nullptr, slot->arrivalUs);
+                if (yuv_ && !w->rgba.empty()) {
+                    publishFrame(owner_, w->rgba.data(), nullptr, nullptr, slot->arrivalUs);
+                }
+            }
+            lock.lock();
+            ++nextPublish_;
+            freeSlots_.push_back(slot);
+            lock.unlock();
+            publishCv_.notify_all();
+        }
+    }
+
+    // yuvj4xxp is the same layout as yuv4xxp, flagged as full range
+    static AVPixelFormat unJpeg(AVPixelFormat f, bool& fullRange) {
+        fullRange = true;
+        switch (f) {
+            case AV_PIX_FMT_YUVJ420P: return AV_PIX_FMT_YUV420P;
+            case AV_PIX_FMT_YUVJ422P: return AV_PIX_FMT_YUV422P;
+            case AV_PIX_FMT_YUVJ444P: return AV_PIX_FMT_YUV444P;
+            case AV_PIX_FMT_YUVJ440P: return AV_PIX_FMT_YUV440P;
+            default: fullRange = false; return f;
+        }
+    }
+
+    static SwsContext* makeSws(int w, int h, AVPixelFormat src, bool srcFull, AVPixelFormat dst) {
+        SwsContext* sws = sws_getContext(w, h, src, w, h, dst, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (sws) {
+            // JPEG is full range; the NV12 shader expects limited range
+            const int* coeffs = sws_getCoefficients(SWS_CS_ITU601);
+            sws_setColorspaceDetails(sws, coeffs, srcFull ? 1 : 0, coeffs,
+                                     dst == AV_PIX_FMT_RGBA ? 1 : 0, 0, 1 << 16, 1 << 16);
+        }
+        return sws;
+    }
+
+    bool decode(Worker& w, Slot& slot) {
+        w.pkt->data = slot.data.data();
+        w.pkt->size = (int)slot.size;
+        if (avcodec_send_packet(w.ctx, w.pkt) < 0) return false;
+        if (avcodec_receive_frame(w.ctx, w.frame) < 0) return false;
+
+        AVFrame* f = w.frame;
+        bool ok = f->width == width_ && f->height == height_;
+        if (ok && f->format != w.swsFormat) {
+            if (w.sws) sws_freeContext(w.sws);
+            if (w.swsRgba) sws_freeContext(w.swsRgba);
+            w.sws = w.swsRgba = nullptr;
+            bool full = false;
+            const AVPixelFormat src = unJpeg((AVPixelFormat)f->format, full);
+            full = full || f->color_range == AVCOL_RANGE_JPEG;
+            w.sws = makeSws(width_, height_, src, full, yuv_ ? AV_PIX_FMT_NV12 : AV_PIX_FMT_RGBA);
+            if (yuv_) w.swsRgba = makeSws(width_, height_, src, full, AV_PIX_FMT_RGBA);
+            w.swsFormat = f->format;
+            if (w.sws) {
+                logVerbose("VideoGrabber") << "MJPEG decodes to "
+                                           << av_get_pix_fmt_name((AVPixelFormat)f->format);
+            }
+        }
+        ok = ok && w.sws;
+        if (ok) {
+            if (yuv_) {
+                // NV12 chroma rounds up: an odd size has a half-covered
+                // last column / row of UV pairs.
+                const int uvWidth = (width_ + 1) / 2, uvHeight = (height_ + 1) / 2;
+                w.out.resize((size_t)width_ * height_);
+                w.outUV.resize((size_t)uvWidth * uvHeight * 2);
+                uint8_t* dst[4] = { w.out.data(), w.outUV.data(), nullptr, nullptr };
+                int stride[4] = { width_, uvWidth * 2, 0, 0 };
+                sws_scale(w.sws, f->data, f->linesize, 0, height_, dst, stride);
+
+                if (queueRgba_.load(std::memory_order_relaxed) && w.swsRgba) {
+                    w.rgba.resize((size_t)width_ * height_ * 4);
+                    uint8_t* rgbaDst[4] = { w.rgba.data(), nullptr, nullptr, nullptr };
+                    int rgbaStride[4] = { width_ * 4, 0, 0, 0 };
+                    sws_scale(w.swsRgba, f->data, f->linesize, 0, height_, rgbaDst, rgbaStride);
+                } else {
+                    w.rgba.clear();
+                }
+            } else {
+                w.out.resize((size_t)width_ * height_ * 4);
+                uint8_t* dst[4] = { w.out.data(), nullptr, nullptr, nullptr };
+                int stride[4] = { width_ * 4, 0, 0, 0 };
+                sws_scale(w.sws, f->data, f->linesize, 0, height_, dst, stride);
+            }
+        }
+        av_frame_unref(f);
+        return ok;
+    }
+
+    VideoGrabberPlatformData* owner_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    bool yuv_ = false;
+    std::atomic<bool> queueRgba_{false};
+
+    std::vector<Worker> workers_;
+    std::vector<Slot> slots_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;         // pending_ / running_
+    std::condition_variable publishCv_;  // nextPublish_
+    bool running_ = false;
+    std::vector<Slot*> freeSlots_;
+    std::deque<Slot*> pending_;
+    uint64_t nextSeq_ = 0;
+    uint64_t nextPublish_ = 0;
+    uint64_t dropped_ = 0;
+};
+
 // =============================================================================
 // Platform data structure
 // =============================================================================
@@ -58,8 +323,18 @@ struct VideoGrabberPlatformData {
     // Format info
     uint32_t pixelFormat = 0;
 
+    // YUV output: Y + interleaved UV planes (uvWidth x uvHeight pairs)
+    bool yuv = false;
+    int uvWidth = 0;
+    int uvHeight = 0;
+
+    // MJPEG decode threads (MJPEG format only)
+    std::unique_ptr<MjpegDecoder> mjpeg;
+
     // Pointer to VideoGrabber members
     unsigned char* targetPixels = nullptr;
+    unsigned char* targetY = nullptr;
+    unsigned char* targetUV = nullptr;
     std::atomic<bool>* pixelsDirty = nullptr;
     std::mutex* mutex = nullptr;
 
@@ -79,59 +354,37 @@ static int xioctl(int fd, unsigned long request, void* arg) {
     return r;
 }
 
-// Convert YUYV (YUV422) to RGBA
-static void convertYUYVtoRGBA(const unsigned char* src, unsigned char* dst, int width, int height) {
-    for (int i = 0; i < width * height; i += 2) {
-        int y0 = src[0];
-        int u  = src[1];
-        int y1 = src[2];
-        int v  = src[3];
-        src += 4;
-
-        // YUV to RGB conversion
-        int c = y0 - 16;
-        int d = u - 128;
-        int e = v - 128;
-
-        int r = (298 * c + 409 * e + 128) >> 8;
-        int g = (298 * c - 100 * d - 208 * e + 128) >> 8;
-        int b = (298 * c + 516 * d + 128) >> 8;
-
-        dst[0] = (r < 0) ? 0 : (r > 255) ? 255 : r;
-        dst[1] = (g < 0) ? 0 : (g > 255) ? 255 : g;
-        dst[2] = (b < 0) ? 0 : (b > 255) ? 255 : b;
-        dst[3] = 255;
-        dst += 4;
-
-        c = y1 - 16;
-        r = (298 * c + 409 * e + 128) >> 8;
-        g = (298 * c - 100 * d - 208 * e + 128) >> 8;
-        b = (298 * c + 516 * d + 128) >> 8;
-
-        dst[0] = (r < 0) ? 0 : (r > 255) ? 255 : r;
-        dst[1] = (g < 0) ? 0 : (g > 255) ? 255 : g;
-        dst[2] = (b < 0) ? 0 : (b > 255) ? 255 : b;
-        dst[3] = 255;
-        dst += 4;
+// Hand a finished frame to the grabber: the latest-frame buffer (RGBA, or
+// the Y / UV planes in YUV mode) and the timestamped frame queue (RGBA).
+// Called from the capture thread (YUYV) or an MJPEG worker.
+static void publishFrame(VideoGrabberPlatformData* data, const unsigned char* rgba,
+                         const unsigned char* y, const unsigned char* uv, uint64_t arrivalUs) {
+    const size_t pixels = (size_t)data->bufferWidth * data->bufferHeight;
+    if (data->mutex) {
+        std::lock_guard<std::mutex> lock(*data->mutex);
+        if (data->yuv) {
+            if (y && uv && data->targetY && data->targetUV) {
+                memcpy(data->targetY, y, pixels);
+                memcpy(data->targetUV, uv, (size_t)data->uvWidth * data->uvHeight * 2);
+            }
+        } else if (rgba && data->targetPixels) {
+            memcpy(data->targetPixels, rgba, pixels * 4);
+        }
     }
-}
-
-// Decode MJPEG to RGBA using stb_image
-static bool decodeMJPEGtoRGBA(const unsigned char* src, size_t srcSize,
-                               unsigned char* dst, int width, int height) {
-    int w, h, channels;
-    unsigned char* decoded = stbi_load_from_memory(src, srcSize, &w, &h, &channels, 4);
 
-    if (!decoded) {
-        return false;
+    if (data->pixelsDirty && (data->yuv ? y != nullptr : rgba != nullptr)) {
+        data->pixelsDirty->store(true);
     }
 
-    if (w == width && h == height) {
-        memcpy(dst, decoded, width * height * 4);
+    // Timestamped frame queue (no-op unless enabled)
+    if (data->frameQueue && rgba) {
+        data->frameQueue->push(rgba, data->bufferWidth, data->bufferHeight, arrivalUs);
     }
+}
 
-    stbi_image_free(decoded);
-    return true;
+// Whether the frame queue wants RGBA frames
+static bool frameQueueEnabled(const VideoGrabberPlatformData* data) {
+    return data->frameQueue && data->frameQueue->maxFrames.load(std::memory_order_relaxed) > 0;
 }
 
 // =============================================================================
@@ -174,32 +427,27 @@ static void captureThreadFunc(VideoGrabberPlatformData* data) {
         uint64_t arrivalUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
             std::chrono::steady_clock::now().time_since_epoch()).count();
 
-        // Convert frame to RGBA
-        if (data->backBuffer && buf.index < data->bufferCount) {
+        if (buf.index < data->bufferCount) {
             const unsigned char* src = (const unsigned char*)data->buffers[buf.index].start;
-
-            if (data->pixelFormat == V4L2_PIX_FMT_YUYV) {
-                convertYUYVtoRGBA(src, data->backBuffer, data->bufferWidth, data->bufferHeight);
-            } else if (data->pixelFormat == V4L2_PIX_FMT_MJPEG) {
-                decodeMJPEGtoRGBA(src, buf.bytesused, data->backBuffer,
-                                  data->bufferWidth, data->bufferHeight);
-            }
-
-            // Copy to target buffer
-            if (data->targetPixels && data->mutex) {
-                std::lock_guard<std::mutex> lock(*data->mutex);
-                memcpy(data->targetPixels, data->backBuffer,
-                       data->bufferWidth * data->bufferHeight * 4);
-            }
-
-            if (data->pixelsDirty) {
-                data->pixelsDirty->store(true);
-            }
-
-            // Timestamped frame queue (no-op unless enabled)
-            if (data->frameQueue) {
-                data->frameQueue->push(data->backBuffer, data->bufferWidth,
-                                       data->bufferHeight, arrivalUs);
+            const size_t pixels = (size_t)data->bufferWidth * data->bufferHeight;
+
+            if (data->pixelFormat == V4L2_PIX_FMT_MJPEG) {
+                // Decoded and published by the MJPEG workers
+                data->mjpeg->setQueueRgba(data->yuv && frameQueueEnabled(data));
+                data->mjpeg->submit(src, buf.bytesused, arrivalUs);
+            } else if (data->pixelFormat == V4L2_PIX_FMT_YUYV && data->yuv) {
+                unsigned char* y = data->backBuffer;
+                unsigned char* uv = data->backBuffer + pixels;
+                pixelconv::yuyvToPlanes(src, y, uv, pixels);
+                publishFrame(data, nullptr, y, uv, arrivalUs);
+                if (frameQueueEnabled(data)) {
+                    unsigned char* rgba = data->backBuffer + pixels * 2;
+                    pixelconv::yuyvToRgba(src, rgba, pixels);
+                    publishFrame(data, rgba, nullptr, nullptr, arrivalUs);
+                }
+            } else if (data->pixelFormat == V4L2_PIX_FMT_YUYV) {
+                pixelconv::yuyvToRgba(src, data->backBuffer, pixels);
+                publishFrame(data, data->backBuffer, nullptr, nullptr, arrivalUs);
             }
         }
 
@@ -279,6 +527,27 @@ bool VideoGrabber::setupPlatform() {
     logNotice("VideoGrabber") << "Format: " << width_ << "x" << height_
                                 << " (" << (char*)&data->pixelFormat << ")";
 
+    // YUV output: YUYV keeps its 4:2:2 chroma, MJPEG goes through NV12
+    data->yuv = yuvOutput_;
+    if (data->yuv) {
+        data->uvWidth = (width_ + 1) / 2;   // as MjpegDecoder sizes its NV12 output
+        data->uvHeight = data->pixelFormat == V4L2_PIX_FMT_YUYV ? height_ : (height_ + 1) / 2;
+    }
+
+    if (data->pixelFormat == V4L2_PIX_FMT_MJPEG) {
+        // Half the cores (the app and the capture thread need the rest),
+        // at most 4: that already covers 1080p60 on a modest CPU.
+        const int cores = (int)std::thread::hardware_concurrency();
+        const int threads = std::clamp(cores / 2, 1, 4);
+        data->mjpeg = std::make_unique<MjpegDecoder>();
+        if (!data->mjpeg->start(data, width_, height_, data->yuv, threads)) {
+            ::close(data->fd);
+            delete data;
+            platformHandle_ = nullptr;
+            return false;
+        }
+    }
+
     // Set frame rate if specified
     if (desiredFrameRate_ > 0) {
         struct v4l2_streamparm parm = {};
@@ -342,8 +611,11 @@ bool VideoGrabber::setupPlatform() {
         }
     }
 
-    // Allocate back buffer
-    data->backBuffer = new unsigned char[width_ * height_ * 4];
+    // Allocate back buffer (YUYV only; MJPEG workers have their own).
+    // YUV mode: Y + UV planes, then RGBA for the frame queue.
+    if (data->pixelFormat == V4L2_PIX_FMT_YUYV) {
+        data->backBuffer = new unsigned char[(size_t)width_ * height_ * (data->yuv ? 6 : 4)];
+    }
 
     // Queue buffers
     for (unsigned int i = 0; i < data->bufferCount; i++) {
@@ -373,6 +645,15 @@ bool VideoGrabber::setupPlatform() {
         return false;
     }
 
+    yuvMode_ = data->yuv;
+    uvWidth_ = data->uvWidth;
+    uvHeight_ = data->uvHeight;
+    if (yuvMode_) {
+        auto* shader = new internal::YuvVideoShader();
+        shader->loadShader(false);  // NV12 layout (UV interleaved)
+        yuvShaderHandle_ = shader;
+    }
+
     // Start capture thread
     data->running = true;
     data->captureThread = std::thread(captureThreadFunc, data);
@@ -386,11 +667,24 @@ void VideoGrabber::closePlatform() {
 
     auto data = static_cast<VideoGrabberPlatformData*>(platformHandle_);
 
-    // Stop capture thread
+    // Stop capture thread, then the MJPEG workers it feeds
     data->running = false;
     if (data->captureThread.joinable()) {
         data->captureThread.join();
     }
+    if (data->mjpeg) {
+        const uint64_t dropped = data->mjpeg->getDropped();
+        if (dropped > 0) {
+            logNotice("VideoGrabber") << "MJPEG decoders were behind: " << dropped
+                                      << " camera frames dropped";
+        }
+    }
+    data->mjpeg.reset();
+
+    if (yuvShaderHandle_) {
+        delete static_cast<internal::YuvVideoShader*>(yuvShaderHandle_);
+        yuvShaderHandle_ = nullptr;
+    }
 
     // Stop streaming
     if (data->fd != -1) {
@@ -426,16 +720,28 @@ void VideoGrabber::updatePlatform() {
     // Nothing special needed - capture thread handles everything
 }
 
+uint64_t VideoGrabber::getDroppedFramesPlatform() const {
+    auto data = static_cast<const VideoGrabberPlatformData*>(platformHandle_);
+    return data && data->mjpeg ? data->mjpeg->getDropped() : 0;
+}
+
 void VideoGrabber::updateDelegatePixels() {
     if (!platformHandle_) return;
 
     auto data = static_cast<VideoGrabberPlatformData*>(platformHandle_);
     data->targetPixels = pixels_;
+    data->targetY = pixelsY_;
+    data->targetUV = pixelsUV_;
     data->pixelsDirty = &pixelsDirty_;
     data->mutex = &mutex_;
     data->frameQueue = frameQueue_.get();
 }
 
+void VideoGrabber::drawYuvPlatform(float x, float y, float w, float h) const {
+    static_cast<internal::YuvVideoShader*>(yuvShaderHandle_)->draw(x, y, w, h, textureY_, textureUV_,
+                                                                   nullptr);
+}
+
 std::vector<VideoDeviceInfo> VideoGrabber::listDevicesPlatform() {
     std::vector<VideoDeviceInfo> devices;
 
@@ -2,12 +2,21 @@
 // tcVideoPlayer_linux.cpp - Linux VideoPlayer implementation using FFmpeg
 // =============================================================================
 // Uses libavcodec/libavformat for video decoding.
-// Frames are converted to RGBA and uploaded to sokol_gfx texture.
+// 4:2:0 frames (NV12 / P010 from HW decode, YUV420P from SW decode) are
+// copied plane by plane and converted to RGB by a shader at draw; anything
+// else is converted to RGBA with sws_scale and uploaded to a sokol_gfx texture.
+// Seeks go through a keyframe / PTS index (tcVideoSeekIndex.h) built on a
+// background thread and cached in a sidecar file. Players in a VideoGroup
+// follow the group's clock and share a VideoDecodePool instead of running a
+// decode thread each.
 // =============================================================================
 
 #ifdef __linux__
 
 #include "TrussC.h"
+#include "tc/video/tcVideoFrameQueue.h"
+#include "tc/video/tcVideoSeekIndex.h"
+#include "tc/video/tcYuvVideoShader.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -22,7 +31,10 @@ extern "C" {
 
 #include <thread>
 #include <atomic>
-#include <queue>
+#include <deque>
+#include <optional>
+#include <cmath>
+#include <limits>
 #include <condition_variable>
 
 using namespace trussc;
@@ -51,6 +63,8 @@ static AVHWDeviceType tryCreateHwDevice(AVBufferRef** outCtx) {
     return AV_HWDEVICE_TYPE_NONE;
 }
 
+class VideoDecodePool;
+
 // =============================================================================
 // TCVideoPlayerImpl - Linux implementation using FFmpeg
 // =============================================================================
@@ -83,6 +97,36 @@ public:
     void nextFrame();
     void previousFrame();
 
+    // VideoGroup support. In a pool the player has no decode thread of its
+    // own: the pool's workers call decodeStep() whenever wantsDecode(),
+    // most urgent decodeDeadline() first.
+    void attachPool(VideoDecodePool* pool);
+    bool wantsDecode() const {
+        return seekRequested_ ||
+               (isPlaying_ && !isPaused_ && !isFinished_ && queued_ < VideoFrameQueue::MAX_QUEUE_SIZE);
+    }
+    double decodeDeadline() const {
+        return seekRequested_ ? -std::numeric_limits<double>::infinity() : lastQueuedPts_.load();
+    }
+    void decodeStep();
+
+    // Group clock (NaN = the player's own clock): `clock` drives the audio
+    // and resync, update() shows the newest frame at or before `present`.
+    void setGroupClock(double clock, double present) {
+        groupClock_ = clock;
+        groupPresent_ = present;
+    }
+    // Newest frame time at or before `t` that update() could show now
+    // (queued or on screen); -inf before the first frame.
+    double newestFrameAt(double t);
+    double frameDuration() const { return frameRate_ > 0 ? 1.0 / frameRate_ : 1.0 / 30.0; }
+
+    // Scrub mode: see VideoPlayer::setScrubMode(). Applied at the next seek.
+    void setScrubMode(bool on, int cacheFrames) {
+        scrubCacheFrames_ = on ? std::max(cacheFrames, 0) : 0;
+        scrubMode_ = on;
+    }
+
     int getWidth() const { return width_; }
     int getHeight() const { return height_; }
 
@@ -106,7 +150,12 @@ private:
     bool loadAudioForPlayback();
     void decodeThread();
     bool decodeNextFrame();
+    bool receiveFrame();
     void seekToTime(double seconds);
+    void seekTo(double seconds);
+    void notifyDecoder();
+    void clearQueue();
+    void buildSeekIndex(std::string path, int streamIndex);
     void probeHwOutputFormat();
 
     // FFmpeg context
@@ -114,7 +163,6 @@ private:
     AVCodecContext* codecCtx_ = nullptr;
     SwsContext* swsCtx_ = nullptr;
     AVFrame* frame_ = nullptr;
-    AVFrame* frameRGBA_ = nullptr;
     AVPacket* packet_ = nullptr;
     // Set when packet_ holds a referenced packet that avcodec_send_packet
     // returned EAGAIN on. The packet must be re-sent (not re-read) after the
@@ -164,43 +212,247 @@ private:
     std::thread decodeThread_;
     std::mutex mutex_;
     std::condition_variable cv_;
+    VideoDecodePool* pool_ = nullptr;   // set while in a VideoGroup
+    std::atomic<double> groupClock_{std::numeric_limits<double>::quiet_NaN()};
+    std::atomic<double> groupPresent_{0.0};
 
-    // Frame queue
-    struct FrameData {
-        std::vector<uint8_t> pixels;    // RGBA, or NV12 Y-plane when isNV12
-        std::vector<uint8_t> pixelsUV;  // NV12 UV-plane (empty when !isNV12)
-        bool isNV12 = false;
-        double pts;
-    };
-    std::queue<FrameData> frameQueue_;
-    static constexpr size_t MAX_QUEUE_SIZE = 4;
+public:
+    using Planes = VideoFrameQueue::Planes;
+    using FrameData = VideoFrameQueue::Frame;
+
+    // The frame on screen. update() moves the due frame there from the
+    // queue (the one it replaces goes back to the pool) and the player's
+    // pixel pointers alias it until the next new frame, so nothing is
+    // copied between the decode thread and the texture upload.
+    FrameData& shownFrame() { return frames_.shown(); }
+
+    // Set the layout chosen at load (planarLayout()), then allocate the
+    // shown frame with neutral content and warm the pool, so playback
+    // doesn't allocate from the first frame on.
+    void primeFrames(Planes planes) {
+        frames_.setLayout(width_, height_, planes);
+        frames_.prime();
+    }
+    Planes getPlanes() const { return frames_.getLayout(); }
+
+private:
+    // Frame queue and shown frame, under mutex_. Frame storage is borrowed
+    // from the player's PixelsPool (see VideoFrameQueue).
+    VideoFrameQueue frames_;
+    std::atomic<size_t> queued_{0};           // frames_.size(), readable without mutex_
+    std::atomic<double> lastQueuedPts_{0.0};  // pts of the newest queued frame
 
     // Timing
     double currentPts_ = 0.0;
     double playbackStartTime_ = 0.0;
     double pausedTime_ = 0.0;
 
-    // Pixel buffer
-    uint8_t* rgbaBuffer_ = nullptr;
-    int rgbaBufferSize_ = 0;
+    // Seeking. seekIndex_ is filled by indexThread_ and read by the decode
+    // thread once indexReady_ is set; until then seeks fall back to a plain
+    // demuxer seek. scrubCache_ belongs to the decode thread.
+    struct SeekPlan {
+        int64_t keyTs;    // keyframe decoding starts from
+        int64_t frameTs;  // first frame at or after this is the one to show
+    };
+    VideoSeekIndex seekIndex_;
+    std::atomic<bool> indexReady_{false};
+    std::atomic<bool> indexCancel_{false};
+    std::thread indexThread_;
+    VideoFrameCache<FrameData> scrubCache_;
+    std::atomic<bool> scrubMode_{false};
+    std::atomic<int> scrubCacheFrames_{0};
+    // After a seek answered from scrubCache_ the decoder is still where it
+    // was; the position it has to move to before playback decodes on.
+    std::optional<SeekPlan> deferredSeek_;
+
+    SeekPlan planSeek(double seconds) const;
+    void decodeTo(const SeekPlan& plan, bool preview);
+    void pushFrame(FrameData&& data);
+
+    bool convertFrame(FrameData& data);
+    bool copyPlanes(const AVFrame* src, FrameData& data);
+    void takeFrame(VideoPlayer* player);
 
 public:
-    bool nv12Mode_ = false;  // set by loadPlatform() when HW decode produces NV12
-    // Runtime check: HW backend is active AND the first probed frame came
-    // out as NV12 after hwframe_transfer. Different backends / codecs /
-    // bit-depths can produce P010, YUV420P, etc. — those fall back to RGBA.
-    bool isNV12Capable() const {
-        return hwType_ != AV_HWDEVICE_TYPE_NONE
-            && probedFormat_ == AV_PIX_FMT_NV12;
+
+    // Plane layout the decode thread can hand over without sws_scale. The
+    // format frames arrive in is the probed post-transfer format for HW
+    // decode (NV12 on most backends, P010 for 10-bit, YUV420P on some
+    // V4L2M2M) and the codec's own format for SW decode. Both shaders do
+    // BT.601 limited range, so full-range YUVJ420P stays on RGBA, as does
+    // anything else (4:2:2, 4:4:4, 10-bit SW output, odd sizes).
+    Planes planarLayout() const {
+        if (!codecCtx_ || width_ % 2 != 0 || height_ % 2 != 0) return Planes::RGBA;
+        const AVPixelFormat fmt = hwType_ != AV_HWDEVICE_TYPE_NONE ? probedFormat_
+                                                                   : codecCtx_->pix_fmt;
+        switch (fmt) {
+            case AV_PIX_FMT_NV12:
+            case AV_PIX_FMT_P010:
+                return Planes::NV12;
+            case AV_PIX_FMT_YUV420P:
+                return codecCtx_->color_range == AVCOL_RANGE_JPEG ? Planes::RGBA : Planes::I420;
+            default:
+                return Planes::RGBA;
+        }
     }
 };
 
+// =============================================================================
+// VideoDecodePool - decode workers shared by the players of a VideoGroup
+// =============================================================================
+// A wall of N players with a thread each oversubscribes the cores and lets
+// the scheduler decide which stream falls behind. The pool runs a fixed
+// number of workers; each takes the member whose queue ends earliest
+// (earliest deadline first, seeks before everything), so the stream closest
+// to running dry is always decoded next. A member is stepped by one worker
+// at a time. The pool never takes a player's mutex_, only reads its atomics.
+class VideoDecodePool {
+public:
+    explicit VideoDecodePool(int threads) {
+        threads = std::max(threads, 1);
+        for (int i = 0; i < threads; ++i) {
+            workers_.emplace_back(&VideoDecodePool::run, this);
+        }
+    }
+
+    ~VideoDecodePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    int getThreadCount() const { return (int)workers_.size(); }
+
+    void add(TCVideoPlayerImpl* impl) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            members_.push_back({impl, false});
+        }
+        cv_.notify_all();
+    }
+
+    // Returns once no worker is inside impl->decodeStep().
+    void remove(TCVideoPlayerImpl* impl) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] {
+            for (const auto& m : members_) {
+                if (m.impl == impl) return !m.busy;
+            }
+            return true;
+        });
+        members_.erase(std::remove_if(members_.begin(), members_.end(),
+                                      [&](const Member& m) { return m.impl == impl; }),
+                       members_.end());
+    }
+
+    // A member may have work now. Every change that can make wantsDecode()
+    // true ends here through notifyDecoder(): play / resume, a seek request,
+    // update() taking frames off the queue. Changes made by decodeStep()
+    // itself (a seek landing) are seen by the worker's next pass.
+    void wake() {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_all();
+    }
+
+private:
+    struct Member {
+        TCVideoPlayerImpl* impl;
+        bool busy;
+    };
+
+    Member* next() {
+        Member* best = nullptr;
+        double bestDeadline = 0.0;
+        for (auto& m : members_) {
+            if (m.busy || !m.impl->wantsDecode()) continue;
+            const double d = m.impl->decodeDeadline();
+            if (!best || d < bestDeadline) {
+                best = &m;
+                bestDeadline = d;
+            }
+        }
+        return best;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            Member* m = next();
+            if (!m) {
+                cv_.wait(lock);   // until wake(), add() or a member is released
+                continue;
+            }
+            TCVideoPlayerImpl* impl = m->impl;
+            m->busy = true;
+            lock.unlock();
+            impl->decodeStep();
+            lock.lock();
+            // members_ may have grown (and moved) meanwhile
+            for (auto& other : members_) {
+                if (other.impl == impl) other.busy = false;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::vector<Member> members_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+void TCVideoPlayerImpl::attachPool(VideoDecodePool* pool) {
+    if (pool == pool_) return;
+    if (pool_) {
+        pool_->remove(this);
+        pool_ = nullptr;
+    }
+    if (pool) {
+        // Hand decoding over: the own thread must be gone before the pool
+        // starts calling decodeStep().
+        shouldStop_ = true;
+        cv_.notify_all();
+        if (decodeThread_.joinable()) decodeThread_.join();
+        shouldStop_ = false;
+        pool_ = pool;
+        pool_->add(this);
+    } else if (isLoaded_ && (isPlaying_ || seekRequested_) && !decodeThread_.joinable()) {
+        shouldStop_ = false;
+        decodeThread_ = std::thread(&TCVideoPlayerImpl::decodeThread, this);
+    }
+}
+
+void TCVideoPlayerImpl::notifyDecoder() {
+    cv_.notify_all();
+    if (pool_) pool_->wake();
+}
+
+double TCVideoPlayerImpl::newestFrameAt(double t) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The frame on screen counts only if it is not past `t`: after a seek
+    // back (a group loop) it is the old position until the seek lands.
+    const FrameData& shown = frames_.shown();
+    double newest = frames_.hasShownFrame() && !shown.preview && shown.pts <= t
+                  ? shown.pts : -std::numeric_limits<double>::infinity();
+    for (const auto& f : frames_.queued()) {
+        if (f.pts > t) break;
+        if (!f.preview) newest = f.pts;
+    }
+    return newest;
+}
+
 // =============================================================================
 // Implementation
 // =============================================================================
 
 bool TCVideoPlayerImpl::load(const std::string& path, VideoPlayer* player) {
     filePath_ = path;
+    frames_.setPool(player ? internal::VideoPlayerPlatformAccess::getFramePool(*player)
+                           : PixelsPool::shared());
 
     // Open file
     if (avformat_open_input(&formatCtx_, path.c_str(), nullptr, nullptr) < 0) {
@@ -351,25 +603,14 @@ bool TCVideoPlayerImpl::load(const std::string& path, VideoPlayer* player) {
 
     // Allocate frames
     frame_ = av_frame_alloc();
-    frameRGBA_ = av_frame_alloc();
     packet_ = av_packet_alloc();
 
-    if (!frame_ || !frameRGBA_ || !packet_) {
+    if (!frame_ || !packet_) {
         logError("VideoPlayer") << "Failed to allocate frames";
         close();
         return false;
     }
 
-    // Allocate RGBA buffer
-    rgbaBufferSize_ = av_image_get_buffer_size(AV_PIX_FMT_RGBA, width_, height_, 1);
-    rgbaBuffer_ = (uint8_t*)av_malloc(rgbaBufferSize_);
-
-    av_image_fill_arrays(
-        frameRGBA_->data, frameRGBA_->linesize,
-        rgbaBuffer_, AV_PIX_FMT_RGBA,
-        width_, height_, 1
-    );
-
     isLoaded_ = true;
 
     // Pre-decode audio for playback using FFmpeg (audio stream only)
@@ -382,13 +623,25 @@ bool TCVideoPlayerImpl::load(const std::string& path, VideoPlayer* player) {
     }
 
     // Probe the first decoded frame so callers can see the post-transfer
-    // pixel format and pick NV12 fast path vs RGBA fallback accurately.
+    // pixel format and pick the planar fast path vs RGBA fallback accurately.
     probeHwOutputFormat();
 
+    // Keyframe index for seeking, off the load path (seeks before it is
+    // ready use a plain demuxer seek).
+    indexCancel_ = false;
+    indexThread_ = std::thread(&TCVideoPlayerImpl::buildSeekIndex, this, path, videoStreamIndex_);
+
     return true;
 }
 
 void TCVideoPlayerImpl::close() {
+    // Leave the group's decode pool (waits for a step in progress)
+    if (pool_) {
+        pool_->remove(this);
+        pool_ = nullptr;
+    }
+    groupClock_ = std::numeric_limits<double>::quiet_NaN();
+
     // Stop decode thread
     shouldStop_ = true;
     cv_.notify_all();
@@ -397,12 +650,19 @@ void TCVideoPlayerImpl::close() {
         decodeThread_.join();
     }
 
-    // Clear frame queue
+    indexCancel_ = true;
+    if (indexThread_.joinable()) {
+        indexThread_.join();
+    }
+    indexReady_ = false;
+    seekIndex_.clear();
+    scrubCache_.clear();
+    deferredSeek_.reset();
+
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        while (!frameQueue_.empty()) {
-            frameQueue_.pop();
-        }
+        frames_.reset();
+        queued_ = 0;
     }
 
     // Free FFmpeg resources
@@ -413,21 +673,11 @@ void TCVideoPlayerImpl::close() {
     hwType_        = AV_HWDEVICE_TYPE_NONE;
     lastScalerFmt_ = AV_PIX_FMT_NONE;
 
-    if (rgbaBuffer_) {
-        av_free(rgbaBuffer_);
-        rgbaBuffer_ = nullptr;
-    }
-
     if (packet_) {
         av_packet_free(&packet_);
         packet_ = nullptr;
     }
 
-    if (frameRGBA_) {
-        av_frame_free(&frameRGBA_);
-        frameRGBA_ = nullptr;
-    }
-
     if (frame_) {
         av_frame_free(&frame_);
         frame_ = nullptr;
@@ -477,15 +727,15 @@ void TCVideoPlayerImpl::play() {
         seekToTime(0.0);
     }
 
-    // Start decode thread if not running
-    if (!decodeThread_.joinable()) {
+    // Start decode thread if not running (a pool decodes grouped players)
+    if (!pool_ && !decodeThread_.joinable()) {
         decodeThread_ = std::thread(&TCVideoPlayerImpl::decodeThread, this);
     }
 
     playbackStartTime_ = av_gettime_relative() / 1000000.0 - currentPts_;
     isPlaying_ = true;
     isPaused_ = false;
-    cv_.notify_all();
+    notifyDecoder();
 
     if (audioBuffer_) {
         audioSound_.play();
@@ -504,13 +754,7 @@ void TCVideoPlayerImpl::stop() {
     seekToTime(0.0);
     currentPts_ = 0.0;
 
-    // Clear frame queue
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        while (!frameQueue_.empty()) {
-            frameQueue_.pop();
-        }
-    }
+    clearQueue();
 }
 
 void TCVideoPlayerImpl::setPaused(bool paused) {
@@ -523,7 +767,7 @@ void TCVideoPlayerImpl::setPaused(bool paused) {
         double pauseDuration = av_gettime_relative() / 1000000.0 - pausedTime_;
         playbackStartTime_ += pauseDuration;
         isPaused_ = false;
-        cv_.notify_all();
+        notifyDecoder();
     }
 
     if (audioBuffer_) {
@@ -535,12 +779,27 @@ void TCVideoPlayerImpl::setPaused(bool paused) {
 void TCVideoPlayerImpl::update(VideoPlayer* player) {
     hasNewFrame_ = false;
 
-    if (!isLoaded_ || !isPlaying_ || isPaused_) return;
+    if (!isLoaded_) return;
+
+    // Stopped / paused: only frames decoded for a seek (scrubbing) show up.
+    if (!isPlaying_ || isPaused_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!frames_.empty() && frames_.front().scrub) takeFrame(player);
+        queued_ = frames_.size();
+        return;
+    }
 
-    // Target PTS: use audio as master clock when available (no drift).
-    // Fall back to wall clock for audio-less videos.
+    // Target PTS: a VideoGroup's clock when grouped, else audio as master
+    // clock when available (no drift), else the wall clock.
     double targetPts;
-    if (audioBuffer_) {
+    const double groupClock = groupClock_;
+    if (!std::isnan(groupClock)) {
+        targetPts = groupPresent_;
+        // Keep the soundtrack on the group clock
+        if (audioBuffer_ && std::abs(audioSound_.getPosition() - groupClock) > 0.1) {
+            audioSound_.setPosition(static_cast<float>(groupClock));
+        }
+    } else if (audioBuffer_) {
         targetPts = audioSound_.getPosition();
     } else {
         double elapsed = av_gettime_relative() / 1000000.0 - playbackStartTime_;
@@ -556,45 +815,18 @@ void TCVideoPlayerImpl::update(VideoPlayer* player) {
     float resyncThreshold = player ? player->getResyncThreshold() : 0.5f;
     if (resyncThreshold > 0.0f &&
         std::abs(targetPts - currentPts_) > resyncThreshold) {
-        seekToTime(targetPts);
+        seekToTime(std::isnan(groupClock) ? targetPts : groupClock);
         return;  // next update() will pick up freshly decoded frames
     }
 
     // Get frame from queue if available and PTS is right
     std::lock_guard<std::mutex> lock(mutex_);
 
-    while (!frameQueue_.empty()) {
-        FrameData& front = frameQueue_.front();
-
-        if (front.pts <= targetPts) {
-            if (player) {
-                if (front.isNV12) {
-                    unsigned char* yBuf  = player->getPixelsY();
-                    unsigned char* uvBuf = player->getPixelsUV();
-                    if (yBuf  && front.pixels.size()   == (size_t)(width_ * height_) &&
-                        uvBuf && front.pixelsUV.size() == (size_t)(width_ * height_ / 2)) {
-                        memcpy(yBuf,  front.pixels.data(),   front.pixels.size());
-                        memcpy(uvBuf, front.pixelsUV.data(), front.pixelsUV.size());
-                        hasNewFrame_ = true;
-                        currentPts_  = front.pts;
-                    }
-                } else {
-                    unsigned char* playerPixels = player->getPixels();
-                    if (playerPixels && front.pixels.size() == (size_t)(width_ * height_ * 4)) {
-                        memcpy(playerPixels, front.pixels.data(), front.pixels.size());
-                        hasNewFrame_ = true;
-                        currentPts_  = front.pts;
-                    }
-                }
-            }
-            frameQueue_.pop();
-        } else {
-            break;
-        }
-    }
+    while (!frames_.empty() && frames_.front().pts <= targetPts) takeFrame(player);
+    queued_ = frames_.size();
 
-    // Check if finished
-    if (frameQueue_.empty() && isFinished_) {
+    // Check if finished (a group loops its members together)
+    if (frames_.empty() && isFinished_ && std::isnan(groupClock)) {
         if (isLoop_) {
             if (audioBuffer_) {
                 audioSound_.setPosition(0.0f);
@@ -602,13 +834,26 @@ void TCVideoPlayerImpl::update(VideoPlayer* player) {
             seekToTime(0.0);
             playbackStartTime_ = av_gettime_relative() / 1000000.0;
             isFinished_ = false;
-            cv_.notify_all();
         } else {
             isPlaying_ = false;
         }
     }
 
-    cv_.notify_all();
+    notifyDecoder();
+}
+
+// Take the front frame by moving its buffers (just drop it without a
+// player); the player re-points its pixel pointers at the shown frame
+// (VideoPlayer::bindFramePlatform()). A scrub preview doesn't move the
+// position: that stays at the seek target. Caller holds mutex_.
+void TCVideoPlayerImpl::takeFrame(VideoPlayer* player) {
+    if (!player) {
+        frames_.pop();
+        return;
+    }
+    if (!frames_.takeFront()) return;
+    hasNewFrame_ = true;
+    if (!frames_.shown().preview) currentPts_ = frames_.shown().pts;
 }
 
 void TCVideoPlayerImpl::decodeThread() {
@@ -616,46 +861,38 @@ void TCVideoPlayerImpl::decodeThread() {
         // Wait if paused or queue is full
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] {
-                return shouldStop_ ||
-                       (isPlaying_ && !isPaused_ && frameQueue_.size() < MAX_QUEUE_SIZE) ||
-                       seekRequested_;
-            });
+            cv_.wait(lock, [this] { return shouldStop_ || wantsDecode(); });
         }
 
         if (shouldStop_) break;
+        decodeStep();
+    }
+}
 
-        // Handle seek request
-        if (seekRequested_) {
-            double target = seekTarget_;
-            seekRequested_ = false;
-
-            int64_t timestamp = (int64_t)(target / av_q2d(timeBase_));
-            av_seek_frame(formatCtx_, videoStreamIndex_, timestamp, AVSEEK_FLAG_BACKWARD);
-            avcodec_flush_buffers(codecCtx_);
-
-            // Any packet held from a previous EAGAIN is invalidated by the seek.
-            if (packetPending_) {
-                av_packet_unref(packet_);
-                packetPending_ = false;
-            }
-
-            // Clear queue
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
-                while (!frameQueue_.empty()) {
-                    frameQueue_.pop();
-                }
-            }
+// One unit of decode work: a pending seek, or the next frame. Called by the
+// player's own decode thread, or by a VideoDecodePool worker when grouped
+// (never by both: attachPool() stops the own thread first).
+void TCVideoPlayerImpl::decodeStep() {
+    // Handle seek request
+    if (seekRequested_) {
+        double target = seekTarget_;
+        seekRequested_ = false;
+        seekTo(target);
+        return;
+    }
 
-            currentPts_ = target;
-            continue;
-        }
+    // The last seek was answered from the scrub cache; put the decoder
+    // there before playback goes on from it.
+    if (deferredSeek_) {
+        SeekPlan plan = *deferredSeek_;
+        deferredSeek_.reset();
+        decodeTo(plan, false);
+        return;
+    }
 
-        // Decode next frame
-        if (!decodeNextFrame()) {
-            isFinished_ = true;
-        }
+    // Decode next frame
+    if (!decodeNextFrame()) {
+        isFinished_ = true;
     }
 }
 
@@ -721,7 +958,21 @@ void TCVideoPlayerImpl::probeHwOutputFormat() {
     }
 }
 
+// Decode and queue the next frame for playback. False at the end of the
+// stream or on a decoder error.
 bool TCVideoPlayerImpl::decodeNextFrame() {
+    while (receiveFrame()) {
+        FrameData data;
+        if (convertFrame(data)) {
+            pushFrame(std::move(data));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Pull the next decoded frame into frame_ (still on the GPU for HW decode).
+bool TCVideoPlayerImpl::receiveFrame() {
     char errbuf[128];
     while (true) {
         // Drain the decoder first. HW backends (VAAPI/NVDEC) and streams with
@@ -784,90 +1035,145 @@ bool TCVideoPlayerImpl::decodeNextFrame() {
             return false;
         }
 
-        // HW frames need to be transferred to CPU before scaling
-        AVFrame* srcFrame = frame_;
-        AVFrame* swFrame  = nullptr;
-        if (hwType_ != AV_HWDEVICE_TYPE_NONE && frame_->hw_frames_ctx) {
-            swFrame = av_frame_alloc();
-            // Use the HW backend's native format (e.g. NV12 on VAAPI) to
-            // avoid an extra pixel-format conversion during transfer. The
-            // scaler is rebuilt lazily on format change (lastScalerFmt_).
-            swFrame->format = AV_PIX_FMT_NONE;
-            if (av_hwframe_transfer_data(swFrame, frame_, 0) < 0) {
-                logWarning("VideoPlayer") << "HW frame transfer failed, dropping frame";
-                av_frame_free(&swFrame);
-                av_frame_unref(frame_);
-                continue;
-            }
-            srcFrame = swFrame;
+        return true;  // frame_ holds the next frame
+    }
+}
+
+// Transfer (HW) and convert frame_ into a pooled frame, then unref frame_.
+// False if the frame had to be dropped.
+bool TCVideoPlayerImpl::convertFrame(FrameData& data) {
+    // HW frames need to be transferred to CPU before scaling
+    AVFrame* srcFrame = frame_;
+    AVFrame* swFrame  = nullptr;
+    if (hwType_ != AV_HWDEVICE_TYPE_NONE && frame_->hw_frames_ctx) {
+        swFrame = av_frame_alloc();
+        // Use the HW backend's native format (e.g. NV12 on VAAPI) to
+        // avoid an extra pixel-format conversion during transfer. The
+        // scaler is rebuilt lazily on format change (lastScalerFmt_).
+        swFrame->format = AV_PIX_FMT_NONE;
+        if (av_hwframe_transfer_data(swFrame, frame_, 0) < 0) {
+            logWarning("VideoPlayer") << "HW frame transfer failed, dropping frame";
+            av_frame_free(&swFrame);
+            av_frame_unref(frame_);
+            return false;
         }
+        srcFrame = swFrame;
+    }
 
-        // Calculate PTS (frame_->pts before any av_frame_unref)
-        double pts = 0.0;
-        if (frame_->pts != AV_NOPTS_VALUE)
-            pts = frame_->pts * av_q2d(timeBase_);
+    // Calculate PTS (frame_->pts before any av_frame_unref)
+    data.pts = 0.0;
+    if (frame_->pts != AV_NOPTS_VALUE)
+        data.pts = frame_->pts * av_q2d(timeBase_);
 
-        // NV12 fast path: copy Y+UV planes directly, skip sws_scale entirely
-        if (nv12Mode_ && srcFrame->format == AV_PIX_FMT_NV12) {
-            FrameData data;
-            data.isNV12 = true;
-            data.pts    = pts;
-
-            data.pixels.resize(width_ * height_);
-            for (int row = 0; row < height_; ++row)
-                std::memcpy(data.pixels.data()  + row * width_,
-                            srcFrame->data[0]   + row * srcFrame->linesize[0],
-                            width_);
-
-            const int uvRows     = height_ / 2;
-            const int uvRowBytes = width_;      // (width/2 pairs) * 2 bytes = width
-            data.pixelsUV.resize(uvRows * uvRowBytes);
-            for (int row = 0; row < uvRows; ++row)
-                std::memcpy(data.pixelsUV.data() + row * uvRowBytes,
-                            srcFrame->data[1]    + row * srcFrame->linesize[1],
-                            uvRowBytes);
-
-            if (swFrame) av_frame_free(&swFrame);
-            av_frame_unref(frame_);
+    // Planar fast path: copy the planes, skip sws_scale entirely
+    if (frames_.getLayout() != Planes::RGBA && copyPlanes(srcFrame, data)) {
+        if (swFrame) av_frame_free(&swFrame);
+        av_frame_unref(frame_);
+        return true;
+    }
 
-            std::lock_guard<std::mutex> lock(mutex_);
-            frameQueue_.push(std::move(data));
-            return true;
-        }
+    // RGBA fallback: sws_scale for formats without a planar path
+    AVPixelFormat srcFmt = (AVPixelFormat)srcFrame->format;
+    if (srcFmt != lastScalerFmt_ && srcFmt != AV_PIX_FMT_NONE) {
+        if (swsCtx_) sws_freeContext(swsCtx_);
+        swsCtx_ = sws_getContext(
+            width_, height_, srcFmt,
+            width_, height_, AV_PIX_FMT_RGBA,
+            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        lastScalerFmt_ = srcFmt;
+    }
+
+    // Scale straight into the pooled frame
+    frames_.allocate(data, Planes::RGBA);
+    if (swsCtx_ && srcFrame->data[0]) {
+        uint8_t* dst[4]     = { data.pixels.getData(), nullptr, nullptr, nullptr };
+        int      dstStep[4] = { width_ * 4, 0, 0, 0 };
+        sws_scale(
+            swsCtx_,
+            srcFrame->data, srcFrame->linesize,
+            0, height_,
+            dst, dstStep);
+    } else {
+        std::memset(data.pixels.getData(), 0, data.pixels.getTotalBytes());
+    }
+    if (swFrame) av_frame_free(&swFrame);
+    av_frame_unref(frame_);
+    return true;
+}
 
-        // RGBA fallback: sws_scale for non-CUDA or non-NV12
-        AVPixelFormat srcFmt = (AVPixelFormat)srcFrame->format;
-        if (srcFmt != lastScalerFmt_ && srcFmt != AV_PIX_FMT_NONE) {
-            if (swsCtx_) sws_freeContext(swsCtx_);
-            swsCtx_ = sws_getContext(
-                width_, height_, srcFmt,
-                width_, height_, AV_PIX_FMT_RGBA,
-                SWS_BILINEAR, nullptr, nullptr, nullptr);
-            lastScalerFmt_ = srcFmt;
-        }
+void TCVideoPlayerImpl::pushFrame(FrameData&& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!data.preview) lastQueuedPts_ = data.pts;
+    frames_.push(std::move(data));
+    queued_ = frames_.size();
+}
 
-        if (swsCtx_ && srcFrame->data[0]) {
-            sws_scale(
-                swsCtx_,
-                srcFrame->data, srcFrame->linesize,
-                0, height_,
-                frameRGBA_->data, frameRGBA_->linesize);
-        }
+void TCVideoPlayerImpl::clearQueue() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_.clear();
+    queued_ = 0;
+}
 
-        if (swFrame) av_frame_free(&swFrame);
+// Copies the planes of a decoded frame into pooled Pixels for the planar
+// path chosen at load. Returns false (caller falls back to RGBA) when the
+// frame isn't in a format that path takes, e.g. after a mid-stream change.
+bool TCVideoPlayerImpl::copyPlanes(const AVFrame* src, FrameData& data) {
+    VideoFrameQueue::Source source;
+    switch ((AVPixelFormat)src->format) {
+        case AV_PIX_FMT_NV12:    source = VideoFrameQueue::Source::NV12; break;
+        case AV_PIX_FMT_P010:    source = VideoFrameQueue::Source::P010; break;
+        case AV_PIX_FMT_YUV420P: source = VideoFrameQueue::Source::YUV420P; break;
+        default: return false;
+    }
+    return frames_.copyPlanes(source, src->data, src->linesize, data);
+}
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            FrameData data;
-            data.pixels.resize(width_ * height_ * 4);
-            memcpy(data.pixels.data(), rgbaBuffer_, data.pixels.size());
-            data.pts = pts;
-            frameQueue_.push(std::move(data));
+// Runs on indexThread_: load the sidecar index, or demux the whole file on
+// a format context of its own (packets only, nothing is decoded), then
+// cache the result next to the video. Non-files (URLs) get no index.
+void TCVideoPlayerImpl::buildSeekIndex(std::string path, int streamIndex) {
+    const fs::path file(path);
+    VideoSeekIndex::Source source;
+    if (!VideoSeekIndex::Source::of(file, streamIndex, source)) return;
+
+    VideoSeekIndex index;
+    const fs::path sidecar = VideoSeekIndex::sidecarPath(file);
+    if (!index.load(sidecar, source)) {
+        AVFormatContext* fmt = nullptr;
+        if (avformat_open_input(&fmt, path.c_str(), nullptr, nullptr) < 0) return;
+        if (avformat_find_stream_info(fmt, nullptr) < 0 || streamIndex >= (int)fmt->nb_streams) {
+            avformat_close_input(&fmt);
+            return;
+        }
+        for (unsigned int i = 0; i < fmt->nb_streams; i++) {
+            if ((int)i != streamIndex) fmt->streams[i]->discard = AVDISCARD_ALL;
         }
 
-        av_frame_unref(frame_);
-        return true;
+        AVPacket* pkt = av_packet_alloc();
+        while (!indexCancel_ && av_read_frame(fmt, pkt) >= 0) {
+            if (pkt->stream_index == streamIndex && pkt->pts != AV_NOPTS_VALUE) {
+                index.add(pkt->pts, (pkt->flags & AV_PKT_FLAG_KEY) != 0);
+            }
+            av_packet_unref(pkt);
+        }
+        av_packet_free(&pkt);
+        avformat_close_input(&fmt);
+        if (indexCancel_) return;
+
+        index.finish();
+        if (index.empty()) {
+            logVerbose("VideoPlayer") << "No keyframe timestamps; seeking without an index";
+            return;
+        }
+        if (!index.save(sidecar, source)) {
+            logVerbose("VideoPlayer") << "Seek index not cached (can't write " << sidecar.string() << ")";
+        }
     }
+
+    logVerbose("VideoPlayer") << "Seek index: " << index.getFrameCount() << " frames, "
+                              << index.getKeyframeCount() << " keyframes";
+    seekIndex_ = std::move(index);
+    indexReady_ = true;
 }
 
 bool TCVideoPlayerImpl::loadAudioForPlayback() {
@@ -1061,7 +1367,109 @@ std::vector<uint8_t> TCVideoPlayerImpl::getAudioData() const {
 void TCVideoPlayerImpl::seekToTime(double seconds) {
     seekTarget_ = seconds;
     seekRequested_ = true;
-    cv_.notify_all();
+
+    // Seeks decode their frame even before play() (scrubbing a stopped or
+    // paused player), so the decode thread may have to start here.
+    if (isLoaded_ && !pool_ && !decodeThread_.joinable()) {
+        shouldStop_ = false;
+        decodeThread_ = std::thread(&TCVideoPlayerImpl::decodeThread, this);
+    }
+    notifyDecoder();
+}
+
+// Where decoding starts and which frame ends a seek to `seconds`. With the
+// index that is the keyframe before the frame on screen at `seconds` and
+// that frame itself; without it the demuxer picks the keyframe and the
+// first frame at or after `seconds` is taken.
+TCVideoPlayerImpl::SeekPlan TCVideoPlayerImpl::planSeek(double seconds) const {
+    const int64_t ts = std::llround(seconds / av_q2d(timeBase_));
+    SeekPlan plan{ts, ts};
+    if (indexReady_) {
+        const int64_t frame = seekIndex_.frameAtOrBefore(ts);
+        const int64_t key   = seekIndex_.keyframeAtOrBefore(frame);
+        if (frame != VideoSeekIndex::kNone && key != VideoSeekIndex::kNone) {
+            plan.keyTs   = key;
+            plan.frameTs = frame;
+        }
+    }
+    return plan;
+}
+
+// Runs on the decode thread. Queues the frame at `seconds` (marked scrub, so
+// update() shows it even while paused); in scrub mode the keyframe goes
+// first as a preview, and a frame decoded for an earlier seek comes straight
+// from scrubCache_ without touching the decoder.
+void TCVideoPlayerImpl::seekTo(double seconds) {
+    clearQueue();
+    currentPts_ = seconds;
+    lastQueuedPts_ = seconds;
+    isFinished_ = false;
+    scrubCache_.setCapacity(scrubMode_ ? (size_t)scrubCacheFrames_ : 0);
+
+    const SeekPlan plan = planSeek(seconds);
+    if (const FrameData* hit = scrubCache_.find(plan.frameTs)) {
+        FrameData data;
+        frames_.copyFrame(*hit, data);
+        data.scrub   = true;
+        data.preview = false;
+        pushFrame(std::move(data));
+        deferredSeek_ = plan;
+        return;
+    }
+    deferredSeek_.reset();
+    decodeTo(plan, scrubMode_);
+}
+
+// Seek the demuxer to plan.keyTs and decode forward to plan.frameTs. Frames
+// before the target are decoded but not converted. Gives up when a newer
+// seek comes in, so fast scrubbing never waits for stale targets.
+void TCVideoPlayerImpl::decodeTo(const SeekPlan& plan, bool preview) {
+    av_seek_frame(formatCtx_, videoStreamIndex_, plan.keyTs, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(codecCtx_);
+
+    // Any packet held from a previous EAGAIN is invalidated by the seek.
+    if (packetPending_) {
+        av_packet_unref(packet_);
+        packetPending_ = false;
+    }
+
+    // A keyframe still cached from an earlier seek is an instant preview.
+    bool previewed = !preview;
+    if (!previewed) {
+        if (const FrameData* hit = scrubCache_.find(plan.keyTs)) {
+            FrameData data;
+            frames_.copyFrame(*hit, data);
+            data.scrub = data.preview = true;
+            pushFrame(std::move(data));
+            previewed = true;
+        }
+    }
+
+    while (!shouldStop_ && !seekRequested_ && receiveFrame()) {
+        const int64_t pts = frame_->pts;
+        const bool before = pts != AV_NOPTS_VALUE && pts < plan.frameTs;
+        if (before && previewed) {
+            av_frame_unref(frame_);
+            continue;
+        }
+
+        FrameData data;
+        if (!convertFrame(data)) continue;
+        data.scrub = true;
+        if (scrubCache_.getCapacity() > 0) {
+            FrameData cached;
+            frames_.copyFrame(data, cached);
+            scrubCache_.put(pts, std::move(cached));
+        }
+        if (before) {
+            data.preview = true;
+            previewed = true;
+            pushFrame(std::move(data));
+            continue;
+        }
+        pushFrame(std::move(data));
+        return;
+    }
 }
 
 float TCVideoPlayerImpl::getPosition() const {
@@ -1115,7 +1523,15 @@ void TCVideoPlayerImpl::setFrame(int frame) {
     }
 }
 
+// With the index, step to the neighbouring frame's own timestamp (exact for
+// variable frame rates); otherwise by one nominal frame duration.
 void TCVideoPlayerImpl::nextFrame() {
+    if (indexReady_) {
+        const double tb = av_q2d(timeBase_);
+        const int64_t next = seekIndex_.frameAfter(std::llround(currentPts_ / tb));
+        if (next != VideoSeekIndex::kNone) seekToTime(next * tb);
+        return;
+    }
     if (frameRate_ > 0) {
         double frameTime = 1.0 / frameRate_;
         seekToTime(currentPts_ + frameTime);
@@ -1123,6 +1539,12 @@ void TCVideoPlayerImpl::nextFrame() {
 }
 
 void TCVideoPlayerImpl::previousFrame() {
+    if (indexReady_) {
+        const double tb = av_q2d(timeBase_);
+        const int64_t prev = seekIndex_.frameBefore(std::llround(currentPts_ / tb));
+        if (prev != VideoSeekIndex::kNone) seekToTime(prev * tb);
+        return;
+    }
     if (frameRate_ > 0) {
         double frameTime = 1.0 / frameRate_;
         double newTime = currentPts_ - frameTime;
@@ -1135,80 +1557,6 @@ void TCVideoPlayerImpl::previousFrame() {
 // VideoPlayer platform methods (Linux implementation)
 // =============================================================================
 
-#include "tc/gpu/shaders/videoNV12.glsl.h"
-
-// NV12 immediate-draw shader (immutable unit-quad, uniform-based positioning)
-class NV12VideoShader : public Shader {
-public:
-    void loadShader() { load(tc_video_nv12_nv12_shader_desc); }
-
-    void draw(float x, float y, float w, float h,
-              const Texture& texY, const Texture& texUV) {
-        if (!loaded) return;
-
-        ensureSwapchainPass();
-        sgl_draw();
-
-        sg_apply_pipeline(pipeline);
-
-        // x/y/w/h come in logical coordinates (same space tcApp draws in),
-        // but sapp_width()/sapp_height() are physical framebuffer pixels.
-        // Divide by DPI scale so the shader's viewport matches its inputs.
-        const float dpiScale = sapp_dpi_scale();
-        const float vpW = (float)sapp_width()  / dpiScale;
-        const float vpH = (float)sapp_height() / dpiScale;
-
-        struct VsParams { float v[8]; } p = {{
-            vpW, vpH, x, y,
-            w,   h,   0.0f, 0.0f
-        }};
-        sg_range range = { &p, sizeof(p) };
-        sg_apply_uniforms(0, &range);
-
-        sg_bindings bind = {};
-        bind.vertex_buffers[0] = vertexBuffer;
-        bind.index_buffer      = indexBuffer;
-        bind.views[0]    = texY.getView();
-        bind.samplers[0] = texY.getSampler();
-        bind.views[1]    = texUV.getView();
-        bind.samplers[1] = texUV.getSampler();
-        sg_apply_bindings(&bind);
-
-        sg_draw(0, 6, 1);
-
-        sg_reset_state_cache();
-        sgl_defaults();
-        trussc::internal::sglLoadProjection(trussc::internal::screen2DProjection(vpW, vpH));
-        sgl_matrix_mode_modelview();
-        sgl_load_identity();
-    }
-
-protected:
-    sg_pipeline_desc createPipelineDesc() override {
-        sg_pipeline_desc desc = {};
-        desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT2;
-        desc.colors[0].blend.enabled = false;
-        desc.index_type = SG_INDEXTYPE_UINT16;
-        desc.label = "tc_nv12_pipeline";
-        return desc;
-    }
-
-    void createVertexBuffer() override {
-        float verts[] = { 0.f,0.f, 1.f,0.f, 1.f,1.f, 0.f,1.f };
-        sg_buffer_desc vd = {};
-        vd.data  = SG_RANGE(verts);
-        vd.label = "tc_nv12_verts";
-        vertexBuffer = sg_make_buffer(&vd);
-
-        uint16_t idx[] = { 0, 1, 2, 0, 2, 3 };
-        sg_buffer_desc id = {};
-        id.usage.index_buffer = true;
-        id.data  = SG_RANGE(idx);
-        id.label = "tc_nv12_idx";
-        indexBuffer = sg_make_buffer(&id);
-    }
-};
-
 namespace trussc {
 
 bool VideoPlayer::loadPlatform(const fs::path& path) {
@@ -1225,30 +1573,35 @@ bool VideoPlayer::loadPlatform(const fs::path& path) {
     height_ = impl->getHeight();
 
     if (width_ > 0 && height_ > 0) {
-        if (impl->isNV12Capable()) {
-            impl->nv12Mode_ = true;
-            nv12Mode_  = true;
-            pixelsY_   = new unsigned char[width_ * height_];
-            pixelsUV_  = new unsigned char[width_ * height_ / 2];
-            std::memset(pixelsY_,  0, width_ * height_);
-            std::memset(pixelsUV_, 128, width_ * height_ / 2);  // 128 = neutral chroma in NV12
-
-            auto* shader = new NV12VideoShader();
-            shader->loadShader();
-            nv12ShaderHandle_ = shader;
-        } else {
-            pixels_ = new unsigned char[width_ * height_ * 4];
-            std::memset(pixels_, 0, width_ * height_ * 4);
+        const auto planes = impl->planarLayout();
+        if (planes != TCVideoPlayerImpl::Planes::RGBA) {
+            yuvMode_  = true;
+            i420Mode_ = planes == TCVideoPlayerImpl::Planes::I420;
+
+            auto* shader = new internal::YuvVideoShader();
+            shader->loadShader(i420Mode_);
+            yuvShaderHandle_ = shader;
         }
+        // The pixel buffers are the impl's shown frame (neutral until the
+        // first frame arrives), not copies of it.
+        impl->primeFrames(planes);
+        bindFramePlatform();
     }
+    setScrubModePlatform();
 
     return true;
 }
 
 void VideoPlayer::closePlatform() {
-    if (nv12ShaderHandle_) {
-        delete static_cast<NV12VideoShader*>(nv12ShaderHandle_);
-        nv12ShaderHandle_ = nullptr;
+    // The pixel buffers belong to the impl's shown frame; close() must not
+    // delete[] them.
+    pixels_   = nullptr;
+    pixelsY_  = nullptr;
+    pixelsUV_ = nullptr;
+    pixelsV_  = nullptr;
+    if (yuvShaderHandle_) {
+        delete static_cast<internal::YuvVideoShader*>(yuvShaderHandle_);
+        yuvShaderHandle_ = nullptr;
     }
     if (platformHandle_) {
         auto impl = static_cast<TCVideoPlayerImpl*>(platformHandle_);
@@ -1257,8 +1610,9 @@ void VideoPlayer::closePlatform() {
     }
 }
 
-void VideoPlayer::drawNV12Platform(float x, float y, float w, float h) const {
-    static_cast<NV12VideoShader*>(nv12ShaderHandle_)->draw(x, y, w, h, textureY_, textureUV_);
+void VideoPlayer::drawYuvPlatform(float x, float y, float w, float h) const {
+    static_cast<internal::YuvVideoShader*>(yuvShaderHandle_)->draw(x, y, w, h, textureY_, textureUV_,
+                                                         i420Mode_ ? &textureV_ : nullptr);
 }
 
 void VideoPlayer::playPlatform() {
@@ -1281,7 +1635,59 @@ void VideoPlayer::setPausedPlatform(bool paused) {
 
 void VideoPlayer::updatePlatform() {
     if (platformHandle_) {
-        static_cast<TCVideoPlayerImpl*>(platformHandle_)->update(this);
+        auto impl = static_cast<TCVideoPlayerImpl*>(platformHandle_);
+        impl->update(this);
+        if (impl->hasNewFrame()) bindFramePlatform();
+    }
+}
+
+void VideoPlayer::setScrubModePlatform() {
+    if (platformHandle_) {
+        static_cast<TCVideoPlayerImpl*>(platformHandle_)->setScrubMode(scrubMode_, scrubCacheFrames_);
+    }
+}
+
+void* VideoPlayer::createDecodePoolPlatform(int threads) {
+    return new VideoDecodePool(threads);
+}
+
+void VideoPlayer::destroyDecodePoolPlatform(void* pool) {
+    delete static_cast<VideoDecodePool*>(pool);
+}
+
+void VideoPlayer::attachDecodePoolPlatform(void* pool) {
+    if (platformHandle_) {
+        static_cast<TCVideoPlayerImpl*>(platformHandle_)->attachPool(static_cast<VideoDecodePool*>(pool));
+    }
+}
+
+void VideoPlayer::setGroupClockPlatform(double clock, double present) {
+    if (platformHandle_) {
+        static_cast<TCVideoPlayerImpl*>(platformHandle_)->setGroupClock(clock, present);
+    }
+}
+
+double VideoPlayer::newestFramePlatform(double t) const {
+    if (!platformHandle_) return -std::numeric_limits<double>::infinity();
+    return static_cast<TCVideoPlayerImpl*>(platformHandle_)->newestFrameAt(t);
+}
+
+double VideoPlayer::frameDurationPlatform() const {
+    if (!platformHandle_) return 1.0 / 30.0;
+    return static_cast<TCVideoPlayerImpl*>(platformHandle_)->frameDuration();
+}
+
+// Point pixels_ (RGBA) or the Y / UV / V planes at the impl's shown frame.
+// update() uploads from there directly; the pointers stay valid until the
+// next new frame replaces it.
+void VideoPlayer::bindFramePlatform() {
+    auto& frame = static_cast<TCVideoPlayerImpl*>(platformHandle_)->shownFrame();
+    if (yuvMode_) {
+        pixelsY_  = frame.pixels.getData();
+        pixelsUV_ = frame.pixelsUV.getData();
+        pixelsV_  = i420Mode_ ? frame.pixelsV.getData() : nullptr;
+    } else {
+        pixels_ = frame.pixels.getData();
     }
 }
 
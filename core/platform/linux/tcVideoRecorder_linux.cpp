@@ -3,10 +3,12 @@
 // =============================================================================
 //
 // Mirrors the macOS AVFoundation / Windows Media Foundation backends: it
-// implements the three platform hooks declared in tc/video/tcVideoRecorder.h
+// implements the platform hooks declared in tc/video/tcVideoRecorder.h
 //   - openPlatform()   : build an appsrc -> encoder -> mp4mux pipeline
-//   - appendPlatform() : push one RGBA8 (top-down) frame
-//   - closePlatform()  : end-of-stream, flush and finalize the .mp4
+//   - appendPlatform() : queue one RGBA8 (top-down) frame
+//   - acquireFramePlatform() / commitFramePlatform() : the same, but the
+//     caller (addFrame(Fbo)) reads back straight into the queued buffer
+//   - closePlatform()  : drain the queue, end-of-stream, finalize the .mp4
 //
 // GStreamer is the desktop-native multimedia framework on Linux and is already
 // a TrussC dependency (Sound/VideoPlayer), so this adds no new library - the
@@ -21,19 +23,30 @@
 // rather than silently producing an empty file - so we get the efficient path
 // automatically and still never hard-fail where software is available.
 //
-// The recorder feeds RGBA top-down, which is exactly GStreamer's default raw
-// video layout, so no vertical flip or R<->B swizzle is needed here (unlike the
-// mac/win backends) - videoconvert handles RGBA -> I420 for the encoder.
+// Pipelined (4K60 needs it): frames land in a ring of pooled RGBA buffers
+// (settings.queueDepth; when it is full, settings.queuePolicy blocks or drops).
+// Worker threads convert them with the SIMD kernels in tcPixelConv.h - NV12
+// for hardware encoders, I420 for software ones - and hand the planes to
+// appsrc without a copy (gst_buffer_new_wrapped_full), in frame order. A plane
+// buffer goes back to its pool when the encoder releases it, which is what
+// getEncodedFrames() counts. RGBA top-down is the recorder's frame layout, so
+// no flip or swizzle is needed (unlike the mac/win backends); videoconvert
+// stays in the pipeline but just passes the planes through.
 // =============================================================================
 
 #if defined(__linux__)
 
 #include "TrussC.h"
+#include "tc/graphics/tcPixelConv.h"
 
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <string>
 
 namespace trussc {
@@ -42,6 +55,34 @@ namespace trussc {
 // Platform state (the pipeline owns the encoder + mp4 muxer + file sink)
 // ---------------------------------------------------------------------------
 namespace internal {
+
+// Plane buffers handed to appsrc. Shared with every GstBuffer wrapping one of
+// them, so a buffer the pipeline releases late still has somewhere to go.
+struct YuvBufferPool {
+    std::mutex mutex;
+    std::vector<uint8_t*> free;
+    size_t size = 0;
+    std::atomic<uint64_t>* encoded = nullptr;  // VideoWriter's counter; null once closed
+
+    ~YuvBufferPool() {
+        for (uint8_t* p : free) delete[] p;
+    }
+    uint8_t* take() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (free.empty()) return new uint8_t[size];
+        uint8_t* p = free.back();
+        free.pop_back();
+        return p;
+    }
+    // `wasEncoded`: the buffer went through the encoder (appsrc accepted it),
+    // rather than being discarded after a failure.
+    void give(uint8_t* p, bool wasEncoded) {
+        std::lock_guard<std::mutex> lock(mutex);
+        free.push_back(p);
+        if (wasEncoded && encoded) encoded->fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
 struct VideoWriterPlatformData {
     GstElement* pipeline = nullptr;
     GstElement* appsrc   = nullptr;  // video source (we hold a ref)
@@ -52,10 +93,42 @@ struct VideoWriterPlatformData {
     bool   hasAudio = false;
     int    audioRate = 0;
     int    audioChannels = 0;
-    bool   failed = false;
+    std::atomic<bool> failed{false};  // set by the conversion workers too
+
+    // Raw frame layout appsrc gets: GStreamer's default I420 / NV12 strides
+    // and plane offsets for width x height.
+    bool   nv12 = false;
+    int    yStride = 0;
+    int    cStride = 0;     // U and V (I420) or interleaved UV (NV12)
+    size_t uOffset = 0;
+    size_t vOffset = 0;     // I420 only
+    std::shared_ptr<YuvBufferPool> planes;
+
+    // Encode queue: RGBA slots cycle free -> (acquired) -> pending -> free.
+    struct Slot {
+        std::vector<uint8_t> rgba;
+        double   pts = 0.0;
+        uint64_t seq = 0;
+    };
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<Slot*> freeSlots;
+    std::deque<Slot*>  pending;
+    Slot* acquired = nullptr;
+    VideoQueuePolicy policy = VideoQueuePolicy::Block;
+    std::atomic<uint64_t>* dropped = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable workCv;   // pending frames / stopping
+    std::condition_variable slotCv;   // a slot came free / failed
+    std::condition_variable pushCv;   // nextPush advanced
+    std::vector<std::thread> workers;
+    uint64_t nextSeq  = 0;            // next frame committed
+    uint64_t nextPush = 0;            // next frame allowed into appsrc
+    bool stopping = false;
 };
 }  // namespace internal
 using internal::VideoWriterPlatformData;
+using internal::YuvBufferPool;
 
 namespace {
 
@@ -64,6 +137,8 @@ namespace {
 // element named "enc". HW encoders negotiate their own (4:2:0) chroma and may
 // need an uploader (vaapipostproc); software encoders get an explicit I420
 // capsfilter so x264enc doesn't pick the poorly-supported high-4:4:4 profile.
+// The recorder converts frames itself to the format each side prefers: NV12
+// for hardware encoders (their native surface format), I420 for software.
 struct EncoderOption {
     const char* probe;       // element that must exist for this option
     const char* encName;     // the "enc" element (for logging / bitrate)
@@ -129,6 +204,10 @@ bool codecPlan(VideoCodec codec, CodecPlan& out) {
     }
 }
 
+const char* rawFormat(const EncoderOption& opt) {
+    return opt.hardware ? "NV12" : "I420";
+}
+
 bool elementAvailable(const char* name) {
     GstElementFactory* f = gst_element_factory_find(name);
     if (f) { gst_object_unref(f); return true; }
@@ -146,7 +225,8 @@ bool probeEncoder(const EncoderOption& opt, int w, int h) {
     int pw = (w < 16 ? 16 : (w & ~1));
     int ph = (h < 16 ? 16 : (h & ~1));
     std::string desc =
-        "videotestsrc num-buffers=2 ! video/x-raw,format=RGBA,width=" +
+        "videotestsrc num-buffers=2 ! video/x-raw,format=" +
+        std::string(rawFormat(opt)) + ",width=" +
         std::to_string(pw) + ",height=" + std::to_string(ph) +
         ",framerate=30/1 ! videoconvert ! ";
     desc += opt.segment;
@@ -243,6 +323,98 @@ void configureKeyframeInterval(GstElement* enc, int frames) {
     }
 }
 
+size_t roundUp(size_t v, size_t align) {
+    return (v + align - 1) / align * align;
+}
+
+// A plane buffer travelling through the pipeline, and where it goes back to.
+// `accepted` is set once appsrc took the buffer; only those count as encoded.
+struct YuvRelease {
+    std::shared_ptr<YuvBufferPool> pool;
+    uint8_t* data;
+    bool accepted = false;
+};
+
+void releaseYuvBuffer(gpointer data) {
+    auto* r = static_cast<YuvRelease*>(data);
+    r->pool->give(r->data, r->accepted);
+    delete r;
+}
+
+// Conversion worker: take the oldest pending frame, convert it into a plane
+// buffer, give the RGBA slot back and push the planes once every earlier
+// frame is in (frames convert in parallel, appsrc needs them in order).
+void conversionWorker(VideoWriterPlatformData* pd) {
+    const int w = pd->width;
+    const int h = pd->height;
+    const gsize size = pd->planes->size;
+    for (;;) {
+        VideoWriterPlatformData::Slot* slot = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(pd->mutex);
+            pd->workCv.wait(lock, [&] { return pd->stopping || !pd->pending.empty(); });
+            if (pd->pending.empty()) return;  // stopping and drained
+            slot = pd->pending.front();
+            pd->pending.pop_front();
+        }
+
+        uint8_t* yuv = pd->planes->take();
+        if (pd->nv12) {
+            pixelconv::rgbaToNv12(slot->rgba.data(), w * 4, w, h,
+                                  yuv, pd->yStride, yuv + pd->uOffset, pd->cStride);
+        } else {
+            pixelconv::rgbaToI420(slot->rgba.data(), w * 4, w, h,
+                                  yuv, pd->yStride,
+                                  yuv + pd->uOffset, pd->cStride,
+                                  yuv + pd->vOffset, pd->cStride);
+        }
+        const double pts = slot->pts;
+        const uint64_t seq = slot->seq;
+        {
+            std::lock_guard<std::mutex> lock(pd->mutex);
+            pd->freeSlots.push_back(slot);
+        }
+        pd->slotCv.notify_one();
+
+        auto* release = new YuvRelease{pd->planes, yuv};
+        GstBuffer* buf = gst_buffer_new_wrapped_full(
+            GST_MEMORY_FLAG_READONLY, yuv, size, 0, size, release, releaseYuvBuffer);
+        // PTS is decided by the caller (fixed-rate for manual addFrame(), real
+        // elapsed time for auto-capture). Duration is one frame at the target fps.
+        GST_BUFFER_PTS(buf) = (GstClockTime)(pts * GST_SECOND);
+        GST_BUFFER_DURATION(buf) =
+            (GstClockTime)(GST_SECOND / (pd->fps > 0 ? pd->fps : 30.0));
+
+        {
+            std::unique_lock<std::mutex> lock(pd->mutex);
+            pd->pushCv.wait(lock, [&] { return pd->nextPush == seq; });
+        }
+        if (pd->failed) {
+            gst_buffer_unref(buf);  // discarded, not counted as encoded
+        } else {
+            // Hold a ref across the push so the buffer (and `release`) can't
+            // be freed before it is marked accepted; a rejected buffer is
+            // released unmarked.
+            gst_buffer_ref(buf);
+            GstFlowReturn ret =
+                gst_app_src_push_buffer(GST_APP_SRC(pd->appsrc), buf);  // takes one ref
+            if (ret == GST_FLOW_OK) release->accepted = true;
+            gst_buffer_unref(buf);
+            if (ret != GST_FLOW_OK) {
+                logError("VideoWriter")
+                    << "appsrc rejected frame: " << gst_flow_get_name(ret);
+                pd->failed = true;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(pd->mutex);
+            ++pd->nextPush;
+        }
+        pd->pushCv.notify_all();
+        if (pd->failed) pd->slotCv.notify_all();
+    }
+}
+
 } // namespace
 
 // ---------------------------------------------------------------------------
@@ -370,17 +542,31 @@ bool VideoWriter::openPlatform(const std::string& fullPath, int w, int h,
     configureKeyframeInterval(enc, settings.keyframeInterval);
     if (enc) gst_object_unref(enc);
 
-    // appsrc: time-stamped (we set PTS ourselves), pushed synchronously with
-    // backpressure so a slow encoder throttles capture instead of ballooning
-    // memory. RGBA top-down matches the recorder's frame layout exactly.
+    // Plane layout of the converted frames: GStreamer's default strides and
+    // offsets for the format (4-byte aligned rows, chroma of the rounded-up
+    // even height), so the caps alone describe the buffers.
+    const bool nv12 = opt->hardware;
+    const size_t chromaRows = roundUp((size_t)h, 2) / 2;
+    const int yStride = (int)roundUp((size_t)w, 4);
+    const int cStride = nv12 ? yStride : (int)roundUp(roundUp((size_t)w, 2) / 2, 4);
+    const size_t uOffset = (size_t)yStride * roundUp((size_t)h, 2);
+    const size_t vOffset = uOffset + (size_t)cStride * chromaRows;
+    const size_t frameSize = nv12 ? uOffset + (size_t)cStride * chromaRows
+                                  : vOffset + (size_t)cStride * chromaRows;
+
+    // appsrc: time-stamped (we set PTS ourselves), pushed with backpressure so
+    // a slow encoder throttles the conversion workers (and through the queue
+    // policy, capture) instead of ballooning memory. It holds at most two
+    // frames: one being encoded, the next ready behind it.
     int fnum = 0, fden = 1;
     fpsToRatio((fps > 0) ? fps : 30.0, fnum, fden);
     GstCaps* caps = gst_caps_new_simple(
         "video/x-raw",
-        "format",    G_TYPE_STRING, "RGBA",
-        "width",     G_TYPE_INT, w,
-        "height",    G_TYPE_INT, h,
-        "framerate", GST_TYPE_FRACTION, fnum, fden,
+        "format",      G_TYPE_STRING, rawFormat(*opt),
+        "width",       G_TYPE_INT, w,
+        "height",      G_TYPE_INT, h,
+        "framerate",   GST_TYPE_FRACTION, fnum, fden,
+        "colorimetry", G_TYPE_STRING, "bt709",
         nullptr);
     gst_app_src_set_caps(GST_APP_SRC(appsrc), caps);
     gst_caps_unref(caps);
@@ -390,6 +576,7 @@ bool VideoWriter::openPlatform(const std::string& fullPath, int w, int h,
                  "is-live",      FALSE,
                  "do-timestamp", FALSE,
                  "block",        TRUE,
+                 "max-bytes",    (guint64)frameSize * 2,
                  nullptr);
 
     // Audio appsrc: interleaved float32 at the engine's rate/channels;
@@ -451,13 +638,41 @@ bool VideoWriter::openPlatform(const std::string& fullPath, int w, int h,
         pd->audioRate     = settings.audioSampleRate;
         pd->audioChannels = settings.audioChannels;
     }
+
+    // Encode queue. A worker converts a 4K frame in a few ms; more than one
+    // lets the next frame convert while another waits on a busy encoder.
+    pd->nv12    = nv12;
+    pd->yStride = yStride;
+    pd->cStride = cStride;
+    pd->uOffset = uOffset;
+    pd->vOffset = vOffset;
+    pd->planes  = std::make_shared<YuvBufferPool>();
+    pd->planes->size    = frameSize;
+    pd->planes->encoded = &encodedFrames_;
+    pd->policy  = settings.queuePolicy;
+    pd->dropped = &droppedFrames_;
+
+    const int cores = (int)std::thread::hardware_concurrency();
+    const int workers = std::clamp(cores / 4, 2, 4);
+    const int depth = settings.queueDepth > 0 ? settings.queueDepth : workers + 2;
+    for (int i = 0; i < depth; ++i) {
+        auto slot = std::make_unique<VideoWriterPlatformData::Slot>();
+        slot->rgba.resize((size_t)w * h * 4);
+        pd->freeSlots.push_back(slot.get());
+        pd->slots.push_back(std::move(slot));
+    }
+    for (int i = 0; i < workers; ++i) {
+        pd->workers.emplace_back(conversionWorker, pd);
+    }
     platform_ = pd;
 
     logNotice("VideoWriter")
         << "GStreamer " << plan.label << " encoder: " << opt->encName
         << (opt->hardware ? " (hardware)" : " (software)")
         << (pd->hasAudio ? std::string(" + AAC audio (") + aacEnc + ")"
-                         : std::string());
+                         : std::string())
+        << ", " << rawFormat(*opt) << " from " << workers << " threads, queue "
+        << depth << (pd->policy == VideoQueuePolicy::Drop ? " (drop)" : " (block)");
     return true;
 }
 
@@ -494,36 +709,60 @@ bool VideoWriter::appendAudioPlatform(const float* interleaved, int frames,
     return true;
 }
 
-bool VideoWriter::appendPlatform(const unsigned char* rgba, double timeSec) {
+// ---------------------------------------------------------------------------
+// Encode queue - the frame goes into a free RGBA slot, the workers do the rest
+// ---------------------------------------------------------------------------
+unsigned char* VideoWriter::acquireFramePlatform(bool& dropped) {
+    dropped = false;
     VideoWriterPlatformData* pd = platform_;
-    if (!pd || !pd->appsrc || pd->failed) return false;
-
-    const gsize size = (gsize)pd->width * pd->height * 4;
-    GstBuffer* buf = gst_buffer_new_allocate(nullptr, size, nullptr);
-    if (!buf) {
-        logError("VideoWriter") << "could not allocate frame buffer";
-        pd->failed = true;
-        return false;
+    if (!pd || !pd->appsrc || pd->failed) return nullptr;
+
+    std::unique_lock<std::mutex> lock(pd->mutex);
+    if (pd->freeSlots.empty()) {
+        if (pd->policy == VideoQueuePolicy::Drop) {
+            pd->dropped->fetch_add(1, std::memory_order_relaxed);
+            dropped = true;
+            return nullptr;
+        }
+        pd->slotCv.wait(lock, [&] { return !pd->freeSlots.empty() || pd->failed; });
+        if (pd->failed) return nullptr;
     }
+    pd->acquired = pd->freeSlots.back();
+    pd->freeSlots.pop_back();
+    return pd->acquired->rgba.data();
+}
 
-    // RGBA top-down -> GStreamer RGBA top-down: a straight copy.
-    gst_buffer_fill(buf, 0, rgba, size);
-
-    // PTS is decided by the caller (fixed-rate for manual addFrame(), real
-    // elapsed time for auto-capture). Duration is one frame at the target fps.
-    GST_BUFFER_PTS(buf) = (GstClockTime)(timeSec * GST_SECOND);
-    GST_BUFFER_DURATION(buf) =
-        (GstClockTime)(GST_SECOND / (pd->fps > 0 ? pd->fps : 30.0));
+bool VideoWriter::commitFramePlatform(double timeSec) {
+    VideoWriterPlatformData* pd = platform_;
+    if (!pd || !pd->acquired) return false;
+    {
+        std::lock_guard<std::mutex> lock(pd->mutex);
+        pd->acquired->pts = timeSec;
+        pd->acquired->seq = pd->nextSeq++;
+        pd->pending.push_back(pd->acquired);
+        pd->acquired = nullptr;
+    }
+    pd->workCv.notify_one();
+    return !pd->failed;
+}
 
-    GstFlowReturn ret =
-        gst_app_src_push_buffer(GST_APP_SRC(pd->appsrc), buf);  // takes ownership
-    if (ret != GST_FLOW_OK) {
-        logError("VideoWriter")
-            << "appsrc rejected frame: " << gst_flow_get_name(ret);
-        pd->failed = true;
-        return false;
+void VideoWriter::cancelFramePlatform() {
+    VideoWriterPlatformData* pd = platform_;
+    if (!pd || !pd->acquired) return;
+    {
+        std::lock_guard<std::mutex> lock(pd->mutex);
+        pd->freeSlots.push_back(pd->acquired);
+        pd->acquired = nullptr;
     }
-    return true;
+    pd->slotCv.notify_one();
+}
+
+bool VideoWriter::appendPlatform(const unsigned char* rgba, double timeSec) {
+    bool dropped = false;
+    unsigned char* dst = acquireFramePlatform(dropped);
+    if (!dst) return dropped;  // a dropped frame isn't an error
+    std::memcpy(dst, rgba, (size_t)platform_->width * platform_->height * 4);
+    return commitFramePlatform(timeSec);
 }
 
 // ---------------------------------------------------------------------------
@@ -533,6 +772,16 @@ void VideoWriter::closePlatform() {
     VideoWriterPlatformData* pd = platform_;
     if (!pd) return;
 
+    // Convert and push everything still queued before ending the stream.
+    cancelFramePlatform();
+    {
+        std::lock_guard<std::mutex> lock(pd->mutex);
+        pd->stopping = true;
+    }
+    pd->workCv.notify_all();
+    for (auto& t : pd->workers) t.join();
+    pd->workers.clear();
+
     if (pd->pipeline && pd->appsrc && !pd->failed) {
         // Signal EOS on every source so mp4mux writes its moov atom (the muxer
         // waits for EOS on ALL its pads), then wait for the EOS (or ERROR) to
@@ -572,6 +821,11 @@ void VideoWriter::closePlatform() {
     if (pd->appsrc)   gst_object_unref(pd->appsrc);
     if (pd->audiosrc) gst_object_unref(pd->audiosrc);
     if (pd->pipeline) gst_object_unref(pd->pipeline);
+    {
+        // Frames released from here on no longer count (the writer may go).
+        std::lock_guard<std::mutex> lock(pd->planes->mutex);
+        pd->planes->encoded = nullptr;
+    }
 
     delete pd;
     platform_ = nullptr;
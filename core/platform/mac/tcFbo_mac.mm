@@ -129,10 +129,7 @@ bool Fbo::readPixelsFloatPlatform(float* pixels) const {
                                      mtlFmt, bytesPerRow, tmp.data());
         if (!ok) return false;
         // Convert U8 to float
-        int total = width_ * height_ * ch;
-        for (int i = 0; i < total; i++) {
-            pixels[i] = (float)tmp[i] / 255.0f;
-        }
+        pixelconv::u8ToF32(tmp.data(), pixels, (size_t)width_ * height_ * ch);
         return true;
     }
 
@@ -99,14 +99,7 @@ didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer
         for (size_t y = 0; y < height; y++) {
             unsigned char* srcRow = src + y * bytesPerRow;
             unsigned char* dstRow = dst + y * width * 4;
-            for (size_t x = 0; x < width; x++) {
-                size_t srcIdx = x * 4;
-                size_t dstIdx = x * 4;
-                dstRow[dstIdx + 0] = srcRow[srcIdx + 2];  // R <- B
-                dstRow[dstIdx + 1] = srcRow[srcIdx + 1];  // G <- G
-                dstRow[dstIdx + 2] = srcRow[srcIdx + 0];  // B <- R
-                dstRow[dstIdx + 3] = 255;                  // A = 不透明
-            }
+            trussc::pixelconv::swapRB(srcRow, dstRow, width, /*forceOpaque=*/true);
         }
 
         // メインスレッド用バッファにコピー
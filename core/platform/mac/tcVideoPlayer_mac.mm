@@ -367,14 +367,7 @@ NS_INLINE CGImageRef tcv_copy_cgimage_at_time(AVAssetImageGenerator* gen,
                 for (size_t y = 0; y < copyH; y++) {
                     unsigned char* srcRow = baseAddress + y * bytesPerRow;
                     unsigned char* dstRow = _pixelBuffer + y * (size_t)_videoWidth * 4;
-
-                    for (size_t x = 0; x < copyW; x++) {
-                        // BGRA -> RGBA
-                        dstRow[x * 4 + 0] = srcRow[x * 4 + 2];  // R <- B
-                        dstRow[x * 4 + 1] = srcRow[x * 4 + 1];  // G <- G
-                        dstRow[x * 4 + 2] = srcRow[x * 4 + 0];  // B <- R
-                        dstRow[x * 4 + 3] = srcRow[x * 4 + 3];  // A <- A
-                    }
+                    trussc::pixelconv::swapRB(srcRow, dstRow, copyW);
                 }
                 _hasNewFrame = YES;
             }
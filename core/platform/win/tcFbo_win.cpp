@@ -164,9 +164,7 @@ bool Fbo::readPixelsFloatPlatform(float* pixels) const {
         for (int y = 0; y < height_; y++) {
             unsigned char* srcRow = (unsigned char*)mapped.pData + y * mapped.RowPitch;
             float* dstRow = pixels + y * width_ * ch;
-            for (int i = 0; i < width_ * ch; i++) {
-                dstRow[i] = (float)srcRow[i] / 255.0f;
-            }
+            pixelconv::u8ToF32(srcRow, dstRow, (size_t)width_ * ch);
         }
     }
 
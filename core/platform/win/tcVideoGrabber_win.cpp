@@ -147,12 +147,8 @@ static void captureThreadFunc(VideoGrabberPlatformData* data) {
                         int srcY = h - 1 - y;  // flip vertically
                         unsigned char* srcRow = src + srcY * w * 4;
                         unsigned char* dstRow = dst + y * w * 4;
-                        for (int x = 0; x < w; x++) {
-                            dstRow[x * 4 + 0] = srcRow[x * 4 + 2];  // R <- B (BGRA->RGBA)
-                            dstRow[x * 4 + 1] = srcRow[x * 4 + 1];  // G
-                            dstRow[x * 4 + 2] = srcRow[x * 4 + 0];  // B <- R
-                            dstRow[x * 4 + 3] = 255;  // A (force opaque)
-                        }
+                        // BGRA->RGBA, A forced opaque
+                        pixelconv::swapRB(srcRow, dstRow, (size_t)w, /*forceOpaque=*/true);
                     }
 
                     // Copy to main thread buffer
@@ -538,12 +538,7 @@ bool VideoWriter::appendPlatform(const unsigned char* rgba, double timeSec) {
     for (int y = 0; y < h; ++y) {
         const unsigned char* srow = rgba + (size_t)y * stride;
         BYTE* drow = dst + (size_t)(h - 1 - y) * stride;
-        for (int x = 0; x < w; ++x) {
-            drow[x * 4 + 0] = srow[x * 4 + 2];  // B
-            drow[x * 4 + 1] = srow[x * 4 + 1];  // G
-            drow[x * 4 + 2] = srow[x * 4 + 0];  // R
-            drow[x * 4 + 3] = srow[x * 4 + 3];  // A
-        }
+        pixelconv::swapRB(srow, drow, (size_t)w);
     }
     buffer->Unlock();
     buffer->SetCurrentLength(frameBytes);
@@ -0,0 +1,57 @@
+@module tc_video_i420
+// I420 (YUV420P, software decode) → RGB shader for VideoPlayer on Linux.
+// The decode thread only copies planes; YUV→RGB happens here instead of in
+// sws_scale(). Same conversion as videoNV12.glsl.
+// Y plane: R8 texture, full resolution
+// U plane: R8 texture, half resolution (chroma subsampling)
+// V plane: R8 texture, half resolution
+
+@vs vs_i420
+layout(binding=0) uniform vs_params {
+    vec4 screenSizePos;  // xy = screen size (pixels), zw = draw origin (pixels)
+    vec4 sizePad;        // xy = draw size (pixels), zw = unused (padding)
+};
+
+in vec2 position;   // unit quad: (0,0) → (1,1)
+out vec2 v_uv;
+
+void main() {
+    v_uv = position;
+    vec2 pixelPos = screenSizePos.zw + position * sizePad.xy;
+    vec2 ndc = (pixelPos / screenSizePos.xy) * 2.0 - 1.0;
+    ndc.y = -ndc.y;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
+@end
+
+@fs fs_i420
+layout(binding=0) uniform texture2D texY;
+layout(binding=0) uniform sampler smpY;
+layout(binding=1) uniform texture2D texU;
+layout(binding=1) uniform sampler smpU;
+layout(binding=2) uniform texture2D texV;
+layout(binding=2) uniform sampler smpV;
+
+in vec2 v_uv;
+out vec4 frag_color;
+
+void main() {
+    float y  = texture(sampler2D(texY, smpY), v_uv).r;
+    float cb = texture(sampler2D(texU, smpU), v_uv).r;
+    float cr = texture(sampler2D(texV, smpV), v_uv).r;
+
+    // BT.601 limited-range YCbCr → RGB
+    float yy = (y  - 16.0 / 255.0) * (255.0 / 219.0);
+    float u  = (cb - 0.5) * (255.0 / 224.0);
+    float v  = (cr - 0.5) * (255.0 / 224.0);
+
+    frag_color = vec4(
+        clamp(yy + 1.402   * v,               0.0, 1.0),
+        clamp(yy - 0.34414 * u - 0.71414 * v, 0.0, 1.0),
+        clamp(yy + 1.772   * u,               0.0, 1.0),
+        1.0
+    );
+}
+@end
+
+@program i420 vs_i420 fs_i420
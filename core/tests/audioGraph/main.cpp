@@ -0,0 +1,337 @@
+// =============================================================================
+// core/tests/audioGraph — AudioGraph routing and effect nodes, driven the way
+// AudioEngine::mixThroughGraph() drives them, plus a processing benchmark.
+//
+// Routing: bus gain / pan / mute, post-fader sends and nested outputs sum to
+// the expected constant; cycles are refused; a removed bus falls back to
+// master. Nodes: biquad / SVF attenuation matches their design (and
+// BiquadFilter::getResponse()), the delay puts an impulse at the right
+// sample, the reverb tail decays, the compressor settles at the static-curve
+// gain reduction and the limiter never exceeds its ceiling.
+//
+// A global operator new counter asserts that the audio-thread side
+// (beginBlock / clear / process, with parameter changes) never allocates.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/sound/tcAudioGraph.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+
+using namespace trussc;
+
+static std::atomic<long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+constexpr int RATE = 48000;
+constexpr int CH = 2;
+constexpr int BLOCK = AudioGraph::BLOCK_FRAMES;
+constexpr float PI = 3.14159265358979f;
+
+// One engine block: voices are "sources" writing a constant or a signal into
+// a bus, then the graph runs.
+struct Source {
+    const AudioBus* bus = nullptr;
+    std::function<float(int64_t frame, int ch)> signal;
+};
+
+static void runBlock(AudioGraph& g, const std::vector<Source>& sources, float* out,
+                     int frames, int64_t start) {
+    g.clear(frames, CH);
+    for (auto& s : sources) {
+        float* buf = g.getBusBuffer(s.bus);
+        for (int i = 0; i < frames; i++) {
+            for (int c = 0; c < CH; c++) buf[i * CH + c] += s.signal(start + i, c);
+        }
+    }
+    g.process(out, frames, CH);
+}
+
+// Render `frames` frames through the graph; returns interleaved output.
+static std::vector<float> render(AudioGraph& g, const std::vector<Source>& sources, int frames) {
+    std::vector<float> out((size_t)frames * CH, 0.0f);
+    for (int off = 0; off < frames; off += BLOCK) {
+        const int n = std::min(BLOCK, frames - off);
+        if (g.beginBlock(CH)) runBlock(g, sources, out.data() + (size_t)off * CH, n, off);
+        g.collectGarbage();
+    }
+    return out;
+}
+
+// Run one node over a mono-per-channel signal.
+static std::vector<float> runNode(AudioNode& node, const std::function<float(int64_t)>& x, int frames) {
+    node.prepare(RATE, CH);
+    std::vector<float> buf((size_t)frames * CH);
+    for (int i = 0; i < frames; i++) buf[i * CH] = buf[i * CH + 1] = x(i);
+    for (int off = 0; off < frames; off += BLOCK) {
+        node.process(buf.data() + (size_t)off * CH, std::min(BLOCK, frames - off), CH);
+    }
+    return buf;
+}
+
+static float rmsTail(const std::vector<float>& buf, int from, int to, int ch = 0) {
+    double acc = 0.0;
+    for (int i = from; i < to; i++) acc += (double)buf[i * CH + ch] * buf[i * CH + ch];
+    return (float)std::sqrt(acc / std::max(1, to - from));
+}
+
+static std::function<float(int64_t)> sine(float hz, float amp = 1.0f) {
+    return [=](int64_t i) { return amp * std::sin(2.0f * PI * hz * (float)i / RATE); };
+}
+
+// --- routing -----------------------------------------------------------------
+
+static void testRouting() {
+    AudioGraph g;
+    g.prepare(RATE, CH);
+    auto one = [](int64_t, int) { return 1.0f; };
+
+    check("master-only graph is skipped", !g.beginBlock(CH));
+
+    auto a = g.createBus("a");
+    auto b = g.createBus("b");
+    auto c = g.createBus("c");
+    a->setGain(0.5f);
+    a->setSend(b, 0.25f);
+    b->setOutput(c);
+    c->setGain(2.0f);
+    auto out = render(g, {{a.get(), one}}, 1024);
+    // a: 0.5 to master; send 0.5 * 0.25 -> b -> c * 2.
+    check("gain + send + nested output sum", std::fabs(out[2000] - (0.5f + 0.25f)) < 1e-6f);
+    check("bus peak meter is post-fader", std::fabs(a->getPeak() - 0.5f) < 1e-6f);
+
+    c->setMute(true);
+    out = render(g, {{a.get(), one}}, BLOCK);
+    check("mute silences a bus and what feeds it", std::fabs(out[10] - 0.5f) < 1e-6f);
+    c->setMute(false);
+
+    g.getMaster()->setPan(-1.0f);
+    out = render(g, {{nullptr, one}}, BLOCK);
+    check("master pan hard left", out[0] == 1.0f && out[1] == 0.0f);
+    g.getMaster()->setPan(0.0f);
+
+    check("self output refused", !a->setOutput(a));
+    check("master output refused", !g.getMaster()->setOutput(a));
+    check("cycle via output refused", !c->setOutput(b) && c->getOutput() == g.getMaster());
+    check("cycle via send refused", !c->setSend(a, 0.5f) && c->getSend(a) == 0.0f);
+    check("send level update", a->setSend(b, 0.5f) && a->getSend(b) == 0.5f);
+    check("findBus", g.findBus("b") == b && g.findBus("master") == g.getMaster() && !g.findBus("x"));
+
+    // Removing b: a's send is dropped, a source still routed to b plays
+    // through master.
+    g.removeBus(b);
+    out = render(g, {{a.get(), one}, {b.get(), one}}, 1024);
+    check("removed bus falls back to master", std::fabs(out[2000] - 1.5f) < 1e-6f);
+    check("send to removed bus dropped", a->getSend(b) == 0.0f && g.getBuses().size() == 3);
+    check("output of removed bus reset", c->getOutput() == g.getMaster());
+}
+
+// --- nodes -------------------------------------------------------------------
+
+static void testFilters() {
+    const int N = RATE / 2;
+    {
+        BiquadFilter lp(BiquadFilter::Type::LowPass, 1000.0f);
+        const float pass = rmsTail(runNode(lp, sine(100.0f), N), N / 2, N) / 0.7071f;
+        const float stop = rmsTail(runNode(lp, sine(10000.0f), N), N / 2, N) / 0.7071f;
+        check("biquad LP passes 100 Hz", std::fabs(pass - 1.0f) < 0.01f);
+        check("biquad LP -40 dB at 10 kHz", stop < 0.012f);
+        check("biquad getResponse matches", std::fabs(lp.getResponse(10000.0f) - stop) < 0.002f);
+        BiquadFilter hp(BiquadFilter::Type::HighPass, 1000.0f);
+        check("biquad HP stops 100 Hz",
+              rmsTail(runNode(hp, sine(100.0f), N), N / 2, N) / 0.7071f < 0.012f);
+        BiquadFilter peak(BiquadFilter::Type::Peak, 2000.0f, 1.0f, 6.0f);
+        check("biquad peak +6 dB at center", std::fabs(peak.getResponse(2000.0f) - 1.9953f) < 0.01f);
+    }
+    {
+        SvfFilter lp(SvfFilter::Type::LowPass, 1000.0f);
+        const float pass = rmsTail(runNode(lp, sine(100.0f), N), N / 2, N) / 0.7071f;
+        const float stop = rmsTail(runNode(lp, sine(10000.0f), N), N / 2, N) / 0.7071f;
+        check("SVF LP passes 100 Hz", std::fabs(pass - 1.0f) < 0.01f);
+        check("SVF LP -40 dB at 10 kHz", stop < 0.012f);
+        SvfFilter bp(SvfFilter::Type::BandPass, 1000.0f, 1.0f);
+        const float center = rmsTail(runNode(bp, sine(1000.0f), N), N / 2, N) / 0.7071f;
+        check("SVF BP unity at center", std::fabs(center - 1.0f) < 0.01f);
+
+        // Sweep the cutoff every block: output stays bounded.
+        SvfFilter sweep(SvfFilter::Type::LowPass, 200.0f, 4.0f);
+        sweep.prepare(RATE, CH);
+        std::vector<float> buf((size_t)BLOCK * CH);
+        float worst = 0.0f;
+        for (int b = 0; b < 400; b++) {
+            sweep.setCutoff(200.0f + 8000.0f * (0.5f + 0.5f * std::sin(b * 0.3f)));
+            for (int i = 0; i < BLOCK; i++) buf[i * CH] = buf[i * CH + 1] = (i & 32) ? 0.5f : -0.5f;
+            sweep.process(buf.data(), BLOCK, CH);
+            for (float v : buf) worst = std::max(worst, std::fabs(v));
+        }
+        check("SVF stable under cutoff modulation", worst < 4.0f);
+    }
+}
+
+static void testDelay() {
+    Delay d(0.01f, 0.0f, 1.0f);
+    auto out = runNode(d, [](int64_t i) { return i == 3 ? 1.0f : 0.0f; }, 2048);
+    int at = -1;
+    for (int i = 0; i < 2048; i++) {
+        if (std::fabs(out[i * CH]) > 0.5f) { at = i; break; }
+    }
+    check("delay impulse lands 10 ms later", at == 3 + 480 && std::fabs(out[at * CH] - 1.0f) < 1e-6f);
+
+    Delay fb(0.01f, 0.5f, 1.0f);
+    out = runNode(fb, [](int64_t i) { return i == 0 ? 1.0f : 0.0f; }, 2048);
+    check("delay feedback repeats at half level", std::fabs(out[960 * CH] - 0.5f) < 1e-6f);
+}
+
+static void testReverb() {
+    Reverb r(0.7f, 0.5f, 1.0f, 0.0f);
+    const int N = RATE * 6;
+    auto out = runNode(r, [](int64_t i) { return i == 0 ? 1.0f : 0.0f; }, N);
+    const float early = rmsTail(out, 0, RATE / 2);
+    const float late = rmsTail(out, RATE * 5, N);
+    check("reverb produces a tail", early > 1e-3f);
+    check("reverb tail decays (> 60 dB)", late < early * 1e-3f);
+    check("reverb stereo decorrelated", std::fabs(out[RATE / 4 * CH] - out[RATE / 4 * CH + 1]) > 1e-6f);
+}
+
+static void testDynamics() {
+    const int N = RATE;
+    Compressor comp(-20.0f, 4.0f, 1.0f, 50.0f, 0.0f);
+    auto out = runNode(comp, sine(200.0f), N);
+    // Peak 0 dBFS, 20 dB over -> 15 dB reduction at 4:1.
+    check("compressor settles at static curve",
+          std::fabs(comp.getGainReduction() - 15.0f) < 0.5f);
+    check("compressor output level",
+          std::fabs(rmsTail(out, N / 2, N) / 0.7071f - std::pow(10.0f, -15.0f / 20.0f)) < 0.02f);
+
+    Limiter lim(-1.0f);
+    out = runNode(lim, sine(200.0f, 2.0f), N);
+    float peak = 0.0f;
+    for (float v : out) peak = std::max(peak, std::fabs(v));
+    check("limiter never exceeds ceiling", peak <= std::pow(10.0f, -1.0f / 20.0f) + 1e-6f);
+}
+
+// --- allocation --------------------------------------------------------------
+
+static void testNoAllocation() {
+    AudioGraph g;
+    g.prepare(RATE, CH);
+    auto sfx = g.createBus("sfx");
+    auto fx = g.createBus("fx");
+    auto eq = std::make_shared<BiquadFilter>(BiquadFilter::Type::HighPass, 80.0f);
+    auto svf = std::make_shared<SvfFilter>();
+    auto delay = std::make_shared<Delay>();
+    sfx->addEffect(eq);
+    sfx->addEffect(svf);
+    sfx->setSend(fx, 0.3f);
+    fx->addEffect(delay);
+    fx->addEffect(std::make_shared<Reverb>());
+    g.getMaster()->addEffect(std::make_shared<Compressor>());
+    g.getMaster()->addEffect(std::make_shared<Limiter>());
+    check("node belongs to one bus", !fx->addEffect(eq));
+
+    std::vector<float> out(BLOCK * CH);
+    g.beginBlock(CH);   // adopt the published order
+    const long before = g_allocs.load();
+    for (int b = 0; b < 1000; b++) {
+        eq->setFrequency(80.0f + (float)(b % 50));
+        svf->setCutoff(500.0f + 10.0f * (float)b);
+        delay->setTime(0.2f + 0.0001f * (float)b);
+        sfx->setPan(std::sin((float)b));
+        fx->setSend(g.getMaster(), 0.0f);     // no-op: no such send
+        g.beginBlock(CH);
+        g.clear(BLOCK, CH);
+        float* in = g.getBusBuffer(sfx.get());
+        for (int i = 0; i < BLOCK * CH; i++) in[i] = std::sin((float)(b * BLOCK + i) * 0.05f);
+        g.process(out.data(), BLOCK, CH);
+    }
+    check("audio-thread side never allocates", g_allocs.load() == before);
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static double bench(const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 5) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    return elapsed / iters;
+}
+
+static void benchmark() {
+    printf("\n--- benchmark: %d-frame stereo block at %d Hz ---\n", BLOCK, RATE);
+    const double blockMs = 1e3 * BLOCK / RATE;
+    std::vector<float> out(BLOCK * CH);
+
+    auto run = [&](const char* label, AudioGraph& g) {
+        g.beginBlock(CH);
+        double t = bench([&] {
+            g.beginBlock(CH);
+            g.clear(BLOCK, CH);
+            g.process(out.data(), BLOCK, CH);
+        });
+        printf("  %-40s %7.2f us (%5.2f%% of a core)\n", label, t * 1e6, 100.0 * t * 1e3 / blockMs);
+    };
+
+    {
+        AudioGraph g;
+        g.prepare(RATE, CH);
+        for (int i = 0; i < 8; i++) g.createBus("bus")->setGain(0.9f);
+        run("8 buses, gain only", g);
+    }
+    {
+        AudioGraph g;
+        g.prepare(RATE, CH);
+        auto fx = g.createBus("fx");
+        fx->addEffect(std::make_shared<Reverb>());
+        fx->addEffect(std::make_shared<Delay>());
+        for (int i = 0; i < 8; i++) {
+            auto b = g.createBus("bus");
+            b->addEffect(std::make_shared<BiquadFilter>(BiquadFilter::Type::Peak, 1000.0f, 1.0f, 3.0f));
+            b->addEffect(std::make_shared<SvfFilter>());
+            b->setSend(fx, 0.2f);
+        }
+        g.getMaster()->addEffect(std::make_shared<Compressor>());
+        g.getMaster()->addEffect(std::make_shared<Limiter>());
+        run("8 buses x (EQ+SVF), reverb+delay, comp+lim", g);
+    }
+}
+
+int main() {
+    testRouting();
+    testFilters();
+    testDelay();
+    testReverb();
+    testDynamics();
+    testNoAllocation();
+    benchmark();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
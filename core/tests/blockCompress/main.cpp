@@ -0,0 +1,217 @@
+// =============================================================================
+// core/tests/blockCompress — BC1 / BC3 / BC7 encoders decode back correctly.
+//
+// Every block the encoders emit is decoded with bcdec (an independent
+// decoder, vendored by tcxHap) and compared with the source:
+//   - smooth content stays above a per-format PSNR floor (a broken endpoint
+//     order, p-bit or anchor-index fix-up drops this to ~10-20 dB),
+//   - BC1 punch-through keeps transparent texels transparent,
+//   - solid blocks round-trip within the format's quantisation step,
+//   - partial edge blocks (sizes not a multiple of 4) are encoded.
+// Then a 4K frame is encoded per format and the time printed (informational).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#define BCDEC_IMPLEMENTATION
+#include "bcdec.h"
+
+#include "tc/graphics/tcBlockCompress.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+static const char* name(BlockFormat f) {
+    return f == BlockFormat::BC1 ? "BC1" : f == BlockFormat::BC3 ? "BC3" : "BC7";
+}
+
+static std::vector<uint8_t> decode(const std::vector<uint8_t>& blocks, int w, int h, BlockFormat f) {
+    const int bw = (w + 3) / 4, bh = (h + 3) / 4;
+    const size_t bb = blockBytes(f);
+    std::vector<uint8_t> padded((size_t)bw * 4 * bh * 4 * 4);
+    for (int by = 0; by < bh; by++) {
+        for (int bx = 0; bx < bw; bx++) {
+            const uint8_t* src = &blocks[((size_t)by * bw + bx) * bb];
+            uint8_t* dst = &padded[(((size_t)by * 4) * bw * 4 + bx * 4) * 4];
+            int pitch = bw * 16;
+            if (f == BlockFormat::BC1) bcdec_bc1(src, dst, pitch);
+            else if (f == BlockFormat::BC3) bcdec_bc3(src, dst, pitch);
+            else bcdec_bc7(src, dst, pitch);
+        }
+    }
+    std::vector<uint8_t> out((size_t)w * h * 4);
+    for (int y = 0; y < h; y++) {
+        std::memcpy(&out[(size_t)y * w * 4], &padded[(size_t)y * bw * 16], (size_t)w * 4);
+    }
+    return out;
+}
+
+static double psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, bool withAlpha) {
+    double se = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!withAlpha && i % 4 == 3) continue;
+        double d = (double)a[i] - (double)b[i];
+        se += d * d;
+        n++;
+    }
+    return se == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 * n / se);
+}
+
+// Smooth colour field + alpha ramp, like a photo with a soft matte.
+static std::vector<uint8_t> smoothImage(int w, int h, bool opaque) {
+    std::vector<uint8_t> img((size_t)w * h * 4);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            float fx = (float)x / w, fy = (float)y / h;
+            uint8_t* p = &img[((size_t)y * w + x) * 4];
+            p[0] = (uint8_t)(255.0f * (0.5f + 0.5f * std::sin(fx * 13.0f + fy * 3.0f)));
+            p[1] = (uint8_t)(255.0f * fy);
+            p[2] = (uint8_t)(255.0f * (0.5f + 0.5f * std::cos(fx * 7.0f * fy)));
+            p[3] = opaque ? 255 : (uint8_t)(255.0f * fx);
+        }
+    }
+    return img;
+}
+
+static void testQuality() {
+    const int w = 259, h = 131;   // partial edge blocks on both axes
+    struct Case { BlockFormat f; bool opaque; double floorRgb; double floorRgba; };
+    const Case cases[] = {
+        {BlockFormat::BC1, true,  38.0, 38.0},
+        {BlockFormat::BC3, false, 38.0, 38.0},
+        {BlockFormat::BC7, false, 44.0, 44.0},
+    };
+    for (const Case& c : cases) {
+        auto img = smoothImage(w, h, c.opaque);
+        std::vector<uint8_t> blocks;
+        encodeBlocks(img.data(), w, h, c.f, blocks);
+        bool sizeOk = blocks.size() == blockCompressedSize(w, h, c.f)
+                   && blocks.size() == (size_t)65 * 33 * blockBytes(c.f);
+        auto back = decode(blocks, w, h, c.f);
+        double rgb = psnr(img, back, false), rgba = psnr(img, back, true);
+        char label[96];
+        snprintf(label, sizeof(label), "%s smooth image PSNR rgb %.1f / rgba %.1f dB", name(c.f), rgb, rgba);
+        check(label, sizeOk && rgb >= c.floorRgb && rgba >= c.floorRgba);
+    }
+}
+
+static void testBlocks() {
+    std::mt19937 rng(11);
+
+    // BC1 punch-through: alpha < 128 decodes transparent, the rest opaque.
+    {
+        uint8_t px[64], out[8], dec[64];
+        for (int i = 0; i < 16; i++) {
+            px[i * 4 + 0] = (uint8_t)(100 + i * 2);
+            px[i * 4 + 1] = 90;
+            px[i * 4 + 2] = (uint8_t)(200 - i);
+            px[i * 4 + 3] = (i % 3 == 0) ? 0 : 255;
+        }
+        encodeBC1Block(px, out);
+        bcdec_bc1(out, dec, 16);
+        bool ok = true;
+        for (int i = 0; i < 16; i++) {
+            bool transparent = px[i * 4 + 3] < 128;
+            ok &= transparent ? dec[i * 4 + 3] == 0 : dec[i * 4 + 3] == 255;
+            if (!transparent) {
+                for (int c = 0; c < 3; c++) ok &= std::abs(dec[i * 4 + c] - px[i * 4 + c]) <= 16;
+            }
+        }
+        check("BC1 punch-through alpha", ok);
+    }
+
+    // Solid blocks: within one quantisation step (565 for BC1, 7+p for BC7).
+    {
+        bool ok1 = true, ok3 = true, ok7 = true;
+        for (int t = 0; t < 200; t++) {
+            uint8_t px[64], out[16], dec[64];
+            uint8_t r = (uint8_t)rng(), g = (uint8_t)rng(), b = (uint8_t)rng(), a = (uint8_t)rng();
+            for (int i = 0; i < 16; i++) {
+                px[i * 4 + 0] = r; px[i * 4 + 1] = g; px[i * 4 + 2] = b; px[i * 4 + 3] = a;
+            }
+            auto within = [&](const uint8_t* d, int tolRgb, int tolA, bool alpha) {
+                bool ok = true;
+                for (int i = 0; i < 16; i++) {
+                    for (int c = 0; c < 3; c++) ok &= std::abs(d[i * 4 + c] - px[i * 4 + c]) <= tolRgb;
+                    if (alpha) ok &= std::abs(d[i * 4 + 3] - px[i * 4 + 3]) <= tolA;
+                }
+                return ok;
+            };
+            uint8_t opaque[64];
+            std::memcpy(opaque, px, 64);
+            for (int i = 0; i < 16; i++) opaque[i * 4 + 3] = 255;
+            encodeBC1Block(opaque, out);
+            bcdec_bc1(out, dec, 16);
+            ok1 &= within(dec, 4, 0, false);
+            encodeBC3Block(px, out);
+            bcdec_bc3(out, dec, 16);
+            ok3 &= within(dec, 4, 0, true);
+            encodeBC7Block(px, out);
+            bcdec_bc7(out, dec, 16);
+            ok7 &= within(dec, 1, 1, true);
+        }
+        check("BC1 solid blocks within 565 step", ok1);
+        check("BC3 solid blocks within 565 step, alpha exact", ok3);
+        check("BC7 solid blocks within 1 LSB", ok7);
+    }
+
+    // Random blocks must still decode to *something* close on average —
+    // catches bit-layout mistakes that smooth content might hide.
+    {
+        double worst = 99.0;
+        for (int t = 0; t < 500; t++) {
+            uint8_t px[64], out[16], dec[64];
+            uint8_t base[4] = {(uint8_t)rng(), (uint8_t)rng(), (uint8_t)rng(), (uint8_t)rng()};
+            for (int i = 0; i < 64; i++) px[i] = (uint8_t)std::clamp((int)base[i % 4] + (int)(rng() % 33) - 16, 0, 255);
+            encodeBC7Block(px, out);
+            bcdec_bc7(out, dec, 16);
+            std::vector<uint8_t> a(px, px + 64), b(dec, dec + 64);
+            worst = std::min(worst, psnr(a, b, true));
+        }
+        char label[96];
+        snprintf(label, sizeof(label), "BC7 noisy blocks, worst PSNR %.1f dB", worst);
+        check(label, worst >= 26.0);
+    }
+}
+
+static void benchmark(int w, int h) {
+    printf("\nencode time, %dx%d RGBA8:\n", w, h);
+    std::vector<uint8_t> img = smoothImage(w, h, false);
+    for (BlockFormat f : {BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7}) {
+        std::vector<uint8_t> blocks;
+        auto t0 = std::chrono::steady_clock::now();
+        encodeBlocks(img.data(), w, h, f, blocks);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        printf("  %-4s %8.1f ms  %6.1f Mpx/s\n", name(f), ms, (double)w * h / ms / 1e3);
+    }
+}
+
+// Usage: blockCompress [width height]   (benchmark frame size, default 3840x2160)
+int main(int argc, char** argv) {
+    int w = 3840, h = 2160;
+    if (argc >= 3) {
+        w = std::atoi(argv[1]);
+        h = std::atoi(argv[2]);
+    }
+    testQuality();
+    testBlocks();
+    benchmark(w, h);
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+// =============================================================================
+// core/tests/chipSound — ChipSoundSynth (live synthesis) against the offline
+// build() path, plus a benchmark.
+//
+// Instances are created and rendered directly, the way the mixer drives them,
+// so no audio device is needed.
+//
+// - ChipSoundNote::generateBuffer() (now the shared voice code) matches the
+//   SoundBuffer::generate*() waveforms it used to call.
+// - A bundle rendered live matches the same bundle mixed offline
+//   (generateBuffer + applyADSR + mixFrom), however the blocks are split.
+// - Notes start on their exact frame; setTempo() moves them, setPitch()
+//   transposes, sweep / duty shape the tone, maxVoices caps the polyphony,
+//   seek() resumes notes mid-way, loop wraps, trigger() plays a note.
+// - Memory doesn't grow with the sequence, and render / skip / seek / trigger
+//   never allocate.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/sound/tcChipSound.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace trussc;
+
+// getLogger() normally lives in libTrussC (tcGlobal.cpp).
+Logger& trussc::getLogger() {
+    static Logger logger;
+    return logger;
+}
+
+static std::atomic<long> g_allocs{0};
+static std::atomic<long> g_bytes{0};
+
+[[gnu::noinline]] void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add((long)n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+// noinline: keeps GCC from flagging free() on a pointer it saw come from new.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+constexpr int RATE = 44100;
+constexpr int RUN = soundmix::RUN_FRAMES;
+
+// Render `frames` mono frames in blocks of `block` (<= RUN), appending to
+// out. Returns false if the instance ended early.
+static bool renderInto(SoundSynthInstance& inst, std::vector<float>& out, size_t frames,
+                       int block = RUN, double speed = 1.0, bool loop = false) {
+    float planes[SoundSynth::MAX_CHANNELS * RUN];
+    size_t done = 0;
+    while (done < frames) {
+        const int want = (int)std::min<size_t>((size_t)block, frames - done);
+        const int got = inst.render(planes, want, speed, loop);
+        out.insert(out.end(), planes, planes + got);
+        done += (size_t)got;
+        if (got < want) return false;
+    }
+    return true;
+}
+
+static float maxDiff(const std::vector<float>& a, const std::vector<float>& b, size_t n) {
+    float worst = 0.0f;
+    for (size_t i = 0; i < n; i++) worst = std::max(worst, std::fabs(a[i] - b[i]));
+    return worst;
+}
+
+static size_t firstNonZero(const std::vector<float>& x) {
+    for (size_t i = 0; i < x.size(); i++) {
+        if (x[i] != 0.0f) return i;
+    }
+    return x.size();
+}
+
+// Rising zero crossings / second over [from, to).
+static double frequencyOf(const std::vector<float>& x, size_t from, size_t to) {
+    int crossings = 0;
+    for (size_t i = from + 1; i < to; i++) {
+        if (x[i - 1] < 0.0f && x[i] >= 0.0f) ++crossings;
+    }
+    return crossings * (double)RATE / (double)(to - from);
+}
+
+// --- build() path -------------------------------------------------------------
+
+static void testOffline() {
+    printf("\n--- generateBuffer() vs SoundBuffer::generate*() ---\n");
+    struct Case { const char* name; Wave wave; };
+    const Case cases[] = {{"sine", Wave::Sin}, {"square", Wave::Square}, {"triangle", Wave::Triangle},
+                          {"sawtooth", Wave::Sawtooth}, {"noise", Wave::Noise},
+                          {"pink noise", Wave::PinkNoise}, {"silence", Wave::Silent}};
+    for (const auto& c : cases) {
+        ChipSoundNote note(c.wave, 523.25f, 0.4f, 0.6f);
+        SoundBuffer got, ref;
+        note.generateBuffer(got);
+        switch (c.wave) {
+            case Wave::Sin:       ref.generateSineWave(note.hz, note.duration, note.volume); break;
+            case Wave::Square:    ref.generateSquareWave(note.hz, note.duration, note.volume); break;
+            case Wave::Triangle:  ref.generateTriangleWave(note.hz, note.duration, note.volume); break;
+            case Wave::Sawtooth:  ref.generateSawtoothWave(note.hz, note.duration, note.volume); break;
+            case Wave::Noise:     ref.generateNoise(note.duration, note.volume); break;
+            case Wave::PinkNoise: ref.generatePinkNoise(note.duration, note.volume); break;
+            case Wave::Silent:    ref.generateSilence(note.duration); break;
+        }
+        // Square / saw edges may land one sample apart where the old float
+        // time and the phase accumulator round differently.
+        size_t mismatched = 0;
+        for (size_t i = 0; i < ref.numSamples && i < got.numSamples; i++) {
+            if (std::fabs(got.samples[i] - ref.samples[i]) > 1e-3f) ++mismatched;
+        }
+        char name[96];
+        snprintf(name, sizeof(name), "%s: same samples as before", c.name);
+        check(name, got.numSamples == ref.numSamples && got.sampleRate == ref.sampleRate
+                    && mismatched <= got.numSamples / 1000);
+    }
+}
+
+// --- live vs offline ----------------------------------------------------------
+
+static ChipSoundBundle melody() {
+    ChipSoundBundle b;
+    const float notes[] = {440.0f, 554.37f, 659.25f, 880.0f, 659.25f, 554.37f};
+    for (int i = 0; i < 6; i++) {
+        b.add({Wave::Square, notes[i], 0.2f, 0.3f}, 0.25f * (float)i);
+        b.add({Wave::Triangle, notes[i] / 2, 0.4f, 0.3f}, 0.25f * (float)i);
+    }
+    b.add({Wave::Noise, 0.0f, 0.1f, 0.2f}, 0.5f);
+    b.volume = 0.8f;
+    return b;
+}
+
+static std::vector<float> mixOffline(const ChipSoundBundle& b) {
+    SoundBuffer mixed;
+    mixed.generateSilence(b.getDuration(), RATE);
+    for (const auto& e : b.entries) {
+        SoundBuffer noteBuf;
+        e.note.generateBuffer(noteBuf);
+        noteBuf.applyADSR(e.note.attack, e.note.decay, e.note.sustain, e.note.release);
+        mixed.mixFrom(noteBuf, (size_t)(e.time * RATE), b.volume);
+    }
+    return mixed.samples;
+}
+
+static void testLiveMatchesOffline() {
+    printf("\n--- live synthesis vs build() ---\n");
+    const auto bundle = melody();
+    const auto offline = mixOffline(bundle);
+
+    bool allMatch = true;
+    for (int block : {RUN, 64, 37, 1}) {
+        ChipSoundSynth synth(bundle);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> live;
+        renderInto(*inst, live, offline.size(), block);
+        const float diff = maxDiff(live, offline, offline.size());
+        printf("  block %3d: max |live - offline| = %.2e\n", block, diff);
+        allMatch = allMatch && live.size() == offline.size() && diff < 2e-3f;
+    }
+    check("bundle renders like build() at any block split", allMatch);
+
+    ChipSoundSynth synth(bundle);
+    auto inst = synth.createInstance(RATE);
+    std::vector<float> live;
+    const bool full = renderInto(*inst, live, offline.size() + 1000);
+    check("non-looping synth ends at getDuration()",
+          !full && std::abs((long)live.size() - (long)(bundle.getDuration() * RATE)) <= 1);
+}
+
+// --- timing and modulation ----------------------------------------------------
+
+static ChipSoundNote flat(Wave wave, float hz, float duration) {
+    ChipSoundNote n(wave, hz, duration, 0.5f);
+    n.attack = 0.0f;
+    n.decay = 0.0f;
+    n.sustain = 1.0f;
+    n.release = 0.0f;
+    return n;
+}
+
+static void testTiming() {
+    printf("\n--- timing and modulation ---\n");
+    // 0.5 s + 37 frames: not a multiple of any block size used.
+    const double start = (RATE / 2 + 37) / (double)RATE;
+    ChipSoundBundle b;
+    b.add(flat(Wave::Square, 440.0f, 0.1f), (float)start);
+    const size_t expect = (size_t)std::ceil((float)start * RATE);
+
+    bool exact = true;
+    for (int block : {RUN, 100, 7}) {
+        ChipSoundSynth synth(b);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        renderInto(*inst, out, RATE, block);
+        exact = exact && firstNonZero(out) == expect;
+    }
+    check("note starts on its exact frame for any block size", exact);
+
+    {
+        ChipSoundSynth synth(b);
+        synth.setTempo(2.0f);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        renderInto(*inst, out, RATE);
+        const size_t first = firstNonZero(out);
+        check("setTempo(2) starts it at half the time", std::abs((long)first - (long)expect / 2) <= 1);
+        // Length halves too: 0.1 s -> 0.05 s.
+        size_t last = first;
+        for (size_t i = first; i < out.size(); i++) if (out[i] != 0.0f) last = i;
+        check("setTempo(2) halves the note length", std::abs((long)(last - first) - RATE / 20) <= 2);
+    }
+    {
+        ChipSoundBundle tone;
+        tone.add(flat(Wave::Sin, 440.0f, 1.0f), 0.0f);
+        ChipSoundSynth synth(tone);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        renderInto(*inst, out, RATE / 2);
+        const double before = frequencyOf(out, 0, out.size());
+        synth.setPitch(12.0f);
+        out.clear();
+        renderInto(*inst, out, RATE / 2);
+        const double after = frequencyOf(out, 0, out.size());
+        printf("  sine: %.0f Hz, after setPitch(12) %.0f Hz\n", before, after);
+        check("setPitch(12) doubles the frequency while playing",
+              std::fabs(before - 440.0) < 5.0 && std::fabs(after - 880.0) < 5.0);
+    }
+    {
+        ChipSoundNote sweep = flat(Wave::Sin, 220.0f, 1.0f);
+        sweep.sweep = 12.0f;   // one octave per second
+        ChipSoundBundle b2;
+        b2.add(sweep, 0.0f);
+        ChipSoundSynth synth(b2);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        renderInto(*inst, out, RATE);
+        const double lo = frequencyOf(out, 0, RATE / 10);
+        const double hi = frequencyOf(out, RATE * 9 / 10, RATE);
+        printf("  sweep +12 st/s: %.0f Hz -> %.0f Hz\n", lo, hi);
+        check("sweep slides the pitch", lo < 240.0 && hi > 400.0 && hi < 450.0);
+    }
+    {
+        ChipSoundNote pulse = flat(Wave::Square, 441.0f, 1.0f);
+        pulse.duty = 0.25f;
+        SoundBuffer buf;
+        pulse.generateBuffer(buf);
+        size_t high = 0;
+        for (float v : buf.samples) high += v > 0.0f;
+        const double ratio = (double)high / (double)buf.numSamples;
+        check("duty 0.25 keeps the pulse high a quarter of the time", std::fabs(ratio - 0.25) < 0.01);
+    }
+    {
+        ChipSoundBundle chord;
+        for (int i = 0; i < 40; i++) chord.add(flat(Wave::Square, 200.0f + 10.0f * i, 0.5f), 0.0f);
+        ChipSoundSynth synth(chord, 8);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        renderInto(*inst, out, RATE / 4);
+        float peak = 0.0f;
+        for (float v : out) peak = std::max(peak, std::fabs(v));
+        check("40 simultaneous notes play on at most 8 voices", peak > 0.5f && peak <= 8 * 0.5f + 1e-4f);
+    }
+}
+
+// --- seek, loop, trigger ------------------------------------------------------
+
+static double rms(const std::vector<float>& x, size_t from, size_t to) {
+    double sum = 0.0;
+    for (size_t i = from; i < to; i++) sum += (double)x[i] * x[i];
+    return std::sqrt(sum / (double)(to - from));
+}
+
+static void testTransport() {
+    printf("\n--- seek / loop / trigger ---\n");
+    ChipSoundBundle b;
+    ChipSoundNote held(Wave::Square, 330.0f, 1.0f, 0.5f);
+    b.add(held, 0.0f);
+    b.add(flat(Wave::Square, 660.0f, 0.2f), 1.5f);
+    {
+        ChipSoundSynth synth(b);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> straight;
+        renderInto(*inst, straight, RATE);
+
+        auto seeked = synth.createInstance(RATE);
+        seeked->seek(RATE / 2);
+        std::vector<float> out;
+        renderInto(*seeked, out, RATE / 10);
+        const double a = rms(straight, RATE / 2, RATE / 2 + RATE / 10);
+        const double c = rms(out, 0, out.size());
+        check("seek() into a note resumes it at the right level",
+              std::fabs(seeked->getPosition() - (RATE / 2 + RATE / 10)) < 1e-6 && std::fabs(a - c) < 0.02 * a);
+
+        seeked->seek(1.6 * RATE);
+        out.clear();
+        renderInto(*seeked, out, RATE / 20);
+        check("seek() past a gap picks up the later note", rms(out, 0, out.size()) > 0.4);
+    }
+    {
+        ChipSoundSynth synth(b);
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        const size_t length = (size_t)(b.getDuration() * RATE);
+        const bool full = renderInto(*inst, out, length * 2 + 100, RUN, 1.0, true);
+        const bool secondPass = maxDiff(std::vector<float>(out.begin() + (long)length, out.end()),
+                                        out, length - 10) < 2e-3f;
+        check("looping wraps to the start and replays the sequence",
+              full && secondPass && inst->getPosition() < RATE);
+    }
+    {
+        ChipSoundSynth synth;   // no sequence: endless, trigger() only
+        auto inst = synth.createInstance(RATE);
+        std::vector<float> out;
+        bool alive = renderInto(*inst, out, RATE);
+        const bool silentBefore = firstNonZero(out) == out.size();
+        synth.trigger(flat(Wave::Sin, 440.0f, 0.1f));
+        out.clear();
+        alive = renderInto(*inst, out, RATE / 5) && alive;
+        check("trigger() plays on an endless synth from the next block",
+              alive && silentBefore && firstNonZero(out) < 2 && synth.getDuration() == 0.0f);
+    }
+}
+
+// --- memory -------------------------------------------------------------------
+
+static void testMemory() {
+    printf("\n--- memory ---\n");
+    auto instanceBytes = [](int notes) {
+        ChipSoundBundle b;
+        for (int i = 0; i < notes; i++) b.add({Wave::Square, 440.0f, 0.1f, 0.3f}, 0.05f * (float)i);
+        ChipSoundSynth synth(b);
+        const long before = g_bytes.load();
+        auto inst = synth.createInstance(RATE);
+        return g_bytes.load() - before;
+    };
+    const long small = instanceBytes(10);
+    const long big = instanceBytes(100000);
+    printf("  instance: %ld bytes (10 notes), %ld bytes (100000 notes)\n", small, big);
+    check("instance memory doesn't grow with the sequence", small == big && small < 8192);
+
+    const auto bundle = melody();
+    ChipSoundSynth synth(bundle);
+    auto inst = synth.createInstance(RATE);
+    std::vector<float> scratch;
+    scratch.reserve(4 * RATE);
+    renderInto(*inst, scratch, RUN);
+
+    const long before = g_allocs.load();
+    float planes[RUN];
+    for (int i = 0; i < 400; i++) {
+        if (i % 50 == 0) synth.trigger(flat(Wave::PinkNoise, 0.0f, 0.05f));
+        if (i % 97 == 0) inst->seek((double)(i * 37));
+        synth.setPitch((float)(i % 7));
+        synth.setTempo(1.0f + (float)(i % 3) * 0.25f);
+        if (i & 1) inst->render(planes, RUN, 1.0, true);
+        else inst->skip(RUN, 1.0, true);
+    }
+    check("render / skip / seek / trigger never allocate", g_allocs.load() == before);
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static void benchmark() {
+    printf("\n--- benchmark: 16 voices for 3 minutes at 48 kHz ---\n");
+    ChipSoundBundle song;
+    const float scale[] = {261.63f, 293.66f, 329.63f, 349.23f, 392.0f, 440.0f, 493.88f, 523.25f};
+    const Wave waves[] = {Wave::Square, Wave::Triangle, Wave::Sawtooth, Wave::Sin};
+    for (int step = 0; step < 180 * 8; step++) {
+        for (int v = 0; v < 16; v++) {
+            ChipSoundNote n(waves[v % 4], scale[(step + v) % 8] * (1 + v / 8), 0.3f, 0.05f);
+            song.add(n, 0.125f * (float)step);
+        }
+    }
+    constexpr int rate = 48000;
+    const size_t frames = (size_t)(song.getDuration() * rate);
+
+    ChipSoundSynth synth(song, 16);
+    auto inst = synth.createInstance(rate);
+    float planes[RUN];
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t done = 0; done < frames; done += RUN) inst->render(planes, RUN, 1.0, false);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double audio = (double)frames / rate;
+    printf("  live: %.1f ms for %.0f s (%.0fx realtime, %.2f%% of one core), %zu voice bytes\n",
+           sec * 1e3, audio, audio / sec, 100.0 * sec / audio, 16 * sizeof(internal::ChipVoice));
+    printf("  build(): would hold %.1f MB of PCM (mono float, 44.1 kHz)\n",
+           song.getDuration() * 44100 * sizeof(float) / 1e6);
+}
+
+int main() {
+    testOffline();
+    testLiveMatchesOffline();
+    testTiming();
+    testTransport();
+    testMemory();
+    benchmark();
+
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// =============================================================================
+// core/tests/fft — FftPlan / fft() / fftReal() against a double-precision
+// DFT, plus a benchmark against the radix-2 loop they replaced.
+//
+// Every power-of-two size from 1 to 4096 is transformed (complex forward,
+// inverse round trip, real-input half-size transform with and without a
+// window) and compared to a direct O(N^2) DFT in double precision; the error
+// bound scales with log2(N). The vector-returning fftReal() must still return
+// all N bins with a mirrored upper half.
+//
+// A global operator new counter asserts that repeated FftPlan::forwardReal(),
+// fftReal(signal, out) and fftMagnitude(spectrum, out) calls don't allocate.
+//
+// The benchmark runs a 4096-point real FFT with the old path (complex copy +
+// radix-2 with per-butterfly twiddle recurrence) and the new one
+// (informational only).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/math/tcFFT.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <vector>
+
+using namespace trussc;
+
+// getLogger() normally lives in libTrussC (tcGlobal.cpp); tcFFT.h only needs
+// it for size errors.
+Logger& trussc::getLogger() {
+    static Logger logger;
+    return logger;
+}
+
+using cf = std::complex<float>;
+using cd = std::complex<double>;
+
+static std::atomic<long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+// noinline: keeps GCC from flagging free() on a pointer it saw come from new.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// --- references ----------------------------------------------------------------
+
+static std::vector<cd> dft(const std::vector<cd>& x) {
+    const size_t n = x.size();
+    std::vector<cd> out(n);
+    for (size_t k = 0; k < n; k++) {
+        cd acc = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            acc += x[i] * std::polar(1.0, -2.0 * 3.14159265358979323846 * (double)((k * i) % n) / (double)n);
+        }
+        out[k] = acc;
+    }
+    return out;
+}
+
+// The old tc::fft() body, for the benchmark.
+static void oldFft(std::vector<cf>& data) {
+    int n = (int)data.size();
+    int bits = internal::getBits(n);
+    for (int i = 0; i < n; i++) {
+        int j = internal::bitReverse(i, bits);
+        if (i < j) std::swap(data[i], data[j]);
+    }
+    for (int len = 2; len <= n; len *= 2) {
+        float angle = -TAU / len;
+        cf wn(std::cos(angle), std::sin(angle));
+        for (int i = 0; i < n; i += len) {
+            cf w(1.0f, 0.0f);
+            for (int j = 0; j < len / 2; j++) {
+                cf u = data[i + j];
+                cf t = w * data[i + j + len / 2];
+                data[i + j] = u + t;
+                data[i + j + len / 2] = u - t;
+                w *= wn;
+            }
+        }
+    }
+}
+
+// Max |a - b| relative to the reference's peak magnitude.
+template <typename A>
+static double relError(const A* a, const std::vector<cd>& ref, size_t n) {
+    double peak = 1e-12, err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        peak = std::max(peak, std::abs(ref[i]));
+        err = std::max(err, std::abs(cd(a[i].real(), a[i].imag()) - ref[i]));
+    }
+    return err / peak;
+}
+
+// --- accuracy ----------------------------------------------------------------
+
+static void testAccuracy() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    bool cplx = true, inv = true, real = true, win = true, full = true;
+    for (int bits = 0; bits <= 12; bits++) {
+        const int n = 1 << bits;
+        const double tol = 2e-7 * (bits + 2) * 4;
+        std::vector<cf> x(n);
+        std::vector<float> r(n);
+        std::vector<cd> xd(n), rd(n), wd(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = {u(rng), u(rng)};
+            r[i] = u(rng);
+            xd[i] = cd(x[i].real(), x[i].imag());
+            rd[i] = r[i];
+            wd[i] = n > 1 ? (double)r[i] * windowFunction(WindowType::Hanning, i, n) : r[i];
+        }
+        const auto X = dft(xd), R = dft(rd), W = dft(wd);
+
+        auto y = x;
+        fft(y);
+        cplx &= relError(y.data(), X, n) < tol;
+        ifft(y);
+        double rt = 0.0;
+        for (int i = 0; i < n; i++) rt = std::max(rt, (double)std::abs(y[i] - x[i]));
+        inv &= rt < tol;
+
+        FftPlan plan(n);
+        std::vector<cf> bins(plan.getRealBins());
+        plan.forwardReal(r.data(), bins.data());
+        real &= (int)bins.size() == n / 2 + 1 && relError(bins.data(), R, bins.size()) < tol;
+        if (n > 1) {
+            plan.forwardReal(r.data(), bins.data(), WindowType::Hanning);
+            win &= relError(bins.data(), W, bins.size()) < tol;
+        }
+
+        auto all = fftReal(r);
+        full &= (int)all.size() == n && relError(all.data(), R, n) < tol;
+
+        if (!(cplx && inv && real && win && full)) {
+            printf("  first failure at N = %d\n", n);
+            break;
+        }
+    }
+    check("fft() matches DFT, N = 1 .. 4096", cplx);
+    check("ifft(fft(x)) == x", inv);
+    check("FftPlan::forwardReal matches DFT (N/2+1 bins)", real);
+    check("forwardReal with Hanning == windowed DFT", win);
+    check("fftReal(signal) returns N bins, upper half mirrored", full);
+
+    std::vector<float> bad(6, 1.0f);
+    std::vector<cf> out(3);
+    fftReal(bad, out);
+    check("non-power-of-two size rejected", out.empty());
+}
+
+// --- allocation --------------------------------------------------------------
+
+static void testNoAllocation() {
+    const int n = 4096;
+    std::vector<float> signal(n);
+    for (int i = 0; i < n; i++) signal[i] = std::sin(0.05f * i);
+    std::vector<cf> bins;
+    std::vector<float> mags;
+    FftPlan plan(n);
+    std::vector<cf> planOut(plan.getRealBins());
+
+    // Warm up: per-thread plan, window table, output capacity.
+    fftReal(signal, bins, WindowType::Hanning);
+    fftMagnitude(bins, mags);
+    plan.forwardReal(signal.data(), planOut.data(), WindowType::Blackman);
+
+    const long before = g_allocs.load();
+    for (int i = 0; i < 100; i++) {
+        fftReal(signal, bins, WindowType::Hanning);
+        fftMagnitude(bins, mags);
+        plan.forwardReal(signal.data(), planOut.data(), WindowType::Blackman);
+    }
+    check("repeated fftReal / fftMagnitude / plan never allocate", g_allocs.load() == before);
+
+    const int peak = (int)(std::max_element(mags.begin(), mags.end()) - mags.begin());
+    const int expected = (int)std::lround(0.05 * n / TAU);
+    check("sine lands in the expected bin", std::abs(peak - expected) <= 1);
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static double bench(const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 5) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    return elapsed / iters;
+}
+
+static void benchmark() {
+    printf("\n--- benchmark: 4096-point real FFT (Hanning) ---\n");
+    const int n = 4096;
+    std::vector<float> signal(n);
+    for (int i = 0; i < n; i++) signal[i] = std::sin(0.05f * i) + 0.3f * std::sin(0.9f * i);
+
+    const double tOld = bench([&] {
+        std::vector<float> windowed = signal;
+        applyWindow(windowed, WindowType::Hanning);
+        auto data = toComplex(windowed);
+        oldFft(data);
+        auto mag = std::vector<float>(data.size());
+        for (size_t i = 0; i < data.size(); i++) mag[i] = std::abs(data[i]);
+    });
+    std::vector<cf> bins;
+    std::vector<float> mags;
+    const double tNew = bench([&] {
+        fftReal(signal, bins, WindowType::Hanning);
+        fftMagnitude(bins, mags);
+    });
+    std::vector<cf> cplx(n);
+    FftPlan plan(n);
+    const double tOldC = bench([&] {
+        for (int i = 0; i < n; i++) cplx[i] = {signal[i], 0.0f};
+        oldFft(cplx);
+    });
+    const double tNewC = bench([&] {
+        for (int i = 0; i < n; i++) cplx[i] = {signal[i], 0.0f};
+        plan.forward(cplx.data());
+    });
+    printf("  real + window + magnitude: old %7.2f us, new %7.2f us (%.1fx)\n",
+           tOld * 1e6, tNew * 1e6, tOld / tNew);
+    printf("  complex forward:           old %7.2f us, new %7.2f us (%.1fx)\n",
+           tOldC * 1e6, tNewC * 1e6, tOldC / tNewC);
+}
+
+int main() {
+    testAccuracy();
+    testNoAllocation();
+    benchmark();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
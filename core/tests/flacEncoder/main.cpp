@@ -0,0 +1,276 @@
+// =============================================================================
+// core/tests/flacEncoder — FlacEncoder round trips through an independent
+// decoder, plus BlockFileWriter, plus encode throughput.
+//
+// Every stream is decoded with dr_flac (bundled in miniaudio, the decoder
+// SoundBuffer::load() uses), which also verifies each frame's CRC-16, and
+// must come back bit-exact:
+//
+// - mono / stereo / 6-channel, 16- and 24-bit;
+// - correlated stereo (exercises the side / mid-side decorrelations),
+//   independent noise, full-scale noise (verbatim subframes), silence
+//   (constant subframes) and a short final block;
+// - block sizes that use every header block-size encoding, and enough
+//   frames for multi-byte frame numbers.
+//
+// Sizes are checked against the WAV equivalent (tone well below, silence
+// tiny, noise never more than a little above), STREAMINFO totals against
+// the input, and a counting operator new asserts encode() doesn't allocate.
+//
+// BlockFileWriter: odd-sized appends across small staging buffers, writeAt()
+// header patches and the final size read back byte for byte.
+//
+// The benchmark encodes 60 s of 48 kHz stereo music-like signal (informational
+// only).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#define MA_NO_DEVICE_IO
+#define MA_NO_ENCODING
+#define MA_NO_GENERATION
+#define MA_NO_THREADING
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "tc/sound/tcFlacEncoder.h"
+#include "tc/utils/tcBlockFileWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <vector>
+
+using namespace trussc;
+
+static std::atomic<long> g_allocs{0};
+
+// noinline: keeps GCC from pairing the inlined malloc() / free() with
+// new / delete and flagging them as mismatched.
+[[gnu::noinline]] void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// --- helpers -------------------------------------------------------------------
+
+struct Encoded {
+    std::vector<uint8_t> bytes;
+    uint64_t frames = 0;
+};
+
+static Encoded encodeAll(const std::vector<int32_t>& pcm, int rate, int channels, int bits,
+                         int blockSize) {
+    FlacEncoder enc;
+    Encoded e;
+    if (!enc.setup(rate, channels, bits, blockSize)) return e;
+    e.bytes.resize(FlacEncoder::HEADER_SIZE);
+    const size_t frames = pcm.size() / channels;
+    for (size_t f = 0; f < frames; f += (size_t)blockSize) {
+        const int n = (int)std::min<size_t>((size_t)blockSize, frames - f);
+        const size_t bytes = enc.encode(pcm.data() + f * channels, n);
+        e.bytes.insert(e.bytes.end(), enc.data(), enc.data() + bytes);
+    }
+    const uint8_t* header = enc.getHeader();
+    std::copy(header, header + FlacEncoder::HEADER_SIZE, e.bytes.begin());
+    e.frames = enc.getTotalFrames();
+    return e;
+}
+
+// Decode with dr_flac; true if the stream has the expected layout, length
+// and every sample matches.
+static bool roundTrip(const std::vector<int32_t>& pcm, int rate, int channels, int bits,
+                      int blockSize, size_t* encodedBytes = nullptr) {
+    const Encoded e = encodeAll(pcm, rate, channels, bits, blockSize);
+    if (encodedBytes) *encodedBytes = e.bytes.size();
+    if (e.bytes.empty()) return false;
+
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_s32, 0, 0);
+    cfg.encodingFormat = ma_encoding_format_flac;
+    ma_decoder dec;
+    if (ma_decoder_init_memory(e.bytes.data(), e.bytes.size(), &cfg, &dec) != MA_SUCCESS) return false;
+
+    bool ok = (int)dec.outputChannels == channels && (int)dec.outputSampleRate == rate;
+    ma_uint64 length = 0;
+    ma_decoder_get_length_in_pcm_frames(&dec, &length);
+    const size_t frames = pcm.size() / channels;
+    ok &= length == frames && e.frames == frames;
+
+    std::vector<int32_t> out(pcm.size() + channels * 16);
+    ma_uint64 read = 0;
+    ma_decoder_read_pcm_frames(&dec, out.data(), frames + 16, &read);
+    ok &= read == frames;
+    for (size_t i = 0; ok && i < pcm.size(); i++) ok = (out[i] >> (32 - bits)) == pcm[i];
+    ma_decoder_uninit(&dec);
+    return ok;
+}
+
+static int32_t quantize(double v, int bits) {
+    const double full = (double)((1 << (bits - 1)) - 1);
+    return (int32_t)std::lrint(std::clamp(v, -1.0, 1.0) * full);
+}
+
+// Two detuned tones + a little noise, same on both channels with a delay:
+// compressible and correlated, like most program material.
+static std::vector<int32_t> music(size_t frames, int channels, int bits, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 0.0003);
+    std::vector<int32_t> pcm(frames * channels);
+    for (size_t f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            const double t = (double)(f + (size_t)c * 7) / 48000.0;
+            const double v = 0.4 * std::sin(6.283185307 * 220.0 * t)
+                           + 0.2 * std::sin(6.283185307 * 331.0 * t) + noise(rng);
+            pcm[f * channels + c] = quantize(v, bits);
+        }
+    }
+    return pcm;
+}
+
+static std::vector<int32_t> whiteNoise(size_t frames, int channels, int bits, double amp, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(-amp, amp);
+    std::vector<int32_t> pcm(frames * channels);
+    for (auto& s : pcm) s = quantize(u(rng), bits);
+    return pcm;
+}
+
+// --- round trips -----------------------------------------------------------------
+
+static void testRoundTrips() {
+    check("mono 16-bit tone", roundTrip(music(20000, 1, 16, 1), 48000, 1, 16, 4096));
+    check("stereo 16-bit correlated", roundTrip(music(20000, 2, 16, 2), 44100, 2, 16, 4096));
+    check("stereo 24-bit correlated", roundTrip(music(20000, 2, 24, 3), 96000, 2, 24, 4096));
+    check("6-channel 24-bit", roundTrip(music(9000, 6, 24, 4), 48000, 6, 24, 4096));
+    check("stereo independent noise", roundTrip(whiteNoise(12000, 2, 16, 0.3, 5), 48000, 2, 16, 4096));
+    check("full-scale noise (verbatim)", roundTrip(whiteNoise(8192, 2, 16, 1.0, 6), 48000, 2, 16, 4096));
+    check("silence (constant)", roundTrip(std::vector<int32_t>(2 * 10000, 0), 48000, 2, 16, 4096));
+    check("full-scale extremes", [] {
+        std::vector<int32_t> pcm(2 * 5000);
+        for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (i / 3) % 2 ? 32767 : -32768;
+        return roundTrip(pcm, 48000, 2, 16, 4096);
+    }());
+    check("stream shorter than a block", roundTrip(music(100, 2, 16, 7), 48000, 2, 16, 4096));
+    check("odd sample rate (from STREAMINFO)", roundTrip(music(5000, 1, 16, 8), 37800, 1, 16, 1152));
+
+    // Header block-size codes: 192, 576 family, 8-bit and 16-bit explicit.
+    bool codes = true;
+    for (int bs : {192, 576, 4608, 200, 1000, 16})
+        codes &= roundTrip(music(6000, 2, 16, 9), 48000, 2, 16, bs);
+    check("every block-size header encoding", codes);
+
+    // 16-frame blocks: > 2048 frames, so frame numbers need 3-byte UTF-8.
+    check("multi-byte frame numbers", roundTrip(music(16 * 2100, 1, 16, 10), 48000, 1, 16, 16));
+}
+
+// --- sizes ---------------------------------------------------------------------
+
+static void testSizes() {
+    const size_t frames = 48000 * 2;
+    size_t tone = 0, silence = 0, noise = 0;
+    roundTrip(music(frames, 2, 16, 11), 48000, 2, 16, 4096, &tone);
+    roundTrip(std::vector<int32_t>(frames * 2, 0), 48000, 2, 16, 4096, &silence);
+    roundTrip(whiteNoise(frames, 2, 16, 1.0, 12), 48000, 2, 16, 4096, &noise);
+    const double wav = (double)frames * 2 * 2;
+    printf("  2 s stereo 16-bit: tone %.1f%%, silence %.2f%%, noise %.1f%% of WAV\n",
+           100.0 * tone / wav, 100.0 * silence / wav, 100.0 * noise / wav);
+    check("tone compresses below 50% of WAV", tone < 0.5 * wav);
+    check("silence compresses below 0.5% of WAV", silence < 0.005 * wav);
+    check("noise stays within 1% of WAV", noise < 1.01 * wav);
+}
+
+// --- allocation ----------------------------------------------------------------
+
+static void testNoAllocation() {
+    FlacEncoder enc;
+    enc.setup(48000, 2, 24);
+    const auto pcm = music(4096 * 8, 2, 24, 13);
+    const long before = g_allocs.load();
+    size_t total = 0;
+    for (int b = 0; b < 8; b++) total += enc.encode(pcm.data() + (size_t)b * 4096 * 2, 4096);
+    total += enc.encode(pcm.data(), 777);
+    (void)enc.getHeader();
+    check("encode() / getHeader() never allocate", g_allocs.load() == before && total > 0);
+    check("setup rejects 9 channels", !FlacEncoder().setup(48000, 9, 16));
+}
+
+// --- BlockFileWriter ---------------------------------------------------------
+
+static void testFileWriter() {
+    const auto path = std::filesystem::temp_directory_path() / "tc_filewriter_test.bin";
+    std::vector<uint8_t> expect;
+    std::mt19937 rng(14);
+    bool ok = true;
+    {
+        BlockFileWriter w;
+        ok &= w.open(path, 5000, 1 << 16);          // staging rounds up to 8 KiB
+        const uint32_t placeholder = 0;
+        ok &= w.write(&placeholder, 4);
+        expect.insert(expect.end(), 4, 0);
+        for (int i = 0; i < 300; i++) {
+            std::vector<uint8_t> chunk(rng() % 3000 + 1);
+            for (auto& b : chunk) b = (uint8_t)rng();
+            ok &= w.write(chunk.data(), chunk.size());
+            expect.insert(expect.end(), chunk.begin(), chunk.end());
+        }
+        const uint32_t size = (uint32_t)expect.size();
+        ok &= w.writeAt(0, &size, 4);
+        std::memcpy(expect.data(), &size, 4);
+        ok &= !w.writeAt(expect.size() - 2, &size, 4);   // past the end
+        ok &= w.tell() == expect.size();
+        ok &= w.close();
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> got((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::filesystem::remove(path);
+    check("BlockFileWriter: appends + writeAt read back exactly", ok && got == expect);
+}
+
+// --- benchmark -----------------------------------------------------------------
+
+static void benchmark() {
+    printf("\n--- benchmark: 60 s of 48 kHz stereo ---\n");
+    const size_t frames = 48000 * 60;
+    for (int bits : {16, 24}) {
+        const auto pcm = music(frames, 2, bits, 15);
+        FlacEncoder enc;
+        enc.setup(48000, 2, bits);
+        size_t bytes = FlacEncoder::HEADER_SIZE;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < frames; f += 4096) {
+            bytes += enc.encode(pcm.data() + f * 2, (int)std::min<size_t>(4096, frames - f));
+        }
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("  %d-bit: %.1f ms (%.0fx realtime), %.1f%% of WAV\n", bits, sec * 1e3, 60.0 / sec,
+               100.0 * bytes / ((double)frames * 2 * (bits / 8)));
+    }
+}
+
+int main() {
+    testRoundTrips();
+    testSizes();
+    testNoAllocation();
+    testFileWriter();
+    benchmark();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
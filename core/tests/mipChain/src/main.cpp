@@ -0,0 +1,187 @@
+// =============================================================================
+// mipChain — MipChain partial updates stay in step with a full rebuild
+//
+// Texture::loadData(pixels, x, y, w, h) and the glyph atlas only re-average
+// the mip texels under a changed rectangle. If the footprint maths is off by
+// one (odd level sizes, a rect touching the right/bottom edge) the chain
+// silently drifts from the base image. This test scribbles random rects into
+// odd- and even-sized U8/F32 images, applies MipChain::update() for each, and
+// asserts every level equals a fresh build() — which in turn must equal the
+// chain of Pixels::halve() calls Texture used before, and both must equal the
+// original per-texel pow() / lround() loop (kept below as the reference; the
+// LUT gamma encode has to reproduce it exactly, down to the darkest codes).
+// =============================================================================
+
+#include <TrussC.h>
+#include "tc/graphics/tcGammaTables.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace std;
+using namespace tc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-64s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// The original Pixels::halve(): per-texel pow(2.2) decode, pow(1 / 2.2) +
+// lround encode.
+static Pixels referenceHalve(const Pixels& src) {
+    const int sw = src.getWidth();
+    const int sh = src.getHeight();
+    const int ch = src.getChannels();
+    const int newW = std::max(sw / 2, 1);
+    const int newH = std::max(sh / 2, 1);
+    const bool isF32 = src.getFormat() == PixelFormat::F32;
+
+    Pixels dst;
+    dst.allocate(newW, newH, ch, src.getFormat());
+    auto srcF = static_cast<const float*>(src.getDataVoid());
+    auto srcU = static_cast<const unsigned char*>(src.getDataVoid());
+    auto dstF = static_cast<float*>(dst.getDataVoid());
+    auto dstU = static_cast<unsigned char*>(dst.getDataVoid());
+
+    for (int y = 0; y < newH; y++) {
+        int sy0 = std::min(2 * y,     sh - 1);
+        int sy1 = std::min(2 * y + 1, sh - 1);
+        for (int x = 0; x < newW; x++) {
+            int sx0 = std::min(2 * x,     sw - 1);
+            int sx1 = std::min(2 * x + 1, sw - 1);
+            for (int c = 0; c < ch; c++) {
+                int i00 = (sy0 * sw + sx0) * ch + c;
+                int i01 = (sy0 * sw + sx1) * ch + c;
+                int i10 = (sy1 * sw + sx0) * ch + c;
+                int i11 = (sy1 * sw + sx1) * ch + c;
+                if (isF32) {
+                    dstF[(y * newW + x) * ch + c] = (srcF[i00] + srcF[i01] + srcF[i10] + srcF[i11]) * 0.25f;
+                } else {
+                    bool linear = ch <= 2 || c == 3;
+                    auto fetch = [&](int i) -> float {
+                        float v = srcU[i] / 255.0f;
+                        return linear ? v : std::pow(v, 2.2f);
+                    };
+                    float avg = (fetch(i00) + fetch(i01) + fetch(i10) + fetch(i11)) * 0.25f;
+                    if (!linear) avg = std::pow(avg, 1.0f / 2.2f);
+                    avg = std::clamp(avg, 0.0f, 1.0f);
+                    dstU[(y * newW + x) * ch + c] = static_cast<unsigned char>(std::lround(avg * 255.0f));
+                }
+            }
+        }
+    }
+    return dst;
+}
+
+static void fillRect(Pixels& p, int x, int y, int w, int h, mt19937& rng) {
+    const int ch = p.getChannels();
+    for (int yy = y; yy < std::min(p.getHeight(), y + h); yy++) {
+        for (int xx = x; xx < std::min(p.getWidth(), x + w); xx++) {
+            for (int c = 0; c < ch; c++) {
+                size_t i = ((size_t)yy * p.getWidth() + xx) * ch + c;
+                if (p.getFormat() == PixelFormat::F32) p.getDataF32()[i] = (rng() % 1000) / 250.0f;
+                else p.getData()[i] = (unsigned char)rng();
+            }
+        }
+    }
+}
+
+static bool sameAsBuild(const MipChain& chain, const Pixels& base, MipChain::Filter filter) {
+    MipChain fresh;
+    fresh.build(base, 0, filter);
+    if (fresh.getNumLevels() != chain.getNumLevels()) return false;
+    for (int l = 1; l < chain.getNumLevels(); l++) {
+        if (memcmp(fresh.getLevelData(l), chain.getLevelData(l), chain.getLevelBytes(l)) != 0) return false;
+    }
+    return true;
+}
+
+// GammaTables::encode against the pow() / lround() it replaced: every float
+// within 2^14 ulps of each code boundary (where the two can disagree), both
+// the exact one and the pow((k - 0.5) / 255, 2.2) estimate, plus a strided
+// sweep of (0, 1).
+static bool encodeMatchesPow() {
+    const auto& gt = internal::gammaTables();
+    auto same = [&](uint32_t bits) {
+        float l;
+        memcpy(&l, &bits, sizeof(l));
+        return gt.encode(l) == internal::GammaTables::referenceEncode(l);
+    };
+    const uint32_t one = 0x3F800000u;
+    const uint32_t window = 1u << 14;
+    for (int k = 1; k < 256; k++) {
+        const float approx = std::pow((k - 0.5f) / 255.0f, 2.2f);
+        for (float center : {gt.threshold[k], approx}) {
+            uint32_t c;
+            memcpy(&c, &center, sizeof(c));
+            const uint32_t lo = c > window ? c - window : 1;
+            const uint32_t hi = std::min(c + window, one);
+            for (uint32_t b = lo; b < hi; b++) {
+                if (!same(b)) return false;
+            }
+        }
+    }
+    for (uint32_t b = 1; b < one; b += 251) {
+        if (!same(b)) return false;
+    }
+    return true;
+}
+
+int main() {
+    mt19937 rng(7);
+    check("GammaTables::encode == lround(pow(l, 1 / 2.2) * 255)", encodeMatchesPow());
+
+    struct Case { int w, h, ch; PixelFormat fmt; MipChain::Filter filter; const char* name; };
+    const Case cases[] = {
+        {256, 128, 4, PixelFormat::U8,  MipChain::Filter::Box,      "256x128 RGBA8"},
+        {333, 97,  4, PixelFormat::U8,  MipChain::Filter::Box,      "333x97 RGBA8 (odd sizes)"},
+        {61,  1,   1, PixelFormat::U8,  MipChain::Filter::Box,      "61x1 R8"},
+        {45,  70,  3, PixelFormat::U8,  MipChain::Filter::Box,      "45x70 RGB8"},
+        {129, 65,  4, PixelFormat::F32, MipChain::Filter::Box,      "129x65 RGBA32F"},
+        {512, 256, 4, PixelFormat::U8,  MipChain::Filter::Coverage, "512x256 glyph atlas (Coverage)"},
+    };
+
+    for (const Case& c : cases) {
+        Pixels base;
+        base.allocate(c.w, c.h, c.ch, c.fmt);
+        fillRect(base, 0, 0, c.w, c.h, rng);
+
+        MipChain chain;
+        chain.build(base, 0, c.filter);
+
+        if (c.filter == MipChain::Filter::Box) {
+            Pixels cur = base.clone();
+            Pixels ref = base.clone();
+            bool ok = chain.getNumLevels() == MipChain::computeNumLevels(c.w, c.h);
+            bool refOk = ok;
+            for (int l = 1; ok && l < chain.getNumLevels(); l++) {
+                cur.halve();
+                ref = referenceHalve(ref);
+                ok = cur.getWidth() == chain.getLevelWidth(l) && cur.getHeight() == chain.getLevelHeight(l)
+                  && memcmp(cur.getDataVoid(), chain.getLevelData(l), chain.getLevelBytes(l)) == 0;
+                refOk = refOk && memcmp(ref.getDataVoid(), cur.getDataVoid(), chain.getLevelBytes(l)) == 0;
+            }
+            check((string(c.name) + ": build == halve() chain").c_str(), ok);
+            check((string(c.name) + ": halve() == original pow/lround loop").c_str(), ok && refOk);
+        }
+
+        bool ok = true;
+        for (int i = 0; i < 40 && ok; i++) {
+            // Bias toward the last row/column, where odd sizes bite.
+            int x = (i % 4 == 0) ? c.w - 1 : (int)(rng() % c.w);
+            int y = (i % 3 == 0) ? c.h - 1 : (int)(rng() % c.h);
+            int w = 1 + (int)(rng() % std::max(1, c.w / 4));
+            int h = 1 + (int)(rng() % std::max(1, c.h / 4));
+            fillRect(base, x, y, w, h, rng);
+            chain.update(base.getDataVoid(), x, y, w, h);
+            ok = sameAsBuild(chain, base, c.filter);
+        }
+        check((string(c.name) + ": update(rect) == build()").c_str(), ok);
+    }
+
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,399 @@
+// =============================================================================
+// core/tests/pixelConv — tc::pixelconv kernels vs. the scalar loops they
+// replaced, plus a throughput report.
+//
+// Every kernel is checked against a straightforward per-pixel reference on
+// odd-sized buffers (so the SIMD body AND the scalar tail both run). Then each
+// kernel is timed on a 3840x2160 frame (or `pixelConv W H`) and reported in
+// GB/s (bytes read + written). Only the correctness checks affect the exit
+// code; the numbers are for humans comparing machines / commits.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/graphics/tcPixelConv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+static std::vector<uint8_t> randomBytes(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> v(n);
+    for (auto& b : v) b = (uint8_t)rng();
+    return v;
+}
+
+// --- scalar references (the loops that used to live at the call sites) -----
+
+static uint8_t refDiv255(uint32_t x) { return (uint8_t)std::lround(x / 255.0); }
+
+// The grabber's per-pixel YUYV loop (BT.601 limited range).
+static void refYuyvToRgba(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i += 2) {
+        const uint8_t* s = src + i * 2;
+        int y0 = s[0], u = s[1], y1 = s[2], v = s[3];
+        int d = u - 128, e = v - 128;
+        for (int k = 0; k < 2; ++k) {
+            int c = (k == 0 ? y0 : y1) - 16;
+            int r = (298 * c + 409 * e + 128) >> 8;
+            int g = (298 * c - 100 * d - 208 * e + 128) >> 8;
+            int b = (298 * c + 516 * d + 128) >> 8;
+            uint8_t* o = dst + (i + k) * 4;
+            o[0] = (uint8_t)std::clamp(r, 0, 255);
+            o[1] = (uint8_t)std::clamp(g, 0, 255);
+            o[2] = (uint8_t)std::clamp(b, 0, 255);
+            o[3] = 255;
+        }
+    }
+}
+
+// Straightforward per-pixel RGBA -> I420 (BT.709 limited, 2x2 mean chroma).
+static void refRgbaToI420(const uint8_t* src, int w, int h, uint8_t* y, uint8_t* u, uint8_t* v) {
+    const int cw = (w + 1) / 2;
+    for (int j = 0; j < h; ++j) {
+        for (int i = 0; i < w; ++i) {
+            const uint8_t* p = src + ((size_t)j * w + i) * 4;
+            y[(size_t)j * w + i] = (uint8_t)(((47 * p[0] + 157 * p[1] + 16 * p[2] + 128) >> 8) + 16);
+        }
+    }
+    for (int j = 0; j < (h + 1) / 2; ++j) {
+        for (int i = 0; i < cw; ++i) {
+            int m[3] = {0, 0, 0};
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    const int sx = std::min(i * 2 + dx, w - 1), sy = std::min(j * 2 + dy, h - 1);
+                    for (int k = 0; k < 3; ++k) m[k] += src[((size_t)sy * w + sx) * 4 + k];
+                }
+            }
+            for (int k = 0; k < 3; ++k) m[k] = (m[k] + 2) >> 2;
+            u[(size_t)j * cw + i] = (uint8_t)(((-26 * m[0] - 86 * m[1] + 112 * m[2] + 128) >> 8) + 128);
+            v[(size_t)j * cw + i] = (uint8_t)(((112 * m[0] - 102 * m[1] - 10 * m[2] + 128) >> 8) + 128);
+        }
+    }
+}
+
+static void testCorrectness() {
+    const size_t n = 1000 + 13;   // pixels; not a multiple of any vector width
+
+    {
+        auto src = randomBytes(n * 3, 1);
+        std::vector<uint8_t> dst(n * 4), ref(n * 4);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i * 4 + 0] = src[i * 3 + 0];
+            ref[i * 4 + 1] = src[i * 3 + 1];
+            ref[i * 4 + 2] = src[i * 3 + 2];
+            ref[i * 4 + 3] = 200;
+        }
+        pixelconv::rgbToRgba(src.data(), dst.data(), n, 200);
+        check("rgbToRgba matches scalar", dst == ref);
+    }
+    {
+        auto src = randomBytes(n, 2);
+        std::vector<uint8_t> dst(n * 4), ref(n * 4);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i * 4 + 0] = ref[i * 4 + 1] = ref[i * 4 + 2] = src[i];
+            ref[i * 4 + 3] = 255;
+        }
+        pixelconv::grayToRgba(src.data(), dst.data(), n);
+        check("grayToRgba matches scalar", dst == ref);
+    }
+    {
+        auto src = randomBytes(n * 2, 11);
+        std::vector<uint8_t> dst(n * 4), ref(n * 4);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i * 4 + 0] = ref[i * 4 + 1] = ref[i * 4 + 2] = src[i * 2];
+            ref[i * 4 + 3] = src[i * 2 + 1];
+        }
+        pixelconv::grayAlphaToRgba(src.data(), dst.data(), n);
+        check("grayAlphaToRgba matches scalar", dst == ref);
+    }
+    {
+        auto src = randomBytes(n * 4, 3);
+        std::vector<uint8_t> dst(n * 4), ref(n * 4), opaque(n * 4), refOpaque(n * 4);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i * 4 + 0] = src[i * 4 + 2];
+            ref[i * 4 + 1] = src[i * 4 + 1];
+            ref[i * 4 + 2] = src[i * 4 + 0];
+            ref[i * 4 + 3] = src[i * 4 + 3];
+            refOpaque[i * 4 + 0] = src[i * 4 + 2];
+            refOpaque[i * 4 + 1] = src[i * 4 + 1];
+            refOpaque[i * 4 + 2] = src[i * 4 + 0];
+            refOpaque[i * 4 + 3] = 255;
+        }
+        pixelconv::swapRB(src.data(), dst.data(), n);
+        pixelconv::swapRB(src.data(), opaque.data(), n, true);
+        check("swapRB matches scalar", dst == ref);
+        check("swapRB forceOpaque matches scalar", opaque == refOpaque);
+        auto inPlace = src;
+        pixelconv::swapRB(inPlace.data(), inPlace.data(), n);
+        check("swapRB in place", inPlace == ref);
+    }
+    {
+        std::vector<uint8_t> src(256 + 7);
+        for (size_t i = 0; i < src.size(); ++i) src[i] = (uint8_t)i;
+        std::vector<float> f(src.size());
+        pixelconv::u8ToF32(src.data(), f.data(), src.size());
+        bool ok = true;
+        for (size_t i = 0; i < src.size(); ++i) {
+            ok &= std::fabs(f[i] - src[i] / 255.0f) <= 1e-7f;
+        }
+        check("u8ToF32 within 1 ulp of x / 255", ok);
+
+        std::vector<uint8_t> back(src.size());
+        pixelconv::f32ToU8(f.data(), back.data(), f.size());
+        check("f32ToU8(u8ToF32(x)) == x", back == src);
+    }
+    {
+        std::vector<float> f = { -1.0f, 0.0f, 0.5f / 255.0f, 0.499f, 0.5f, 1.0f, 2.0f, NAN,
+                                 0.25f, 0.75f, 1e-9f, 0.999f, -0.0f, 0.1f, 0.2f, 0.3f, 0.9f };
+        std::vector<uint8_t> dst(f.size()), ref(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            float v = std::isnan(f[i]) ? 0.0f : std::min(std::max(f[i], 0.0f), 1.0f);
+            ref[i] = (uint8_t)(int)(v * 255.0f + 0.5f);
+        }
+        pixelconv::f32ToU8(f.data(), dst.data(), f.size());
+        check("f32ToU8 clamps and rounds (incl. NaN)", dst == ref);
+    }
+    {
+        std::vector<uint16_t> src(65536 + 7);
+        for (size_t i = 0; i < src.size(); ++i) src[i] = (uint16_t)(i * 40503u);
+        std::vector<uint8_t> dst(src.size()), ref(src.size());
+        for (size_t i = 0; i < src.size(); ++i) ref[i] = (uint8_t)(src[i] >> 8);
+        pixelconv::u16ToU8(src.data(), dst.data(), src.size());
+        check("u16ToU8 == x >> 8", dst == ref);
+    }
+    {
+        auto src = randomBytes(n * 4, 4);
+        std::vector<uint8_t> dst(n * 4), ref(n * 4);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t a = src[i * 4 + 3];
+            for (int c = 0; c < 3; ++c) ref[i * 4 + c] = refDiv255(src[i * 4 + c] * a);
+            ref[i * 4 + 3] = (uint8_t)a;
+        }
+        pixelconv::premultiply(src.data(), dst.data(), n);
+        check("premultiply RGBA8 == round(c * a / 255)", dst == ref);
+
+        // Every (c, a) pair exhaustively.
+        std::vector<uint8_t> all(256 * 256 * 4), allOut(all.size());
+        for (int a = 0; a < 256; ++a) {
+            for (int c = 0; c < 256; ++c) {
+                uint8_t* p = &all[((size_t)a * 256 + c) * 4];
+                p[0] = p[1] = p[2] = (uint8_t)c;
+                p[3] = (uint8_t)a;
+            }
+        }
+        pixelconv::premultiply(all.data(), allOut.data(), 256 * 256);
+        bool ok = true;
+        for (int a = 0; a < 256; ++a) {
+            for (int c = 0; c < 256; ++c) {
+                const uint8_t* p = &allOut[((size_t)a * 256 + c) * 4];
+                ok &= p[0] == refDiv255(c * a) && p[3] == a;
+            }
+        }
+        check("premultiply RGBA8 exhaustive (c, a)", ok);
+
+        std::vector<uint8_t> un(allOut.size());
+        pixelconv::unpremultiply(allOut.data(), un.data(), 256 * 256);
+        ok = true;
+        for (int a = 1; a < 256; ++a) {
+            for (int c = 0; c < 256; ++c) {
+                const uint8_t* p = &un[((size_t)a * 256 + c) * 4];
+                // Premultiplying by a loses precision; the round trip is
+                // within half a premultiplied step (255 / 2a) of the input.
+                ok &= std::abs((int)p[0] - c) <= (int)std::ceil(127.5 / a);
+            }
+        }
+        check("unpremultiply(premultiply(c)) round-trips", ok);
+    }
+    {
+        std::vector<float> src(n * 4), dst(n * 4), back(n * 4);
+        std::mt19937 rng(5);
+        for (auto& v : src) v = (rng() % 1001) / 1000.0f;
+        pixelconv::premultiply(src.data(), dst.data(), n);
+        pixelconv::unpremultiply(dst.data(), back.data(), n);
+        bool ok = true;
+        for (size_t i = 0; i < n; ++i) {
+            float a = src[i * 4 + 3];
+            for (int c = 0; c < 3; ++c) {
+                ok &= dst[i * 4 + c] == src[i * 4 + c] * a;
+                if (a > 0.01f) ok &= std::fabs(back[i * 4 + c] - src[i * 4 + c]) < 1e-4f;
+            }
+            ok &= dst[i * 4 + 3] == a;
+        }
+        check("premultiply / unpremultiply RGBA32F", ok);
+    }
+    {
+        auto src = randomBytes(n * 4, 6);
+        bool ok = true;
+        for (int c = 0; c < 4; ++c) {
+            std::vector<uint8_t> plane(n);
+            pixelconv::extractChannel(src.data(), 4, c, plane.data(), n);
+            for (size_t i = 0; i < n; ++i) ok &= plane[i] == src[i * 4 + c];
+        }
+        std::vector<uint16_t> depth(n * 2), plane16(n);
+        for (size_t i = 0; i < depth.size(); ++i) depth[i] = (uint16_t)(i * 7);
+        pixelconv::extractChannel(depth.data(), 2, 1, plane16.data(), n);
+        for (size_t i = 0; i < n; ++i) ok &= plane16[i] == depth[i * 2 + 1];
+        check("extractChannel (u8 RGBA, u16 2-ch)", ok);
+    }
+    {
+        const size_t m = n & ~(size_t)1;   // YUYV comes in pixel pairs
+        auto src = randomBytes(m * 2, 10);
+        std::vector<uint8_t> dst(m * 4), ref(m * 4);
+        pixelconv::yuyvToRgba(src.data(), dst.data(), m);
+        refYuyvToRgba(src.data(), ref.data(), m);
+        check("yuyvToRgba matches the grabber's scalar loop", dst == ref);
+
+        // Every (y, u, v) corner the clamps care about.
+        std::vector<uint8_t> edge;
+        for (int y : {0, 16, 128, 235, 255})
+            for (int u : {0, 16, 128, 240, 255})
+                for (int v : {0, 16, 128, 240, 255}) edge.insert(edge.end(), {(uint8_t)y, (uint8_t)u, (uint8_t)(255 - y), (uint8_t)v});
+        const size_t e = edge.size() / 2;
+        std::vector<uint8_t> edgeOut(e * 4), edgeRef(e * 4);
+        pixelconv::yuyvToRgba(edge.data(), edgeOut.data(), e);
+        refYuyvToRgba(edge.data(), edgeRef.data(), e);
+        check("yuyvToRgba clamps like the scalar loop", edgeOut == edgeRef);
+
+        std::vector<uint8_t> y(m), uv(m);
+        pixelconv::yuyvToPlanes(src.data(), y.data(), uv.data(), m);
+        bool ok = true;
+        for (size_t i = 0; i < m; ++i) ok &= y[i] == src[i * 2] && uv[i] == src[i * 2 + 1];
+        check("yuyvToPlanes splits Y and interleaved UV", ok);
+    }
+    {
+        // Odd sizes: the SIMD body, the scalar tail and the self-paired last
+        // row / column all run. Padded destination strides.
+        bool okI420 = true, okNv12 = true, okGray = true;
+        for (auto [w, h] : {std::pair{37, 11}, std::pair{64, 2}, std::pair{1, 1}, std::pair{50, 7}}) {
+            const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+            auto src = randomBytes((size_t)w * h * 4, 11 + w);
+            std::vector<uint8_t> ry((size_t)w * h), ru((size_t)cw * ch), rv((size_t)cw * ch);
+            refRgbaToI420(src.data(), w, h, ry.data(), ru.data(), rv.data());
+
+            const size_t ys = w + 3, cs = cw + 5, uvs = cw * 2 + 2;
+            std::vector<uint8_t> y(ys * h), u(cs * ch), v(cs * ch), y2(ys * h), uv(uvs * ch);
+            pixelconv::rgbaToI420(src.data(), (size_t)w * 4, w, h, y.data(), ys, u.data(), cs, v.data(), cs);
+            pixelconv::rgbaToNv12(src.data(), (size_t)w * 4, w, h, y2.data(), ys, uv.data(), uvs);
+            for (int j = 0; j < h; ++j)
+                for (int i = 0; i < w; ++i) {
+                    okI420 &= y[j * ys + i] == ry[(size_t)j * w + i];
+                    okNv12 &= y2[j * ys + i] == ry[(size_t)j * w + i];
+                }
+            for (int j = 0; j < ch; ++j)
+                for (int i = 0; i < cw; ++i) {
+                    okI420 &= u[j * cs + i] == ru[(size_t)j * cw + i] && v[j * cs + i] == rv[(size_t)j * cw + i];
+                    okNv12 &= uv[j * uvs + i * 2] == ru[(size_t)j * cw + i] &&
+                              uv[j * uvs + i * 2 + 1] == rv[(size_t)j * cw + i];
+                }
+        }
+        // Neutral greys keep neutral chroma; black / white hit 16 / 235.
+        for (int g : {0, 1, 127, 128, 254, 255}) {
+            std::vector<uint8_t> src(32 * 2 * 4, (uint8_t)g), y(32 * 2), u(16), v(16);
+            pixelconv::rgbaToI420(src.data(), 32 * 4, 32, 2, y.data(), 32, u.data(), 16, v.data(), 16);
+            okGray &= u[3] == 128 && v[3] == 128;
+            if (g == 0) okGray &= y[0] == 16;
+            if (g == 255) okGray &= y[0] == 235;
+        }
+        check("rgbaToI420 matches scalar (odd sizes, strides)", okI420);
+        check("rgbaToNv12 matches scalar (odd sizes, strides)", okNv12);
+        check("rgbaToI420 greys: neutral chroma, 16..235 luma", okGray);
+    }
+}
+
+// --- throughput ---------------------------------------------------------------
+
+static void bench(const char* name, size_t bytesMoved, const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();  // warm-up (page faults, caches)
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 3) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    double perIter = elapsed / iters;
+    printf("  %-28s %7.2f ms/frame  %6.2f GB/s\n", name, perIter * 1e3, bytesMoved / perIter / 1e9);
+}
+
+static void benchmark(size_t w, size_t h) {
+    const size_t n = w * h;
+    printf("\nthroughput, %zux%zu (bytes read + written):\n", w, h);
+
+    auto rgba = randomBytes(n * 4, 7);
+    auto rgb  = randomBytes(n * 3, 8);
+    auto gray = randomBytes(n, 9);
+    std::vector<uint8_t> out(n * 4), plane(n), uv(n);
+    std::vector<float> f(n * 4);
+    std::vector<uint16_t> u16(n);
+
+    bench("rgbToRgba", n * 7, [&] { pixelconv::rgbToRgba(rgb.data(), out.data(), n); });
+    bench("grayToRgba", n * 5, [&] { pixelconv::grayToRgba(gray.data(), out.data(), n); });
+    bench("grayAlphaToRgba", n * 6, [&] { pixelconv::grayAlphaToRgba(rgba.data(), out.data(), n); });
+    bench("swapRB", n * 8, [&] { pixelconv::swapRB(rgba.data(), out.data(), n); });
+    bench("u8ToF32", n * 4 * 5, [&] { pixelconv::u8ToF32(rgba.data(), f.data(), n * 4); });
+    bench("f32ToU8", n * 4 * 5, [&] { pixelconv::f32ToU8(f.data(), out.data(), n * 4); });
+    bench("u16ToU8", n * 3, [&] { pixelconv::u16ToU8(u16.data(), out.data(), n); });
+    bench("premultiply (u8)", n * 8, [&] { pixelconv::premultiply(rgba.data(), out.data(), n); });
+    bench("unpremultiply (u8)", n * 8, [&] { pixelconv::unpremultiply(rgba.data(), out.data(), n); });
+    bench("premultiply (f32)", n * 32, [&] { pixelconv::premultiply(f.data(), f.data(), n); });
+    bench("extractChannel (u8, A)", n * 5, [&] { pixelconv::extractChannel(rgba.data(), 4, 3, plane.data(), n); });
+    bench("yuyvToRgba", n * 6, [&] { pixelconv::yuyvToRgba(rgba.data(), out.data(), n & ~(size_t)1); });
+    {
+        std::vector<uint8_t> u((w + 1) / 2 * ((h + 1) / 2)), v(u.size());
+        bench("rgbaToI420", n * 4 + n * 3 / 2, [&] {
+            pixelconv::rgbaToI420(rgba.data(), w * 4, w, h, plane.data(), w, u.data(), (w + 1) / 2, v.data(), (w + 1) / 2);
+        });
+        bench("rgbaToNv12", n * 4 + n * 3 / 2, [&] {
+            pixelconv::rgbaToNv12(rgba.data(), w * 4, w, h, plane.data(), w, uv.data(), (w + 1) / 2 * 2);
+        });
+        bench("rgbaToI420 (scalar ref)", n * 4 + n * 3 / 2, [&] {
+            refRgbaToI420(rgba.data(), (int)w, (int)h, plane.data(), u.data(), v.data());
+        });
+    }
+    bench("yuyvToPlanes", n * 4, [&] { pixelconv::yuyvToPlanes(rgba.data(), plane.data(), uv.data(), n & ~(size_t)1); });
+
+    // The per-pixel loop swapRB replaced, for comparison.
+    bench("swapRB (old scalar loop)", n * 8, [&] {
+        const uint8_t* s = rgba.data();
+        uint8_t* d = out.data();
+        for (size_t i = 0; i < n; ++i) {
+            d[i * 4 + 0] = s[i * 4 + 2];
+            d[i * 4 + 1] = s[i * 4 + 1];
+            d[i * 4 + 2] = s[i * 4 + 0];
+            d[i * 4 + 3] = s[i * 4 + 3];
+        }
+    });
+    bench("yuyvToRgba (old scalar loop)", n * 6, [&] { refYuyvToRgba(rgba.data(), out.data(), n & ~(size_t)1); });
+}
+
+// Usage: pixelConv [width height]   (benchmark frame size, default 3840x2160)
+int main(int argc, char** argv) {
+    size_t w = 3840, h = 2160;
+    if (argc >= 3) {
+        w = (size_t)std::strtoul(argv[1], nullptr, 10);
+        h = (size_t)std::strtoul(argv[2], nullptr, 10);
+    }
+    testCorrectness();
+    benchmark(w, h);
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
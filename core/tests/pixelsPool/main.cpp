@@ -0,0 +1,258 @@
+// =============================================================================
+// core/tests/pixelsPool — PixelsPool reuse / alignment / accounting, Pixels
+// borrowing from a pool, plus a per-frame allocation benchmark.
+//
+// The checks cover what video producers rely on: blocks are 64-byte aligned,
+// a released block is handed out again for the next same-sized frame, a
+// pooled Pixels returns its block on clear / destruction / move-assign, the
+// pool outlives the producer while frames are still out, and the high-water
+// mark equals the deepest queue. The benchmark compares a fresh new[] per
+// 1080p / 4K frame with pooled storage (informational only).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tcColor.h"   // tcPixels.h expects Color (TrussC.h includes it first)
+#include "tc/graphics/tcPixels.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <thread>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+static bool aligned(const void* p, size_t a) { return ((uintptr_t)p % a) == 0; }
+
+static void testSizeClasses() {
+    bool ok = true;
+    size_t prev = 0;
+    for (size_t n = 1; n < (64u << 20); n += 1 + n / 7) {
+        size_t c = PixelsPool::sizeClass(n);
+        ok &= c >= n && c % PixelsPool::kAlignment == 0;
+        ok &= c <= n + n / 4 + PixelsPool::kAlignment;   // at most 25% slack
+        ok &= c >= prev;
+        prev = c;
+    }
+    check("sizeClass: >= request, 64-byte multiple, <= 25% slack", ok);
+    check("sizeClass: 1080p and 1088p RGBA share a class",
+          PixelsPool::sizeClass(1920 * 1080 * 4) == PixelsPool::sizeClass(1920 * 1088 * 4));
+}
+
+static void testAcquireRelease() {
+    PixelsPool pool;
+    bool ok = true;
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t n : {1u, 63u, 100u, 4097u, 640u * 480 * 4, 1920u * 1080 * 3}) {
+        size_t cap = 0;
+        void* p = pool.acquire(n, cap);
+        ok &= p && aligned(p, PixelsPool::kAlignment) && cap >= n;
+        std::memset(p, 0xab, n);
+        blocks.push_back({p, cap});
+    }
+    check("acquire: 64-byte aligned, capacity >= request", ok);
+
+    auto s = pool.getStats();
+    check("stats: 6 blocks in use, none cached", s.blocksInUse == 6 && s.bytesCached == 0);
+
+    for (auto& [p, cap] : blocks) pool.release(p, cap);
+    s = pool.getStats();
+    check("release: everything back on the free lists",
+          s.blocksInUse == 0 && s.bytesInUse == 0 && s.bytesCached == s.peakBytesInUse);
+
+    size_t cap = 0;
+    void* again = pool.acquire(640 * 480 * 4, cap);
+    check("acquire after release reuses the block", again == blocks[4].first && pool.getStats().reused == 1);
+    pool.release(again, cap);
+
+    pool.trim();
+    check("trim empties the free lists", pool.getStats().bytesCached == 0);
+    check("acquire(0) returns nullptr", pool.acquire(0, cap) == nullptr && cap == 0);
+}
+
+static void testPixelsBorrow() {
+    auto pool = std::make_shared<PixelsPool>();
+    {
+        Pixels px;
+        px.allocate(320, 240, 4, PixelFormat::U8, pool);
+        const void* first = px.getData();
+        check("pooled Pixels: allocated, aligned, pool recorded",
+              px.isAllocated() && aligned(first, 64) && px.getPool() == pool
+              && px.getTotalBytes() == 320 * 240 * 4);
+
+        px.allocate(300, 240, 4, PixelFormat::U8, pool);
+        check("re-allocate smaller keeps the block", px.getData() == first && px.getWidth() == 300);
+
+        px.allocate(16, 16, 4, PixelFormat::F32, pool);
+        check("F32 from a pool", px.isFloat() && aligned(px.getDataF32(), 64));
+
+        px.clear();
+        auto s = pool->getStats();
+        check("clear() returns the block", s.blocksInUse == 0 && !px.getPool());
+
+        px.allocate(8, 8);
+        check("plain allocate after pooled one is not pooled", !px.getPool() && px.getData()[0] == 0);
+    }
+    {
+        Pixels a;
+        a.allocate(64, 64, 4, PixelFormat::U8, pool);
+        Pixels b = std::move(a);
+        check("move carries the pool", b.getPool() == pool && !a.getPool() && !a.getData());
+        Pixels c;
+        c.allocate(64, 64, 4, PixelFormat::U8, pool);
+        c = std::move(b);
+        check("move-assign releases the overwritten block", pool->getStats().blocksInUse == 1);
+    }
+    check("destruction returns the block", pool->getStats().blocksInUse == 0);
+
+    // Frames can outlive the producer (e.g. a VideoGrabber closed while the
+    // app still holds queued frames): the Pixels keep the pool alive.
+    Pixels orphan;
+    std::weak_ptr<PixelsPool> watch;
+    {
+        auto shortLived = std::make_shared<PixelsPool>();
+        watch = shortLived;
+        orphan.allocate(128, 128, 4, PixelFormat::U8, shortLived);
+    }
+    const bool alive = !watch.expired();
+    std::memset(orphan.getData(), 1, orphan.getTotalBytes());
+    orphan.clear();
+    check("Pixels keep their pool alive until the last block returns", alive && watch.expired());
+}
+
+// A producer thread pushing frames into a bounded queue (dropping the oldest,
+// like GrabberFrameQueue) while the main thread drains it.
+static void testProducerConsumer() {
+    auto pool = std::make_shared<PixelsPool>();
+    std::mutex mtx;
+    std::deque<Pixels> queue;
+    const size_t cap = 4;
+    const int frames = 2000;
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int i = 0; i < frames; i++) {
+            Pixels f;
+            f.allocate(64, 48, 4, PixelFormat::U8, pool);
+            std::memset(f.getData(), i & 0xff, f.getTotalBytes());
+            std::lock_guard<std::mutex> lock(mtx);
+            while (queue.size() >= cap) queue.pop_front();
+            queue.push_back(std::move(f));
+        }
+        done = true;
+    });
+    bool finished = false;
+    while (!finished) {
+        finished = done.load();
+        std::deque<Pixels> got;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            got.swap(queue);
+        }
+        if (got.empty()) std::this_thread::yield();
+    }
+    producer.join();
+    auto s = pool->getStats();
+    check("producer/consumer: all blocks returned", s.blocksInUse == 0 && s.bytesInUse == 0);
+    check("producer/consumer: steady state reuses blocks", s.allocated <= cap + 3 && s.reused >= frames - cap - 3);
+    printf("  (%zu system allocations for %d frames, peak %zu blocks)\n",
+           s.allocated, frames, s.peakBlocksInUse);
+}
+
+static void testHighWater() {
+    auto pool = std::make_shared<PixelsPool>();
+    std::deque<Pixels> queue;
+    for (int depth : {2, 5, 3}) {
+        while ((int)queue.size() < depth) {
+            queue.emplace_back();
+            queue.back().allocate(100, 100, 4, PixelFormat::U8, pool);
+        }
+        while ((int)queue.size() > 1) queue.pop_front();
+    }
+    auto s = pool->getStats();
+    check("high-water mark = deepest queue", s.peakBlocksInUse == 5
+          && s.peakBytesInUse == 5 * PixelsPool::sizeClass(100 * 100 * 4));
+    pool->resetPeak();
+    check("resetPeak drops to the current use", pool->getStats().peakBlocksInUse == 1);
+}
+
+static void testHugePages() {
+    PixelsPool pool;
+    pool.setHugePages(true);
+    size_t cap = 0;
+    void* p = pool.acquire(3840 * 2160 * 4, cap);
+#if defined(__linux__)
+    check("huge pages: 2 MiB aligned, capacity in whole huge pages",
+          p && aligned(p, 2u << 20) && cap % (2u << 20) == 0 && pool.getHugePages());
+#else
+    check("huge pages: ignored off Linux", p && !pool.getHugePages());
+#endif
+    std::memset(p, 0, cap);
+    pool.release(p, cap);
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static double bench(const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 5) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    return elapsed / iters;
+}
+
+static void benchmark() {
+    printf("\nper-frame allocate + fill + free:\n");
+    for (auto [w, h] : {std::pair{1920, 1080}, std::pair{3840, 2160}}) {
+        const size_t bytes = (size_t)w * h * 4;
+        double plain = bench([&] {
+            Pixels f;
+            f.allocate(w, h, 4);
+            std::memset(f.getData(), 1, bytes);
+        });
+        auto pool = std::make_shared<PixelsPool>();
+        double pooled = bench([&] {
+            Pixels f;
+            f.allocate(w, h, 4, PixelFormat::U8, pool);
+            std::memset(f.getData(), 1, bytes);
+        });
+        pool->setHugePages(true);
+        pool->trim();
+        double huge = bench([&] {
+            Pixels f;
+            f.allocate(w, h, 4, PixelFormat::U8, pool);
+            std::memset(f.getData(), 1, bytes);
+        });
+        printf("  %4dx%-4d  new[]: %6.3f ms   pool: %6.3f ms   pool+huge: %6.3f ms\n",
+               w, h, plain * 1e3, pooled * 1e3, huge * 1e3);
+    }
+}
+
+int main() {
+    testSizeClasses();
+    testAcquireRelease();
+    testPixelsBorrow();
+    testProducerConsumer();
+    testHighWater();
+    testHugePages();
+    benchmark();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,636 @@
+// =============================================================================
+// core/tests/soundMix — tc::soundmix block kernels vs. the per-frame eager
+// mixer they replaced, plus a 256-voice benchmark.
+//
+// The reference below is the old AudioEngine::mixEagerVoice() loop and the old
+// clip + analysis copy, verbatim apart from taking plain arguments. Every
+// routing case (mono broadcast, N -> N, downmix, explicit map with invalid
+// and summed entries, gains, pan) is mixed at forward / reverse / freeze /
+// non-integer speeds, looping and not, starting near the ends, over several
+// callbacks — and must match bit for bit, including the play head and the
+// "ran off the end" result.
+//
+// The windowed-sinc resampler is measured against the ideal band-limited
+// output: passband error for slowed-down / 44.1k -> 48k sines and alias
+// rejection for a pitched-up one, at every quality.
+//
+// The voice management decisions (tcSoundVoices.h) are checked directly:
+// real / virtual ranking and counts, the threshold and rank-cutoff
+// hysteresis, every steal policy with priority protection, and the fade ramp.
+//
+// The benchmark mixes 256 stereo voices into a 512-frame stereo block with the
+// old loop and the block kernels, then 128 voices at each resampler quality
+// (informational only).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/sound/tcSoundMix.h"
+#include "tc/sound/tcSoundVoices.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// --- reference (the old per-frame loop) --------------------------------------
+
+struct RefVoice {
+    const std::vector<float>* samples;
+    size_t numSamples;
+    int channels;
+    double posF = 0.0;
+    double posStep = 1.0;
+    bool loop = false;
+    bool playing = true;
+    float pan = 0.0f;
+    float vol = 1.0f;
+    const std::vector<std::vector<int>>* map = nullptr;
+    const std::vector<float>* gains = nullptr;
+    bool downmix = false;
+};
+
+static void refMix(RefVoice& v, float* buffer, int num_frames, int num_channels) {
+    double posF = v.posF;
+    float vol = v.vol;
+    float pan = v.pan;
+    double posStep = v.posStep;
+    double srcLen = (double)v.numSamples;
+    float panL = (pan <= 0.0f) ? 1.0f : (1.0f - pan);
+    float panR = (pan >= 0.0f) ? 1.0f : (1.0f + pan);
+    const int srcCh = v.channels;
+    const int mapSize = v.map ? (int)v.map->size() : 0;
+    const int gainsSize = v.gains ? (int)v.gains->size() : 0;
+    const auto& samples = *v.samples;
+
+    for (int frame = 0; frame < num_frames; frame++) {
+        if (posF < 0.0) {
+            if (v.loop) {
+                posF += srcLen;
+                if (posF < 0.0) posF = std::fmod(posF, srcLen) + srcLen;
+            } else {
+                v.playing = false;
+                break;
+            }
+        }
+        if (posF >= srcLen) {
+            if (v.loop) {
+                posF -= srcLen;
+                if (posF >= srcLen) posF = std::fmod(posF, srcLen);
+            } else {
+                v.playing = false;
+                break;
+            }
+        }
+
+        size_t pos0 = (size_t)posF;
+        size_t pos1 = pos0 + 1;
+        float frac = (float)(posF - (double)pos0);
+        if (pos1 >= v.numSamples) pos1 = v.loop ? 0 : pos0;
+
+        auto srcAt = [&](int s) -> float {
+            if (s < 0 || s >= srcCh) return 0.0f;
+            float a = samples[pos0 * (size_t)srcCh + (size_t)s];
+            float b = samples[pos1 * (size_t)srcCh + (size_t)s];
+            return a + (b - a) * frac;
+        };
+
+        for (int c = 0; c < num_channels; c++) {
+            float sample = 0.0f;
+            if (mapSize > 0) {
+                if (c < mapSize) {
+                    for (int s : (*v.map)[c]) sample += srcAt(s);
+                }
+            } else if (v.downmix) {
+                for (int s = 0; s < srcCh; s++) sample += srcAt(s);
+                if (srcCh > 0) sample /= (float)srcCh;
+            } else {
+                if (srcCh == 1) sample = srcAt(0);
+                else sample = (c < srcCh) ? srcAt(c) : 0.0f;
+            }
+            float gain = (c < gainsSize) ? (*v.gains)[c] : 1.0f;
+            float panMul = (c == 0) ? panL : ((c == 1) ? panR : 1.0f);
+            buffer[frame * num_channels + c] += sample * gain * panMul * vol;
+        }
+        posF += posStep;
+    }
+    v.posF = posF;
+}
+
+static void refClipAndTap(float* buffer, int num_frames, int num_channels,
+                          std::vector<float>& ring, size_t& writePos) {
+    for (int i = 0; i < num_frames * num_channels; i++) {
+        if (buffer[i] > 1.0f) buffer[i] = 1.0f;
+        if (buffer[i] < -1.0f) buffer[i] = -1.0f;
+    }
+    for (int frame = 0; frame < num_frames; frame++) {
+        float mono = num_channels > 1
+            ? (buffer[frame * num_channels] + buffer[frame * num_channels + 1]) * 0.5f
+            : buffer[frame * num_channels];
+        ring[writePos] = mono;
+        writePos = (writePos + 1) % ring.size();
+    }
+}
+
+// --- kernels under test --------------------------------------------------------
+
+static bool newMix(RefVoice& v, float* buffer, int num_frames, int num_channels) {
+    soundmix::Source src;
+    src.samples = v.samples->data();
+    src.numFrames = v.numSamples;
+    src.channels = v.channels;
+    soundmix::Routing r;
+    r.map = v.map && !v.map->empty() ? v.map : nullptr;
+    r.gains = v.gains;
+    r.downmixMono = v.downmix;
+    r.panL = (v.pan <= 0.0f) ? 1.0f : (1.0f - v.pan);
+    r.panR = (v.pan >= 0.0f) ? 1.0f : (1.0f + v.pan);
+    r.volume = v.vol;
+    if (!soundmix::mixLinear(src, v.posF, v.posStep, v.loop, r, buffer, num_frames, num_channels)) {
+        v.playing = false;
+    }
+    return v.playing;
+}
+
+static std::vector<float> randomSignal(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto& x : v) x = d(rng);
+    return v;
+}
+
+static bool sameBits(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+// Mix `blocks` callbacks of one voice configuration both ways.
+static bool matches(RefVoice base, int outCh, int blockFrames, int blocks) {
+    RefVoice a = base, b = base;
+    std::vector<float> outA((size_t)blockFrames * outCh), outB(outA.size());
+    // Pre-existing mix content, like earlier voices in the same callback.
+    auto prior = randomSignal(outA.size(), 99);
+    for (int blk = 0; blk < blocks; blk++) {
+        outA = prior;
+        outB = prior;
+        if (a.playing) refMix(a, outA.data(), blockFrames, outCh);
+        if (b.playing) newMix(b, outB.data(), blockFrames, outCh);
+        if (!sameBits(outA, outB) || a.playing != b.playing) return false;
+        if (std::memcmp(&a.posF, &b.posF, sizeof(double)) != 0) return false;
+    }
+    return true;
+}
+
+static void testRouting() {
+    const size_t frames = 1000;
+    auto mono = randomSignal(frames, 1);
+    auto stereo = randomSignal(frames * 2, 2);
+    auto six = randomSignal(frames * 6, 3);
+    const std::vector<float> gains = {0.5f, 1.25f, 0.0f, -1.0f};
+    const std::vector<std::vector<int>> mapSwap = {{1}, {0}};
+    const std::vector<std::vector<int>> mapMixed = {{0, 1, 7}, {}, {-1, 2}, {3, 3}, {5}};
+    const double steps[] = {1.0, 0.5, 1.37, 2.0, 0.0, -1.0, -0.73, 1.0 / 3.0, 7.9};
+    const double starts[] = {0.0, 12.25, 990.5, 999.0};
+
+    struct Case {
+        const char* name;
+        const std::vector<float>* samples;
+        int channels;
+        int outCh;
+        const std::vector<std::vector<int>>* map;
+        bool downmix;
+    };
+    const Case cases[] = {
+        {"mono -> stereo broadcast", &mono, 1, 2, nullptr, false},
+        {"mono -> 6ch broadcast", &mono, 1, 6, nullptr, false},
+        {"stereo -> stereo", &stereo, 2, 2, nullptr, false},
+        {"stereo -> mono (truncate)", &stereo, 2, 1, nullptr, false},
+        {"6ch -> 8ch (silent extra outputs)", &six, 6, 8, nullptr, false},
+        {"stereo downmix -> stereo", &stereo, 2, 2, nullptr, true},
+        {"6ch downmix -> stereo", &six, 6, 2, nullptr, true},
+        {"mono downmix -> mono", &mono, 1, 1, nullptr, true},
+        {"explicit map: swap L/R", &stereo, 2, 2, &mapSwap, false},
+        {"explicit map: sums, invalid + empty entries", &six, 6, 6, &mapMixed, false},
+        {"explicit map wider than output", &six, 6, 2, &mapMixed, false},
+    };
+
+    for (const Case& c : cases) {
+        bool ok = true;
+        for (double step : steps) {
+            for (double start : starts) {
+                for (bool loop : {false, true}) {
+                    for (float pan : {0.0f, -0.4f, 0.7f}) {
+                        RefVoice v;
+                        v.samples = c.samples;
+                        v.numSamples = frames;
+                        v.channels = c.channels;
+                        v.posF = start;
+                        v.posStep = step;
+                        v.loop = loop;
+                        v.pan = pan;
+                        v.vol = 0.8f;
+                        v.map = c.map;
+                        v.downmix = c.downmix;
+                        v.gains = (pan == 0.7f) ? &gains : nullptr;
+                        ok &= matches(v, c.outCh, 512, 5);
+                        ok &= matches(v, c.outCh, 97, 3);   // runs shorter than RUN_FRAMES
+                    }
+                }
+            }
+        }
+        char name[96];
+        snprintf(name, sizeof(name), "bit-identical: %s", c.name);
+        check(name, ok);
+    }
+}
+
+static void testEdges() {
+    auto mono = randomSignal(1, 5);
+    RefVoice v;
+    v.samples = &mono;
+    v.numSamples = 1;
+    v.channels = 1;
+    v.loop = true;
+    v.posStep = 0.3;
+    check("bit-identical: 1-frame looping source", matches(v, 2, 64, 4));
+
+    std::vector<float> empty;
+    RefVoice e;
+    e.samples = &empty;
+    e.numSamples = 0;
+    e.channels = 1;
+    std::vector<float> out(8, 0.25f);
+    check("empty source stops without touching the mix",
+          !newMix(e, out.data(), 4, 2) && out == std::vector<float>(8, 0.25f));
+}
+
+static void testClipAndTap() {
+    bool ok = true;
+    for (int ch : {1, 2, 6}) {
+        const int frames = 700;
+        auto buf = randomSignal((size_t)frames * ch, 7 + ch);
+        for (auto& x : buf) x *= 3.0f;
+        buf[3] = NAN;
+        auto ref = buf;
+        std::vector<float> ringA(4096, 0.0f), ringB(4096, 0.0f);
+        size_t posA = 3900, posB = 3900;   // wraps mid-block
+        refClipAndTap(ref.data(), frames, ch, ringA, posA);
+        soundmix::clipAndTap(buf.data(), frames, ch, ringB.data(), ringB.size(), posB);
+        ok &= std::memcmp(buf.data(), ref.data(), buf.size() * sizeof(float)) == 0;
+        ok &= sameBits(ringA, ringB) && posA == posB;
+    }
+    check("clipAndTap == clip pass + analysis copy (incl. NaN, wrap)", ok);
+}
+
+// --- windowed sinc -------------------------------------------------------------
+
+static const int kQualities[] = {0, 8, 16, 32, 64};   // 0 = linear
+
+// Mix a mono sine of `freq` cycles per source frame at `step`, return the
+// output (one channel) and the ideal band-limited result.
+static void resampleSine(int taps, double freq, double step, int frames,
+                         std::vector<float>& got, std::vector<float>& ideal) {
+    const int srcLen = 40000;
+    std::vector<float> sine(srcLen);
+    for (int i = 0; i < srcLen; i++) sine[i] = (float)std::sin(2.0 * M_PI * freq * i);
+    soundmix::Source src;
+    src.samples = sine.data();
+    src.numFrames = srcLen;
+    src.channels = 1;
+    soundmix::Routing r;
+    got.assign(frames, 0.0f);
+    ideal.assign(frames, 0.0f);
+    double pos = step < 0.0 ? 30000.25 : 1000.25, p = pos;   // clear of the source ends
+    for (int k = 0; k < frames; k++, p += step) {
+        // Content above the output Nyquist must be removed, not folded.
+        ideal[k] = freq * std::fabs(step) < 0.5 ? (float)std::sin(2.0 * M_PI * freq * p) : 0.0f;
+    }
+    if (taps == 0) soundmix::mixLinear(src, pos, step, false, r, got.data(), frames, 1);
+    else soundmix::mixSinc(src, pos, step, false, *soundmix::SincTable::get(taps), r, got.data(), frames, 1);
+}
+
+static double errorDb(const std::vector<float>& got, const std::vector<float>& ideal) {
+    double err = 0.0;
+    for (size_t i = 0; i < got.size(); i++) err += (double)(got[i] - ideal[i]) * (got[i] - ideal[i]);
+    return 10.0 * std::log10(err / got.size() / 0.5 + 1e-30);   // relative to a full-scale sine
+}
+
+static void testSinc() {
+    check("SincTable: get() builds once, find() returns it",
+          soundmix::SincTable::find(16) == nullptr
+          && soundmix::SincTable::get(16) == soundmix::SincTable::find(16)
+          && soundmix::SincTable::get(12) == soundmix::SincTable::find(16)
+          && soundmix::SincTable::get(0) == nullptr);
+
+    bool unity = true;
+    for (int taps : {8, 16, 32, 64}) {
+        const auto* t = soundmix::SincTable::get(taps);
+        float coef[64];
+        for (int band : {0, 5, 9}) {
+            for (float frac : {0.0f, 0.37f, 0.999f}) {
+                t->coefficients(band, frac, coef);
+                float sum = 0.0f;
+                for (int k = 0; k < taps; k++) sum += coef[k];
+                unity &= std::fabs(sum - 1.0f) < 1e-4f;
+            }
+        }
+    }
+    check("SincTable: unity DC gain for every band / phase", unity);
+
+    printf("  error vs ideal (dB re full scale):   linear   sinc8  sinc16  sinc32  sinc64\n");
+    struct Probe { const char* name; double freq, step; };
+    const Probe probes[] = {
+        {"passband 0.05, step 0.73", 0.05, 0.7317},
+        {"passband 0.15, 44.1k->48k", 0.15, 44100.0 / 48000.0},
+        {"alias 0.30, step 2.2", 0.30, 2.2},
+        {"alias 0.30, step -2.2", 0.30, -2.2},
+    };
+    double db[4][5];
+    for (int p = 0; p < 4; p++) {
+        printf("  %-30s", probes[p].name);
+        for (int q = 0; q < 5; q++) {
+            std::vector<float> got, ideal;
+            resampleSine(kQualities[q], probes[p].freq, probes[p].step, 4000, got, ideal);
+            db[p][q] = errorDb(got, ideal);
+            printf("  %6.1f", db[p][q]);
+        }
+        printf("\n");
+    }
+    bool better = true;
+    for (int p = 0; p < 4; p++) better &= db[p][1] < db[p][0] - 6.0 && db[p][4] < db[p][1];
+    check("sinc beats linear on passband accuracy and aliasing", better);
+    check("sinc32 / sinc64: passband error below -70 dB",
+          db[0][3] < -70.0 && db[0][4] < -70.0 && db[1][4] < -70.0);
+    check("sinc32 / sinc64: pitched-up alias rejection below -60 dB",
+          db[2][3] < -60.0 && db[2][4] < -60.0 && db[3][4] < -60.0);
+
+    // Routing and looping go through the same paths as the linear mixer.
+    auto stereo = randomSignal(3000, 21);
+    soundmix::Source src;
+    src.samples = stereo.data();
+    src.numFrames = 1500;
+    src.channels = 2;
+    soundmix::Routing swap;
+    const std::vector<std::vector<int>> mapSwap = {{1}, {0}};
+    swap.map = &mapSwap;
+    std::vector<float> a(2 * 600, 0.0f), b(2 * 600, 0.0f);
+    double pa = 1300.5, pb = 1300.5;
+    const auto& t32 = *soundmix::SincTable::get(32);
+    bool okA = soundmix::mixSinc(src, pa, 1.3, true, t32, soundmix::Routing{}, a.data(), 600, 2);
+    bool okB = soundmix::mixSinc(src, pb, 1.3, true, t32, swap, b.data(), 600, 2);
+    bool swapped = okA && okB && pa == pb;
+    for (int i = 0; i < 600; i++) swapped &= a[2 * i] == b[2 * i + 1] && a[2 * i + 1] == b[2 * i];
+    check("sinc: looping across the end, channel map applied", swapped && pa < 1500.0);
+
+    double pc = 1450.0;
+    std::vector<float> c(2 * 600, 0.0f);
+    check("sinc: non-looping voice ends at the source end",
+          !soundmix::mixSinc(src, pc, 1.0, false, t32, soundmix::Routing{}, c.data(), 600, 2)
+          && c[2 * 100] == 0.0f && c[2 * 49] != 0.0f);
+}
+
+// --- voice management (tcSoundVoices.h) -------------------------------------
+
+static soundmix::VoiceInfo voiceInfo(int id, int priority, float audibility, bool real) {
+    soundmix::VoiceInfo v;
+    v.id = id;
+    v.priority = priority;
+    v.audibility = audibility;
+    v.startOrder = (uint64_t)id;
+    v.real = real;
+    return v;
+}
+
+// Run assignReal() and return the real flags indexed by id.
+static std::vector<bool> realById(std::vector<soundmix::VoiceInfo> v, float threshold, int budget,
+                                  soundmix::VoiceCounts* counts = nullptr) {
+    const soundmix::VoiceCounts c = soundmix::assignReal(v.data(), (int)v.size(), threshold, budget);
+    if (counts) *counts = c;
+    std::vector<bool> real(v.size());
+    for (const auto& x : v) real[x.id] = x.real;
+    return real;
+}
+
+static void testVoices() {
+    const float th = 0.001f;
+
+    // Ranking: priority first, then audibility, then start order.
+    {
+        std::vector<soundmix::VoiceInfo> v = {
+            voiceInfo(0, 0, 0.9f, true), voiceInfo(1, 0, 0.2f, true),
+            voiceInfo(2, 1, 0.05f, true), voiceInfo(3, 0, 0.5f, true),
+            voiceInfo(4, 0, 0.5f, true), voiceInfo(5, 0, 0.0001f, true),
+        };
+        soundmix::VoiceCounts c;
+        const auto real = realById(v, th, 3, &c);
+        check("rank: priority beats level, louder beats quieter",
+              real[2] && real[0] && !real[1] && !real[5]);
+        check("rank: equal level -> older voice stays real", real[3] && !real[4]);
+        check("counters: real == budget, virtual == the rest",
+              c.real == 3 && c.virtualVoices == 3);
+
+        const auto all = realById(v, th, 0, &c);
+        check("budget 0 mixes every audible voice",
+              c.real == 5 && c.virtualVoices == 1 && !all[5] && all[4]);
+    }
+
+    // Threshold hysteresis: leaving virtual needs +3 dB over the threshold.
+    {
+        const float in = th * 1.2f;   // above threshold, inside the margin
+        check("threshold: real voice below it goes virtual",
+              !realById({voiceInfo(0, 0, th * 0.9f, true)}, th, 0)[0]);
+        check("threshold: real voice inside the margin stays real",
+              realById({voiceInfo(0, 0, in, true)}, th, 0)[0]);
+        check("threshold: virtual voice inside the margin stays virtual",
+              !realById({voiceInfo(0, 0, in, false)}, th, 0)[0]);
+        check("threshold: virtual voice past the margin comes back",
+              realById({voiceInfo(0, 0, th * 1.5f, false)}, th, 0)[0]);
+    }
+
+    // Rank hysteresis: a slightly louder virtual voice doesn't displace a
+    // real one, a clearly louder one does; priority overrides the margin.
+    {
+        check("rank cutoff: +2 dB challenger stays virtual",
+              realById({voiceInfo(0, 0, 0.5f, true), voiceInfo(1, 0, 0.63f, false)}, th, 1)[0]);
+        check("rank cutoff: +4 dB challenger takes the slot",
+              realById({voiceInfo(0, 0, 0.5f, true), voiceInfo(1, 0, 0.8f, false)}, th, 1)[1]);
+        check("rank cutoff: higher priority wins regardless of level",
+              realById({voiceInfo(0, 0, 1.0f, true), voiceInfo(1, 1, 0.01f, false)}, th, 1)[1]);
+    }
+
+    // No flapping: two voices trading level by +-1 dB around each other
+    // every block, one real slot. Without hysteresis they swap each block.
+    {
+        std::vector<soundmix::VoiceInfo> v = {voiceInfo(0, 0, 0.5f, true), voiceInfo(1, 0, 0.5f, false)};
+        int switches = 0;
+        bool real0 = true;
+        for (int block = 0; block < 200; block++) {
+            const float wobble = (block & 1) ? 1.12f : 0.89f;
+            for (auto& x : v) x.audibility = x.id == 0 ? 0.5f * wobble : 0.5f / wobble;
+            soundmix::assignReal(v.data(), (int)v.size(), th, 1);
+            for (const auto& x : v) {
+                if (x.id == 0 && x.real != real0) { ++switches; real0 = x.real; }
+            }
+        }
+        // Same, around the threshold.
+        int thSwitches = 0;
+        soundmix::VoiceInfo q = voiceInfo(0, 0, th, true);
+        bool wasReal = true;
+        for (int block = 0; block < 200; block++) {
+            q.audibility = th * ((block & 1) ? 1.12f : 0.89f);
+            soundmix::assignReal(&q, 1, th, 0);
+            if (q.real != wasReal) { ++thSwitches; wasReal = q.real; }
+        }
+        check("hysteresis: +-1 dB wobble doesn't flap (rank, threshold)",
+              switches == 0 && thSwitches == 1);
+    }
+
+    // Stealing.
+    {
+        const std::vector<soundmix::VoiceInfo> reg = {
+            voiceInfo(0, 2, 0.3f, true),    // oldest, protected from priority <2
+            voiceInfo(1, 0, 0.8f, true),
+            voiceInfo(2, 1, 0.1f, true),    // quietest
+            voiceInfo(3, 0, 0.2f, true),
+        };
+        auto get = [&reg](int i) { return reg[i]; };
+        const int n = (int)reg.size();
+        using P = VoiceStealPolicy;
+        check("steal: None never steals",
+              soundmix::pickStealVictim(P::None, 5, n, get) == -1);
+        check("steal: Oldest / Quietest / LowestPriority pick their voice",
+              soundmix::pickStealVictim(P::Oldest, 1, n, get) == 1
+              && soundmix::pickStealVictim(P::Quietest, 1, n, get) == 2
+              && soundmix::pickStealVictim(P::LowestPriority, 1, n, get) == 1);
+        check("steal: higher-priority voices are never taken",
+              soundmix::pickStealVictim(P::Oldest, 2, n, get) == 0
+              && soundmix::pickStealVictim(P::Quietest, 0, n, get) == 3
+              && soundmix::pickStealVictim(P::LowestPriority, -1, n, get) == -1);
+    }
+
+    // Fade ramp: reaches the target exactly, never jumps by more than a step.
+    {
+        const float step = (float)(1.0 / (soundmix::FADE_SECONDS * 48000.0));   // 240 frames
+        std::vector<float> src(2 * 512, 1.0f), out(2 * 512, 0.0f);
+        float g = soundmix::addFaded(src.data(), out.data(), 512, 2, 0.0f, 1.0f, step);
+        bool smooth = g == 1.0f && out[1] == out[0];
+        float prev = 0.0f;
+        for (int i = 0; i < 512; i++) {
+            smooth &= out[2 * i] >= prev && out[2 * i] - prev <= step * 1.0001f;
+            prev = out[2 * i];
+        }
+        smooth &= out[2 * 241] == 1.0f && out[2 * 200] < 1.0f;
+
+        std::fill(out.begin(), out.end(), 0.0f);
+        g = soundmix::addFaded(src.data(), out.data(), 100, 2, 1.0f, 0.0f, step);
+        const float mid = g;
+        g = soundmix::addFaded(src.data(), out.data() + 200, 412, 2, g, 0.0f, step);
+        smooth &= mid > 0.0f && g == 0.0f && out[0] == 1.0f - step
+                  && out[2 * 100] == mid - step && out[2 * 511] == 0.0f;
+        check("fade: 5 ms ramp, continuous across blocks, ends exactly", smooth);
+    }
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static double bench(const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 5) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    return elapsed / iters;
+}
+
+static void benchmark() {
+    const int voices = 256, blockFrames = 512, outCh = 2;
+    const size_t frames = 48000 * 2;
+    auto stereo = randomSignal(frames * 2, 11);
+    auto mono = randomSignal(frames, 12);
+    std::vector<float> out((size_t)blockFrames * outCh);
+    const double blockMs = 1e3 * blockFrames / 48000.0;
+
+    printf("\n%d voices, %d-frame stereo block (%.2f ms of audio):\n", voices, blockFrames, blockMs);
+    struct Mode { const char* name; const std::vector<float>* samples; int ch; double step; };
+    for (const Mode& m : {Mode{"stereo, speed 1", &stereo, 2, 1.0},
+                          Mode{"stereo, 44.1k -> 48k", &stereo, 2, 44100.0 / 48000.0},
+                          Mode{"mono, speed 1", &mono, 1, 1.0}}) {
+        std::vector<RefVoice> vs(voices);
+        for (int i = 0; i < voices; i++) {
+            vs[i].samples = m.samples;
+            vs[i].numSamples = frames;
+            vs[i].channels = m.ch;
+            vs[i].posF = (double)(i * 331 % frames);
+            vs[i].posStep = m.step;
+            vs[i].loop = true;
+            vs[i].pan = (float)(i % 9 - 4) * 0.2f;
+            vs[i].vol = 0.01f;
+        }
+        auto a = vs, b = vs;
+        double ref = bench([&] {
+            std::fill(out.begin(), out.end(), 0.0f);
+            for (auto& v : a) refMix(v, out.data(), blockFrames, outCh);
+        });
+        double blk = bench([&] {
+            std::fill(out.begin(), out.end(), 0.0f);
+            for (auto& v : b) newMix(v, out.data(), blockFrames, outCh);
+        });
+        printf("  %-22s per-frame: %6.3f ms (%4.1f%% of a core)   block: %6.3f ms (%4.1f%%)\n",
+               m.name, ref * 1e3, 100.0 * ref * 1e3 / blockMs, blk * 1e3, 100.0 * blk * 1e3 / blockMs);
+    }
+
+    // Resampler cost per quality: 128 stereo voices, 44.1 kHz assets on a
+    // 48 kHz device, each at a slightly different speed.
+    const int sincVoices = 128;
+    printf("\n%d stereo voices, 44.1k -> 48k, per %d-frame block:\n", sincVoices, blockFrames);
+    for (int taps : kQualities) {
+        const soundmix::SincTable* table = taps ? soundmix::SincTable::get(taps) : nullptr;
+        std::vector<double> pos(sincVoices);
+        for (int i = 0; i < sincVoices; i++) pos[i] = (double)(i * 331 % frames);
+        soundmix::Source src;
+        src.samples = stereo.data();
+        src.numFrames = frames;
+        src.channels = 2;
+        soundmix::Routing r;
+        r.volume = 0.01f;
+        double t = bench([&] {
+            std::fill(out.begin(), out.end(), 0.0f);
+            for (int i = 0; i < sincVoices; i++) {
+                const double step = 44100.0 / 48000.0 * (1.0 + 0.001 * i);
+                if (table) soundmix::mixSinc(src, pos[i], step, true, *table, r, out.data(), blockFrames, outCh);
+                else soundmix::mixLinear(src, pos[i], step, true, r, out.data(), blockFrames, outCh);
+            }
+        });
+        printf("  %-8s %7.3f ms (%5.1f%% of a core)\n", taps ? ("sinc" + std::to_string(taps)).c_str() : "linear",
+               t * 1e3, 100.0 * t * 1e3 / blockMs);
+    }
+}
+
+int main() {
+    testRouting();
+    testEdges();
+    testClipAndTap();
+    testSinc();
+    testVoices();
+    benchmark();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
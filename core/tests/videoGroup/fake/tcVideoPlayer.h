@@ -0,0 +1,173 @@
+#pragma once
+
+// =============================================================================
+// Fake tc::VideoPlayer for core/tests/videoGroup.
+//
+// The CMakeLists copies tcVideoGroup.h into the build tree, where its
+// #include "tcVideoPlayer.h" finds this file instead of the real player, so
+// the test runs the real VideoGroup against players with no decoder behind
+// them. Only what VideoGroup calls is here, and it behaves like the Linux
+// backend in a group:
+//
+// - setCurrentTime() is a seek that lands `seekUpdates` update() calls
+//   later (decode latency); until then no frame at the target exists.
+// - Stopped or paused, update() shows the frame a seek landed on; playing,
+//   it shows the newest decoded frame at or before the group's present time.
+// - The decoder stays kAhead frames ahead of the shown frame while playing.
+// - newestFramePlatform(t) is the newest frame at or before t that update()
+//   could show now (on screen or decoded), as in TCVideoPlayerImpl.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define TC_PLATFORMS(list)
+
+namespace trussc {
+
+class VideoPlayer {
+public:
+    static constexpr int kAhead = 4;
+
+    // --- test side -----------------------------------------------------------
+
+    void load(double duration, double fps, int seekUpdates) {
+        duration_ = duration;
+        fps_ = fps;
+        seekUpdates_ = seekUpdates;
+        platformHandle_ = this;
+    }
+
+    int seeks = 0;                   // setCurrentTime() calls
+    double lastSeek = -1.0;
+    void* pool = nullptr;            // attachDecodePoolPlatform()
+    int attaches = 0;
+    double groupClock = std::numeric_limits<double>::quiet_NaN();
+
+    bool seekPending() const { return countdown_ > 0; }
+
+    struct Pools {
+        int live = 0;
+        int created = 0;
+        int lastThreads = 0;
+    };
+    static Pools& pools() {
+        static Pools p;
+        return p;
+    }
+
+    // --- what VideoGroup uses ------------------------------------------------
+
+    bool isLoaded() const { return duration_ > 0.0; }
+    bool isReady() const { return shown_ > kNone; }
+    bool isPlaying() const { return playing_ && !paused_; }
+    bool isPaused() const { return paused_; }
+    bool isFrameNew() const { return frameNew_; }
+
+    float getDuration() const { return (float)duration_; }
+    float getCurrentTime() const { return shown_ > kNone ? (float)shown_ : 0.0f; }
+    int getCurrentFrame() const { return shown_ > kNone ? (int)std::lround(shown_ * fps_) : 0; }
+    int getTotalFrames() const { return (int)std::lround(duration_ * fps_); }
+
+    void setLoop(bool loop) { loop_ = loop; }
+    bool isLoop() const { return loop_; }
+
+    void play() {
+        playing_ = true;
+        paused_ = false;
+    }
+    void stop() {
+        playing_ = false;
+        paused_ = false;
+        setCurrentTime(0.0f);
+    }
+    void setPaused(bool paused) { paused_ = paused; }
+
+    void setCurrentTime(float seconds) {
+        ++seeks;
+        lastSeek = seconds;
+        target_ = frameAt(seconds);
+        countdown_ = seekUpdates_;
+        queueFront_ = queueBack_ = kNone;   // the queue is dropped
+    }
+
+    void update() {
+        frameNew_ = false;
+        if (countdown_ > 0 && --countdown_ == 0) {
+            queueFront_ = queueBack_ = target_;
+            scrub_ = true;
+        }
+        const bool running = playing_ && !paused_;
+        if (queueFront_ > kNone && (scrub_ || (running && queueFront_ <= present_))) {
+            shown_ = scrub_ ? queueFront_ : std::min(frameAt(present_), queueBack_);
+            scrub_ = false;
+            frameNew_ = true;
+            queueFront_ = shown_ + 1.0 / fps_;
+            if (queueFront_ > queueBack_) queueFront_ = queueBack_ = kNone;
+        }
+        if (running && countdown_ == 0 && shown_ > kNone) {
+            const double ahead = std::min(shown_ + kAhead / fps_, lastFrame());
+            if (ahead > shown_) {
+                if (queueFront_ == kNone) queueFront_ = shown_ + 1.0 / fps_;
+                queueBack_ = std::max(queueBack_, ahead);
+            }
+        }
+    }
+
+private:
+    friend class VideoGroup;
+
+    static constexpr double kNone = -std::numeric_limits<double>::infinity();
+
+    double frameAt(double t) const {
+        return std::clamp(std::floor(t * fps_ + 1e-9) / fps_, 0.0, lastFrame());
+    }
+    double lastFrame() const { return std::ceil(duration_ * fps_ - 1.0 - 1e-9) / fps_; }
+
+    // Platform hooks (tcVideoPlayer_linux.cpp in the real player)
+    static void* createDecodePoolPlatform(int threads) {
+        ++pools().live;
+        ++pools().created;
+        pools().lastThreads = threads;
+        return new int(threads);
+    }
+    static void destroyDecodePoolPlatform(void* p) {
+        --pools().live;
+        delete static_cast<int*>(p);
+    }
+    void attachDecodePoolPlatform(void* p) {
+        pool = p;
+        ++attaches;
+    }
+    void setGroupClockPlatform(double clock, double present) {
+        groupClock = clock;
+        present_ = present;
+    }
+    double newestFramePlatform(double t) const {
+        double newest = shown_ <= t ? shown_ : kNone;
+        if (queueFront_ > kNone && queueFront_ <= t) newest = std::min(frameAt(t), queueBack_);
+        return newest;
+    }
+    double frameDurationPlatform() const { return 1.0 / fps_; }
+
+    void* platformHandle_ = nullptr;
+
+    double duration_ = 0.0;
+    double fps_ = 30.0;
+    int seekUpdates_ = 1;
+    bool loop_ = false;
+    bool playing_ = false;
+    bool paused_ = false;
+    bool frameNew_ = false;
+
+    double present_ = 0.0;
+    double shown_ = kNone;        // frame on screen
+    double queueFront_ = kNone;   // decoded frames not shown yet
+    double queueBack_ = kNone;
+    double target_ = 0.0;         // pending seek
+    int countdown_ = 0;
+    bool scrub_ = false;          // the landed seek frame, shown even paused
+};
+
+} // namespace trussc
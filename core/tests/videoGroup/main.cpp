@@ -0,0 +1,461 @@
+// =============================================================================
+// core/tests/videoGroup — VideoFrameLock (VideoGroup's frame lock), plus
+// video wall simulations.
+//
+// The checks cover the presentation policy: everyone on time shows the
+// clock, a member a frame or two late holds the wall on its frame, a member
+// further behind (or without any frame) doesn't freeze the others, the
+// presented time never runs backwards until reset(), and on-time is judged
+// per member frame rate.
+//
+// VideoGroup itself runs on fake players (fake/tcVideoPlayer.h, Linux
+// only): play() and a loop preroll until the slowest member's seek lands,
+// a member added while playing starts at the clock, a removed one goes
+// back to its own clock, and the decode pool is rebuilt only when the
+// thread count changes, with the members re-attached on the next update().
+//
+// The benchmarks (informational only) simulate a 9-screen wall:
+//  - coherence: players on their own clocks (staggered start, crystal drift,
+//    occasional late frames) vs one group clock with the frame lock, as the
+//    share of display frames on which the screens show different moments;
+//  - decode scheduling: one thread per player vs a shared pool serving
+//    players round-robin vs earliest deadline first, as display frames on
+//    which a screen had no frame on time.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/video/tcVideoSync.h"
+#include "tcVideoGroup.h"   // the real one, on fake players (see CMakeLists.txt)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+static const double kNoFrame = -std::numeric_limits<double>::infinity();
+
+// --- frame lock ---------------------------------------------------------------------
+
+static void testFrameLock() {
+    const double f = 1.0 / 30.0;
+    const std::vector<double> durs(3, f);
+    std::vector<char> late;
+
+    {
+        VideoFrameLock lock;
+        auto d = lock.decide(10.0, {10.0 - f * 0.5, 10.0 - f * 0.1, 10.0}, durs, &late);
+        check("all on time: present the clock", d.present == 10.0 && !d.held && d.late == 0);
+    }
+    {
+        VideoFrameLock lock;
+        auto d = lock.decide(10.0, {10.0, 10.0 - f * 1.5, 10.0}, durs, &late);
+        check("one frame late: wall held on its frame",
+              d.held && d.present == 10.0 - f * 1.5 && d.late == 1);
+        check("only the late member flagged", late[0] == 0 && late[1] == 1 && late[2] == 0);
+    }
+    {
+        VideoFrameLock lock;
+        auto d = lock.decide(10.0, {10.0, 10.0 - f * 5, 10.0 - f * 1.5}, durs, &late);
+        check("beyond max lag: clock goes on without it", !d.held && d.present == 10.0 && d.late == 2);
+    }
+    {
+        VideoFrameLock lock;
+        auto d = lock.decide(10.0, {10.0, kNoFrame, 10.0}, durs);
+        check("no frame at all: clock goes on", !d.held && d.present == 10.0 && d.late == 1);
+    }
+    {
+        VideoFrameLock lock;
+        lock.setMaxLagFrames(0);
+        auto d = lock.decide(10.0, {10.0, 10.0 - f * 1.5, 10.0}, durs);
+        check("max lag 0: never holds", !d.held && d.present == 10.0);
+    }
+    {
+        VideoFrameLock lock;
+        auto a = lock.decide(10.0, {10.0, 10.0 - f * 1.5, 10.0}, durs);
+        auto b = lock.decide(10.0 + f * 0.2, {10.0, 10.0 - f * 1.7, 10.0}, durs);
+        check("presented time never goes backwards", b.present == a.present && b.held);
+        auto c = lock.decide(10.0 + f, {10.0 + f, 10.0 + f, 10.0 + f}, durs);
+        check("catches up to the clock once all are on time", c.present == 10.0 + f && !c.held);
+        lock.reset();
+        auto r = lock.decide(2.0, {2.0, 2.0, 2.0}, durs);
+        check("reset (seek back): presents the new clock", r.present == 2.0);
+    }
+    {
+        // 24 fps member with a frame 1.2 x 1/30 s old is still on time.
+        VideoFrameLock lock;
+        auto d = lock.decide(10.0, {10.0, 10.0 - f * 1.2}, {f, 1.0 / 24.0});
+        check("on time judged by each member's frame duration", d.late == 0 && d.present == 10.0);
+    }
+}
+
+
+// --- VideoGroup on fake players -----------------------------------------------------
+
+// update() at ~200 Hz until `done` (true) or `seconds` of wall time (false).
+template<class Done>
+static bool runUntil(VideoGroup& group, double seconds, Done done) {
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        group.update();
+        if (done()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+static void testGroup() {
+    const auto& pools = VideoPlayer::pools();
+    // Seek latencies of 1, 2, 4 and 1 update()s; the third ends early.
+    VideoPlayer p[4];
+    p[0].load(0.6, 30.0, 1);
+    p[1].load(0.6, 30.0, 2);
+    p[2].load(0.5, 30.0, 4);
+    p[3].load(0.6, 30.0, 1);
+    const auto playing = [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            if (!p[i].isPlaying()) return false;
+        }
+        return true;
+    };
+    const auto attached = [&](VideoGroup& g) {
+        void* pool = g.get(0).pool;
+        for (size_t i = 0; i < g.size(); ++i) {
+            if (!g.get(i).pool || g.get(i).pool != pool) return false;
+        }
+        return true;
+    };
+
+    {
+        VideoGroup group;
+        group.setDecodeThreads(2);
+        for (int i = 0; i < 3; ++i) group.add(p[i]);
+        check("rebuildPool: one pool for a fixed thread count",
+              pools.live == 1 && pools.created == 1 && pools.lastThreads == 2);
+        group.update();
+        check("members move to the pool on update()", attached(group));
+
+        // Preroll: the clock waits for the slowest member's seek.
+        group.setLoop(true);
+        group.play();
+        for (int i = 0; i < 4; ++i) group.update();
+        check("preroll: nobody starts before the slowest member's frame",
+              !p[0].isPlaying() && !p[1].isPlaying() && !p[2].isPlaying() && group.getCurrentTime() == 0.0
+              && p[0].isReady() && !p[2].seekPending());
+        group.update();
+        check("preroll: then all start together", playing(3));
+        check("members run on the group clock", !std::isnan(p[0].groupClock) && !std::isnan(p[2].groupClock));
+        runUntil(group, 1.0, [&] { return group.getCurrentTime() > 0.2; });
+        check("playing: members show frames at the group clock",
+              std::abs(p[0].getCurrentTime() - group.getCurrentTime()) < 2.0 / 30.0
+              && std::abs(p[2].getCurrentTime() - group.getCurrentTime()) < 2.0 / 30.0);
+
+        // Loop: all seek back to 0 and preroll again. The old frames (near
+        // the end) must not count as ready.
+        const int seeks = p[2].seeks;
+        double last = group.getCurrentTime();
+        const bool wrapped = runUntil(group, 2.0, [&] {
+            const double t = group.getCurrentTime();
+            const bool back = t < last;
+            last = t;
+            return back;
+        });
+        check("loop: the longest member's end restarts all at 0",
+              wrapped && group.getCurrentTime() == 0.0 && p[2].seeks == seeks + 1 && p[2].lastSeek == 0.0);
+        group.update();
+        group.update();
+        check("loop: preroll holds the clock until every seek lands",
+              group.getCurrentTime() == 0.0 && !p[2].isPlaying() && p[2].seekPending());
+        check("loop: and then all run again",
+              runUntil(group, 1.0, [&] { return playing(3) && group.getCurrentTime() > 0.0; }));
+
+        // Joining a running group: seeked to the clock and started.
+        runUntil(group, 1.0, [&] { return group.getCurrentTime() > 0.1; });
+        group.add(p[3]);
+        check("add while playing: the newcomer starts at the clock",
+              p[3].isPlaying() && p[3].isLoop() && std::abs(p[3].lastSeek - group.getCurrentTime()) < 1e-4);
+        check("add: the pool is kept (fixed thread count)", pools.live == 1 && pools.created == 1);
+        runUntil(group, 1.0, [&] { return p[3].isReady(); });
+        check("add: the newcomer is on the pool and shows the clock's frame",
+              attached(group) && std::abs(p[3].getCurrentTime() - group.getCurrentTime()) < 2.0 / 30.0);
+
+        // Leaving: back on its own thread and clock; the others go on.
+        group.remove(p[1]);
+        check("remove while playing: member released",
+              group.size() == 3 && !p[1].pool && std::isnan(p[1].groupClock));
+        const double before = p[0].getCurrentTime();
+        check("remove: the others keep playing",
+              runUntil(group, 1.0, [&] { return p[0].getCurrentTime() > before; }) && p[3].isPlaying());
+
+        // rebuildPool: a new thread count replaces the pool, members follow.
+        const int attaches = p[0].attaches;
+        group.setDecodeThreads(3);
+        check("rebuildPool: a new count replaces the pool, members detached",
+              pools.live == 1 && pools.created == 2 && pools.lastThreads == 3 && !p[0].pool);
+        group.update();
+        check("rebuildPool: members re-attached on the next update()",
+              attached(group) && p[0].attaches == attaches + 2);
+        group.setDecodeThreads(3);
+        check("rebuildPool: same count, same pool", pools.created == 2 && p[0].pool);
+        group.setDecodeThreads(0);
+        check("rebuildPool: automatic, at most one thread per member",
+              group.getDecodeThreads() >= 1 && group.getDecodeThreads() <= (int)group.size());
+
+        group.clear();
+        check("clear: pool gone, members back on their own clocks",
+              pools.live == 0 && !p[0].pool && !p[3].pool && std::isnan(p[0].groupClock));
+        group.add(p[0]);
+    }
+    check("destructor releases the members and the pool", pools.live == 0 && !p[0].pool);
+}
+
+// --- benchmark: wall coherence ------------------------------------------------------
+
+// Frame k of screen i can be shown from ready[i][k] on: decoded ahead of
+// time, except now and then one that is up to half a frame late.
+struct Wall {
+    int screens, frames;
+    double fps;
+    std::vector<std::vector<double>> ready;
+};
+
+static Wall makeWall(int screens, int frames, double fps, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    Wall w{screens, frames, fps, {}};
+    w.ready.resize(screens);
+    for (auto& r : w.ready) {
+        r.resize(frames);
+        for (int k = 0; k < frames; ++k) {
+            const double late = u(rng) < 0.01 ? (1.5 + u(rng)) / fps : 0.0;
+            r[k] = k / fps - 2.0 / fps + late;
+        }
+    }
+    return w;
+}
+
+// Newest frame of screen i with pts <= t that is ready at wall time `now`,
+// never older than the one already up (`shown`).
+static int newestFrame(const Wall& w, int i, double t, double now, int shown) {
+    int k = std::min((int)std::floor(t * w.fps + 1e-9), w.frames - 1);
+    for (; k > shown; --k) {
+        if (w.ready[i][k] <= now) return k;
+    }
+    return shown;
+}
+
+static void benchCoherence() {
+    const int screens = 9, seconds = 120;
+    const double fps = 30.0, vsync = 60.0;
+    const Wall w = makeWall(screens, (int)(seconds * fps), fps, 7);
+    const int ticks = (int)((seconds - 1) * vsync);
+
+    printf("\n%d screens, %.0f fps video, %.0f Hz display, %d s (informational):\n",
+           screens, fps, vsync, seconds);
+
+    // Independent players: started 0-50 ms apart, clocks off by up to 100 ppm.
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<double> start(0.0, 0.05), ppm(-100e-6, 100e-6);
+        std::vector<double> offset(screens), rate(screens);
+        for (int i = 0; i < screens; ++i) {
+            offset[i] = start(rng);
+            rate[i] = 1.0 + ppm(rng);
+        }
+        std::vector<int> shown(screens, -1);
+        int torn = 0, spread = 0;
+        for (int n = 0; n < ticks; ++n) {
+            const double now = 1.0 + n / vsync;  // after a 1 s preroll
+            for (int i = 0; i < screens; ++i) {
+                shown[i] = newestFrame(w, i, std::max(now - offset[i], 0.0) * rate[i], now, shown[i]);
+            }
+            const auto [lo, hi] = std::minmax_element(shown.begin(), shown.end());
+            if (*lo != *hi) ++torn;
+            spread = std::max(spread, *hi - *lo);
+        }
+        printf("  %-44s %6.1f%% of display frames torn, max spread %d frames\n",
+               "independent clocks", 100.0 * torn / ticks, spread);
+    }
+
+    // Group clock + frame lock.
+    {
+        VideoFrameLock lock;
+        std::vector<int> shown(screens, -1);
+        std::vector<double> newest(screens), durs(screens, 1.0 / fps);
+        int torn = 0, spread = 0, held = 0;
+        for (int n = 0; n < ticks; ++n) {
+            const double now = 1.0 + n / vsync;  // after a 1 s preroll
+            for (int i = 0; i < screens; ++i) {
+                const int k = newestFrame(w, i, now, now, shown[i]);
+                newest[i] = k < 0 ? kNoFrame : k / fps;
+            }
+            const auto d = lock.decide(now, newest, durs);
+            if (d.held) ++held;
+            for (int i = 0; i < screens; ++i) {
+                shown[i] = newestFrame(w, i, d.present, now, shown[i]);
+            }
+            const auto [lo, hi] = std::minmax_element(shown.begin(), shown.end());
+            if (*lo != *hi) ++torn;
+            spread = std::max(spread, *hi - *lo);
+        }
+        printf("  %-44s %6.1f%% of display frames torn, max spread %d frames\n",
+               "group clock + frame lock", 100.0 * torn / ticks, spread);
+        printf("  %-44s %6.1f%% of display frames\n", "  (held for a late screen)", 100.0 * held / ticks);
+        check("frame lock: one moment on every screen (late < max lag)", torn == 0);
+    }
+}
+
+// --- benchmark: decode scheduling ---------------------------------------------------
+
+enum class Sched { ThreadPerPlayer, RoundRobin, EarliestDeadline };
+
+// `cores` cores decode `costs.size()` 30 fps streams (ms per frame, 2.5x on
+// keyframes every 30 frames, +-20% jitter) into 4-frame queues; a 60 Hz
+// display consumes them after a 200 ms preroll. A stream 0.5 s behind skips
+// ahead, like the player's resync. Returns display frames on which some
+// screen had no frame covering the clock.
+static int simulateDecode(Sched sched, int cores, const std::vector<double>& costs, double seconds) {
+    const int n = (int)costs.size();
+    const double fps = 30.0, vsync = 60.0, preroll = 0.2, dt = 0.00025;
+    const size_t maxQueue = 4;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> jitter(0.8, 1.2);
+
+    std::vector<int> next(n, 0);                 // next frame to decode
+    std::vector<std::vector<int>> queue(n);      // decoded, not shown yet
+    std::vector<int> shown(n, -1);
+    std::vector<double> remaining(n, 0.0);       // work left on frame next[i] (s)
+    std::vector<int> worker(cores, -1);          // pool: member each worker decodes
+    std::vector<char> busy(n, 0);
+    int rr = 0, misses = 0;
+
+    auto cost = [&](int i) {
+        return costs[i] * 0.001 * jitter(rng) * (next[i] % 30 == 0 ? 2.5 : 1.0);
+    };
+    auto wants = [&](int i) { return queue[i].size() < maxQueue; };
+    for (int i = 0; i < n; ++i) remaining[i] = cost(i);
+
+    const int steps = (int)(seconds / dt);
+    const int stepsPerTick = (int)std::lround(1.0 / vsync / dt);
+    for (int s = 0; s < steps; ++s) {
+        auto finish = [&](int i) {
+            queue[i].push_back(next[i]++);
+            remaining[i] = cost(i);
+        };
+
+        if (sched == Sched::ThreadPerPlayer) {
+            // The OS shares the cores evenly between threads with work.
+            int active = 0;
+            for (int i = 0; i < n; ++i) active += wants(i);
+            const double share = active > cores ? (double)cores / active : 1.0;
+            for (int i = 0; i < n; ++i) {
+                if (!wants(i)) continue;
+                remaining[i] -= dt * share;
+                if (remaining[i] <= 0.0) finish(i);
+            }
+        } else {
+            for (int c = 0; c < cores; ++c) {
+                if (worker[c] < 0) {
+                    int pick = -1;
+                    if (sched == Sched::RoundRobin) {
+                        for (int k = 0; k < n && pick < 0; ++k) {
+                            const int i = (rr + k) % n;
+                            if (!busy[i] && wants(i)) pick = i;
+                        }
+                        if (pick >= 0) rr = (pick + 1) % n;
+                    } else {
+                        // queue end = last queued frame's time
+                        for (int i = 0; i < n; ++i) {
+                            if (busy[i] || !wants(i)) continue;
+                            if (pick < 0 || next[i] < next[pick]) pick = i;
+                        }
+                    }
+                    if (pick < 0) continue;
+                    worker[c] = pick;
+                    busy[pick] = 1;
+                }
+                const int i = worker[c];
+                remaining[i] -= dt;
+                if (remaining[i] <= 0.0) {
+                    finish(i);
+                    busy[i] = 0;
+                    worker[c] = -1;
+                }
+            }
+        }
+
+        if (s % stepsPerTick == 0) {
+            const double clock = s * dt - preroll;
+            if (clock < 0.0) continue;
+            const int due = (int)std::floor(clock * fps + 1e-6);  // frame on screen now
+            bool miss = false;
+            for (int i = 0; i < n; ++i) {
+                auto& q = queue[i];
+                while (!q.empty() && q.front() <= due) {
+                    shown[i] = q.front();
+                    q.erase(q.begin());
+                }
+                if (shown[i] < due) miss = true;
+                if (next[i] < due - (int)(0.5 * fps) && !busy[i]) {
+                    q.clear();
+                    next[i] = due + 1;
+                    remaining[i] = cost(i);
+                }
+            }
+            misses += miss;
+        }
+    }
+    return misses;
+}
+
+static void benchDecode(double ms4k, const char* load) {
+    // 3 x 4K + 6 x 1080p on 4 cores.
+    const std::vector<double> costs = {ms4k, ms4k, ms4k, 7, 7, 7, 7, 7, 7};
+    const int cores = 4;
+    const double seconds = 60.0;
+    const int ticks = (int)((seconds - 0.2) * 60.0);
+
+    printf("\n3 x 4K (%.0f ms/frame) + 6 x 1080p (7 ms) on %d cores, %s, %.0f s at 60 Hz,\n"
+           "display frames on which a screen missed its frame:\n",
+           ms4k, cores, load, seconds);
+    const struct {
+        const char* name;
+        Sched sched;
+    } rows[] = {
+        {"thread per player", Sched::ThreadPerPlayer},
+        {"shared pool, round-robin", Sched::RoundRobin},
+        {"shared pool, earliest deadline first", Sched::EarliestDeadline},
+    };
+    for (const auto& row : rows) {
+        const int misses = simulateDecode(row.sched, cores, costs, seconds);
+        printf("  %-44s %6d  (%.2f%%)\n", row.name, misses, 100.0 * misses / ticks);
+    }
+}
+
+int main() {
+    testFrameLock();
+#if defined(__linux__) && !defined(__ANDROID__)
+    testGroup();   // the decode pool and group clock are the Linux backend's
+#endif
+
+    benchCoherence();
+    benchDecode(22.0, "~85% busy");
+    benchDecode(24.0, "~90% busy");
+
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,466 @@
+// =============================================================================
+// core/tests/videoPlanes — Linux VideoPlayer decode-thread plane handling,
+// plus a per-frame cost benchmark of the planar path vs the RGBA fallback.
+//
+// The decode thread hands 4:2:0 frames over as planes (I420 from YUV420P,
+// NV12 from NV12 / P010) and the GPU converts them; anything else goes
+// through sws_scale to RGBA. The checks cover what the planar path relies
+// on: planes copied out of padded AVFrame-style rows arrive tight and
+// unchanged, P010 keeps its high byte, and the RGBA fallback agrees with
+// the BT.601 limited-range math of videoI420.glsl / videoNV12.glsl (so a
+// stream looks the same on either path). The copies and the queue are the
+// player's own VideoFrameQueue (tc/video/tcVideoFrameQueue.h): the checks
+// also cover prime(), that takeFront() swaps the queued block in rather than
+// copying it, that a frame in the wrong layout is dropped, and that a
+// MAX_QUEUE_SIZE-deep queue stays within POOL_FRAMES pooled frames. The
+// benchmark times the work done per decoded frame on each path,
+// and the whole pipeline with the older copies vs the buffer swap
+// (informational only).
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tcColor.h"   // tcPixels.h expects Color (TrussC.h includes it first)
+#include "tc/video/tcVideoFrameQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#ifdef TC_TEST_HAVE_SWSCALE
+extern "C" {
+#include <libswscale/swscale.h>
+#include <libavutil/pixfmt.h>
+}
+#endif
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// --- source frames (padded rows, like AVFrame linesize) -----------------------
+
+struct Plane {
+    std::vector<uint8_t> data;
+    int stride = 0;   // bytes per row
+};
+
+struct YuvFrame {    // YUV420P
+    int width = 0, height = 0;
+    Plane y, u, v;
+};
+
+struct P010Frame {   // P010: Y + interleaved UV, 10 bits in the top of 16
+    int width = 0, height = 0;
+    Plane y, uv;
+};
+
+static Plane makePlane(int rowBytes, int rows, uint32_t seed) {
+    Plane p;
+    p.stride = (rowBytes + 64 + 63) & ~63;   // padding past the row, like FFmpeg
+    p.data.resize((size_t)p.stride * rows);
+    std::mt19937 rng(seed);
+    for (auto& b : p.data) b = (uint8_t)rng();
+    return p;
+}
+
+// Luma is noise; chroma is constant over 8x8 luma blocks, so the fallback's
+// chroma upsampling can't blur it inside a block.
+static YuvFrame makeYuv(int w, int h, uint32_t seed) {
+    YuvFrame f;
+    f.width = w;
+    f.height = h;
+    f.y = makePlane(w, h, seed);
+    f.u = makePlane(w / 2, h / 2, seed + 1);
+    f.v = makePlane(w / 2, h / 2, seed + 2);
+    for (Plane* c : {&f.u, &f.v}) {
+        for (int y = 0; y < h / 2; ++y) {
+            for (int x = 0; x < w / 2; ++x) {
+                c->data[(size_t)y * c->stride + x] = c->data[(size_t)(y & ~3) * c->stride + (x & ~3)];
+            }
+        }
+    }
+    return f;
+}
+
+static P010Frame makeP010(int w, int h, uint32_t seed) {
+    P010Frame f;
+    f.width = w;
+    f.height = h;
+    f.y  = makePlane(w * 2, h, seed);
+    f.uv = makePlane(w * 2, h / 2, seed + 1);
+    for (Plane* p : {&f.y, &f.uv}) {
+        for (size_t i = 0; i + 1 < p->data.size(); i += 2) p->data[i] &= 0xC0;  // low 6 bits zero
+    }
+    return f;
+}
+
+// --- the decode-thread paths (VideoFrameQueue, as TCVideoPlayerImpl uses it) ---
+
+using FrameData = VideoFrameQueue::Frame;
+using Planes = VideoFrameQueue::Planes;
+
+// A queue set up the way loadPlatform() sets up the player's.
+static void setUp(VideoFrameQueue& queue, int w, int h, Planes planes,
+                  const std::shared_ptr<PixelsPool>& pool) {
+    queue.setPool(pool);
+    queue.setLayout(w, h, planes);
+}
+
+// TCVideoPlayerImpl::copyPlanes() with the AVFrame's data / linesize.
+static bool i420Path(const VideoFrameQueue& queue, const YuvFrame& s, FrameData& data) {
+    const uint8_t* planes[3] = { s.y.data.data(), s.u.data.data(), s.v.data.data() };
+    const int strides[3] = { s.y.stride, s.u.stride, s.v.stride };
+    return queue.copyPlanes(VideoFrameQueue::Source::YUV420P, planes, strides, data);
+}
+
+static bool p010Path(const VideoFrameQueue& queue, const P010Frame& s, FrameData& data) {
+    const uint8_t* planes[2] = { s.y.data.data(), s.uv.data.data() };
+    const int strides[2] = { s.y.stride, s.uv.stride };
+    return queue.copyPlanes(VideoFrameQueue::Source::P010, planes, strides, data);
+}
+
+// RGBA fallback: decodeNextFrame() converts straight into the pooled frame.
+// runViaScratch() is the older scratch buffer + copy, for comparison.
+class RgbaPath {
+public:
+    RgbaPath(int w, int h) : width_(w), height_(h), scratch_((size_t)w * h * 4) {
+#ifdef TC_TEST_HAVE_SWSCALE
+        sws_ = sws_getContext(w, h, AV_PIX_FMT_YUV420P, w, h, AV_PIX_FMT_RGBA,
+                              SWS_BILINEAR, nullptr, nullptr, nullptr);
+#endif
+    }
+    ~RgbaPath() {
+#ifdef TC_TEST_HAVE_SWSCALE
+        if (sws_) sws_freeContext(sws_);
+#endif
+    }
+    RgbaPath(const RgbaPath&) = delete;
+    RgbaPath& operator=(const RgbaPath&) = delete;
+
+    static const char* name() {
+#ifdef TC_TEST_HAVE_SWSCALE
+        return "sws_scale bilinear";
+#else
+        return "scalar stand-in, no libswscale";
+#endif
+    }
+
+    void run(const VideoFrameQueue& queue, const YuvFrame& s, FrameData& data) {
+        queue.allocate(data, Planes::RGBA);
+        convert(s, data.pixels.getData());
+    }
+
+    void runViaScratch(const VideoFrameQueue& queue, const YuvFrame& s, FrameData& data) {
+        convert(s, scratch_.data());
+        queue.allocate(data, Planes::RGBA);
+        std::memcpy(data.pixels.getData(), scratch_.data(), data.pixels.getTotalBytes());
+    }
+
+private:
+    int width_, height_;
+    std::vector<uint8_t> scratch_;
+#ifdef TC_TEST_HAVE_SWSCALE
+    SwsContext* sws_ = nullptr;
+
+    void convert(const YuvFrame& s, uint8_t* rgba) {
+        const uint8_t* src[4] = { s.y.data.data(), s.u.data.data(), s.v.data.data(), nullptr };
+        const int srcStride[4] = { s.y.stride, s.u.stride, s.v.stride, 0 };
+        uint8_t* dst[4] = { rgba, nullptr, nullptr, nullptr };
+        const int dstStride[4] = { width_ * 4, 0, 0, 0 };
+        sws_scale(sws_, src, srcStride, 0, height_, dst, dstStride);
+    }
+#else
+    // Fixed-point BT.601 limited range, nearest chroma. Unvectorised, so
+    // only a rough stand-in for the sws_scale cost.
+    void convert(const YuvFrame& s, uint8_t* rgba) {
+        auto clamp8 = [](int v) { return (uint8_t)std::min(std::max(v, 0), 255); };
+        for (int y = 0; y < height_; ++y) {
+            const uint8_t* ys = s.y.data.data() + (size_t)y * s.y.stride;
+            const uint8_t* us = s.u.data.data() + (size_t)(y / 2) * s.u.stride;
+            const uint8_t* vs = s.v.data.data() + (size_t)(y / 2) * s.v.stride;
+            uint8_t* d = rgba + (size_t)y * width_ * 4;
+            for (int x = 0; x < width_; ++x) {
+                const int c = (ys[x] - 16) * 298, e = us[x / 2] - 128, f = vs[x / 2] - 128;
+                d[x * 4 + 0] = clamp8((c + 409 * f + 128) >> 8);
+                d[x * 4 + 1] = clamp8((c - 100 * e - 208 * f + 128) >> 8);
+                d[x * 4 + 2] = clamp8((c + 516 * e + 128) >> 8);
+                d[x * 4 + 3] = 255;
+            }
+        }
+    }
+#endif
+};
+
+// videoI420.glsl / videoNV12.glsl fragment math, in float like the GPU.
+static void shaderRgb(uint8_t y8, uint8_t u8, uint8_t v8, float out[3]) {
+    const float yy = (y8 / 255.0f - 16.0f / 255.0f) * (255.0f / 219.0f);
+    const float u  = (u8 / 255.0f - 0.5f) * (255.0f / 224.0f);
+    const float v  = (v8 / 255.0f - 0.5f) * (255.0f / 224.0f);
+    out[0] = std::clamp(yy + 1.402f * v, 0.0f, 1.0f) * 255.0f;
+    out[1] = std::clamp(yy - 0.34414f * u - 0.71414f * v, 0.0f, 1.0f) * 255.0f;
+    out[2] = std::clamp(yy + 1.772f * u, 0.0f, 1.0f) * 255.0f;
+}
+
+// --- checks -------------------------------------------------------------------
+
+static bool planeEquals(const Pixels& px, const Plane& src, int rowBytes, int rows) {
+    if (px.getTotalBytes() != (size_t)rowBytes * rows) return false;
+    for (int y = 0; y < rows; ++y) {
+        if (std::memcmp(px.getData() + (size_t)y * rowBytes,
+                        src.data.data() + (size_t)y * src.stride, rowBytes) != 0) return false;
+    }
+    return true;
+}
+
+static void testPlanes() {
+    auto pool = std::make_shared<PixelsPool>();
+    const int w = 200, h = 72;   // rows not a multiple of 16 / 64
+
+    VideoFrameQueue i420Queue, nv12Queue;
+    setUp(i420Queue, w, h, Planes::I420, pool);
+    setUp(nv12Queue, w, h, Planes::NV12, pool);
+
+    YuvFrame yuv = makeYuv(w, h, 1);
+    FrameData i420;
+    check("I420 layout takes YUV420P, refuses P010 (falls back to RGBA)",
+          i420Path(i420Queue, yuv, i420) && !p010Path(i420Queue, makeP010(w, h, 7), i420));
+    check("I420: Y plane copied tight and unchanged", planeEquals(i420.pixels, yuv.y, w, h));
+    check("I420: U / V planes copied tight and unchanged",
+          planeEquals(i420.pixelsUV, yuv.u, w / 2, h / 2) && planeEquals(i420.pixelsV, yuv.v, w / 2, h / 2));
+    check("I420: 1.5 bytes per pixel handed over",
+          i420.pixels.getTotalBytes() + i420.pixelsUV.getTotalBytes() + i420.pixelsV.getTotalBytes()
+              == (size_t)w * h * 3 / 2);
+
+    P010Frame p010 = makeP010(w, h, 2);
+    FrameData nv12;
+    p010Path(nv12Queue, p010, nv12);
+    auto narrowed = [](const Pixels& px, const Plane& src, int samples, int rows) {
+        if (px.getTotalBytes() != (size_t)samples * rows) return false;
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < samples; ++x) {
+                uint16_t s;
+                std::memcpy(&s, src.data.data() + (size_t)y * src.stride + x * 2, 2);
+                if (px.getData()[(size_t)y * samples + x] != (uint8_t)(s >> 8)) return false;
+            }
+        }
+        return true;
+    };
+    check("P010: Y plane narrowed to its high byte", narrowed(nv12.pixels, p010.y, w, h));
+    check("P010: UV plane narrowed to its high byte (NV12 layout)", narrowed(nv12.pixelsUV, p010.uv, w, h / 2));
+
+    // Frames recycle pool blocks: a second frame after the first is gone
+    // doesn't allocate.
+    i420 = FrameData{};
+    const auto before = pool->getStats();
+    FrameData again;
+    i420Path(i420Queue, yuv, again);
+    check("I420 frames reuse pool blocks", pool->getStats().reused >= before.reused + 3);
+}
+
+static void testFallbackMatchesShader() {
+    auto pool = std::make_shared<PixelsPool>();
+    const int w = 256, h = 128;
+    YuvFrame yuv = makeYuv(w, h, 3);
+    RgbaPath rgba(w, h);
+    VideoFrameQueue queue;
+    setUp(queue, w, h, Planes::RGBA, pool);
+    FrameData data;
+    rgba.run(queue, yuv, data);
+
+    // Compare away from chroma block edges (upsampling filters differ).
+    float maxErr = 0.0f;
+    for (int y = 0; y < h; ++y) {
+        if (y % 8 < 2 || y % 8 > 5) continue;
+        for (int x = 0; x < w; ++x) {
+            if (x % 8 < 2 || x % 8 > 5) continue;
+            float ref[3];
+            shaderRgb(yuv.y.data[(size_t)y * yuv.y.stride + x],
+                      yuv.u.data[(size_t)(y / 2) * yuv.u.stride + x / 2],
+                      yuv.v.data[(size_t)(y / 2) * yuv.v.stride + x / 2], ref);
+            const uint8_t* p = data.pixels.getData() + ((size_t)y * w + x) * 4;
+            for (int c = 0; c < 3; ++c) maxErr = std::max(maxErr, std::fabs(p[c] - ref[c]));
+        }
+    }
+    printf("  RGBA fallback (%s) vs shader math: max error %.2f / 255\n", RgbaPath::name(), maxErr);
+    check("RGBA fallback matches the YUV shader math (<= 4 / 255)", maxErr <= 4.0f);
+}
+
+// --- frame pipeline (decode thread -> queue -> update()) -----------------------
+
+static constexpr size_t kQueue = VideoFrameQueue::MAX_QUEUE_SIZE;
+static constexpr size_t kPoolFrames = VideoFrameQueue::POOL_FRAMES;
+
+// Run `frames` frames through the queue, one produced and one taken per
+// iteration once full, like playback in steady state. With `copyInto`,
+// update() as it was before the buffer swap: the front frame is memcpy'd
+// into player-owned buffers instead of taken (benchmark only).
+static void runPipeline(VideoFrameQueue& queue, int frames,
+                        const std::function<void(FrameData&)>& produce,
+                        std::vector<uint8_t>* copyInto = nullptr) {
+    for (int i = 0; i < frames; ++i) {
+        while (queue.size() < kQueue) {
+            FrameData data;
+            produce(data);
+            queue.push(std::move(data));
+        }
+        if (!copyInto) {
+            queue.takeFront();
+            continue;
+        }
+        const FrameData& front = queue.front();
+        const Pixels* planes[3] = { &front.pixels, &front.pixelsUV, &front.pixelsV };
+        for (int p = 0; p < 3; ++p) {
+            const size_t n = planes[p]->getTotalBytes();
+            if (n == 0) continue;
+            copyInto[p].resize(n);
+            std::memcpy(copyInto[p].data(), planes[p]->getData(), n);
+        }
+        queue.pop();
+    }
+}
+
+static void testPipeline() {
+    auto pool = std::make_shared<PixelsPool>();
+    const int w = 320, h = 180;
+    YuvFrame yuv = makeYuv(w, h, 6);
+    VideoFrameQueue queue;
+    setUp(queue, w, h, Planes::I420, pool);
+
+    queue.prime();
+    const FrameData& shown = queue.shown();
+    check("prime: black / neutral-chroma frame shown, none decoded yet",
+          !queue.hasShownFrame() && shown.pixels.getData()[0] == 0
+          && shown.pixelsUV.getData()[0] == 128 && shown.pixelsV.getData()[0] == 128);
+
+    const auto primed = pool->getStats();
+    runPipeline(queue, 100, [&](FrameData& d) { i420Path(queue, yuv, d); });
+    const auto after = pool->getStats();
+    check("swap pipeline: no allocation after prime()", after.allocated == primed.allocated);
+    check("swap pipeline: at most POOL_FRAMES frames out at once",
+          after.peakBlocksInUse <= kPoolFrames * 3);
+    check("swap pipeline: shown frame holds the last planes",
+          queue.hasShownFrame() && planeEquals(shown.pixels, yuv.y, w, h)
+          && planeEquals(shown.pixelsV, yuv.v, w / 2, h / 2));
+
+    // takeFront() hands over the queued block itself (what getPixelsY()
+    // points at), and the block it replaces is reused by the next decode.
+    const uint8_t* queuedY = queue.front().pixels.getData();
+    const uint8_t* oldY = shown.pixels.getData();
+    queue.takeFront();
+    FrameData next;
+    i420Path(queue, yuv, next);
+    check("takeFront swaps the queued block in, the old one is recycled",
+          shown.pixels.getData() == queuedY && next.pixels.getData() == oldY);
+
+    // A frame that doesn't fit the layout (RGBA after a format change) is
+    // dropped without touching the shown frame.
+    queue.clear();
+    FrameData rgba;
+    queue.allocate(rgba, Planes::RGBA);
+    queue.push(std::move(rgba));
+    check("takeFront drops a frame in the wrong layout",
+          !queue.takeFront() && queue.empty() && shown.pixels.getData() == queuedY);
+}
+
+// --- benchmark ----------------------------------------------------------------
+
+static double bench(const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();  // warm-up (page faults, pool blocks)
+    int iters = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < 0.25 || iters < 5) {
+        fn();
+        ++iters;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    return elapsed / iters;
+}
+
+static void benchmark(int w, int h) {
+    printf("\ndecode-thread work per %dx%d frame, after the codec (pooled frames):\n", w, h);
+    auto pool = std::make_shared<PixelsPool>();
+    YuvFrame yuv = makeYuv(w, h, 4);
+    P010Frame p010 = makeP010(w, h, 5);
+    RgbaPath rgbaPath(w, h);
+    VideoFrameQueue i420Queue, nv12Queue, rgbaQueue;
+    setUp(i420Queue, w, h, Planes::I420, pool);
+    setUp(nv12Queue, w, h, Planes::NV12, pool);
+    setUp(rgbaQueue, w, h, Planes::RGBA, pool);
+
+    const double mb = 1.0 / (1024.0 * 1024.0);
+    double rgba = bench([&] { FrameData d; rgbaPath.run(rgbaQueue, yuv, d); });
+    double i420 = bench([&] { FrameData d; i420Path(i420Queue, yuv, d); });
+    double nv12 = bench([&] { FrameData d; p010Path(nv12Queue, p010, d); });
+    printf("  %-40s %7.3f ms  %6.1f MB/frame to upload\n", "RGBA fallback (YUV420P -> RGBA + copy)",
+           rgba * 1e3, w * h * 4 * mb);
+    printf("    (%s)\n", RgbaPath::name());
+    printf("  %-40s %7.3f ms  %6.1f MB/frame to upload\n", "I420 planes (YUV420P)", i420 * 1e3, w * h * 1.5 * mb);
+    printf("  %-40s %7.3f ms  %6.1f MB/frame to upload\n", "NV12 planes (P010, high byte)", nv12 * 1e3, w * h * 1.5 * mb);
+    printf("  planar path: %.1fx less decode-thread time than the fallback\n", rgba / std::max(i420, 1e-9));
+
+    // Whole pipeline, decode thread + update(): the older copies (RGBA via a
+    // scratch buffer; queue front memcpy'd into the player's buffers) vs
+    // converting into the pooled frame and swapping it in. Copy traffic is
+    // the bytes memcpy reads + writes per frame (the conversion / plane copy
+    // itself and the texture upload are the same on both sides).
+    printf("\npipeline per %dx%d frame (decode + update), copy -> swap:\n", w, h);
+    const int frames = 8;
+    const double px = (double)w * h;
+    struct Row {
+        const char* name; double bpp; VideoFrameQueue* queue;
+        std::function<void(FrameData&, bool)> produce;
+    };
+    const Row rows[] = {
+        {"RGBA fallback", 4.0, &rgbaQueue, [&](FrameData& d, bool copy) {
+             if (copy) rgbaPath.runViaScratch(rgbaQueue, yuv, d); else rgbaPath.run(rgbaQueue, yuv, d); }},
+        {"I420 planes", 1.5, &i420Queue, [&](FrameData& d, bool) { i420Path(i420Queue, yuv, d); }},
+        {"NV12 planes (P010)", 1.5, &nv12Queue, [&](FrameData& d, bool) { p010Path(nv12Queue, p010, d); }},
+    };
+    for (const Row& row : rows) {
+        double t[2];
+        for (int copy = 1; copy >= 0; --copy) {
+            std::vector<uint8_t> player[3];
+            row.queue->prime();
+            t[copy] = bench([&] {
+                runPipeline(*row.queue, frames, [&](FrameData& d) { row.produce(d, copy != 0); },
+                            copy ? player : nullptr);
+            }) / frames;
+            row.queue->reset();
+        }
+        // copy mode: update() memcpy (read + write), plus scratch -> frame for RGBA
+        const double copyBytes = px * row.bpp * 2 * (row.bpp == 4.0 ? 2 : 1);
+        printf("  %-24s %7.3f -> %7.3f ms   copies %6.1f -> 0 MB/frame (%5.2f GB/s at 60 fps)\n",
+               row.name, t[1] * 1e3, t[0] * 1e3, copyBytes * mb, copyBytes * 60 / 1e9);
+    }
+}
+
+// Usage: videoPlanes [width height]   (benchmark frame size, default 3840x2160)
+int main(int argc, char** argv) {
+    int w = 3840, h = 2160;
+    if (argc >= 3) {
+        w = (int)std::strtol(argv[1], nullptr, 10) & ~1;
+        h = (int)std::strtol(argv[2], nullptr, 10) & ~1;
+    }
+    testPlanes();
+    testFallbackMatchesShader();
+    testPipeline();
+    benchmark(w, h);
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
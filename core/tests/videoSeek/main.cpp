@@ -0,0 +1,533 @@
+// =============================================================================
+// core/tests/videoSeek — VideoSeekIndex / VideoFrameCache (the Linux
+// VideoPlayer's seek path), plus a seek latency benchmark.
+//
+// The checks cover what seeking relies on: packets added in decode order
+// come out in presentation order, a time maps to the frame on screen then
+// and to the keyframe decoding has to start from, the sidecar cache
+// round-trips and refuses a different file version or a damaged file, and
+// the scrub cache evicts least recently used frames.
+//
+// The benchmark (informational only) prints seek latency percentiles for
+// random jumps and for a back-and-forth scrub on a synthetic long-GOP
+// stream, counted in frames the decoder has to produce before the picture
+// is right: the old seek (decode + convert every frame from the keyframe)
+// vs the index (convert only the target), scrub mode's keyframe preview and
+// its frame cache. With FFmpeg available, `videoSeek <clip>` times the same
+// strategies in milliseconds on a real file.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/video/tcVideoSeekIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef TC_TEST_HAVE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// --- synthetic stream -----------------------------------------------------------
+
+// `frames` frames `tick` apart with a keyframe every `gop`, added in decode
+// order with I P B B reordering (P before the two B frames it anchors).
+static VideoSeekIndex makeIndex(int frames, int gop, int64_t tick) {
+    VideoSeekIndex index;
+    for (int k = 0; k < frames; k += gop) {
+        const int end = std::min(k + gop, frames);
+        index.add(k * tick, true);
+        for (int i = k + 1; i < end; i += 3) {
+            if (i + 2 < end) {
+                index.add((i + 2) * tick, false);
+                index.add(i * tick, false);
+                index.add((i + 1) * tick, false);
+            } else {
+                for (int j = i; j < end; ++j) index.add(j * tick, false);
+            }
+        }
+    }
+    index.finish();
+    return index;
+}
+
+// --- index ------------------------------------------------------------------------
+
+static void testIndex() {
+    const int64_t tick = 3000;   // 30 fps in a 1/90000 time base
+    VideoSeekIndex index = makeIndex(100, 30, tick);
+
+    check("finish: presentation order, every frame once",
+          index.getFrameCount() == 100 && std::is_sorted(index.getFrames().begin(), index.getFrames().end()) &&
+          index.getFrames().front() == 0 && index.getFrames().back() == 99 * tick);
+    check("finish: keyframes every GOP",
+          index.getKeyframes() == std::vector<int64_t>({0, 30 * tick, 60 * tick, 90 * tick}));
+
+    check("frameAtOrBefore: exact timestamp is that frame", index.frameAtOrBefore(41 * tick) == 41 * tick);
+    check("frameAtOrBefore: between frames is the one on screen",
+          index.frameAtOrBefore(41 * tick + tick / 2) == 41 * tick &&
+          index.frameAtOrBefore(42 * tick - 1) == 41 * tick);
+    check("frameAtOrBefore: before the first / after the last frame",
+          index.frameAtOrBefore(-5 * tick) == 0 && index.frameAtOrBefore(500 * tick) == 99 * tick);
+    check("keyframeAtOrBefore: start of the GOP",
+          index.keyframeAtOrBefore(41 * tick) == 30 * tick && index.keyframeAtOrBefore(30 * tick) == 30 * tick &&
+          index.keyframeAtOrBefore(29 * tick) == 0);
+    check("frameAfter / frameBefore step one frame",
+          index.frameAfter(41 * tick) == 42 * tick && index.frameBefore(41 * tick) == 40 * tick &&
+          index.frameAfter(41 * tick + 7) == 42 * tick);
+    check("frameAfter / frameBefore past the ends are kNone",
+          index.frameAfter(99 * tick) == VideoSeekIndex::kNone && index.frameBefore(0) == VideoSeekIndex::kNone);
+    check("framesToDecode: keyframe .. target inclusive",
+          index.framesToDecode(30 * tick) == 1 && index.framesToDecode(41 * tick) == 12 &&
+          index.framesToDecode(59 * tick + 1) == 30);
+
+    VideoSeekIndex empty;
+    check("empty index: no frames, lookups are kNone",
+          empty.empty() && empty.frameAtOrBefore(0) == VideoSeekIndex::kNone &&
+          empty.keyframeAtOrBefore(0) == VideoSeekIndex::kNone);
+
+    VideoSeekIndex noKeys;
+    noKeys.add(0, false);
+    noKeys.add(tick, false);
+    noKeys.finish();
+    check("index without keyframes is unusable (empty())", noKeys.empty() && noKeys.getFrameCount() == 2);
+}
+
+// --- sidecar ------------------------------------------------------------------------
+
+static void testSidecar() {
+    const fs::path dir = fs::temp_directory_path() / "tc_videoSeek_test";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    const fs::path video = dir / "clip.mp4";
+    {
+        std::FILE* f = std::fopen(video.string().c_str(), "wb");
+        const char bytes[] = "not really a video";
+        if (f) {
+            std::fwrite(bytes, 1, sizeof(bytes), f);
+            std::fclose(f);
+        }
+    }
+    VideoSeekIndex::Source source;
+    check("Source::of: size of a regular file",
+          VideoSeekIndex::Source::of(video, 0, source) && source.size == 19);
+    VideoSeekIndex::Source none;
+    check("Source::of: missing file / directory fail",
+          !VideoSeekIndex::Source::of(dir / "missing.mp4", 0, none) && !VideoSeekIndex::Source::of(dir, 0, none));
+
+    const fs::path sidecar = VideoSeekIndex::sidecarPath(video);
+    check("sidecarPath appends .tcseek", sidecar.filename() == "clip.mp4.tcseek");
+
+    const VideoSeekIndex index = makeIndex(1000, 250, 512);
+    const auto onlySidecar = [&] {   // no temp files left next to it
+        size_t files = 0;
+        for (const auto& e : fs::directory_iterator(dir, ec)) files += e.path() != video;
+        return files == 1;
+    };
+    check("save writes the sidecar (and no temp file)",
+          index.save(sidecar, source) && fs::exists(sidecar) && onlySidecar());
+
+    // Two players indexing the same clip at once: each writes its own temp
+    // file, so one never truncates or renames the other's half-written one.
+    {
+        const fs::path other = fs::path(sidecar) += ".tmp";   // another writer's, in flight
+        { std::ofstream(other, std::ios::binary) << "partial"; }
+        std::string kept;
+        const bool saved = index.save(sidecar, source);
+        { std::ifstream(other, std::ios::binary) >> kept; }
+        fs::remove(other, ec);
+        check("save leaves another writer's temp file alone", saved && kept == "partial" && onlySidecar());
+    }
+    {
+        std::vector<VideoSeekIndex> indices;
+        for (int t = 0; t < 8; ++t) indices.push_back(makeIndex(20000 + 1000 * t, 250, 512));
+        std::vector<std::thread> writers;
+        std::atomic<int> failed{0};
+        for (int t = 0; t < 8; ++t) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < 20; ++i) failed += !indices[t].save(sidecar, source);
+            });
+        }
+        for (auto& w : writers) w.join();
+        VideoSeekIndex last;
+        const bool whole = last.load(sidecar, source)
+            && std::any_of(indices.begin(), indices.end(), [&](const VideoSeekIndex& x) {
+                   return x.getFrames() == last.getFrames() && x.getKeyframes() == last.getKeyframes();
+               });
+        check("concurrent saves: one whole index lands, no temp files left",
+              failed == 0 && whole && onlySidecar());
+    }
+    index.save(sidecar, source);
+
+    VideoSeekIndex loaded;
+    check("load: same file version round-trips",
+          loaded.load(sidecar, source) && loaded.getFrames() == index.getFrames() &&
+          loaded.getKeyframes() == index.getKeyframes());
+
+    VideoSeekIndex other = makeIndex(10, 5, 1);
+    VideoSeekIndex::Source changed = source;
+    changed.mtime += 1;
+    check("load: modified file is refused, index unchanged",
+          !other.load(sidecar, changed) && other.getFrameCount() == 10);
+    changed = source;
+    changed.stream = 1;
+    check("load: other stream is refused", !other.load(sidecar, changed));
+
+    // Truncate by a few bytes: header counts no longer match the file.
+    const auto size = fs::file_size(sidecar, ec);
+    fs::resize_file(sidecar, size - 5, ec);
+    check("load: truncated sidecar is refused", !ec && !other.load(sidecar, source));
+    {
+        std::FILE* f = std::fopen(sidecar.string().c_str(), "wb");
+        if (f) {
+            std::fwrite("TCSK", 1, 4, f);
+            std::fclose(f);
+        }
+    }
+    check("load: header-only garbage is refused", !other.load(sidecar, source));
+    check("load: missing sidecar fails", !other.load(dir / "nothing.tcseek", source));
+
+    fs::remove_all(dir, ec);
+}
+
+// --- frame cache --------------------------------------------------------------------
+
+struct MoveOnly {
+    std::vector<int> v;
+    MoveOnly() = default;
+    explicit MoveOnly(int x) : v{x} {}
+    MoveOnly(MoveOnly&&) = default;
+    MoveOnly& operator=(MoveOnly&&) = default;
+    MoveOnly(const MoveOnly&) = delete;
+};
+
+static void testCache() {
+    VideoFrameCache<MoveOnly> cache(3);
+    for (int i = 1; i <= 3; ++i) cache.put(i * 100, MoveOnly(i));
+    check("cache: holds up to capacity", cache.size() == 3 && cache.contains(100) && cache.contains(300));
+
+    const MoveOnly* hit = cache.find(100);   // 100 is now most recent
+    check("cache: find returns the stored frame", hit && hit->v[0] == 1);
+    cache.put(400, MoveOnly(4));
+    check("cache: evicts the least recently used",
+          cache.size() == 3 && !cache.contains(200) && cache.contains(100) && cache.contains(400));
+
+    cache.put(300, MoveOnly(33));
+    hit = cache.find(300);
+    check("cache: put on an existing key replaces it", cache.size() == 3 && hit && hit->v[0] == 33);
+    check("cache: miss returns nullptr", cache.find(999) == nullptr);
+
+    cache.setCapacity(1);
+    check("cache: shrinking keeps the most recent", cache.size() == 1 && cache.contains(300));
+    cache.setCapacity(0);
+    cache.put(500, MoveOnly(5));
+    check("cache: capacity 0 stores nothing", cache.size() == 0 && cache.find(500) == nullptr);
+}
+
+// --- benchmark ----------------------------------------------------------------------
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (double)(v.size() - 1) + 0.5);
+    return v[std::min(i, v.size() - 1)];
+}
+
+static void printRow(const char* name, const std::vector<double>& v, const char* unit) {
+    printf("  %-40s p50 %7.1f  p90 %7.1f  p99 %7.1f %s\n", name,
+           percentile(v, 0.5), percentile(v, 0.9), percentile(v, 0.99), unit);
+}
+
+// Random jumps (cue points) and a drag back and forth over a few seconds at
+// one target per 60 Hz display frame.
+static std::vector<int> jumpTrace(int frames, int count) {
+    std::mt19937 rng(47);
+    std::vector<int> t(count);
+    for (auto& f : t) f = (int)(rng() % (uint32_t)frames);
+    return t;
+}
+
+static std::vector<int> dragTrace(int frames, int fps) {
+    std::vector<int> t;
+    const int start = frames / 3, span = 3 * fps;   // 3 s of timeline
+    for (int pass = 0; pass < 6; ++pass) {
+        for (int step = 0; step <= 60; ++step) {     // each pass takes 1 s
+            const int off = span * step / 60;
+            t.push_back(pass % 2 == 0 ? start + off : start + span - off);
+        }
+    }
+    return t;
+}
+
+// Frames the decoder must output before the right picture is up, per seek.
+//   before: demuxer seek, every frame from the keyframe decoded and converted
+//           (and nothing shown while paused)
+//   index:  keyframe from the index, only the target converted
+//   scrub:  first picture = keyframe preview; cache hits decode nothing
+static void modelStream(const char* label, int frames, int gop, int fps) {
+    const int64_t tick = 90000 / fps;
+    const VideoSeekIndex index = makeIndex(frames, gop, tick);
+    printf("\n%s (%d fps, keyframe every %d frames), frames decoded per seek:\n", label, fps, gop);
+
+    struct Trace { const char* name; std::vector<int> targets; };
+    const Trace traces[] = {
+        {"random jumps", jumpTrace(frames, 500)},
+        {"scrub back and forth", dragTrace(frames, fps)},
+    };
+    for (const Trace& trace : traces) {
+        std::vector<double> exact, preview, cached;
+        VideoFrameCache<int> cache(8);
+        size_t hits = 0;
+        for (int f : trace.targets) {
+            const int64_t ts = f * tick + tick / 3;    // somewhere inside frame f
+            const int64_t frame = index.frameAtOrBefore(ts);
+            const int64_t key = index.keyframeAtOrBefore(frame);
+            const double n = (double)index.framesToDecode(ts);
+            exact.push_back(n);
+            if (cache.find(frame)) {
+                ++hits;
+                cached.push_back(0.0);
+                preview.push_back(0.0);
+                continue;
+            }
+            preview.push_back(cache.find(key) ? 0.0 : 1.0);
+            cached.push_back(n);
+            cache.put(key, 0);
+            cache.put(frame, 0);
+        }
+        printf(" %s (%zu seeks):\n", trace.name, trace.targets.size());
+        printRow("before / index: exact frame", exact, "frames (before also converts each)");
+        printRow("scrub: first picture (keyframe)", preview, "frames");
+        printRow("scrub: exact frame, 8-frame cache", cached, "frames");
+        printf("  %-40s %zu / %zu\n", "scrub cache hits", hits, trace.targets.size());
+    }
+}
+
+#ifdef TC_TEST_HAVE_FFMPEG
+// Real seeks on a clip: the same strategies as the model, in milliseconds.
+class Clip {
+public:
+    ~Clip() {
+        if (sws_) sws_freeContext(sws_);
+        av_frame_free(&frame_);
+        av_packet_free(&pkt_);
+        avcodec_free_context(&dec_);
+        avformat_close_input(&fmt_);
+    }
+
+    bool open(const std::string& path) {
+        if (avformat_open_input(&fmt_, path.c_str(), nullptr, nullptr) < 0) return false;
+        if (avformat_find_stream_info(fmt_, nullptr) < 0) return false;
+        stream_ = av_find_best_stream(fmt_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (stream_ < 0) return false;
+        AVCodecParameters* par = fmt_->streams[stream_]->codecpar;
+        const AVCodec* codec = avcodec_find_decoder(par->codec_id);
+        if (!codec) return false;
+        dec_ = avcodec_alloc_context3(codec);
+        if (!dec_ || avcodec_parameters_to_context(dec_, par) < 0) return false;
+        if (avcodec_open2(dec_, codec, nullptr) < 0) return false;
+        frame_ = av_frame_alloc();
+        pkt_ = av_packet_alloc();
+        tb_ = av_q2d(fmt_->streams[stream_]->time_base);
+        rgba_.resize((size_t)dec_->width * dec_->height * 4);
+        return frame_ && pkt_;
+    }
+
+    // Demux every packet (what the backend's index thread does).
+    VideoSeekIndex scan() {
+        VideoSeekIndex index;
+        av_seek_frame(fmt_, stream_, 0, AVSEEK_FLAG_BACKWARD);
+        while (av_read_frame(fmt_, pkt_) >= 0) {
+            if (pkt_->stream_index == stream_ && pkt_->pts != AV_NOPTS_VALUE)
+                index.add(pkt_->pts, (pkt_->flags & AV_PKT_FLAG_KEY) != 0);
+            av_packet_unref(pkt_);
+        }
+        index.finish();
+        return index;
+    }
+
+    double timeBase() const { return tb_; }
+    int streamIndex() const { return stream_; }
+
+    // Seek to `keyTs` and decode up to the first frame at or after
+    // `frameTs`. convertAll: convert every frame on the way (the old path).
+    // Returns ms to the exact frame; *previewMs gets the ms to the first
+    // converted frame.
+    double seek(int64_t keyTs, int64_t frameTs, bool convertAll, bool preview, double* previewMs) {
+        const auto t0 = Clock::now();
+        av_seek_frame(fmt_, stream_, keyTs, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(dec_);
+        bool first = true;
+        while (receive()) {
+            const bool before = frame_->pts != AV_NOPTS_VALUE && frame_->pts < frameTs;
+            if (convertAll || !before || (preview && first)) {
+                convert();
+                if (first && previewMs) *previewMs = ms(t0);
+                first = false;
+            }
+            av_frame_unref(frame_);
+            if (!before) break;
+        }
+        return ms(t0);
+    }
+
+    const std::vector<uint8_t>& rgba() const { return rgba_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static double ms(Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    bool receive() {
+        while (true) {
+            int ret = avcodec_receive_frame(dec_, frame_);
+            if (ret == 0) return true;
+            if (ret != AVERROR(EAGAIN)) return false;
+            if (av_read_frame(fmt_, pkt_) < 0) {
+                avcodec_send_packet(dec_, nullptr);   // drain
+                continue;
+            }
+            if (pkt_->stream_index == stream_) avcodec_send_packet(dec_, pkt_);
+            av_packet_unref(pkt_);
+        }
+    }
+
+    void convert() {
+        sws_ = sws_getCachedContext(sws_, frame_->width, frame_->height, (AVPixelFormat)frame_->format,
+                                    dec_->width, dec_->height, AV_PIX_FMT_RGBA,
+                                    SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws_) return;
+        uint8_t* dst[4] = { rgba_.data(), nullptr, nullptr, nullptr };
+        int stride[4] = { dec_->width * 4, 0, 0, 0 };
+        sws_scale(sws_, frame_->data, frame_->linesize, 0, frame_->height, dst, stride);
+    }
+
+    AVFormatContext* fmt_ = nullptr;
+    AVCodecContext* dec_ = nullptr;
+    SwsContext* sws_ = nullptr;
+    AVFrame* frame_ = nullptr;
+    AVPacket* pkt_ = nullptr;
+    int stream_ = -1;
+    double tb_ = 0.0;
+    std::vector<uint8_t> rgba_;
+};
+
+static void measureClip(const std::string& path) {
+    Clip clip;
+    if (!clip.open(path)) {
+        printf("\ncan't open %s\n", path.c_str());
+        return;
+    }
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    const VideoSeekIndex index = clip.scan();
+    const double scanMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (index.empty() || index.getFrameCount() < 2) {
+        printf("\n%s: no keyframe timestamps, nothing to measure\n", path.c_str());
+        return;
+    }
+
+    const fs::path sidecar = fs::temp_directory_path() / "tc_videoSeek_clip.tcseek";
+    VideoSeekIndex::Source source{1, 2, clip.streamIndex()};
+    index.save(sidecar, source);
+    VideoSeekIndex loaded;
+    t0 = Clock::now();
+    loaded.load(sidecar, source);
+    const double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::error_code ec;
+    fs::remove(sidecar, ec);
+
+    // The seek cost scales with the GOP, so say which kind of clip this was.
+    printf("\n%s: %zu frames, %zu keyframes (one every %.0f frames)\n", path.c_str(),
+           index.getFrameCount(), index.getKeyframeCount(),
+           (double)index.getFrameCount() / index.getKeyframeCount());
+    printf("  index: demux scan %.1f ms, sidecar load %.2f ms\n", scanMs, loadMs);
+
+    const auto& frames = index.getFrames();
+    const int count = (int)frames.size();
+    const double tb = clip.timeBase();
+    const size_t frameBytes = clip.rgba().size();
+
+    struct Trace { const char* name; std::vector<int> targets; };
+    const double fps = (count - 1) / ((frames.back() - frames.front()) * tb);
+    const Trace traces[] = {
+        {"random jumps", jumpTrace(count, 60)},
+        {"scrub back and forth", dragTrace(count, std::max(1, (int)(fps + 0.5)))},
+    };
+    for (const Trace& trace : traces) {
+        std::vector<double> before, exact, preview, cached;
+        VideoFrameCache<std::vector<uint8_t>> cache(8);
+        for (int f : trace.targets) {
+            f = std::clamp(f, 0, count - 1);
+            const int64_t ts = frames[f];
+            const int64_t key = index.keyframeAtOrBefore(ts);
+            before.push_back(clip.seek(ts, ts, true, false, nullptr));
+            exact.push_back(clip.seek(key, ts, false, false, nullptr));
+
+            const auto c0 = Clock::now();
+            if (const auto* hit = cache.find(ts)) {
+                std::vector<uint8_t> shown(*hit);   // the copy the backend makes
+                const double hitMs = std::chrono::duration<double, std::milli>(Clock::now() - c0).count();
+                cached.push_back(hitMs);
+                preview.push_back(hitMs);
+                continue;
+            }
+            double previewMs = 0.0;
+            cached.push_back(clip.seek(key, ts, false, true, &previewMs));
+            preview.push_back(previewMs);
+            cache.put(ts, std::vector<uint8_t>(clip.rgba()));
+        }
+        printf(" %s (%zu seeks, %.1f MB per cached frame):\n", trace.name, trace.targets.size(),
+               frameBytes / (1024.0 * 1024.0));
+        printRow("before: seek + convert every frame", before, "ms");
+        printRow("index: keyframe + convert target only", exact, "ms");
+        printRow("scrub: first picture (keyframe)", preview, "ms");
+        printRow("scrub: exact frame, 8-frame cache", cached, "ms");
+    }
+}
+#endif
+
+int main(int argc, char** argv) {
+    testIndex();
+    testSidecar();
+    testCache();
+
+    modelStream("10 min long-GOP stream", 30 * 600, 300, 30);
+    modelStream("10 min short-GOP stream", 30 * 600, 30, 30);
+#ifdef TC_TEST_HAVE_FFMPEG
+    if (argc >= 2) measureClip(argv[1]);
+    else printf("\n(pass a video file to time real seeks on it)\n");
+#else
+    (void)argc;
+    (void)argv;
+    printf("\n(built without FFmpeg: no real-clip timing)\n");
+#endif
+
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
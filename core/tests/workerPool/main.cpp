@@ -0,0 +1,120 @@
+// =============================================================================
+// core/tests/workerPool — WorkerPool::parallelFor with several callers.
+//
+// Two threads calling parallelFor on one pool must both get helpers (they
+// used to take turns: the second caller ran its whole range inline). Each of
+// the two jobs has two items that only return once all four items are
+// running at the same time, which needs the pool to serve both jobs at once.
+//
+// Also: every item runs exactly once under concurrent and nested calls, and
+// setThreadCount() racing parallelFor() / getThreadCount() neither loses
+// items nor reports a count the pool never had.
+//
+// Console, exit code = pass/fail (build_all.py runs it under --core-tests-only).
+// =============================================================================
+
+#include "tc/utils/tcParallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace trussc;
+
+static int g_fail = 0;
+static void check(const char* name, bool ok) {
+    printf("%-64s %s\n", name, ok ? "PASS" : "FAIL");
+    fflush(stdout);
+    if (!ok) ++g_fail;
+}
+
+// Wait (up to 5 s) until `arrived` reaches `want`.
+static bool rendezvous(std::atomic<int>& arrived, int want) {
+    arrived.fetch_add(1);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (arrived.load() < want) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+static void testConcurrentCallers() {
+    WorkerPool pool(3);
+    std::atomic<int> arrived{0};
+    std::atomic<int> met{0};
+    auto body = [&](int) { if (rendezvous(arrived, 4)) met.fetch_add(1); };
+
+    std::thread a([&] { pool.parallelFor(0, 2, body); });
+    std::thread b([&] { pool.parallelFor(0, 2, body); });
+    a.join();
+    b.join();
+    check("two callers run side by side (4 items of 2 jobs at once)", met.load() == 4);
+}
+
+static void testEveryItemOnce() {
+    WorkerPool pool(4);
+    constexpr int CALLERS = 6;
+    constexpr int ITEMS = 2000;
+    std::vector<std::atomic<int>> hits(CALLERS * ITEMS);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < CALLERS; c++) {
+        callers.emplace_back([&, c] {
+            for (int round = 0; round < 20; round++) {
+                pool.parallelFor(0, ITEMS, [&](int i) { hits[c * ITEMS + i].fetch_add(1); });
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    bool ok = true;
+    for (auto& h : hits) ok &= h.load() == 20;
+    check("6 concurrent callers x 20 rounds: every item exactly once", ok);
+
+    std::atomic<int> inner{0};
+    pool.parallelFor(0, 16, [&](int) {
+        pool.parallelFor(0, 16, [&](int) { inner.fetch_add(1); });
+    });
+    check("nested parallelFor from inside a body completes", inner.load() == 256);
+
+    std::atomic<int> capped{0};
+    pool.parallelFor(0, 100, [&](int) { capped.fetch_add(1); }, 1);
+    check("maxThreads = 1 runs the range on the caller", capped.load() == 100);
+}
+
+static void testResize() {
+    WorkerPool pool(2);
+    std::atomic<bool> done{false};
+    std::atomic<long> items{0};
+    std::atomic<bool> countOk{true};
+
+    std::thread caller([&] {
+        for (int round = 0; round < 500; round++) {
+            pool.parallelFor(0, 64, [&](int) { items.fetch_add(1); });
+        }
+        done = true;
+    });
+    std::thread reader([&] {
+        while (!done) {
+            const int n = pool.getThreadCount();
+            if (n < 0 || n > 5) countOk = false;
+        }
+    });
+    for (int i = 0; i < 50; i++) pool.setThreadCount(i % 6);
+    caller.join();
+    reader.join();
+    check("setThreadCount during parallelFor: no item lost", items.load() == 500L * 64);
+    check("getThreadCount during setThreadCount stays in range", countOk.load());
+
+    pool.setThreadCount(3);
+    check("getThreadCount == workers after resize", pool.getThreadCount() == 3);
+}
+
+int main() {
+    testConcurrentCallers();
+    testEveryItemOnce();
+    testResize();
+    printf("\n%s (%d failures)\n", g_fail == 0 ? "PASSED" : "FAILED", g_fail);
+    return g_fail == 0 ? 0 : 1;
+}
@@ -14,10 +14,10 @@ void tcApp::update() {
     if (!getMicInput().isRunning()) return;
 
     getMicAnalysisBuffer(fftInput.data(), FFT_SIZE);
-    auto fftResult = fftReal(fftInput, WindowType::Hanning);
+    fftReal(fftInput, fftBins, WindowType::Hanning);
 
     for (size_t i = 0; i < spectrum.size(); i++) {
-        float mag = std::abs(fftResult[i]) * 4.0f;
+        float mag = std::abs(fftBins[i]) * 4.0f;
         spectrum[i] = mag > 1.0f ? 1.0f : mag;
     }
 }
@@ -14,5 +14,6 @@ public:
 private:
     static constexpr int FFT_SIZE = 1024;
     vector<float> fftInput;
+    vector<complex<float>> fftBins;
     vector<float> spectrum;
 };
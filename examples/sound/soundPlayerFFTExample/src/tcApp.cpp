@@ -51,12 +51,12 @@ void tcApp::update() {
     // Get latest audio samples from AudioEngine
     getAudioAnalysisBuffer(fftInput.data(), FFT_SIZE);
 
-    // Apply window function and execute FFT
-    auto fftResult = fftReal(fftInput, WindowType::Hanning);
+    // Apply window function and execute FFT (into fftBins, no allocation)
+    fftReal(fftInput, fftBins, WindowType::Hanning);
 
     // Calculate magnitude (with log scale support)
     for (size_t i = 0; i < spectrum.size(); i++) {
-        float mag = std::abs(fftResult[i]);
+        float mag = std::abs(fftBins[i]);
 
         if (useLogScale) {
             // dB scale: map -60dB ~ 0dB to 0.0 ~ 1.0
@@ -19,6 +19,7 @@ private:
     // FFT related
     static constexpr int FFT_SIZE = 1024;
     std::vector<float> fftInput;
+    std::vector<std::complex<float>> fftBins;   // FFT_SIZE / 2 + 1, reused every frame
     std::vector<float> spectrum;
     std::vector<float> spectrumSmooth;  // For smoothing
 